@@ -0,0 +1,197 @@
+/**
+ * @file ping_pong.h
+ *
+ * @brief Round-trip latency (ping-pong) measurement
+ *
+ * The initiator sends a ping, the reflector answers it with a pong as soon
+ * as it is indicated. Both nodes take time stamps with their own clock:
+ *
+ *     initiator                          reflector
+ *     t_req   request of the ping
+ *     t_tx    ping starts on air  ---->  r_rx    ping starts on air
+ *     t_conf  confirm of the ping        r_ind   indication of the ping
+ *                                        r_req   request of the pong
+ *     i_rx    pong starts on air  <----  r_tx    pong starts on air
+ *     i_ind   indication of the pong
+ *
+ * Only differences of time stamps of the same node are used, so the clocks
+ * need not be synchronized. The reflector reports its differences in the
+ * pong; r_tx is known after the pong was transmitted only, so it is reported
+ * by the next pong.
+ *
+ * The frame start on air is the frame time stamp of the TAL, which requires
+ * ENABLE_TSTAMP. Without it only the round trip time and the turnaround are
+ * measured, and the one-way latency is estimated as half of their difference.
+ *
+ * The module is independent of the stack layer: the application builds and
+ * transmits the frames via the TAL or the MAC API and passes the payloads,
+ * time stamps and confirms to this module.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PING_PONG_H
+#define PING_PONG_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+/**
+ * Maximum number of samples stored per metric; the percentiles are
+ * calculated from the stored samples, so a run is limited to this number
+ * of pings.
+ */
+#ifndef PING_MAX_SAMPLES
+#define PING_MAX_SAMPLES                (100)
+#endif
+
+/** Time in us after which a ping without pong is regarded as lost */
+#ifndef PING_TIMEOUT_US
+#define PING_TIMEOUT_US                 (100000)
+#endif
+
+/** Minimum payload length of a ping and a pong */
+#define PING_PAYLOAD_MIN_LEN            (9)
+
+/** Payload type of a ping */
+#define PING_TYPE_REQUEST               (0x50)
+
+/** Payload type of a pong */
+#define PING_TYPE_RESPONSE              (0x51)
+
+/* === Types ================================================================ */
+
+/**
+ * Role of a node in the measurement
+ */
+typedef enum ping_role_tag
+{
+    PING_INITIATOR,
+    PING_REFLECTOR
+} ping_role_t;
+
+/**
+ * Latency metrics measured by the initiator
+ */
+typedef enum ping_metric_tag
+{
+    /** Request of the ping until indication of the pong */
+    PING_RTT,
+    /** Request of the ping until indication at the reflector */
+    PING_ONE_WAY,
+    /** Request of the ping until start of the frame on air */
+    PING_TX_PATH,
+    /** Start of the ping on air until its confirm */
+    PING_TX_CONFIRM,
+    /** Start of the ping on air until its indication at the reflector */
+    PING_REMOTE_RX_PATH,
+    /** Indication of the ping until request of the pong at the reflector */
+    PING_TURNAROUND,
+    /** Request of the pong until start of the frame on air */
+    PING_REMOTE_TX_PATH,
+    /** Start of the pong on air until its indication */
+    PING_RX_PATH,
+    PING_NUM_METRICS
+} ping_metric_t;
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts a new measurement and clears all samples
+ *
+ * @param role Role of this node
+ * @param payload_length Payload length of pings and pongs, at least
+ *                       PING_PAYLOAD_MIN_LEN
+ *
+ * @return true if the payload length is supported
+ */
+bool ping_init(ping_role_t role, uint8_t payload_length);
+
+/**
+ * @brief Builds the next ping; the initiator requests its transmission
+ *        right afterwards
+ *
+ * @param payload Buffer for the payload of the ping
+ *
+ * @return Length of the payload
+ */
+uint8_t ping_build_request(uint8_t *payload);
+
+/**
+ * @brief Builds the pong to the last ping; the reflector requests its
+ *        transmission right afterwards
+ *
+ * @param payload Buffer for the payload of the pong
+ *
+ * @return Length of the payload
+ */
+uint8_t ping_build_response(uint8_t *payload);
+
+/**
+ * @brief Handles the confirm of the last ping or pong
+ *
+ * @param status Status of the transmission
+ * @param tx_stamp Start of the frame on air in us (ENABLE_TSTAMP only)
+ */
+void ping_tx_done(uint8_t status, uint32_t tx_stamp);
+
+/**
+ * @brief Handles a received payload; called first in the indication
+ *
+ * @param payload Received payload
+ * @param length Length of the payload
+ * @param rx_stamp Time stamp of the frame in us (ENABLE_TSTAMP only)
+ *
+ * @return true if the payload was a ping and the reflector shall answer it
+ */
+bool ping_rx(uint8_t *payload, uint8_t length, uint32_t rx_stamp);
+
+/**
+ * @brief Checks whether the last ping is still outstanding
+ *
+ * A ping without pong is regarded as lost after PING_TIMEOUT_US.
+ *
+ * @return true if the initiator has to wait before the next ping
+ */
+bool ping_pending(void);
+
+/**
+ * @brief Gets the number of pings sent in this measurement
+ *
+ * @return Number of pings
+ */
+uint16_t ping_count(void);
+
+/**
+ * @brief Prints the result of the measurement to the terminal
+ *
+ * @param layer Name of the stack layer the frames were sent by
+ */
+void ping_print_result(const char *layer);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PING_PONG_H */
+/* EOF */
@@ -0,0 +1,499 @@
+/**
+ * @file ping_pong.c
+ *
+ * @brief Round-trip latency (ping-pong) measurement
+ *
+ * Payload of a ping:
+ *     type (1) | sequence number (2) | padding
+ *
+ * Payload of a pong:
+ *     type (1) | sequence number (2) | rx path (2) | turnaround (2) |
+ *     tx path of the previous pong (2) | padding
+ *
+ * The values of the pong are in us, little endian; 0xFFFF marks a value
+ * not measured.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include "pal.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "ping_pong.h"
+
+/* === Macros ============================================================== */
+
+/* Positions within the payload */
+#define PING_POS_TYPE                   (0)
+#define PING_POS_SEQ                    (1)
+#define PING_POS_RX_PATH                (3)
+#define PING_POS_TURNAROUND             (5)
+#define PING_POS_PREV_TX_PATH           (7)
+
+/** Value of a latency not measured */
+#define PING_INVALID                    (0xFFFF)
+
+/* States of the outstanding ping of the initiator */
+#define PING_WAIT_CONFIRM               (0x01)
+#define PING_WAIT_RESPONSE              (0x02)
+
+/*
+ * The TAL time stamp of a received frame is taken at the end of the PHR,
+ * the one of a transmitted frame at the start of the SHR. The duration of
+ * SHR and PHR is added to the received time stamps, so both refer to the
+ * start of the frame on air.
+ */
+#define PING_RX_STAMP_OFFSET_US         \
+    TAL_CONVERT_SYMBOLS_TO_US((PHY_OVERHEAD + LENGTH_FIELD_LEN) * SYMBOLS_PER_OCTET)
+
+/* === Globals ============================================================= */
+
+static ping_role_t ping_role;
+static uint8_t ping_payload_length;
+static uint8_t ping_state;
+static uint16_t ping_seq;
+/* Pings sent and pongs received by the initiator, vice versa by the reflector */
+static uint16_t frames_sent;
+static uint16_t frames_received;
+static uint16_t pings_lost;
+static uint16_t tx_failures;
+
+/* Time stamps of the current ping, see ping_pong.h */
+static uint32_t t_req;
+static uint32_t t_conf;
+static uint32_t r_ind;
+static uint32_t i_ind;
+#ifdef ENABLE_TSTAMP
+static uint32_t t_tx;
+static uint32_t r_rx;
+static uint32_t i_rx;
+#endif
+
+/* Latencies of the reflector, reported by the pong */
+static uint16_t remote_rx_path;
+static uint16_t turnaround;
+static uint16_t prev_remote_tx_path;
+
+static uint16_t samples[PING_NUM_METRICS][PING_MAX_SAMPLES];
+static uint16_t num_samples[PING_NUM_METRICS];
+
+static const char *const metric_names[PING_NUM_METRICS] =
+{
+    "Round trip",
+    "One-way",
+    " Tx path",
+    " Tx confirm",
+    " Remote rx path",
+    " Turnaround",
+    " Remote tx path",
+    " Rx path"
+};
+
+/* === Prototypes ========================================================== */
+
+static void add_sample(ping_metric_t metric, uint32_t value);
+static uint16_t limit_latency(uint32_t value);
+static void complete_ping(void);
+static void sort_samples(uint16_t *values, uint16_t count);
+
+/* === Implementation ====================================================== */
+
+
+/**
+ * @brief Starts a new measurement and clears all samples
+ *
+ * @param role Role of this node
+ * @param payload_length Payload length of pings and pongs
+ *
+ * @return true if the payload length is supported
+ */
+bool ping_init(ping_role_t role, uint8_t payload_length)
+{
+    if (payload_length < PING_PAYLOAD_MIN_LEN)
+    {
+        return false;
+    }
+
+    ping_role = role;
+    ping_payload_length = payload_length;
+    ping_state = 0;
+    frames_sent = 0;
+    frames_received = 0;
+    pings_lost = 0;
+    tx_failures = 0;
+    prev_remote_tx_path = PING_INVALID;
+
+    for (uint8_t i = 0; i < PING_NUM_METRICS; i++)
+    {
+        num_samples[i] = 0;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Builds the next ping
+ *
+ * @param payload Buffer for the payload of the ping
+ *
+ * @return Length of the payload
+ */
+uint8_t ping_build_request(uint8_t *payload)
+{
+    ping_seq++;
+    payload[PING_POS_TYPE] = PING_TYPE_REQUEST;
+    convert_16_bit_to_byte_array(ping_seq, &payload[PING_POS_SEQ]);
+    for (uint8_t i = PING_POS_SEQ + 2; i < ping_payload_length; i++)
+    {
+        payload[i] = i;
+    }
+
+    frames_sent++;
+    ping_state = PING_WAIT_CONFIRM | PING_WAIT_RESPONSE;
+    pal_get_current_time(&t_req);
+
+    return ping_payload_length;
+}
+
+
+/**
+ * @brief Builds the pong to the last ping
+ *
+ * @param payload Buffer for the payload of the pong
+ *
+ * @return Length of the payload
+ */
+uint8_t ping_build_response(uint8_t *payload)
+{
+    uint16_t rx_path = PING_INVALID;
+
+    pal_get_current_time(&t_req);
+
+#ifdef ENABLE_TSTAMP
+    rx_path = limit_latency(pal_sub_time_us(r_ind, r_rx) + PING_RX_STAMP_OFFSET_US);
+#endif
+
+    payload[PING_POS_TYPE] = PING_TYPE_RESPONSE;
+    convert_16_bit_to_byte_array(ping_seq, &payload[PING_POS_SEQ]);
+    convert_16_bit_to_byte_array(rx_path, &payload[PING_POS_RX_PATH]);
+    convert_16_bit_to_byte_array(limit_latency(pal_sub_time_us(t_req, r_ind)),
+                                 &payload[PING_POS_TURNAROUND]);
+    convert_16_bit_to_byte_array(prev_remote_tx_path, &payload[PING_POS_PREV_TX_PATH]);
+    for (uint8_t i = PING_POS_PREV_TX_PATH + 2; i < ping_payload_length; i++)
+    {
+        payload[i] = i;
+    }
+
+    frames_sent++;
+    ping_state = PING_WAIT_CONFIRM;
+
+    return ping_payload_length;
+}
+
+
+/**
+ * @brief Handles the confirm of the last ping or pong
+ *
+ * @param status Status of the transmission
+ * @param tx_stamp Start of the frame on air in us
+ */
+void ping_tx_done(uint8_t status, uint32_t tx_stamp)
+{
+    pal_get_current_time(&t_conf);
+
+    if (!(ping_state & PING_WAIT_CONFIRM))
+    {
+        return;
+    }
+
+    if (status != MAC_SUCCESS)
+    {
+        tx_failures++;
+        ping_state = 0;
+        prev_remote_tx_path = PING_INVALID;
+        return;
+    }
+
+    ping_state &= ~PING_WAIT_CONFIRM;
+
+    if (ping_role == PING_REFLECTOR)
+    {
+        /* Reported by the next pong */
+#ifdef ENABLE_TSTAMP
+        prev_remote_tx_path = limit_latency(pal_sub_time_us(tx_stamp, t_req));
+#endif
+    }
+    else
+    {
+#ifdef ENABLE_TSTAMP
+        t_tx = tx_stamp;
+#endif
+        if (ping_state == 0)
+        {
+            /* The pong overtook the confirm. */
+            complete_ping();
+        }
+    }
+
+    tx_stamp = tx_stamp;    /* Keep compiler happy. */
+}
+
+
+/**
+ * @brief Handles a received payload
+ *
+ * @param payload Received payload
+ * @param length Length of the payload
+ * @param rx_stamp Time stamp of the frame in us
+ *
+ * @return true if the payload was a ping and the reflector shall answer it
+ */
+bool ping_rx(uint8_t *payload, uint8_t length, uint32_t rx_stamp)
+{
+    uint32_t now;
+
+    pal_get_current_time(&now);
+
+    if (length < PING_PAYLOAD_MIN_LEN)
+    {
+        return false;
+    }
+
+    if (ping_role == PING_REFLECTOR)
+    {
+        if ((payload[PING_POS_TYPE] != PING_TYPE_REQUEST) ||
+            (ping_state & PING_WAIT_CONFIRM))
+        {
+            /* Not a ping, or the last pong is still being transmitted */
+            return false;
+        }
+        ping_seq = convert_byte_array_to_16_bit(&payload[PING_POS_SEQ]);
+        r_ind = now;
+#ifdef ENABLE_TSTAMP
+        r_rx = rx_stamp;
+#endif
+        frames_received++;
+        return true;
+    }
+
+    if ((payload[PING_POS_TYPE] != PING_TYPE_RESPONSE) ||
+        !(ping_state & PING_WAIT_RESPONSE) ||
+        (convert_byte_array_to_16_bit(&payload[PING_POS_SEQ]) != ping_seq))
+    {
+        /* Not a pong, or a late pong of a lost ping */
+        return false;
+    }
+
+    i_ind = now;
+#ifdef ENABLE_TSTAMP
+    i_rx = rx_stamp;
+#endif
+    remote_rx_path = convert_byte_array_to_16_bit(&payload[PING_POS_RX_PATH]);
+    turnaround = convert_byte_array_to_16_bit(&payload[PING_POS_TURNAROUND]);
+    prev_remote_tx_path = convert_byte_array_to_16_bit(&payload[PING_POS_PREV_TX_PATH]);
+    frames_received++;
+
+    ping_state &= ~PING_WAIT_RESPONSE;
+    if (ping_state == 0)
+    {
+        complete_ping();
+    }
+
+    rx_stamp = rx_stamp;    /* Keep compiler happy. */
+
+    return false;
+}
+
+
+/**
+ * @brief Checks whether the last ping is still outstanding
+ *
+ * @return true if the initiator has to wait before the next ping
+ */
+bool ping_pending(void)
+{
+    uint32_t now;
+
+    if (ping_state != PING_WAIT_RESPONSE)
+    {
+        /* The confirm is always awaited. */
+        return (ping_state != 0);
+    }
+
+    pal_get_current_time(&now);
+    if (pal_sub_time_us(now, t_conf) > PING_TIMEOUT_US)
+    {
+        pings_lost++;
+        ping_state = 0;
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Gets the number of pings sent in this measurement
+ *
+ * @return Number of pings
+ */
+uint16_t ping_count(void)
+{
+    return frames_sent;
+}
+
+
+/**
+ * @brief Prints the result of the measurement to the terminal
+ *
+ * @param layer Name of the stack layer the frames were sent by
+ */
+void ping_print_result(const char *layer)
+{
+    if (ping_role == PING_REFLECTOR)
+    {
+        printf("\r\nPing-pong via %s, reflector:\r\n", layer);
+        printf("Pings received = %" PRIu16 "\r\n", frames_received);
+        printf("Pongs transmitted = %" PRIu16 "\r\n", frames_sent - tx_failures);
+        printf("Pong tx failures = %" PRIu16 "\r\n", tx_failures);
+        return;
+    }
+
+    printf("\r\nPing-pong via %s, initiator:\r\n", layer);
+    printf("Pings transmitted = %" PRIu16 "\r\n", frames_sent - tx_failures);
+    printf("Ping tx failures = %" PRIu16 "\r\n", tx_failures);
+    printf("Pongs received = %" PRIu16 "\r\n", frames_received);
+    printf("Pings lost = %" PRIu16 "\r\n", pings_lost);
+
+    printf("Latency in us         min   median      p99      max\r\n");
+    for (uint8_t i = 0; i < PING_NUM_METRICS; i++)
+    {
+        uint16_t n = num_samples[i];
+
+        if (n == 0)
+        {
+            continue;
+        }
+
+        sort_samples(samples[i], n);
+
+        /* Nearest rank percentiles */
+        printf("%-16s %8" PRIu16 " %8" PRIu16 " %8" PRIu16 " %8" PRIu16 "\r\n",
+               metric_names[i],
+               samples[i][0],
+               samples[i][((n + 1) / 2) - 1],
+               samples[i][(((uint32_t)n * 99 + 99) / 100) - 1],
+               samples[i][n - 1]);
+    }
+#ifndef ENABLE_TSTAMP
+    printf("One-way latency estimated, no frame time stamps (ENABLE_TSTAMP)\r\n");
+#endif
+}
+
+
+/**
+ * @brief Stores the samples of a ping once its confirm and pong are handled
+ */
+static void complete_ping(void)
+{
+    uint32_t rtt = pal_sub_time_us(i_ind, t_req);
+
+    add_sample(PING_RTT, rtt);
+    add_sample(PING_TURNAROUND, turnaround);
+
+#ifdef ENABLE_TSTAMP
+    add_sample(PING_TX_PATH, pal_sub_time_us(t_tx, t_req));
+    add_sample(PING_TX_CONFIRM, pal_sub_time_us(t_conf, t_tx));
+    add_sample(PING_REMOTE_RX_PATH, remote_rx_path);
+    add_sample(PING_REMOTE_TX_PATH, prev_remote_tx_path);
+    add_sample(PING_RX_PATH, pal_sub_time_us(i_ind, i_rx) + PING_RX_STAMP_OFFSET_US);
+    if (remote_rx_path != PING_INVALID)
+    {
+        /* Both paths refer to the same frame start on air. */
+        add_sample(PING_ONE_WAY, pal_sub_time_us(t_tx, t_req) + remote_rx_path);
+    }
+#else
+    if (rtt > turnaround)
+    {
+        add_sample(PING_ONE_WAY, (rtt - turnaround) / 2);
+    }
+#endif
+}
+
+
+/**
+ * @brief Stores a sample of a metric
+ *
+ * Samples beyond PING_MAX_SAMPLES and values marked as not measured are
+ * dropped.
+ *
+ * @param metric Metric of the sample
+ * @param value Latency in us
+ */
+static void add_sample(ping_metric_t metric, uint32_t value)
+{
+    if ((value == PING_INVALID) || (num_samples[metric] >= PING_MAX_SAMPLES))
+    {
+        return;
+    }
+
+    samples[metric][num_samples[metric]++] = limit_latency(value);
+}
+
+
+/**
+ * @brief Limits a latency to the range of the samples
+ *
+ * @param value Latency in us
+ *
+ * @return Latency, at most PING_INVALID - 1
+ */
+static uint16_t limit_latency(uint32_t value)
+{
+    if (value >= PING_INVALID)
+    {
+        return (PING_INVALID - 1);
+    }
+
+    return (uint16_t)value;
+}
+
+
+/**
+ * @brief Sorts the samples of a metric in ascending order
+ *
+ * @param values Samples
+ * @param count Number of samples
+ */
+static void sort_samples(uint16_t *values, uint16_t count)
+{
+    for (uint16_t i = 1; i < count; i++)
+    {
+        uint16_t value = values[i];
+        uint16_t j = i;
+
+        while ((j > 0) && (values[j - 1] > value))
+        {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = value;
+    }
+}
+
+/* EOF */
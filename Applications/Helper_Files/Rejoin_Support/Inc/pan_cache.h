@@ -0,0 +1,274 @@
+/**
+ * @file pan_cache.h
+ *
+ * @brief PAN descriptor cache and fast rejoin
+ *
+ * The cache holds the coordinators found by scans together with the age and
+ * the link quality of their last beacon, and the coordinator the device is
+ * associated to together with the short address assigned by it. With
+ * PAN_CACHE_PERSISTENT the cache is kept in the persistent storage of the
+ * PAL, so it survives a reset.
+ *
+ * After a reset or a loss of the coordinator, pan_rejoin_start() tries the
+ * cached information first and falls back to a scan only if it fails:
+ *
+ *  1. Poll:   the PIB is set to the cached association and a data request
+ *             is sent to the cached coordinator; its acknowledgment ends
+ *             the rejoin (nonbeacon-enabled PANs only).
+ *  2. Orphan: an orphan scan on the cached channels of the PAN; the
+ *             coordinator realignment of a coordinator still knowing the
+ *             device ends the rejoin.
+ *  3. Scan:   an active scan on the cached channels of the PAN, then on all
+ *             channels requested, followed by the association to the best
+ *             coordinator found; the coordinator the device was associated
+ *             to is preferred.
+ *
+ * The poll needs one frame exchange and the orphan scan the response wait
+ * time on each cached channel, whereas the active scan dwells on all
+ * channels requested. With MAC_FAST_SCAN the active scan ends at the first
+ * coordinator of the PAN permitting association.
+ *
+ * The module uses the MAC API only: the application forwards the confirms
+ * of the MAC to the pan_rejoin_*_conf() functions, which return true if the
+ * confirm belongs to the rejoin. After a rejoin by poll or orphan scan the
+ * MAC is not in the associated state; in nonbeacon-enabled PANs this only
+ * affects the handling of a disassociation notification.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAN_CACHE_H
+#define PAN_CACHE_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mac_api.h"
+
+/* === Macros =============================================================== */
+
+/** Number of coordinators held in the cache */
+#ifndef PAN_CACHE_SIZE
+#define PAN_CACHE_SIZE                  (4)
+#endif
+
+/**
+ * Keep the cache in the persistent storage (1) or in RAM only (0)
+ */
+#ifndef PAN_CACHE_PERSISTENT
+#define PAN_CACHE_PERSISTENT            (0)
+#endif
+
+/** Start address of the cache within the persistent storage */
+#ifndef PAN_CACHE_PS_ADDR
+#define PAN_CACHE_PS_ADDR               (0x0400)
+#endif
+
+/**
+ * Age after which a coordinator is no longer tried by poll or orphan scan
+ */
+#ifndef PAN_CACHE_MAX_AGE
+#define PAN_CACHE_MAX_AGE               (8)
+#endif
+
+/** Scan duration of the active scan on the cached channels */
+#ifndef PAN_REJOIN_CACHED_SCAN_DURATION
+#define PAN_REJOIN_CACHED_SCAN_DURATION (3)
+#endif
+
+/* === Types ================================================================ */
+
+/**
+ * Coordinator held in the cache
+ */
+typedef struct pan_cache_entry_tag
+{
+    /** Address of the coordinator and PAN Id */
+    wpan_addr_spec_t CoordAddrSpec;
+    /** Channel of the PAN */
+    uint8_t LogicalChannel;
+    /** Channel page of the PAN */
+    uint8_t ChannelPage;
+    /** Superframe specification of the last beacon */
+    uint16_t SuperframeSpec;
+    /** LQI of the beacons, averaged over the last ones */
+    uint8_t LinkQuality;
+    /**
+     * Number of resets and failed rejoins since the coordinator was seen
+     * last; 0 if it has been seen since the last reset
+     */
+    uint8_t age;
+} pan_cache_entry_t;
+
+/**
+ * Way the device has rejoined the PAN
+ */
+typedef enum pan_rejoin_path_tag
+{
+    /** Data request acknowledged by the cached coordinator */
+    PAN_REJOIN_POLL,
+    /** Coordinator realignment received in an orphan scan */
+    PAN_REJOIN_ORPHAN,
+    /** Association after an active scan */
+    PAN_REJOIN_SCAN
+} pan_rejoin_path_t;
+
+/**
+ * Callback indicating the end of a rejoin
+ *
+ * @param status MAC_SUCCESS if the device has rejoined, otherwise the
+ *               status of the last scan or of the association
+ * @param path Way the device has rejoined the PAN
+ * @param coordinator Coordinator the device has rejoined
+ * @param ShortAddress Short address of the device
+ */
+typedef void (*pan_rejoin_cb_t)(uint8_t status,
+                                pan_rejoin_path_t path,
+                                const pan_cache_entry_t *coordinator,
+                                uint16_t ShortAddress);
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the cache
+ *
+ * With PAN_CACHE_PERSISTENT the cache is read from the persistent storage
+ * and the age of all coordinators is incremented.
+ */
+void pan_cache_init(void);
+
+/**
+ * @brief Removes all coordinators and the association from the cache
+ *
+ * @return MAC_SUCCESS if the cleared cache is stored or PAN_CACHE_PERSISTENT
+ *         is 0, FAILURE if it cannot be written to the persistent storage
+ */
+retval_t pan_cache_clear(void);
+
+/**
+ * @brief Adds a coordinator to the cache or updates it
+ *
+ * Called for the PAN descriptors of scans and beacon notifications. If the
+ * cache is full, the oldest coordinator with the lowest link quality is
+ * replaced; the coordinator the device is associated to is kept.
+ *
+ * @param pan_desc PAN descriptor of the coordinator
+ */
+void pan_cache_update(const wpan_pandescriptor_t *pan_desc);
+
+/**
+ * @brief Stores the association of the device
+ *
+ * Called by applications associating on their own, after a successful
+ * association confirm.
+ *
+ * @param pan_desc PAN descriptor of the coordinator
+ * @param ShortAddress Short address assigned by the coordinator
+ *
+ * @return MAC_SUCCESS if the association is stored or PAN_CACHE_PERSISTENT
+ *         is 0, FAILURE if it cannot be written to the persistent storage;
+ *         the association is held in RAM in both cases
+ */
+retval_t pan_cache_joined(const wpan_pandescriptor_t *pan_desc, uint16_t ShortAddress);
+
+/**
+ * @brief Gets a coordinator of the cache
+ *
+ * @param index Index of the coordinator, 0 .. PAN_CACHE_SIZE - 1
+ *
+ * @return Pointer to the coordinator, NULL if the entry is not used
+ */
+const pan_cache_entry_t *pan_cache_get(uint8_t index);
+
+/**
+ * @brief Starts a rejoin
+ *
+ * The MAC needs to be idle, i.e. reset or not associated.
+ *
+ * @param PANId PAN Id of the PAN to join, BROADCAST for any PAN
+ * @param ScanChannels Channels of the fallback scan
+ * @param ScanDuration Scan duration of the fallback scan
+ * @param ChannelPage Channel page of the fallback scan
+ * @param CapabilityInformation Capabilities of the device for the
+ *                              association
+ * @param cb Callback indicating the end of the rejoin
+ *
+ * @return true if the rejoin is started
+ */
+bool pan_rejoin_start(uint16_t PANId,
+                      uint32_t ScanChannels,
+                      uint8_t ScanDuration,
+                      uint8_t ChannelPage,
+                      uint8_t CapabilityInformation,
+                      pan_rejoin_cb_t cb);
+
+/**
+ * @brief Checks whether a rejoin is ongoing
+ *
+ * @return true if a rejoin is ongoing
+ */
+bool pan_rejoin_busy(void);
+
+/**
+ * @brief Handles a scan confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_scan_conf(uint8_t status,
+                          uint8_t ScanType,
+                          uint8_t ChannelPage,
+                          uint32_t UnscannedChannels,
+                          uint8_t ResultListSize,
+                          void *ResultList);
+
+/**
+ * @brief Handles an association confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_associate_conf(uint16_t AssocShortAddress, uint8_t status);
+
+/**
+ * @brief Handles a poll confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_poll_conf(uint8_t status);
+
+/**
+ * @brief Handles a set confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_set_conf(uint8_t status, uint8_t PIBAttribute);
+
+/**
+ * @brief Handles a get confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_get_conf(uint8_t status, uint8_t PIBAttribute, void *PIBAttributeValue);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PAN_CACHE_H */
+/* EOF */
@@ -0,0 +1,1103 @@
+/**
+ * @file pan_cache.c
+ *
+ * @brief PAN descriptor cache and fast rejoin
+ *
+ * Layout of the cache within the persistent storage:
+ *     magic (2) | cache size (1) | checksum (1) | short address (2) |
+ *     index of the coordinator associated to (1) | coordinators
+ *
+ * The cache is written when the association changes and at the end of a
+ * rejoin; the PAL writes changed octets only.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "return_val.h"
+#include "ieee_const.h"
+#include "mac_api.h"
+#include "pan_cache.h"
+
+/* === Macros ============================================================== */
+
+/* Index value of no coordinator */
+#define NO_ENTRY                        (0xFF)
+
+/* Identifier of the cache within the persistent storage */
+#define PS_MAGIC                        (0x5043)
+
+/* Length of the header of the cache within the persistent storage */
+#define PS_HEADER_LEN                   (4)
+
+/* Addresses of the parts of the cache within the persistent storage */
+#define PS_SHORT_ADDR_ADDR              (PAN_CACHE_PS_ADDR + PS_HEADER_LEN)
+#define PS_MEMBER_ADDR                  (PS_SHORT_ADDR_ADDR + sizeof(uint16_t))
+#define PS_ENTRIES_ADDR                 (PS_MEMBER_ADDR + sizeof(uint8_t))
+
+/* Beacon order of a superframe specification */
+#define SF_BEACON_ORDER(spec)           ((uint8_t)((spec) & 0x000F))
+
+/* Number of PIB attributes read after an orphan scan */
+#define ORPHAN_GET_ATTRIBUTES           (4)
+
+#if (PAN_CACHE_SIZE >= NO_ENTRY)
+#error "PAN_CACHE_SIZE is too large"
+#endif
+
+/* === Types =============================================================== */
+
+/* Steps of a rejoin */
+typedef enum rejoin_state_tag
+{
+    REJOIN_IDLE,
+    REJOIN_POLL_SET,
+    REJOIN_POLL,
+    REJOIN_ORPHAN,
+    REJOIN_ORPHAN_GET,
+    REJOIN_SCAN_CACHED,
+    REJOIN_SCAN_ALL,
+    REJOIN_ASSOCIATE
+} rejoin_state_t;
+
+/* === Globals ============================================================= */
+
+/* Coordinators held in the cache; AddrMode is WPAN_ADDRMODE_NONE if unused */
+static pan_cache_entry_t cache[PAN_CACHE_SIZE];
+
+/* Coordinator the device is associated to, NO_ENTRY if none */
+static uint8_t member;
+
+/* Short address assigned by this coordinator */
+static uint16_t member_short_addr;
+
+/* Parameters of the current rejoin */
+static rejoin_state_t rejoin_state = REJOIN_IDLE;
+static uint16_t rejoin_pan_id;
+static uint32_t rejoin_channels;
+static uint8_t rejoin_duration;
+static uint8_t rejoin_page;
+static uint8_t rejoin_capability;
+static pan_rejoin_cb_t rejoin_cb;
+
+/* Set or get confirms outstanding */
+static uint8_t rejoin_pending;
+
+/* A set or get request of the current step has failed. */
+static bool rejoin_failed;
+
+/* Coordinator association has been requested from */
+static wpan_pandescriptor_t rejoin_candidate;
+
+/* The candidate has been found by the scan on the cached channels. */
+static bool rejoin_scan_cached;
+
+/* PIB attributes read after an orphan scan */
+static uint16_t orphan_pan_id;
+static uint16_t orphan_short_addr;
+static uint16_t orphan_coord_short_addr;
+static uint8_t orphan_channel;
+
+/* === Prototypes ========================================================== */
+
+static bool same_coordinator(const wpan_addr_spec_t *a, const wpan_addr_spec_t *b);
+static bool pan_matches(uint16_t pan_id);
+static uint8_t find_entry(const wpan_addr_spec_t *addr);
+static uint32_t cached_channels(uint8_t page, bool all_ages);
+static void age_entries(uint32_t channels, uint8_t page);
+static void cache_load(void);
+static retval_t cache_save(void);
+#if (PAN_CACHE_PERSISTENT == 1)
+static uint8_t cache_checksum(void);
+#endif  /* (PAN_CACHE_PERSISTENT == 1) */
+static void poll_start(void);
+static void poll_request(void);
+static void orphan_start(void);
+static void orphan_done(void);
+static void scan_cached_start(void);
+static void scan_all_start(void);
+static void fast_scan_set(bool enable);
+static void rejoin_end(uint8_t status, pan_rejoin_path_t path);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the cache
+ */
+void pan_cache_init(void)
+{
+    uint8_t i;
+
+    memset(cache, 0, sizeof(cache));
+    member = NO_ENTRY;
+    member_short_addr = BROADCAST;
+    rejoin_state = REJOIN_IDLE;
+
+    cache_load();
+
+    /* A reset has passed since the coordinators were seen. */
+    for (i = 0; i < PAN_CACHE_SIZE; i++)
+    {
+        if ((WPAN_ADDRMODE_NONE != cache[i].CoordAddrSpec.AddrMode) &&
+            (cache[i].age < 0xFF))
+        {
+            cache[i].age++;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Removes all coordinators and the association from the cache
+ *
+ * @return MAC_SUCCESS if the cleared cache is stored, FAILURE otherwise
+ */
+retval_t pan_cache_clear(void)
+{
+    memset(cache, 0, sizeof(cache));
+    member = NO_ENTRY;
+    member_short_addr = BROADCAST;
+
+    return cache_save();
+}
+
+
+
+/**
+ * @brief Adds a coordinator to the cache or updates it
+ *
+ * @param pan_desc PAN descriptor of the coordinator
+ */
+void pan_cache_update(const wpan_pandescriptor_t *pan_desc)
+{
+    pan_cache_entry_t *entry;
+    uint8_t index;
+    uint8_t i;
+
+    index = find_entry(&pan_desc->CoordAddrSpec);
+
+    if (NO_ENTRY != index)
+    {
+        entry = &cache[index];
+        entry->LinkQuality = (uint8_t)(((uint16_t)entry->LinkQuality +
+                                        pan_desc->LinkQuality + 1) / 2);
+    }
+    else
+    {
+        /*
+         * Use a free entry or replace the oldest coordinator with the lowest
+         * link quality, except the one the device is associated to.
+         */
+        for (i = 0; i < PAN_CACHE_SIZE; i++)
+        {
+            if (WPAN_ADDRMODE_NONE == cache[i].CoordAddrSpec.AddrMode)
+            {
+                index = i;
+                break;
+            }
+
+            if ((i != member) &&
+                ((NO_ENTRY == index) ||
+                 (cache[i].age > cache[index].age) ||
+                 ((cache[i].age == cache[index].age) &&
+                  (cache[i].LinkQuality < cache[index].LinkQuality))))
+            {
+                index = i;
+            }
+        }
+
+        if (NO_ENTRY == index)
+        {
+            /* The cache holds the coordinator associated to only. */
+            return;
+        }
+
+        entry = &cache[index];
+        entry->CoordAddrSpec = pan_desc->CoordAddrSpec;
+        entry->LinkQuality = pan_desc->LinkQuality;
+    }
+
+    entry->LogicalChannel = pan_desc->LogicalChannel;
+    entry->ChannelPage = pan_desc->ChannelPage;
+    entry->SuperframeSpec = pan_desc->SuperframeSpec;
+    entry->age = 0;
+}
+
+
+
+/**
+ * @brief Stores the association of the device
+ *
+ * @param pan_desc PAN descriptor of the coordinator
+ * @param ShortAddress Short address assigned by the coordinator
+ *
+ * @return MAC_SUCCESS if the association is stored, FAILURE otherwise
+ */
+retval_t pan_cache_joined(const wpan_pandescriptor_t *pan_desc, uint16_t ShortAddress)
+{
+    /* The old association is dropped first, so its entry may be replaced. */
+    member = NO_ENTRY;
+
+    pan_cache_update(pan_desc);
+
+    member = find_entry(&pan_desc->CoordAddrSpec);
+    member_short_addr = ShortAddress;
+
+    return cache_save();
+}
+
+
+
+/**
+ * @brief Gets a coordinator of the cache
+ *
+ * @param index Index of the coordinator
+ *
+ * @return Pointer to the coordinator, NULL if the entry is not used
+ */
+const pan_cache_entry_t *pan_cache_get(uint8_t index)
+{
+    if ((index >= PAN_CACHE_SIZE) ||
+        (WPAN_ADDRMODE_NONE == cache[index].CoordAddrSpec.AddrMode))
+    {
+        return NULL;
+    }
+
+    return &cache[index];
+}
+
+
+
+/**
+ * @brief Starts a rejoin
+ *
+ * @return true if the rejoin is started
+ */
+bool pan_rejoin_start(uint16_t PANId,
+                      uint32_t ScanChannels,
+                      uint8_t ScanDuration,
+                      uint8_t ChannelPage,
+                      uint8_t CapabilityInformation,
+                      pan_rejoin_cb_t cb)
+{
+    if ((REJOIN_IDLE != rejoin_state) || (NULL == cb))
+    {
+        return false;
+    }
+
+    rejoin_pan_id = PANId;
+    rejoin_channels = ScanChannels;
+    rejoin_duration = ScanDuration;
+    rejoin_page = ChannelPage;
+    rejoin_capability = CapabilityInformation;
+    rejoin_cb = cb;
+
+    poll_start();
+
+    return true;
+}
+
+
+
+/**
+ * @brief Checks whether a rejoin is ongoing
+ *
+ * @return true if a rejoin is ongoing
+ */
+bool pan_rejoin_busy(void)
+{
+    return (REJOIN_IDLE != rejoin_state);
+}
+
+
+
+/**
+ * @brief Handles a scan confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_scan_conf(uint8_t status,
+                          uint8_t ScanType,
+                          uint8_t ChannelPage,
+                          uint32_t UnscannedChannels,
+                          uint8_t ResultListSize,
+                          void *ResultList)
+{
+    wpan_pandescriptor_t *pan_desc;
+    wpan_pandescriptor_t *best = NULL;
+    bool best_is_member = false;
+    uint8_t i;
+
+    if (REJOIN_ORPHAN == rejoin_state)
+    {
+        if (MAC_SUCCESS == status)
+        {
+            orphan_done();
+        }
+        else
+        {
+            scan_cached_start();
+        }
+        return true;
+    }
+
+    if ((REJOIN_SCAN_CACHED != rejoin_state) && (REJOIN_SCAN_ALL != rejoin_state))
+    {
+        return false;
+    }
+
+    fast_scan_set(false);
+
+    if (MAC_SUCCESS == status)
+    {
+        pan_desc = (wpan_pandescriptor_t *)ResultList;
+
+        for (i = 0; i < ResultListSize; i++, pan_desc++)
+        {
+            pan_cache_update(pan_desc);
+
+            if (!pan_matches(pan_desc->CoordAddrSpec.PANId) ||
+                !(pan_desc->SuperframeSpec & ((uint16_t)1 << ASSOC_PERMIT_BIT_POS)))
+            {
+                continue;
+            }
+
+            /*
+             * The coordinator the device was associated to is preferred,
+             * otherwise the one with the best link.
+             */
+            if ((NO_ENTRY != member) &&
+                same_coordinator(&pan_desc->CoordAddrSpec, &cache[member].CoordAddrSpec))
+            {
+                best = pan_desc;
+                best_is_member = true;
+            }
+            else if (!best_is_member &&
+                     ((NULL == best) || (pan_desc->LinkQuality > best->LinkQuality)))
+            {
+                best = pan_desc;
+            }
+        }
+    }
+
+    if (NULL != best)
+    {
+        rejoin_candidate = *best;
+
+        if (wpan_mlme_associate_req(rejoin_candidate.LogicalChannel,
+                                    rejoin_candidate.ChannelPage,
+                                    &rejoin_candidate.CoordAddrSpec,
+                                    rejoin_capability))
+        {
+            rejoin_scan_cached = (REJOIN_SCAN_CACHED == rejoin_state);
+            rejoin_state = REJOIN_ASSOCIATE;
+            return true;
+        }
+
+        status = FAILURE;
+    }
+    else if (MAC_SUCCESS == status)
+    {
+        status = MAC_NO_BEACON;
+    }
+
+    if (REJOIN_SCAN_CACHED == rejoin_state)
+    {
+        scan_all_start();
+    }
+    else
+    {
+        rejoin_end(status, PAN_REJOIN_SCAN);
+    }
+
+    /* Keep compiler happy. */
+    ScanType = ScanType;
+    ChannelPage = ChannelPage;
+    UnscannedChannels = UnscannedChannels;
+
+    return true;
+}
+
+
+
+/**
+ * @brief Handles an association confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_associate_conf(uint16_t AssocShortAddress, uint8_t status)
+{
+    if (REJOIN_ASSOCIATE != rejoin_state)
+    {
+        return false;
+    }
+
+    if (MAC_SUCCESS == status)
+    {
+        /* The device is associated even if the cache cannot be stored. */
+        pan_cache_joined(&rejoin_candidate, AssocShortAddress);
+        rejoin_end(MAC_SUCCESS, PAN_REJOIN_SCAN);
+    }
+    else if (rejoin_scan_cached)
+    {
+        /* Another coordinator may be found on the remaining channels. */
+        scan_all_start();
+    }
+    else
+    {
+        rejoin_end(status, PAN_REJOIN_SCAN);
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Handles a poll confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_poll_conf(uint8_t status)
+{
+    if (REJOIN_POLL != rejoin_state)
+    {
+        return false;
+    }
+
+    /* The coordinator has acknowledged the data request. */
+    if ((MAC_SUCCESS == status) || (MAC_NO_DATA == status))
+    {
+        cache[member].age = 0;
+        rejoin_end(MAC_SUCCESS, PAN_REJOIN_POLL);
+    }
+    else
+    {
+        if (cache[member].age < 0xFF)
+        {
+            cache[member].age++;
+        }
+        orphan_start();
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Handles a set confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_set_conf(uint8_t status, uint8_t PIBAttribute)
+{
+    if (REJOIN_POLL_SET != rejoin_state)
+    {
+        return false;
+    }
+
+    if (MAC_SUCCESS != status)
+    {
+        rejoin_failed = true;
+    }
+
+    if (--rejoin_pending == 0)
+    {
+        if (rejoin_failed)
+        {
+            orphan_start();
+        }
+        else
+        {
+            poll_request();
+        }
+    }
+
+    PIBAttribute = PIBAttribute;    /* Keep compiler happy. */
+
+    return true;
+}
+
+
+
+/**
+ * @brief Handles a get confirm
+ *
+ * @return true if the confirm belongs to the rejoin
+ */
+bool pan_rejoin_get_conf(uint8_t status, uint8_t PIBAttribute, void *PIBAttributeValue)
+{
+    if (REJOIN_ORPHAN_GET != rejoin_state)
+    {
+        return false;
+    }
+
+    if (MAC_SUCCESS == status)
+    {
+        switch (PIBAttribute)
+        {
+            case macPANId:
+                memcpy(&orphan_pan_id, PIBAttributeValue, sizeof(orphan_pan_id));
+                break;
+
+            case macShortAddress:
+                memcpy(&orphan_short_addr, PIBAttributeValue, sizeof(orphan_short_addr));
+                break;
+
+            case macCoordShortAddress:
+                memcpy(&orphan_coord_short_addr, PIBAttributeValue,
+                       sizeof(orphan_coord_short_addr));
+                break;
+
+            case phyCurrentChannel:
+                orphan_channel = *(uint8_t *)PIBAttributeValue;
+                break;
+
+            default:
+                break;
+        }
+    }
+    else
+    {
+        rejoin_failed = true;
+    }
+
+    if (--rejoin_pending == 0)
+    {
+        orphan_done();
+    }
+
+    return true;
+}
+
+
+
+/*
+ * @brief Compares the addresses of two coordinators
+ *
+ * @return true if both addresses and PAN Ids are equal
+ */
+static bool same_coordinator(const wpan_addr_spec_t *a, const wpan_addr_spec_t *b)
+{
+    if ((a->AddrMode != b->AddrMode) || (a->PANId != b->PANId))
+    {
+        return false;
+    }
+
+    if (WPAN_ADDRMODE_SHORT == a->AddrMode)
+    {
+        return (a->Addr.short_address == b->Addr.short_address);
+    }
+
+    return (a->Addr.long_address == b->Addr.long_address);
+}
+
+
+
+/*
+ * @brief Checks whether a PAN Id is the one of the rejoin
+ */
+static bool pan_matches(uint16_t pan_id)
+{
+    return ((BROADCAST == rejoin_pan_id) || (pan_id == rejoin_pan_id));
+}
+
+
+
+/*
+ * @brief Finds a coordinator in the cache
+ *
+ * @return Index of the coordinator, NO_ENTRY if it is not cached
+ */
+static uint8_t find_entry(const wpan_addr_spec_t *addr)
+{
+    uint8_t i;
+
+    for (i = 0; i < PAN_CACHE_SIZE; i++)
+    {
+        if ((WPAN_ADDRMODE_NONE != cache[i].CoordAddrSpec.AddrMode) &&
+            same_coordinator(&cache[i].CoordAddrSpec, addr))
+        {
+            return i;
+        }
+    }
+
+    return NO_ENTRY;
+}
+
+
+
+/*
+ * @brief Gets the channels of the cached coordinators of the PAN
+ *
+ * @param page Channel page
+ * @param all_ages false to leave out coordinators older than
+ *                 PAN_CACHE_MAX_AGE
+ *
+ * @return Bit mask of the channels
+ */
+static uint32_t cached_channels(uint8_t page, bool all_ages)
+{
+    uint32_t channels = 0;
+    uint8_t i;
+
+    for (i = 0; i < PAN_CACHE_SIZE; i++)
+    {
+        if ((WPAN_ADDRMODE_NONE != cache[i].CoordAddrSpec.AddrMode) &&
+            pan_matches(cache[i].CoordAddrSpec.PANId) &&
+            (cache[i].ChannelPage == page) &&
+            (all_ages || (cache[i].age <= PAN_CACHE_MAX_AGE)))
+        {
+            channels |= 1UL << cache[i].LogicalChannel;
+        }
+    }
+
+    return channels;
+}
+
+
+
+/*
+ * @brief Increments the age of the cached coordinators of the PAN
+ *
+ * Coordinators found by the following scan are set to age 0 again.
+ *
+ * @param channels Channels scanned
+ * @param page Channel page scanned
+ */
+static void age_entries(uint32_t channels, uint8_t page)
+{
+    uint8_t i;
+
+    for (i = 0; i < PAN_CACHE_SIZE; i++)
+    {
+        if ((WPAN_ADDRMODE_NONE != cache[i].CoordAddrSpec.AddrMode) &&
+            pan_matches(cache[i].CoordAddrSpec.PANId) &&
+            (cache[i].ChannelPage == page) &&
+            (channels & (1UL << cache[i].LogicalChannel)) &&
+            (cache[i].age < 0xFF))
+        {
+            cache[i].age++;
+        }
+    }
+}
+
+
+
+/*
+ * @brief Reads the cache from the persistent storage
+ *
+ * The cache is empty if it cannot be read completely.
+ */
+static void cache_load(void)
+{
+#if (PAN_CACHE_PERSISTENT == 1)
+    uint8_t header[PS_HEADER_LEN];
+
+    if ((MAC_SUCCESS != pal_ps_get(INTERN_EEPROM, PAN_CACHE_PS_ADDR,
+                                   PS_HEADER_LEN, header)) ||
+        (header[0] != (uint8_t)PS_MAGIC) ||
+        (header[1] != (uint8_t)(PS_MAGIC >> 8)) ||
+        (header[2] != PAN_CACHE_SIZE))
+    {
+        /*
+         * No persistent storage, no cache stored, or stored with a
+         * different size; the cache has been cleared by pan_cache_init().
+         */
+        return;
+    }
+
+    if ((MAC_SUCCESS != pal_ps_get(INTERN_EEPROM, PS_SHORT_ADDR_ADDR,
+                                   sizeof(member_short_addr), &member_short_addr)) ||
+        (MAC_SUCCESS != pal_ps_get(INTERN_EEPROM, PS_MEMBER_ADDR,
+                                   sizeof(member), &member)) ||
+        (MAC_SUCCESS != pal_ps_get(INTERN_EEPROM, PS_ENTRIES_ADDR,
+                                   sizeof(cache), cache)) ||
+        (header[3] != cache_checksum()) ||
+        ((NO_ENTRY != member) &&
+         ((member >= PAN_CACHE_SIZE) ||
+          (WPAN_ADDRMODE_NONE == cache[member].CoordAddrSpec.AddrMode))))
+    {
+        /* Read failure or interrupted write */
+        memset(cache, 0, sizeof(cache));
+        member = NO_ENTRY;
+        member_short_addr = BROADCAST;
+    }
+#endif  /* (PAN_CACHE_PERSISTENT == 1) */
+}
+
+
+
+/*
+ * @brief Writes the cache to the persistent storage
+ *
+ * The header is written last, so a partly written cache does not match the
+ * stored checksum and is discarded by the next cache_load().
+ *
+ * @return MAC_SUCCESS if the cache is stored or PAN_CACHE_PERSISTENT is 0,
+ *         FAILURE otherwise
+ */
+static retval_t cache_save(void)
+{
+#if (PAN_CACHE_PERSISTENT == 1)
+    uint8_t header[PS_HEADER_LEN];
+
+    header[0] = (uint8_t)PS_MAGIC;
+    header[1] = (uint8_t)(PS_MAGIC >> 8);
+    header[2] = PAN_CACHE_SIZE;
+    header[3] = cache_checksum();
+
+    if ((MAC_SUCCESS != pal_ps_set(PS_SHORT_ADDR_ADDR,
+                                   sizeof(member_short_addr), &member_short_addr)) ||
+        (MAC_SUCCESS != pal_ps_set(PS_MEMBER_ADDR, sizeof(member), &member)) ||
+        (MAC_SUCCESS != pal_ps_set(PS_ENTRIES_ADDR, sizeof(cache), cache)) ||
+        (MAC_SUCCESS != pal_ps_set(PAN_CACHE_PS_ADDR, PS_HEADER_LEN, header)))
+    {
+        return FAILURE;
+    }
+#endif  /* (PAN_CACHE_PERSISTENT == 1) */
+
+    return MAC_SUCCESS;
+}
+
+
+
+#if (PAN_CACHE_PERSISTENT == 1)
+/*
+ * @brief Calculates the checksum of the cache
+ *
+ * @return Sum of all octets of the cache
+ */
+static uint8_t cache_checksum(void)
+{
+    uint8_t *ptr = (uint8_t *)cache;
+    uint8_t sum = member + (uint8_t)member_short_addr + (uint8_t)(member_short_addr >> 8);
+    uint16_t i;
+
+    for (i = 0; i < sizeof(cache); i++)
+    {
+        sum += ptr[i];
+    }
+
+    return sum;
+}
+#endif  /* (PAN_CACHE_PERSISTENT == 1) */
+
+
+
+/*
+ * @brief Starts the rejoin by a data request to the cached coordinator
+ *
+ * The PIB is set to the cached association before, the poll is requested
+ * once all set requests are confirmed.
+ */
+static void poll_start(void)
+{
+    pan_cache_entry_t *coord;
+    uint8_t attributes = 0;
+
+    if ((NO_ENTRY == member) ||
+        !pan_matches(cache[member].CoordAddrSpec.PANId) ||
+        (cache[member].age > PAN_CACHE_MAX_AGE) ||
+        (NON_BEACON_NWK != SF_BEACON_ORDER(cache[member].SuperframeSpec)))
+    {
+        orphan_start();
+        return;
+    }
+
+    coord = &cache[member];
+
+    attributes += wpan_mlme_set_req(phyCurrentPage, &coord->ChannelPage);
+    attributes += wpan_mlme_set_req(phyCurrentChannel, &coord->LogicalChannel);
+    attributes += wpan_mlme_set_req(macPANId, &coord->CoordAddrSpec.PANId);
+    if (WPAN_ADDRMODE_SHORT == coord->CoordAddrSpec.AddrMode)
+    {
+        attributes += wpan_mlme_set_req(macCoordShortAddress,
+                                        &coord->CoordAddrSpec.Addr.short_address);
+    }
+    else
+    {
+        attributes += wpan_mlme_set_req(macCoordExtendedAddress,
+                                        &coord->CoordAddrSpec.Addr.long_address);
+    }
+    attributes += wpan_mlme_set_req(macShortAddress, &member_short_addr);
+
+    if (attributes == 0)
+    {
+        orphan_start();
+        return;
+    }
+
+    /* A set request not queued counts as failed. */
+    rejoin_failed = (attributes < 5);
+    rejoin_pending = attributes;
+    rejoin_state = REJOIN_POLL_SET;
+}
+
+
+
+/*
+ * @brief Requests the poll of the cached coordinator
+ */
+static void poll_request(void)
+{
+    if (wpan_mlme_poll_req(&cache[member].CoordAddrSpec))
+    {
+        rejoin_state = REJOIN_POLL;
+    }
+    else
+    {
+        orphan_start();
+    }
+}
+
+
+
+/*
+ * @brief Starts the rejoin by an orphan scan on the cached channels
+ */
+static void orphan_start(void)
+{
+    uint32_t channels;
+    uint8_t page;
+
+    page = (NO_ENTRY != member) ? cache[member].ChannelPage : rejoin_page;
+    channels = cached_channels(page, false);
+
+    if ((channels != 0) &&
+        wpan_mlme_scan_req(MLME_SCAN_TYPE_ORPHAN, channels, 0, page))
+    {
+        rejoin_page = page;
+        rejoin_state = REJOIN_ORPHAN;
+    }
+    else
+    {
+        scan_cached_start();
+    }
+}
+
+
+
+/*
+ * @brief Handles the successful orphan scan
+ *
+ * The MAC has taken the PIB attributes of the coordinator realignment; they
+ * are read before the rejoin ends.
+ */
+static void orphan_done(void)
+{
+    wpan_pandescriptor_t pan_desc;
+    uint8_t index = NO_ENTRY;
+    uint8_t i;
+
+    if (REJOIN_ORPHAN == rejoin_state)
+    {
+        uint8_t attributes = 0;
+
+        rejoin_failed = false;
+        attributes += wpan_mlme_get_req(macPANId);
+        attributes += wpan_mlme_get_req(macShortAddress);
+        attributes += wpan_mlme_get_req(macCoordShortAddress);
+        attributes += wpan_mlme_get_req(phyCurrentChannel);
+
+        if (attributes != 0)
+        {
+            rejoin_failed = (attributes < ORPHAN_GET_ATTRIBUTES);
+            rejoin_pending = attributes;
+            rejoin_state = REJOIN_ORPHAN_GET;
+            return;
+        }
+
+        rejoin_failed = true;
+    }
+
+    if (rejoin_failed)
+    {
+        /* The realignment is not known. */
+        scan_cached_start();
+        return;
+    }
+
+    /*
+     * The realignment has been sent by the coordinator the device was
+     * associated to, or else by a cached coordinator of the PAN.
+     */
+    if ((NO_ENTRY != member) &&
+        (cache[member].CoordAddrSpec.PANId == orphan_pan_id))
+    {
+        index = member;
+    }
+    else
+    {
+        for (i = 0; i < PAN_CACHE_SIZE; i++)
+        {
+            if ((WPAN_ADDRMODE_NONE != cache[i].CoordAddrSpec.AddrMode) &&
+                (cache[i].CoordAddrSpec.PANId == orphan_pan_id) &&
+                (cache[i].LogicalChannel == orphan_channel) &&
+                ((NO_ENTRY == index) || (cache[i].age < cache[index].age)))
+            {
+                index = i;
+            }
+        }
+    }
+
+    if (NO_ENTRY != index)
+    {
+        pan_desc.CoordAddrSpec = cache[index].CoordAddrSpec;
+        pan_desc.SuperframeSpec = cache[index].SuperframeSpec;
+        pan_desc.LinkQuality = cache[index].LinkQuality;
+    }
+    else
+    {
+        pan_desc.CoordAddrSpec.AddrMode = WPAN_ADDRMODE_SHORT;
+        pan_desc.CoordAddrSpec.PANId = orphan_pan_id;
+        pan_desc.SuperframeSpec = NON_BEACON_NWK;
+        pan_desc.LinkQuality = 0;
+    }
+
+    if (WPAN_ADDRMODE_SHORT == pan_desc.CoordAddrSpec.AddrMode)
+    {
+        pan_desc.CoordAddrSpec.Addr.short_address = orphan_coord_short_addr;
+    }
+    pan_desc.LogicalChannel = orphan_channel;
+    pan_desc.ChannelPage = rejoin_page;
+
+    if ((NO_ENTRY != index) &&
+        !same_coordinator(&pan_desc.CoordAddrSpec, &cache[index].CoordAddrSpec))
+    {
+        /* The coordinator has got a new short address. */
+        memset(&cache[index], 0, sizeof(cache[index]));
+    }
+
+    /*
+     * The LQI of the realignment is not known; the cached one is kept.
+     * The device is associated even if the cache cannot be stored.
+     */
+    pan_cache_joined(&pan_desc, orphan_short_addr);
+
+    rejoin_end(MAC_SUCCESS, PAN_REJOIN_ORPHAN);
+}
+
+
+
+/*
+ * @brief Starts an active scan on the cached channels of the PAN
+ */
+static void scan_cached_start(void)
+{
+    uint32_t channels = cached_channels(rejoin_page, true);
+
+    if (channels == 0)
+    {
+        scan_all_start();
+        return;
+    }
+
+    age_entries(channels, rejoin_page);
+    fast_scan_set(true);
+
+    if (wpan_mlme_scan_req(MLME_SCAN_TYPE_ACTIVE,
+                           channels,
+                           PAN_REJOIN_CACHED_SCAN_DURATION,
+                           rejoin_page))
+    {
+        rejoin_state = REJOIN_SCAN_CACHED;
+    }
+    else
+    {
+        fast_scan_set(false);
+        scan_all_start();
+    }
+}
+
+
+
+/*
+ * @brief Starts an active scan on all channels of the rejoin
+ */
+static void scan_all_start(void)
+{
+    fast_scan_set(true);
+
+    if (wpan_mlme_scan_req(MLME_SCAN_TYPE_ACTIVE,
+                           rejoin_channels,
+                           rejoin_duration,
+                           rejoin_page))
+    {
+        rejoin_state = REJOIN_SCAN_ALL;
+    }
+    else
+    {
+        fast_scan_set(false);
+        rejoin_end(FAILURE, PAN_REJOIN_SCAN);
+    }
+}
+
+
+
+/*
+ * @brief Configures the fast scan of the MAC for the active scans
+ *
+ * @param enable true to end the scan at the first coordinator of the PAN
+ *               permitting association, false for the standard scan
+ */
+static void fast_scan_set(bool enable)
+{
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+    wpan_fast_scan_config_t config;
+
+    memset(&config, 0, sizeof(config));
+
+    if (enable)
+    {
+        config.stop_at_first_pan = true;
+        config.pan_id = rejoin_pan_id;
+        config.association_permit = true;
+    }
+
+    wpan_fast_scan_config(&config);
+#else
+    enable = enable;    /* Keep compiler happy. */
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+}
+
+
+
+/*
+ * @brief Ends the rejoin
+ *
+ * @param status Result of the rejoin
+ * @param path Way the device has rejoined the PAN
+ */
+static void rejoin_end(uint8_t status, pan_rejoin_path_t path)
+{
+    rejoin_state = REJOIN_IDLE;
+
+    cache_save();
+
+    if (MAC_SUCCESS == status)
+    {
+        rejoin_cb(status, path, &cache[member], member_short_addr);
+    }
+    else
+    {
+        rejoin_cb(status, path, NULL, BROADCAST);
+    }
+}
+
+/* EOF */
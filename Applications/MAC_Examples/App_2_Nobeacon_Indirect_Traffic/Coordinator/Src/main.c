@@ -419,6 +419,34 @@ void usr_mlme_comm_status_ind(wpan_addr_spec_t *SrcAddrSpec,
 
 
 
+/**
+ * @brief Callback function usr_mlme_orphan_ind
+ *
+ * @param OrphanAddress Extended address of the orphaned device
+ */
+void usr_mlme_orphan_ind(uint64_t OrphanAddress)
+{
+    uint8_t i;
+
+    /*
+     * A device associated before has lost its coordinator, e.g. by a reset,
+     * and rejoins by an orphan scan. Only a device found in the device list
+     * is realigned.
+     * This response leads to comm status indication -> usr_mlme_comm_status_ind
+     */
+    for (i = 0; i < MAX_NUMBER_OF_DEVICES; i++)
+    {
+        if ((device_list[i].short_addr != 0x0000) &&
+            (device_list[i].ieee_addr == OrphanAddress))
+        {
+            wpan_mlme_orphan_resp(OrphanAddress, device_list[i].short_addr, true);
+            return;
+        }
+    }
+}
+
+
+
 /**
  * Callback function usr_mcps_data_conf
  *
@@ -136,6 +136,12 @@ typedef enum
 /* Offset of IEEE address storage location within EEPROM */
 #define EE_IEEE_ADDR                (0)
 
+/* Keep the PAN descriptor cache in the EEPROM, so a reset rejoins fast */
+#define PAN_CACHE_PERSISTENT        (1)
+
+/* Offset of the PAN descriptor cache within EEPROM */
+#define PAN_CACHE_PS_ADDR           (0x0400)
+
 /* === Externals ============================================================ */
 
 
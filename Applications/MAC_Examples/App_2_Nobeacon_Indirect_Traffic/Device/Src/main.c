@@ -6,6 +6,8 @@
  * This is the source code of a simple MAC example. It implements the
  * firmware for all devices of a network with star topology
  * polling for indirect data at the coordinator.
+ * After a reset, the device rejoins the coordinator it was associated to
+ * via the PAN descriptor cache and scans only if this fails.
  *
  * $Id: main.c 22900 2010-08-12 11:12:17Z sschneid $
  *
@@ -31,6 +33,7 @@
 #include "mac_api.h"
 #include "app_config.h"
 #include "ieee_const.h"
+#include "pan_cache.h"
 
 /* === TYPES =============================================================== */
 
@@ -61,6 +64,9 @@
 /** This is the time period in micro seconds for polling transmissions. */
 #define APP_POLL_PERIOD_MS              (5000)
 
+/** Number of polls without acknowledgment after which the device rejoins. */
+#define APP_MAX_POLL_FAILURES           (3)
+
 /** Defines the bit mask of channels that should be scanned. */
 #if (TAL_TYPE == AT86RF212)
     #if (DEFAULT_CHANNEL == 0)
@@ -92,14 +98,21 @@
 
 /* === GLOBALS ============================================================= */
 
-/** This structure stores the short address of the coordinator. */
-static uint16_t coord_addr;
+/** This structure stores the address of the coordinator. */
+static wpan_addr_spec_t coord_addr_spec;
+/** This variable counts the polls without acknowledgment in a row. */
+static uint8_t poll_failures;
 /** This variable counts the number of received data frames. */
 static uint32_t rx_cnt;
 
 /* === PROTOTYPES ========================================================== */
 
 static void app_initiate_polling(void *parameter);
+static void start_rejoin(uint8_t scan_duration);
+static void rejoin_cb(uint8_t status,
+                      pan_rejoin_path_t path,
+                      const pan_cache_entry_t *coordinator,
+                      uint16_t ShortAddress);
 static void network_search_indication_cb(void *parameter);
 static void rx_data_led_off_cb(void *parameter);
 
@@ -121,6 +134,9 @@ int main(void)
         pal_alert();
     }
 
+    /* Read the coordinators found before the reset. */
+    pan_cache_init();
+
     /* Initialize LEDs. */
     pal_led_init();
     pal_led(LED_START, LED_ON);         // indicating application is started
@@ -172,25 +188,11 @@ void usr_mlme_reset_conf(uint8_t status)
 {
     if (status == MAC_SUCCESS)
     {
-        printf("Searching network\n");
-
         /*
-         * Initiate an active scan over all channels to determine
-         * which channel is used by the coordinator.
-         * Use: bool wpan_mlme_scan_req(uint8_t ScanType,
-         *                              uint32_t ScanChannels,
-         *                              uint8_t ScanDuration,
-         *                              uint8_t ChannelPage);
-         *
-         * This request leads to a scan confirm message -> usr_mlme_scan_conf
-         * Scan for about 50 ms on each channel -> ScanDuration = 1
-         * Scan for about 1/2 second on each channel -> ScanDuration = 5
-         * Scan for about 1 second on each channel -> ScanDuration = 6
+         * Rejoin the coordinator of the cache; if this fails, scan for
+         * about 1/2 second on each channel.
          */
-        wpan_mlme_scan_req(MLME_SCAN_TYPE_ACTIVE,
-                           SCAN_ALL_CHANNELS,
-                           SCAN_DURATION_SHORT,
-                           DEFAULT_CHANNEL_PAGE);
+        start_rejoin(SCAN_DURATION_SHORT);
 
         /* Indicate network scanning by a LED flashing. */
         pal_timer_start(APP_TIMER_LED_OFF,
@@ -225,108 +227,124 @@ void usr_mlme_scan_conf(uint8_t status,
                         uint8_t ResultListSize,
                         void *ResultList)
 {
-    if (status == MAC_SUCCESS)
-    {
-        wpan_pandescriptor_t *coordinator;
-        uint8_t i;
+    /* The scans are part of the rejoin. */
+    pan_rejoin_scan_conf(status,
+                         ScanType,
+                         ChannelPage,
+                         UnscannedChannels,
+                         ResultListSize,
+                         ResultList);
+}
 
-        /*
-         * Analyze the ResultList.
-         * Assume that the first entry of the result list is our coodinator.
-         */
-        coordinator = (wpan_pandescriptor_t *)ResultList;
 
-        for (i = 0; i < ResultListSize; i++)
-        {
-            /*
-             * Check if the PAN descriptor belongs to our coordinator.
-             * Check if coordinator allows association.
-             */
-            if ((coordinator->LogicalChannel == DEFAULT_CHANNEL) &&
-                (coordinator->ChannelPage == DEFAULT_CHANNEL_PAGE) &&
-                (coordinator->CoordAddrSpec.PANId == DEFAULT_PAN_ID) &&
-                ((coordinator->SuperframeSpec & ((uint16_t)1 << ASSOC_PERMIT_BIT_POS)) == ((uint16_t)1 << ASSOC_PERMIT_BIT_POS))
-               )
-            {
-                /* Store the coordinator's address information. */
-                if (coordinator->CoordAddrSpec.AddrMode == WPAN_ADDRMODE_SHORT)
-                {
-                    coord_addr = coordinator->CoordAddrSpec.Addr.short_address;
-                }
-                else
-                {
-                    /* Something went wrong; restart. */
-                    wpan_mlme_reset_req(true);
-                    return;
-                }
-
-                printf("Found network\n");
-
-                /*
-                 * Associate to our coordinator.
-                 * Use: bool wpan_mlme_associate_req(uint8_t LogicalChannel,
-                 *                                   uint8_t ChannelPage,
-                 *                                   wpan_addr_spec_t *CoordAddrSpec,
-                 *                                   uint8_t CapabilityInformation);
-                 * This request will cause a mlme associate confirm message ->
-                 * usr_mlme_associate_conf.
-                 */
-                wpan_mlme_associate_req(coordinator->LogicalChannel,
-                                        coordinator->ChannelPage,
-                                        &(coordinator->CoordAddrSpec),
-                                        WPAN_CAP_ALLOCADDRESS);
-                return;
-            }
-
-            /* Get the next PAN descriptor. */
-            coordinator++;
-        }
 
-        /*
-         * If here, the result list does not contain our expected coordinator.
-         * Let's scan again.
-         */
-        wpan_mlme_scan_req(MLME_SCAN_TYPE_ACTIVE,
-                           SCAN_ALL_CHANNELS,
-                           SCAN_DURATION_SHORT,
-                           DEFAULT_CHANNEL_PAGE);
-    }
-    else if (status == MAC_NO_BEACON)
-    {
-        /*
-         * No beacon is received; no coordiantor is located.
-         * Scan again, but used longer scan duration.
-         */
-        wpan_mlme_scan_req(MLME_SCAN_TYPE_ACTIVE,
-                           SCAN_ALL_CHANNELS,
-                           SCAN_DURATION_LONG,
-                           DEFAULT_CHANNEL_PAGE);
-    }
-    else
+/**
+ * @brief Callback function usr_mlme_associate_conf
+ *
+ * @param AssocShortAddress    Short address allocated by the coordinator
+ * @param status               Result of requested association operation
+ */
+void usr_mlme_associate_conf(uint16_t AssocShortAddress, uint8_t status)
+{
+    /* The association is part of the rejoin. */
+    pan_rejoin_associate_conf(AssocShortAddress, status);
+}
+
+
+
+/**
+ * @brief Callback function usr_mlme_set_conf
+ *
+ * @param status        Result of requested PIB attribute set operation
+ * @param PIBAttribute  Updated PIB attribute
+ */
+void usr_mlme_set_conf(uint8_t status, uint8_t PIBAttribute)
+{
+    /* The PIB is set by the rejoin only. */
+    pan_rejoin_set_conf(status, PIBAttribute);
+}
+
+
+
+/**
+ * @brief Callback function usr_mlme_get_conf
+ *
+ * @param status            Result of requested PIB attribute get operation
+ * @param PIBAttribute      Retrieved PIB attribute
+ * @param PIBAttributeValue Pointer to data containing retrieved PIB attribute
+ */
+void usr_mlme_get_conf(uint8_t status,
+                       uint8_t PIBAttribute,
+                       void *PIBAttributeValue)
+{
+    /* The PIB is read by the rejoin only. */
+    pan_rejoin_get_conf(status, PIBAttribute, PIBAttributeValue);
+}
+
+
+
+/**
+ * @brief Starts the rejoin of the network
+ *
+ * @param scan_duration Scan duration if the coordinator of the cache is
+ *                      not found
+ */
+static void start_rejoin(uint8_t scan_duration)
+{
+    printf("Searching network\n");
+
+    /*
+     * The rejoin tries the coordinator of the cache first, then scans
+     * all channels and associates to the coordinator found.
+     * This leads to the callback rejoin_cb().
+     */
+    if (!pan_rejoin_start(DEFAULT_PAN_ID,
+                          SCAN_ALL_CHANNELS,
+                          scan_duration,
+                          DEFAULT_CHANNEL_PAGE,
+                          WPAN_CAP_ALLOCADDRESS,
+                          rejoin_cb))
     {
         /* Something went wrong; restart. */
         wpan_mlme_reset_req(true);
     }
-
-    /* Keep compiler happy. */
-    ScanType = ScanType;
-    ChannelPage = ChannelPage;
-    UnscannedChannels = UnscannedChannels;
 }
 
 
 
 /**
- * @brief Callback function usr_mlme_associate_conf
+ * @brief Callback function indicating the end of the rejoin
  *
- * @param AssocShortAddress    Short address allocated by the coordinator
- * @param status               Result of requested association operation
+ * @param status       Result of the rejoin
+ * @param path         Way the device has rejoined the network
+ * @param coordinator  Coordinator the device has rejoined
+ * @param ShortAddress Short address of the device
  */
-void usr_mlme_associate_conf(uint16_t AssocShortAddress, uint8_t status)
+static void rejoin_cb(uint8_t status,
+                      pan_rejoin_path_t path,
+                      const pan_cache_entry_t *coordinator,
+                      uint16_t ShortAddress)
 {
     if (status == MAC_SUCCESS)
     {
-        printf("Conntected to nonbeacon-enabled network\n");
+        switch (path)
+        {
+            case PAN_REJOIN_POLL:
+                printf("Rejoined coordinator of the cache\n");
+                break;
+
+            case PAN_REJOIN_ORPHAN:
+                printf("Rejoined by orphan scan\n");
+                break;
+
+            default:
+                printf("Conntected to nonbeacon-enabled network\n");
+                break;
+        }
+
+        /* Store the coordinator's address information. */
+        coord_addr_spec = coordinator->CoordAddrSpec;
+        poll_failures = 0;
 
         /* Stop timer used for search indication (same as used for data transmission). */
         pal_timer_stop(APP_TIMER_LED_OFF);
@@ -339,6 +357,14 @@ void usr_mlme_associate_conf(uint16_t AssocShortAddress, uint8_t status)
                         (FUNC_PTR)app_initiate_polling,
                         NULL);
     }
+    else if (status == MAC_NO_BEACON)
+    {
+        /*
+         * No beacon is received; no coordiantor is located.
+         * Scan again, but used longer scan duration.
+         */
+        start_rejoin(SCAN_DURATION_LONG);
+    }
     else
     {
         /* Something went wrong; restart. */
@@ -346,7 +372,7 @@ void usr_mlme_associate_conf(uint16_t AssocShortAddress, uint8_t status)
     }
 
     /* Keep compiler happy. */
-    AssocShortAddress = AssocShortAddress;
+    ShortAddress = ShortAddress;
 }
 
 
@@ -424,12 +450,6 @@ static void app_initiate_polling(void *parameter)
      *
      * @return true - success; false - buffer not availability or queue full.
      */
-    wpan_addr_spec_t coord_addr_spec;
-
-    coord_addr_spec.AddrMode = WPAN_ADDRMODE_SHORT;
-    coord_addr_spec.PANId = DEFAULT_PAN_ID;
-    coord_addr_spec.Addr.short_address = coord_addr;
-
     printf("Poll coordinator\n");
 
     wpan_mlme_poll_req(&coord_addr_spec);
@@ -449,14 +469,33 @@ static void app_initiate_polling(void *parameter)
  */
 void usr_mlme_poll_conf(uint8_t status)
 {
+    if (pan_rejoin_poll_conf(status))
+    {
+        /* The poll has been part of the rejoin. */
+        return;
+    }
+
+    if (status == MAC_NO_ACK)
+    {
+        if (++poll_failures >= APP_MAX_POLL_FAILURES)
+        {
+            /* The coordinator is lost; rejoin. */
+            pal_led(LED_NWK_SETUP, LED_OFF);
+            start_rejoin(SCAN_DURATION_SHORT);
+            return;
+        }
+    }
+    else
+    {
+        poll_failures = 0;
+    }
+
     /* Start a timer that polls for pending data at the coordinator. */
     pal_timer_start(APP_TIMER_POLL_DATA,
                     ((uint32_t)APP_POLL_PERIOD_MS * 1000),
                     TIMEOUT_RELATIVE,
                     (FUNC_PTR)app_initiate_polling,
                     NULL);
-
-    status = status;    /* Keep compiler happy. */
 }
 
 
@@ -0,0 +1,460 @@
+/**
+ * @file main.c
+ *
+ * @brief  MAC Example - Ping_Pong
+ *
+ * This is the source code of the MAC example Ping_Pong. It measures the
+ * round-trip and one-way latency of data frames sent via the MAC API
+ * (wpan_mcps_data_req()) between two nodes; the measurement is done by
+ * ping_pong.c. The TAL example Performance_Test measures the same via the
+ * TAL API, so the comparison of both results shows the share of the MAC.
+ *
+ * The nodes do not join a network; both set their short address, the PAN
+ * Id and the channel directly and keep the receiver on when idle.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include "pal.h"
+#include "tal.h"
+#include "sio_handler.h"
+#include "mac_api.h"
+#include "app_config.h"
+#include "ieee_const.h"
+#include "ping_pong.h"
+
+/* === TYPES =============================================================== */
+
+
+/* === MACROS ============================================================== */
+
+#ifdef CHANNEL
+#define DEFAULT_CHANNEL                 (CHANNEL)
+#define DEFAULT_CHANNEL_PAGE            (0)
+#else
+/** Defines the default channel. */
+#if (TAL_TYPE == AT86RF212)
+    #ifdef CHINESE_BAND
+        #define DEFAULT_CHANNEL                 (0)
+        #define DEFAULT_CHANNEL_PAGE            (5)
+    #else
+        #define DEFAULT_CHANNEL                 (1)
+        #define DEFAULT_CHANNEL_PAGE            (0)
+    #endif  /* #ifdef CHINESE_BAND */
+#else
+#define DEFAULT_CHANNEL                 (20)
+#define DEFAULT_CHANNEL_PAGE            (0)
+#endif  /* #if (TAL_TYPE == AT86RF212) */
+#endif  /* #ifdef CHANNEL */
+/** Defines the PAN ID of the network. */
+#ifdef PAN_ID
+#define DEFAULT_PAN_ID                  (PAN_ID)
+#else
+#define DEFAULT_PAN_ID                  (0xBABE)
+#endif
+/** Defines the short address of the initiator. */
+#define INITIATOR_SHORT_ADDR            (0x0001)
+/** Defines the short address of the reflector. */
+#define REFLECTOR_SHORT_ADDR            (0x0002)
+/** Defines the MSDU length of pings and pongs. */
+#ifndef PING_MSDU_LENGTH
+#define PING_MSDU_LENGTH                (20)
+#endif
+
+#if (PING_MSDU_LENGTH < PING_PAYLOAD_MIN_LEN)
+#error "PING_MSDU_LENGTH is shorter than PING_PAYLOAD_MIN_LEN"
+#endif
+
+#if (NO_OF_LEDS >= 3)
+#define LED_START                       (LED_0)
+#define LED_NWK_SETUP                   (LED_1)
+#define LED_DATA                        (LED_2)
+#elif (NO_OF_LEDS == 2)
+#define LED_START                       (LED_0)
+#define LED_NWK_SETUP                   (LED_0)
+#define LED_DATA                        (LED_1)
+#else
+#define LED_START                       (LED_0)
+#define LED_NWK_SETUP                   (LED_0)
+#define LED_DATA                        (LED_0)
+#endif
+
+/* === GLOBALS ============================================================= */
+
+/** Role of this node */
+static ping_role_t role;
+/** Short address of the peer node */
+static uint16_t peer_short_addr;
+/** true once the PIB attributes are set */
+static bool ready;
+/** true while a data request is pending */
+static bool tx_busy;
+/** true once a key stopped the current run */
+static bool stopping;
+/** MSDU of the last ping or pong */
+static uint8_t msdu[PING_MSDU_LENGTH];
+
+/* === PROTOTYPES ========================================================== */
+
+static void app_task(void);
+static void select_role(void);
+static void start_run(void);
+static void send_msdu(uint8_t length);
+
+/* === IMPLEMENTATION ====================================================== */
+
+
+/**
+ * @brief Main function of the Ping_Pong application
+ */
+int main(void)
+{
+    /* Initialize the MAC layer and its underlying layers, like PAL, TAL, BMM. */
+    if (wpan_init() != MAC_SUCCESS)
+    {
+        /*
+         * Stay here; we need a valid IEEE address.
+         * Check kit documentation how to create an IEEE address
+         * and to store it into the EEPROM.
+         */
+        pal_alert();
+    }
+
+    /* Initialize LEDs. */
+    pal_led_init();
+    pal_led(LED_START, LED_ON);         // indicating application is started
+    pal_led(LED_NWK_SETUP, LED_OFF);    // indicating PIB attributes are set
+    pal_led(LED_DATA, LED_OFF);         // indicating ongoing run
+
+    /*
+     * The stack is initialized above, hence the global interrupts are enabled
+     * here.
+     */
+    pal_global_irq_enable();
+
+    /* Initialize the serial interface used for communication with terminal program. */
+    if (pal_sio_init(SIO_CHANNEL) != MAC_SUCCESS)
+    {
+        /* Something went wrong during initialization. */
+        pal_alert();
+    }
+
+#if ((!defined __ICCAVR__) && (!defined __ICCARM__))
+    fdevopen(_sio_putchar, _sio_getchar);
+#endif
+
+    select_role();
+
+    /*
+     * Reset the MAC layer to the default values
+     * This request will cause a mlme reset confirm message ->
+     * usr_mlme_reset_conf
+     */
+    wpan_mlme_reset_req(true);
+
+    /* Main loop */
+    while (1)
+    {
+        wpan_task();
+        app_task();
+    }
+}
+
+
+/**
+ * @brief Asks the user for the role of this node
+ */
+static void select_role(void)
+{
+    while (1)
+    {
+        printf("\r\nPing_Pong: (I)nitiator or (R)eflector? ");
+        switch (toupper(sio_getchar()))
+        {
+            case 'I':
+                role = PING_INITIATOR;
+                peer_short_addr = REFLECTOR_SHORT_ADDR;
+                return;
+
+            case 'R':
+                role = PING_REFLECTOR;
+                peer_short_addr = INITIATOR_SHORT_ADDR;
+                return;
+
+            default:
+                break;
+        }
+    }
+}
+
+
+/**
+ * @brief Application task
+ *
+ * The initiator sends the next ping once the last one is answered or lost.
+ * Any key ends the current run; the result is printed and a new run is
+ * started with the next key.
+ */
+static void app_task(void)
+{
+    if (!ready)
+    {
+        return;
+    }
+
+    if (sio_getchar_nowait() != -1)
+    {
+        stopping = true;
+    }
+
+    if (tx_busy || ((role == PING_INITIATOR) && ping_pending()))
+    {
+        return;
+    }
+
+    if (!stopping && (role == PING_INITIATOR) && (ping_count() < PING_MAX_SAMPLES))
+    {
+        send_msdu(ping_build_request(msdu));
+    }
+    else if (stopping || (role == PING_INITIATOR))
+    {
+        pal_led(LED_DATA, LED_OFF);
+        ping_print_result("MAC");
+        printf("\r\nPress any key to start a new run.\r\n");
+        sio_getchar();
+        start_run();
+    }
+}
+
+
+/**
+ * @brief Starts a new run
+ */
+static void start_run(void)
+{
+    ping_init(role, PING_MSDU_LENGTH);
+    stopping = false;
+    pal_led(LED_DATA, LED_ON);
+
+    if (role == PING_INITIATOR)
+    {
+        printf("\r\nSending %d pings... Press any key to stop.\r\n", PING_MAX_SAMPLES);
+    }
+    else
+    {
+        printf("\r\nAnswering pings... Press any key to stop.\r\n");
+    }
+}
+
+
+/**
+ * @brief Requests the transmission of a ping or pong to the peer node
+ *
+ * @param length Length of the MSDU
+ */
+static void send_msdu(uint8_t length)
+{
+    /*
+     * Use: bool wpan_mcps_data_req(uint8_t SrcAddrMode,
+     *                              wpan_addr_spec_t *DstAddrSpec,
+     *                              uint8_t msduLength,
+     *                              uint8_t *msdu,
+     *                              uint8_t msduHandle,
+     *                              uint8_t TxOptions);
+     *
+     * This request will cause a mcps data confirm message ->
+     * usr_mcps_data_conf
+     */
+    wpan_addr_spec_t dst_addr;
+    static uint8_t msduHandle = 0;
+
+    dst_addr.AddrMode = WPAN_ADDRMODE_SHORT;
+    dst_addr.PANId = DEFAULT_PAN_ID;
+    ADDR_COPY_DST_SRC_16(dst_addr.Addr.short_address, peer_short_addr);
+
+    msduHandle++;
+    tx_busy = true;
+    if (!wpan_mcps_data_req(WPAN_ADDRMODE_SHORT,
+                            &dst_addr,
+                            length,
+                            msdu,
+                            msduHandle,
+                            WPAN_TXOPT_ACK))
+    {
+        /* The request could not be queued. */
+        tx_busy = false;
+        ping_tx_done(MAC_CHANNEL_ACCESS_FAILURE, 0);
+    }
+}
+
+
+/**
+ * @brief Callback function usr_mlme_reset_conf
+ *
+ * @param status Result of the reset procedure
+ */
+void usr_mlme_reset_conf(uint8_t status)
+{
+    if (status == MAC_SUCCESS)
+    {
+        /*
+         * Set the short address of this node.
+         * Use: bool wpan_mlme_set_req(uint8_t PIBAttribute,
+         *                             void *PIBAttributeValue);
+         *
+         * This request leads to a set confirm message -> usr_mlme_set_conf
+         */
+        uint16_t short_addr;
+
+        if (role == PING_INITIATOR)
+        {
+            short_addr = INITIATOR_SHORT_ADDR;
+        }
+        else
+        {
+            short_addr = REFLECTOR_SHORT_ADDR;
+        }
+        wpan_mlme_set_req(macShortAddress, &short_addr);
+    }
+    else
+    {
+        // something went wrong; restart
+        wpan_mlme_reset_req(true);
+    }
+}
+
+
+/**
+ * @brief Callback function usr_mlme_set_conf
+ *
+ * The PIB attributes are set one after the other; the run starts once the
+ * receiver is switched on.
+ *
+ * @param status        Result of requested PIB attribute set operation
+ * @param PIBAttribute  Updated PIB attribute
+ */
+void usr_mlme_set_conf(uint8_t status, uint8_t PIBAttribute)
+{
+    if ((status == MAC_SUCCESS) && (PIBAttribute == macShortAddress))
+    {
+        uint16_t pan_id = DEFAULT_PAN_ID;
+
+        wpan_mlme_set_req(macPANId, &pan_id);
+    }
+    else if ((status == MAC_SUCCESS) && (PIBAttribute == macPANId))
+    {
+        uint8_t channel_page = DEFAULT_CHANNEL_PAGE;
+
+        wpan_mlme_set_req(phyCurrentPage, &channel_page);
+    }
+    else if ((status == MAC_SUCCESS) && (PIBAttribute == phyCurrentPage))
+    {
+        uint8_t channel = DEFAULT_CHANNEL;
+
+        wpan_mlme_set_req(phyCurrentChannel, &channel);
+    }
+    else if ((status == MAC_SUCCESS) && (PIBAttribute == phyCurrentChannel))
+    {
+        bool rx_on_when_idle = true;
+
+        wpan_mlme_set_req(macRxOnWhenIdle, &rx_on_when_idle);
+    }
+    else if ((status == MAC_SUCCESS) && (PIBAttribute == macRxOnWhenIdle))
+    {
+        pal_led(LED_NWK_SETUP, LED_ON);
+        ready = true;
+        start_run();
+    }
+    else
+    {
+        // something went wrong; restart
+        wpan_mlme_reset_req(true);
+    }
+}
+
+
+/**
+ * @brief Callback function usr_mcps_data_ind
+ *
+ * The reflector answers a ping right away.
+ *
+ * @param SrcAddrSpec      Pointer to source address specification
+ * @param DstAddrSpec      Pointer to destination address specification
+ * @param msduLength       Number of octets contained in MSDU
+ * @param msdu_rx          Pointer to MSDU
+ * @param mpduLinkQuality  LQI measured during reception of the MPDU
+ * @param DSN              DSN of the received data frame.
+ * @param Timestamp        The time, in microseconds, at which the data were
+ *                         received (only if timestamping is enabled).
+ */
+void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
+                       wpan_addr_spec_t *DstAddrSpec,
+                       uint8_t msduLength,
+                       uint8_t *msdu_rx,
+                       uint8_t mpduLinkQuality,
+#ifdef ENABLE_TSTAMP
+                       uint8_t DSN,
+                       uint32_t Timestamp)
+#else
+                       uint8_t DSN)
+#endif  /* ENABLE_TSTAMP */
+{
+#ifndef ENABLE_TSTAMP
+    uint32_t Timestamp = 0;
+#endif
+
+    if (ping_rx(msdu_rx, msduLength, Timestamp) && !tx_busy && !stopping)
+    {
+        send_msdu(ping_build_response(msdu));
+    }
+
+    /* Keep compiler happy. */
+    SrcAddrSpec = SrcAddrSpec;
+    DstAddrSpec = DstAddrSpec;
+    mpduLinkQuality = mpduLinkQuality;
+    DSN = DSN;
+}
+
+
+/**
+ * Callback function usr_mcps_data_conf
+ *
+ * @param msduHandle  Handle of MSDU handed over to MAC earlier
+ * @param status      Result for requested data transmission request
+ * @param Timestamp   The time, in microseconds, at which the data were
+ *                    transmitted (only if timestamping is enabled).
+ *
+ */
+#ifdef ENABLE_TSTAMP
+void usr_mcps_data_conf(uint8_t msduHandle, uint8_t status, uint32_t Timestamp)
+#else
+void usr_mcps_data_conf(uint8_t msduHandle, uint8_t status)
+#endif  /* ENABLE_TSTAMP */
+{
+    tx_busy = false;
+#ifdef ENABLE_TSTAMP
+    ping_tx_done(status, Timestamp);
+#else
+    ping_tx_done(status, 0);
+#endif  /* ENABLE_TSTAMP */
+
+    /* Keep compiler happy. */
+    msduHandle = msduHandle;
+}
+
+/* EOF */
@@ -0,0 +1,665 @@
+/**
+ * @file sniffer_pcap.c
+ *
+ * @brief Converter of the binary sniffer stream to pcapng or pcap
+ *
+ * Reads the binary records of the promiscuous mode demo (see
+ * sniffer_stream.h) from a file or a serial port and writes the frames as
+ * pcapng (default) or pcap file, which can be opened by Wireshark. Text
+ * output of the demo preceding the stream and corrupted records are skipped.
+ * The channel statistics of the channel hopping sniffer are printed to
+ * stderr at the end of the stream.
+ *
+ * Usage: sniffer_pcap [-c] [-f] [-r rssi_base] [input [output]]
+ *
+ * -c  Write a classic pcap file instead of pcapng.
+ * -f  Use the link type IEEE802_15_4_WITHFCS instead of IEEE802_15_4_TAP;
+ *     the channel, LQI and signal strength are not written in this case.
+ * -r  RSSI base value of the transceiver in dBm used to derive the signal
+ *     strength from the ED value (default -90, AT86RF231).
+ *
+ * Input and output default to stdin and stdout ("-"), so a live capture is
+ * possible by
+ *     stty -F /dev/ttyUSB0 raw 1000000
+ *     sniffer_pcap /dev/ttyUSB0 | wireshark -k -i -
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "sniffer_stream.h"
+
+/* === MACROS ============================================================== */
+
+/** Link types, see http://www.tcpdump.org/linktypes.html */
+#define LINKTYPE_IEEE802_15_4_WITHFCS   (195)
+#define LINKTYPE_IEEE802_15_4_TAP       (283)
+
+/** pcapng block types */
+#define PCAPNG_SHB                      (0x0A0D0D0AUL)
+#define PCAPNG_IDB                      (0x00000001UL)
+#define PCAPNG_ISB                      (0x00000005UL)
+#define PCAPNG_EPB                      (0x00000006UL)
+#define PCAPNG_BYTE_ORDER_MAGIC         (0x1A2B3C4DUL)
+
+/** pcapng options */
+#define PCAPNG_OPT_ENDOFOPT             (0)
+#define PCAPNG_IF_NAME                  (2)
+#define PCAPNG_IF_TSRESOL               (9)
+#define PCAPNG_ISB_IFRECV               (4)
+#define PCAPNG_ISB_IFDROP               (5)
+
+/** Classic pcap file */
+#define PCAP_MAGIC                      (0xA1B2C3D4UL)
+
+/** IEEE 802.15.4 TAP header and TLVs */
+#define TAP_HDR_LEN                     (4)
+#define TAP_TLV_FCS_TYPE                (0)
+#define TAP_TLV_RSS                     (1)
+#define TAP_TLV_CHANNEL                 (3)
+#define TAP_TLV_LQI                     (10)
+#define TAP_FCS_TYPE_16_BIT             (1)
+#define TAP_MAX_LEN                     (TAP_HDR_LEN + 8 + 8 + 8 + 8)
+
+/** Default RSSI base value (AT86RF231) */
+#define DEFAULT_RSSI_BASE               (-90)
+
+/** Number of channels covered by the statistics */
+#define MAX_CHANNELS                    (32)
+
+/** Size of the input buffer */
+#define IN_BUF_SIZE                     (4096)
+
+/* === TYPES =============================================================== */
+
+
+/* === GLOBALS ============================================================= */
+
+static int in_fd;
+static FILE *out;
+
+static uint8_t in_buf[IN_BUF_SIZE];
+static size_t in_pos;
+static size_t in_len;
+
+static bool classic_pcap;
+static bool with_tap = true;
+static int rssi_base = DEFAULT_RSSI_BASE;
+
+/** Time of the last frame in microseconds */
+static uint64_t time_us;
+static uint32_t last_timestamp;
+static bool first_frame = true;
+
+static uint32_t frames;
+static uint32_t dropped;
+static uint32_t skipped;
+
+/** Last statistics record of each channel */
+static uint8_t channel_stats[MAX_CHANNELS][SNIFFER_STATS_LEN];
+static bool channel_stats_valid[MAX_CHANNELS];
+
+/* === PROTOTYPES ========================================================== */
+
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Makes at least length octets of the input available at in_pos
+ *
+ * @return false at the end of the input
+ */
+static bool need(size_t length)
+{
+    ssize_t n;
+
+    if ((in_len - in_pos) >= length)
+    {
+        return true;
+    }
+
+    memmove(in_buf, &in_buf[in_pos], in_len - in_pos);
+    in_len -= in_pos;
+    in_pos = 0;
+
+    while (in_len < length)
+    {
+        /* read() returns what is available, so a live stream is not delayed. */
+        n = read(in_fd, &in_buf[in_len], IN_BUF_SIZE - in_len);
+        if (n <= 0)
+        {
+            return false;
+        }
+        in_len += (size_t)n;
+    }
+
+    return true;
+}
+
+
+
+static void put_u8(uint8_t **p, uint8_t value)
+{
+    *(*p)++ = value;
+}
+
+
+
+static void put_u16(uint8_t **p, uint16_t value)
+{
+    put_u8(p, (uint8_t)value);
+    put_u8(p, (uint8_t)(value >> 8));
+}
+
+
+
+static void put_u32(uint8_t **p, uint32_t value)
+{
+    put_u16(p, (uint16_t)value);
+    put_u16(p, (uint16_t)(value >> 16));
+}
+
+
+
+static void put_u64(uint8_t **p, uint64_t value)
+{
+    put_u32(p, (uint32_t)value);
+    put_u32(p, (uint32_t)(value >> 32));
+}
+
+
+
+/**
+ * @brief Writes a pcapng block
+ *
+ * The files are written little endian, which is indicated by the byte
+ * order magic of the section header block.
+ */
+static void write_block(uint32_t type, const uint8_t *body, size_t length)
+{
+    uint8_t hdr[8];
+    uint8_t *p = hdr;
+    uint32_t total = (uint32_t)(12 + ((length + 3) & ~(size_t)3));
+    static const uint8_t pad[3];
+
+    put_u32(&p, type);
+    put_u32(&p, total);
+    fwrite(hdr, 1, sizeof(hdr), out);
+    fwrite(body, 1, length, out);
+    fwrite(pad, 1, (4 - (length & 3)) & 3, out);
+    p = hdr;
+    put_u32(&p, total);
+    fwrite(hdr, 1, 4, out);
+}
+
+
+
+/**
+ * @brief Writes the header of the output file
+ */
+static void write_file_header(void)
+{
+    uint8_t body[64];
+    uint8_t *p = body;
+    uint16_t linktype = with_tap ? LINKTYPE_IEEE802_15_4_TAP :
+                                   LINKTYPE_IEEE802_15_4_WITHFCS;
+    static const char if_name[] = "IEEE 802.15.4 sniffer";
+
+    memset(body, 0, sizeof(body));
+
+    if (classic_pcap)
+    {
+        put_u32(&p, PCAP_MAGIC);
+        put_u16(&p, 2);
+        put_u16(&p, 4);
+        put_u32(&p, 0);             /* thiszone */
+        put_u32(&p, 0);             /* sigfigs */
+        put_u32(&p, 0xFFFF);        /* snaplen */
+        put_u32(&p, linktype);
+        fwrite(body, 1, p - body, out);
+        return;
+    }
+
+    /* Section header block */
+    put_u32(&p, PCAPNG_BYTE_ORDER_MAGIC);
+    put_u16(&p, 1);
+    put_u16(&p, 0);
+    put_u64(&p, UINT64_MAX);        /* section length not specified */
+    write_block(PCAPNG_SHB, body, p - body);
+
+    /* Interface description block */
+    p = body;
+    put_u16(&p, linktype);
+    put_u16(&p, 0);
+    put_u32(&p, 0xFFFF);            /* snaplen */
+    put_u16(&p, PCAPNG_IF_NAME);
+    put_u16(&p, sizeof(if_name) - 1);
+    memcpy(p, if_name, sizeof(if_name) - 1);
+    p += (sizeof(if_name) - 1 + 3) & ~3;
+    put_u16(&p, PCAPNG_IF_TSRESOL);
+    put_u16(&p, 1);
+    put_u32(&p, 6);                 /* microseconds, padded */
+    put_u32(&p, PCAPNG_OPT_ENDOFOPT);
+    write_block(PCAPNG_IDB, body, p - body);
+}
+
+
+
+/**
+ * @brief Duration of a symbol in microseconds, see TAL_CONVERT_SYMBOLS_TO_US
+ */
+static uint32_t symbol_time_us(uint8_t channel, uint8_t page)
+{
+    if (channel >= 11)
+    {
+        return 16;
+    }
+    if (page == 0)
+    {
+        return (channel == 0) ? 50 : 25;
+    }
+    return (channel == 0) ? 40 : 16;
+}
+
+
+
+/**
+ * @brief Writes the TAP header of a frame
+ *
+ * @return Length of the TAP header
+ */
+static size_t write_tap(uint8_t *tap, const uint8_t *hdr)
+{
+    uint8_t *p = tap + TAP_HDR_LEN;
+    int8_t rssi = (int8_t)hdr[SNIFFER_OFF_RSSI];
+    float rss;
+    uint32_t rss_bits;
+
+    put_u16(&p, TAP_TLV_FCS_TYPE);
+    put_u16(&p, 1);
+    put_u32(&p, TAP_FCS_TYPE_16_BIT);
+
+    /* The RSSI of the MAC is preferred to the ED value. */
+    rss = (rssi != SNIFFER_RSSI_INVALID) ? (float)rssi :
+                                           (float)(rssi_base + hdr[SNIFFER_OFF_ED]);
+    memcpy(&rss_bits, &rss, sizeof(rss_bits));
+    put_u16(&p, TAP_TLV_RSS);
+    put_u16(&p, 4);
+    put_u32(&p, rss_bits);
+
+    put_u16(&p, TAP_TLV_CHANNEL);
+    put_u16(&p, 3);
+    put_u16(&p, hdr[SNIFFER_OFF_CHANNEL]);
+    put_u16(&p, hdr[SNIFFER_OFF_PAGE]);
+
+    put_u16(&p, TAP_TLV_LQI);
+    put_u16(&p, 1);
+    put_u32(&p, hdr[SNIFFER_OFF_LQI]);
+
+    p = tap;
+    put_u8(&p, 0);                  /* version */
+    put_u8(&p, 0);
+    put_u16(&p, TAP_MAX_LEN);
+
+    return TAP_MAX_LEN;
+}
+
+
+
+/**
+ * @brief Writes a received frame
+ */
+static void write_frame(const uint8_t *hdr, const uint8_t *psdu)
+{
+    uint8_t body[28 + TAP_MAX_LEN + SNIFFER_MAX_PSDU_LEN];
+    uint8_t tap[TAP_MAX_LEN];
+    uint8_t *p = body;
+    uint8_t length = hdr[SNIFFER_OFF_LEN];
+    uint32_t timestamp = (uint32_t)hdr[SNIFFER_OFF_TIMESTAMP] |
+                         ((uint32_t)hdr[SNIFFER_OFF_TIMESTAMP + 1] << 8) |
+                         ((uint32_t)hdr[SNIFFER_OFF_TIMESTAMP + 2] << 16) |
+                         ((uint32_t)hdr[SNIFFER_OFF_TIMESTAMP + 3] << 24);
+    size_t tap_len = 0;
+    uint32_t caplen;
+
+    /* The time stamp of the TAL wraps around; accumulate the differences. */
+    if (!first_frame)
+    {
+        time_us += (uint64_t)((timestamp - last_timestamp) & SNIFFER_TIMESTAMP_MASK) *
+                   symbol_time_us(hdr[SNIFFER_OFF_CHANNEL], hdr[SNIFFER_OFF_PAGE]);
+    }
+    first_frame = false;
+    last_timestamp = timestamp;
+
+    if (with_tap)
+    {
+        tap_len = write_tap(tap, hdr);
+    }
+    caplen = (uint32_t)(tap_len + length);
+
+    if (classic_pcap)
+    {
+        put_u32(&p, (uint32_t)(time_us / 1000000));
+        put_u32(&p, (uint32_t)(time_us % 1000000));
+        put_u32(&p, caplen);
+        put_u32(&p, caplen);
+        memcpy(p, tap, tap_len);
+        p += tap_len;
+        memcpy(p, psdu, length);
+        p += length;
+        fwrite(body, 1, p - body, out);
+    }
+    else
+    {
+        put_u32(&p, 0);             /* interface */
+        put_u32(&p, (uint32_t)(time_us >> 32));
+        put_u32(&p, (uint32_t)time_us);
+        put_u32(&p, caplen);
+        put_u32(&p, caplen);
+        memcpy(p, tap, tap_len);
+        p += tap_len;
+        memcpy(p, psdu, length);
+        p += length;
+        write_block(PCAPNG_EPB, body, p - body);
+    }
+
+    frames++;
+}
+
+
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(&p[2]) << 16);
+}
+
+
+
+/**
+ * @brief Number of frames dropped from the capture rings of all channels
+ */
+static uint32_t ring_dropped(void)
+{
+    uint32_t sum = 0;
+    uint8_t i;
+
+    for (i = 0; i < MAX_CHANNELS; i++)
+    {
+        if (channel_stats_valid[i])
+        {
+            sum += get_u16(&channel_stats[i][SNIFFER_STATS_OFF_DROPPED]);
+        }
+    }
+
+    return sum;
+}
+
+
+
+/**
+ * @brief Prints the channel statistics of the channel hopping sniffer
+ */
+static void print_channel_stats(void)
+{
+    const uint8_t *s;
+    uint8_t i;
+    bool header = false;
+
+    for (i = 0; i < MAX_CHANNELS; i++)
+    {
+        if (!channel_stats_valid[i])
+        {
+            continue;
+        }
+
+        if (!header)
+        {
+            fprintf(stderr, "channel  frames    octets  crc err  dropped  visits  switch us (mean/max)\n");
+            header = true;
+        }
+
+        s = channel_stats[i];
+        fprintf(stderr, "%7u %7u %9u %8u %8u %7u  %5u/%u\n", i,
+                get_u32(&s[SNIFFER_STATS_OFF_FRAMES]),
+                get_u32(&s[SNIFFER_STATS_OFF_OCTETS]),
+                get_u16(&s[SNIFFER_STATS_OFF_CRC_ERRORS]),
+                get_u16(&s[SNIFFER_STATS_OFF_DROPPED]),
+                get_u16(&s[SNIFFER_STATS_OFF_DWELLS]),
+                get_u16(&s[SNIFFER_STATS_OFF_SWITCH_US]),
+                get_u16(&s[SNIFFER_STATS_OFF_SWITCH_MAX_US]));
+    }
+}
+
+
+
+/**
+ * @brief Writes the interface statistics with the number of dropped frames
+ */
+static void write_statistics(void)
+{
+    uint8_t body[48];
+    uint8_t *p = body;
+    uint32_t all_dropped = dropped + ring_dropped();
+
+    if (classic_pcap)
+    {
+        return;
+    }
+
+    put_u32(&p, 0);                 /* interface */
+    put_u32(&p, (uint32_t)(time_us >> 32));
+    put_u32(&p, (uint32_t)time_us);
+    put_u16(&p, PCAPNG_ISB_IFRECV);
+    put_u16(&p, 8);
+    put_u64(&p, (uint64_t)frames + all_dropped);
+    put_u16(&p, PCAPNG_ISB_IFDROP);
+    put_u16(&p, 8);
+    put_u64(&p, all_dropped);
+    put_u32(&p, PCAPNG_OPT_ENDOFOPT);
+    write_block(PCAPNG_ISB, body, p - body);
+}
+
+
+
+/**
+ * @brief Checks the header of a record at in_pos
+ */
+static bool header_valid(const uint8_t *hdr)
+{
+    uint8_t check = 0;
+    uint8_t i;
+
+    if ((hdr[0] != SNIFFER_SYNC_0) || (hdr[1] != SNIFFER_SYNC_1))
+    {
+        return false;
+    }
+
+    for (i = SNIFFER_OFF_TYPE; i < SNIFFER_OFF_CHECK; i++)
+    {
+        check ^= hdr[i];
+    }
+    if (check != hdr[SNIFFER_OFF_CHECK])
+    {
+        return false;
+    }
+
+    switch (hdr[SNIFFER_OFF_TYPE])
+    {
+        case SNIFFER_REC_FRAME:
+            return (hdr[SNIFFER_OFF_LEN] <= SNIFFER_MAX_PSDU_LEN);
+
+        case SNIFFER_REC_DROPPED:
+            return (hdr[SNIFFER_OFF_LEN] == 0);
+
+        case SNIFFER_REC_STATS:
+            return (hdr[SNIFFER_OFF_LEN] == SNIFFER_STATS_LEN);
+
+        default:
+            return false;
+    }
+}
+
+
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-c] [-f] [-r rssi_base] [input [output]]\n"
+                    "  -c  write a classic pcap file instead of pcapng\n"
+                    "  -f  use link type IEEE802_15_4_WITHFCS instead of IEEE802_15_4_TAP\n"
+                    "  -r  RSSI base value of the transceiver in dBm (default %d)\n",
+            name, DEFAULT_RSSI_BASE);
+    exit(2);
+}
+
+
+
+/**
+ * @brief Main function of the converter
+ */
+int main(int argc, char **argv)
+{
+    int opt;
+    const uint8_t *hdr;
+    bool live;
+
+    while ((opt = getopt(argc, argv, "cfr:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c':
+                classic_pcap = true;
+                break;
+
+            case 'f':
+                with_tap = false;
+                break;
+
+            case 'r':
+                rssi_base = atoi(optarg);
+                break;
+
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if ((argc - optind) > 2)
+    {
+        usage(argv[0]);
+    }
+
+    in_fd = STDIN_FILENO;
+    if ((optind < argc) && (strcmp(argv[optind], "-") != 0))
+    {
+        in_fd = open(argv[optind], O_RDONLY);
+        if (in_fd < 0)
+        {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    out = stdout;
+    if (((optind + 1) < argc) && (strcmp(argv[optind + 1], "-") != 0))
+    {
+        out = fopen(argv[optind + 1], "wb");
+        if (NULL == out)
+        {
+            perror(argv[optind + 1]);
+            return 1;
+        }
+    }
+
+    /* Frames are passed on immediately if the input is a device or a pipe. */
+    live = (lseek(in_fd, 0, SEEK_CUR) < 0) || isatty(in_fd);
+
+    write_file_header();
+
+    while (need(SNIFFER_HDR_LEN))
+    {
+        hdr = &in_buf[in_pos];
+
+        if (!header_valid(hdr))
+        {
+            /* Text output or a corrupted record; search the next record. */
+            in_pos++;
+            skipped++;
+            continue;
+        }
+
+        if (SNIFFER_REC_DROPPED == hdr[SNIFFER_OFF_TYPE])
+        {
+            dropped += (uint32_t)hdr[SNIFFER_OFF_TIMESTAMP] |
+                       ((uint32_t)hdr[SNIFFER_OFF_TIMESTAMP + 1] << 8) |
+                       ((uint32_t)hdr[SNIFFER_OFF_TIMESTAMP + 2] << 16) |
+                       ((uint32_t)hdr[SNIFFER_OFF_TIMESTAMP + 3] << 24);
+            in_pos += SNIFFER_HDR_LEN;
+            continue;
+        }
+
+        if (!need(SNIFFER_HDR_LEN + hdr[SNIFFER_OFF_LEN]))
+        {
+            break;
+        }
+        /* need() may have moved the buffer. */
+        hdr = &in_buf[in_pos];
+
+        if (SNIFFER_REC_STATS == hdr[SNIFFER_OFF_TYPE])
+        {
+            if (hdr[SNIFFER_OFF_CHANNEL] < MAX_CHANNELS)
+            {
+                memcpy(channel_stats[hdr[SNIFFER_OFF_CHANNEL]], &hdr[SNIFFER_HDR_LEN],
+                       SNIFFER_STATS_LEN);
+                channel_stats_valid[hdr[SNIFFER_OFF_CHANNEL]] = true;
+            }
+            in_pos += SNIFFER_HDR_LEN + SNIFFER_STATS_LEN;
+            continue;
+        }
+
+        write_frame(hdr, &hdr[SNIFFER_HDR_LEN]);
+        in_pos += SNIFFER_HDR_LEN + hdr[SNIFFER_OFF_LEN];
+
+        if (live)
+        {
+            fflush(out);
+        }
+    }
+
+    write_statistics();
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    fprintf(stderr, "%u frames, %u dropped by the sniffer, %u octets skipped\n",
+            frames, dropped + ring_dropped(), skipped);
+    print_channel_stats();
+
+    return 0;
+}
+
+/* EOF */
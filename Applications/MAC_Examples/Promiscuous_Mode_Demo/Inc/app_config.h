@@ -78,9 +78,10 @@ typedef enum
 #define TOTAL_NUMBER_OF_BUFS        (TOTAL_NUMBER_OF_LARGE_BUFS + TOTAL_NUMBER_OF_SMALL_BUFS)
 
 /**
- * Defines the USB transmit buffer size
+ * Defines the USB transmit buffer size; large enough for a complete record of
+ * the binary stream (see sniffer_stream.h)
  */
-#define USB_TX_BUF_SIZE             (128)
+#define USB_TX_BUF_SIZE             (255)
 
 /**
  * Defines the USB receive buffer size
@@ -124,9 +125,10 @@ typedef enum
 #define USB_PRODUCT_NAME L"RZUSBSTICK"
 
 /**
- * Defines the UART transmit buffer size
+ * Defines the UART transmit buffer size; large enough for a complete record of
+ * the binary stream (see sniffer_stream.h)
  */
-#define UART_MAX_TX_BUF_LENGTH      (10)
+#define UART_MAX_TX_BUF_LENGTH      (255)
 
 /**
  * Defines the UART receive buffer size
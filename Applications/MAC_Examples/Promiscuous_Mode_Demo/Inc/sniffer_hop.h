@@ -0,0 +1,122 @@
+/**
+ * @file sniffer_hop.h
+ *
+ * @brief Channel hopping sniffer of the promiscuous mode demo
+ *
+ * The sniffer visits the channels of a channel mask for a dwell time each.
+ * In lock mode it stays on a channel as long as frames are received there,
+ * up to SNIFFER_LOCK_MAX_MS. The received frames are kept in a capture ring
+ * per channel, so a busy channel cannot crowd out the frames of the other
+ * channels while the serial interface is the bottleneck. The rings are
+ * drained round-robin into the binary stream (see sniffer_stream.h); after
+ * each sweep over the channel mask a statistics record is sent per channel.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef SNIFFER_HOP_H
+#define SNIFFER_HOP_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tal.h"
+
+/* === Macros =============================================================== */
+
+/** Time spent on each channel in ms */
+#ifndef SNIFFER_HOP_DWELL_MS
+#define SNIFFER_HOP_DWELL_MS            (50)
+#endif
+
+/** Maximum time the lock mode stays on an active channel in ms */
+#ifndef SNIFFER_LOCK_MAX_MS
+#define SNIFFER_LOCK_MAX_MS             (1000)
+#endif
+
+/** Size of the capture ring of each channel in octets */
+#ifndef SNIFFER_RING_SIZE
+#define SNIFFER_RING_SIZE               (256)
+#endif
+
+#if (RF_BAND == BAND_2400)
+/** Lowest channel of the band */
+#define SNIFFER_FIRST_CHANNEL           (11)
+/** Number of channels of the band */
+#define SNIFFER_NUM_CHANNELS            (16)
+#else
+#define SNIFFER_FIRST_CHANNEL           (0)
+#define SNIFFER_NUM_CHANNELS            (11)
+#endif
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts the channel hopping sniffer
+ *
+ * Promiscuous mode has to be on and the binary stream initialized.
+ *
+ * @param channel_mask Channels to be visited
+ * @param channel Channel currently set
+ * @param page Channel page currently set
+ * @param lock Stay on channels with activity
+ */
+void sniffer_hop_start(uint32_t channel_mask, uint8_t channel, uint8_t page,
+                       bool lock);
+
+/**
+ * @brief Stores a received frame in the capture ring of the current channel
+ *
+ * @param psdu PSDU of the frame, including the FCS
+ * @param length Length of the PSDU
+ * @param lqi LQI of the frame
+ * @param ed ED register value measured during the reception
+ * @param rssi Signal strength in dBm or SNIFFER_RSSI_INVALID
+ * @param timestamp Receive time stamp in symbols
+ */
+void sniffer_hop_frame(uint8_t *psdu, uint8_t length,
+                       uint8_t lqi, uint8_t ed, int8_t rssi,
+                       uint32_t timestamp);
+
+/**
+ * @brief Switches the channel and passes the captured frames to the stream
+ *
+ * Has to be called from the main loop after wpan_task().
+ */
+void sniffer_hop_task(void);
+
+/**
+ * @brief Completes a channel switch
+ *
+ * Has to be called from usr_mlme_set_conf() for phyCurrentChannel.
+ *
+ * @param status Result of the set request
+ */
+void sniffer_hop_set_conf(uint8_t status);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SNIFFER_HOP_H */
+/* EOF */
@@ -0,0 +1,199 @@
+/**
+ * @file sniffer_stream.h
+ *
+ * @brief Binary record stream of the promiscuous mode demo
+ *
+ * In the binary stream mode each received frame is sent to the host as a
+ * record, so that the serial interface is not the bottleneck of the
+ * sniffer. This file is shared by the firmware and the host converter
+ * (HOST/Src/sniffer_pcap.c).
+ *
+ * Each record consists of a header of SNIFFER_HDR_LEN octets followed by
+ * the PSDU of the frame (including the FCS):
+ *
+ *     SYNC0 | SYNC1 | TYPE | LEN | CHANNEL | PAGE | LQI | ED | RSSI |
+ *     TIMESTAMP (4) | CHECK | PSDU (LEN)
+ *
+ * - TYPE is SNIFFER_REC_FRAME, SNIFFER_REC_DROPPED or SNIFFER_REC_STATS.
+ * - LEN is the length of the PSDU, 0 for SNIFFER_REC_DROPPED and
+ *   SNIFFER_STATS_LEN for SNIFFER_REC_STATS.
+ * - ED is the ED register value measured during the reception,
+ *   RSSI the derived signal strength in dBm or SNIFFER_RSSI_INVALID.
+ * - TIMESTAMP is the receive time stamp of the TAL in symbols (masked by
+ *   SNIFFER_TIMESTAMP_MASK, little endian). For SNIFFER_REC_DROPPED it is
+ *   the number of frames dropped since the previous record of this type.
+ * - SNIFFER_REC_STATS carries the statistics of the channel CHANNEL of the
+ *   channel hopping sniffer (see sniffer_hop.h) instead of a PSDU; its
+ *   fields are given by SNIFFER_STATS_OFF_* (little endian).
+ * - CHECK is the XOR of the octets TYPE ... TIMESTAMP; together with SYNC it
+ *   allows the receiver to find the start of a record in the stream.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef SNIFFER_STREAM_H
+#define SNIFFER_STREAM_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+/** First and second octet of a record */
+#define SNIFFER_SYNC_0                  (0xA7)
+#define SNIFFER_SYNC_1                  (0x15)
+
+/** Record of a received frame */
+#define SNIFFER_REC_FRAME               (0x01)
+
+/** Record of frames dropped due to a full transmit buffer */
+#define SNIFFER_REC_DROPPED             (0x02)
+
+/** Statistics of a channel of the channel hopping sniffer */
+#define SNIFFER_REC_STATS               (0x03)
+
+/** Length of the record header */
+#define SNIFFER_HDR_LEN                 (14)
+
+/** Offsets of the fields of the record header */
+#define SNIFFER_OFF_TYPE                (2)
+#define SNIFFER_OFF_LEN                 (3)
+#define SNIFFER_OFF_CHANNEL             (4)
+#define SNIFFER_OFF_PAGE                (5)
+#define SNIFFER_OFF_LQI                 (6)
+#define SNIFFER_OFF_ED                  (7)
+#define SNIFFER_OFF_RSSI                (8)
+#define SNIFFER_OFF_TIMESTAMP           (9)
+#define SNIFFER_OFF_CHECK               (13)
+
+/** Fields of the statistics record following the header */
+#define SNIFFER_STATS_OFF_FRAMES        (0)
+#define SNIFFER_STATS_OFF_OCTETS        (4)
+#define SNIFFER_STATS_OFF_CRC_ERRORS    (8)
+#define SNIFFER_STATS_OFF_DROPPED       (10)
+#define SNIFFER_STATS_OFF_DWELLS        (12)
+#define SNIFFER_STATS_OFF_SWITCH_US     (14)
+#define SNIFFER_STATS_OFF_SWITCH_MAX_US (16)
+#define SNIFFER_STATS_LEN               (18)
+
+/** Maximum length of a PSDU */
+#define SNIFFER_MAX_PSDU_LEN            (127)
+
+/** RSSI value if the signal strength is not available */
+#define SNIFFER_RSSI_INVALID            (127)
+
+/** Valid bits of the time stamp */
+#define SNIFFER_TIMESTAMP_MASK          (0x0FFFFFFFUL)
+
+/**
+ * Size of the transmit buffer of the firmware; frames received while it is
+ * full are dropped and reported by a SNIFFER_REC_DROPPED record.
+ */
+#ifndef SNIFFER_BUF_SIZE
+#define SNIFFER_BUF_SIZE                (1024)
+#endif
+
+/* === Types ================================================================ */
+
+/**
+ * Statistics of a channel of the channel hopping sniffer
+ */
+typedef struct sniffer_channel_stats_tag
+{
+    /** Frames received */
+    uint32_t frames;
+    /** PSDU octets received */
+    uint32_t octets;
+    /** Frames discarded due to an invalid FCS */
+    uint16_t crc_errors;
+    /** Frames dropped due to a full capture ring */
+    uint16_t dropped;
+    /** Number of visits */
+    uint16_t dwells;
+    /** Mean time in us to switch to the channel */
+    uint16_t switch_us;
+    /** Maximum time in us to switch to the channel */
+    uint16_t switch_max_us;
+} sniffer_channel_stats_t;
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the binary record stream
+ *
+ * @param sio_unit Serial interface used for the stream
+ */
+void sniffer_stream_init(uint8_t sio_unit);
+
+/**
+ * @brief Adds the record of a received frame to the stream
+ *
+ * @param psdu PSDU of the frame, including the FCS
+ * @param length Length of the PSDU
+ * @param channel Channel the frame was received on
+ * @param page Channel page the frame was received on
+ * @param lqi LQI of the frame
+ * @param ed ED register value measured during the reception
+ * @param rssi Signal strength in dBm or SNIFFER_RSSI_INVALID
+ * @param timestamp Receive time stamp in symbols
+ */
+void sniffer_stream_frame(uint8_t *psdu, uint8_t length,
+                          uint8_t channel, uint8_t page,
+                          uint8_t lqi, uint8_t ed, int8_t rssi,
+                          uint32_t timestamp);
+
+/**
+ * @brief Checks whether a frame record fits into the transmit buffer
+ *
+ * @param length Length of the PSDU
+ *
+ * @return true if sniffer_stream_frame() will not drop the frame
+ */
+bool sniffer_stream_space(uint8_t length);
+
+/**
+ * @brief Adds the statistics record of a channel to the stream
+ *
+ * The record is omitted if the transmit buffer is full; the statistics are
+ * cumulative, so the next record covers it.
+ *
+ * @param channel Channel
+ * @param page Channel page
+ * @param stats Statistics of the channel
+ */
+void sniffer_stream_stats(uint8_t channel, uint8_t page,
+                          const sniffer_channel_stats_t *stats);
+
+/**
+ * @brief Passes the collected records to the serial interface
+ *
+ * Has to be called from the main loop after wpan_task(), so that all
+ * records of one MAC task are sent by a single write where possible.
+ */
+void sniffer_stream_flush(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SNIFFER_STREAM_H */
+/* EOF */
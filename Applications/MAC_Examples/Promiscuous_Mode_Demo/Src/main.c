@@ -9,6 +9,12 @@
  * (i.e. frames with valid CRC) on the current channel (= DEFAULT_CHANNEL)
  * and forward them via serial I/O to a terminal.
  *
+ * If the first key stroke is 'b', the frames are forwarded as binary records
+ * (see sniffer_stream.h) instead of text; HOST/Src/sniffer_pcap.c converts
+ * this stream to a pcapng or pcap file. With 'h' the binary stream is
+ * combined with channel hopping over SNIFFER_HOP_CHANNELS (see
+ * sniffer_hop.h); with 'l' the hopping sniffer locks onto active channels.
+ *
  * $Id: main.c,v 1.3.2.2 2010/09/07 17:39:35 dam Exp $
  *
  * @author    Atmel Corporation: http://www.atmel.com
@@ -34,6 +40,8 @@
 #include "app_config.h"
 #include "ieee_const.h"
 #include "sio_handler.h"
+#include "sniffer_stream.h"
+#include "sniffer_hop.h"
 
 /* === TYPES =============================================================== */
 
@@ -71,12 +79,25 @@ typedef struct prom_mode_payload_tag
 #define DEFAULT_CHANNEL_PAGE            (0)
 #endif  /* #if (TAL_TYPE == AT86RF212) */
 
+/** Channels visited by the channel hopping sniffer */
+#ifndef SNIFFER_HOP_CHANNELS
+#define SNIFFER_HOP_CHANNELS            (TRX_SUPPORTED_CHANNELS)
+#endif
+
 /* === GLOBALS ============================================================= */
 
 static uint32_t rx_frame_cnt;
 static prom_mode_payload_t app_parse_data;
 static uint8_t current_page;
 static uint8_t current_channel;
+/** Frames are forwarded as binary records instead of text */
+static bool binary_stream;
+/** Channel hopping requested by the first key stroke */
+static bool hop_requested;
+/** Channel hopping sniffer locks onto active channels */
+static bool hop_lock;
+/** Channel hopping sniffer is running */
+static bool hopping;
 
 /* === PROTOTYPES ========================================================== */
 
@@ -95,6 +116,8 @@ static uint8_t get_page(void);
  */
 int main(void)
 {
+    int key;
+
     /* Initialize the MAC layer and its underlying layers, like PAL, TAL, BMM. */
     if (wpan_init() != MAC_SUCCESS)
     {
@@ -127,7 +150,10 @@ int main(void)
 #endif
 
     /* Wait for the first key stroke before continuing */
-    sio_getchar();
+    key = sio_getchar();
+    hop_lock = ((key == 'l') || (key == 'L'));
+    hop_requested = (hop_lock || (key == 'h') || (key == 'H'));
+    binary_stream = (hop_requested || (key == 'b') || (key == 'B'));
 
     /*
      * Reset the MAC layer to the default values
@@ -142,6 +168,17 @@ int main(void)
     while (1)
     {
         wpan_task();
+
+        if (hopping)
+        {
+            /* Switch the channel and send the captured frames. */
+            sniffer_hop_task();
+        }
+        else if (binary_stream)
+        {
+            /* Send the records of all frames indicated by this MAC task. */
+            sniffer_stream_flush();
+        }
     }
 }
 
@@ -178,7 +215,12 @@ void usr_mlme_reset_conf(uint8_t status)
  */
 void usr_mlme_set_conf(uint8_t status, uint8_t PIBAttribute)
 {
-    if ((status == MAC_SUCCESS) && (PIBAttribute == phyCurrentPage))
+    if (hopping && (PIBAttribute == phyCurrentChannel))
+    {
+        /* Channel switch of the hopping sniffer */
+        sniffer_hop_set_conf(status);
+    }
+    else if ((status == MAC_SUCCESS) && (PIBAttribute == phyCurrentPage))
     {
         printf("\r\nCurrent channel page: %d\r\n", current_page);
 
@@ -218,6 +260,19 @@ void usr_mlme_set_conf(uint8_t status, uint8_t PIBAttribute)
     else if ((status == MAC_SUCCESS) && (PIBAttribute == macPromiscuousMode))
     {
         printf("\r\nPromiscuous mode is on\r\n\r\n");
+
+        if (binary_stream)
+        {
+            /* From now on only binary records are sent. */
+            sniffer_stream_init(SIO_CHANNEL);
+        }
+
+        if (hop_requested)
+        {
+            sniffer_hop_start(SNIFFER_HOP_CHANNELS, current_channel, current_page,
+                              hop_lock);
+            hopping = true;
+        }
         /*
          * Node is now in promiscuous mode and will receive all proper frames
          * on this channel via MCPS_DATA.incidation primitives.
@@ -261,8 +316,21 @@ void usr_mlme_get_conf(uint8_t status,
     {
         printf("\r\nCurrent channel: %d\r\n", *(uint8_t *)PIBAttributeValue);
 
-        /* Ask for new channel. */
-        current_channel = get_channel();
+        if (hop_requested)
+        {
+            /* Start hopping on the lowest channel of the channel mask. */
+            current_channel = 0;
+            while (!(((uint32_t)SNIFFER_HOP_CHANNELS & TRX_SUPPORTED_CHANNELS) &
+                     ((uint32_t)1 << current_channel)))
+            {
+                current_channel++;
+            }
+        }
+        else
+        {
+            /* Ask for new channel. */
+            current_channel = get_channel();
+        }
 
         wpan_mlme_set_req(phyCurrentChannel, &current_channel);
     }
@@ -278,6 +346,8 @@ void usr_mlme_get_conf(uint8_t status,
  * @param msduLength       Number of octets contained in MSDU
  * @param msdu             Pointer to MSDU
  * @param mpduLinkQuality  LQI measured during reception of the MPDU
+ * @param mpduRssi         RSSI in dBm measured during reception of the MPDU
+ *                         (only if ENABLE_RSSI is defined).
  * @param DSN              DSN of the received data frame.
  * @param Timestamp        The time, in symbols, at which the data were received.
  *                         (only if timestamping is enabled).
@@ -287,6 +357,9 @@ void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
                        uint8_t msduLength,
                        uint8_t *msdu,
                        uint8_t mpduLinkQuality,
+#ifdef ENABLE_RSSI
+                       int8_t mpduRssi,
+#endif
                        uint8_t DSN,
                        uint32_t Timestamp)
 {
@@ -295,6 +368,35 @@ void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
     /* Update rx counter. */
     rx_frame_cnt++;
 
+    if (binary_stream)
+    {
+        /*
+         * In promiscuous mode msdu is the PSDU of the frame including the
+         * FCS; the TAL stores the LQI and the ED value behind it.
+         */
+        int8_t rssi;
+
+#ifdef ENABLE_RSSI
+        rssi = mpduRssi;
+#else
+        rssi = SNIFFER_RSSI_INVALID;
+#endif
+        if (hopping)
+        {
+            sniffer_hop_frame(msdu, msduLength,
+                              mpduLinkQuality, msdu[msduLength + LQI_LEN], rssi,
+                              Timestamp);
+        }
+        else
+        {
+            sniffer_stream_frame(msdu, msduLength,
+                                 current_channel, current_page,
+                                 mpduLinkQuality, msdu[msduLength + LQI_LEN], rssi,
+                                 Timestamp);
+        }
+        return;
+    }
+
     /*
      * The relevant information in promiscuous mode is in the payload (*msdu)
      * of this callback. This payload contains the MHR of the original frame
@@ -0,0 +1,392 @@
+/**
+ * @file sniffer_hop.c
+ *
+ * @brief Channel hopping sniffer of the promiscuous mode demo
+ *
+ * The channel is switched by wpan_mlme_set_req(phyCurrentChannel). In
+ * promiscuous mode the TAL changes the channel without leaving RX_ON, so
+ * the receiver is only blind while the PLL settles. The time from the set
+ * request until its confirm is measured per channel and reported in the
+ * statistics records, as an upper bound of the blind time.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "tal.h"
+#include "mac_api.h"
+#include "ieee_const.h"
+#include "sniffer_stream.h"
+#include "sniffer_hop.h"
+
+/* === MACROS ============================================================== */
+
+/** Length of the ring entry header: length, LQI, ED, RSSI, time stamp */
+#define RING_HDR_LEN                    (8)
+
+/* === TYPES =============================================================== */
+
+/**
+ * Capture ring of a channel
+ */
+typedef struct capture_ring_tag
+{
+    uint8_t buf[SNIFFER_RING_SIZE];
+    /** Position of the oldest entry */
+    uint16_t head;
+    /** Number of octets in use */
+    uint16_t used;
+} capture_ring_t;
+
+/* === GLOBALS ============================================================= */
+
+static capture_ring_t rings[SNIFFER_NUM_CHANNELS];
+static sniffer_channel_stats_t stats[SNIFFER_NUM_CHANNELS];
+
+/** Sum of the switch times per channel for the mean value */
+static uint32_t switch_sum_us[SNIFFER_NUM_CHANNELS];
+
+static uint32_t hop_mask;
+static uint8_t hop_page;
+static bool hop_lock;
+static bool hop_active;
+
+/** Channel frames are currently received on */
+static uint8_t hop_channel;
+
+/** Channel requested by the pending set request */
+static uint8_t hop_next_channel;
+static bool switch_pending;
+static uint32_t switch_start;
+
+static uint32_t dwell_start;
+static uint32_t lock_time_us;
+static uint16_t dwell_frames;
+static uint16_t crc_error_base;
+
+/** Ring to be drained first */
+static uint8_t drain_index;
+
+/* === PROTOTYPES ========================================================== */
+
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Reads the FCS error counter of the TAL
+ *
+ * The counter is incremented by the RX interrupt and cannot be read
+ * atomically by 8 bit MCUs.
+ */
+static uint16_t get_crc_errors(void)
+{
+    uint16_t cnt;
+
+    ENTER_CRITICAL_REGION();
+    cnt = tal_prom_crc_error_cnt;
+    LEAVE_CRITICAL_REGION();
+
+    return cnt;
+}
+
+
+
+void sniffer_hop_start(uint32_t channel_mask, uint8_t channel, uint8_t page,
+                       bool lock)
+{
+    memset(rings, 0, sizeof(rings));
+    memset(stats, 0, sizeof(stats));
+    memset(switch_sum_us, 0, sizeof(switch_sum_us));
+
+    hop_mask = channel_mask & TRX_SUPPORTED_CHANNELS;
+    if (0 == hop_mask)
+    {
+        hop_mask = (uint32_t)1 << channel;
+    }
+    hop_page = page;
+    hop_lock = lock;
+    hop_channel = channel;
+    switch_pending = false;
+    drain_index = 0;
+
+    pal_get_current_time(&dwell_start);
+    lock_time_us = 0;
+    dwell_frames = 0;
+    crc_error_base = get_crc_errors();
+
+    hop_active = true;
+}
+
+
+
+static void ring_put(capture_ring_t *ring, uint8_t value)
+{
+    uint16_t pos = ring->head + ring->used;
+
+    if (pos >= SNIFFER_RING_SIZE)
+    {
+        pos -= SNIFFER_RING_SIZE;
+    }
+    ring->buf[pos] = value;
+    ring->used++;
+}
+
+
+
+static uint8_t ring_get(capture_ring_t *ring)
+{
+    uint8_t value = ring->buf[ring->head];
+
+    ring->head++;
+    if (ring->head >= SNIFFER_RING_SIZE)
+    {
+        ring->head = 0;
+    }
+    ring->used--;
+
+    return value;
+}
+
+
+
+void sniffer_hop_frame(uint8_t *psdu, uint8_t length,
+                       uint8_t lqi, uint8_t ed, int8_t rssi,
+                       uint32_t timestamp)
+{
+    uint8_t index = hop_channel - SNIFFER_FIRST_CHANNEL;
+    capture_ring_t *ring = &rings[index];
+    uint8_t i;
+
+    if (!hop_active)
+    {
+        return;
+    }
+
+    stats[index].frames++;
+    stats[index].octets += length;
+    dwell_frames++;
+
+    if ((SNIFFER_RING_SIZE - ring->used) < (RING_HDR_LEN + length))
+    {
+        stats[index].dropped++;
+        return;
+    }
+
+    ring_put(ring, length);
+    ring_put(ring, lqi);
+    ring_put(ring, ed);
+    ring_put(ring, (uint8_t)rssi);
+    ring_put(ring, (uint8_t)timestamp);
+    ring_put(ring, (uint8_t)(timestamp >> 8));
+    ring_put(ring, (uint8_t)(timestamp >> 16));
+    ring_put(ring, (uint8_t)(timestamp >> 24));
+    for (i = 0; i < length; i++)
+    {
+        ring_put(ring, psdu[i]);
+    }
+}
+
+
+
+/**
+ * @brief Moves the captured frames round-robin from the rings to the stream
+ */
+static void drain_rings(void)
+{
+    uint8_t frame[RING_HDR_LEN + aMaxPHYPacketSize];
+    capture_ring_t *ring;
+    bool moved;
+    uint8_t n;
+    uint8_t i;
+
+    do
+    {
+        moved = false;
+
+        for (n = 0; n < SNIFFER_NUM_CHANNELS; n++)
+        {
+            ring = &rings[drain_index];
+
+            if (ring->used > 0)
+            {
+                /* The length is the first octet of the entry. */
+                if (!sniffer_stream_space(ring->buf[ring->head]))
+                {
+                    return;
+                }
+
+                frame[0] = ring_get(ring);
+                for (i = 1; i < (RING_HDR_LEN + frame[0]); i++)
+                {
+                    frame[i] = ring_get(ring);
+                }
+
+                sniffer_stream_frame(&frame[RING_HDR_LEN], frame[0],
+                                     drain_index + SNIFFER_FIRST_CHANNEL, hop_page,
+                                     frame[1], frame[2], (int8_t)frame[3],
+                                     (uint32_t)frame[4] |
+                                     ((uint32_t)frame[5] << 8) |
+                                     ((uint32_t)frame[6] << 16) |
+                                     ((uint32_t)frame[7] << 24));
+                moved = true;
+            }
+
+            drain_index++;
+            if (drain_index >= SNIFFER_NUM_CHANNELS)
+            {
+                drain_index = 0;
+            }
+        }
+    } while (moved);
+}
+
+
+
+/**
+ * @brief Returns the channel following the current one in the channel mask
+ */
+static uint8_t next_channel(void)
+{
+    uint8_t channel = hop_channel;
+
+    do
+    {
+        channel++;
+        if (channel >= (SNIFFER_FIRST_CHANNEL + SNIFFER_NUM_CHANNELS))
+        {
+            channel = SNIFFER_FIRST_CHANNEL;
+        }
+    } while (!(hop_mask & ((uint32_t)1 << channel)));
+
+    return channel;
+}
+
+
+
+void sniffer_hop_task(void)
+{
+    uint32_t now;
+    uint32_t dwell_time;
+    uint8_t i;
+
+    if (!hop_active)
+    {
+        return;
+    }
+
+    if (!switch_pending)
+    {
+        pal_get_current_time(&now);
+        dwell_time = pal_sub_time_us(now, dwell_start);
+
+        if (dwell_time >= ((uint32_t)SNIFFER_HOP_DWELL_MS * 1000))
+        {
+            uint16_t crc_errors = get_crc_errors();
+
+            stats[hop_channel - SNIFFER_FIRST_CHANNEL].crc_errors += crc_errors - crc_error_base;
+            crc_error_base = crc_errors;
+
+            if (hop_lock && (dwell_frames > 0) &&
+                (lock_time_us < ((uint32_t)SNIFFER_LOCK_MAX_MS * 1000)))
+            {
+                /* Activity seen; stay on this channel for another dwell time. */
+                lock_time_us += dwell_time;
+                dwell_start = now;
+                dwell_frames = 0;
+            }
+            else
+            {
+                hop_next_channel = next_channel();
+
+                /* A sweep over the channel mask is complete. */
+                if (hop_next_channel <= hop_channel)
+                {
+                    for (i = 0; i < SNIFFER_NUM_CHANNELS; i++)
+                    {
+                        if (hop_mask & ((uint32_t)1 << (i + SNIFFER_FIRST_CHANNEL)))
+                        {
+                            sniffer_stream_stats(i + SNIFFER_FIRST_CHANNEL, hop_page, &stats[i]);
+                        }
+                    }
+                }
+
+                if (hop_next_channel == hop_channel)
+                {
+                    /* Only one channel to be visited */
+                    dwell_start = now;
+                    dwell_frames = 0;
+                }
+                else
+                {
+                    switch_start = now;
+                    /* The request is repeated by the next task if no buffer is available. */
+                    switch_pending = wpan_mlme_set_req(phyCurrentChannel, &hop_next_channel);
+                }
+            }
+        }
+    }
+
+    drain_rings();
+    sniffer_stream_flush();
+}
+
+
+
+void sniffer_hop_set_conf(uint8_t status)
+{
+    sniffer_channel_stats_t *s;
+    uint32_t now;
+    uint32_t switch_us;
+
+    if (!switch_pending)
+    {
+        return;
+    }
+    switch_pending = false;
+
+    pal_get_current_time(&now);
+
+    if (MAC_SUCCESS == status)
+    {
+        hop_channel = hop_next_channel;
+
+        s = &stats[hop_channel - SNIFFER_FIRST_CHANNEL];
+        switch_us = pal_sub_time_us(now, switch_start);
+        if (switch_us > 0xFFFF)
+        {
+            switch_us = 0xFFFF;
+        }
+        /* The mean is frozen once the visit counter saturates. */
+        if (s->dwells < 0xFFFF)
+        {
+            s->dwells++;
+            switch_sum_us[hop_channel - SNIFFER_FIRST_CHANNEL] += switch_us;
+            s->switch_us = (uint16_t)(switch_sum_us[hop_channel - SNIFFER_FIRST_CHANNEL] / s->dwells);
+        }
+        if (switch_us > s->switch_max_us)
+        {
+            s->switch_max_us = (uint16_t)switch_us;
+        }
+    }
+
+    /* FCS errors during the switch cannot be assigned to a channel. */
+    crc_error_base = get_crc_errors();
+    dwell_start = now;
+    lock_time_us = 0;
+    dwell_frames = 0;
+}
+
+/* EOF */
@@ -0,0 +1,258 @@
+/**
+ * @file sniffer_stream.c
+ *
+ * @brief Binary record stream of the promiscuous mode demo
+ *
+ * The records of the received frames are collected in a transmit buffer and
+ * passed to the serial interface by sniffer_stream_flush(). In contrast to
+ * printing each frame, this never blocks the MAC: if the serial interface
+ * cannot keep up, frames are dropped and counted.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "sniffer_stream.h"
+
+/* === MACROS ============================================================== */
+
+
+/* === TYPES =============================================================== */
+
+
+/* === GLOBALS ============================================================= */
+
+/** Serial interface used for the stream */
+static uint8_t stream_sio_unit;
+
+/** Records to be sent */
+static uint8_t stream_buf[SNIFFER_BUF_SIZE];
+
+/** Octets of stream_buf already passed to the serial interface */
+static uint16_t stream_start;
+
+/** Octets of stream_buf filled with records */
+static uint16_t stream_end;
+
+/** Number of frames dropped and not yet reported */
+static uint32_t stream_dropped;
+
+/* === PROTOTYPES ========================================================== */
+
+
+/* === IMPLEMENTATION ====================================================== */
+
+void sniffer_stream_init(uint8_t sio_unit)
+{
+    stream_sio_unit = sio_unit;
+    stream_start = 0;
+    stream_end = 0;
+    stream_dropped = 0;
+}
+
+
+
+/**
+ * @brief Provides space for a record in the transmit buffer
+ *
+ * @param length Length of the record
+ *
+ * @return Start of the record, NULL if the buffer is full
+ */
+static uint8_t *stream_reserve(uint16_t length)
+{
+    if ((SNIFFER_BUF_SIZE - stream_end) < length)
+    {
+        /* Move the octets not yet sent to the start of the buffer. */
+        memmove(stream_buf, &stream_buf[stream_start], stream_end - stream_start);
+        stream_end -= stream_start;
+        stream_start = 0;
+
+        if ((SNIFFER_BUF_SIZE - stream_end) < length)
+        {
+            return NULL;
+        }
+    }
+
+    return &stream_buf[stream_end];
+}
+
+
+
+/**
+ * @brief Writes the header of a record
+ *
+ * @param rec Start of the record
+ * @param type Record type
+ * @param length Length of the PSDU
+ * @param channel Channel
+ * @param page Channel page
+ * @param lqi LQI
+ * @param ed ED register value
+ * @param rssi Signal strength in dBm
+ * @param timestamp Time stamp or number of dropped frames
+ */
+static void stream_header(uint8_t *rec, uint8_t type, uint8_t length,
+                          uint8_t channel, uint8_t page,
+                          uint8_t lqi, uint8_t ed, int8_t rssi,
+                          uint32_t timestamp)
+{
+    uint8_t check = 0;
+    uint8_t i;
+
+    rec[0] = SNIFFER_SYNC_0;
+    rec[1] = SNIFFER_SYNC_1;
+    rec[SNIFFER_OFF_TYPE] = type;
+    rec[SNIFFER_OFF_LEN] = length;
+    rec[SNIFFER_OFF_CHANNEL] = channel;
+    rec[SNIFFER_OFF_PAGE] = page;
+    rec[SNIFFER_OFF_LQI] = lqi;
+    rec[SNIFFER_OFF_ED] = ed;
+    rec[SNIFFER_OFF_RSSI] = (uint8_t)rssi;
+    rec[SNIFFER_OFF_TIMESTAMP] = (uint8_t)timestamp;
+    rec[SNIFFER_OFF_TIMESTAMP + 1] = (uint8_t)(timestamp >> 8);
+    rec[SNIFFER_OFF_TIMESTAMP + 2] = (uint8_t)(timestamp >> 16);
+    rec[SNIFFER_OFF_TIMESTAMP + 3] = (uint8_t)(timestamp >> 24);
+
+    for (i = SNIFFER_OFF_TYPE; i < SNIFFER_OFF_CHECK; i++)
+    {
+        check ^= rec[i];
+    }
+    rec[SNIFFER_OFF_CHECK] = check;
+
+    stream_end += SNIFFER_HDR_LEN + length;
+}
+
+
+
+void sniffer_stream_frame(uint8_t *psdu, uint8_t length,
+                          uint8_t channel, uint8_t page,
+                          uint8_t lqi, uint8_t ed, int8_t rssi,
+                          uint32_t timestamp)
+{
+    uint8_t *rec;
+
+    /* Report dropped frames first, so the host sees where the gap is. */
+    if (stream_dropped > 0)
+    {
+        rec = stream_reserve(SNIFFER_HDR_LEN);
+        if (NULL == rec)
+        {
+            stream_dropped++;
+            return;
+        }
+        stream_header(rec, SNIFFER_REC_DROPPED, 0, channel, page, 0, 0,
+                      SNIFFER_RSSI_INVALID, stream_dropped);
+        stream_dropped = 0;
+    }
+
+    rec = stream_reserve(SNIFFER_HDR_LEN + length);
+    if (NULL == rec)
+    {
+        stream_dropped++;
+        return;
+    }
+
+    memcpy(&rec[SNIFFER_HDR_LEN], psdu, length);
+    stream_header(rec, SNIFFER_REC_FRAME, length, channel, page, lqi, ed, rssi,
+                  timestamp & SNIFFER_TIMESTAMP_MASK);
+}
+
+
+
+bool sniffer_stream_space(uint8_t length)
+{
+    /* A pending record of dropped frames is sent first. */
+    uint16_t needed = SNIFFER_HDR_LEN + length;
+
+    if (stream_dropped > 0)
+    {
+        needed += SNIFFER_HDR_LEN;
+    }
+
+    return (NULL != stream_reserve(needed));
+}
+
+
+
+void sniffer_stream_stats(uint8_t channel, uint8_t page,
+                          const sniffer_channel_stats_t *stats)
+{
+    uint8_t *rec;
+    uint8_t *p;
+
+    rec = stream_reserve(SNIFFER_HDR_LEN + SNIFFER_STATS_LEN);
+    if (NULL == rec)
+    {
+        return;
+    }
+
+    p = &rec[SNIFFER_HDR_LEN];
+    p[SNIFFER_STATS_OFF_FRAMES] = (uint8_t)stats->frames;
+    p[SNIFFER_STATS_OFF_FRAMES + 1] = (uint8_t)(stats->frames >> 8);
+    p[SNIFFER_STATS_OFF_FRAMES + 2] = (uint8_t)(stats->frames >> 16);
+    p[SNIFFER_STATS_OFF_FRAMES + 3] = (uint8_t)(stats->frames >> 24);
+    p[SNIFFER_STATS_OFF_OCTETS] = (uint8_t)stats->octets;
+    p[SNIFFER_STATS_OFF_OCTETS + 1] = (uint8_t)(stats->octets >> 8);
+    p[SNIFFER_STATS_OFF_OCTETS + 2] = (uint8_t)(stats->octets >> 16);
+    p[SNIFFER_STATS_OFF_OCTETS + 3] = (uint8_t)(stats->octets >> 24);
+    p[SNIFFER_STATS_OFF_CRC_ERRORS] = (uint8_t)stats->crc_errors;
+    p[SNIFFER_STATS_OFF_CRC_ERRORS + 1] = (uint8_t)(stats->crc_errors >> 8);
+    p[SNIFFER_STATS_OFF_DROPPED] = (uint8_t)stats->dropped;
+    p[SNIFFER_STATS_OFF_DROPPED + 1] = (uint8_t)(stats->dropped >> 8);
+    p[SNIFFER_STATS_OFF_DWELLS] = (uint8_t)stats->dwells;
+    p[SNIFFER_STATS_OFF_DWELLS + 1] = (uint8_t)(stats->dwells >> 8);
+    p[SNIFFER_STATS_OFF_SWITCH_US] = (uint8_t)stats->switch_us;
+    p[SNIFFER_STATS_OFF_SWITCH_US + 1] = (uint8_t)(stats->switch_us >> 8);
+    p[SNIFFER_STATS_OFF_SWITCH_MAX_US] = (uint8_t)stats->switch_max_us;
+    p[SNIFFER_STATS_OFF_SWITCH_MAX_US + 1] = (uint8_t)(stats->switch_max_us >> 8);
+
+    stream_header(rec, SNIFFER_REC_STATS, SNIFFER_STATS_LEN, channel, page,
+                  0, 0, SNIFFER_RSSI_INVALID, 0);
+}
+
+
+
+void sniffer_stream_flush(void)
+{
+    uint16_t length;
+    uint8_t sent;
+
+    while (stream_start < stream_end)
+    {
+        length = stream_end - stream_start;
+        if (length > 0xFF)
+        {
+            length = 0xFF;
+        }
+
+        sent = pal_sio_tx(stream_sio_unit, &stream_buf[stream_start], (uint8_t)length);
+        if (0 == sent)
+        {
+            /* The serial interface is busy; continue after the next MAC task. */
+            break;
+        }
+        stream_start += sent;
+    }
+
+    if (stream_start == stream_end)
+    {
+        stream_start = 0;
+        stream_end = 0;
+    }
+}
+
+/* EOF */
@@ -0,0 +1,373 @@
+/**
+ * @file ncp_host.h
+ *
+ * @brief Host library of the MAC network co-processor (NCP)
+ *
+ * The library encodes the requests of the MAC API as messages to the NCP
+ * and decodes the confirms and indications received from the NCP. It does
+ * not access the serial interface itself: the messages to the NCP are
+ * passed to a write function supplied by the application, and the octets
+ * received from the NCP are passed to ncp_host_input() by the application.
+ *
+ * Each request function returns the sequence number assigned to the
+ * request. The NCP returns it in the NCP_STATUS message of the request and
+ * in the confirm, so several requests may be outstanding at a time. The
+ * requests are collected and written at once by ncp_host_flush().
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef NCP_HOST_H
+#define NCP_HOST_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ncp_protocol.h"
+
+/* === Macros =============================================================== */
+
+/**
+ * Size of the buffer collecting the requests until ncp_host_flush()
+ */
+#ifndef NCP_HOST_TX_BUF_SIZE
+#define NCP_HOST_TX_BUF_SIZE            (1024)
+#endif
+
+/** Maximum number of PAN descriptors of a scan confirm */
+#define NCP_HOST_MAX_PAN_DESC           ((NCP_MSG_MAX_LEN - 10) / NCP_PAN_DESC_LEN)
+
+#if (NCP_HOST_TX_BUF_SIZE < NCP_FRAME_MAX_LEN)
+#error "NCP_HOST_TX_BUF_SIZE has to hold a frame of the maximum length"
+#endif
+
+/* === Types ================================================================ */
+
+/**
+ * Address specification; a short address is stored in the lower two octets
+ * of Addr.
+ */
+typedef struct ncp_addr_spec_tag
+{
+    uint8_t AddrMode;
+    uint16_t PANId;
+    uint64_t Addr;
+} ncp_addr_spec_t;
+
+/**
+ * PAN descriptor
+ */
+typedef struct ncp_pandescriptor_tag
+{
+    ncp_addr_spec_t CoordAddrSpec;
+    uint8_t LogicalChannel;
+    uint8_t ChannelPage;
+    uint16_t SuperframeSpec;
+    uint8_t GTSPermit;
+    uint8_t LinkQuality;
+    uint32_t TimeStamp;
+} ncp_pandescriptor_t;
+
+/**
+ * Message received from the NCP
+ *
+ * The member of the union is selected by code. Pointers refer to the
+ * receive buffer and are only valid during the event callback.
+ */
+typedef struct ncp_event_tag
+{
+    /** Sequence number of the request, NCP_SEQ_INDICATION for indications */
+    uint8_t seq;
+    /** Message code */
+    uint8_t code;
+    union
+    {
+        /** NCP_STATUS */
+        struct
+        {
+            uint8_t request;
+            uint8_t status;
+        } ncp_status;
+        /** NCP_MCPS_DATA_CONFIRM */
+        struct
+        {
+            uint8_t msduHandle;
+            uint8_t status;
+            uint32_t Timestamp;
+        } data_conf;
+        /** NCP_MCPS_DATA_INDICATION */
+        struct
+        {
+            ncp_addr_spec_t SrcAddrSpec;
+            ncp_addr_spec_t DstAddrSpec;
+            uint8_t mpduLinkQuality;
+            int8_t mpduRssi;
+            uint8_t DSN;
+            uint32_t Timestamp;
+            uint8_t SecurityLevel;
+            uint8_t KeyIdMode;
+            uint8_t KeyIndex;
+            uint8_t msduLength;
+            const uint8_t *msdu;
+        } data_ind;
+        /** NCP_MCPS_PURGE_CONFIRM */
+        struct
+        {
+            uint8_t msduHandle;
+            uint8_t status;
+        } purge_conf;
+        /** NCP_MLME_ASSOCIATE_INDICATION */
+        struct
+        {
+            uint64_t DeviceAddress;
+            uint8_t CapabilityInformation;
+        } associate_ind;
+        /** NCP_MLME_ASSOCIATE_CONFIRM */
+        struct
+        {
+            uint16_t AssocShortAddress;
+            uint8_t status;
+        } associate_conf;
+        /** NCP_MLME_DISASSOCIATE_INDICATION */
+        struct
+        {
+            uint64_t DeviceAddress;
+            uint8_t DisassociateReason;
+        } disassociate_ind;
+        /** NCP_MLME_DISASSOCIATE_CONFIRM */
+        struct
+        {
+            uint8_t status;
+            ncp_addr_spec_t DeviceAddrSpec;
+        } disassociate_conf;
+        /** NCP_MLME_BEACON_NOTIFY_INDICATION */
+        struct
+        {
+            uint8_t BSN;
+            ncp_pandescriptor_t PANDescriptor;
+            uint8_t PendAddrSpec;
+            const uint8_t *AddrList;
+            uint8_t sduLength;
+            const uint8_t *sdu;
+        } beacon_notify_ind;
+        /** NCP_MLME_ORPHAN_INDICATION */
+        struct
+        {
+            uint64_t OrphanAddress;
+        } orphan_ind;
+        /** NCP_MLME_SCAN_CONFIRM */
+        struct
+        {
+            uint8_t status;
+            uint8_t ScanType;
+            uint8_t ChannelPage;
+            uint32_t UnscannedChannels;
+            uint8_t ResultListSize;
+            /** Energy levels of an energy detect scan */
+            const uint8_t *EnergyList;
+            /** PAN descriptors of an active or passive scan */
+            ncp_pandescriptor_t PANDescriptorList[NCP_HOST_MAX_PAN_DESC];
+        } scan_conf;
+        /** NCP_MLME_COMM_STATUS_INDICATION */
+        struct
+        {
+            ncp_addr_spec_t SrcAddrSpec;
+            ncp_addr_spec_t DstAddrSpec;
+            uint8_t status;
+        } comm_status_ind;
+        /** NCP_MLME_SYNC_LOSS_INDICATION */
+        struct
+        {
+            uint8_t LossReason;
+            uint16_t PANId;
+            uint8_t LogicalChannel;
+            uint8_t ChannelPage;
+        } sync_loss_ind;
+        /** NCP_MLME_GET_CONFIRM */
+        struct
+        {
+            uint8_t status;
+            uint8_t PIBAttribute;
+            uint8_t PIBAttributeLength;
+            const uint8_t *PIBAttributeValue;
+        } get_conf;
+        /** NCP_MLME_SET_CONFIRM */
+        struct
+        {
+            uint8_t status;
+            uint8_t PIBAttribute;
+        } set_conf;
+        /**
+         * NCP_MLME_RESET_CONFIRM, NCP_MLME_RX_ENABLE_CONFIRM,
+         * NCP_MLME_START_CONFIRM, NCP_MLME_POLL_CONFIRM
+         */
+        struct
+        {
+            uint8_t status;
+        } conf;
+    } u;
+} ncp_event_t;
+
+/**
+ * Function writing octets to the serial interface of the NCP
+ */
+typedef void (*ncp_host_write_t)(void *context, const uint8_t *data, uint16_t length);
+
+/**
+ * Function receiving the messages of the NCP
+ */
+typedef void (*ncp_host_event_t)(void *context, const ncp_event_t *event);
+
+/**
+ * State of the connection to a NCP
+ */
+typedef struct ncp_host_tag
+{
+    /** Write function of the application */
+    ncp_host_write_t write;
+    /** Event function of the application */
+    ncp_host_event_t event;
+    /** Context passed to the functions of the application */
+    void *context;
+    /** Reception state of the frames from the NCP */
+    ncp_rx_t rx;
+    /** Requests not yet written */
+    uint8_t tx_buf[NCP_HOST_TX_BUF_SIZE];
+    /** Number of octets in tx_buf */
+    uint16_t tx_length;
+    /** Sequence number of the last request */
+    uint8_t seq;
+    /** Number of messages with a wrong length of the parameters */
+    uint16_t malformed;
+} ncp_host_t;
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the connection to a NCP
+ *
+ * @param host Connection state
+ * @param write Write function of the application
+ * @param event Event function of the application
+ * @param context Context passed to the functions of the application
+ */
+void ncp_host_init(ncp_host_t *host, ncp_host_write_t write,
+                   ncp_host_event_t event, void *context);
+
+/**
+ * @brief Writes the collected requests
+ *
+ * @param host Connection state
+ */
+void ncp_host_flush(ncp_host_t *host);
+
+/**
+ * @brief Processes octets received from the NCP
+ *
+ * The event function is called for each complete message.
+ *
+ * @param host Connection state
+ * @param data Received octets
+ * @param length Number of received octets
+ */
+void ncp_host_input(ncp_host_t *host, const uint8_t *data, uint16_t length);
+
+/*
+ * Requests; the parameters correspond to those of the wpan_* functions.
+ * Each function returns the sequence number of the request (1 ... 255).
+ */
+uint8_t ncp_host_mcps_data_req(ncp_host_t *host,
+                               uint8_t SrcAddrMode,
+                               const ncp_addr_spec_t *DstAddrSpec,
+                               uint8_t msduLength,
+                               const uint8_t *msdu,
+                               uint8_t msduHandle,
+                               uint8_t TxOptions,
+                               uint8_t SecurityLevel,
+                               uint8_t KeyIdMode,
+                               uint8_t KeyIndex);
+
+uint8_t ncp_host_mcps_purge_req(ncp_host_t *host, uint8_t msduHandle);
+
+uint8_t ncp_host_mlme_associate_req(ncp_host_t *host,
+                                    uint8_t LogicalChannel,
+                                    uint8_t ChannelPage,
+                                    const ncp_addr_spec_t *CoordAddrSpec,
+                                    uint8_t CapabilityInformation);
+
+uint8_t ncp_host_mlme_associate_resp(ncp_host_t *host,
+                                     uint64_t DeviceAddress,
+                                     uint16_t AssocShortAddress,
+                                     uint8_t status);
+
+uint8_t ncp_host_mlme_disassociate_req(ncp_host_t *host,
+                                       const ncp_addr_spec_t *DeviceAddrSpec,
+                                       uint8_t DisassociateReason,
+                                       bool TxIndirect);
+
+uint8_t ncp_host_mlme_get_req(ncp_host_t *host, uint8_t PIBAttribute);
+
+uint8_t ncp_host_mlme_orphan_resp(ncp_host_t *host,
+                                  uint64_t OrphanAddress,
+                                  uint16_t ShortAddress,
+                                  bool AssociatedMember);
+
+uint8_t ncp_host_mlme_poll_req(ncp_host_t *host,
+                               const ncp_addr_spec_t *CoordAddrSpec);
+
+uint8_t ncp_host_mlme_reset_req(ncp_host_t *host, bool SetDefaultPib);
+
+uint8_t ncp_host_mlme_set_req(ncp_host_t *host,
+                              uint8_t PIBAttribute,
+                              const void *PIBAttributeValue,
+                              uint8_t PIBAttributeLength);
+
+uint8_t ncp_host_mlme_rx_enable_req(ncp_host_t *host,
+                                    bool DeferPermit,
+                                    uint32_t RxOnTime,
+                                    uint32_t RxOnDuration);
+
+uint8_t ncp_host_mlme_scan_req(ncp_host_t *host,
+                               uint8_t ScanType,
+                               uint32_t ScanChannels,
+                               uint8_t ScanDuration,
+                               uint8_t ChannelPage);
+
+uint8_t ncp_host_mlme_start_req(ncp_host_t *host,
+                                uint16_t PANId,
+                                uint8_t LogicalChannel,
+                                uint8_t ChannelPage,
+                                uint8_t BeaconOrder,
+                                uint8_t SuperframeOrder,
+                                bool PANCoordinator,
+                                bool BatteryLifeExtension,
+                                bool CoordRealignment);
+
+uint8_t ncp_host_mlme_sync_req(ncp_host_t *host,
+                               uint8_t LogicalChannel,
+                               uint8_t ChannelPage,
+                               bool TrackBeacon);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NCP_HOST_H */
+/* EOF */
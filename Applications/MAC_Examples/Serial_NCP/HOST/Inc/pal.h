@@ -0,0 +1,91 @@
+/**
+ * @file pal.h
+ *
+ * @brief Minimal PAL for building the NCP loopback test on a host computer
+ *
+ * The loopback test links the NCP firmware with the host library, a stub
+ * of the MAC API and a serial interface emulated in memory. The firmware
+ * only requires the compiler abstraction, the critical region handling and
+ * the SIO functions of the PAL; this file provides these for a host build
+ * with GCC. The compiler abstraction of the 32 bit MCUs (PAL_GENERIC_TYPE
+ * ARM7) is used, since it only depends on GCC.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_H
+#define PAL_H
+
+/* === Includes ============================================================ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pal_types.h"
+#include "return_val.h"
+#include "app_config.h"
+
+#if (PAL_GENERIC_TYPE != ARM7)
+#error "The host PAL requires PAL_GENERIC_TYPE ARM7"
+#endif
+
+/* === Macros =============================================================== */
+
+/**
+ * Serial interface emulated by the loopback test
+ */
+#define SIO_0                           (0x0)
+
+/**
+ * Adds two time values
+ */
+#define ADD_TIME(a, b)                  ((a) + (b))
+
+/**
+ * Subtracts two time values
+ */
+#define SUB_TIME(a, b)                  ((a) - (b))
+
+/**
+ * A host build runs single threaded without interrupts, so no critical
+ * regions are required.
+ */
+#define ENTER_CRITICAL_REGION()
+#define LEAVE_CRITICAL_REGION()
+
+/**
+ * Assertions are not evaluated by the host build.
+ */
+#define ASSERT(expr)
+
+/* === Types =============================================================== */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool pal_is_timer_running(uint8_t timer_id);
+retval_t pal_sio_init(uint8_t sio_unit);
+uint8_t pal_sio_tx(uint8_t sio_unit, uint8_t *data, uint8_t length);
+uint8_t pal_sio_rx(uint8_t sio_unit, uint8_t *data, uint8_t max_length);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* PAL_H */
+/* EOF */
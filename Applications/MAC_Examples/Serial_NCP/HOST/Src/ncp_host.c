@@ -0,0 +1,625 @@
+/**
+ * @file ncp_host.c
+ *
+ * @brief Host library of the MAC network co-processor (NCP)
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "ncp_protocol.h"
+#include "ncp_host.h"
+
+/* === Macros ============================================================== */
+
+/** Number of short addresses of the pending address specification */
+#define NUM_SHORT_ADDR_PENDING(x)       ((x) & 0x07)
+
+/** Number of extended addresses of the pending address specification */
+#define NUM_EXTENDED_ADDR_PENDING(x)    (((x) >> 4) & 0x07)
+
+/* === Types =============================================================== */
+
+
+/* === Globals ============================================================= */
+
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+void ncp_host_init(ncp_host_t *host, ncp_host_write_t write,
+                   ncp_host_event_t event, void *context)
+{
+    host->write = write;
+    host->event = event;
+    host->context = context;
+    ncp_rx_init(&host->rx);
+    host->tx_length = 0;
+    host->seq = 0;
+    host->malformed = 0;
+}
+
+
+
+void ncp_host_flush(ncp_host_t *host)
+{
+    if (host->tx_length > 0)
+    {
+        host->write(host->context, host->tx_buf, host->tx_length);
+        host->tx_length = 0;
+    }
+}
+
+
+
+/**
+ * @brief Reserves space for a request
+ *
+ * @param host Connection state
+ * @param param_length Length of the parameters of the request
+ *
+ * @return Position of the parameters
+ */
+static uint8_t *request_start(ncp_host_t *host, uint8_t param_length)
+{
+    if ((NCP_HOST_TX_BUF_SIZE - host->tx_length) <
+        ((uint16_t)param_length + NCP_FRAME_OVERHEAD + 2))
+    {
+        ncp_host_flush(host);
+    }
+
+    return &host->tx_buf[host->tx_length + NCP_FRAME_PARAM_OFFSET];
+}
+
+
+
+/**
+ * @brief Completes a request reserved by request_start()
+ *
+ * @param host Connection state
+ * @param code Message code of the request
+ * @param end Position following the last parameter
+ *
+ * @return Sequence number of the request
+ */
+static uint8_t request_end(ncp_host_t *host, uint8_t code, uint8_t *end)
+{
+    uint8_t *frame = &host->tx_buf[host->tx_length];
+
+    /* The sequence number NCP_SEQ_INDICATION is not used for requests. */
+    host->seq++;
+    if (NCP_SEQ_INDICATION == host->seq)
+    {
+        host->seq++;
+    }
+
+    host->tx_length += ncp_frame_complete(frame, host->seq, code,
+                                          (uint8_t)(end - (frame + NCP_FRAME_PARAM_OFFSET)));
+
+    return host->seq;
+}
+
+
+
+static uint8_t *put_addr_spec(uint8_t *ptr, const ncp_addr_spec_t *addr_spec)
+{
+    *ptr++ = addr_spec->AddrMode;
+    ptr = ncp_put_16(ptr, addr_spec->PANId);
+
+    return ncp_put_64(ptr, addr_spec->Addr);
+}
+
+
+
+static const uint8_t *get_addr_spec(const uint8_t *ptr, ncp_addr_spec_t *addr_spec)
+{
+    addr_spec->AddrMode = ptr[0];
+    addr_spec->PANId = ncp_get_16(&ptr[1]);
+    addr_spec->Addr = ncp_get_64(&ptr[3]);
+
+    return (ptr + NCP_ADDR_SPEC_LEN);
+}
+
+
+
+static const uint8_t *get_pan_desc(const uint8_t *ptr, ncp_pandescriptor_t *desc)
+{
+    ptr = get_addr_spec(ptr, &desc->CoordAddrSpec);
+    desc->LogicalChannel = ptr[0];
+    desc->ChannelPage = ptr[1];
+    desc->SuperframeSpec = ncp_get_16(&ptr[2]);
+    desc->GTSPermit = ptr[4];
+    desc->LinkQuality = ptr[5];
+    desc->TimeStamp = ncp_get_32(&ptr[6]);
+
+    return (ptr + 10);
+}
+
+
+
+uint8_t ncp_host_mcps_data_req(ncp_host_t *host,
+                               uint8_t SrcAddrMode,
+                               const ncp_addr_spec_t *DstAddrSpec,
+                               uint8_t msduLength,
+                               const uint8_t *msdu,
+                               uint8_t msduHandle,
+                               uint8_t TxOptions,
+                               uint8_t SecurityLevel,
+                               uint8_t KeyIdMode,
+                               uint8_t KeyIndex)
+{
+    uint8_t *ptr = request_start(host, 18 + msduLength);
+
+    *ptr++ = SrcAddrMode;
+    ptr = put_addr_spec(ptr, DstAddrSpec);
+    *ptr++ = msduHandle;
+    *ptr++ = TxOptions;
+    *ptr++ = SecurityLevel;
+    *ptr++ = KeyIdMode;
+    *ptr++ = KeyIndex;
+    *ptr++ = msduLength;
+    memcpy(ptr, msdu, msduLength);
+
+    return request_end(host, NCP_MCPS_DATA_REQUEST, ptr + msduLength);
+}
+
+
+
+uint8_t ncp_host_mcps_purge_req(ncp_host_t *host, uint8_t msduHandle)
+{
+    uint8_t *ptr = request_start(host, 1);
+
+    *ptr++ = msduHandle;
+
+    return request_end(host, NCP_MCPS_PURGE_REQUEST, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_associate_req(ncp_host_t *host,
+                                    uint8_t LogicalChannel,
+                                    uint8_t ChannelPage,
+                                    const ncp_addr_spec_t *CoordAddrSpec,
+                                    uint8_t CapabilityInformation)
+{
+    uint8_t *ptr = request_start(host, 3 + NCP_ADDR_SPEC_LEN);
+
+    *ptr++ = LogicalChannel;
+    *ptr++ = ChannelPage;
+    ptr = put_addr_spec(ptr, CoordAddrSpec);
+    *ptr++ = CapabilityInformation;
+
+    return request_end(host, NCP_MLME_ASSOCIATE_REQUEST, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_associate_resp(ncp_host_t *host,
+                                     uint64_t DeviceAddress,
+                                     uint16_t AssocShortAddress,
+                                     uint8_t status)
+{
+    uint8_t *ptr = request_start(host, 11);
+
+    ptr = ncp_put_64(ptr, DeviceAddress);
+    ptr = ncp_put_16(ptr, AssocShortAddress);
+    *ptr++ = status;
+
+    return request_end(host, NCP_MLME_ASSOCIATE_RESPONSE, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_disassociate_req(ncp_host_t *host,
+                                       const ncp_addr_spec_t *DeviceAddrSpec,
+                                       uint8_t DisassociateReason,
+                                       bool TxIndirect)
+{
+    uint8_t *ptr = request_start(host, NCP_ADDR_SPEC_LEN + 2);
+
+    ptr = put_addr_spec(ptr, DeviceAddrSpec);
+    *ptr++ = DisassociateReason;
+    *ptr++ = TxIndirect;
+
+    return request_end(host, NCP_MLME_DISASSOCIATE_REQUEST, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_get_req(ncp_host_t *host, uint8_t PIBAttribute)
+{
+    uint8_t *ptr = request_start(host, 1);
+
+    *ptr++ = PIBAttribute;
+
+    return request_end(host, NCP_MLME_GET_REQUEST, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_orphan_resp(ncp_host_t *host,
+                                  uint64_t OrphanAddress,
+                                  uint16_t ShortAddress,
+                                  bool AssociatedMember)
+{
+    uint8_t *ptr = request_start(host, 11);
+
+    ptr = ncp_put_64(ptr, OrphanAddress);
+    ptr = ncp_put_16(ptr, ShortAddress);
+    *ptr++ = AssociatedMember;
+
+    return request_end(host, NCP_MLME_ORPHAN_RESPONSE, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_poll_req(ncp_host_t *host,
+                               const ncp_addr_spec_t *CoordAddrSpec)
+{
+    uint8_t *ptr = request_start(host, NCP_ADDR_SPEC_LEN);
+
+    ptr = put_addr_spec(ptr, CoordAddrSpec);
+
+    return request_end(host, NCP_MLME_POLL_REQUEST, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_reset_req(ncp_host_t *host, bool SetDefaultPib)
+{
+    uint8_t *ptr = request_start(host, 1);
+
+    *ptr++ = SetDefaultPib;
+
+    return request_end(host, NCP_MLME_RESET_REQUEST, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_set_req(ncp_host_t *host,
+                              uint8_t PIBAttribute,
+                              const void *PIBAttributeValue,
+                              uint8_t PIBAttributeLength)
+{
+    uint8_t *ptr = request_start(host, 1 + PIBAttributeLength);
+
+    *ptr++ = PIBAttribute;
+    memcpy(ptr, PIBAttributeValue, PIBAttributeLength);
+
+    return request_end(host, NCP_MLME_SET_REQUEST, ptr + PIBAttributeLength);
+}
+
+
+
+uint8_t ncp_host_mlme_rx_enable_req(ncp_host_t *host,
+                                    bool DeferPermit,
+                                    uint32_t RxOnTime,
+                                    uint32_t RxOnDuration)
+{
+    uint8_t *ptr = request_start(host, 9);
+
+    *ptr++ = DeferPermit;
+    ptr = ncp_put_32(ptr, RxOnTime);
+    ptr = ncp_put_32(ptr, RxOnDuration);
+
+    return request_end(host, NCP_MLME_RX_ENABLE_REQUEST, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_scan_req(ncp_host_t *host,
+                               uint8_t ScanType,
+                               uint32_t ScanChannels,
+                               uint8_t ScanDuration,
+                               uint8_t ChannelPage)
+{
+    uint8_t *ptr = request_start(host, 7);
+
+    *ptr++ = ScanType;
+    ptr = ncp_put_32(ptr, ScanChannels);
+    *ptr++ = ScanDuration;
+    *ptr++ = ChannelPage;
+
+    return request_end(host, NCP_MLME_SCAN_REQUEST, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_start_req(ncp_host_t *host,
+                                uint16_t PANId,
+                                uint8_t LogicalChannel,
+                                uint8_t ChannelPage,
+                                uint8_t BeaconOrder,
+                                uint8_t SuperframeOrder,
+                                bool PANCoordinator,
+                                bool BatteryLifeExtension,
+                                bool CoordRealignment)
+{
+    uint8_t *ptr = request_start(host, 9);
+
+    ptr = ncp_put_16(ptr, PANId);
+    *ptr++ = LogicalChannel;
+    *ptr++ = ChannelPage;
+    *ptr++ = BeaconOrder;
+    *ptr++ = SuperframeOrder;
+    *ptr++ = PANCoordinator;
+    *ptr++ = BatteryLifeExtension;
+    *ptr++ = CoordRealignment;
+
+    return request_end(host, NCP_MLME_START_REQUEST, ptr);
+}
+
+
+
+uint8_t ncp_host_mlme_sync_req(ncp_host_t *host,
+                               uint8_t LogicalChannel,
+                               uint8_t ChannelPage,
+                               bool TrackBeacon)
+{
+    uint8_t *ptr = request_start(host, 3);
+
+    *ptr++ = LogicalChannel;
+    *ptr++ = ChannelPage;
+    *ptr++ = TrackBeacon;
+
+    return request_end(host, NCP_MLME_SYNC_REQUEST, ptr);
+}
+
+
+
+/**
+ * @brief Decodes a message of the NCP
+ *
+ * @param event Decoded message; seq and code have to be set
+ * @param param Parameters of the message
+ * @param length Length of the parameters
+ *
+ * @return true if the length of the parameters matches the message
+ */
+static bool decode(ncp_event_t *event, const uint8_t *param, uint8_t length)
+{
+    const uint8_t *ptr;
+    uint8_t addr_list_length;
+    uint8_t i;
+
+    switch (event->code)
+    {
+        case NCP_STATUS:
+            if (length != 2)
+            {
+                return false;
+            }
+            event->u.ncp_status.request = param[0];
+            event->u.ncp_status.status = param[1];
+            return true;
+
+        case NCP_MCPS_DATA_CONFIRM:
+            if (length != 6)
+            {
+                return false;
+            }
+            event->u.data_conf.msduHandle = param[0];
+            event->u.data_conf.status = param[1];
+            event->u.data_conf.Timestamp = ncp_get_32(&param[2]);
+            return true;
+
+        case NCP_MCPS_DATA_INDICATION:
+            if ((length < (2 * NCP_ADDR_SPEC_LEN + 11)) ||
+                (length != (2 * NCP_ADDR_SPEC_LEN + 11 + param[2 * NCP_ADDR_SPEC_LEN + 10])))
+            {
+                return false;
+            }
+            ptr = get_addr_spec(param, &event->u.data_ind.SrcAddrSpec);
+            ptr = get_addr_spec(ptr, &event->u.data_ind.DstAddrSpec);
+            event->u.data_ind.mpduLinkQuality = ptr[0];
+            event->u.data_ind.mpduRssi = (int8_t)ptr[1];
+            event->u.data_ind.DSN = ptr[2];
+            event->u.data_ind.Timestamp = ncp_get_32(&ptr[3]);
+            event->u.data_ind.SecurityLevel = ptr[7];
+            event->u.data_ind.KeyIdMode = ptr[8];
+            event->u.data_ind.KeyIndex = ptr[9];
+            event->u.data_ind.msduLength = ptr[10];
+            event->u.data_ind.msdu = &ptr[11];
+            return true;
+
+        case NCP_MCPS_PURGE_CONFIRM:
+            if (length != 2)
+            {
+                return false;
+            }
+            event->u.purge_conf.msduHandle = param[0];
+            event->u.purge_conf.status = param[1];
+            return true;
+
+        case NCP_MLME_ASSOCIATE_INDICATION:
+            if (length != 9)
+            {
+                return false;
+            }
+            event->u.associate_ind.DeviceAddress = ncp_get_64(&param[0]);
+            event->u.associate_ind.CapabilityInformation = param[8];
+            return true;
+
+        case NCP_MLME_ASSOCIATE_CONFIRM:
+            if (length != 3)
+            {
+                return false;
+            }
+            event->u.associate_conf.AssocShortAddress = ncp_get_16(&param[0]);
+            event->u.associate_conf.status = param[2];
+            return true;
+
+        case NCP_MLME_DISASSOCIATE_INDICATION:
+            if (length != 9)
+            {
+                return false;
+            }
+            event->u.disassociate_ind.DeviceAddress = ncp_get_64(&param[0]);
+            event->u.disassociate_ind.DisassociateReason = param[8];
+            return true;
+
+        case NCP_MLME_DISASSOCIATE_CONFIRM:
+            if (length != (1 + NCP_ADDR_SPEC_LEN))
+            {
+                return false;
+            }
+            event->u.disassociate_conf.status = param[0];
+            get_addr_spec(&param[1], &event->u.disassociate_conf.DeviceAddrSpec);
+            return true;
+
+        case NCP_MLME_BEACON_NOTIFY_INDICATION:
+            if (length < (3 + NCP_PAN_DESC_LEN))
+            {
+                return false;
+            }
+            event->u.beacon_notify_ind.BSN = param[0];
+            ptr = get_pan_desc(&param[1], &event->u.beacon_notify_ind.PANDescriptor);
+            event->u.beacon_notify_ind.PendAddrSpec = ptr[0];
+            addr_list_length = NUM_SHORT_ADDR_PENDING(ptr[0]) * 2 +
+                               NUM_EXTENDED_ADDR_PENDING(ptr[0]) * 8;
+            if (length < (3 + NCP_PAN_DESC_LEN + addr_list_length))
+            {
+                return false;
+            }
+            event->u.beacon_notify_ind.AddrList = &ptr[1];
+            ptr += 1 + addr_list_length;
+            event->u.beacon_notify_ind.sduLength = ptr[0];
+            event->u.beacon_notify_ind.sdu = &ptr[1];
+            return (length == (3 + NCP_PAN_DESC_LEN + addr_list_length + ptr[0]));
+
+        case NCP_MLME_ORPHAN_INDICATION:
+            if (length != 8)
+            {
+                return false;
+            }
+            event->u.orphan_ind.OrphanAddress = ncp_get_64(&param[0]);
+            return true;
+
+        case NCP_MLME_SCAN_CONFIRM:
+            if (length < 8)
+            {
+                return false;
+            }
+            event->u.scan_conf.status = param[0];
+            event->u.scan_conf.ScanType = param[1];
+            event->u.scan_conf.ChannelPage = param[2];
+            event->u.scan_conf.UnscannedChannels = ncp_get_32(&param[3]);
+            event->u.scan_conf.ResultListSize = param[7];
+            event->u.scan_conf.EnergyList = &param[8];
+            if (length == (8 + param[7]))
+            {
+                /* Energy levels, or no results */
+                return true;
+            }
+            if ((length != (8 + param[7] * NCP_PAN_DESC_LEN)) ||
+                (param[7] > NCP_HOST_MAX_PAN_DESC))
+            {
+                return false;
+            }
+            event->u.scan_conf.EnergyList = NULL;
+            ptr = &param[8];
+            for (i = 0; i < param[7]; i++)
+            {
+                ptr = get_pan_desc(ptr, &event->u.scan_conf.PANDescriptorList[i]);
+            }
+            return true;
+
+        case NCP_MLME_COMM_STATUS_INDICATION:
+            if (length != (2 * NCP_ADDR_SPEC_LEN + 1))
+            {
+                return false;
+            }
+            ptr = get_addr_spec(param, &event->u.comm_status_ind.SrcAddrSpec);
+            ptr = get_addr_spec(ptr, &event->u.comm_status_ind.DstAddrSpec);
+            event->u.comm_status_ind.status = ptr[0];
+            return true;
+
+        case NCP_MLME_SYNC_LOSS_INDICATION:
+            if (length != 5)
+            {
+                return false;
+            }
+            event->u.sync_loss_ind.LossReason = param[0];
+            event->u.sync_loss_ind.PANId = ncp_get_16(&param[1]);
+            event->u.sync_loss_ind.LogicalChannel = param[3];
+            event->u.sync_loss_ind.ChannelPage = param[4];
+            return true;
+
+        case NCP_MLME_GET_CONFIRM:
+            if (length < 2)
+            {
+                return false;
+            }
+            event->u.get_conf.status = param[0];
+            event->u.get_conf.PIBAttribute = param[1];
+            event->u.get_conf.PIBAttributeLength = length - 2;
+            event->u.get_conf.PIBAttributeValue = &param[2];
+            return true;
+
+        case NCP_MLME_SET_CONFIRM:
+            if (length != 2)
+            {
+                return false;
+            }
+            event->u.set_conf.status = param[0];
+            event->u.set_conf.PIBAttribute = param[1];
+            return true;
+
+        case NCP_MLME_RESET_CONFIRM:
+        case NCP_MLME_RX_ENABLE_CONFIRM:
+        case NCP_MLME_START_CONFIRM:
+        case NCP_MLME_POLL_CONFIRM:
+            if (length != 1)
+            {
+                return false;
+            }
+            event->u.conf.status = param[0];
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+
+void ncp_host_input(ncp_host_t *host, const uint8_t *data, uint16_t length)
+{
+    ncp_event_t event;
+    uint16_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        if (!ncp_rx_octet(&host->rx, data[i]))
+        {
+            continue;
+        }
+
+        event.seq = host->rx.msg[0];
+        event.code = host->rx.msg[1];
+        if (decode(&event, &host->rx.msg[2], host->rx.length - 2))
+        {
+            host->event(host->context, &event);
+        }
+        else
+        {
+            host->malformed++;
+        }
+    }
+}
+
+/* EOF */
@@ -0,0 +1,969 @@
+/**
+ * @file ncp_loopback.c
+ *
+ * @brief Loopback test of the MAC network co-processor (NCP)
+ *
+ * The NCP firmware (ncp.c) and the host library (ncp_host.c) are linked
+ * into one host program. The serial interface is emulated by two pipes in
+ * memory, which accept only small chunks per call like a real SIO driver,
+ * and the MAC is replaced by a stub that queues the requests and delivers
+ * their confirms from wpan_task(). A data request is looped back as data
+ * indication.
+ *
+ * The test checks the encoding of the requests, confirms and indications,
+ * the assignment of the confirms to many outstanding requests, the
+ * rejection of requests while too many are pending, the resynchronization
+ * after corrupted frames and the batching of messages into few writes.
+ * The program returns the number of failed checks.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "pal.h"
+#include "mac_api.h"
+#include "ieee_const.h"
+#include "ncp.h"
+#include "ncp_host.h"
+
+/* === Macros ============================================================== */
+
+/** Size of each emulated pipe */
+#define PIPE_SIZE                       (4096)
+
+/** Maximum number of octets accepted by one pal_sio_tx() */
+#define SIO_TX_CHUNK                    (64)
+
+/** Number of requests the stub MAC can queue */
+#define MAC_QUEUE_SIZE                  (32)
+
+/** Maximum number of events recorded by the host */
+#define MAX_EVENTS                      (256)
+
+/** Number of data requests outstanding at a time */
+#define IN_FLIGHT                       (12)
+
+/** Checks a condition and counts the failures */
+#define CHECK(cond)                                                     \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("  FAILED line %d: %s\n", __LINE__, #cond);          \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/* === Types =============================================================== */
+
+/**
+ * Emulated serial pipe
+ */
+typedef struct pipe_tag
+{
+    uint8_t data[PIPE_SIZE];
+    uint16_t head;
+    uint16_t tail;
+    /** Number of write calls that transferred data */
+    uint32_t writes;
+} pipe_t;
+
+/**
+ * Request queued in the stub MAC
+ */
+typedef struct mac_request_tag
+{
+    uint8_t code;
+    uint8_t handle;
+    uint8_t param;
+    uint32_t channels;
+    wpan_addr_spec_t addr_spec;
+    uint8_t length;
+    uint8_t msdu[aMaxMACPayloadSize];
+} mac_request_t;
+
+/**
+ * Event recorded by the host
+ */
+typedef struct record_tag
+{
+    ncp_event_t event;
+    /** Copy of the msdu of a data indication or the value of a get confirm */
+    uint8_t data[NCP_MSG_MAX_LEN];
+} record_t;
+
+/* === Globals ============================================================= */
+
+static pipe_t host_to_ncp;
+static pipe_t ncp_to_host;
+
+static mac_request_t mac_queue[MAC_QUEUE_SIZE];
+static uint8_t mac_queue_count;
+static bool mac_reject;
+static uint8_t mac_pib[256][8];
+
+static ncp_host_t host;
+static record_t records[MAX_EVENTS];
+static uint16_t record_count;
+
+static int failures;
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+static uint16_t pipe_used(const pipe_t *pipe)
+{
+    return (uint16_t)(pipe->tail - pipe->head);
+}
+
+
+
+static uint16_t pipe_write(pipe_t *pipe, const uint8_t *data, uint16_t length)
+{
+    uint16_t i;
+
+    if (length > (PIPE_SIZE - pipe_used(pipe)))
+    {
+        length = PIPE_SIZE - pipe_used(pipe);
+    }
+    for (i = 0; i < length; i++)
+    {
+        pipe->data[pipe->tail++ % PIPE_SIZE] = data[i];
+    }
+    if (length > 0)
+    {
+        pipe->writes++;
+    }
+
+    return length;
+}
+
+
+
+static uint16_t pipe_read(pipe_t *pipe, uint8_t *data, uint16_t max_length)
+{
+    uint16_t i;
+
+    if (max_length > pipe_used(pipe))
+    {
+        max_length = pipe_used(pipe);
+    }
+    for (i = 0; i < max_length; i++)
+    {
+        data[i] = pipe->data[pipe->head++ % PIPE_SIZE];
+    }
+
+    return max_length;
+}
+
+
+
+/*
+ * Serial interface of the NCP
+ */
+
+retval_t pal_sio_init(uint8_t sio_unit)
+{
+    return MAC_SUCCESS;
+}
+
+
+
+uint8_t pal_sio_tx(uint8_t sio_unit, uint8_t *data, uint8_t length)
+{
+    if (length > SIO_TX_CHUNK)
+    {
+        length = SIO_TX_CHUNK;
+    }
+
+    return (uint8_t)pipe_write(&ncp_to_host, data, length);
+}
+
+
+
+uint8_t pal_sio_rx(uint8_t sio_unit, uint8_t *data, uint8_t max_length)
+{
+    return (uint8_t)pipe_read(&host_to_ncp, data, max_length);
+}
+
+
+
+bool pal_is_timer_running(uint8_t timer_id)
+{
+    return false;
+}
+
+
+
+/*
+ * Stub of the MAC
+ */
+
+uint8_t mac_get_pib_attribute_size(uint8_t pib_attribute_id)
+{
+    switch (pib_attribute_id)
+    {
+        case phyCurrentChannel:
+            return sizeof(uint8_t);
+        case macPANId:
+        case macShortAddress:
+            return sizeof(uint16_t);
+        case macCoordExtendedAddress:
+            return sizeof(uint64_t);
+        default:
+            return 0;
+    }
+}
+
+
+
+static mac_request_t *mac_queue_add(uint8_t code)
+{
+    mac_request_t *req;
+
+    if (mac_reject || (MAC_QUEUE_SIZE == mac_queue_count))
+    {
+        return NULL;
+    }
+    req = &mac_queue[mac_queue_count++];
+    memset(req, 0, sizeof(mac_request_t));
+    req->code = code;
+
+    return req;
+}
+
+
+
+bool wpan_mcps_data_req(uint8_t SrcAddrMode,
+                        wpan_addr_spec_t *DstAddrSpec,
+                        uint8_t msduLength,
+                        uint8_t *msdu,
+                        uint8_t msduHandle,
+                        uint8_t TxOptions)
+{
+    mac_request_t *req = mac_queue_add(NCP_MCPS_DATA_REQUEST);
+
+    if (NULL == req)
+    {
+        return false;
+    }
+    req->handle = msduHandle;
+    req->param = SrcAddrMode;
+    req->addr_spec = *DstAddrSpec;
+    req->length = msduLength;
+    memcpy(req->msdu, msdu, msduLength);
+
+    return true;
+}
+
+
+
+bool wpan_mcps_purge_req(const uint8_t msduHandle)
+{
+    mac_request_t *req = mac_queue_add(NCP_MCPS_PURGE_REQUEST);
+
+    if (NULL == req)
+    {
+        return false;
+    }
+    req->handle = msduHandle;
+
+    return true;
+}
+
+
+
+bool wpan_mlme_associate_req(uint8_t LogicalChannel,
+                             uint8_t ChannelPage,
+                             wpan_addr_spec_t *CoordAddrSpec,
+                             uint8_t CapabilityInformation)
+{
+    return (NULL != mac_queue_add(NCP_MLME_ASSOCIATE_REQUEST));
+}
+
+
+
+bool wpan_mlme_associate_resp(uint64_t DeviceAddress,
+                              uint16_t AssocShortAddress,
+                              uint8_t status)
+{
+    mac_request_t *req = mac_queue_add(NCP_MLME_ASSOCIATE_RESPONSE);
+
+    if (NULL == req)
+    {
+        return false;
+    }
+    req->addr_spec.AddrMode = WPAN_ADDRMODE_LONG;
+    req->addr_spec.Addr.long_address = DeviceAddress;
+
+    return true;
+}
+
+
+
+bool wpan_mlme_disassociate_req(wpan_addr_spec_t *DeviceAddrSpec,
+                                uint8_t DisassociateReason,
+                                bool TxIndirect)
+{
+    mac_request_t *req = mac_queue_add(NCP_MLME_DISASSOCIATE_REQUEST);
+
+    if (NULL == req)
+    {
+        return false;
+    }
+    req->addr_spec = *DeviceAddrSpec;
+
+    return true;
+}
+
+
+
+bool wpan_mlme_get_req(uint8_t PIBAttribute)
+{
+    mac_request_t *req = mac_queue_add(NCP_MLME_GET_REQUEST);
+
+    if (NULL == req)
+    {
+        return false;
+    }
+    req->param = PIBAttribute;
+
+    return true;
+}
+
+
+
+bool wpan_mlme_orphan_resp(uint64_t OrphanAddress,
+                           uint16_t ShortAddress,
+                           bool AssociatedMember)
+{
+    return (NULL != mac_queue_add(NCP_MLME_ORPHAN_RESPONSE));
+}
+
+
+
+bool wpan_mlme_poll_req(wpan_addr_spec_t *CoordAddrSpec)
+{
+    return (NULL != mac_queue_add(NCP_MLME_POLL_REQUEST));
+}
+
+
+
+bool wpan_mlme_reset_req(bool SetDefaultPib)
+{
+    return (NULL != mac_queue_add(NCP_MLME_RESET_REQUEST));
+}
+
+
+
+bool wpan_mlme_set_req(uint8_t PIBAttribute,
+                       void *PIBAttributeValue)
+{
+    mac_request_t *req = mac_queue_add(NCP_MLME_SET_REQUEST);
+
+    if (NULL == req)
+    {
+        return false;
+    }
+    req->param = PIBAttribute;
+    memcpy(mac_pib[PIBAttribute], PIBAttributeValue,
+           mac_get_pib_attribute_size(PIBAttribute));
+
+    return true;
+}
+
+
+
+bool wpan_mlme_rx_enable_req(bool DeferPermit,
+                             uint32_t RxOnTime,
+                             uint32_t RxOnDuration)
+{
+    return (NULL != mac_queue_add(NCP_MLME_RX_ENABLE_REQUEST));
+}
+
+
+
+bool wpan_mlme_scan_req(uint8_t ScanType,
+                        uint32_t ScanChannels,
+                        uint8_t ScanDuration,
+                        uint8_t ChannelPage)
+{
+    mac_request_t *req = mac_queue_add(NCP_MLME_SCAN_REQUEST);
+
+    if (NULL == req)
+    {
+        return false;
+    }
+    req->param = ScanType;
+    req->channels = ScanChannels;
+
+    return true;
+}
+
+
+
+bool wpan_mlme_start_req(uint16_t PANId,
+                         uint8_t LogicalChannel,
+                         uint8_t ChannelPage,
+                         uint8_t BeaconOrder,
+                         uint8_t SuperframeOrder,
+                         bool PANCoordinator,
+                         bool BatteryLifeExtension,
+                         bool CoordRealignment)
+{
+    return (NULL != mac_queue_add(NCP_MLME_START_REQUEST));
+}
+
+
+
+bool wpan_mlme_sync_req(uint8_t LogicalChannel,
+                        uint8_t ChannelPage,
+                        bool TrackBeacon)
+{
+    return (NULL != mac_queue_add(NCP_MLME_SYNC_REQUEST));
+}
+
+
+
+/**
+ * @brief Delivers the results of a scan request
+ */
+static void mac_scan(mac_request_t *req)
+{
+    uint8_t energy[32];
+    wpan_pandescriptor_t desc[2];
+    uint8_t payload[4] = { 'N', 'C', 'P', 0 };
+    uint8_t addr_list[2 + 8] = { 0x34, 0x12, 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t count = 0;
+    uint8_t i;
+
+    if (MLME_SCAN_TYPE_ED == req->param)
+    {
+        for (i = 0; i < 32; i++)
+        {
+            if (req->channels & (1UL << i))
+            {
+                energy[count++] = i * 3;
+            }
+        }
+        usr_mlme_scan_conf(MAC_SUCCESS, req->param, 0, 0, count, energy);
+        return;
+    }
+
+    memset(desc, 0, sizeof(desc));
+    for (i = 0; i < 2; i++)
+    {
+        desc[i].CoordAddrSpec.AddrMode = WPAN_ADDRMODE_SHORT;
+        desc[i].CoordAddrSpec.PANId = 0x1AAA + i;
+        desc[i].CoordAddrSpec.Addr.short_address = 0x0000;
+        desc[i].LogicalChannel = 11 + i;
+        desc[i].SuperframeSpec = 0xCFFF;
+        desc[i].LinkQuality = 200 + i;
+
+        /* One short and one extended address pending */
+        payload[3] = i;
+        usr_mlme_beacon_notify_ind(i, &desc[i], 0x11, addr_list, sizeof(payload), payload);
+    }
+    usr_mlme_scan_conf(MAC_SUCCESS, req->param, 0, 0, 2, desc);
+}
+
+
+
+bool wpan_task(void)
+{
+    mac_request_t *req;
+    wpan_addr_spec_t src_addr_spec;
+    uint8_t i;
+
+    if (0 == mac_queue_count)
+    {
+        return false;
+    }
+
+    for (i = 0; i < mac_queue_count; i++)
+    {
+        req = &mac_queue[i];
+        switch (req->code)
+        {
+            case NCP_MCPS_DATA_REQUEST:
+                /* Loop the frame back as if received from the destination. */
+                src_addr_spec = req->addr_spec;
+                usr_mcps_data_ind(&src_addr_spec, &req->addr_spec, req->length,
+                                  req->msdu, 0xFF, req->handle);
+                usr_mcps_data_conf(req->handle, MAC_SUCCESS);
+                break;
+
+            case NCP_MCPS_PURGE_REQUEST:
+                usr_mcps_purge_conf(req->handle, MAC_INVALID_HANDLE);
+                break;
+
+            case NCP_MLME_ASSOCIATE_REQUEST:
+                usr_mlme_associate_conf(0x1234, MAC_SUCCESS);
+                break;
+
+            case NCP_MLME_ASSOCIATE_RESPONSE:
+            case NCP_MLME_ORPHAN_RESPONSE:
+                src_addr_spec.AddrMode = WPAN_ADDRMODE_LONG;
+                src_addr_spec.PANId = 0xCAFE;
+                src_addr_spec.Addr.long_address = 0x1122334455667788ULL;
+                usr_mlme_comm_status_ind(&src_addr_spec, &req->addr_spec, MAC_SUCCESS);
+                break;
+
+            case NCP_MLME_DISASSOCIATE_REQUEST:
+                usr_mlme_disassociate_conf(MAC_SUCCESS, &req->addr_spec);
+                break;
+
+            case NCP_MLME_GET_REQUEST:
+                usr_mlme_get_conf(MAC_SUCCESS, req->param, mac_pib[req->param]);
+                break;
+
+            case NCP_MLME_POLL_REQUEST:
+                usr_mlme_poll_conf(MAC_NO_DATA);
+                break;
+
+            case NCP_MLME_RESET_REQUEST:
+                usr_mlme_reset_conf(MAC_SUCCESS);
+                break;
+
+            case NCP_MLME_SET_REQUEST:
+                usr_mlme_set_conf(MAC_SUCCESS, req->param);
+                break;
+
+            case NCP_MLME_RX_ENABLE_REQUEST:
+                usr_mlme_rx_enable_conf(MAC_SUCCESS);
+                break;
+
+            case NCP_MLME_SCAN_REQUEST:
+                mac_scan(req);
+                break;
+
+            case NCP_MLME_START_REQUEST:
+                usr_mlme_start_conf(MAC_SUCCESS);
+                break;
+
+            default:
+                break;
+        }
+    }
+    mac_queue_count = 0;
+
+    return true;
+}
+
+
+
+/*
+ * Host side
+ */
+
+static void host_write(void *context, const uint8_t *data, uint16_t length)
+{
+    pipe_write(&host_to_ncp, data, length);
+}
+
+
+
+static void host_event(void *context, const ncp_event_t *event)
+{
+    record_t *rec;
+
+    if (MAX_EVENTS == record_count)
+    {
+        return;
+    }
+    rec = &records[record_count++];
+    rec->event = *event;
+
+    /* The pointers of the event are only valid during the callback. */
+    if (NCP_MCPS_DATA_INDICATION == event->code)
+    {
+        memcpy(rec->data, event->u.data_ind.msdu, event->u.data_ind.msduLength);
+    }
+    else if (NCP_MLME_GET_CONFIRM == event->code)
+    {
+        memcpy(rec->data, event->u.get_conf.PIBAttributeValue,
+               event->u.get_conf.PIBAttributeLength);
+    }
+    else if (NCP_MLME_BEACON_NOTIFY_INDICATION == event->code)
+    {
+        memcpy(rec->data, event->u.beacon_notify_ind.sdu,
+               event->u.beacon_notify_ind.sduLength);
+    }
+}
+
+
+
+/**
+ * @brief Passes the messages of the NCP to the host
+ */
+static void host_receive(void)
+{
+    uint8_t data[50];
+    uint16_t length;
+
+    while ((length = pipe_read(&ncp_to_host, data, sizeof(data))) > 0)
+    {
+        ncp_host_input(&host, data, length);
+    }
+}
+
+
+
+/**
+ * @brief Runs the main loop of the NCP until all messages are exchanged
+ */
+static void run(void)
+{
+    uint8_t i;
+
+    ncp_host_flush(&host);
+    for (i = 0; i < 8; i++)
+    {
+        wpan_task();
+        ncp_task();
+        host_receive();
+    }
+}
+
+
+
+static void clear_records(void)
+{
+    record_count = 0;
+}
+
+
+
+/**
+ * @brief Finds the record of a message
+ *
+ * @param seq Sequence number of the message
+ * @param code Message code
+ *
+ * @return Record, NULL if no such message has been received
+ */
+static const record_t *find(uint8_t seq, uint8_t code)
+{
+    uint16_t i;
+
+    for (i = 0; i < record_count; i++)
+    {
+        if ((records[i].event.seq == seq) && (records[i].event.code == code))
+        {
+            return &records[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+
+static uint16_t count(uint8_t code)
+{
+    uint16_t i;
+    uint16_t n = 0;
+
+    for (i = 0; i < record_count; i++)
+    {
+        if (records[i].event.code == code)
+        {
+            n++;
+        }
+    }
+
+    return n;
+}
+
+
+
+/**
+ * @brief Checks the response of the NCP to a request
+ */
+static bool accepted(uint8_t seq, uint8_t request, uint8_t status)
+{
+    const record_t *rec = find(seq, NCP_STATUS);
+
+    return ((NULL != rec) &&
+            (rec->event.u.ncp_status.request == request) &&
+            (rec->event.u.ncp_status.status == status));
+}
+
+
+
+static void test_pib(void)
+{
+    uint8_t seq_reset, seq_set, seq_get, seq_bad;
+    uint16_t pan_id = 0xCAFE;
+    const record_t *rec;
+
+    printf("Reset, set and get\n");
+    clear_records();
+    seq_reset = ncp_host_mlme_reset_req(&host, true);
+    seq_set = ncp_host_mlme_set_req(&host, macPANId, &pan_id, sizeof(pan_id));
+    seq_get = ncp_host_mlme_get_req(&host, macPANId);
+    /* Value of the wrong size */
+    seq_bad = ncp_host_mlme_set_req(&host, macPANId, &pan_id, 1);
+    run();
+
+    CHECK(accepted(seq_reset, NCP_MLME_RESET_REQUEST, NCP_ACCEPTED));
+    CHECK(accepted(seq_set, NCP_MLME_SET_REQUEST, NCP_ACCEPTED));
+    CHECK(accepted(seq_get, NCP_MLME_GET_REQUEST, NCP_ACCEPTED));
+    CHECK(accepted(seq_bad, NCP_MLME_SET_REQUEST, NCP_MALFORMED));
+
+    rec = find(seq_reset, NCP_MLME_RESET_CONFIRM);
+    CHECK((NULL != rec) && (MAC_SUCCESS == rec->event.u.conf.status));
+    rec = find(seq_set, NCP_MLME_SET_CONFIRM);
+    CHECK((NULL != rec) && (macPANId == rec->event.u.set_conf.PIBAttribute));
+    rec = find(seq_get, NCP_MLME_GET_CONFIRM);
+    CHECK((NULL != rec) && (2 == rec->event.u.get_conf.PIBAttributeLength) &&
+          (0xCAFE == ncp_get_16(rec->data)));
+    CHECK(NULL == find(seq_bad, NCP_MLME_SET_CONFIRM));
+}
+
+
+
+static void test_data_in_flight(void)
+{
+    ncp_addr_spec_t dst = { WPAN_ADDRMODE_SHORT, 0xCAFE, 0x0001 };
+    uint8_t seq[IN_FLIGHT];
+    uint8_t msdu[100];
+    const record_t *rec;
+    uint32_t writes;
+    uint16_t frames;
+    uint8_t i;
+
+    printf("%d data requests in flight\n", IN_FLIGHT);
+    clear_records();
+    for (i = 0; i < IN_FLIGHT; i++)
+    {
+        memset(msdu, i, sizeof(msdu));
+        seq[i] = ncp_host_mcps_data_req(&host, WPAN_ADDRMODE_SHORT, &dst,
+                                        10 + i * 5, msdu, 0x80 + i,
+                                        WPAN_TXOPT_ACK, 0, 0, 0);
+    }
+    writes = ncp_to_host.writes;
+    run();
+    writes = ncp_to_host.writes - writes;
+
+    for (i = 0; i < IN_FLIGHT; i++)
+    {
+        CHECK(accepted(seq[i], NCP_MCPS_DATA_REQUEST, NCP_ACCEPTED));
+        rec = find(seq[i], NCP_MCPS_DATA_CONFIRM);
+        CHECK((NULL != rec) && (rec->event.u.data_conf.msduHandle == 0x80 + i) &&
+              (MAC_SUCCESS == rec->event.u.data_conf.status));
+    }
+    CHECK(IN_FLIGHT == count(NCP_MCPS_DATA_INDICATION));
+    for (i = 0; i < record_count; i++)
+    {
+        if (NCP_MCPS_DATA_INDICATION == records[i].event.code)
+        {
+            rec = &records[i];
+            CHECK(NCP_SEQ_INDICATION == rec->event.seq);
+            CHECK(0xCAFE == rec->event.u.data_ind.DstAddrSpec.PANId);
+            CHECK(0x0001 == rec->event.u.data_ind.SrcAddrSpec.Addr);
+            CHECK(rec->data[0] == rec->data[rec->event.u.data_ind.msduLength - 1]);
+        }
+    }
+
+    frames = record_count;
+    printf("  %u messages in %u SIO writes of at most %d octets\n",
+           frames, (unsigned)writes, SIO_TX_CHUNK);
+}
+
+
+
+static void test_busy(void)
+{
+    ncp_addr_spec_t dst = { WPAN_ADDRMODE_SHORT, 0xCAFE, 0x0001 };
+    uint8_t seq[NCP_MAX_PENDING + 4];
+    uint8_t msdu[4] = { 1, 2, 3, 4 };
+    uint8_t i;
+
+    printf("Pending table full and MAC queue full\n");
+    clear_records();
+    for (i = 0; i < (NCP_MAX_PENDING + 4); i++)
+    {
+        seq[i] = ncp_host_mcps_data_req(&host, WPAN_ADDRMODE_SHORT, &dst,
+                                        sizeof(msdu), msdu, i, 0, 0, 0, 0);
+    }
+    ncp_host_flush(&host);
+
+    /* Let the NCP receive all requests before the MAC confirms any. */
+    ncp_task();
+    host_receive();
+    for (i = 0; i < (NCP_MAX_PENDING + 4); i++)
+    {
+        CHECK(accepted(seq[i], NCP_MCPS_DATA_REQUEST,
+                       (i < NCP_MAX_PENDING) ? NCP_ACCEPTED : NCP_BUSY));
+    }
+    run();
+    CHECK(NCP_MAX_PENDING == count(NCP_MCPS_DATA_CONFIRM));
+
+    clear_records();
+    mac_reject = true;
+    seq[0] = ncp_host_mlme_start_req(&host, 0xCAFE, 11, 0, 15, 15, true, false, false);
+    run();
+    mac_reject = false;
+    CHECK(accepted(seq[0], NCP_MLME_START_REQUEST, NCP_REJECTED));
+    CHECK(0 == count(NCP_MLME_START_CONFIRM));
+}
+
+
+
+static void test_scan(void)
+{
+    uint8_t seq_ed, seq_active;
+    const record_t *rec;
+
+    printf("Energy detect and active scan\n");
+    clear_records();
+    seq_ed = ncp_host_mlme_scan_req(&host, MLME_SCAN_TYPE_ED, 0x07FFF800, 3, 0);
+    seq_active = ncp_host_mlme_scan_req(&host, MLME_SCAN_TYPE_ACTIVE, 0x00001800, 3, 0);
+    run();
+
+    rec = find(seq_ed, NCP_MLME_SCAN_CONFIRM);
+    CHECK((NULL != rec) && (16 == rec->event.u.scan_conf.ResultListSize));
+    rec = find(seq_active, NCP_MLME_SCAN_CONFIRM);
+    CHECK((NULL != rec) && (2 == rec->event.u.scan_conf.ResultListSize) &&
+          (0x1AAB == rec->event.u.scan_conf.PANDescriptorList[1].CoordAddrSpec.PANId) &&
+          (12 == rec->event.u.scan_conf.PANDescriptorList[1].LogicalChannel) &&
+          (201 == rec->event.u.scan_conf.PANDescriptorList[1].LinkQuality));
+    CHECK(2 == count(NCP_MLME_BEACON_NOTIFY_INDICATION));
+    rec = find(NCP_SEQ_INDICATION, NCP_MLME_BEACON_NOTIFY_INDICATION);
+    CHECK((NULL != rec) && (0x11 == rec->event.u.beacon_notify_ind.PendAddrSpec) &&
+          (4 == rec->event.u.beacon_notify_ind.sduLength) &&
+          (0 == memcmp(rec->data, "NCP", 3)));
+}
+
+
+
+static void test_other_requests(void)
+{
+    ncp_addr_spec_t coord = { WPAN_ADDRMODE_SHORT, 0xCAFE, 0x0000 };
+    uint8_t seq[8];
+    const record_t *rec;
+
+    printf("Remaining requests\n");
+    clear_records();
+    seq[0] = ncp_host_mlme_associate_req(&host, 11, 0, &coord, 0x80);
+    seq[1] = ncp_host_mlme_associate_resp(&host, 0x0102030405060708ULL, 0x0042, 0);
+    seq[2] = ncp_host_mlme_disassociate_req(&host, &coord, 2, false);
+    seq[3] = ncp_host_mlme_poll_req(&host, &coord);
+    seq[4] = ncp_host_mlme_rx_enable_req(&host, false, 0, 1000);
+    seq[5] = ncp_host_mcps_purge_req(&host, 0x55);
+    seq[6] = ncp_host_mlme_start_req(&host, 0xCAFE, 11, 0, 15, 15, true, false, false);
+    seq[7] = ncp_host_mlme_sync_req(&host, 11, 0, false);
+    run();
+
+    rec = find(seq[0], NCP_MLME_ASSOCIATE_CONFIRM);
+    CHECK((NULL != rec) && (0x1234 == rec->event.u.associate_conf.AssocShortAddress));
+    rec = find(seq[1], NCP_MLME_COMM_STATUS_INDICATION);
+    CHECK((NULL != rec) &&
+          (0x0102030405060708ULL == rec->event.u.comm_status_ind.DstAddrSpec.Addr));
+    rec = find(seq[2], NCP_MLME_DISASSOCIATE_CONFIRM);
+    CHECK((NULL != rec) && (0xCAFE == rec->event.u.disassociate_conf.DeviceAddrSpec.PANId));
+    rec = find(seq[3], NCP_MLME_POLL_CONFIRM);
+    CHECK((NULL != rec) && (MAC_NO_DATA == rec->event.u.conf.status));
+    CHECK(NULL != find(seq[4], NCP_MLME_RX_ENABLE_CONFIRM));
+    rec = find(seq[5], NCP_MCPS_PURGE_CONFIRM);
+    CHECK((NULL != rec) && (0x55 == rec->event.u.purge_conf.msduHandle));
+    CHECK(NULL != find(seq[6], NCP_MLME_START_CONFIRM));
+#if (MAC_SYNC_REQUEST == 1)
+    CHECK(accepted(seq[7], NCP_MLME_SYNC_REQUEST, NCP_ACCEPTED));
+#else
+    CHECK(accepted(seq[7], NCP_MLME_SYNC_REQUEST, NCP_UNSUPPORTED));
+#endif
+}
+
+
+
+static void test_resync(void)
+{
+    uint8_t frame[NCP_FRAME_MAX_LEN];
+    uint8_t garbage[] = { 0x00, NCP_SOF, 0xFF, 0x01, NCP_SOF, 0x00 };
+    uint16_t length;
+    uint16_t errors = host.rx.errors;
+    uint8_t seq;
+
+    printf("Corrupted frames and unknown requests\n");
+    clear_records();
+
+    /* Corrupted get request */
+    frame[NCP_FRAME_PARAM_OFFSET] = macPANId;
+    length = ncp_frame_complete(frame, 0xF0, NCP_MLME_GET_REQUEST, 1);
+    frame[NCP_FRAME_PARAM_OFFSET] ^= 0x01;
+    pipe_write(&host_to_ncp, frame, length);
+    pipe_write(&host_to_ncp, garbage, sizeof(garbage));
+
+    /* Unknown request */
+    length = ncp_frame_complete(frame, 0xF1, 0x3F, 0);
+    pipe_write(&host_to_ncp, frame, length);
+
+    /* Get request with a wrong length */
+    frame[NCP_FRAME_PARAM_OFFSET] = macPANId;
+    frame[NCP_FRAME_PARAM_OFFSET + 1] = 0;
+    length = ncp_frame_complete(frame, 0xF2, NCP_MLME_GET_REQUEST, 2);
+    pipe_write(&host_to_ncp, frame, length);
+
+    seq = ncp_host_mlme_get_req(&host, macPANId);
+    run();
+
+    CHECK(NULL == find(0xF0, NCP_STATUS));
+    CHECK(accepted(0xF1, 0x3F, NCP_UNSUPPORTED));
+    CHECK(accepted(0xF2, NCP_MLME_GET_REQUEST, NCP_MALFORMED));
+    CHECK(accepted(seq, NCP_MLME_GET_REQUEST, NCP_ACCEPTED));
+    CHECK(NULL != find(seq, NCP_MLME_GET_CONFIRM));
+
+    /* Corruption on the way to the host */
+    clear_records();
+    seq = ncp_host_mlme_get_req(&host, macPANId);
+    ncp_host_flush(&host);
+    ncp_task();
+    ncp_to_host.data[(ncp_to_host.head + 5) % PIPE_SIZE] ^= 0x80;
+    host_receive();
+    run();
+    CHECK(NULL == find(seq, NCP_STATUS));
+    CHECK(NULL != find(seq, NCP_MLME_GET_CONFIRM));
+    CHECK(host.rx.errors == errors + 1);
+}
+
+
+
+/**
+ * @brief Main function of the loopback test
+ */
+int main(void)
+{
+    ncp_init(SIO_0);
+    ncp_host_init(&host, host_write, host_event, NULL);
+
+    test_pib();
+    test_data_in_flight();
+    test_busy();
+    test_scan();
+    test_other_requests();
+    test_resync();
+
+    CHECK(0 == host.malformed);
+    printf("%s: %d failed checks\n", (0 == failures) ? "PASSED" : "FAILED", failures);
+
+    return failures;
+}
+
+/* EOF */
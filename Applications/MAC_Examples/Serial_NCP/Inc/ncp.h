@@ -0,0 +1,98 @@
+/**
+ * @file ncp.h
+ *
+ * @brief Interface of the MAC network co-processor (NCP) firmware
+ *
+ * The NCP receives the requests of the MAC API as binary messages from the
+ * serial interface, calls the corresponding wpan_* function and sends the
+ * confirms and indications of the MAC (usr_* callbacks) back to the host.
+ * See ncp_protocol.h for the messages.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef NCP_H
+#define NCP_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include "ncp_protocol.h"
+
+/* === Macros =============================================================== */
+
+/**
+ * Size of the transmit buffer of the NCP. The messages created during one
+ * call of wpan_task() and ncp_task() are collected here and passed to the
+ * serial interface by one pal_sio_tx(). It has to hold at least one frame
+ * of the maximum length.
+ */
+#ifndef NCP_TX_BUF_SIZE
+#define NCP_TX_BUF_SIZE                 (512)
+#endif
+
+/**
+ * Number of accepted requests that may await their confirm. Further
+ * requests are answered with NCP_BUSY.
+ */
+#ifndef NCP_MAX_PENDING
+#define NCP_MAX_PENDING                 (16)
+#endif
+
+/**
+ * Number of octets read from the serial interface at once
+ */
+#ifndef NCP_RX_CHUNK_SIZE
+#define NCP_RX_CHUNK_SIZE               (32)
+#endif
+
+#if (NCP_TX_BUF_SIZE < NCP_FRAME_MAX_LEN)
+#error "NCP_TX_BUF_SIZE has to hold a frame of the maximum length"
+#endif
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the NCP
+ *
+ * The serial interface has to be initialized by pal_sio_init() before.
+ *
+ * @param sio_unit Serial interface used for the communication with the host
+ */
+void ncp_init(uint8_t sio_unit);
+
+/**
+ * @brief Processes the requests received from the host and sends the
+ *        collected messages
+ *
+ * Has to be called after each wpan_task(), so that the confirms and
+ * indications of one MAC task are sent as one write to the serial
+ * interface.
+ */
+void ncp_task(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NCP_H */
+/* EOF */
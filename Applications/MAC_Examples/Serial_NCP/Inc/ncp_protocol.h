@@ -0,0 +1,284 @@
+/**
+ * @file ncp_protocol.h
+ *
+ * @brief Serial protocol of the MAC network co-processor (NCP)
+ *
+ * This file is shared by the NCP firmware and the host library. It defines
+ * the framing of the serial messages, the message codes and the layout of
+ * the message parameters.
+ *
+ * Each message is sent as a frame:
+ *
+ *     SOF | LEN | SEQ | CODE | PARAMETERS | CRC
+ *
+ * - SOF is the start of frame delimiter NCP_SOF.
+ * - LEN is the number of octets of SEQ, CODE and PARAMETERS (2 ... NCP_MSG_MAX_LEN).
+ * - SEQ is the sequence number assigned to a request by the host. The NCP
+ *   returns it in the NCP_STATUS message for this request and in the
+ *   confirm of this request; indications carry the sequence number 0.
+ * - CODE is the message code, see below.
+ * - CRC is the CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of
+ *   LEN ... PARAMETERS, low byte first.
+ *
+ * A receiver that finds a wrong CRC or an invalid length discards the frame
+ * and searches for the next SOF, so the protocol resynchronizes itself.
+ * Several frames may be transferred by one write to the serial interface.
+ *
+ * All parameters with more than one octet are sent in little endian byte
+ * order. An address specification (ADDR_SPEC, 11 octets) is sent as
+ * AddrMode (1), PANId (2), Addr (8); a short address occupies the lower two
+ * octets of Addr. A PAN descriptor (PAN_DESC, 21 octets) is sent as
+ * CoordAddrSpec (ADDR_SPEC), LogicalChannel (1), ChannelPage (1),
+ * SuperframeSpec (2), GTSPermit (1), LinkQuality (1), TimeStamp (4).
+ * PIB attribute values are sent in the byte order of the NCP, which is
+ * little endian for all supported MCUs. Parameters not supported by the
+ * build of the NCP (e.g. security parameters without MAC_SECURITY_ZIP)
+ * are ignored on reception and sent as 0.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef NCP_PROTOCOL_H
+#define NCP_PROTOCOL_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+/** Start of frame delimiter */
+#define NCP_SOF                         (0x7E)
+
+/** Maximum number of octets of SEQ, CODE and PARAMETERS of a message */
+#define NCP_MSG_MAX_LEN                 (250)
+
+/** Number of octets of a frame in addition to the message */
+#define NCP_FRAME_OVERHEAD              (4)
+
+/** Maximum length of a frame */
+#define NCP_FRAME_MAX_LEN               (NCP_MSG_MAX_LEN + NCP_FRAME_OVERHEAD)
+
+/** Offset of the parameters within a frame: SOF, LEN, SEQ, CODE */
+#define NCP_FRAME_PARAM_OFFSET          (4)
+
+/** Sequence number of indications */
+#define NCP_SEQ_INDICATION              (0)
+
+/** Length of an address specification */
+#define NCP_ADDR_SPEC_LEN               (11)
+
+/** Length of a PAN descriptor */
+#define NCP_PAN_DESC_LEN                (21)
+
+/*
+ * Message codes of requests and responses sent by the host.
+ * The values are those of enum msg_code of the MAC (mac_msg_const.h).
+ */
+
+/** MLME-ASSOCIATE.request: LogicalChannel (1), ChannelPage (1), CoordAddrSpec (ADDR_SPEC), CapabilityInformation (1) */
+#define NCP_MLME_ASSOCIATE_REQUEST              (0x01)
+/** MLME-ASSOCIATE.response: DeviceAddress (8), AssocShortAddress (2), status (1) */
+#define NCP_MLME_ASSOCIATE_RESPONSE             (0x02)
+/** MCPS-DATA.request: SrcAddrMode (1), DstAddrSpec (ADDR_SPEC), msduHandle (1), TxOptions (1), SecurityLevel (1), KeyIdMode (1), KeyIndex (1), msduLength (1), msdu (msduLength) */
+#define NCP_MCPS_DATA_REQUEST                   (0x03)
+/** MCPS-PURGE.request: msduHandle (1) */
+#define NCP_MCPS_PURGE_REQUEST                  (0x04)
+/** MLME-DISASSOCIATE.request: DeviceAddrSpec (ADDR_SPEC), DisassociateReason (1), TxIndirect (1) */
+#define NCP_MLME_DISASSOCIATE_REQUEST           (0x05)
+/** MLME-SET.request: PIBAttribute (1), PIBAttributeValue (remaining octets) */
+#define NCP_MLME_SET_REQUEST                    (0x06)
+/** MLME-ORPHAN.response: OrphanAddress (8), ShortAddress (2), AssociatedMember (1) */
+#define NCP_MLME_ORPHAN_RESPONSE                (0x07)
+/** MLME-GET.request: PIBAttribute (1) */
+#define NCP_MLME_GET_REQUEST                    (0x08)
+/** MLME-RESET.request: SetDefaultPib (1) */
+#define NCP_MLME_RESET_REQUEST                  (0x09)
+/** MLME-RX-ENABLE.request: DeferPermit (1), RxOnTime (4), RxOnDuration (4) */
+#define NCP_MLME_RX_ENABLE_REQUEST              (0x0A)
+/** MLME-SCAN.request: ScanType (1), ScanChannels (4), ScanDuration (1), ChannelPage (1) */
+#define NCP_MLME_SCAN_REQUEST                   (0x0B)
+/** MLME-START.request: PANId (2), LogicalChannel (1), ChannelPage (1), BeaconOrder (1), SuperframeOrder (1), PANCoordinator (1), BatteryLifeExtension (1), CoordRealignment (1) */
+#define NCP_MLME_START_REQUEST                  (0x0D)
+/** MLME-POLL.request: CoordAddrSpec (ADDR_SPEC) */
+#define NCP_MLME_POLL_REQUEST                   (0x0E)
+/** MLME-SYNC.request: LogicalChannel (1), ChannelPage (1), TrackBeacon (1) */
+#define NCP_MLME_SYNC_REQUEST                   (0x0F)
+
+/*
+ * Message codes of confirms and indications sent by the NCP.
+ * The values are those of enum msg_code of the MAC (mac_msg_const.h).
+ */
+
+/** MCPS-DATA.confirm: msduHandle (1), status (1), Timestamp (4) */
+#define NCP_MCPS_DATA_CONFIRM                   (0x10)
+/** MCPS-DATA.indication: SrcAddrSpec (ADDR_SPEC), DstAddrSpec (ADDR_SPEC), mpduLinkQuality (1), mpduRssi (1), DSN (1), Timestamp (4), SecurityLevel (1), KeyIdMode (1), KeyIndex (1), msduLength (1), msdu (msduLength) */
+#define NCP_MCPS_DATA_INDICATION                (0x11)
+/** MCPS-PURGE.confirm: msduHandle (1), status (1) */
+#define NCP_MCPS_PURGE_CONFIRM                  (0x12)
+/** MLME-ASSOCIATE.indication: DeviceAddress (8), CapabilityInformation (1) */
+#define NCP_MLME_ASSOCIATE_INDICATION           (0x13)
+/** MLME-ASSOCIATE.confirm: AssocShortAddress (2), status (1) */
+#define NCP_MLME_ASSOCIATE_CONFIRM              (0x14)
+/** MLME-DISASSOCIATE.indication: DeviceAddress (8), DisassociateReason (1) */
+#define NCP_MLME_DISASSOCIATE_INDICATION        (0x15)
+/** MLME-DISASSOCIATE.confirm: status (1), DeviceAddrSpec (ADDR_SPEC) */
+#define NCP_MLME_DISASSOCIATE_CONFIRM           (0x16)
+/** MLME-BEACON-NOTIFY.indication: BSN (1), PANDescriptor (PAN_DESC), PendAddrSpec (1), AddrList (2 octets per short, 8 per extended address), sduLength (1), sdu (sduLength) */
+#define NCP_MLME_BEACON_NOTIFY_INDICATION       (0x17)
+/** MLME-ORPHAN.indication: OrphanAddress (8) */
+#define NCP_MLME_ORPHAN_INDICATION              (0x1A)
+/** MLME-SCAN.confirm: status (1), ScanType (1), ChannelPage (1), UnscannedChannels (4), ResultListSize (1), ResultList (1 octet per energy level or PAN_DESC per PAN descriptor) */
+#define NCP_MLME_SCAN_CONFIRM                   (0x1B)
+/** MLME-COMM-STATUS.indication: SrcAddrSpec (ADDR_SPEC), DstAddrSpec (ADDR_SPEC), status (1); confirms an associate or orphan response */
+#define NCP_MLME_COMM_STATUS_INDICATION         (0x1C)
+/** MLME-SYNC-LOSS.indication: LossReason (1), PANId (2), LogicalChannel (1), ChannelPage (1) */
+#define NCP_MLME_SYNC_LOSS_INDICATION           (0x1D)
+/** MLME-GET.confirm: status (1), PIBAttribute (1), PIBAttributeValue (remaining octets) */
+#define NCP_MLME_GET_CONFIRM                    (0x1E)
+/** MLME-SET.confirm: status (1), PIBAttribute (1) */
+#define NCP_MLME_SET_CONFIRM                    (0x1F)
+/** MLME-RESET.confirm: status (1) */
+#define NCP_MLME_RESET_CONFIRM                  (0x20)
+/** MLME-RX-ENABLE.confirm: status (1) */
+#define NCP_MLME_RX_ENABLE_CONFIRM              (0x21)
+/** MLME-START.confirm: status (1) */
+#define NCP_MLME_START_CONFIRM                  (0x22)
+/** MLME-POLL.confirm: status (1) */
+#define NCP_MLME_POLL_CONFIRM                   (0x23)
+
+/**
+ * Response of the NCP to each request: request code (1), status (1), see
+ * ncp_status_t. A request is only confirmed if it has been accepted.
+ */
+#define NCP_STATUS                              (0x40)
+
+/* === Types ================================================================ */
+
+/**
+ * Status of the NCP_STATUS message
+ */
+typedef enum ncp_status_tag
+{
+    /** The request has been passed to the MAC. */
+    NCP_ACCEPTED                        = (0x00),
+    /** The MAC has rejected the request, e.g. for lack of buffers. */
+    NCP_REJECTED                        = (0x01),
+    /** The request is unknown or not supported by the build of the NCP. */
+    NCP_UNSUPPORTED                     = (0x02),
+    /** The length of the parameters does not match the request. */
+    NCP_MALFORMED                       = (0x03),
+    /** Too many requests await their confirm; the request may be repeated. */
+    NCP_BUSY                            = (0x04)
+} ncp_status_t;
+
+/**
+ * State of the reception of a frame
+ */
+typedef struct ncp_rx_tag
+{
+    /** Number of octets of the frame received so far, 0 while searching for SOF */
+    uint16_t index;
+    /** Length of the message of the frame */
+    uint8_t length;
+    /** CRC of the frame received so far */
+    uint16_t crc;
+    /** Number of frames discarded because of a wrong CRC or length */
+    uint16_t errors;
+    /** Message of the received frame: SEQ, CODE, PARAMETERS, CRC */
+    uint8_t msg[NCP_MSG_MAX_LEN + 2];
+} ncp_rx_t;
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Updates a CRC-16/CCITT by one octet
+ *
+ * @param crc CRC so far
+ * @param data Next octet
+ *
+ * @return Updated CRC
+ */
+uint16_t ncp_crc_update(uint16_t crc, uint8_t data);
+
+/**
+ * @brief Completes a frame
+ *
+ * The parameters have to be written starting at frame + NCP_FRAME_PARAM_OFFSET.
+ * This function writes SOF, LEN, SEQ, CODE and the CRC.
+ *
+ * @param frame Frame buffer
+ * @param seq Sequence number
+ * @param code Message code
+ * @param param_length Number of octets of the parameters
+ *
+ * @return Length of the frame
+ */
+uint16_t ncp_frame_complete(uint8_t *frame, uint8_t seq, uint8_t code,
+                            uint8_t param_length);
+
+/**
+ * @brief Initializes the reception of frames
+ *
+ * @param rx Reception state
+ */
+void ncp_rx_init(ncp_rx_t *rx);
+
+/**
+ * @brief Processes a received octet
+ *
+ * @param rx Reception state
+ * @param data Received octet
+ *
+ * @return true if a frame with a valid CRC is complete; its message is
+ *         available in rx->msg (SEQ, CODE, PARAMETERS) with the length
+ *         rx->length until the next call
+ */
+bool ncp_rx_octet(ncp_rx_t *rx, uint8_t data);
+
+/**
+ * @brief Writes parameters in little endian byte order
+ *
+ * @param ptr Position of the parameter
+ * @param value Value of the parameter
+ *
+ * @return Position following the parameter
+ */
+uint8_t *ncp_put_16(uint8_t *ptr, uint16_t value);
+uint8_t *ncp_put_32(uint8_t *ptr, uint32_t value);
+uint8_t *ncp_put_64(uint8_t *ptr, uint64_t value);
+
+/**
+ * @brief Reads parameters in little endian byte order
+ *
+ * @param ptr Position of the parameter
+ *
+ * @return Value of the parameter
+ */
+uint16_t ncp_get_16(const uint8_t *ptr);
+uint32_t ncp_get_32(const uint8_t *ptr);
+uint64_t ncp_get_64(const uint8_t *ptr);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NCP_PROTOCOL_H */
+/* EOF */
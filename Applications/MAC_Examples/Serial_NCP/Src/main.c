@@ -0,0 +1,90 @@
+/**
+ * @file main.c
+ *
+ * @brief MAC Example Serial NCP
+ *
+ * This is the firmware of a MAC network co-processor (NCP). The complete
+ * MAC API is made available to a host via the serial interface (UART or
+ * USB); the host sends the requests and receives the confirms and
+ * indications as binary messages, see ncp_protocol.h.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "pal.h"
+#include "tal.h"
+#include "mac_api.h"
+#include "app_config.h"
+#include "ncp.h"
+
+/* === TYPES =============================================================== */
+
+
+/* === MACROS ============================================================== */
+
+
+/* === GLOBALS ============================================================= */
+
+
+/* === PROTOTYPES ========================================================== */
+
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Main function of the network co-processor
+ *
+ * This function initializes the MAC and the serial interface and implements
+ * the main loop. The MAC is not reset here; this is done by the host with
+ * the first request.
+ */
+int main(void)
+{
+    /* Initialize the MAC layer and its underlying layers, like PAL, TAL, BMM. */
+    if (wpan_init() != MAC_SUCCESS)
+    {
+        /*
+         * Stay here; we need a valid IEEE address.
+         * Check kit documentation how to create an IEEE address
+         * and to store it into the EEPROM.
+         */
+        pal_alert();
+    }
+
+    /*
+     * The stack is initialized above, hence the global interrupts are enabled
+     * here.
+     */
+    pal_global_irq_enable();
+
+    /* Initialize the serial interface used for communication with the host. */
+    if (pal_sio_init(NCP_SIO_CHANNEL) != MAC_SUCCESS)
+    {
+        /* Something went wrong during initialization. */
+        pal_alert();
+    }
+
+    ncp_init(NCP_SIO_CHANNEL);
+
+    /* Main loop */
+    while (1)
+    {
+        wpan_task();
+        ncp_task();
+    }
+}
+
+/* EOF */
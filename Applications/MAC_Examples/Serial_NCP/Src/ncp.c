@@ -0,0 +1,1003 @@
+/**
+ * @file ncp.c
+ *
+ * @brief MAC network co-processor (NCP) firmware
+ *
+ * The requests received from the host are decoded and passed to the MAC
+ * API. The confirms and indications of the MAC are encoded by the usr_*
+ * callbacks of this file and collected in a transmit buffer, which is
+ * passed to the serial interface at the end of each ncp_task().
+ *
+ * Each accepted request that is confirmed by the MAC is kept in a table of
+ * pending requests until its confirm is delivered, so that the confirm
+ * carries the sequence number of the request. A confirm is assigned to the
+ * oldest pending request of the same primitive, for MCPS-DATA and
+ * MCPS-PURGE additionally of the same msduHandle.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "mac_api.h"
+#include "ieee_const.h"
+#include "mac_internal.h"
+#include "ncp.h"
+
+/* === Macros ============================================================== */
+
+/** Length of the parameters of a MCPS-DATA.request without the msdu */
+#define DATA_REQ_LEN                    (18)
+
+/** Confirm code of requests without confirm */
+#define NO_CONFIRM                      (0)
+
+/* === Types =============================================================== */
+
+/**
+ * Request awaiting its confirm
+ */
+typedef struct ncp_pending_tag
+{
+    /** Sequence number of the request */
+    uint8_t seq;
+    /** Message code of the confirm */
+    uint8_t confirm;
+    /** msduHandle of MCPS-DATA and MCPS-PURGE requests */
+    uint8_t handle;
+} ncp_pending_t;
+
+/* === Globals ============================================================= */
+
+/** Serial interface used for the communication with the host */
+static uint8_t ncp_sio_unit;
+
+/** Reception state of the frames from the host */
+static ncp_rx_t ncp_rx;
+
+/** Messages to be sent to the host */
+static uint8_t ncp_tx_buf[NCP_TX_BUF_SIZE];
+
+/** Octets of ncp_tx_buf already passed to the serial interface */
+static uint16_t ncp_tx_start;
+
+/** Octets of ncp_tx_buf filled with messages */
+static uint16_t ncp_tx_end;
+
+/** Requests awaiting their confirm, the oldest first */
+static ncp_pending_t ncp_pending[NCP_MAX_PENDING];
+
+/** Number of requests awaiting their confirm */
+static uint8_t ncp_pending_count;
+
+/* === Prototypes ========================================================== */
+
+static void ncp_handle_request(uint8_t seq, uint8_t code,
+                               uint8_t *param, uint8_t length);
+
+/* === Implementation ====================================================== */
+
+void ncp_init(uint8_t sio_unit)
+{
+    ncp_sio_unit = sio_unit;
+    ncp_rx_init(&ncp_rx);
+    ncp_tx_start = 0;
+    ncp_tx_end = 0;
+    ncp_pending_count = 0;
+}
+
+
+
+/**
+ * @brief Passes the collected messages to the serial interface
+ *
+ * As many octets are passed as the serial interface accepts.
+ */
+static void ncp_tx_flush(void)
+{
+    uint16_t length;
+    uint8_t sent;
+
+    while (ncp_tx_start < ncp_tx_end)
+    {
+        length = ncp_tx_end - ncp_tx_start;
+        if (length > 0xFF)
+        {
+            length = 0xFF;
+        }
+
+        sent = pal_sio_tx(ncp_sio_unit, &ncp_tx_buf[ncp_tx_start], (uint8_t)length);
+        if (0 == sent)
+        {
+            /* The serial interface is busy. */
+            break;
+        }
+        ncp_tx_start += sent;
+    }
+
+    if (ncp_tx_start == ncp_tx_end)
+    {
+        ncp_tx_start = 0;
+        ncp_tx_end = 0;
+    }
+}
+
+
+
+/**
+ * @brief Reserves space for a frame in the transmit buffer
+ *
+ * If the transmit buffer is full, this function waits until the serial
+ * interface has accepted enough octets. Hence the confirms and indications
+ * are never dropped; the MAC is slowed down to the speed of the serial
+ * interface instead.
+ *
+ * @param param_length Maximum length of the parameters of the frame
+ *
+ * @return Start of the frame; the parameters are written at
+ *         NCP_FRAME_PARAM_OFFSET
+ */
+static uint8_t *ncp_tx_reserve(uint8_t param_length)
+{
+    uint16_t needed = (uint16_t)param_length + NCP_FRAME_OVERHEAD + 2;
+
+    while ((NCP_TX_BUF_SIZE - ncp_tx_end) < needed)
+    {
+        if (ncp_tx_start > 0)
+        {
+            /* Move the octets not yet sent to the start of the buffer. */
+            memmove(ncp_tx_buf, &ncp_tx_buf[ncp_tx_start], ncp_tx_end - ncp_tx_start);
+            ncp_tx_end -= ncp_tx_start;
+            ncp_tx_start = 0;
+        }
+        else
+        {
+            ncp_tx_flush();
+        }
+    }
+
+    return &ncp_tx_buf[ncp_tx_end];
+}
+
+
+
+/**
+ * @brief Completes a frame reserved by ncp_tx_reserve()
+ *
+ * @param frame Start of the frame
+ * @param seq Sequence number
+ * @param code Message code
+ * @param end Position following the last parameter
+ */
+static void ncp_tx_commit(uint8_t *frame, uint8_t seq, uint8_t code, uint8_t *end)
+{
+    ncp_tx_end += ncp_frame_complete(frame, seq, code,
+                                     (uint8_t)(end - (frame + NCP_FRAME_PARAM_OFFSET)));
+}
+
+
+
+/**
+ * @brief Sends the response to a request
+ *
+ * @param seq Sequence number of the request
+ * @param code Message code of the request
+ * @param status Status of the request
+ */
+static void ncp_send_status(uint8_t seq, uint8_t code, ncp_status_t status)
+{
+    uint8_t *frame = ncp_tx_reserve(2);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    *ptr++ = code;
+    *ptr++ = (uint8_t)status;
+    ncp_tx_commit(frame, seq, NCP_STATUS, ptr);
+}
+
+
+
+/**
+ * @brief Removes the pending request of a confirm
+ *
+ * @param confirm Message code of the confirm
+ * @param handle msduHandle of the confirm, if confirm is a MCPS confirm
+ *
+ * @return Sequence number of the request, NCP_SEQ_INDICATION if there is
+ *         no pending request for this confirm
+ */
+static uint8_t ncp_pending_remove(uint8_t confirm, uint8_t handle)
+{
+    uint8_t i;
+    uint8_t seq;
+
+    for (i = 0; i < ncp_pending_count; i++)
+    {
+        if ((ncp_pending[i].confirm == confirm) &&
+            (((NCP_MCPS_DATA_CONFIRM != confirm) && (NCP_MCPS_PURGE_CONFIRM != confirm)) ||
+             (ncp_pending[i].handle == handle)))
+        {
+            seq = ncp_pending[i].seq;
+            ncp_pending_count--;
+            memmove(&ncp_pending[i], &ncp_pending[i + 1],
+                    (ncp_pending_count - i) * sizeof(ncp_pending_t));
+            return seq;
+        }
+    }
+
+    return NCP_SEQ_INDICATION;
+}
+
+
+
+void ncp_task(void)
+{
+    uint8_t data[NCP_RX_CHUNK_SIZE];
+    uint8_t length;
+    uint8_t i;
+
+    /* Process the received octets. */
+    while ((length = pal_sio_rx(ncp_sio_unit, data, NCP_RX_CHUNK_SIZE)) > 0)
+    {
+        for (i = 0; i < length; i++)
+        {
+            if (ncp_rx_octet(&ncp_rx, data[i]))
+            {
+                ncp_handle_request(ncp_rx.msg[0], ncp_rx.msg[1],
+                                   &ncp_rx.msg[2], ncp_rx.length - 2);
+            }
+        }
+    }
+
+    /* Send the messages of this and the preceding wpan_task() at once. */
+    ncp_tx_flush();
+}
+
+
+
+/**
+ * @brief Reads an address specification
+ *
+ * @param ptr Position of the address specification
+ * @param addr_spec Address specification read
+ */
+static void ncp_get_addr_spec(const uint8_t *ptr, wpan_addr_spec_t *addr_spec)
+{
+    addr_spec->AddrMode = ptr[0];
+    addr_spec->PANId = ncp_get_16(&ptr[1]);
+    if (WPAN_ADDRMODE_SHORT == addr_spec->AddrMode)
+    {
+        addr_spec->Addr.long_address = 0;
+        addr_spec->Addr.short_address = ncp_get_16(&ptr[3]);
+    }
+    else
+    {
+        addr_spec->Addr.long_address = ncp_get_64(&ptr[3]);
+    }
+}
+
+
+
+/**
+ * @brief Writes an address specification
+ *
+ * @param ptr Position of the address specification
+ * @param addr_spec Address specification to be written
+ *
+ * @return Position following the address specification
+ */
+static uint8_t *ncp_put_addr_spec(uint8_t *ptr, wpan_addr_spec_t *addr_spec)
+{
+    *ptr++ = addr_spec->AddrMode;
+    ptr = ncp_put_16(ptr, addr_spec->PANId);
+    if (WPAN_ADDRMODE_SHORT == addr_spec->AddrMode)
+    {
+        return ncp_put_64(ptr, addr_spec->Addr.short_address);
+    }
+    if (WPAN_ADDRMODE_LONG == addr_spec->AddrMode)
+    {
+        return ncp_put_64(ptr, addr_spec->Addr.long_address);
+    }
+
+    return ncp_put_64(ptr, 0);
+}
+
+
+
+/**
+ * @brief Converts the result of a MAC request to the status of the response
+ *
+ * @param accepted Result of the wpan_* function
+ *
+ * @return Status of the response
+ */
+static ncp_status_t ncp_status(bool accepted)
+{
+    return (accepted ? NCP_ACCEPTED : NCP_REJECTED);
+}
+
+
+
+/**
+ * @brief Decodes a request and passes it to the MAC
+ *
+ * @param seq Sequence number of the request
+ * @param code Message code of the request
+ * @param param Parameters of the request
+ * @param length Length of the parameters
+ */
+static void ncp_handle_request(uint8_t seq, uint8_t code,
+                               uint8_t *param, uint8_t length)
+{
+    ncp_status_t status = NCP_MALFORMED;
+    uint8_t confirm = NO_CONFIRM;
+    uint8_t handle = 0;
+#if ((MAC_ASSOCIATION_REQUEST_CONFIRM == 1) || \
+     (MAC_DISASSOCIATION_BASIC_SUPPORT == 1) || \
+     (MAC_INDIRECT_DATA_BASIC == 1))
+    wpan_addr_spec_t addr_spec;
+#endif
+
+    if ((ncp_pending_count == NCP_MAX_PENDING) && (NCP_MLME_SYNC_REQUEST != code))
+    {
+        ncp_send_status(seq, code, NCP_BUSY);
+        return;
+    }
+
+    switch (code)
+    {
+        case NCP_MCPS_DATA_REQUEST:
+            {
+                wpan_addr_spec_t dst_addr_spec;
+
+                if ((length < DATA_REQ_LEN) || (length != (DATA_REQ_LEN + param[17])))
+                {
+                    break;
+                }
+                ncp_get_addr_spec(&param[1], &dst_addr_spec);
+                handle = param[12];
+                confirm = NCP_MCPS_DATA_CONFIRM;
+#ifdef MAC_SECURITY_ZIP
+                status = ncp_status(wpan_mcps_data_req(param[0], &dst_addr_spec,
+                                                       param[17], &param[DATA_REQ_LEN],
+                                                       handle, param[13],
+                                                       param[14], param[15], param[16]));
+#else
+                status = ncp_status(wpan_mcps_data_req(param[0], &dst_addr_spec,
+                                                       param[17], &param[DATA_REQ_LEN],
+                                                       handle, param[13]));
+#endif  /* MAC_SECURITY_ZIP */
+            }
+            break;
+
+#if ((MAC_PURGE_REQUEST_CONFIRM == 1) && (MAC_INDIRECT_DATA_BASIC == 1))
+        case NCP_MCPS_PURGE_REQUEST:
+            if (length != 1)
+            {
+                break;
+            }
+            handle = param[0];
+            confirm = NCP_MCPS_PURGE_CONFIRM;
+            status = ncp_status(wpan_mcps_purge_req(handle));
+            break;
+#endif  /* ((MAC_PURGE_REQUEST_CONFIRM == 1) && (MAC_INDIRECT_DATA_BASIC == 1)) */
+
+#if (MAC_ASSOCIATION_REQUEST_CONFIRM == 1)
+        case NCP_MLME_ASSOCIATE_REQUEST:
+            if (length != (3 + NCP_ADDR_SPEC_LEN))
+            {
+                break;
+            }
+            ncp_get_addr_spec(&param[2], &addr_spec);
+            confirm = NCP_MLME_ASSOCIATE_CONFIRM;
+            status = ncp_status(wpan_mlme_associate_req(param[0], param[1], &addr_spec,
+                                                        param[2 + NCP_ADDR_SPEC_LEN]));
+            break;
+#endif  /* (MAC_ASSOCIATION_REQUEST_CONFIRM == 1) */
+
+#if (MAC_ASSOCIATION_INDICATION_RESPONSE == 1)
+        case NCP_MLME_ASSOCIATE_RESPONSE:
+            if (length != 11)
+            {
+                break;
+            }
+            confirm = NCP_MLME_COMM_STATUS_INDICATION;
+            status = ncp_status(wpan_mlme_associate_resp(ncp_get_64(&param[0]),
+                                                         ncp_get_16(&param[8]),
+                                                         param[10]));
+            break;
+#endif  /* (MAC_ASSOCIATION_INDICATION_RESPONSE == 1) */
+
+#if (MAC_DISASSOCIATION_BASIC_SUPPORT == 1)
+        case NCP_MLME_DISASSOCIATE_REQUEST:
+            if (length != (NCP_ADDR_SPEC_LEN + 2))
+            {
+                break;
+            }
+            ncp_get_addr_spec(&param[0], &addr_spec);
+            confirm = NCP_MLME_DISASSOCIATE_CONFIRM;
+            status = ncp_status(wpan_mlme_disassociate_req(&addr_spec,
+                                                           param[NCP_ADDR_SPEC_LEN],
+                                                           param[NCP_ADDR_SPEC_LEN + 1]));
+            break;
+#endif  /* (MAC_DISASSOCIATION_BASIC_SUPPORT == 1) */
+
+#if (MAC_GET_SUPPORT == 1)
+        case NCP_MLME_GET_REQUEST:
+            if (length != 1)
+            {
+                break;
+            }
+            confirm = NCP_MLME_GET_CONFIRM;
+            status = ncp_status(wpan_mlme_get_req(param[0]));
+            break;
+#endif  /* (MAC_GET_SUPPORT == 1) */
+
+#if (MAC_ORPHAN_INDICATION_RESPONSE == 1)
+        case NCP_MLME_ORPHAN_RESPONSE:
+            if (length != 11)
+            {
+                break;
+            }
+            confirm = NCP_MLME_COMM_STATUS_INDICATION;
+            status = ncp_status(wpan_mlme_orphan_resp(ncp_get_64(&param[0]),
+                                                      ncp_get_16(&param[8]),
+                                                      param[10]));
+            break;
+#endif  /* (MAC_ORPHAN_INDICATION_RESPONSE == 1) */
+
+#if (MAC_INDIRECT_DATA_BASIC == 1)
+        case NCP_MLME_POLL_REQUEST:
+            if (length != NCP_ADDR_SPEC_LEN)
+            {
+                break;
+            }
+            ncp_get_addr_spec(&param[0], &addr_spec);
+            confirm = NCP_MLME_POLL_CONFIRM;
+            status = ncp_status(wpan_mlme_poll_req(&addr_spec));
+            break;
+#endif  /* (MAC_INDIRECT_DATA_BASIC == 1) */
+
+        case NCP_MLME_RESET_REQUEST:
+            if (length != 1)
+            {
+                break;
+            }
+            confirm = NCP_MLME_RESET_CONFIRM;
+            status = ncp_status(wpan_mlme_reset_req(param[0]));
+            break;
+
+        case NCP_MLME_SET_REQUEST:
+            /* The value is copied by the MAC, so it may be unaligned. */
+            if ((length < 1) || ((length - 1) != mac_get_pib_attribute_size(param[0])))
+            {
+                break;
+            }
+            confirm = NCP_MLME_SET_CONFIRM;
+            status = ncp_status(wpan_mlme_set_req(param[0], &param[1]));
+            break;
+
+#if (MAC_RX_ENABLE_SUPPORT == 1)
+        case NCP_MLME_RX_ENABLE_REQUEST:
+            if (length != 9)
+            {
+                break;
+            }
+            confirm = NCP_MLME_RX_ENABLE_CONFIRM;
+            status = ncp_status(wpan_mlme_rx_enable_req(param[0],
+                                                        ncp_get_32(&param[1]),
+                                                        ncp_get_32(&param[5])));
+            break;
+#endif  /* (MAC_RX_ENABLE_SUPPORT == 1) */
+
+#if ((MAC_SCAN_ED_REQUEST_CONFIRM == 1)      || \
+     (MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1)  || \
+     (MAC_SCAN_PASSIVE_REQUEST_CONFIRM == 1) || \
+     (MAC_SCAN_ORPHAN_REQUEST_CONFIRM == 1))
+        case NCP_MLME_SCAN_REQUEST:
+            if (length != 7)
+            {
+                break;
+            }
+            confirm = NCP_MLME_SCAN_CONFIRM;
+            status = ncp_status(wpan_mlme_scan_req(param[0], ncp_get_32(&param[1]),
+                                                   param[5], param[6]));
+            break;
+#endif
+
+#if (MAC_START_REQUEST_CONFIRM == 1)
+        case NCP_MLME_START_REQUEST:
+            if (length != 9)
+            {
+                break;
+            }
+            confirm = NCP_MLME_START_CONFIRM;
+            status = ncp_status(wpan_mlme_start_req(ncp_get_16(&param[0]),
+                                                    param[2], param[3], param[4],
+                                                    param[5], param[6], param[7],
+                                                    param[8]));
+            break;
+#endif  /* (MAC_START_REQUEST_CONFIRM == 1) */
+
+#if (MAC_SYNC_REQUEST == 1)
+        case NCP_MLME_SYNC_REQUEST:
+            if (length != 3)
+            {
+                break;
+            }
+            /* A lost synchronization is indicated by MLME-SYNC-LOSS.indication. */
+            status = ncp_status(wpan_mlme_sync_req(param[0], param[1], param[2]));
+            break;
+#endif /* (MAC_SYNC_REQUEST == 1) */
+
+        default:
+            status = NCP_UNSUPPORTED;
+            break;
+    }
+
+    if ((NCP_ACCEPTED == status) && (NO_CONFIRM != confirm))
+    {
+        ncp_pending[ncp_pending_count].seq = seq;
+        ncp_pending[ncp_pending_count].confirm = confirm;
+        ncp_pending[ncp_pending_count].handle = handle;
+        ncp_pending_count++;
+    }
+
+    ncp_send_status(seq, code, status);
+}
+
+
+
+/*
+ * The following callbacks of the MAC encode the confirms and indications.
+ */
+
+#if defined(ENABLE_TSTAMP)
+void usr_mcps_data_conf(uint8_t msduHandle,
+                        uint8_t status,
+                        uint32_t Timestamp)
+#else
+void usr_mcps_data_conf(uint8_t msduHandle,
+                        uint8_t status)
+#endif  /* ENABLE_TSTAMP */
+{
+    uint8_t *frame = ncp_tx_reserve(6);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    *ptr++ = msduHandle;
+    *ptr++ = status;
+#if defined(ENABLE_TSTAMP)
+    ptr = ncp_put_32(ptr, Timestamp);
+#else
+    ptr = ncp_put_32(ptr, 0);
+#endif  /* ENABLE_TSTAMP */
+    ncp_tx_commit(frame,
+                  ncp_pending_remove(NCP_MCPS_DATA_CONFIRM, msduHandle),
+                  NCP_MCPS_DATA_CONFIRM, ptr);
+}
+
+
+
+#ifdef MAC_SECURITY_ZIP
+void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
+                       wpan_addr_spec_t *DstAddrSpec,
+                       uint8_t msduLength,
+                       uint8_t *msdu,
+                       uint8_t mpduLinkQuality,
+    #ifdef ENABLE_RSSI
+                       int8_t mpduRssi,
+    #endif  /* ENABLE_RSSI */
+                       uint8_t DSN,
+    #ifdef ENABLE_TSTAMP
+                       uint32_t Timestamp,
+    #endif  /* ENABLE_TSTAMP */
+                       uint8_t SecurityLevel,
+                       uint8_t KeyIdMode,
+                       uint8_t KeyIndex)
+#else   /* No MAC_SECURITY */
+void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
+                       wpan_addr_spec_t *DstAddrSpec,
+                       uint8_t msduLength,
+                       uint8_t *msdu,
+                       uint8_t mpduLinkQuality,
+    #ifdef ENABLE_RSSI
+                       int8_t mpduRssi,
+    #endif  /* ENABLE_RSSI */
+    #ifdef ENABLE_TSTAMP
+                       uint8_t DSN,
+                       uint32_t Timestamp)
+    #else
+                       uint8_t DSN)
+    #endif  /* ENABLE_TSTAMP */
+#endif  /* MAC_SECURITY */
+{
+    uint8_t *frame = ncp_tx_reserve(2 * NCP_ADDR_SPEC_LEN + 11 + msduLength);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    ptr = ncp_put_addr_spec(ptr, SrcAddrSpec);
+    ptr = ncp_put_addr_spec(ptr, DstAddrSpec);
+    *ptr++ = mpduLinkQuality;
+#ifdef ENABLE_RSSI
+    *ptr++ = (uint8_t)mpduRssi;
+#else
+    *ptr++ = 0;
+#endif  /* ENABLE_RSSI */
+    *ptr++ = DSN;
+#ifdef ENABLE_TSTAMP
+    ptr = ncp_put_32(ptr, Timestamp);
+#else
+    ptr = ncp_put_32(ptr, 0);
+#endif  /* ENABLE_TSTAMP */
+#ifdef MAC_SECURITY_ZIP
+    *ptr++ = SecurityLevel;
+    *ptr++ = KeyIdMode;
+    *ptr++ = KeyIndex;
+#else
+    *ptr++ = 0;
+    *ptr++ = 0;
+    *ptr++ = 0;
+#endif  /* MAC_SECURITY_ZIP */
+    *ptr++ = msduLength;
+    memcpy(ptr, msdu, msduLength);
+    ptr += msduLength;
+    ncp_tx_commit(frame, NCP_SEQ_INDICATION, NCP_MCPS_DATA_INDICATION, ptr);
+}
+
+
+
+#if ((MAC_PURGE_REQUEST_CONFIRM == 1) && (MAC_INDIRECT_DATA_BASIC == 1))
+void usr_mcps_purge_conf(uint8_t msduHandle,
+                         uint8_t status)
+{
+    uint8_t *frame = ncp_tx_reserve(2);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    *ptr++ = msduHandle;
+    *ptr++ = status;
+    ncp_tx_commit(frame,
+                  ncp_pending_remove(NCP_MCPS_PURGE_CONFIRM, msduHandle),
+                  NCP_MCPS_PURGE_CONFIRM, ptr);
+}
+#endif  /* ((MAC_PURGE_REQUEST_CONFIRM == 1) && (MAC_INDIRECT_DATA_BASIC == 1)) */
+
+
+
+#if (MAC_ASSOCIATION_REQUEST_CONFIRM == 1)
+void usr_mlme_associate_conf(uint16_t AssocShortAddress,
+                             uint8_t status)
+{
+    uint8_t *frame = ncp_tx_reserve(3);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    ptr = ncp_put_16(ptr, AssocShortAddress);
+    *ptr++ = status;
+    ncp_tx_commit(frame,
+                  ncp_pending_remove(NCP_MLME_ASSOCIATE_CONFIRM, 0),
+                  NCP_MLME_ASSOCIATE_CONFIRM, ptr);
+}
+#endif  /* (MAC_ASSOCIATION_REQUEST_CONFIRM == 1) */
+
+
+
+#if (MAC_ASSOCIATION_INDICATION_RESPONSE == 1)
+void usr_mlme_associate_ind(uint64_t DeviceAddress,
+                            uint8_t CapabilityInformation)
+{
+    uint8_t *frame = ncp_tx_reserve(9);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    ptr = ncp_put_64(ptr, DeviceAddress);
+    *ptr++ = CapabilityInformation;
+    ncp_tx_commit(frame, NCP_SEQ_INDICATION, NCP_MLME_ASSOCIATE_INDICATION, ptr);
+}
+#endif  /* (MAC_ASSOCIATION_INDICATION_RESPONSE == 1) */
+
+
+
+/**
+ * @brief Writes a PAN descriptor
+ *
+ * @param ptr Position of the PAN descriptor
+ * @param desc PAN descriptor to be written
+ *
+ * @return Position following the PAN descriptor
+ */
+#if ((MAC_BEACON_NOTIFY_INDICATION == 1) || \
+     (MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1) || \
+     (MAC_SCAN_PASSIVE_REQUEST_CONFIRM == 1))
+static uint8_t *ncp_put_pan_desc(uint8_t *ptr, wpan_pandescriptor_t *desc)
+{
+    ptr = ncp_put_addr_spec(ptr, &desc->CoordAddrSpec);
+    *ptr++ = desc->LogicalChannel;
+    *ptr++ = desc->ChannelPage;
+    ptr = ncp_put_16(ptr, desc->SuperframeSpec);
+    *ptr++ = desc->GTSPermit;
+    *ptr++ = desc->LinkQuality;
+#ifdef ENABLE_TSTAMP
+    return ncp_put_32(ptr, desc->TimeStamp);
+#else
+    return ncp_put_32(ptr, 0);
+#endif  /* ENABLE_TSTAMP */
+}
+#endif
+
+
+
+#if (MAC_BEACON_NOTIFY_INDICATION == 1)
+void usr_mlme_beacon_notify_ind(uint8_t BSN,
+                                wpan_pandescriptor_t *PANDescriptor,
+                                uint8_t PendAddrSpec,
+                                uint8_t *AddrList,
+                                uint8_t sduLength,
+                                uint8_t *sdu)
+{
+    uint8_t addr_list_length = WPAN_NUM_SHORT_ADDR_PENDING(PendAddrSpec) * sizeof(uint16_t) +
+                               WPAN_NUM_EXTENDED_ADDR_PENDING(PendAddrSpec) * sizeof(uint64_t);
+    uint8_t *frame = ncp_tx_reserve(3 + NCP_PAN_DESC_LEN + addr_list_length + sduLength);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    *ptr++ = BSN;
+    ptr = ncp_put_pan_desc(ptr, PANDescriptor);
+    *ptr++ = PendAddrSpec;
+    /* The address list is taken from the beacon frame as is. */
+    memcpy(ptr, AddrList, addr_list_length);
+    ptr += addr_list_length;
+    *ptr++ = sduLength;
+    memcpy(ptr, sdu, sduLength);
+    ptr += sduLength;
+    ncp_tx_commit(frame, NCP_SEQ_INDICATION, NCP_MLME_BEACON_NOTIFY_INDICATION, ptr);
+}
+#endif  /* (MAC_BEACON_NOTIFY_INDICATION == 1) */
+
+
+
+#if ((MAC_ORPHAN_INDICATION_RESPONSE == 1) || (MAC_ASSOCIATION_INDICATION_RESPONSE == 1))
+void usr_mlme_comm_status_ind(wpan_addr_spec_t *SrcAddrSpec,
+                              wpan_addr_spec_t *DstAddrSpec,
+                              uint8_t status)
+{
+    uint8_t *frame = ncp_tx_reserve(2 * NCP_ADDR_SPEC_LEN + 1);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    ptr = ncp_put_addr_spec(ptr, SrcAddrSpec);
+    ptr = ncp_put_addr_spec(ptr, DstAddrSpec);
+    *ptr++ = status;
+    ncp_tx_commit(frame,
+                  ncp_pending_remove(NCP_MLME_COMM_STATUS_INDICATION, 0),
+                  NCP_MLME_COMM_STATUS_INDICATION, ptr);
+}
+#endif  /* ((MAC_ORPHAN_INDICATION_RESPONSE == 1) || (MAC_ASSOCIATION_INDICATION_RESPONSE == 1)) */
+
+
+
+#if (MAC_DISASSOCIATION_BASIC_SUPPORT == 1)
+void usr_mlme_disassociate_conf(uint8_t status,
+                                wpan_addr_spec_t *DeviceAddrSpec)
+{
+    uint8_t *frame = ncp_tx_reserve(1 + NCP_ADDR_SPEC_LEN);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    *ptr++ = status;
+    ptr = ncp_put_addr_spec(ptr, DeviceAddrSpec);
+    ncp_tx_commit(frame,
+                  ncp_pending_remove(NCP_MLME_DISASSOCIATE_CONFIRM, 0),
+                  NCP_MLME_DISASSOCIATE_CONFIRM, ptr);
+}
+
+
+
+void usr_mlme_disassociate_ind(uint64_t DeviceAddress,
+                               uint8_t DisassociateReason)
+{
+    uint8_t *frame = ncp_tx_reserve(9);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    ptr = ncp_put_64(ptr, DeviceAddress);
+    *ptr++ = DisassociateReason;
+    ncp_tx_commit(frame, NCP_SEQ_INDICATION, NCP_MLME_DISASSOCIATE_INDICATION, ptr);
+}
+#endif  /* (MAC_DISASSOCIATION_BASIC_SUPPORT == 1) */
+
+
+
+#if (MAC_GET_SUPPORT == 1)
+void usr_mlme_get_conf(uint8_t status,
+                       uint8_t PIBAttribute,
+                       void *PIBAttributeValue)
+{
+    uint8_t size = 0;
+    uint8_t *frame;
+    uint8_t *ptr;
+
+    if (MAC_SUCCESS == status)
+    {
+        size = mac_get_pib_attribute_size(PIBAttribute);
+    }
+
+    frame = ncp_tx_reserve(2 + size);
+    ptr = frame + NCP_FRAME_PARAM_OFFSET;
+    *ptr++ = status;
+    *ptr++ = PIBAttribute;
+    memcpy(ptr, PIBAttributeValue, size);
+    ptr += size;
+    ncp_tx_commit(frame,
+                  ncp_pending_remove(NCP_MLME_GET_CONFIRM, 0),
+                  NCP_MLME_GET_CONFIRM, ptr);
+}
+#endif  /* (MAC_GET_SUPPORT == 1) */
+
+
+
+#if (MAC_ORPHAN_INDICATION_RESPONSE == 1)
+void usr_mlme_orphan_ind(uint64_t OrphanAddress)
+{
+    uint8_t *frame = ncp_tx_reserve(8);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    ptr = ncp_put_64(ptr, OrphanAddress);
+    ncp_tx_commit(frame, NCP_SEQ_INDICATION, NCP_MLME_ORPHAN_INDICATION, ptr);
+}
+#endif  /* (MAC_ORPHAN_INDICATION_RESPONSE == 1) */
+
+
+
+/**
+ * @brief Sends a confirm with the status as only parameter
+ *
+ * @param confirm Message code of the confirm
+ * @param status Status of the confirm
+ */
+static void ncp_send_conf(uint8_t confirm, uint8_t status)
+{
+    uint8_t *frame = ncp_tx_reserve(1);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    *ptr++ = status;
+    ncp_tx_commit(frame, ncp_pending_remove(confirm, 0), confirm, ptr);
+}
+
+
+
+#if (MAC_INDIRECT_DATA_BASIC == 1)
+void usr_mlme_poll_conf(uint8_t status)
+{
+    ncp_send_conf(NCP_MLME_POLL_CONFIRM, status);
+}
+#endif  /* (MAC_INDIRECT_DATA_BASIC == 1) */
+
+
+
+void usr_mlme_reset_conf(uint8_t status)
+{
+    ncp_send_conf(NCP_MLME_RESET_CONFIRM, status);
+}
+
+
+
+#if (MAC_RX_ENABLE_SUPPORT == 1)
+void usr_mlme_rx_enable_conf(uint8_t status)
+{
+    ncp_send_conf(NCP_MLME_RX_ENABLE_CONFIRM, status);
+}
+#endif  /* (MAC_RX_ENABLE_SUPPORT == 1) */
+
+
+
+#if ((MAC_SCAN_ED_REQUEST_CONFIRM == 1)      || \
+     (MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1)  || \
+     (MAC_SCAN_PASSIVE_REQUEST_CONFIRM == 1) || \
+     (MAC_SCAN_ORPHAN_REQUEST_CONFIRM == 1))
+void usr_mlme_scan_conf(uint8_t status,
+                        uint8_t ScanType,
+                        uint8_t ChannelPage,
+                        uint32_t UnscannedChannels,
+                        uint8_t ResultListSize,
+                        void *ResultList)
+{
+    uint8_t entry_length = 0;
+    uint8_t *frame;
+    uint8_t *ptr;
+    uint8_t i;
+
+    if (MLME_SCAN_TYPE_ED == ScanType)
+    {
+        entry_length = 1;
+    }
+#if ((MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1) || (MAC_SCAN_PASSIVE_REQUEST_CONFIRM == 1))
+    else if ((MLME_SCAN_TYPE_ACTIVE == ScanType) || (MLME_SCAN_TYPE_PASSIVE == ScanType))
+    {
+        entry_length = NCP_PAN_DESC_LEN;
+    }
+#endif
+    else
+    {
+        /* An orphan scan has no result list. */
+        ResultListSize = 0;
+    }
+
+    if ((entry_length > 0) &&
+        (ResultListSize > ((NCP_MSG_MAX_LEN - 10) / entry_length)))
+    {
+        /* Only the results fitting into one message are sent. */
+        ResultListSize = (NCP_MSG_MAX_LEN - 10) / entry_length;
+    }
+
+    frame = ncp_tx_reserve(8 + ResultListSize * entry_length);
+    ptr = frame + NCP_FRAME_PARAM_OFFSET;
+    *ptr++ = status;
+    *ptr++ = ScanType;
+    *ptr++ = ChannelPage;
+    ptr = ncp_put_32(ptr, UnscannedChannels);
+    *ptr++ = ResultListSize;
+
+    for (i = 0; i < ResultListSize; i++)
+    {
+#if ((MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1) || (MAC_SCAN_PASSIVE_REQUEST_CONFIRM == 1))
+        if (NCP_PAN_DESC_LEN == entry_length)
+        {
+            ptr = ncp_put_pan_desc(ptr, (wpan_pandescriptor_t *)ResultList + i);
+            continue;
+        }
+#endif
+        *ptr++ = ((uint8_t *)ResultList)[i];
+    }
+
+    ncp_tx_commit(frame,
+                  ncp_pending_remove(NCP_MLME_SCAN_CONFIRM, 0),
+                  NCP_MLME_SCAN_CONFIRM, ptr);
+}
+#endif
+
+
+
+void usr_mlme_set_conf(uint8_t status,
+                       uint8_t PIBAttribute)
+{
+    uint8_t *frame = ncp_tx_reserve(2);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    *ptr++ = status;
+    *ptr++ = PIBAttribute;
+    ncp_tx_commit(frame,
+                  ncp_pending_remove(NCP_MLME_SET_CONFIRM, 0),
+                  NCP_MLME_SET_CONFIRM, ptr);
+}
+
+
+
+#if (MAC_START_REQUEST_CONFIRM == 1)
+void usr_mlme_start_conf(uint8_t status)
+{
+    ncp_send_conf(NCP_MLME_START_CONFIRM, status);
+}
+#endif  /* (MAC_START_REQUEST_CONFIRM == 1) */
+
+
+
+void usr_mlme_sync_loss_ind(uint8_t LossReason,
+                            uint16_t PANId,
+                            uint8_t LogicalChannel,
+                            uint8_t ChannelPage)
+{
+    uint8_t *frame = ncp_tx_reserve(5);
+    uint8_t *ptr = frame + NCP_FRAME_PARAM_OFFSET;
+
+    *ptr++ = LossReason;
+    ptr = ncp_put_16(ptr, PANId);
+    *ptr++ = LogicalChannel;
+    *ptr++ = ChannelPage;
+    ncp_tx_commit(frame, NCP_SEQ_INDICATION, NCP_MLME_SYNC_LOSS_INDICATION, ptr);
+}
+
+/* EOF */
@@ -0,0 +1,201 @@
+/**
+ * @file ncp_frame.c
+ *
+ * @brief Framing of the serial messages of the MAC network co-processor
+ *
+ * This file is shared by the NCP firmware and the host library.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ncp_protocol.h"
+
+/* === Macros ============================================================== */
+
+/** Initial value of the CRC */
+#define NCP_CRC_INIT                    (0xFFFF)
+
+/* === Types =============================================================== */
+
+
+/* === Globals ============================================================= */
+
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+uint16_t ncp_crc_update(uint16_t crc, uint8_t data)
+{
+    uint8_t i;
+
+    crc ^= (uint16_t)data << 8;
+    for (i = 0; i < 8; i++)
+    {
+        if (crc & 0x8000)
+        {
+            crc = (crc << 1) ^ 0x1021;
+        }
+        else
+        {
+            crc <<= 1;
+        }
+    }
+
+    return crc;
+}
+
+
+
+uint16_t ncp_frame_complete(uint8_t *frame, uint8_t seq, uint8_t code,
+                            uint8_t param_length)
+{
+    uint8_t length = param_length + 2;
+    uint16_t crc = NCP_CRC_INIT;
+    uint8_t i;
+
+    frame[0] = NCP_SOF;
+    frame[1] = length;
+    frame[2] = seq;
+    frame[3] = code;
+
+    for (i = 0; i <= length; i++)
+    {
+        crc = ncp_crc_update(crc, frame[1 + i]);
+    }
+    frame[2 + length] = (uint8_t)crc;
+    frame[3 + length] = (uint8_t)(crc >> 8);
+
+    return (length + NCP_FRAME_OVERHEAD);
+}
+
+
+
+void ncp_rx_init(ncp_rx_t *rx)
+{
+    rx->index = 0;
+    rx->length = 0;
+    rx->crc = NCP_CRC_INIT;
+    rx->errors = 0;
+}
+
+
+
+bool ncp_rx_octet(ncp_rx_t *rx, uint8_t data)
+{
+    if (0 == rx->index)
+    {
+        /* Search for the start of a frame. */
+        if (NCP_SOF == data)
+        {
+            rx->index = 1;
+            rx->crc = NCP_CRC_INIT;
+        }
+        return false;
+    }
+
+    if (1 == rx->index)
+    {
+        if ((data < 2) || (data > NCP_MSG_MAX_LEN))
+        {
+            /*
+             * Invalid length; this may have been a SOF within the data of
+             * a corrupted frame. An SOF may follow immediately.
+             */
+            rx->errors++;
+            rx->index = (NCP_SOF == data) ? 1 : 0;
+            return false;
+        }
+        rx->length = data;
+        rx->crc = ncp_crc_update(rx->crc, data);
+        rx->index = 2;
+        return false;
+    }
+
+    /* Message and CRC, the CRC is stored behind the message. */
+    rx->msg[rx->index - 2] = data;
+    if (rx->index < (rx->length + 2))
+    {
+        rx->crc = ncp_crc_update(rx->crc, data);
+    }
+    rx->index++;
+
+    if (rx->index < (rx->length + NCP_FRAME_OVERHEAD))
+    {
+        return false;
+    }
+
+    /* The frame is complete. */
+    rx->index = 0;
+    if (ncp_get_16(&rx->msg[rx->length]) != rx->crc)
+    {
+        rx->errors++;
+        return false;
+    }
+
+    return true;
+}
+
+
+
+uint8_t *ncp_put_16(uint8_t *ptr, uint16_t value)
+{
+    ptr[0] = (uint8_t)value;
+    ptr[1] = (uint8_t)(value >> 8);
+
+    return (ptr + 2);
+}
+
+
+
+uint8_t *ncp_put_32(uint8_t *ptr, uint32_t value)
+{
+    ptr = ncp_put_16(ptr, (uint16_t)value);
+
+    return ncp_put_16(ptr, (uint16_t)(value >> 16));
+}
+
+
+
+uint8_t *ncp_put_64(uint8_t *ptr, uint64_t value)
+{
+    ptr = ncp_put_32(ptr, (uint32_t)value);
+
+    return ncp_put_32(ptr, (uint32_t)(value >> 32));
+}
+
+
+
+uint16_t ncp_get_16(const uint8_t *ptr)
+{
+    return ((uint16_t)ptr[0] | ((uint16_t)ptr[1] << 8));
+}
+
+
+
+uint32_t ncp_get_32(const uint8_t *ptr)
+{
+    return ((uint32_t)ncp_get_16(ptr) | ((uint32_t)ncp_get_16(ptr + 2) << 16));
+}
+
+
+
+uint64_t ncp_get_64(const uint8_t *ptr)
+{
+    return ((uint64_t)ncp_get_32(ptr) | ((uint64_t)ncp_get_32(ptr + 4) << 32));
+}
+
+/* EOF */
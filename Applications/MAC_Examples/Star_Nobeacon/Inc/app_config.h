@@ -127,10 +127,23 @@ typedef enum
  */
 #define USB_PRODUCT_NAME L"RZUSBSTICK"
 
+#ifdef ENABLE_TELEMETRY
+/**
+ * Defines the UART transmit buffer size; large enough for a complete batch
+ * of telemetry records
+ */
+#define UART_MAX_TX_BUF_LENGTH      (255)
+
+/** Serial interface the telemetry records are sent to */
+#ifndef TLM_SIO_CHANNEL
+#define TLM_SIO_CHANNEL             (SIO_0)
+#endif
+#else
 /**
  * Defines the UART transmit buffer size
  */
 #define UART_MAX_TX_BUF_LENGTH      (10)
+#endif  /* ENABLE_TELEMETRY */
 
 /**
  * Defines the UART receive buffer size
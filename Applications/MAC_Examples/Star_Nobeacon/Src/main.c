@@ -28,6 +28,7 @@
 #include "mac_api.h"
 #include "app_config.h"
 #include "ieee_const.h"
+#include "tlm.h"
 
 /* === TYPES =============================================================== */
 
@@ -141,6 +142,15 @@ int main(void)
         pal_alert();
     }
 
+#ifdef ENABLE_TELEMETRY
+    /* Initialize the serial interface the stack events are sent to. */
+    if (pal_sio_init(TLM_SIO_CHANNEL) != MAC_SUCCESS)
+    {
+        pal_alert();
+    }
+    tlm_init(TLM_SIO_CHANNEL);
+#endif
+
     /* Initialize LEDs. */
     pal_led_init();
     pal_led(LED_START, LED_ON);         // indicating application is started
@@ -164,6 +174,9 @@ int main(void)
     while (1)
     {
         wpan_task();
+#ifdef ENABLE_TELEMETRY
+        tlm_task();
+#endif
     }
 }
 
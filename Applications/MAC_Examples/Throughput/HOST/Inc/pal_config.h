@@ -0,0 +1,145 @@
+/**
+ * @file pal_config.h
+ *
+ * @brief Board configuration of the host PAL
+ *
+ * The host build of the throughput benchmark links the MAC with a PAL and a
+ * TAL emulated on the host computer. This file takes the place of the board
+ * specific pal_config.h, so the generic pal.h of the stack can be used. The
+ * compiler abstraction of the 32 bit MCUs (PAL_GENERIC_TYPE ARM7) is used,
+ * since it only depends on GCC.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_CONFIG_H
+#define PAL_CONFIG_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "return_val.h"
+
+#if (PAL_GENERIC_TYPE != ARM7)
+#error "The host PAL requires PAL_GENERIC_TYPE ARM7"
+#endif
+
+/* === Types ================================================================ */
+
+/**
+ * Identifiers of the LEDs; LED requests are ignored by the host PAL.
+ */
+typedef enum led_id_tag
+{
+    LED_0,
+    LED_1,
+    LED_2
+} led_id_t;
+
+#define NO_OF_LEDS                      (3)
+
+/**
+ * Identifiers of the buttons; no button is ever pressed on the host.
+ */
+typedef enum button_id_tag
+{
+    BUTTON_0
+} button_id_t;
+
+#define NO_OF_BUTTONS                   (1)
+
+/* === Macros =============================================================== */
+
+/**
+ * The host build runs single threaded; timers expire within pal_task() and
+ * the emulated transceiver has no interrupts, so no critical regions are
+ * required.
+ */
+#define ENABLE_GLOBAL_IRQ()
+#define DISABLE_GLOBAL_IRQ()
+#define ENTER_CRITICAL_REGION()         {
+#define LEAVE_CRITICAL_REGION()         }
+#define ENTER_TRX_REGION()              {
+#define LEAVE_TRX_REGION()              }
+
+#define ENABLE_TRX_IRQ()
+#define DISABLE_TRX_IRQ()
+#define CLEAR_TRX_IRQ()
+#define ENABLE_TRX_IRQ_TSTAMP()
+#define DISABLE_TRX_IRQ_TSTAMP()
+#define CLEAR_TRX_IRQ_TSTAMP()
+
+#define RST_HIGH()
+#define RST_LOW()
+#define SLP_TR_HIGH()
+#define SLP_TR_LOW()
+
+/**
+ * Minimum timeout in us accepted by pal_timer_start()
+ */
+#define MIN_TIMEOUT                     (0x80)
+
+/**
+ * Maximum timeout in us accepted by pal_timer_start()
+ */
+#define MAX_TIMEOUT                     (0x7FFFFFFF)
+
+/**
+ * Maximum number of timers the host PAL can run at a time
+ */
+#define MAX_NO_OF_TIMERS                (25)
+
+#define TIMER_SRC_DURING_TRX_AWAKE()
+#define TIMER_SRC_DURING_TRX_SLEEP()
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Gets the CPU time of the host process in us
+ *
+ * Used by the benchmark instead of the emulated clock, see BENCH_CPU_CLOCK.
+ *
+ * @param cpu_time Returns the CPU time
+ */
+void pal_host_cpu_time(uint32_t *cpu_time);
+
+/**
+ * @brief Gets the expiry time of the next running timer
+ *
+ * @param expiry Returns the absolute expiry time in us
+ *
+ * @return true if a timer is running
+ */
+bool pal_host_next_timer(uint32_t *expiry);
+
+/**
+ * @brief Advances the emulated clock
+ *
+ * The clock of the host PAL only advances when requested, i.e. the stack
+ * runs in zero time and the main loop jumps to the next event once there
+ * is nothing left to do.
+ *
+ * @param time New absolute time in us; ignored if it is not in the future
+ */
+void pal_host_advance_time(uint32_t time);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* PAL_CONFIG_H */
+/* EOF */
@@ -0,0 +1,88 @@
+/**
+ * @file tal_sim.h
+ *
+ * @brief TAL emulation of the host build of the throughput benchmark
+ *
+ * The emulation implements the TAL API on the host computer and models the
+ * air interface of the 2.4 GHz O-QPSK PHY: airtime, CCA, CSMA-CA (unslotted
+ * and slotted), acknowledgments, retries and collisions. The peers of the
+ * node under test are emulated remote nodes, whose behaviour follows from
+ * the benchmark configuration of the node under test:
+ *
+ *  - coordinator under test: devices sending data frames to it, or, with
+ *    indirect traffic, devices polling it for their data,
+ *  - device under test: a coordinator acknowledging its frames, answering
+ *    its polls with data and, with beacon traffic, sending beacons.
+ *
+ * All timing is based on the emulated clock of the host PAL, so the results
+ * are deterministic.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef TAL_SIM_H
+#define TAL_SIM_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mac_bench.h"
+
+/* === Macros =============================================================== */
+
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sets up the emulated remote nodes for a run
+ *
+ * Called before bench_start(); frames of the previous run still on the air
+ * are dropped.
+ *
+ * @param config Benchmark configuration of the node under test
+ */
+void tal_sim_configure(const bench_config_t *config);
+
+/**
+ * @brief Gets the time of the next event of the emulated air interface
+ *
+ * @param time Returns the absolute time in us
+ *
+ * @return true if an event is pending
+ */
+bool tal_sim_next_event(uint32_t *time);
+
+/**
+ * @brief Gets the number of collisions on the air since the last
+ *        configuration
+ *
+ * @return Number of frames corrupted by overlapping transmissions
+ */
+uint32_t tal_sim_collisions(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TAL_SIM_H */
+/* EOF */
@@ -0,0 +1,222 @@
+/**
+ * @file bench_host.c
+ *
+ * @brief Host build of the MAC example Throughput
+ *
+ * Runs the benchmark for all traffic mixes, with the node under test as
+ * coordinator and as device, against the TAL emulation of tal_sim.c and
+ * prints one line of comma separated values per run. Whenever the stack is
+ * idle, the emulated clock jumps to the next timer or air event, so a run
+ * takes far less time than on the node; the CPU time of the MAC is the CPU
+ * time of the host process.
+ *
+ * Usage: Throughput_Host [duration in ms] [MSDU length] [number of devices]
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "pal.h"
+#include "tal.h"
+#include "mac_api.h"
+#include "app_config.h"
+#include "ieee_const.h"
+#include "mac_bench.h"
+#include "tal_sim.h"
+
+/* === TYPES =============================================================== */
+
+
+/* === MACROS ============================================================== */
+
+/** Default duration of a run in ms */
+#define DEFAULT_DURATION_MS             (10000)
+
+/** Default MSDU length */
+#define DEFAULT_MSDU_LENGTH             (100)
+
+/** Default number of devices */
+#define DEFAULT_NUM_DEVICES             (1)
+
+/** Number of data requests outstanding per destination */
+#define HOST_WINDOW                     (2)
+
+/** Beacon order and superframe order of the beacon-enabled PAN */
+#define HOST_BEACON_ORDER               (6)
+#define HOST_SUPERFRAME_ORDER           (6)
+
+/** Emulated time allowed for the setup and the end of a run in ms */
+#define RUN_MARGIN_MS                   (60000)
+
+/** Calls of bench_task() without event before the clock jumps */
+#define IDLE_ROUNDS                     (2)
+
+/* === GLOBALS ============================================================= */
+
+
+/* === PROTOTYPES ========================================================== */
+
+static bool run(const bench_config_t *config);
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Main function of the host build of the Throughput application
+ */
+int main(int argc, char *argv[])
+{
+    bench_config_t config;
+    uint8_t traffic;
+    bool ok = true;
+
+    config.duration_ms = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_DURATION_MS;
+    config.msdu_length = (argc > 2) ? (uint8_t)strtoul(argv[2], NULL, 0) : DEFAULT_MSDU_LENGTH;
+    config.num_devices = (argc > 3) ? (uint8_t)strtoul(argv[3], NULL, 0) : DEFAULT_NUM_DEVICES;
+    config.device_index = 1;
+    config.window = HOST_WINDOW;
+    config.beacon_order = HOST_BEACON_ORDER;
+    config.superframe_order = HOST_SUPERFRAME_ORDER;
+
+    if ((config.num_devices < 1) || (config.num_devices > BENCH_MAX_DEVICES))
+    {
+        fprintf(stderr, "Number of devices out of range 1 .. %u\n", BENCH_MAX_DEVICES);
+        return EXIT_FAILURE;
+    }
+
+    if ((config.msdu_length < BENCH_MSDU_MIN_LEN) || (config.msdu_length > BENCH_MSDU_MAX_LEN))
+    {
+        fprintf(stderr, "MSDU length out of range %u .. %u\n", BENCH_MSDU_MIN_LEN, BENCH_MSDU_MAX_LEN);
+        return EXIT_FAILURE;
+    }
+
+    if (wpan_init() != MAC_SUCCESS)
+    {
+        fprintf(stderr, "wpan_init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("traffic,role,devices,msdu_length,msdus,msdu_per_s,goodput_bps,"
+           "latency_min_us,latency_mean_us,latency_p50_us,latency_p99_us,latency_max_us,"
+           "failures,lost,duplicates,collisions,mac_cpu_ns_per_msdu\n");
+
+    for (traffic = 0; traffic < BENCH_NUM_TRAFFIC; traffic++)
+    {
+        config.traffic = (bench_traffic_t)traffic;
+
+        config.role = BENCH_COORDINATOR;
+        ok &= run(&config);
+        config.role = BENCH_DEVICE;
+        ok &= run(&config);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/**
+ * @brief Performs a run and prints its result
+ *
+ * @param config Configuration of the run
+ *
+ * @return true if MSDUs were delivered in the run
+ */
+static bool run(const bench_config_t *config)
+{
+    bench_result_t result;
+    uint32_t start;
+    uint32_t now;
+    uint32_t next;
+    uint32_t timer;
+    uint32_t msdus;
+    uint8_t idle = 0;
+    bool sender;
+
+    tal_sim_configure(config);
+    if (!bench_start(config))
+    {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    pal_get_current_time(&start);
+
+    while (!bench_done())
+    {
+        if (bench_task())
+        {
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_ROUNDS)
+        {
+            continue;
+        }
+        idle = 0;
+
+        /* The stack is idle; the clock jumps to the next event. */
+        pal_get_current_time(&now);
+        if (!tal_sim_next_event(&next))
+        {
+            if (!pal_host_next_timer(&next))
+            {
+                fprintf(stderr, "%s %s: no pending event\n", bench_traffic_name(config->traffic),
+                        (config->role == BENCH_COORDINATOR) ? "coordinator" : "device");
+                return false;
+            }
+        }
+        else if (pal_host_next_timer(&timer) && (pal_sub_time_us(next, timer) < 0x80000000UL))
+        {
+            next = timer;
+        }
+        pal_host_advance_time(next);
+
+        if (pal_sub_time_us(next, start) / 1000 > config->duration_ms + RUN_MARGIN_MS)
+        {
+            fprintf(stderr, "%s %s: run does not end\n", bench_traffic_name(config->traffic),
+                    (config->role == BENCH_COORDINATOR) ? "coordinator" : "device");
+            bench_stop();
+            return false;
+        }
+    }
+
+    bench_get_result(&result);
+    sender = bench_is_sender();
+    msdus = sender ? result.confirmed : result.indications;
+
+    printf("%s,%s,%u,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+           bench_traffic_name(config->traffic),
+           (config->role == BENCH_COORDINATOR) ? "coordinator" : "device",
+           config->num_devices,
+           config->msdu_length,
+           (unsigned long)msdus,
+           (unsigned long)((result.elapsed_us == 0) ? 0 :
+                           (uint64_t)msdus * 1000000 / result.elapsed_us),
+           (unsigned long)((result.elapsed_us == 0) ? 0 :
+                           (uint64_t)msdus * config->msdu_length * 8 * 1000000 / result.elapsed_us),
+           (unsigned long)result.latency_min,
+           (unsigned long)result.latency_mean,
+           (unsigned long)result.latency_p50,
+           (unsigned long)result.latency_p99,
+           (unsigned long)result.latency_max,
+           (unsigned long)(result.no_ack + result.channel_access_failures + result.other_failures),
+           (unsigned long)result.lost,
+           (unsigned long)result.duplicates,
+           (unsigned long)tal_sim_collisions(),
+           (unsigned long)((msdus == 0) ? 0 : (uint64_t)result.mac_cpu_us * 1000 / msdus));
+
+    return (msdus > 0);
+}
+
+/* EOF */
@@ -0,0 +1,337 @@
+/**
+ * @file pal_host.c
+ *
+ * @brief PAL of the host build of the throughput benchmark
+ *
+ * The clock is emulated: it only advances via pal_host_advance_time(), so
+ * the timing of a run does not depend on the speed of the host computer.
+ * Timers expire within pal_task() like on the 32 bit MCUs. The persistence
+ * storage is a RAM array holding the IEEE address of the node.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pal.h"
+#include "app_config.h"
+
+/* === Macros ============================================================== */
+
+/** Size of the emulated EEPROM */
+#define EEPROM_SIZE                     (256)
+
+/** IEEE address of the emulated node */
+#define HOST_IEEE_ADDR                  (0x0000000000000001ULL)
+
+/* === Types =============================================================== */
+
+/**
+ * Callback of an expired timer
+ */
+typedef void (*timer_expiry_cb_t)(void *);
+
+/**
+ * Running timer
+ */
+typedef struct timer_info_tag
+{
+    /** Absolute expiry time in us */
+    uint32_t expiry;
+    /** Callback; NULL if the timer is not running */
+    FUNC_PTR timer_cb;
+    /** Parameter of the callback */
+    void *param_cb;
+} timer_info_t;
+
+/* === Globals ============================================================= */
+
+static uint32_t current_time;
+
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+static timer_info_t timer_array[TOTAL_NUMBER_OF_TIMERS];
+#endif
+
+static uint8_t eeprom[EEPROM_SIZE];
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+retval_t pal_init(void)
+{
+    uint64_t ieee_addr = HOST_IEEE_ADDR;
+
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+    memset(timer_array, 0, sizeof(timer_array));
+#endif
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    memcpy(&eeprom[EE_IEEE_ADDR], &ieee_addr, sizeof(ieee_addr));
+
+    return MAC_SUCCESS;
+}
+
+
+void pal_task(void)
+{
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+    while (1)
+    {
+        uint8_t timer_id;
+        uint8_t expired_id = TOTAL_NUMBER_OF_TIMERS;
+        uint32_t overdue = 0;
+        timer_expiry_cb_t callback;
+
+        /* The timer that expired first is served first. */
+        for (timer_id = 0; timer_id < TOTAL_NUMBER_OF_TIMERS; timer_id++)
+        {
+            if ((NULL != timer_array[timer_id].timer_cb) &&
+                (pal_sub_time_us(current_time, timer_array[timer_id].expiry) < 0x80000000UL) &&
+                ((expired_id == TOTAL_NUMBER_OF_TIMERS) ||
+                 (pal_sub_time_us(current_time, timer_array[timer_id].expiry) > overdue)))
+            {
+                expired_id = timer_id;
+                overdue = pal_sub_time_us(current_time, timer_array[timer_id].expiry);
+            }
+        }
+
+        if (expired_id == TOTAL_NUMBER_OF_TIMERS)
+        {
+            break;
+        }
+
+        callback = (timer_expiry_cb_t)timer_array[expired_id].timer_cb;
+        timer_array[expired_id].timer_cb = NULL;
+        callback(timer_array[expired_id].param_cb);
+    }
+#endif
+}
+
+
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+retval_t pal_timer_start(uint8_t timer_id,
+                         uint32_t timer_count,
+                         timeout_type_t timeout_type,
+                         FUNC_PTR timer_cb,
+                         void *param_cb)
+{
+    uint32_t point_in_time;
+
+    if (timer_id >= TOTAL_NUMBER_OF_TIMERS)
+    {
+        return PAL_TMR_INVALID_ID;
+    }
+
+    if (NULL == timer_cb)
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    if (NULL != timer_array[timer_id].timer_cb)
+    {
+        return PAL_TMR_ALREADY_RUNNING;
+    }
+
+    switch (timeout_type)
+    {
+        case TIMEOUT_RELATIVE:
+            /* Limited like by the PAL of the 32 bit MCUs */
+            if (timer_count > MAX_TIMEOUT)
+            {
+                timer_count = MAX_TIMEOUT;
+            }
+            if (timer_count < MIN_TIMEOUT)
+            {
+                return PAL_TMR_INVALID_TIMEOUT;
+            }
+            point_in_time = pal_add_time_us(current_time, timer_count);
+            break;
+
+        case TIMEOUT_ABSOLUTE:
+            {
+                uint32_t timeout = pal_sub_time_us(timer_count, current_time);
+
+                if ((timeout > MAX_TIMEOUT) || (timeout < MIN_TIMEOUT))
+                {
+                    return PAL_TMR_INVALID_TIMEOUT;
+                }
+                point_in_time = timer_count;
+            }
+            break;
+
+        default:
+            return MAC_INVALID_PARAMETER;
+    }
+
+    timer_array[timer_id].expiry = point_in_time;
+    timer_array[timer_id].timer_cb = timer_cb;
+    timer_array[timer_id].param_cb = param_cb;
+
+    return MAC_SUCCESS;
+}
+
+
+retval_t pal_timer_stop(uint8_t timer_id)
+{
+    if (timer_id >= TOTAL_NUMBER_OF_TIMERS)
+    {
+        return PAL_TMR_INVALID_ID;
+    }
+
+    if (NULL == timer_array[timer_id].timer_cb)
+    {
+        return PAL_TMR_NOT_RUNNING;
+    }
+
+    timer_array[timer_id].timer_cb = NULL;
+
+    return MAC_SUCCESS;
+}
+
+
+bool pal_is_timer_running(uint8_t timer_id)
+{
+    return ((timer_id < TOTAL_NUMBER_OF_TIMERS) &&
+            (NULL != timer_array[timer_id].timer_cb));
+}
+#endif  /* (TOTAL_NUMBER_OF_TIMERS > 0) */
+
+
+void pal_get_current_time(uint32_t *timer_count)
+{
+    *timer_count = current_time;
+}
+
+
+void pal_timer_source_select(source_type_t source)
+{
+    source = source;    /* Keep compiler happy. */
+}
+
+
+bool pal_calibrate_rc_osc(void)
+{
+    return true;
+}
+
+
+uint16_t pal_generate_rand_seed(void)
+{
+    return 0x4D21;
+}
+
+
+retval_t pal_ps_get(ps_type_t ps_type, uint16_t start_addr, uint16_t length, void *value)
+{
+    if ((ps_type != INTERN_EEPROM) || ((uint32_t)start_addr + length > EEPROM_SIZE))
+    {
+        return FAILURE;
+    }
+
+    memcpy(value, &eeprom[start_addr], length);
+
+    return MAC_SUCCESS;
+}
+
+
+retval_t pal_ps_set(uint16_t start_addr, uint16_t length, void *value)
+{
+    if ((uint32_t)start_addr + length > EEPROM_SIZE)
+    {
+        return FAILURE;
+    }
+
+    memcpy(&eeprom[start_addr], value, length);
+
+    return MAC_SUCCESS;
+}
+
+
+void pal_led_init(void)
+{
+}
+
+
+void pal_led(led_id_t led_no, led_action_t led_setting)
+{
+    /* Keep compiler happy. */
+    led_no = led_no;
+    led_setting = led_setting;
+}
+
+
+void pal_alert(void)
+{
+    fprintf(stderr, "pal_alert\n");
+    exit(EXIT_FAILURE);
+}
+
+
+void pal_host_cpu_time(uint32_t *cpu_time)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    *cpu_time = (uint32_t)((uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+
+bool pal_host_next_timer(uint32_t *expiry)
+{
+    bool running = false;
+#if (TOTAL_NUMBER_OF_TIMERS > 0)
+    uint8_t timer_id;
+    uint32_t min_timeout = 0;
+
+    for (timer_id = 0; timer_id < TOTAL_NUMBER_OF_TIMERS; timer_id++)
+    {
+        if (NULL != timer_array[timer_id].timer_cb)
+        {
+            uint32_t timeout = pal_sub_time_us(timer_array[timer_id].expiry, current_time);
+
+            /* An expired timer is due right away. */
+            if (timeout >= 0x80000000UL)
+            {
+                timeout = 0;
+            }
+            if (!running || (timeout < min_timeout))
+            {
+                min_timeout = timeout;
+                running = true;
+            }
+        }
+    }
+
+    *expiry = pal_add_time_us(current_time, min_timeout);
+#endif
+
+    return running;
+}
+
+
+void pal_host_advance_time(uint32_t time)
+{
+    uint32_t step = pal_sub_time_us(time, current_time);
+
+    if ((step > 0) && (step < 0x80000000UL))
+    {
+        current_time = time;
+    }
+}
+
+/* EOF */
@@ -0,0 +1,1627 @@
+/**
+ * @file tal_sim.c
+ *
+ * @brief TAL emulation of the host build of the throughput benchmark
+ *
+ * The node under test is station 0, the emulated remote nodes are the
+ * stations 1 .. n; all of them share the transmission engine of this file.
+ * A frame occupies the air from its start until its end; frames overlapping
+ * on the air are corrupted, a CCA reports a busy channel if any frame is on
+ * the air during the CCA. Events are processed in the order of their time,
+ * and in the order of the stations for the same time, so a run always gives
+ * the same result.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "return_val.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "tal_constants.h"
+#include "at86rf231.h"
+#include "bmm.h"
+#include "mac_msg_types.h"
+#include "app_config.h"
+#include "mac_bench.h"
+#include "tal_sim.h"
+
+/* === Macros ============================================================== */
+
+/** Node under test */
+#define DUT                             (0)
+
+/** Number of stations: node under test and remote nodes */
+#define NUM_STATIONS                    (BENCH_MAX_DEVICES + 1)
+
+/** Number of frames kept in the history of the air */
+#define AIR_HISTORY                     (64)
+
+/** Short address of the coordinator */
+#define COORD_ADDR                      (0x0000)
+
+/** Airtime of a PSDU in us, including SHR and PHR */
+#define AIRTIME_US(psdu_len)            \
+    TAL_CONVERT_SYMBOLS_TO_US((PHY_OVERHEAD + LENGTH_FIELD_LEN + (psdu_len)) * SYMBOLS_PER_OCTET)
+
+/** Airtime of an ACK frame in us */
+#define ACK_US                          AIRTIME_US(ACK_PAYLOAD_LEN + FCS_LEN)
+
+/** RX-to-TX turnaround time in us, also the delay of an ACK */
+#define TURNAROUND_US                   TAL_CONVERT_SYMBOLS_TO_US(aTurnaroundTime)
+
+/** Duration of a CCA in us */
+#define CCA_US                          TAL_CONVERT_SYMBOLS_TO_US(8)
+
+/** Backoff period in us */
+#define BACKOFF_US                      TAL_CONVERT_SYMBOLS_TO_US(aUnitBackoffPeriod)
+
+/** Time waited for an ACK after the end of a frame in us */
+#define ACK_WAIT_US                     TAL_CONVERT_SYMBOLS_TO_US(macAckWaitDuration_def)
+
+/** Short and long interframe spacing in us */
+#define SIFS_US                         TAL_CONVERT_SYMBOLS_TO_US(macMinSIFSPeriod_def)
+#define LIFS_US                         TAL_CONVERT_SYMBOLS_TO_US(macMinLIFSPeriod_def)
+
+/** Time a polling device waits for its data in us */
+#define DATA_WAIT_US                    TAL_CONVERT_SYMBOLS_TO_US(macMaxFrameTotalWaitTime_def)
+
+/**
+ * Start of the CAP after the beacon in us; the beacons of a run are
+ * shorter than these 4 backoff periods.
+ */
+#define CAP_OFFSET_US                   (4 * BACKOFF_US)
+
+/** Delay of the first beacon of the emulated coordinator in us */
+#define FIRST_BEACON_US                 (1000)
+
+/** Stagger of the first frames of the remote nodes in us */
+#define STAGGER_US                      (100)
+
+/** Length of the MAC header of the data frames and data requests */
+#define HDR_LEN                         (9)
+
+/** Length of a beacon without FCS */
+#define BEACON_LEN                      (11)
+
+/** CSMA-CA parameters of the remote nodes */
+#define REMOTE_MIN_BE                   (3)
+#define REMOTE_MAX_BE                   (5)
+#define REMOTE_MAX_CSMA_BACKOFFS        (4)
+#define REMOTE_MAX_FRAME_RETRIES        (3)
+
+/** Superframe specification of a beacon: final CAP slot, PAN coordinator */
+#define SUPERFRAME_SPEC_HIGH            (0x0F | 0x40)
+
+/* === Types =============================================================== */
+
+/**
+ * The received frames are stored behind the data indication built by the
+ * MAC in the same buffer; MCPS_DATA_IND_SIZE has to cover it.
+ */
+typedef char mcps_data_ind_size_check_t[(sizeof(mcps_data_ind_t) <= MCPS_DATA_IND_SIZE) ? 1 : -1];
+
+/**
+ * Kind of a station
+ */
+typedef enum station_kind_tag
+{
+    /** Node under test */
+    STATION_DUT,
+    /** Device sending data frames to the coordinator under test */
+    STATION_SOURCE,
+    /** Device polling the coordinator under test */
+    STATION_POLLER,
+    /** Coordinator of the device under test */
+    STATION_COORD
+} station_kind_t;
+
+/**
+ * State of the transmission engine of a station
+ */
+typedef enum tx_state_tag
+{
+    /** No transmission ongoing */
+    TX_IDLE,
+    /** Waiting for the end of the CCA at tx_time */
+    TX_CCA,
+    /** Frame on the air until tx_time */
+    TX_ON_AIR,
+    /** Waiting for the ACK until tx_time */
+    TX_WAIT_ACK
+} tx_state_t;
+
+/**
+ * Phase of the behaviour of a remote node
+ */
+typedef enum phase_tag
+{
+    /** Nothing to do */
+    PHASE_IDLE,
+    /** Sending the next data frame or data request at app_time */
+    PHASE_SEND,
+    /** Waiting for data until app_time (polling device) */
+    PHASE_WAIT_DATA,
+    /** Sending the next beacon at app_time (coordinator) */
+    PHASE_BEACON
+} phase_t;
+
+/**
+ * Frame on the air
+ */
+typedef struct air_frame_tag
+{
+    uint32_t start;
+    uint32_t end;
+    bool corrupted;
+} air_frame_t;
+
+/**
+ * Station
+ */
+typedef struct station_tag
+{
+    station_kind_t kind;
+    uint16_t short_addr;
+
+    /* Transmission engine */
+    tx_state_t tx_state;
+    /** Time of the next event of the engine */
+    uint32_t tx_time;
+    /** Frame being transmitted, starting with the PHR */
+    uint8_t *mpdu;
+    csma_mode_t csma_mode;
+    bool ack_requested;
+    bool acked;
+    bool ack_frame_pending;
+    uint8_t max_retries;
+    uint8_t retries;
+    uint8_t nb;
+    uint8_t be;
+    uint8_t cw;
+    /** Start of the current CCA */
+    uint32_t cca_start;
+    /** Start and end of the frame on the air */
+    uint32_t frame_start;
+    uint32_t frame_end;
+    uint8_t air_index;
+    uint8_t ack_index;
+    /** End of the interframe spacing of the last frame */
+    uint32_t ifs_end;
+    /** End of an ACK being sent by this station */
+    uint32_t ack_end;
+    /** Length of the last frame received, for the IFS of a response */
+    uint8_t last_rx_len;
+
+    /* Behaviour of a remote node */
+    phase_t phase;
+    bool app_timer;
+    uint32_t app_time;
+    /** Data frame to the node under test is pending (coordinator) */
+    bool data_pending;
+    uint8_t dsn;
+    uint16_t msdu_seq;
+    uint32_t rand;
+    uint8_t frame[aMaxPHYPacketSize + LENGTH_FIELD_LEN];
+} station_t;
+
+/**
+ * Addressing of a frame
+ */
+typedef struct frame_addr_tag
+{
+    uint8_t type;
+    bool ack_request;
+    uint8_t dst_mode;
+    uint16_t dst_pan;
+    uint16_t dst_addr;
+    uint8_t src_mode;
+    uint16_t src_pan;
+    uint16_t src_addr;
+    const uint8_t *payload;
+    uint8_t payload_len;
+} frame_addr_t;
+
+/* === Globals ============================================================= */
+
+/*
+ * TAL PIB attributes
+ */
+uint8_t tal_pib_CCAMode;
+uint8_t tal_pib_CurrentChannel;
+uint32_t tal_pib_SupportedChannels;
+uint64_t tal_pib_IeeeAddress;
+uint8_t tal_pib_MaxCSMABackoffs;
+uint8_t tal_pib_MinBE;
+uint16_t tal_pib_PANId;
+bool tal_pib_PrivatePanCoordinator;
+uint16_t tal_pib_ShortAddress;
+uint8_t tal_pib_TransmitPower;
+uint8_t tal_pib_CurrentPage;
+uint16_t tal_pib_MaxFrameDuration;
+uint8_t tal_pib_SHRDuration;
+uint8_t tal_pib_SymbolsPerOctet;
+uint8_t tal_pib_MaxBE;
+uint8_t tal_pib_MaxFrameRetries;
+#ifdef PROMISCUOUS_MODE
+bool tal_pib_PromiscuousMode;
+#endif
+#ifdef BEACON_SUPPORT
+bool tal_pib_BattLifeExt;
+uint8_t tal_pib_BeaconOrder;
+uint8_t tal_pib_SuperFrameOrder;
+uint32_t tal_pib_BeaconTxTime;
+#endif
+
+static station_t stations[NUM_STATIONS];
+static uint8_t num_stations;
+
+static air_frame_t air[AIR_HISTORY];
+static uint8_t air_next;
+static uint32_t collisions;
+
+/** Configuration of the run */
+static bench_config_t run_config;
+
+/** The remote devices have started their traffic */
+static bool remotes_active;
+
+/** Start of the last beacon on the air */
+static bool beacon_valid;
+static uint32_t beacon_start;
+
+/** State of the node under test */
+static frame_info_t *dut_frame;
+static bool dut_rx_on;
+static bool dut_asleep;
+static bool dut_ed_running;
+static uint32_t dut_ed_end;
+
+/* === Prototypes ========================================================== */
+
+static void init_tal_pib(void);
+static uint32_t now_us(void);
+static bool time_reached(uint32_t time, uint32_t now);
+static uint32_t later(uint32_t a, uint32_t b);
+static uint32_t earlier(uint32_t a, uint32_t b);
+static uint8_t next_rand(station_t *st, uint8_t be);
+static uint8_t air_commit(uint32_t start, uint32_t end);
+static bool air_busy(uint32_t start, uint32_t end);
+static void parse_frame(const uint8_t *mpdu, frame_addr_t *addr);
+static uint32_t beacon_interval_us(void);
+static uint32_t cap_end_us(uint32_t superframe_start);
+static void tx_begin(station_t *st, uint8_t *mpdu, csma_mode_t csma_mode, uint8_t max_retries);
+static void tx_attempt(station_t *st, uint32_t now);
+static void tx_backoff(station_t *st, uint32_t now);
+static void tx_slotted_backoff(station_t *st, uint32_t now, uint8_t delay);
+static void tx_commit(station_t *st, uint32_t start);
+static void tx_event(station_t *st, uint32_t now);
+static void tx_end(station_t *st);
+static void tx_complete(station_t *st, retval_t status);
+static bool dut_ready(void);
+static bool dut_accepts(const frame_addr_t *addr);
+static bool dut_receive(const uint8_t *mpdu, uint32_t start);
+static bool remote_receive(station_t *dst, const frame_addr_t *addr, uint32_t end, bool *frame_pending);
+static station_t *find_station(uint16_t short_addr);
+static void app_event(station_t *st, uint32_t now);
+static void app_tx_done(station_t *st, retval_t status, uint32_t now);
+static void activate_remotes(uint32_t now);
+static uint8_t build_data(station_t *st, uint16_t dst_addr, bool ack_request);
+static uint8_t build_data_request(station_t *st);
+static uint8_t build_beacon(station_t *st);
+
+/* === Implementation ====================================================== */
+
+/*
+ * TAL API
+ */
+
+retval_t tal_init(void)
+{
+    if (pal_init() != MAC_SUCCESS)
+    {
+        return FAILURE;
+    }
+
+    /* The IEEE address is read from the EEPROM like by the real TAL. */
+    pal_ps_get(INTERN_EEPROM, EE_IEEE_ADDR, 8, &tal_pib_IeeeAddress);
+    if ((tal_pib_IeeeAddress == 0x0000000000000000ULL) ||
+        (tal_pib_IeeeAddress == 0xFFFFFFFFFFFFFFFFULL))
+    {
+        return FAILURE;
+    }
+
+    init_tal_pib();
+    bmm_buffer_init();
+
+    memset(stations, 0, sizeof(stations));
+    stations[DUT].kind = STATION_DUT;
+    num_stations = 1;
+
+    return MAC_SUCCESS;
+}
+
+
+retval_t tal_reset(bool set_default_pib)
+{
+    station_t *st = &stations[DUT];
+
+    /* A transmission is aborted without confirm. */
+    st->tx_state = TX_IDLE;
+    dut_frame = NULL;
+    dut_rx_on = false;
+    dut_asleep = false;
+    dut_ed_running = false;
+
+    if (set_default_pib)
+    {
+        init_tal_pib();
+    }
+
+    return MAC_SUCCESS;
+}
+
+
+void tal_task(void)
+{
+    uint32_t now = now_us();
+
+    while (1)
+    {
+        station_t *next = NULL;
+        uint32_t next_time = 0;
+        bool next_is_tx = false;
+        uint8_t i;
+
+        /* The earliest event is processed first. */
+        for (i = 0; i < num_stations; i++)
+        {
+            station_t *st = &stations[i];
+
+            if ((st->tx_state != TX_IDLE) && time_reached(st->tx_time, now) &&
+                ((next == NULL) || !time_reached(next_time, st->tx_time) ||
+                 ((st->tx_time == next_time) && !next_is_tx)))
+            {
+                next = st;
+                next_time = st->tx_time;
+                next_is_tx = true;
+            }
+            if (st->app_timer && time_reached(st->app_time, now) &&
+                ((next == NULL) || !time_reached(next_time, st->app_time)))
+            {
+                next = st;
+                next_time = st->app_time;
+                next_is_tx = false;
+            }
+        }
+
+        if (dut_ed_running && time_reached(dut_ed_end, now) &&
+            ((next == NULL) || !time_reached(next_time, dut_ed_end)))
+        {
+            dut_ed_running = false;
+            /* The emulated channel carries no energy outside frames. */
+            tal_ed_end_cb(0);
+            continue;
+        }
+
+        if (next == NULL)
+        {
+            break;
+        }
+
+        if (next_is_tx)
+        {
+            tx_event(next, next_time);
+        }
+        else
+        {
+            next->app_timer = false;
+            app_event(next, next_time);
+        }
+    }
+}
+
+
+retval_t tal_ed_start(uint8_t scan_duration)
+{
+    if ((stations[DUT].tx_state != TX_IDLE) || dut_ed_running)
+    {
+        return TAL_BUSY;
+    }
+
+    dut_asleep = false;
+    dut_ed_running = true;
+    dut_ed_end = pal_add_time_us(now_us(),
+                                 TAL_CONVERT_SYMBOLS_TO_US(aBaseSuperframeDuration *
+                                                           ((1UL << scan_duration) + 1)));
+
+    return MAC_SUCCESS;
+}
+
+
+retval_t tal_pib_set(uint8_t attribute, pib_value_t *value)
+{
+    switch (attribute)
+    {
+        case macMaxFrameRetries:
+            tal_pib_MaxFrameRetries = value->pib_value_8bit;
+            break;
+
+        case macMaxCSMABackoffs:
+            tal_pib_MaxCSMABackoffs = value->pib_value_8bit;
+            break;
+
+#ifdef BEACON_SUPPORT
+        case macBattLifeExt:
+            tal_pib_BattLifeExt = value->pib_value_bool;
+            break;
+
+        case macBeaconOrder:
+            tal_pib_BeaconOrder = value->pib_value_8bit;
+            break;
+
+        case macSuperframeOrder:
+            tal_pib_SuperFrameOrder = value->pib_value_8bit;
+            break;
+
+        case macBeaconTxTime:
+            tal_pib_BeaconTxTime = value->pib_value_32bit;
+            break;
+#endif  /* BEACON_SUPPORT */
+
+#ifdef PROMISCUOUS_MODE
+        case macPromiscuousMode:
+            tal_pib_PromiscuousMode = value->pib_value_8bit;
+            dut_rx_on = tal_pib_PromiscuousMode;
+            break;
+#endif
+
+        default:
+            /* The remaining attributes are registers of the transceiver. */
+            if (dut_asleep)
+            {
+                return TAL_TRX_ASLEEP;
+            }
+
+            switch (attribute)
+            {
+                case macMinBE:
+                    tal_pib_MinBE = value->pib_value_8bit;
+                    if (tal_pib_MinBE > tal_pib_MaxBE)
+                    {
+                        tal_pib_MinBE = tal_pib_MaxBE;
+                    }
+                    break;
+
+                case macMaxBE:
+                    tal_pib_MaxBE = value->pib_value_8bit;
+                    if (tal_pib_MaxBE < tal_pib_MinBE)
+                    {
+                        tal_pib_MinBE = tal_pib_MaxBE;
+                    }
+                    break;
+
+                case macPANId:
+                    tal_pib_PANId = value->pib_value_16bit;
+                    break;
+
+                case macShortAddress:
+                    tal_pib_ShortAddress = value->pib_value_16bit;
+                    break;
+
+                case phyCurrentChannel:
+                    if (stations[DUT].tx_state != TX_IDLE)
+                    {
+                        return TAL_BUSY;
+                    }
+                    if (!((uint32_t)TRX_SUPPORTED_CHANNELS & ((uint32_t)0x01 << value->pib_value_8bit)))
+                    {
+                        return MAC_INVALID_PARAMETER;
+                    }
+                    tal_pib_CurrentChannel = value->pib_value_8bit;
+                    break;
+
+                case phyCurrentPage:
+                    if (stations[DUT].tx_state != TX_IDLE)
+                    {
+                        return TAL_BUSY;
+                    }
+                    if (value->pib_value_8bit != 0)
+                    {
+                        return MAC_INVALID_PARAMETER;
+                    }
+                    break;
+
+                case phyTransmitPower:
+                    tal_pib_TransmitPower = value->pib_value_8bit;
+                    break;
+
+                case phyCCAMode:
+                    tal_pib_CCAMode = value->pib_value_8bit;
+                    break;
+
+                case macIeeeAddress:
+                    tal_pib_IeeeAddress = value->pib_value_64bit;
+                    break;
+
+                case mac_i_pan_coordinator:
+                    tal_pib_PrivatePanCoordinator = value->pib_value_bool;
+                    break;
+
+                default:
+                    return MAC_UNSUPPORTED_ATTRIBUTE;
+            }
+            break;
+    }
+
+    return MAC_SUCCESS;
+}
+
+
+uint8_t tal_rx_enable(uint8_t state)
+{
+    if (stations[DUT].tx_state != TX_IDLE)
+    {
+        return TAL_BUSY;
+    }
+
+    if (state == PHY_TRX_OFF)
+    {
+        dut_rx_on = false;
+        return PHY_TRX_OFF;
+    }
+
+    /* Switching the receiver on wakes up the transceiver. */
+    dut_asleep = false;
+    dut_rx_on = true;
+    activate_remotes(now_us());
+
+    return PHY_RX_ON;
+}
+
+
+retval_t tal_tx_frame(frame_info_t *tx_frame, csma_mode_t csma_mode, bool perform_frame_retry)
+{
+    station_t *st = &stations[DUT];
+
+    if ((st->tx_state != TX_IDLE) || dut_ed_running)
+    {
+        return TAL_BUSY;
+    }
+
+    /* A transmission wakes up the transceiver. */
+    dut_asleep = false;
+    dut_frame = tx_frame;
+    tx_begin(st, tx_frame->mpdu, csma_mode,
+             perform_frame_retry ? tal_pib_MaxFrameRetries : 0);
+
+    return MAC_SUCCESS;
+}
+
+
+#ifdef BEACON_SUPPORT
+void tal_tx_beacon(frame_info_t *tx_frame)
+{
+    station_t *st = &stations[DUT];
+    uint32_t now = now_us();
+
+    /* A beacon is not sent during an ongoing transmission. */
+    if ((st->tx_state == TX_ON_AIR) || (st->tx_state == TX_WAIT_ACK))
+    {
+        return;
+    }
+
+    beacon_valid = true;
+    beacon_start = now;
+    air_commit(now, pal_add_time_us(now, AIRTIME_US(tx_frame->mpdu[0])));
+    activate_remotes(now);
+}
+#endif  /* BEACON_SUPPORT */
+
+
+retval_t tal_trx_sleep(sleep_mode_t mode)
+{
+    mode = mode;    /* Keep compiler happy. */
+
+    if (dut_asleep)
+    {
+        return TAL_TRX_ASLEEP;
+    }
+    if ((stations[DUT].tx_state != TX_IDLE) || dut_ed_running)
+    {
+        return TAL_BUSY;
+    }
+
+    dut_asleep = true;
+    dut_rx_on = false;
+
+    return MAC_SUCCESS;
+}
+
+
+retval_t tal_trx_wakeup(void)
+{
+    if (!dut_asleep)
+    {
+        return TAL_TRX_AWAKE;
+    }
+
+    dut_asleep = false;
+
+    return MAC_SUCCESS;
+}
+
+
+/*
+ * Emulation API
+ */
+
+void tal_sim_configure(const bench_config_t *config)
+{
+    uint8_t i;
+    uint32_t now = now_us();
+
+    run_config = *config;
+
+    /* The node under test is reset by bench_start(); its frame is dropped. */
+    memset(&stations[1], 0, sizeof(stations) - sizeof(stations[0]));
+    memset(air, 0, sizeof(air));
+    air_next = 0;
+    collisions = 0;
+    remotes_active = false;
+    beacon_valid = false;
+
+    if (config->role == BENCH_COORDINATOR)
+    {
+        num_stations = config->num_devices + 1;
+        for (i = 1; i < num_stations; i++)
+        {
+            stations[i].kind = (config->traffic == BENCH_INDIRECT) ? STATION_POLLER : STATION_SOURCE;
+            stations[i].short_addr = i;
+        }
+    }
+    else
+    {
+        num_stations = 2;
+        stations[1].kind = STATION_COORD;
+        stations[1].short_addr = COORD_ADDR;
+        if (config->traffic == BENCH_BEACON)
+        {
+            stations[1].phase = PHASE_BEACON;
+            stations[1].app_timer = true;
+            stations[1].app_time = pal_add_time_us(now, FIRST_BEACON_US);
+        }
+    }
+
+    for (i = 1; i < num_stations; i++)
+    {
+        stations[i].rand = 0x2545F491UL * i;
+        stations[i].dsn = i;
+    }
+}
+
+
+bool tal_sim_next_event(uint32_t *time)
+{
+    bool pending = false;
+    uint32_t now = now_us();
+    uint8_t i;
+
+    for (i = 0; i < num_stations; i++)
+    {
+        if (stations[i].tx_state != TX_IDLE)
+        {
+            *time = pending ? earlier(*time, stations[i].tx_time) : stations[i].tx_time;
+            pending = true;
+        }
+        if (stations[i].app_timer)
+        {
+            *time = pending ? earlier(*time, stations[i].app_time) : stations[i].app_time;
+            pending = true;
+        }
+    }
+    if (dut_ed_running)
+    {
+        *time = pending ? earlier(*time, dut_ed_end) : dut_ed_end;
+        pending = true;
+    }
+
+    /* Events in the past are due now. */
+    if (pending && time_reached(*time, now))
+    {
+        *time = now;
+    }
+
+    return pending;
+}
+
+
+uint32_t tal_sim_collisions(void)
+{
+    return collisions;
+}
+
+
+/*
+ * Helpers
+ */
+
+/**
+ * @brief Initializes the TAL PIB with the defaults of the AT86RF231 TAL
+ */
+static void init_tal_pib(void)
+{
+    tal_pib_MaxCSMABackoffs = TAL_MAX_CSMA_BACKOFFS_DEFAULT;
+    tal_pib_MinBE = TAL_MINBE_DEFAULT;
+    tal_pib_PANId = TAL_PANID_BC_DEFAULT;
+    tal_pib_ShortAddress = TAL_SHORT_ADDRESS_DEFAULT;
+    tal_pib_CurrentChannel = TAL_CURRENT_CHANNEL_DEFAULT;
+    tal_pib_SupportedChannels = TRX_SUPPORTED_CHANNELS;
+    tal_pib_CurrentPage = TAL_CURRENT_PAGE_DEFAULT;
+    tal_pib_MaxFrameDuration = TAL_MAX_FRAME_DURATION_DEFAULT;
+    tal_pib_SHRDuration = TAL_SHR_DURATION_DEFAULT;
+    tal_pib_SymbolsPerOctet = TAL_SYMBOLS_PER_OCTET_DEFAULT;
+    tal_pib_MaxBE = TAL_MAXBE_DEFAULT;
+    tal_pib_MaxFrameRetries = TAL_MAXFRAMERETRIES_DEFAULT;
+    tal_pib_TransmitPower = TAL_TRANSMIT_POWER_DEFAULT;
+    tal_pib_CCAMode = TAL_CCA_MODE_DEFAULT;
+    tal_pib_PrivatePanCoordinator = TAL_PAN_COORDINATOR_DEFAULT;
+#ifdef BEACON_SUPPORT
+    tal_pib_BattLifeExt = TAL_BATTERY_LIFE_EXTENSION_DEFAULT;
+    tal_pib_BeaconOrder = TAL_BEACON_ORDER_DEFAULT;
+    tal_pib_SuperFrameOrder = TAL_SUPERFRAME_ORDER_DEFAULT;
+    tal_pib_BeaconTxTime = TAL_BEACON_TX_TIME_DEFAULT;
+#endif
+#ifdef PROMISCUOUS_MODE
+    tal_pib_PromiscuousMode = TAL_PIB_PROMISCUOUS_MODE_DEFAULT;
+#endif
+}
+
+
+static uint32_t now_us(void)
+{
+    uint32_t now;
+
+    pal_get_current_time(&now);
+
+    return now;
+}
+
+
+/**
+ * @brief Checks whether a point in time is reached
+ */
+static bool time_reached(uint32_t time, uint32_t now)
+{
+    return (pal_sub_time_us(now, time) < 0x80000000UL);
+}
+
+
+/**
+ * @brief Gets the later of two points in time
+ */
+static uint32_t later(uint32_t a, uint32_t b)
+{
+    return time_reached(a, b) ? b : a;
+}
+
+
+/**
+ * @brief Gets the earlier of two points in time
+ */
+static uint32_t earlier(uint32_t a, uint32_t b)
+{
+    return time_reached(a, b) ? a : b;
+}
+
+
+/**
+ * @brief Gets a random backoff in the range 0 .. 2^be - 1
+ */
+static uint8_t next_rand(station_t *st, uint8_t be)
+{
+    st->rand = st->rand * 1103515245UL + 12345;
+
+    return (uint8_t)((st->rand >> 16) & ((1U << be) - 1));
+}
+
+
+/**
+ * @brief Puts a frame on the air; overlapping frames are corrupted
+ *
+ * @return Index of the frame in the history of the air
+ */
+static uint8_t air_commit(uint32_t start, uint32_t end)
+{
+    uint8_t index = air_next;
+    uint8_t i;
+    bool corrupted = false;
+
+    for (i = 0; i < AIR_HISTORY; i++)
+    {
+        air_frame_t *frame = &air[i];
+
+        if ((frame->end != frame->start) &&
+            !time_reached(frame->end, start) && !time_reached(end, frame->start))
+        {
+            if (!frame->corrupted)
+            {
+                collisions++;
+            }
+            frame->corrupted = true;
+            corrupted = true;
+        }
+    }
+
+    air[index].start = start;
+    air[index].end = end;
+    air[index].corrupted = corrupted;
+    if (corrupted)
+    {
+        collisions++;
+    }
+    air_next = (air_next + 1) % AIR_HISTORY;
+
+    return index;
+}
+
+
+/**
+ * @brief Checks whether a frame is on the air within a period
+ */
+static bool air_busy(uint32_t start, uint32_t end)
+{
+    uint8_t i;
+
+    for (i = 0; i < AIR_HISTORY; i++)
+    {
+        if ((air[i].end != air[i].start) &&
+            !time_reached(air[i].end, start) && !time_reached(end, air[i].start))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief Gets the addressing fields of a frame
+ */
+static void parse_frame(const uint8_t *mpdu, frame_addr_t *addr)
+{
+    uint16_t fcf = mpdu[PL_POS_FCF_1] | ((uint16_t)mpdu[PL_POS_FCF_2] << 8);
+    uint8_t pos = PL_POS_SEQ_NUM + 1;
+
+    memset(addr, 0, sizeof(*addr));
+    addr->type = fcf & FCF_FRAMETYPE_MASK;
+    addr->ack_request = ((fcf & FCF_ACK_REQUEST) != 0);
+    addr->dst_mode = (fcf >> FCF_DEST_ADDR_OFFSET) & 0x03;
+    addr->src_mode = (fcf >> FCF_SOURCE_ADDR_OFFSET) & 0x03;
+
+    if (addr->dst_mode != FCF_NO_ADDR)
+    {
+        addr->dst_pan = mpdu[pos] | ((uint16_t)mpdu[pos + 1] << 8);
+        pos += 2;
+        addr->dst_addr = mpdu[pos] | ((uint16_t)mpdu[pos + 1] << 8);
+        pos += (addr->dst_mode == FCF_SHORT_ADDR) ? 2 : 8;
+    }
+    if (addr->src_mode != FCF_NO_ADDR)
+    {
+        if (fcf & FCF_PAN_ID_COMPRESSION)
+        {
+            addr->src_pan = addr->dst_pan;
+        }
+        else
+        {
+            addr->src_pan = mpdu[pos] | ((uint16_t)mpdu[pos + 1] << 8);
+            pos += 2;
+        }
+        addr->src_addr = mpdu[pos] | ((uint16_t)mpdu[pos + 1] << 8);
+        pos += (addr->src_mode == FCF_SHORT_ADDR) ? 2 : 8;
+    }
+
+    addr->payload = &mpdu[pos];
+    addr->payload_len = mpdu[0] - FCS_LEN - (pos - 1);
+}
+
+
+static uint32_t beacon_interval_us(void)
+{
+    return TAL_CONVERT_SYMBOLS_TO_US(TAL_GET_BEACON_INTERVAL_TIME(run_config.beacon_order));
+}
+
+
+/**
+ * @brief Gets the end of the CAP of a superframe
+ */
+static uint32_t cap_end_us(uint32_t superframe_start)
+{
+    return pal_add_time_us(superframe_start,
+                           TAL_CONVERT_SYMBOLS_TO_US(TAL_GET_SUPERFRAME_DURATION_TIME(run_config.superframe_order)));
+}
+
+
+/*
+ * Transmission engine
+ */
+
+/**
+ * @brief Starts the transmission of a frame
+ */
+static void tx_begin(station_t *st, uint8_t *mpdu, csma_mode_t csma_mode, uint8_t max_retries)
+{
+    st->mpdu = mpdu;
+    st->csma_mode = csma_mode;
+    st->ack_requested = ((mpdu[PL_POS_FCF_1] & FCF_ACK_REQUEST) != 0);
+    st->max_retries = max_retries;
+    st->retries = 0;
+
+    tx_attempt(st, now_us());
+}
+
+
+/**
+ * @brief Starts an attempt to transmit the frame, with CSMA-CA if required
+ */
+static void tx_attempt(station_t *st, uint32_t now)
+{
+    /* The transceiver is busy until its ACK of a received frame is sent. */
+    now = later(now, st->ack_end);
+
+    if (st->kind == STATION_DUT)
+    {
+        st->be = tal_pib_MinBE;
+    }
+    else
+    {
+        st->be = REMOTE_MIN_BE;
+    }
+    st->nb = 0;
+
+    switch (st->csma_mode)
+    {
+        case NO_CSMA_NO_IFS:
+            tx_commit(st, pal_add_time_us(now, TURNAROUND_US));
+            break;
+
+        case NO_CSMA_WITH_IFS:
+            tx_commit(st, pal_add_time_us(now, (st->last_rx_len > aMaxSIFSFrameSize) ?
+                                          LIFS_US : SIFS_US));
+            break;
+
+        case CSMA_SLOTTED:
+            if (beacon_valid)
+            {
+                tx_slotted_backoff(st, now, next_rand(st, st->be));
+                break;
+            }
+            /* Without beacon reference the channel is accessed unslotted. */
+            tx_backoff(st, now);
+            break;
+
+        case CSMA_UNSLOTTED:
+        default:
+            tx_backoff(st, now);
+            break;
+    }
+}
+
+
+/**
+ * @brief Waits a random backoff before the CCA of unslotted CSMA-CA
+ */
+static void tx_backoff(station_t *st, uint32_t now)
+{
+    uint32_t start = later(now, st->ifs_end);
+
+    st->cca_start = pal_add_time_us(start, (uint32_t)next_rand(st, st->be) * BACKOFF_US);
+    st->tx_time = pal_add_time_us(st->cca_start, CCA_US);
+    st->tx_state = TX_CCA;
+}
+
+
+/**
+ * @brief Waits a random backoff before the two CCAs of slotted CSMA-CA
+ *
+ * The backoff starts at a backoff period boundary within the CAP; the CCAs,
+ * the frame and its ACK have to fit into the CAP, otherwise they are
+ * deferred to the CAP of the next superframe.
+ */
+static void tx_slotted_backoff(station_t *st, uint32_t now, uint8_t delay)
+{
+    uint32_t interval = beacon_interval_us();
+    uint32_t start = later(now, st->ifs_end);
+    uint32_t superframe = beacon_start;
+    uint32_t need = 2 * BACKOFF_US + AIRTIME_US(st->mpdu[0]) +
+                    (st->ack_requested ? (TURNAROUND_US + ACK_US) : 0);
+    uint32_t offset;
+    uint8_t i;
+
+    /* Superframe of the start time */
+    while (time_reached(pal_add_time_us(superframe, interval), start))
+    {
+        superframe = pal_add_time_us(superframe, interval);
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        uint32_t cap_start = pal_add_time_us(superframe, CAP_OFFSET_US);
+
+        start = later(start, cap_start);
+        /* Backoff period boundary */
+        offset = pal_sub_time_us(start, superframe);
+        offset = ((offset + BACKOFF_US - 1) / BACKOFF_US) * BACKOFF_US;
+        start = pal_add_time_us(superframe, offset + (uint32_t)delay * BACKOFF_US);
+
+        if (time_reached(pal_add_time_us(start, need), cap_end_us(superframe)))
+        {
+            break;
+        }
+        superframe = pal_add_time_us(superframe, interval);
+        start = superframe;
+    }
+
+    st->cw = 2;
+    st->cca_start = start;
+    st->tx_time = pal_add_time_us(start, CCA_US);
+    st->tx_state = TX_CCA;
+}
+
+
+/**
+ * @brief Puts the frame of a station on the air
+ */
+static void tx_commit(station_t *st, uint32_t start)
+{
+    st->frame_start = start;
+    st->frame_end = pal_add_time_us(start, AIRTIME_US(st->mpdu[0]));
+    st->air_index = air_commit(st->frame_start, st->frame_end);
+    st->tx_time = st->frame_end;
+    st->tx_state = TX_ON_AIR;
+}
+
+
+/**
+ * @brief Processes the event of the transmission engine of a station
+ */
+static void tx_event(station_t *st, uint32_t now)
+{
+    switch (st->tx_state)
+    {
+        case TX_CCA:
+            if (!air_busy(st->cca_start, now))
+            {
+                if ((st->csma_mode == CSMA_SLOTTED) && beacon_valid)
+                {
+                    if (--st->cw > 0)
+                    {
+                        /* Second CCA at the next backoff period boundary */
+                        st->cca_start = pal_add_time_us(st->cca_start, BACKOFF_US);
+                        st->tx_time = pal_add_time_us(st->cca_start, CCA_US);
+                        break;
+                    }
+                    tx_commit(st, pal_add_time_us(st->cca_start, BACKOFF_US));
+                }
+                else
+                {
+                    tx_commit(st, pal_add_time_us(now, TURNAROUND_US));
+                }
+                break;
+            }
+
+            /* Channel busy */
+            st->nb++;
+            if (st->nb > ((st->kind == STATION_DUT) ? tal_pib_MaxCSMABackoffs : REMOTE_MAX_CSMA_BACKOFFS))
+            {
+                tx_complete(st, MAC_CHANNEL_ACCESS_FAILURE);
+                break;
+            }
+            if (st->kind == STATION_DUT)
+            {
+                st->be = (st->be < tal_pib_MaxBE) ? (st->be + 1) : tal_pib_MaxBE;
+            }
+            else
+            {
+                st->be = (st->be < REMOTE_MAX_BE) ? (st->be + 1) : REMOTE_MAX_BE;
+            }
+            if ((st->csma_mode == CSMA_SLOTTED) && beacon_valid)
+            {
+                tx_slotted_backoff(st, now, next_rand(st, st->be));
+            }
+            else
+            {
+                tx_backoff(st, now);
+            }
+            break;
+
+        case TX_ON_AIR:
+            tx_end(st);
+            break;
+
+        case TX_WAIT_ACK:
+            if (st->acked && !air[st->ack_index].corrupted)
+            {
+                st->ifs_end = pal_add_time_us(now, (st->mpdu[0] > aMaxSIFSFrameSize) ?
+                                              LIFS_US : SIFS_US);
+                tx_complete(st, st->ack_frame_pending ? TAL_FRAME_PENDING : MAC_SUCCESS);
+            }
+            else if (st->retries < st->max_retries)
+            {
+                st->retries++;
+                tx_attempt(st, now);
+            }
+            else
+            {
+                tx_complete(st, MAC_NO_ACK);
+            }
+            break;
+
+        case TX_IDLE:
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief Delivers a frame at the end of its transmission
+ */
+static void tx_end(station_t *st)
+{
+    bool corrupted = air[st->air_index].corrupted;
+    bool acked = false;
+    bool frame_pending = false;
+    frame_addr_t addr;
+
+    parse_frame(st->mpdu, &addr);
+
+    if (st->kind == STATION_DUT)
+    {
+        station_t *dst = NULL;
+
+        if ((addr.dst_mode == FCF_SHORT_ADDR) && (addr.dst_addr != BROADCAST))
+        {
+            dst = find_station(addr.dst_addr);
+        }
+        if (!corrupted && (dst != NULL) &&
+            remote_receive(dst, &addr, st->frame_end, &frame_pending) &&
+            addr.ack_request)
+        {
+            acked = true;
+            dst->ack_end = pal_add_time_us(st->frame_end, TURNAROUND_US + ACK_US);
+        }
+    }
+    else if (!corrupted && dut_ready() && dut_accepts(&addr) &&
+             dut_receive(st->mpdu, st->frame_start))
+    {
+        stations[DUT].last_rx_len = st->mpdu[0];
+        if (addr.ack_request && (addr.dst_addr != BROADCAST))
+        {
+            acked = true;
+            stations[DUT].ack_end = pal_add_time_us(st->frame_end, TURNAROUND_US + ACK_US);
+        }
+    }
+
+    if (!addr.ack_request || (addr.dst_addr == BROADCAST))
+    {
+        st->ifs_end = pal_add_time_us(st->frame_end, (st->mpdu[0] > aMaxSIFSFrameSize) ?
+                                      LIFS_US : SIFS_US);
+        tx_complete(st, MAC_SUCCESS);
+        return;
+    }
+
+    st->acked = acked;
+    st->ack_frame_pending = frame_pending;
+    if (acked)
+    {
+        st->ack_index = air_commit(pal_add_time_us(st->frame_end, TURNAROUND_US),
+                                   pal_add_time_us(st->frame_end, TURNAROUND_US + ACK_US));
+        st->tx_time = pal_add_time_us(st->frame_end, TURNAROUND_US + ACK_US);
+    }
+    else
+    {
+        st->tx_time = pal_add_time_us(st->frame_end, ACK_WAIT_US);
+    }
+    st->tx_state = TX_WAIT_ACK;
+}
+
+
+/**
+ * @brief Completes a transmission
+ */
+static void tx_complete(station_t *st, retval_t status)
+{
+    st->tx_state = TX_IDLE;
+
+    if (st->kind == STATION_DUT)
+    {
+        frame_info_t *frame = dut_frame;
+
+        /* Like the real TAL, the receiver is switched on after each frame. */
+        dut_rx_on = true;
+        dut_frame = NULL;
+#if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
+        frame->time_stamp = st->frame_start;
+#endif
+        tal_tx_frame_done_cb(status, frame);
+    }
+    else
+    {
+        app_tx_done(st, status, st->tx_time);
+    }
+}
+
+
+/*
+ * Node under test
+ */
+
+/**
+ * @brief Checks whether the node under test is able to receive a frame
+ */
+static bool dut_ready(void)
+{
+    station_t *st = &stations[DUT];
+
+    return (dut_rx_on && !dut_asleep && !dut_ed_running &&
+            (st->tx_state == TX_IDLE) && time_reached(st->ack_end, now_us()));
+}
+
+
+/**
+ * @brief Applies the frame filter of the transceiver
+ */
+static bool dut_accepts(const frame_addr_t *addr)
+{
+    if (addr->type == FCF_FRAMETYPE_BEACON)
+    {
+        return ((tal_pib_PANId == BROADCAST) || (addr->src_pan == tal_pib_PANId));
+    }
+
+    return ((addr->dst_mode == FCF_SHORT_ADDR) &&
+            ((addr->dst_pan == tal_pib_PANId) || (addr->dst_pan == BROADCAST)) &&
+            ((addr->dst_addr == tal_pib_ShortAddress) || (addr->dst_addr == BROADCAST)));
+}
+
+
+/**
+ * @brief Passes a received frame to the MAC like the real TAL
+ *
+ * @return false if no buffer is available; the frame is not acknowledged
+ */
+static bool dut_receive(const uint8_t *mpdu, uint32_t start)
+{
+    buffer_t *buffer = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+    frame_info_t *frame;
+    uint8_t *frame_ptr;
+    uint8_t len = mpdu[0];
+
+    if (NULL == buffer)
+    {
+        return false;
+    }
+
+    frame = (frame_info_t *)BMM_BUFFER_POINTER(buffer);
+    frame_ptr = (uint8_t *)frame + LARGE_BUFFER_SIZE - (len + LENGTH_FIELD_LEN + LQI_LEN + ED_VAL_LEN);
+    memcpy(frame_ptr, mpdu, len + LENGTH_FIELD_LEN);
+    frame_ptr[len + LENGTH_FIELD_LEN] = 0xFF;           /* LQI */
+    frame_ptr[len + LENGTH_FIELD_LEN + LQI_LEN] = 0;    /* ED value */
+
+    frame->mpdu = frame_ptr;
+    frame->buffer_header = buffer;
+#if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
+    frame->time_stamp = start;
+#else
+    start = start;  /* Keep compiler happy. */
+#endif
+
+    tal_rx_frame_cb(frame);
+
+    return true;
+}
+
+
+/*
+ * Remote nodes
+ */
+
+static station_t *find_station(uint16_t short_addr)
+{
+    uint8_t i;
+
+    for (i = 1; i < num_stations; i++)
+    {
+        if (stations[i].short_addr == short_addr)
+        {
+            return &stations[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Receives a frame of the node under test at a remote node
+ *
+ * @param dst Remote node the frame is addressed to
+ * @param addr Addressing of the frame
+ * @param end End of the frame
+ * @param frame_pending Returns the frame pending bit of the ACK
+ *
+ * @return true if the frame is received
+ */
+static bool remote_receive(station_t *dst, const frame_addr_t *addr, uint32_t end, bool *frame_pending)
+{
+    switch (dst->kind)
+    {
+        case STATION_COORD:
+            if ((dst->tx_state == TX_ON_AIR) || (dst->tx_state == TX_WAIT_ACK))
+            {
+                return false;
+            }
+            if ((addr->type == FCF_FRAMETYPE_MAC_CMD) && (addr->payload[0] == DATAREQUEST) &&
+                (run_config.traffic == BENCH_INDIRECT))
+            {
+                /* There is always a frame for the device under test. */
+                *frame_pending = true;
+                if (!dst->data_pending)
+                {
+                    dst->data_pending = true;
+                    dst->last_rx_len = addr->payload_len + HDR_LEN + FCS_LEN;
+                    dst->phase = PHASE_SEND;
+                    dst->app_timer = true;
+                    dst->app_time = pal_add_time_us(end, TURNAROUND_US + ACK_US);
+                }
+            }
+            return true;
+
+        case STATION_POLLER:
+            if ((dst->phase != PHASE_WAIT_DATA) || (addr->type != FCF_FRAMETYPE_DATA))
+            {
+                return false;
+            }
+            /* Data received; the next poll follows after the ACK. */
+            dst->phase = PHASE_SEND;
+            dst->app_timer = true;
+            dst->app_time = pal_add_time_us(end, TURNAROUND_US + ACK_US + LIFS_US);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+/**
+ * @brief Processes the timer of the behaviour of a remote node
+ */
+static void app_event(station_t *st, uint32_t now)
+{
+    uint8_t len;
+
+    if (st->tx_state != TX_IDLE)
+    {
+        /* Retried when the ongoing transmission is completed */
+        st->app_timer = true;
+        st->app_time = st->tx_time;
+        return;
+    }
+
+    switch (st->kind)
+    {
+        case STATION_SOURCE:
+            if (run_config.traffic == BENCH_BROADCAST)
+            {
+                len = build_data(st, BROADCAST, false);
+            }
+            else
+            {
+                len = build_data(st, COORD_ADDR, true);
+            }
+            st->frame[0] = len;
+            tx_begin(st, st->frame, (run_config.traffic == BENCH_BEACON) ? CSMA_SLOTTED : CSMA_UNSLOTTED,
+                     REMOTE_MAX_FRAME_RETRIES);
+            break;
+
+        case STATION_POLLER:
+            if (st->phase == PHASE_WAIT_DATA)
+            {
+                /* No data within the wait time; poll again. */
+                st->phase = PHASE_SEND;
+            }
+            st->frame[0] = build_data_request(st);
+            tx_begin(st, st->frame, CSMA_UNSLOTTED, REMOTE_MAX_FRAME_RETRIES);
+            break;
+
+        case STATION_COORD:
+            if (st->phase == PHASE_BEACON)
+            {
+                st->frame[0] = build_beacon(st);
+                st->mpdu = st->frame;
+                st->ack_requested = false;
+                beacon_valid = true;
+                beacon_start = now;
+                tx_commit(st, now);
+                st->app_timer = true;
+                st->app_time = pal_add_time_us(now, beacon_interval_us());
+            }
+            else if (st->data_pending)
+            {
+                st->frame[0] = build_data(st, tal_pib_ShortAddress, true);
+                tx_begin(st, st->frame, CSMA_UNSLOTTED, REMOTE_MAX_FRAME_RETRIES);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief Continues the behaviour of a remote node after a transmission
+ */
+static void app_tx_done(station_t *st, retval_t status, uint32_t now)
+{
+    switch (st->kind)
+    {
+        case STATION_SOURCE:
+            /* The next frame follows right away. */
+            st->app_timer = true;
+            st->app_time = now;
+            break;
+
+        case STATION_POLLER:
+            st->app_timer = true;
+            if ((status == MAC_SUCCESS) || (status == TAL_FRAME_PENDING))
+            {
+                st->phase = PHASE_WAIT_DATA;
+                st->app_time = pal_add_time_us(now, DATA_WAIT_US);
+            }
+            else
+            {
+                st->app_time = now;
+            }
+            break;
+
+        case STATION_COORD:
+            if (st->mpdu[PL_POS_FCF_1] != FCF_FRAMETYPE_BEACON)
+            {
+                /* The data frame is sent once, like an indirect frame. */
+                st->data_pending = false;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief Starts the traffic of the remote devices once the node under
+ *        test is able to receive
+ */
+static void activate_remotes(uint32_t now)
+{
+    uint8_t i;
+
+    if (remotes_active || (run_config.role != BENCH_COORDINATOR))
+    {
+        return;
+    }
+    /* In a beacon-enabled PAN the devices wait for the first beacon. */
+    if ((run_config.traffic == BENCH_BEACON) && !beacon_valid)
+    {
+        return;
+    }
+
+    remotes_active = true;
+    for (i = 1; i < num_stations; i++)
+    {
+        stations[i].phase = PHASE_SEND;
+        stations[i].app_timer = true;
+        stations[i].app_time = pal_add_time_us(now, (uint32_t)i * STAGGER_US);
+    }
+}
+
+
+/**
+ * @brief Builds a data frame carrying a benchmark MSDU
+ *
+ * @return PSDU length
+ */
+static uint8_t build_data(station_t *st, uint16_t dst_addr, bool ack_request)
+{
+    uint8_t *frame = st->frame;
+    uint8_t msdu_len = run_config.msdu_length;
+
+    frame[PL_POS_FCF_1] = FCF_FRAMETYPE_DATA | FCF_PAN_ID_COMPRESSION |
+                          (ack_request ? FCF_ACK_REQUEST : 0);
+    frame[PL_POS_FCF_2] = (uint8_t)((FCF_SET_DEST_ADDR_MODE(FCF_SHORT_ADDR) |
+                                     FCF_SET_SOURCE_ADDR_MODE(FCF_SHORT_ADDR)) >> 8);
+    frame[PL_POS_SEQ_NUM] = st->dsn++;
+    frame[4] = (uint8_t)tal_pib_PANId;
+    frame[5] = (uint8_t)(tal_pib_PANId >> 8);
+    frame[6] = (uint8_t)dst_addr;
+    frame[7] = (uint8_t)(dst_addr >> 8);
+    frame[8] = (uint8_t)st->short_addr;
+    frame[9] = (uint8_t)(st->short_addr >> 8);
+
+    memset(&frame[HDR_LEN + 1], 0, msdu_len);
+    frame[HDR_LEN + 1] = BENCH_MSDU_TYPE;
+    frame[HDR_LEN + 2] = (uint8_t)st->msdu_seq;
+    frame[HDR_LEN + 3] = (uint8_t)(st->msdu_seq >> 8);
+    st->msdu_seq++;
+
+    return (HDR_LEN + msdu_len + FCS_LEN);
+}
+
+
+/**
+ * @brief Builds a data request command to the coordinator
+ *
+ * @return PSDU length
+ */
+static uint8_t build_data_request(station_t *st)
+{
+    uint8_t *frame = st->frame;
+
+    frame[PL_POS_FCF_1] = FCF_FRAMETYPE_MAC_CMD | FCF_PAN_ID_COMPRESSION | FCF_ACK_REQUEST;
+    frame[PL_POS_FCF_2] = (uint8_t)((FCF_SET_DEST_ADDR_MODE(FCF_SHORT_ADDR) |
+                                     FCF_SET_SOURCE_ADDR_MODE(FCF_SHORT_ADDR)) >> 8);
+    frame[PL_POS_SEQ_NUM] = st->dsn++;
+    frame[4] = (uint8_t)tal_pib_PANId;
+    frame[5] = (uint8_t)(tal_pib_PANId >> 8);
+    frame[6] = (uint8_t)COORD_ADDR;
+    frame[7] = (uint8_t)(COORD_ADDR >> 8);
+    frame[8] = (uint8_t)st->short_addr;
+    frame[9] = (uint8_t)(st->short_addr >> 8);
+    frame[HDR_LEN + 1] = DATAREQUEST;
+
+    return (HDR_LEN + 1 + FCS_LEN);
+}
+
+
+/**
+ * @brief Builds a beacon without GTS and pending addresses
+ *
+ * @return PSDU length
+ */
+static uint8_t build_beacon(station_t *st)
+{
+    uint8_t *frame = st->frame;
+    uint16_t pan_id = tal_pib_PANId;
+
+    frame[PL_POS_FCF_1] = FCF_FRAMETYPE_BEACON;
+    frame[PL_POS_FCF_2] = (uint8_t)(FCF_SET_SOURCE_ADDR_MODE(FCF_SHORT_ADDR) >> 8);
+    frame[PL_POS_SEQ_NUM] = st->dsn++;
+    frame[4] = (uint8_t)pan_id;
+    frame[5] = (uint8_t)(pan_id >> 8);
+    frame[6] = (uint8_t)st->short_addr;
+    frame[7] = (uint8_t)(st->short_addr >> 8);
+    frame[8] = run_config.beacon_order | (run_config.superframe_order << 4);
+    frame[9] = SUPERFRAME_SPEC_HIGH;
+    frame[10] = 0;  /* GTS specification */
+    frame[11] = 0;  /* Pending address specification */
+
+    return (BEACON_LEN + FCS_LEN);
+}
+
+/* EOF */
@@ -0,0 +1,246 @@
+/**
+ * @file mac_bench.h
+ *
+ * @brief MAC throughput benchmark
+ *
+ * The benchmark generates data traffic via the MAC API between a PAN
+ * coordinator and one or more devices and measures the MSDU rate, the
+ * goodput, the latency from the data request until its confirm and the CPU
+ * time spent in the MAC. The traffic mixes are:
+ *
+ *  - direct:    acknowledged unicast from the devices to the coordinator,
+ *  - broadcast: unacknowledged broadcast from the devices,
+ *  - indirect:  acknowledged frames queued by the coordinator for the
+ *               devices, which fetch them by polling,
+ *  - beacon:    acknowledged unicast from the devices to the coordinator in
+ *               the CAP of a beacon-enabled PAN, i.e. with slotted CSMA-CA.
+ *
+ * The nodes do not scan or associate: all of them set the PIB attributes
+ * directly; the coordinator starts the PAN, the devices of a beacon-enabled
+ * PAN synchronize with it. Each node measures on its own: the sender starts
+ * with its first data request, the receiver with its first indication, and
+ * both run for the configured duration.
+ *
+ * The CPU time of the MAC is the time spent in wpan_task() calls that
+ * processed an event, including the callbacks, plus the time spent in the
+ * requests of the benchmark; interrupt service routines are not included.
+ *
+ * The module implements the MAC callbacks used by the benchmark; the
+ * application only configures and starts the runs, calls bench_task()
+ * instead of wpan_task() and prints the results.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef MAC_BENCH_H
+#define MAC_BENCH_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+/** Maximum number of devices of a run */
+#ifndef BENCH_MAX_DEVICES
+#define BENCH_MAX_DEVICES               (8)
+#endif
+
+/**
+ * Maximum number of data requests outstanding at a node; each of them
+ * holds a large buffer, see NUMBER_OF_LARGE_APP_BUFS.
+ */
+#ifndef BENCH_MAX_OUTSTANDING
+#define BENCH_MAX_OUTSTANDING           (8)
+#endif
+
+/**
+ * Reads the clock used for the CPU time of the MAC in us; a host build may
+ * replace it by the CPU time of the process.
+ */
+#ifndef BENCH_CPU_CLOCK
+#define BENCH_CPU_CLOCK(time)           pal_get_current_time(time)
+#endif
+
+/** Minimum MSDU length: type and sequence number */
+#define BENCH_MSDU_MIN_LEN              (3)
+
+/**
+ * Maximum MSDU length: frame with short addresses, PAN ID compression and
+ * without security (MHR 9 octets, MFR 2 octets)
+ */
+#define BENCH_MSDU_MAX_LEN              (aMaxPHYPacketSize - 11)
+
+/** MSDU type of benchmark frames */
+#define BENCH_MSDU_TYPE                 (0x42)
+
+/* === Types ================================================================ */
+
+/**
+ * Traffic mix of a run
+ */
+typedef enum bench_traffic_tag
+{
+    BENCH_DIRECT,
+    BENCH_BROADCAST,
+    BENCH_INDIRECT,
+    BENCH_BEACON,
+    BENCH_NUM_TRAFFIC
+} bench_traffic_t;
+
+/**
+ * Role of a node in a run
+ */
+typedef enum bench_role_tag
+{
+    BENCH_COORDINATOR,
+    BENCH_DEVICE
+} bench_role_t;
+
+/**
+ * Configuration of a run
+ */
+typedef struct bench_config_tag
+{
+    /** Traffic mix */
+    bench_traffic_t traffic;
+    /** Role of this node */
+    bench_role_t role;
+    /** Number of this device (1 .. BENCH_MAX_DEVICES), its short address */
+    uint8_t device_index;
+    /** Number of devices the coordinator sends to (indirect only) */
+    uint8_t num_devices;
+    /** Length of the MSDUs (BENCH_MSDU_MIN_LEN .. BENCH_MSDU_MAX_LEN) */
+    uint8_t msdu_length;
+    /** Number of data requests outstanding per destination */
+    uint8_t window;
+    /** Beacon order (beacon only) */
+    uint8_t beacon_order;
+    /** Superframe order (beacon only) */
+    uint8_t superframe_order;
+    /** Duration of the run in ms */
+    uint32_t duration_ms;
+} bench_config_t;
+
+/**
+ * Result of a run
+ */
+typedef struct bench_result_tag
+{
+    /** Duration of the measurement in us */
+    uint32_t elapsed_us;
+    /** Data requests accepted by the MAC */
+    uint32_t requests;
+    /** Confirms with status MAC_SUCCESS */
+    uint32_t confirmed;
+    /** Confirms with status MAC_NO_ACK */
+    uint32_t no_ack;
+    /** Confirms with status MAC_CHANNEL_ACCESS_FAILURE */
+    uint32_t channel_access_failures;
+    /** Confirms with any other status */
+    uint32_t other_failures;
+    /** Data indications of benchmark frames */
+    uint32_t indications;
+    /** MSDU octets of the indications */
+    uint32_t indicated_octets;
+    /** Frames missing in the sequence of a sender */
+    uint32_t lost;
+    /** Frames indicated twice */
+    uint32_t duplicates;
+    /** Polls without data (indirect only) */
+    uint32_t empty_polls;
+    /** Sync losses (beacon only) */
+    uint16_t sync_losses;
+    /** Confirm latency in us; 0 if no confirm was received */
+    uint32_t latency_min;
+    uint32_t latency_mean;
+    uint32_t latency_p50;
+    uint32_t latency_p99;
+    uint32_t latency_max;
+    /** CPU time of the MAC in us */
+    uint32_t mac_cpu_us;
+} bench_result_t;
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts a run: resets the MAC, sets up the network and generates
+ *        the traffic of the configuration
+ *
+ * @param config Configuration of the run; it is copied
+ *
+ * @return true if the configuration is valid
+ */
+bool bench_start(const bench_config_t *config);
+
+/**
+ * @brief Ends the run before the configured duration
+ */
+void bench_stop(void);
+
+/**
+ * @brief Runs the MAC and the traffic generator; called instead of
+ *        wpan_task() in the main loop
+ *
+ * @return true if an event was processed or a request was issued
+ */
+bool bench_task(void);
+
+/**
+ * @brief Checks whether the current run is completed
+ *
+ * @return true once all confirms of the run are received
+ */
+bool bench_done(void);
+
+/**
+ * @brief Checks whether this node is sending in the current run
+ *
+ * @return true for the devices, and for the coordinator with indirect traffic
+ */
+bool bench_is_sender(void);
+
+/**
+ * @brief Gets the result of the current or last run
+ *
+ * @param result Returns the result
+ */
+void bench_get_result(bench_result_t *result);
+
+/**
+ * @brief Prints the result of the last run to the terminal
+ */
+void bench_print_result(void);
+
+/**
+ * @brief Gets the name of a traffic mix
+ *
+ * @param traffic Traffic mix
+ *
+ * @return Name of the traffic mix
+ */
+const char *bench_traffic_name(bench_traffic_t traffic);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* MAC_BENCH_H */
+/* EOF */
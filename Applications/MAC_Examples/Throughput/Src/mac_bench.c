@@ -0,0 +1,1143 @@
+/**
+ * @file mac_bench.c
+ *
+ * @brief MAC throughput benchmark
+ *
+ * MSDU format: type (BENCH_MSDU_TYPE), sequence number (2 octets, little
+ * endian) and padding. Each sender numbers the MSDUs per destination, so the
+ * receiver detects lost and duplicated frames.
+ *
+ * The confirm latencies are collected in a histogram with four bins per
+ * octave, so the percentiles are accurate to about 12 %; minimum, mean and
+ * maximum are exact.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "pal.h"
+#include "tal.h"
+#include "mac_api.h"
+#include "app_config.h"
+#include "ieee_const.h"
+#include "mac_bench.h"
+
+/* === MACROS ============================================================== */
+
+#ifdef CHANNEL
+#define DEFAULT_CHANNEL                 (CHANNEL)
+#define DEFAULT_CHANNEL_PAGE            (0)
+#else
+/** Defines the default channel. */
+#if (TAL_TYPE == AT86RF212)
+    #ifdef CHINESE_BAND
+        #define DEFAULT_CHANNEL                 (0)
+        #define DEFAULT_CHANNEL_PAGE            (5)
+    #else
+        #define DEFAULT_CHANNEL                 (1)
+        #define DEFAULT_CHANNEL_PAGE            (0)
+    #endif  /* #ifdef CHINESE_BAND */
+#else
+#define DEFAULT_CHANNEL                 (20)
+#define DEFAULT_CHANNEL_PAGE            (0)
+#endif  /* #if (TAL_TYPE == AT86RF212) */
+#endif  /* #ifdef CHANNEL */
+/** Defines the PAN ID of the network. */
+#ifdef PAN_ID
+#define DEFAULT_PAN_ID                  (PAN_ID)
+#else
+#define DEFAULT_PAN_ID                  (0xBABE)
+#endif
+/** Defines the short address of the coordinator. */
+#define COORD_SHORT_ADDR                (0x0000)
+
+/** Number of the coordinator in the per node arrays; devices use 1 .. n */
+#define COORD_INDEX                     (0)
+
+/** Values below 2^LATENCY_MIN_SHIFT us fall into the first bin */
+#define LATENCY_MIN_SHIFT               (6)
+/** Bins per octave are 2^LATENCY_SUB_BITS */
+#define LATENCY_SUB_BITS                (2)
+/** Octaves covered by the histogram; larger values fall into the last bin */
+#define LATENCY_OCTAVES                 (18)
+/** Number of bins of the latency histogram */
+#define LATENCY_BINS                    (LATENCY_OCTAVES << LATENCY_SUB_BITS)
+
+#if (BENCH_MAX_OUTSTANDING > NUMBER_OF_LARGE_APP_BUFS)
+#error "Each outstanding request requires a large application buffer"
+#endif
+
+#if (BENCH_MAX_OUTSTANDING > 255)
+#error "The outstanding requests are identified by the MSDU handle"
+#endif
+
+/* === TYPES =============================================================== */
+
+/**
+ * State of the run
+ */
+typedef enum bench_state_tag
+{
+    BENCH_IDLE,
+    /* The PIB attributes are set and the PAN is started. */
+    BENCH_SETUP,
+    /* The device waits for the first beacon. */
+    BENCH_WAIT_SYNC,
+    BENCH_RUNNING,
+    /* The requests of the run are completed. */
+    BENCH_DRAINING,
+    BENCH_DONE
+} bench_state_t;
+
+/**
+ * Outstanding data request, addressed by its MSDU handle
+ */
+typedef struct request_tag
+{
+    bool used;
+    uint8_t dst_index;
+    uint32_t time;
+} request_t;
+
+/* === GLOBALS ============================================================= */
+
+static bench_config_t config;
+static bench_state_t state = BENCH_IDLE;
+static bench_result_t result;
+
+/** true once the measurement started with the first request or indication */
+static bool measuring;
+static uint32_t start_time;
+static uint32_t end_time;
+
+static request_t requests[BENCH_MAX_OUTSTANDING];
+static uint8_t outstanding;
+/** Outstanding requests per destination */
+static uint8_t pending[BENCH_MAX_DEVICES + 1];
+/** Next sequence number per destination */
+static uint16_t tx_seq[BENCH_MAX_DEVICES + 1];
+/** Next expected sequence number per source */
+static uint16_t rx_seq[BENCH_MAX_DEVICES + 1];
+static bool rx_seq_valid[BENCH_MAX_DEVICES + 1];
+/** true while a poll request of the device is pending */
+static bool polling;
+
+static uint16_t latency_hist[LATENCY_BINS];
+static uint32_t latency_sum;
+
+static uint8_t msdu[aMaxMACPayloadSize];
+
+static const char *const traffic_names[BENCH_NUM_TRAFFIC] =
+{
+    "direct",
+    "broadcast",
+    "indirect",
+    "beacon"
+};
+
+/* === PROTOTYPES ========================================================== */
+
+static bool generate_traffic(void);
+static bool send_msdu(uint8_t dst_index);
+static void poll_coordinator(void);
+static void start_measurement(void);
+static void network_ready(void);
+static void record_latency(uint32_t latency);
+static uint32_t latency_percentile(uint8_t percent);
+static void print_rate(const char *name, uint32_t count, uint32_t scale,
+                       uint32_t elapsed_us);
+
+/* === IMPLEMENTATION ====================================================== */
+
+
+bool bench_start(const bench_config_t *new_config)
+{
+    if ((new_config->traffic >= BENCH_NUM_TRAFFIC) ||
+        (new_config->msdu_length < BENCH_MSDU_MIN_LEN) ||
+        (new_config->msdu_length > BENCH_MSDU_MAX_LEN) ||
+        (new_config->window == 0) ||
+        (new_config->window > BENCH_MAX_OUTSTANDING) ||
+        (new_config->duration_ms == 0))
+    {
+        return false;
+    }
+
+    if ((new_config->role == BENCH_DEVICE) &&
+        ((new_config->device_index == 0) || (new_config->device_index > BENCH_MAX_DEVICES)))
+    {
+        return false;
+    }
+
+    if ((new_config->role == BENCH_COORDINATOR) && (new_config->traffic == BENCH_INDIRECT) &&
+        ((new_config->num_devices == 0) || (new_config->num_devices > BENCH_MAX_DEVICES)))
+    {
+        return false;
+    }
+
+    if ((new_config->traffic == BENCH_BEACON) &&
+        ((new_config->beacon_order >= NON_BEACON_NWK) ||
+         (new_config->superframe_order > new_config->beacon_order)))
+    {
+        return false;
+    }
+
+    config = *new_config;
+    memset(&result, 0, sizeof(result));
+    memset(requests, 0, sizeof(requests));
+    memset(pending, 0, sizeof(pending));
+    memset(tx_seq, 0, sizeof(tx_seq));
+    memset(rx_seq_valid, 0, sizeof(rx_seq_valid));
+    memset(latency_hist, 0, sizeof(latency_hist));
+    latency_sum = 0;
+    outstanding = 0;
+    polling = false;
+    measuring = false;
+
+    memset(msdu, 0, sizeof(msdu));
+    msdu[0] = BENCH_MSDU_TYPE;
+
+    state = BENCH_SETUP;
+
+    /*
+     * Reset the MAC layer to the default values
+     * This request will cause a mlme reset confirm message ->
+     * usr_mlme_reset_conf
+     */
+    wpan_mlme_reset_req(true);
+
+    return true;
+}
+
+
+void bench_stop(void)
+{
+    if (state < BENCH_RUNNING)
+    {
+        state = BENCH_DONE;
+    }
+    else if (state == BENCH_RUNNING)
+    {
+        state = BENCH_DRAINING;
+    }
+}
+
+
+bool bench_task(void)
+{
+    uint32_t cpu_start;
+    uint32_t cpu_end;
+    bool processed;
+
+    BENCH_CPU_CLOCK(&cpu_start);
+    processed = wpan_task();
+    BENCH_CPU_CLOCK(&cpu_end);
+
+    if (processed && measuring)
+    {
+        result.mac_cpu_us += cpu_end - cpu_start;
+    }
+
+    if (measuring && (state == BENCH_RUNNING))
+    {
+        uint32_t now;
+
+        pal_get_current_time(&now);
+        if (pal_sub_time_us(now, start_time) >= config.duration_ms * 1000UL)
+        {
+            state = BENCH_DRAINING;
+        }
+    }
+
+    if (state == BENCH_RUNNING)
+    {
+        processed |= generate_traffic();
+    }
+
+    if ((state == BENCH_DRAINING) && (outstanding == 0) && !polling)
+    {
+        pal_get_current_time(&end_time);
+        state = BENCH_DONE;
+    }
+
+    return processed;
+}
+
+
+bool bench_done(void)
+{
+    return (state == BENCH_DONE);
+}
+
+
+bool bench_is_sender(void)
+{
+    if (config.traffic == BENCH_INDIRECT)
+    {
+        return (config.role == BENCH_COORDINATOR);
+    }
+
+    return (config.role == BENCH_DEVICE);
+}
+
+
+void bench_get_result(bench_result_t *run_result)
+{
+    *run_result = result;
+
+    if (measuring)
+    {
+        uint32_t now = end_time;
+
+        if (state != BENCH_DONE)
+        {
+            pal_get_current_time(&now);
+        }
+        run_result->elapsed_us = pal_sub_time_us(now, start_time);
+    }
+
+    if (result.confirmed > 0)
+    {
+        run_result->latency_mean = latency_sum / result.confirmed;
+        run_result->latency_p50 = latency_percentile(50);
+        run_result->latency_p99 = latency_percentile(99);
+    }
+}
+
+
+void bench_print_result(void)
+{
+    bench_result_t res;
+    uint32_t msdus;
+
+    bench_get_result(&res);
+
+    if (config.role == BENCH_COORDINATOR)
+    {
+        printf("\r\nTraffic %s, coordinator", traffic_names[config.traffic]);
+    }
+    else
+    {
+        printf("\r\nTraffic %s, device %u", traffic_names[config.traffic],
+               config.device_index);
+    }
+    printf(", MSDU length %u, window %u\r\n", config.msdu_length, config.window);
+    printf("Duration = %" PRIu32 " ms\r\n", res.elapsed_us / 1000);
+
+    if (bench_is_sender())
+    {
+        msdus = res.confirmed;
+        printf("Requests = %" PRIu32 ", confirmed = %" PRIu32 "\r\n",
+               res.requests, res.confirmed);
+        printf("Failures: no ACK = %" PRIu32 ", channel access = %" PRIu32
+               ", other = %" PRIu32 "\r\n",
+               res.no_ack, res.channel_access_failures, res.other_failures);
+        if (res.confirmed > 0)
+        {
+            printf("Confirm latency in us: min %" PRIu32 ", mean %" PRIu32
+                   ", p50 %" PRIu32 ", p99 %" PRIu32 ", max %" PRIu32 "\r\n",
+                   res.latency_min, res.latency_mean, res.latency_p50,
+                   res.latency_p99, res.latency_max);
+        }
+    }
+    else
+    {
+        msdus = res.indications;
+        printf("Indications = %" PRIu32 ", lost = %" PRIu32
+               ", duplicates = %" PRIu32 "\r\n",
+               res.indications, res.lost, res.duplicates);
+    }
+
+    if (config.traffic == BENCH_INDIRECT && (config.role == BENCH_DEVICE))
+    {
+        printf("Polls without data = %" PRIu32 "\r\n", res.empty_polls);
+    }
+    if (config.traffic == BENCH_BEACON)
+    {
+        printf("Sync losses = %u\r\n", res.sync_losses);
+    }
+
+    if (res.elapsed_us == 0)
+    {
+        return;
+    }
+
+    print_rate("MSDU rate in 1/s", msdus, 1, res.elapsed_us);
+    print_rate("Goodput in bit/s", msdus, 8U * config.msdu_length, res.elapsed_us);
+    printf("MAC CPU time = %" PRIu32 " us, load = %" PRIu32 ".%" PRIu32 " %%",
+           res.mac_cpu_us,
+           (uint32_t)((uint64_t)res.mac_cpu_us * 100 / res.elapsed_us),
+           (uint32_t)((uint64_t)res.mac_cpu_us * 1000 / res.elapsed_us % 10));
+    if (msdus > 0)
+    {
+        printf(", %" PRIu32 " us per MSDU", res.mac_cpu_us / msdus);
+    }
+    printf("\r\n");
+}
+
+
+const char *bench_traffic_name(bench_traffic_t traffic)
+{
+    if (traffic >= BENCH_NUM_TRAFFIC)
+    {
+        return "unknown";
+    }
+
+    return traffic_names[traffic];
+}
+
+
+/**
+ * @brief Prints a rate per second with one decimal
+ *
+ * @param name Name of the rate
+ * @param count Number of MSDUs of the run
+ * @param scale Factor applied to the count, e.g. bits per MSDU
+ * @param elapsed_us Duration of the run in us
+ */
+static void print_rate(const char *name, uint32_t count, uint32_t scale,
+                       uint32_t elapsed_us)
+{
+    uint64_t rate_x10 = (uint64_t)count * scale * 10000000UL / elapsed_us;
+
+    printf("%s = %" PRIu32 ".%" PRIu32 "\r\n", name,
+           (uint32_t)(rate_x10 / 10), (uint32_t)(rate_x10 % 10));
+}
+
+
+/**
+ * @brief Issues the requests of a sender up to its window
+ *
+ * @return true if a request was issued
+ */
+static bool generate_traffic(void)
+{
+    bool issued = false;
+
+    if (config.traffic == BENCH_INDIRECT)
+    {
+        if (config.role == BENCH_DEVICE)
+        {
+            if (!polling)
+            {
+                poll_coordinator();
+                issued = true;
+            }
+        }
+        else
+        {
+            uint8_t dst_index;
+
+            for (dst_index = 1; dst_index <= config.num_devices; dst_index++)
+            {
+                while ((pending[dst_index] < config.window) &&
+                       (outstanding < BENCH_MAX_OUTSTANDING))
+                {
+                    if (!send_msdu(dst_index))
+                    {
+                        return issued;
+                    }
+                    issued = true;
+                }
+            }
+        }
+    }
+    else if (config.role == BENCH_DEVICE)
+    {
+        while (outstanding < config.window)
+        {
+            if (!send_msdu(COORD_INDEX))
+            {
+                break;
+            }
+            issued = true;
+        }
+    }
+
+    return issued;
+}
+
+
+/**
+ * @brief Requests the transmission of the next MSDU to a destination
+ *
+ * @param dst_index Destination; COORD_INDEX or the number of a device
+ *
+ * @return true if the MAC accepted the request; otherwise no buffer is
+ *         available and the request is repeated later
+ */
+static bool send_msdu(uint8_t dst_index)
+{
+    wpan_addr_spec_t dst_addr;
+    uint16_t short_addr;
+    uint8_t tx_options;
+    uint8_t handle;
+    uint32_t cpu_start;
+    uint32_t cpu_end;
+    bool accepted;
+
+    /* A free handle exists, since outstanding < BENCH_MAX_OUTSTANDING. */
+    for (handle = 0; requests[handle].used; handle++)
+    {
+    }
+
+    switch (config.traffic)
+    {
+        case BENCH_BROADCAST:
+            short_addr = BROADCAST;
+            tx_options = WPAN_TXOPT_OFF;
+            break;
+
+        case BENCH_INDIRECT:
+            short_addr = dst_index;
+            tx_options = WPAN_TXOPT_INDIRECT_ACK;
+            break;
+
+        default:
+            short_addr = COORD_SHORT_ADDR;
+            tx_options = WPAN_TXOPT_ACK;
+            break;
+    }
+
+    dst_addr.AddrMode = WPAN_ADDRMODE_SHORT;
+    dst_addr.PANId = DEFAULT_PAN_ID;
+    ADDR_COPY_DST_SRC_16(dst_addr.Addr.short_address, short_addr);
+
+    msdu[1] = (uint8_t)tx_seq[dst_index];
+    msdu[2] = (uint8_t)(tx_seq[dst_index] >> 8);
+
+    if (!measuring)
+    {
+        start_measurement();
+    }
+
+    pal_get_current_time(&requests[handle].time);
+
+    /*
+     * Use: bool wpan_mcps_data_req(uint8_t SrcAddrMode,
+     *                              wpan_addr_spec_t *DstAddrSpec,
+     *                              uint8_t msduLength,
+     *                              uint8_t *msdu,
+     *                              uint8_t msduHandle,
+     *                              uint8_t TxOptions);
+     *
+     * This request will cause a mcps data confirm message ->
+     * usr_mcps_data_conf
+     */
+    BENCH_CPU_CLOCK(&cpu_start);
+    accepted = wpan_mcps_data_req(WPAN_ADDRMODE_SHORT,
+                                  &dst_addr,
+                                  config.msdu_length,
+                                  msdu,
+                                  handle,
+                                  tx_options);
+    BENCH_CPU_CLOCK(&cpu_end);
+    result.mac_cpu_us += cpu_end - cpu_start;
+
+    if (!accepted)
+    {
+        return false;
+    }
+
+    requests[handle].used = true;
+    requests[handle].dst_index = dst_index;
+    outstanding++;
+    pending[dst_index]++;
+    tx_seq[dst_index]++;
+    result.requests++;
+
+    return true;
+}
+
+
+/**
+ * @brief Requests pending data from the coordinator
+ */
+static void poll_coordinator(void)
+{
+    wpan_addr_spec_t coord_addr;
+    uint16_t coord_short_addr = COORD_SHORT_ADDR;
+    uint32_t cpu_start;
+    uint32_t cpu_end;
+
+    coord_addr.AddrMode = WPAN_ADDRMODE_SHORT;
+    coord_addr.PANId = DEFAULT_PAN_ID;
+    ADDR_COPY_DST_SRC_16(coord_addr.Addr.short_address, coord_short_addr);
+
+    /*
+     * Use: bool wpan_mlme_poll_req(wpan_addr_spec_t *CoordAddrSpec);
+     *
+     * This request will cause a mlme poll confirm message ->
+     * usr_mlme_poll_conf
+     */
+    BENCH_CPU_CLOCK(&cpu_start);
+    polling = wpan_mlme_poll_req(&coord_addr);
+    BENCH_CPU_CLOCK(&cpu_end);
+
+    if (measuring)
+    {
+        result.mac_cpu_us += cpu_end - cpu_start;
+    }
+}
+
+
+/**
+ * @brief Starts the measurement with the first request or indication
+ */
+static void start_measurement(void)
+{
+    measuring = true;
+    pal_get_current_time(&start_time);
+}
+
+
+/**
+ * @brief Starts the traffic once the network is set up
+ */
+static void network_ready(void)
+{
+    if (state == BENCH_SETUP)
+    {
+        state = BENCH_RUNNING;
+    }
+}
+
+
+/**
+ * @brief Adds a confirm latency to the statistics
+ *
+ * @param latency Latency in us
+ */
+static void record_latency(uint32_t latency)
+{
+    uint16_t bin;
+
+    if (latency < (1UL << LATENCY_MIN_SHIFT))
+    {
+        bin = 0;
+    }
+    else
+    {
+        uint8_t msb = LATENCY_MIN_SHIFT;
+
+        while ((msb < 31) && ((latency >> (msb + 1)) != 0))
+        {
+            msb++;
+        }
+
+        bin = ((uint16_t)(msb - LATENCY_MIN_SHIFT) << LATENCY_SUB_BITS) |
+              ((latency >> (msb - LATENCY_SUB_BITS)) & ((1U << LATENCY_SUB_BITS) - 1));
+
+        if (bin >= LATENCY_BINS)
+        {
+            bin = LATENCY_BINS - 1;
+        }
+    }
+
+    if (latency_hist[bin] < UINT16_MAX)
+    {
+        latency_hist[bin]++;
+    }
+
+    if ((result.confirmed == 1) || (latency < result.latency_min))
+    {
+        result.latency_min = latency;
+    }
+    if (latency > result.latency_max)
+    {
+        result.latency_max = latency;
+    }
+    latency_sum += latency;
+}
+
+
+/**
+ * @brief Gets a percentile of the confirm latency (nearest rank)
+ *
+ * @param percent Percentile
+ *
+ * @return Upper bound of the histogram bin containing the percentile,
+ *         limited by the exact minimum and maximum
+ */
+static uint32_t latency_percentile(uint8_t percent)
+{
+    uint32_t rank = (result.confirmed * (uint32_t)percent + 99) / 100;
+    uint32_t count = 0;
+    uint16_t bin;
+
+    for (bin = 0; bin < LATENCY_BINS; bin++)
+    {
+        count += latency_hist[bin];
+
+        if (count >= rank)
+        {
+            uint8_t shift = (bin >> LATENCY_SUB_BITS) + LATENCY_MIN_SHIFT - LATENCY_SUB_BITS;
+            uint32_t upper = ((uint32_t)((1U << LATENCY_SUB_BITS) +
+                                         (bin & ((1U << LATENCY_SUB_BITS) - 1)) + 1) << shift) - 1;
+
+            if (upper > result.latency_max)
+            {
+                upper = result.latency_max;
+            }
+            if (upper < result.latency_min)
+            {
+                upper = result.latency_min;
+            }
+
+            return upper;
+        }
+    }
+
+    return result.latency_max;
+}
+
+
+/**
+ * @brief Callback function usr_mlme_reset_conf
+ *
+ * @param status Result of the reset procedure
+ */
+void usr_mlme_reset_conf(uint8_t status)
+{
+    if (state != BENCH_SETUP)
+    {
+        return;
+    }
+
+    if (status == MAC_SUCCESS)
+    {
+        /*
+         * Set the short address of this node; the PIB attributes are set one
+         * after the other by usr_mlme_set_conf.
+         * Use: bool wpan_mlme_set_req(uint8_t PIBAttribute,
+         *                             void *PIBAttributeValue);
+         *
+         * This request leads to a set confirm message -> usr_mlme_set_conf
+         */
+        uint16_t short_addr = COORD_SHORT_ADDR;
+
+        if (config.role == BENCH_DEVICE)
+        {
+            short_addr = config.device_index;
+        }
+        wpan_mlme_set_req(macShortAddress, &short_addr);
+    }
+    else
+    {
+        // something went wrong; restart
+        wpan_mlme_reset_req(true);
+    }
+}
+
+
+/**
+ * @brief Callback function usr_mlme_set_conf
+ *
+ * The coordinator starts the PAN once its receiver is switched on when
+ * idle. A device of a beacon-enabled PAN turns off macAutoRequest, so each
+ * beacon is indicated, and synchronizes with the coordinator; the other
+ * devices start right away.
+ *
+ * @param status        Result of requested PIB attribute set operation
+ * @param PIBAttribute  Updated PIB attribute
+ */
+void usr_mlme_set_conf(uint8_t status, uint8_t PIBAttribute)
+{
+    if (state != BENCH_SETUP)
+    {
+        return;
+    }
+
+    if (status != MAC_SUCCESS)
+    {
+        // something went wrong; restart
+        wpan_mlme_reset_req(true);
+        return;
+    }
+
+    switch (PIBAttribute)
+    {
+        case macShortAddress:
+            {
+                uint16_t pan_id = DEFAULT_PAN_ID;
+
+                wpan_mlme_set_req(macPANId, &pan_id);
+            }
+            break;
+
+        case macPANId:
+            if (config.role == BENCH_COORDINATOR)
+            {
+                bool rx_on_when_idle = true;
+
+                wpan_mlme_set_req(macRxOnWhenIdle, &rx_on_when_idle);
+            }
+            else
+            {
+                uint16_t coord_addr = COORD_SHORT_ADDR;
+
+                wpan_mlme_set_req(macCoordShortAddress, &coord_addr);
+            }
+            break;
+
+        case macCoordShortAddress:
+            {
+                uint8_t channel_page = DEFAULT_CHANNEL_PAGE;
+
+                wpan_mlme_set_req(phyCurrentPage, &channel_page);
+            }
+            break;
+
+        case phyCurrentPage:
+            {
+                uint8_t channel = DEFAULT_CHANNEL;
+
+                wpan_mlme_set_req(phyCurrentChannel, &channel);
+            }
+            break;
+
+        case phyCurrentChannel:
+            {
+                /* The devices only receive while polling or tracking beacons. */
+                bool rx_on_when_idle = false;
+
+                wpan_mlme_set_req(macRxOnWhenIdle, &rx_on_when_idle);
+            }
+            break;
+
+        case macRxOnWhenIdle:
+            if (config.role == BENCH_COORDINATOR)
+            {
+                uint8_t beacon_order = NON_BEACON_NWK;
+                uint8_t superframe_order = NON_BEACON_NWK;
+
+                if (config.traffic == BENCH_BEACON)
+                {
+                    beacon_order = config.beacon_order;
+                    superframe_order = config.superframe_order;
+                }
+
+                /*
+                 * Use: bool wpan_mlme_start_req(uint16_t PANId,
+                 *                               uint8_t LogicalChannel,
+                 *                               uint8_t ChannelPage,
+                 *                               uint8_t BeaconOrder,
+                 *                               uint8_t SuperframeOrder,
+                 *                               bool PANCoordinator,
+                 *                               bool BatteryLifeExtension,
+                 *                               bool CoordRealignment)
+                 *
+                 * This request leads to a start confirm message -> usr_mlme_start_conf
+                 */
+                wpan_mlme_start_req(DEFAULT_PAN_ID,
+                                    DEFAULT_CHANNEL,
+                                    DEFAULT_CHANNEL_PAGE,
+                                    beacon_order, superframe_order,
+                                    true, false, false);
+            }
+            else if (config.traffic == BENCH_BEACON)
+            {
+                bool auto_request = false;
+
+                wpan_mlme_set_req(macAutoRequest, &auto_request);
+            }
+            else
+            {
+                network_ready();
+            }
+            break;
+
+        case macAutoRequest:
+            wpan_mlme_set_req(macBeaconOrder, &config.beacon_order);
+            break;
+
+        case macBeaconOrder:
+            wpan_mlme_set_req(macSuperframeOrder, &config.superframe_order);
+            break;
+
+        case macSuperframeOrder:
+            /*
+             * Use: bool wpan_mlme_sync_req(uint8_t LogicalChannel,
+             *                              uint8_t ChannelPage,
+             *                              bool TrackBeacon);
+             *
+             * The first beacon leads to a beacon notify indication ->
+             * usr_mlme_beacon_notify_ind
+             */
+            state = BENCH_WAIT_SYNC;
+            wpan_mlme_sync_req(DEFAULT_CHANNEL, DEFAULT_CHANNEL_PAGE, true);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief Callback function usr_mlme_start_conf
+ *
+ * @param status Result of requested start operation
+ */
+void usr_mlme_start_conf(uint8_t status)
+{
+    if (state != BENCH_SETUP)
+    {
+        return;
+    }
+
+    if (status == MAC_SUCCESS)
+    {
+        network_ready();
+    }
+    else
+    {
+        // something went wrong; restart
+        wpan_mlme_reset_req(true);
+    }
+}
+
+
+/**
+ * @brief Callback function usr_mlme_beacon_notify_ind
+ *
+ * The first beacon starts the traffic of a device of a beacon-enabled PAN.
+ *
+ * @param BSN            Beacon sequence number.
+ * @param PANDescriptor  Pointer to PAN descriptor for received beacon.
+ * @param PendAddrSpec   Pending address specification in received beacon.
+ * @param AddrList       List of addresses of devices the coordinator has
+ *                       pending data.
+ * @param sduLength      Length of beacon payload.
+ * @param sdu            Pointer to beacon payload.
+ */
+void usr_mlme_beacon_notify_ind(uint8_t BSN,
+                                wpan_pandescriptor_t *PANDescriptor,
+                                uint8_t PendAddrSpec,
+                                uint8_t *AddrList,
+                                uint8_t sduLength,
+                                uint8_t *sdu)
+{
+    if (state == BENCH_WAIT_SYNC)
+    {
+        state = BENCH_RUNNING;
+    }
+
+    /* Keep compiler happy. */
+    BSN = BSN;
+    PANDescriptor = PANDescriptor;
+    PendAddrSpec = PendAddrSpec;
+    AddrList = AddrList;
+    sduLength = sduLength;
+    sdu = sdu;
+}
+
+
+/**
+ * @brief Callback function usr_mlme_sync_loss_ind
+ *
+ * The device counts the loss and synchronizes again.
+ *
+ * @param LossReason     Reason for synchronization loss.
+ * @param PANId          The PAN identifier with which the device lost
+ *                       synchronization or to which it was realigned.
+ * @param LogicalChannel The logical channel on which the device lost
+ *                       synchronization or to which it was realigned.
+ * @param ChannelPage    The channel page on which the device lost
+ *                       synchronization or to which it was realigned.
+ */
+void usr_mlme_sync_loss_ind(uint8_t LossReason,
+                            uint16_t PANId,
+                            uint8_t LogicalChannel,
+                            uint8_t ChannelPage)
+{
+    if ((state == BENCH_WAIT_SYNC) || (state == BENCH_RUNNING) ||
+        (state == BENCH_DRAINING))
+    {
+        result.sync_losses++;
+        wpan_mlme_sync_req(LogicalChannel, ChannelPage, true);
+    }
+
+    /* Keep compiler happy. */
+    LossReason = LossReason;
+    PANId = PANId;
+}
+
+
+/**
+ * @brief Callback function usr_mlme_poll_conf
+ *
+ * @param status Result of requested poll operation
+ */
+void usr_mlme_poll_conf(uint8_t status)
+{
+    polling = false;
+
+    if (measuring && (status == MAC_NO_DATA))
+    {
+        result.empty_polls++;
+    }
+}
+
+
+/**
+ * Callback function usr_mcps_data_conf
+ *
+ * @param msduHandle  Handle of MSDU handed over to MAC earlier
+ * @param status      Result for requested data transmission request
+ * @param Timestamp   The time, in microseconds, at which the data were
+ *                    transmitted (only if timestamping is enabled).
+ *
+ */
+#ifdef ENABLE_TSTAMP
+void usr_mcps_data_conf(uint8_t msduHandle, uint8_t status, uint32_t Timestamp)
+#else
+void usr_mcps_data_conf(uint8_t msduHandle, uint8_t status)
+#endif  /* ENABLE_TSTAMP */
+{
+    request_t *req;
+    uint32_t now;
+
+    if ((msduHandle >= BENCH_MAX_OUTSTANDING) || !requests[msduHandle].used)
+    {
+        return;
+    }
+
+    pal_get_current_time(&now);
+
+    req = &requests[msduHandle];
+    req->used = false;
+    outstanding--;
+    pending[req->dst_index]--;
+
+    switch (status)
+    {
+        case MAC_SUCCESS:
+            result.confirmed++;
+            record_latency(pal_sub_time_us(now, req->time));
+            break;
+
+        case MAC_NO_ACK:
+            result.no_ack++;
+            break;
+
+        case MAC_CHANNEL_ACCESS_FAILURE:
+            result.channel_access_failures++;
+            break;
+
+        default:
+            result.other_failures++;
+            break;
+    }
+
+#ifdef ENABLE_TSTAMP
+    /* Keep compiler happy. */
+    Timestamp = Timestamp;
+#endif  /* ENABLE_TSTAMP */
+}
+
+
+/**
+ * @brief Callback function usr_mcps_data_ind
+ *
+ * Counts the MSDUs of a receiver; the first one starts the measurement.
+ *
+ * @param SrcAddrSpec      Pointer to source address specification
+ * @param DstAddrSpec      Pointer to destination address specification
+ * @param msduLength       Number of octets contained in MSDU
+ * @param msdu_rx          Pointer to MSDU
+ * @param mpduLinkQuality  LQI measured during reception of the MPDU
+ * @param mpduRssi         Received signal strength in dBm (ENABLE_RSSI only)
+ * @param DSN              DSN of the received data frame.
+ * @param Timestamp        The time, in microseconds, at which the data were
+ *                         received (only if timestamping is enabled).
+ */
+void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
+                       wpan_addr_spec_t *DstAddrSpec,
+                       uint8_t msduLength,
+                       uint8_t *msdu_rx,
+                       uint8_t mpduLinkQuality,
+#ifdef ENABLE_RSSI
+                       int8_t mpduRssi,
+#endif  /* ENABLE_RSSI */
+#ifdef ENABLE_TSTAMP
+                       uint8_t DSN,
+                       uint32_t Timestamp)
+#else
+                       uint8_t DSN)
+#endif  /* ENABLE_TSTAMP */
+{
+    uint8_t src_index = COORD_INDEX;
+    uint16_t seq;
+
+    if ((state != BENCH_RUNNING) || bench_is_sender() ||
+        (msduLength < BENCH_MSDU_MIN_LEN) || (msdu_rx[0] != BENCH_MSDU_TYPE))
+    {
+        return;
+    }
+
+    if (config.role == BENCH_COORDINATOR)
+    {
+        uint16_t src_addr;
+
+        ADDR_COPY_DST_SRC_16(src_addr, SrcAddrSpec->Addr.short_address);
+        if ((SrcAddrSpec->AddrMode != WPAN_ADDRMODE_SHORT) ||
+            (src_addr == COORD_SHORT_ADDR) || (src_addr > BENCH_MAX_DEVICES))
+        {
+            return;
+        }
+        src_index = (uint8_t)src_addr;
+    }
+
+    if (!measuring)
+    {
+        start_measurement();
+    }
+
+    seq = (uint16_t)msdu_rx[1] | ((uint16_t)msdu_rx[2] << 8);
+
+    if (rx_seq_valid[src_index])
+    {
+        uint16_t gap = seq - rx_seq[src_index];
+
+        if (gap >= 0x8000)
+        {
+            /* Repeated after a lost acknowledgment */
+            result.duplicates++;
+            return;
+        }
+        result.lost += gap;
+    }
+
+    rx_seq[src_index] = seq + 1;
+    rx_seq_valid[src_index] = true;
+    result.indications++;
+    result.indicated_octets += msduLength;
+
+    /* Keep compiler happy. */
+    DstAddrSpec = DstAddrSpec;
+    mpduLinkQuality = mpduLinkQuality;
+#ifdef ENABLE_RSSI
+    mpduRssi = mpduRssi;
+#endif  /* ENABLE_RSSI */
+    DSN = DSN;
+#ifdef ENABLE_TSTAMP
+    Timestamp = Timestamp;
+#endif  /* ENABLE_TSTAMP */
+}
+
+/* EOF */
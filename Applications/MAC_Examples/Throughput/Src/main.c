@@ -0,0 +1,249 @@
+/**
+ * @file main.c
+ *
+ * @brief  MAC Example - Throughput
+ *
+ * This is the source code of the MAC example Throughput. It measures the
+ * MSDU rate, the goodput, the confirm latency and the CPU time of the MAC
+ * for direct, broadcast, indirect and beacon-enabled data traffic between a
+ * PAN coordinator and one or more devices; the benchmark is done by
+ * mac_bench.c.
+ *
+ * The role, the traffic mix and the number of the device are selected via
+ * the terminal; the other parameters of a run are set at compile time.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include "pal.h"
+#include "tal.h"
+#include "sio_handler.h"
+#include "mac_api.h"
+#include "app_config.h"
+#include "ieee_const.h"
+#include "mac_bench.h"
+
+/* === TYPES =============================================================== */
+
+
+/* === MACROS ============================================================== */
+
+/** Defines the MSDU length of a run. */
+#ifndef BENCH_MSDU_LENGTH
+#define BENCH_MSDU_LENGTH               (100)
+#endif
+/** Defines the number of data requests outstanding per destination. */
+#ifndef BENCH_WINDOW
+#define BENCH_WINDOW                    (2)
+#endif
+/** Defines the duration of a run in ms. */
+#ifndef BENCH_DURATION_MS
+#define BENCH_DURATION_MS               (10000)
+#endif
+/** Defines the beacon order of the beacon-enabled PAN. */
+#ifndef BENCH_BEACON_ORDER
+#define BENCH_BEACON_ORDER              (6)
+#endif
+/** Defines the superframe order of the beacon-enabled PAN. */
+#ifndef BENCH_SUPERFRAME_ORDER
+#define BENCH_SUPERFRAME_ORDER          (6)
+#endif
+
+#if (NO_OF_LEDS >= 3)
+#define LED_START                       (LED_0)
+#define LED_DATA                        (LED_1)
+#define LED_RESULT                      (LED_2)
+#elif (NO_OF_LEDS == 2)
+#define LED_START                       (LED_0)
+#define LED_DATA                        (LED_1)
+#define LED_RESULT                      (LED_1)
+#else
+#define LED_START                       (LED_0)
+#define LED_DATA                        (LED_0)
+#define LED_RESULT                      (LED_0)
+#endif
+
+/* === GLOBALS ============================================================= */
+
+/** Configuration of the runs */
+static bench_config_t config;
+
+/* === PROTOTYPES ========================================================== */
+
+static void configure_run(void);
+static uint8_t get_number(const char *prompt, uint8_t max);
+static void start_run(void);
+
+/* === IMPLEMENTATION ====================================================== */
+
+
+/**
+ * @brief Main function of the Throughput application
+ */
+int main(void)
+{
+    /* Initialize the MAC layer and its underlying layers, like PAL, TAL, BMM. */
+    if (wpan_init() != MAC_SUCCESS)
+    {
+        /*
+         * Stay here; we need a valid IEEE address.
+         * Check kit documentation how to create an IEEE address
+         * and to store it into the EEPROM.
+         */
+        pal_alert();
+    }
+
+    /* Initialize LEDs. */
+    pal_led_init();
+    pal_led(LED_START, LED_ON);         // indicating application is started
+    pal_led(LED_DATA, LED_OFF);         // indicating ongoing run
+    pal_led(LED_RESULT, LED_OFF);       // indicating completed run
+
+    /*
+     * The stack is initialized above, hence the global interrupts are enabled
+     * here.
+     */
+    pal_global_irq_enable();
+
+    /* Initialize the serial interface used for communication with terminal program. */
+    if (pal_sio_init(SIO_CHANNEL) != MAC_SUCCESS)
+    {
+        /* Something went wrong during initialization. */
+        pal_alert();
+    }
+
+#if ((!defined __ICCAVR__) && (!defined __ICCARM__))
+    fdevopen(_sio_putchar, _sio_getchar);
+#endif
+
+    configure_run();
+    start_run();
+
+    /* Main loop */
+    while (1)
+    {
+        bench_task();
+
+        if (sio_getchar_nowait() != -1)
+        {
+            /* Any key ends the current run. */
+            bench_stop();
+        }
+
+        if (bench_done())
+        {
+            pal_led(LED_DATA, LED_OFF);
+            pal_led(LED_RESULT, LED_ON);
+            bench_print_result();
+            printf("\r\nPress any key to start a new run.\r\n");
+            sio_getchar();
+            pal_led(LED_RESULT, LED_OFF);
+            start_run();
+        }
+    }
+}
+
+
+/**
+ * @brief Asks the user for the role, the traffic mix and the number of
+ *        the device
+ */
+static void configure_run(void)
+{
+    config.msdu_length = BENCH_MSDU_LENGTH;
+    config.window = BENCH_WINDOW;
+    config.duration_ms = BENCH_DURATION_MS;
+    config.beacon_order = BENCH_BEACON_ORDER;
+    config.superframe_order = BENCH_SUPERFRAME_ORDER;
+
+    while (1)
+    {
+        printf("\r\nThroughput: (C)oordinator or (D)evice? ");
+        switch (toupper(sio_getchar()))
+        {
+            case 'C':
+                config.role = BENCH_COORDINATOR;
+                break;
+
+            case 'D':
+                config.role = BENCH_DEVICE;
+                break;
+
+            default:
+                continue;
+        }
+        break;
+    }
+
+    printf("\r\nTraffic: (1) %s, (2) %s, (3) %s, (4) %s",
+           bench_traffic_name(BENCH_DIRECT), bench_traffic_name(BENCH_BROADCAST),
+           bench_traffic_name(BENCH_INDIRECT), bench_traffic_name(BENCH_BEACON));
+    config.traffic = (bench_traffic_t)(get_number("? ", BENCH_NUM_TRAFFIC) - 1);
+
+    if (config.role == BENCH_DEVICE)
+    {
+        config.device_index = get_number("\r\nNumber of this device", BENCH_MAX_DEVICES);
+    }
+    else if (config.traffic == BENCH_INDIRECT)
+    {
+        config.num_devices = get_number("\r\nNumber of devices", BENCH_MAX_DEVICES);
+    }
+}
+
+
+/**
+ * @brief Reads a single digit number from the terminal
+ *
+ * @param prompt Text printed before the range
+ * @param max Largest valid number
+ *
+ * @return Number in the range 1 .. max
+ */
+static uint8_t get_number(const char *prompt, uint8_t max)
+{
+    int input;
+
+    while (1)
+    {
+        printf("%s (1 .. %u) ", prompt, max);
+        input = sio_getchar() - '0';
+        if ((input >= 1) && (input <= max))
+        {
+            printf("%d\r\n", input);
+            return (uint8_t)input;
+        }
+    }
+}
+
+
+/**
+ * @brief Starts a new run
+ */
+static void start_run(void)
+{
+    if (!bench_start(&config))
+    {
+        printf("\r\nInvalid configuration\r\n");
+        pal_alert();
+    }
+
+    pal_led(LED_DATA, LED_ON);
+    printf("\r\nRunning %s traffic for %lu ms... Press any key to stop.\r\n",
+           bench_traffic_name(config.traffic), (unsigned long)config.duration_ms);
+}
+
+/* EOF */
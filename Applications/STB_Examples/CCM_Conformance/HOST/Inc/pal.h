@@ -0,0 +1,72 @@
+/**
+ * @file pal.h
+ *
+ * @brief Minimal PAL for building the STB on a host computer
+ *
+ * The STB and the software AES SAL only require the compiler abstraction,
+ * the flash access macros and the critical region handling of the PAL.
+ * This file provides these for a host build with GCC, so that the STB can
+ * be run without any target hardware. The compiler abstraction of the 32 bit
+ * MCUs (PAL_GENERIC_TYPE ARM7) is used, since it only depends on GCC.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_H
+#define PAL_H
+
+/* === Includes ============================================================ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pal_types.h"
+#include "app_config.h"
+
+#if (PAL_GENERIC_TYPE != ARM7)
+#error "The host PAL requires PAL_GENERIC_TYPE ARM7"
+#endif
+
+/* === Macros =============================================================== */
+
+/**
+ * Adds two time values
+ */
+#define ADD_TIME(a, b)                  ((a) + (b))
+
+/**
+ * Subtracts two time values
+ */
+#define SUB_TIME(a, b)                  ((a) - (b))
+
+/**
+ * A host build runs single threaded without interrupts, so no critical
+ * regions are required.
+ */
+#define ENTER_CRITICAL_REGION()
+#define LEAVE_CRITICAL_REGION()
+
+/**
+ * Assertions are not evaluated by the host build.
+ */
+#define ASSERT(expr)
+
+/* === Types =============================================================== */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+
+#endif  /* PAL_H */
+/* EOF */
@@ -0,0 +1,604 @@
+/**
+ * @file main.c
+ *
+ * @brief STB Example CCM* Conformance - host test of the STB
+ *
+ * This program runs the CCM* test vectors of IEEE 802.15.4-2006 Annex C
+ * and of the ZigBee Specification (2007) Annex C.6 through stb_ccm_secure()
+ * for all eight security levels, securing the plaintext frame and
+ * unsecuring the secured frame. Every vector whose security level contains
+ * a MIC is also unsecured with a corrupted MIC, which has to be rejected.
+ * Afterwards the throughput of stb_ccm_secure() is measured for all
+ * security levels and both directions.
+ *
+ * The program is built for the host using the software AES SAL, so that
+ * changes of the STB can be checked and measured without any hardware.
+ * It returns the number of failed checks.
+ *
+ * $Id$
+ *
+ *  @author
+ *      Atmel Corporation: http://www.atmel.com
+ *      Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include "tal.h"
+#include "stb.h"
+#include "ieee_const.h"
+#include "app_config.h"
+
+/* === TYPES =============================================================== */
+
+/*
+ * CCM* test vector
+ *
+ * The plaintext frame consists of the data to be authenticated (a) followed
+ * by the data to be encrypted (m); the secured frame consists of a, the
+ * encrypted data and the encrypted MIC.
+ */
+typedef struct ccm_vector_tag
+{
+    const char *name;
+    uint8_t sec_level;
+    uint8_t hdr_len;
+    uint8_t pld_len;
+    const uint8_t *nonce;
+    const uint8_t *plain;
+    const uint8_t *secured;
+} ccm_vector_t;
+
+/* === MACROS ============================================================== */
+
+/* Length of the nonce without the flags octet */
+#define NONCE_LEN                       (13)
+
+/* Length of the MAC header of the frames used for the throughput measurement */
+#define PERF_HDR_LEN                    (26)
+
+/* Length of the payload of the frames used for the throughput measurement */
+#define PERF_PLD_LEN                    (80)
+
+/* Default number of frames per security level and direction */
+#define PERF_DEFAULT_FRAMES             (20000UL)
+
+/* Number of security levels */
+#define NO_OF_SEC_LEVELS                (8)
+
+/* === GLOBALS ============================================================= */
+
+/* Key used by all test vectors */
+static uint8_t key[AES_KEYSIZE] =
+{
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF
+};
+
+/*
+ * The test vectors of IEEE 802.15.4-2006 C.2 and ZigBee C.6.1 are taken from
+ * the standards. The vectors named "C.2.2 data at level x" secure the frame of
+ * C.2.2 with the remaining security levels; the Security Control field and
+ * the nonce are changed accordingly, and for levels without encryption the
+ * payload is authenticated only.
+ */
+/* IEEE 802.15.4-2006 C.2.1 beacon */
+static const uint8_t c_2_1_nonce[] =
+{
+    0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x05, 0x02
+};
+
+static const uint8_t c_2_1_plain[] =
+{
+    0x08, 0xD0, 0x84, 0x21, 0x43, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x02, 0x05, 0x00,
+    0x00, 0x00, 0x55, 0xCF, 0x00, 0x00, 0x51, 0x52,
+    0x53, 0x54
+};
+
+static const uint8_t c_2_1_secured[] =
+{
+    0x08, 0xD0, 0x84, 0x21, 0x43, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x02, 0x05, 0x00,
+    0x00, 0x00, 0x55, 0xCF, 0x00, 0x00, 0x51, 0x52,
+    0x53, 0x54, 0x22, 0x3B, 0xC1, 0xEC, 0x84, 0x1A,
+    0xB5, 0x53
+};
+
+/* IEEE 802.15.4-2006 C.2.2 data */
+static const uint8_t c_2_2_nonce[] =
+{
+    0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x05, 0x04
+};
+
+static const uint8_t c_2_2_plain[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x04, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64
+};
+
+static const uint8_t c_2_2_secured[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x04, 0x05, 0x00,
+    0x00, 0x00, 0xD4, 0x3E, 0x02, 0x2B
+};
+
+/* IEEE 802.15.4-2006 C.2.3 command */
+static const uint8_t c_2_3_nonce[] =
+{
+    0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x05, 0x06
+};
+
+static const uint8_t c_2_3_plain[] =
+{
+    0x2B, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0xFF, 0xFF, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x48, 0xDE, 0xAC, 0x06,
+    0x05, 0x00, 0x00, 0x00, 0x01, 0xCE
+};
+
+static const uint8_t c_2_3_secured[] =
+{
+    0x2B, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0xFF, 0xFF, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x48, 0xDE, 0xAC, 0x06,
+    0x05, 0x00, 0x00, 0x00, 0x01, 0xD8, 0x4F, 0xDE,
+    0x52, 0x90, 0x61, 0xF9, 0xC6, 0xF1
+};
+
+/* ZigBee 2007 C.6.1 */
+static const uint8_t zb_c_6_1_nonce[] =
+{
+    0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0x03, 0x02, 0x01, 0x00, 0x06
+};
+
+static const uint8_t zb_c_6_1_plain[] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E
+};
+
+static const uint8_t zb_c_6_1_secured[] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x1A, 0x55, 0xA3, 0x6A, 0xBB, 0x6C, 0x61, 0x0D,
+    0x06, 0x6B, 0x33, 0x75, 0x64, 0x9C, 0xEF, 0x10,
+    0xD4, 0x66, 0x4E, 0xCA, 0xD8, 0x54, 0xA8, 0x0A,
+    0x89, 0x5C, 0xC1, 0xD8, 0xFF, 0x94, 0x69
+};
+
+/* C.2.2 data at level 0 */
+static const uint8_t c_2_2_l0_nonce[] =
+{
+    0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x05, 0x00
+};
+
+static const uint8_t c_2_2_l0_plain[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x00, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64
+};
+
+static const uint8_t c_2_2_l0_secured[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x00, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64
+};
+
+/* C.2.2 data at level 1 */
+static const uint8_t c_2_2_l1_nonce[] =
+{
+    0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x05, 0x01
+};
+
+static const uint8_t c_2_2_l1_plain[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64
+};
+
+static const uint8_t c_2_2_l1_secured[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64, 0xF0, 0x3F,
+    0x38, 0x43
+};
+
+/* C.2.2 data at level 2 */
+static const uint8_t c_2_2_l2_nonce[] =
+{
+    0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x05, 0x02
+};
+
+static const uint8_t c_2_2_l2_plain[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x02, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64
+};
+
+static const uint8_t c_2_2_l2_secured[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x02, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64, 0xAD, 0x29,
+    0xD6, 0x59, 0x27, 0x23, 0x03, 0x75
+};
+
+/* C.2.2 data at level 3 */
+static const uint8_t c_2_2_l3_nonce[] =
+{
+    0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x05, 0x03
+};
+
+static const uint8_t c_2_2_l3_plain[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x03, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64
+};
+
+static const uint8_t c_2_2_l3_secured[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x03, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64, 0x98, 0xBD,
+    0xDC, 0x1A, 0x26, 0x3B, 0x14, 0x79, 0xB4, 0x94,
+    0xB4, 0x8B, 0xC7, 0x84, 0x42, 0x32
+};
+
+/* C.2.2 data at level 5 */
+static const uint8_t c_2_2_l5_nonce[] =
+{
+    0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x05, 0x05
+};
+
+static const uint8_t c_2_2_l5_plain[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x05, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64
+};
+
+static const uint8_t c_2_2_l5_secured[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x05, 0x05, 0x00,
+    0x00, 0x00, 0x35, 0x66, 0xBD, 0x72, 0x1B, 0x0C,
+    0x6E, 0x27
+};
+
+/* C.2.2 data at level 7 */
+static const uint8_t c_2_2_l7_nonce[] =
+{
+    0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x05, 0x07
+};
+
+static const uint8_t c_2_2_l7_plain[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x07, 0x05, 0x00,
+    0x00, 0x00, 0x61, 0x62, 0x63, 0x64
+};
+
+static const uint8_t c_2_2_l7_secured[] =
+{
+    0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x48, 0xDE, 0xAC, 0x07, 0x05, 0x00,
+    0x00, 0x00, 0x4E, 0x8B, 0x60, 0xDA, 0x3D, 0x80,
+    0xEE, 0xBD, 0x89, 0x44, 0xCB, 0x78, 0x18, 0xEB,
+    0x3E, 0x5E, 0x08, 0x63, 0xF8, 0xE6
+};
+
+/* All test vectors */
+static const ccm_vector_t vectors[] =
+{
+    { "IEEE 802.15.4-2006 C.2.1 beacon", 2, 26, 0, c_2_1_nonce, c_2_1_plain, c_2_1_secured },
+    { "IEEE 802.15.4-2006 C.2.2 data", 4, 26, 4, c_2_2_nonce, c_2_2_plain, c_2_2_secured },
+    { "IEEE 802.15.4-2006 C.2.3 command", 6, 29, 1, c_2_3_nonce, c_2_3_plain, c_2_3_secured },
+    { "ZigBee 2007 C.6.1", 6, 8, 23, zb_c_6_1_nonce, zb_c_6_1_plain, zb_c_6_1_secured },
+    { "C.2.2 data at level 0", 0, 30, 0, c_2_2_l0_nonce, c_2_2_l0_plain, c_2_2_l0_secured },
+    { "C.2.2 data at level 1", 1, 30, 0, c_2_2_l1_nonce, c_2_2_l1_plain, c_2_2_l1_secured },
+    { "C.2.2 data at level 2", 2, 30, 0, c_2_2_l2_nonce, c_2_2_l2_plain, c_2_2_l2_secured },
+    { "C.2.2 data at level 3", 3, 30, 0, c_2_2_l3_nonce, c_2_2_l3_plain, c_2_2_l3_secured },
+    { "C.2.2 data at level 5", 5, 26, 4, c_2_2_l5_nonce, c_2_2_l5_plain, c_2_2_l5_secured },
+    { "C.2.2 data at level 7", 7, 26, 4, c_2_2_l7_nonce, c_2_2_l7_plain, c_2_2_l7_secured }
+};
+
+/* Number of failed checks */
+static unsigned int failures;
+
+/* === PROTOTYPES ========================================================== */
+
+static uint8_t mic_length(uint8_t sec_level);
+static void load_nonce(uint8_t nonce[AES_BLOCKSIZE], const uint8_t *src);
+static void check(const char *name, const char *step, bool passed);
+static void run_vector(const ccm_vector_t *vector);
+static double elapsed_seconds(const struct timespec *start);
+static void measure_throughput(uint8_t sec_level, unsigned long no_of_frames);
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Main function of the CCM* conformance test
+ *
+ * @param argc Number of arguments
+ * @param argv Optional number of frames per throughput measurement
+ *
+ * @return Number of failed checks
+ */
+int main(int argc, char *argv[])
+{
+    unsigned long no_of_frames = PERF_DEFAULT_FRAMES;
+    uint8_t i;
+
+    if (argc > 1)
+    {
+        no_of_frames = strtoul(argv[1], NULL, 0);
+    }
+
+    stb_init();
+
+    printf("CCM* conformance\n");
+    for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+    {
+        run_vector(&vectors[i]);
+    }
+
+    if (no_of_frames > 0)
+    {
+        printf("\nCCM* throughput, %u octets per frame, %lu frames\n",
+               PERF_HDR_LEN + PERF_PLD_LEN, no_of_frames);
+        printf("level  direction     frames/s       bytes/s\n");
+        for (i = 0; i < NO_OF_SEC_LEVELS; i++)
+        {
+            measure_throughput(i, no_of_frames);
+        }
+    }
+
+    printf("\n%u check(s) failed\n", failures);
+
+    return ((int)failures);
+}
+
+
+
+/**
+ * @brief Returns the MIC length of a security level
+ *
+ * @param sec_level Security level
+ *
+ * @return MIC length in octets
+ */
+static uint8_t mic_length(uint8_t sec_level)
+{
+    if (sec_level & 3)
+    {
+        return (1 << ((sec_level & 3) + 1));
+    }
+
+    return 0;
+}
+
+
+
+/**
+ * @brief Prepares the nonce for stb_ccm_secure()
+ *
+ * stb_ccm_secure() modifies the nonce, so it is rebuilt for each call.
+ *
+ * @param nonce Nonce passed to stb_ccm_secure()
+ * @param src Nonce of the test vector (13 octets)
+ */
+static void load_nonce(uint8_t nonce[AES_BLOCKSIZE], const uint8_t *src)
+{
+    memset(nonce, 0, AES_BLOCKSIZE);
+    memcpy(&nonce[1], src, NONCE_LEN);
+}
+
+
+
+/**
+ * @brief Reports the result of a single check
+ *
+ * @param name Name of the test vector
+ * @param step Name of the check
+ * @param passed True if the check has passed
+ */
+static void check(const char *name, const char *step, bool passed)
+{
+    if (!passed)
+    {
+        failures++;
+    }
+
+    printf("  %-36s %-10s %s\n", name, step, passed ? "OK" : "FAILED");
+}
+
+
+
+/**
+ * @brief Runs a single test vector in both directions
+ *
+ * @param vector Test vector
+ */
+static void run_vector(const ccm_vector_t *vector)
+{
+    uint8_t buffer[aMaxPHYPacketSize];
+    uint8_t nonce[AES_BLOCKSIZE];
+    uint8_t frame_len = vector->hdr_len + vector->pld_len;
+    uint8_t mic_len = mic_length(vector->sec_level);
+    stb_ccm_t status;
+
+    /* Secure the plaintext frame. */
+    memcpy(buffer, vector->plain, frame_len);
+    load_nonce(nonce, vector->nonce);
+    status = stb_ccm_secure(buffer, nonce, key, vector->hdr_len,
+                            vector->pld_len, vector->sec_level,
+                            AES_DIR_ENCRYPT);
+    check(vector->name, "secure",
+          (status == STB_CCM_OK) &&
+          !memcmp(buffer, vector->secured, frame_len + mic_len));
+
+    /* Unsecure the secured frame. */
+    memcpy(buffer, vector->secured, frame_len + mic_len);
+    load_nonce(nonce, vector->nonce);
+    status = stb_ccm_secure(buffer, nonce, key, vector->hdr_len,
+                            vector->pld_len, vector->sec_level,
+                            AES_DIR_DECRYPT);
+    check(vector->name, "unsecure",
+          (status == STB_CCM_OK) &&
+          !memcmp(buffer, vector->plain, frame_len));
+
+    /* A corrupted MIC has to be detected. */
+    if (mic_len > 0)
+    {
+        memcpy(buffer, vector->secured, frame_len + mic_len);
+        buffer[frame_len + mic_len - 1] ^= 0x01;
+        load_nonce(nonce, vector->nonce);
+        status = stb_ccm_secure(buffer, nonce, key, vector->hdr_len,
+                                vector->pld_len, vector->sec_level,
+                                AES_DIR_DECRYPT);
+        check(vector->name, "bad MIC", (status == STB_CCM_MICERR));
+    }
+}
+
+
+
+/**
+ * @brief Returns the time elapsed since a start time
+ *
+ * @param start Start time
+ *
+ * @return Elapsed time in seconds
+ */
+static double elapsed_seconds(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((double)(now.tv_sec - start->tv_sec) +
+            (double)(now.tv_nsec - start->tv_nsec) / 1e9);
+}
+
+
+
+/**
+ * @brief Measures the throughput of stb_ccm_secure() for a security level
+ *
+ * The payload of the frame is encrypted for security levels with encryption
+ * and authenticated as part of the header otherwise, as done by the MAC.
+ *
+ * @param sec_level Security level
+ * @param no_of_frames Number of frames per direction
+ */
+static void measure_throughput(uint8_t sec_level, unsigned long no_of_frames)
+{
+    uint8_t plain[PERF_HDR_LEN + PERF_PLD_LEN + AES_BLOCKSIZE];
+    uint8_t secured[PERF_HDR_LEN + PERF_PLD_LEN + AES_BLOCKSIZE];
+    uint8_t buffer[PERF_HDR_LEN + PERF_PLD_LEN + AES_BLOCKSIZE];
+    uint8_t nonce[AES_BLOCKSIZE];
+    uint8_t hdr_len;
+    uint8_t pld_len;
+    uint8_t i;
+    bool ok = true;
+
+    if (sec_level & 4)
+    {
+        hdr_len = PERF_HDR_LEN;
+        pld_len = PERF_PLD_LEN;
+    }
+    else
+    {
+        hdr_len = PERF_HDR_LEN + PERF_PLD_LEN;
+        pld_len = 0;
+    }
+
+    for (i = 0; i < sizeof(plain); i++)
+    {
+        plain[i] = i;
+    }
+
+    /* Secured frame used for the measurement of the unsecuring */
+    memcpy(secured, plain, sizeof(secured));
+    load_nonce(nonce, c_2_2_nonce);
+    stb_ccm_secure(secured, nonce, key, hdr_len, pld_len, sec_level,
+                   AES_DIR_ENCRYPT);
+
+    for (i = 0; i < 2; i++)
+    {
+        uint8_t dir = (i == 0) ? AES_DIR_ENCRYPT : AES_DIR_DECRYPT;
+        const uint8_t *src = (dir == AES_DIR_ENCRYPT) ? plain : secured;
+        struct timespec start;
+        unsigned long frame;
+        double seconds;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (frame = 0; frame < no_of_frames; frame++)
+        {
+            memcpy(buffer, src, sizeof(buffer));
+            load_nonce(nonce, c_2_2_nonce);
+            if (stb_ccm_secure(buffer, nonce, key, hdr_len, pld_len,
+                               sec_level, dir) != STB_CCM_OK)
+            {
+                ok = false;
+            }
+        }
+        seconds = elapsed_seconds(&start);
+
+        printf("%5u  %-9s %12.0f  %12.0f\n", sec_level,
+               (dir == AES_DIR_ENCRYPT) ? "secure" : "unsecure",
+               no_of_frames / seconds,
+               no_of_frames * (double)(PERF_HDR_LEN + PERF_PLD_LEN) / seconds);
+    }
+
+    if (!ok)
+    {
+        failures++;
+        printf("  stb_ccm_secure() failed during the measurement\n");
+    }
+}
+
+/* EOF */
@@ -0,0 +1,87 @@
+/**
+ * @file tal_loopback.h
+ *
+ * @brief Loopback TAL of the host test of the MAC security
+ *
+ * The loopback TAL implements the TAL API on the host computer without any
+ * air interface: every frame handed over by the MAC is confirmed as sent
+ * successfully and, while the loopback is enabled, handed back to the MAC
+ * as received frame. Frames addressed to the node itself thus pass the
+ * outgoing and the incoming frame security of the same MAC.
+ *
+ * The last frame sent is kept, so that it can be handed to the MAC again,
+ * e.g. to check the replay protection.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef TAL_LOOPBACK_H
+#define TAL_LOOPBACK_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* === Macros =============================================================== */
+
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Enables or disables the loopback of sent frames
+ *
+ * @param enable true if sent frames are handed back to the MAC
+ */
+void tal_loopback_enable(bool enable);
+
+/**
+ * @brief Gets the number of frames sent since the TAL has been initialized
+ *
+ * @return Number of frames handed over by the MAC
+ */
+uint16_t tal_loopback_tx_count(void);
+
+/**
+ * @brief Gets the last frame sent
+ *
+ * @return Pointer to the frame, starting with the length octet
+ */
+const uint8_t *tal_loopback_last_frame(void);
+
+/**
+ * @brief Hands a frame to the MAC as received frame
+ *
+ * The frame is indicated within the next call of tal_task().
+ *
+ * @param mpdu Frame starting with the length octet
+ *
+ * @return true if the frame is accepted
+ */
+bool tal_loopback_inject(const uint8_t *mpdu);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TAL_LOOPBACK_H */
+/* EOF */
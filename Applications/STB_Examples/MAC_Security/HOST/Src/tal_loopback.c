@@ -0,0 +1,377 @@
+/**
+ * @file tal_loopback.c
+ *
+ * @brief Loopback TAL of the host test of the MAC security
+ *
+ * Frames are not sent on any medium: tal_tx_frame() only copies the frame,
+ * and tal_task() confirms it and, with the loopback enabled, indicates the
+ * copy as received frame. Neither CSMA-CA nor acknowledgments are modelled,
+ * so the frames of the test are sent without acknowledgment request.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "return_val.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "tal_constants.h"
+#include "at86rf231.h"
+#include "bmm.h"
+#include "mac_msg_types.h"
+#include "app_config.h"
+#include "tal_loopback.h"
+
+/* === Macros ============================================================== */
+
+
+/* === Types =============================================================== */
+
+/**
+ * The received frames are stored behind the data indication built by the
+ * MAC in the same buffer; MCPS_DATA_IND_SIZE has to cover it.
+ */
+typedef char mcps_data_ind_size_check_t[(sizeof(mcps_data_ind_t) <= MCPS_DATA_IND_SIZE) ? 1 : -1];
+
+/* === Globals ============================================================= */
+
+/*
+ * TAL PIB attributes
+ */
+uint8_t tal_pib_CCAMode;
+uint8_t tal_pib_CurrentChannel;
+uint32_t tal_pib_SupportedChannels;
+uint64_t tal_pib_IeeeAddress;
+uint8_t tal_pib_MaxCSMABackoffs;
+uint8_t tal_pib_MinBE;
+uint16_t tal_pib_PANId;
+bool tal_pib_PrivatePanCoordinator;
+uint16_t tal_pib_ShortAddress;
+uint8_t tal_pib_TransmitPower;
+uint8_t tal_pib_CurrentPage;
+uint16_t tal_pib_MaxFrameDuration;
+uint8_t tal_pib_SHRDuration;
+uint8_t tal_pib_SymbolsPerOctet;
+uint8_t tal_pib_MaxBE;
+uint8_t tal_pib_MaxFrameRetries;
+
+/** Frame handed over by the MAC and not confirmed yet */
+static frame_info_t *tx_frame_pending;
+
+/** Last frame sent, starting with the length octet */
+static uint8_t last_frame[LENGTH_FIELD_LEN + aMaxPHYPacketSize];
+
+/** Frame to be indicated to the MAC */
+static uint8_t rx_frame[LENGTH_FIELD_LEN + aMaxPHYPacketSize];
+static bool rx_frame_pending;
+
+/** Sent frames are handed back to the MAC */
+static bool loopback_enabled;
+
+/** Number of frames sent */
+static uint16_t tx_count;
+
+/* === Prototypes ========================================================== */
+
+static void init_tal_pib(void);
+static void indicate_frame(const uint8_t *mpdu);
+
+/* === Implementation ====================================================== */
+
+/*
+ * TAL API
+ */
+
+retval_t tal_init(void)
+{
+    if (pal_init() != MAC_SUCCESS)
+    {
+        return FAILURE;
+    }
+
+    /* The IEEE address is read from the EEPROM like by the real TAL. */
+    pal_ps_get(INTERN_EEPROM, EE_IEEE_ADDR, 8, &tal_pib_IeeeAddress);
+    if ((tal_pib_IeeeAddress == 0x0000000000000000ULL) ||
+        (tal_pib_IeeeAddress == 0xFFFFFFFFFFFFFFFFULL))
+    {
+        return FAILURE;
+    }
+
+    init_tal_pib();
+    bmm_buffer_init();
+
+    tx_frame_pending = NULL;
+    rx_frame_pending = false;
+    loopback_enabled = true;
+    tx_count = 0;
+
+    return MAC_SUCCESS;
+}
+
+
+retval_t tal_reset(bool set_default_pib)
+{
+    /* A transmission is aborted without confirm. */
+    tx_frame_pending = NULL;
+    rx_frame_pending = false;
+
+    if (set_default_pib)
+    {
+        init_tal_pib();
+    }
+
+    return MAC_SUCCESS;
+}
+
+
+void tal_task(void)
+{
+    if (NULL != tx_frame_pending)
+    {
+        frame_info_t *frame = tx_frame_pending;
+
+        tx_frame_pending = NULL;
+        tal_tx_frame_done_cb(MAC_SUCCESS, frame);
+    }
+
+    if (rx_frame_pending)
+    {
+        rx_frame_pending = false;
+        indicate_frame(rx_frame);
+    }
+}
+
+
+retval_t tal_ed_start(uint8_t scan_duration)
+{
+    scan_duration = scan_duration;  /* Keep compiler happy. */
+
+    return TAL_BUSY;
+}
+
+
+retval_t tal_pib_set(uint8_t attribute, pib_value_t *value)
+{
+    switch (attribute)
+    {
+        case macMaxFrameRetries:
+            tal_pib_MaxFrameRetries = value->pib_value_8bit;
+            break;
+
+        case macMaxCSMABackoffs:
+            tal_pib_MaxCSMABackoffs = value->pib_value_8bit;
+            break;
+
+        case macMinBE:
+            tal_pib_MinBE = value->pib_value_8bit;
+            break;
+
+        case macMaxBE:
+            tal_pib_MaxBE = value->pib_value_8bit;
+            break;
+
+        case macPANId:
+            tal_pib_PANId = value->pib_value_16bit;
+            break;
+
+        case macShortAddress:
+            tal_pib_ShortAddress = value->pib_value_16bit;
+            break;
+
+        case phyCurrentChannel:
+            if (!((uint32_t)TRX_SUPPORTED_CHANNELS & ((uint32_t)0x01 << value->pib_value_8bit)))
+            {
+                return MAC_INVALID_PARAMETER;
+            }
+            tal_pib_CurrentChannel = value->pib_value_8bit;
+            break;
+
+        case phyCurrentPage:
+            if (value->pib_value_8bit != 0)
+            {
+                return MAC_INVALID_PARAMETER;
+            }
+            break;
+
+        case phyTransmitPower:
+            tal_pib_TransmitPower = value->pib_value_8bit;
+            break;
+
+        case phyCCAMode:
+            tal_pib_CCAMode = value->pib_value_8bit;
+            break;
+
+        case macIeeeAddress:
+            tal_pib_IeeeAddress = value->pib_value_64bit;
+            break;
+
+        case mac_i_pan_coordinator:
+            tal_pib_PrivatePanCoordinator = value->pib_value_bool;
+            break;
+
+        default:
+            return MAC_UNSUPPORTED_ATTRIBUTE;
+    }
+
+    return MAC_SUCCESS;
+}
+
+
+uint8_t tal_rx_enable(uint8_t state)
+{
+    if (NULL != tx_frame_pending)
+    {
+        return TAL_BUSY;
+    }
+
+    return ((state == PHY_TRX_OFF) ? PHY_TRX_OFF : PHY_RX_ON);
+}
+
+
+retval_t tal_tx_frame(frame_info_t *tx_frame, csma_mode_t csma_mode, bool perform_frame_retry)
+{
+    /* Keep compiler happy. */
+    csma_mode = csma_mode;
+    perform_frame_retry = perform_frame_retry;
+
+    if (NULL != tx_frame_pending)
+    {
+        return TAL_BUSY;
+    }
+
+    memcpy(last_frame, tx_frame->mpdu, tx_frame->mpdu[0] + LENGTH_FIELD_LEN);
+    tx_count++;
+    tx_frame_pending = tx_frame;
+
+    if (loopback_enabled)
+    {
+        tal_loopback_inject(last_frame);
+    }
+
+    return MAC_SUCCESS;
+}
+
+
+retval_t tal_trx_sleep(sleep_mode_t mode)
+{
+    mode = mode;    /* Keep compiler happy. */
+
+    return MAC_SUCCESS;
+}
+
+
+retval_t tal_trx_wakeup(void)
+{
+    return TAL_TRX_AWAKE;
+}
+
+
+/*
+ * Loopback API
+ */
+
+void tal_loopback_enable(bool enable)
+{
+    loopback_enabled = enable;
+}
+
+
+uint16_t tal_loopback_tx_count(void)
+{
+    return tx_count;
+}
+
+
+const uint8_t *tal_loopback_last_frame(void)
+{
+    return last_frame;
+}
+
+
+bool tal_loopback_inject(const uint8_t *mpdu)
+{
+    if (rx_frame_pending || (mpdu[0] > aMaxPHYPacketSize))
+    {
+        return false;
+    }
+
+    memcpy(rx_frame, mpdu, mpdu[0] + LENGTH_FIELD_LEN);
+    rx_frame_pending = true;
+
+    return true;
+}
+
+
+/*
+ * Internal functions
+ */
+
+/**
+ * @brief Initializes the TAL PIB with the defaults of the AT86RF231 TAL
+ */
+static void init_tal_pib(void)
+{
+    tal_pib_MaxCSMABackoffs = TAL_MAX_CSMA_BACKOFFS_DEFAULT;
+    tal_pib_MinBE = TAL_MINBE_DEFAULT;
+    tal_pib_PANId = TAL_PANID_BC_DEFAULT;
+    tal_pib_ShortAddress = TAL_SHORT_ADDRESS_DEFAULT;
+    tal_pib_CurrentChannel = TAL_CURRENT_CHANNEL_DEFAULT;
+    tal_pib_SupportedChannels = TRX_SUPPORTED_CHANNELS;
+    tal_pib_CurrentPage = TAL_CURRENT_PAGE_DEFAULT;
+    tal_pib_MaxFrameDuration = TAL_MAX_FRAME_DURATION_DEFAULT;
+    tal_pib_SHRDuration = TAL_SHR_DURATION_DEFAULT;
+    tal_pib_SymbolsPerOctet = TAL_SYMBOLS_PER_OCTET_DEFAULT;
+    tal_pib_MaxBE = TAL_MAXBE_DEFAULT;
+    tal_pib_MaxFrameRetries = TAL_MAXFRAMERETRIES_DEFAULT;
+    tal_pib_TransmitPower = TAL_TRANSMIT_POWER_DEFAULT;
+    tal_pib_CCAMode = TAL_CCA_MODE_DEFAULT;
+    tal_pib_PrivatePanCoordinator = TAL_PAN_COORDINATOR_DEFAULT;
+}
+
+
+/**
+ * @brief Indicates a frame to the MAC
+ *
+ * The frame is stored at the end of a large buffer like by the real TAL,
+ * followed by the LQI and the ED value.
+ *
+ * @param mpdu Frame starting with the length octet
+ */
+static void indicate_frame(const uint8_t *mpdu)
+{
+    buffer_t *buffer = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
+    frame_info_t *frame;
+    uint8_t *frame_ptr;
+    uint8_t len = mpdu[0];
+
+    if (NULL == buffer)
+    {
+        return;
+    }
+
+    frame = (frame_info_t *)BMM_BUFFER_POINTER(buffer);
+    frame_ptr = (uint8_t *)frame + LARGE_BUFFER_SIZE - (len + LENGTH_FIELD_LEN + LQI_LEN + ED_VAL_LEN);
+    memcpy(frame_ptr, mpdu, len + LENGTH_FIELD_LEN);
+    frame_ptr[len + LENGTH_FIELD_LEN] = 0xFF;           /* LQI */
+    frame_ptr[len + LENGTH_FIELD_LEN + LQI_LEN] = 0;    /* ED value */
+
+    frame->mpdu = frame_ptr;
+    frame->buffer_header = buffer;
+
+    tal_rx_frame_cb(frame);
+}
+
+/* EOF */
@@ -0,0 +1,82 @@
+/**
+ * @file
+ *
+ * @brief These are application-specific resources which are used
+ *        in the example application in addition to the
+ *        underlaying stack.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+/* === Includes ============================================================= */
+
+#include "stack_config.h"
+
+/* === Macros =============================================================== */
+
+/** @brief This is the first timer identifier of the application.
+ *
+ *  The value of this identifier is an increment of the largest identifier
+ *  value used by the MAC.
+ */
+#if (NUMBER_OF_TOTAL_STACK_TIMERS == 0)
+#define APP_FIRST_TIMER_ID          (0)
+#else
+#define APP_FIRST_TIMER_ID          (LAST_STACK_TIMER_ID + 1)
+#endif
+
+/** Defines the number of timers used by the application. */
+#define NUMBER_OF_APP_TIMERS        (0)
+
+/** Defines the total number of timers used by the application and the layers below. */
+#define TOTAL_NUMBER_OF_TIMERS      (NUMBER_OF_APP_TIMERS + NUMBER_OF_TOTAL_STACK_TIMERS)
+
+/**
+ * Defines the number of additional large buffers used by the application;
+ * the loopback TAL holds one for each frame it hands back to the MAC.
+ */
+#define NUMBER_OF_LARGE_APP_BUFS    (2)
+
+/** Defines the number of additional small buffers used by the application */
+#define NUMBER_OF_SMALL_APP_BUFS    (0)
+
+/**
+ *  Defines the total number of large buffers used by the application and the
+ *  layers below.
+ */
+#define TOTAL_NUMBER_OF_LARGE_BUFS  (NUMBER_OF_LARGE_APP_BUFS + NUMBER_OF_LARGE_STACK_BUFS)
+
+/**
+ *  Defines the total number of small buffers used by the application and the
+ *  layers below.
+ */
+#define TOTAL_NUMBER_OF_SMALL_BUFS  (NUMBER_OF_SMALL_APP_BUFS + NUMBER_OF_SMALL_STACK_BUFS)
+
+#define TOTAL_NUMBER_OF_BUFS        (TOTAL_NUMBER_OF_LARGE_BUFS + TOTAL_NUMBER_OF_SMALL_BUFS)
+
+/* Offset of IEEE address storage location within EEPROM */
+#define EE_IEEE_ADDR                (0)
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+
+#endif /* APP_CONFIG_H */
+/* EOF */
@@ -0,0 +1,555 @@
+/**
+ * @file main.c
+ *
+ * @brief STB Example MAC Security - host test of the MAC frame security
+ *
+ * This program runs the MAC with MAC_SECURITY_ZIP on a host computer on top
+ * of a loopback TAL, which hands every frame sent back to the MAC as
+ * received frame. Data frames addressed to the node itself thus pass the
+ * outgoing and the incoming frame security (mac_security.c) of the same
+ * MAC. The following is checked:
+ *
+ *  - round trip: a secured MCPS-DATA.request for every security level
+ *    leads to an MCPS-DATA.indication with the original MSDU and the
+ *    security parameters of the request, while the frame sent does not
+ *    contain the MSDU in plain text if it is encrypted,
+ *  - replay: a frame received again is not indicated, since its frame
+ *    counter is not newer than the last one accepted,
+ *  - unknown key: a request with a key index not in macKeyTable is
+ *    confirmed with MAC_UNAVAILABLE_KEY, and a frame secured with a key
+ *    not in macKeyTable is not indicated,
+ *  - size limit: a request whose MSDU does not fit into a frame together
+ *    with the Auxiliary Security Header and the MIC is rejected, and the
+ *    longest MSDU accepted does not corrupt the request.
+ *
+ * It returns the number of failed checks.
+ *
+ * $Id$
+ *
+ *  @author
+ *      Atmel Corporation: http://www.atmel.com
+ *      Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "pal.h"
+#include "tal.h"
+#include "mac_api.h"
+#include "ieee_const.h"
+#include "mac_security.h"
+#include "app_config.h"
+#include "tal_loopback.h"
+
+/* === TYPES =============================================================== */
+
+
+/* === MACROS ============================================================== */
+
+/* PAN Id and short address of the node */
+#define OWN_PAN_ID                      (0xCAFE)
+#define OWN_SHORT_ADDR                  (0x0001)
+
+/* Key index of the key in macKeyTable */
+#define KEY_INDEX                       (1)
+
+/* Key index not in macKeyTable */
+#define UNKNOWN_KEY_INDEX               (2)
+
+/* Security level with encryption and the longest MIC */
+#define SEC_LEVEL_ENC_MIC_128           (7)
+
+/* Length of the MSDU of the round trip and replay checks */
+#define MSDU_LEN                        (20)
+
+/*
+ * Length of the MHR of the data frames of the test: frame control, sequence
+ * number, destination PAN Id, destination and source short address
+ */
+#define MHR_LEN                         (9)
+
+/* Number of calls of wpan_task() processing a request completely */
+#define TASK_ROUNDS                     (20)
+
+/* Number of security levels */
+#define NO_OF_SEC_LEVELS                (8)
+
+/* === GLOBALS ============================================================= */
+
+/* Key used by the test */
+static uint8_t key[16] =
+{
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF
+};
+
+/* macDefaultKeySource used by the test */
+static uint8_t key_source[8] =
+{
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88
+};
+
+/* Number of failed checks */
+static unsigned failures;
+
+/* Last MLME-RESET.confirm and MLME-SET.confirm */
+static bool reset_confirmed;
+static uint8_t last_set_status;
+
+/* Last MCPS-DATA.confirm */
+static uint8_t conf_count;
+static uint8_t conf_handle;
+static uint8_t conf_status;
+
+/* Last MCPS-DATA.indication */
+static uint8_t ind_count;
+static uint8_t ind_msdu[aMaxMACPayloadSize];
+static uint8_t ind_msdu_len;
+static uint8_t ind_sec_level;
+static uint8_t ind_key_id_mode;
+static uint8_t ind_key_index;
+
+/* MSDU sent by the test */
+static uint8_t msdu[aMaxMACPayloadSize];
+
+/* === PROTOTYPES ========================================================== */
+
+static void check(const char *name, const char *step, bool passed);
+static void run_stack(void);
+static bool set_pib(uint8_t attribute, void *value);
+static bool setup_security(void);
+static bool send(uint8_t msdu_len, uint8_t handle, uint8_t sec_level, uint8_t key_index);
+static bool contains(const uint8_t *data, uint8_t data_len,
+                     const uint8_t *pattern, uint8_t pattern_len);
+static void test_round_trip(void);
+static void test_replay(void);
+static void test_unknown_key(void);
+static void test_size_limit(void);
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Main function of the MAC security test
+ */
+int main(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < sizeof(msdu); i++)
+    {
+        msdu[i] = (uint8_t)(0x30 + i);
+    }
+
+    if (wpan_init() != MAC_SUCCESS)
+    {
+        printf("wpan_init() failed\n");
+        return EXIT_FAILURE;
+    }
+
+    wpan_mlme_reset_req(true);
+    run_stack();
+
+    if (!reset_confirmed || !setup_security())
+    {
+        printf("Setup of the MAC failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("MAC security\n");
+    test_round_trip();
+    test_replay();
+    test_unknown_key();
+    test_size_limit();
+
+    printf("\n%u check(s) failed\n", failures);
+
+    return ((int)failures);
+}
+
+
+
+/**
+ * @brief Reports the result of a single check
+ *
+ * @param name Name of the test
+ * @param step Name of the check
+ * @param passed True if the check has passed
+ */
+static void check(const char *name, const char *step, bool passed)
+{
+    if (!passed)
+    {
+        failures++;
+    }
+
+    printf("  %-24s %-28s %s\n", name, step, passed ? "OK" : "FAILED");
+}
+
+
+
+/**
+ * @brief Lets the stack process all pending requests and frames
+ */
+static void run_stack(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < TASK_ROUNDS; i++)
+    {
+        wpan_task();
+    }
+}
+
+
+
+/**
+ * @brief Sets a PIB attribute of the MAC
+ *
+ * @param attribute PIB attribute
+ * @param value Value of the attribute
+ *
+ * @return true if the attribute has been set
+ */
+static bool set_pib(uint8_t attribute, void *value)
+{
+    last_set_status = FAILURE;
+    if (!wpan_mlme_set_req(attribute, value))
+    {
+        return false;
+    }
+    run_stack();
+
+    return (last_set_status == MAC_SUCCESS);
+}
+
+
+
+/**
+ * @brief Sets up the addresses and the security tables of the node
+ *
+ * The node is the only device of macDeviceTable, so that frames sent to
+ * itself are checked against its own incoming frame counter. The key of
+ * macKeyTable is found via macDefaultKeySource and KEY_INDEX (key
+ * identifier mode 1) and may be used by the node for data frames.
+ *
+ * @return true if all attributes have been set
+ */
+static bool setup_security(void)
+{
+    mac_key_table_t key_desc;
+    mac_dev_table_t device;
+    uint16_t pan_id = OWN_PAN_ID;
+    uint16_t short_addr = OWN_SHORT_ADDR;
+    uint8_t entries = 1;
+    bool enabled = true;
+
+    memset(&key_desc, 0, sizeof(key_desc));
+    memcpy(key_desc.KeyIdLookupList[0].LookupData, key_source, sizeof(key_source));
+    key_desc.KeyIdLookupList[0].LookupData[sizeof(key_source)] = KEY_INDEX;
+    key_desc.KeyIdLookupList[0].LookupDataSize = 0x01;
+    key_desc.KeyIdLookupListEntries = 1;
+    key_desc.KeyDeviceList[0].DeviceDescriptorHandle = 0;
+    key_desc.KeyDeviceListEntries = 1;
+    key_desc.KeyUsageList[0].Frametype = FCF_FRAMETYPE_DATA;
+    key_desc.KeyUsageListEntries = 1;
+    memcpy(key_desc.Key, key, sizeof(key));
+
+    memset(&device, 0, sizeof(device));
+    device.DeviceDescriptor[0].PANId = OWN_PAN_ID;
+    device.DeviceDescriptor[0].ShortAddress = OWN_SHORT_ADDR;
+    device.DeviceDescriptor[0].ExtAddress = tal_pib_IeeeAddress;
+    device.DeviceDescriptor[0].FrameCounter = 0;
+
+    return (set_pib(macPANId, &pan_id) &&
+            set_pib(macShortAddress, &short_addr) &&
+            set_pib(macDefaultKeySource, key_source) &&
+            set_pib(macKeyTable, &key_desc) &&
+            set_pib(macKeyTableEntries, &entries) &&
+            set_pib(macDeviceTable, &device) &&
+            set_pib(macDeviceTableEntries, &entries) &&
+            set_pib(macSecurityEnabled, &enabled));
+}
+
+
+
+/**
+ * @brief Sends a secured data frame to the node itself
+ *
+ * @param msdu_len Length of the MSDU
+ * @param handle MSDU handle
+ * @param sec_level Security level
+ * @param key_index Key index
+ *
+ * @return Return value of wpan_mcps_data_req()
+ */
+static bool send(uint8_t msdu_len, uint8_t handle, uint8_t sec_level, uint8_t key_index)
+{
+    wpan_addr_spec_t dst_addr;
+    bool accepted;
+
+    dst_addr.AddrMode = WPAN_ADDRMODE_SHORT;
+    dst_addr.PANId = OWN_PAN_ID;
+    dst_addr.Addr.long_address = 0;
+    dst_addr.Addr.short_address = OWN_SHORT_ADDR;
+
+    conf_count = 0;
+    ind_count = 0;
+
+    accepted = wpan_mcps_data_req(WPAN_ADDRMODE_SHORT, &dst_addr, msdu_len,
+                                  msdu, handle, WPAN_TXOPT_OFF, sec_level,
+                                  KEY_ID_MODE_1, key_index);
+    run_stack();
+
+    return accepted;
+}
+
+
+
+/**
+ * @brief Checks whether a sequence of octets contains a pattern
+ *
+ * @param data Octets searched
+ * @param data_len Number of octets searched
+ * @param pattern Pattern
+ * @param pattern_len Length of the pattern
+ *
+ * @return true if the pattern is found
+ */
+static bool contains(const uint8_t *data, uint8_t data_len,
+                     const uint8_t *pattern, uint8_t pattern_len)
+{
+    uint8_t i;
+
+    for (i = 0; (uint16_t)i + pattern_len <= data_len; i++)
+    {
+        if (!memcmp(&data[i], pattern, pattern_len))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+/**
+ * @brief Sends a frame with each security level to the node itself
+ */
+static void test_round_trip(void)
+{
+    char name[24];
+    uint8_t sec_level;
+
+    for (sec_level = 1; sec_level < NO_OF_SEC_LEVELS; sec_level++)
+    {
+        const uint8_t *frame;
+        bool accepted;
+
+        sprintf(name, "round trip level %u", sec_level);
+
+        accepted = send(MSDU_LEN, sec_level, sec_level, KEY_INDEX);
+        frame = tal_loopback_last_frame();
+
+        check(name, "confirm",
+              accepted && (conf_count == 1) && (conf_handle == sec_level) &&
+              (conf_status == MAC_SUCCESS));
+        check(name, "frame length",
+              frame[0] == (MHR_LEN + AUX_SEC_HDR_LEN + MSDU_LEN +
+                           MAC_SEC_MIC_LEN(sec_level) + FCS_LEN));
+        if (sec_level & MAC_SEC_ENC_FLAG)
+        {
+            check(name, "payload encrypted",
+                  !contains(&frame[1], frame[0], msdu, MSDU_LEN));
+        }
+        check(name, "indication",
+              (ind_count == 1) && (ind_msdu_len == MSDU_LEN) &&
+              !memcmp(ind_msdu, msdu, MSDU_LEN) &&
+              (ind_sec_level == sec_level) &&
+              (ind_key_id_mode == KEY_ID_MODE_1) &&
+              (ind_key_index == KEY_INDEX));
+    }
+}
+
+
+
+/**
+ * @brief Receives frames again that have been accepted before
+ */
+static void test_replay(void)
+{
+    uint8_t frame[LENGTH_FIELD_LEN + aMaxPHYPacketSize];
+    uint8_t stale[LENGTH_FIELD_LEN + aMaxPHYPacketSize];
+
+    /* The older one of two frames is not accepted after the newer one. */
+    send(MSDU_LEN, 0, SEC_LEVEL_ENC_MIC_128, KEY_INDEX);
+    memcpy(stale, tal_loopback_last_frame(), sizeof(stale));
+    send(MSDU_LEN, 1, SEC_LEVEL_ENC_MIC_128, KEY_INDEX);
+    memcpy(frame, tal_loopback_last_frame(), sizeof(frame));
+    check("replay", "fresh frame indicated", ind_count == 1);
+
+    ind_count = 0;
+    tal_loopback_inject(frame);
+    run_stack();
+    check("replay", "same frame dropped", ind_count == 0);
+
+    tal_loopback_inject(stale);
+    run_stack();
+    check("replay", "older frame dropped", ind_count == 0);
+
+    /* The next frame is accepted again. */
+    send(MSDU_LEN, 2, SEC_LEVEL_ENC_MIC_128, KEY_INDEX);
+    check("replay", "next frame indicated", ind_count == 1);
+}
+
+
+
+/**
+ * @brief Sends and receives frames with a key not in macKeyTable
+ */
+static void test_unknown_key(void)
+{
+    uint8_t frame[LENGTH_FIELD_LEN + aMaxPHYPacketSize];
+    uint16_t tx_count = tal_loopback_tx_count();
+    uint8_t entries;
+
+    /* Outgoing frame */
+    send(MSDU_LEN, 3, SEC_LEVEL_ENC_MIC_128, UNKNOWN_KEY_INDEX);
+    check("unknown key", "confirm",
+          (conf_count == 1) && (conf_handle == 3) &&
+          (conf_status == MAC_UNAVAILABLE_KEY));
+    check("unknown key", "nothing sent", tal_loopback_tx_count() == tx_count);
+
+    /* Incoming frame: sent with the key, received after removing it */
+    tal_loopback_enable(false);
+    send(MSDU_LEN, 4, SEC_LEVEL_ENC_MIC_128, KEY_INDEX);
+    memcpy(frame, tal_loopback_last_frame(), sizeof(frame));
+    tal_loopback_enable(true);
+
+    entries = 0;
+    set_pib(macKeyTableEntries, &entries);
+    ind_count = 0;
+    tal_loopback_inject(frame);
+    run_stack();
+    check("unknown key", "frame dropped", ind_count == 0);
+
+    /* The frame is accepted with the key, so only the key was missing. */
+    entries = 1;
+    set_pib(macKeyTableEntries, &entries);
+    tal_loopback_inject(frame);
+    run_stack();
+    check("unknown key", "frame indicated with key", ind_count == 1);
+}
+
+
+
+/**
+ * @brief Sends frames of the largest MSDU lengths with each security level
+ *
+ * The MSDU, the Auxiliary Security Header and the MIC together may not
+ * exceed aMaxMACPayloadSize; the longer MSDUs are rejected right away. The
+ * longest MSDU accepted does not fit into a frame with the MHR of the test
+ * and is confirmed with MAC_FRAME_TOO_LONG; the longest MSDU fitting into
+ * the frame is sent and received unchanged.
+ */
+static void test_size_limit(void)
+{
+    char name[24];
+    uint8_t sec_level;
+    uint8_t max_len;
+    uint8_t fit_len;
+    bool accepted;
+
+    /* The MSDU overlapping the request before the fix of the size check */
+    accepted = send(aMaxMACPayloadSize, 0, SEC_LEVEL_ENC_MIC_128, KEY_INDEX);
+    check("size limit", "aMaxMACPayloadSize rejected",
+          !accepted && (conf_count == 0));
+
+    for (sec_level = 1; sec_level < NO_OF_SEC_LEVELS; sec_level++)
+    {
+        sprintf(name, "size limit level %u", sec_level);
+
+        max_len = aMaxMACPayloadSize - AUX_SEC_HDR_LEN - MAC_SEC_MIC_LEN(sec_level);
+        fit_len = aMaxPHYPacketSize - MHR_LEN - AUX_SEC_HDR_LEN -
+                  MAC_SEC_MIC_LEN(sec_level) - FCS_LEN;
+
+        accepted = send(max_len + 1, 0x80 | sec_level, sec_level, KEY_INDEX);
+        check(name, "too long rejected", !accepted && (conf_count == 0));
+
+        accepted = send(max_len, 0x80 | sec_level, sec_level, KEY_INDEX);
+        check(name, "longest confirmed",
+              accepted && (conf_count == 1) &&
+              (conf_handle == (0x80 | sec_level)) &&
+              (conf_status == MAC_FRAME_TOO_LONG));
+
+        accepted = send(fit_len, 0x80 | sec_level, sec_level, KEY_INDEX);
+        check(name, "longest fitting round trip",
+              accepted && (conf_count == 1) &&
+              (conf_handle == (0x80 | sec_level)) &&
+              (conf_status == MAC_SUCCESS) &&
+              (ind_count == 1) && (ind_msdu_len == fit_len) &&
+              !memcmp(ind_msdu, msdu, fit_len));
+    }
+}
+
+
+
+/*
+ * Callbacks of the MAC
+ */
+
+void usr_mlme_reset_conf(uint8_t status)
+{
+    reset_confirmed = (status == MAC_SUCCESS);
+}
+
+
+void usr_mlme_set_conf(uint8_t status, uint8_t PIBAttribute)
+{
+    last_set_status = status;
+
+    PIBAttribute = PIBAttribute;    /* Keep compiler happy. */
+}
+
+
+void usr_mcps_data_conf(uint8_t msduHandle, uint8_t status)
+{
+    conf_count++;
+    conf_handle = msduHandle;
+    conf_status = status;
+}
+
+
+void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
+                       wpan_addr_spec_t *DstAddrSpec,
+                       uint8_t msduLength,
+                       uint8_t *msdu,
+                       uint8_t mpduLinkQuality,
+                       uint8_t DSN,
+                       uint8_t SecurityLevel,
+                       uint8_t KeyIdMode,
+                       uint8_t KeyIndex)
+{
+    ind_count++;
+    ind_msdu_len = msduLength;
+    memcpy(ind_msdu, msdu, msduLength);
+    ind_sec_level = SecurityLevel;
+    ind_key_id_mode = KeyIdMode;
+    ind_key_index = KeyIndex;
+
+    /* Keep compiler happy. */
+    SrcAddrSpec = SrcAddrSpec;
+    DstAddrSpec = DstAddrSpec;
+    mpduLinkQuality = mpduLinkQuality;
+    DSN = DSN;
+}
+
+/* EOF */
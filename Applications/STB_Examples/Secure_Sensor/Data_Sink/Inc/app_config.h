@@ -45,11 +45,13 @@ typedef enum
     /* App Timers start from APP_FIRST_TIMER_ID */
 
     /** Application timer id used to switch off LED */
-    TIMER_LED_OFF = (APP_FIRST_TIMER_ID)
+    TIMER_LED_OFF = (APP_FIRST_TIMER_ID),
+    /** Application timer id used to write the frame counters to the EEPROM */
+    TIMER_REPLAY_FLUSH
 } app_timer_t;
 
 /** Defines the number of timers used by the application. */
-#define NUMBER_OF_APP_TIMERS        (1)
+#define NUMBER_OF_APP_TIMERS        (2)
 
 /** Defines the total number of timers used by the application and the layers below. */
 #define TOTAL_NUMBER_OF_TIMERS      (NUMBER_OF_APP_TIMERS + NUMBER_OF_TOTAL_STACK_TIMERS)
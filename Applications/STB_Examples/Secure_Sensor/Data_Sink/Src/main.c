@@ -28,6 +28,7 @@
 #include "sio_handler.h"
 #include "tal.h"
 #include "stb.h"
+#include "stb_replay.h"
 #include "stb_app.h"
 #include "ieee_const.h"
 #include "mac_api.h"
@@ -79,6 +80,12 @@ associated_device_t;
 #endif
 /** Defines the scan duration time. */
 #define SCAN_DURATION_COORDINATOR       (1)
+/**
+ * Defines the interval of writing the frame counters to the EEPROM in
+ * microseconds; only changed octets are written, one write per sender and
+ * interval at most.
+ */
+#define REPLAY_FLUSH_INTERVAL           (600000000UL)
 
 #if (NO_OF_LEDS >= 3)
 #define LED_START                       (LED_0)
@@ -106,6 +113,7 @@ static void decrypt_frame(uint8_t msdu[AUX_HDR_LEN + PLD_LEN + AES_BLOCKSIZE],
 static bool assign_new_short_addr(uint64_t addr64, uint16_t *addr16);
 static void indicate_failed_sec(led_id_t led_no);
 static void led_off_cb(void *parameter);
+static void replay_flush_cb(void *parameter);
 
 /* === IMPLEMENTATION ====================================================== */
 
@@ -163,6 +171,16 @@ int main(void)
     /* Init Security Toolbox (incl. AES unit). */
     stb_init();
 
+    /* Init replay protection; frame counters stored before remain valid. */
+    stb_replay_init();
+
+    /* Write the frame counters accepted since to the EEPROM periodically. */
+    pal_timer_start(TIMER_REPLAY_FLUSH,
+                    REPLAY_FLUSH_INTERVAL,
+                    TIMEOUT_RELATIVE,
+                    (FUNC_PTR)replay_flush_cb,
+                    NULL);
+
     /* Main loop */
     while (1)
     {
@@ -470,7 +488,6 @@ static void decrypt_frame(uint8_t msdu[AUX_HDR_LEN + PLD_LEN + AES_BLOCKSIZE],
                           uint8_t msduLength)
 {
     static uint8_t *keyp = stb_app_key;
-    static uint32_t last_framecounter = 0;
     static uint8_t nonce[AES_BLOCKSIZE];
     uint32_t rcvd_framecounter;
     stb_ccm_t decrypt_status;
@@ -490,50 +507,30 @@ static void decrypt_frame(uint8_t msdu[AUX_HDR_LEN + PLD_LEN + AES_BLOCKSIZE],
     }
 
     /*
-     * Init fixed part of nonce during first call - with offset 1
-     * since the nonce is used as an AES block here,
+     * Init nonce - with offset 1 since the nonce is used as an AES block here,
      * not only the core 13 bytes mentioned in ZigBee standard.
+     * The source address is copied for each frame, since it identifies the
+     * sender for the replay protection.
      */
-    if (keyp != NULL)
-    {
-        /*
-         * Copy received IEEE source address from msdu to fixed part of nounce.
-         */
-        memcpy(nonce + 1, msdu + (MSDU_POS_SRC_ADDR - 1), sizeof(tal_pib_IeeeAddress));
-        nonce[1 + (NONCE_POS_SEC_CTRL - 1)] = sec_ctrl;
-    }
+    memcpy(nonce + 1, msdu + (MSDU_POS_SRC_ADDR - 1), sizeof(tal_pib_IeeeAddress));
+    nonce[1 + (NONCE_POS_SEC_CTRL - 1)] = sec_ctrl;
 
     /* Read received framecounter. */
     for (rcvd_framecounter = 0, i = FRM_COUNTER_LEN; i--; /*  */)
     {
-        rcvd_framecounter |= (msdu[FRM_COUNTER_LEN - i] << (i << 3));
+        rcvd_framecounter |= ((uint32_t)msdu[FRM_COUNTER_LEN - i] << (i << 3));
     }
 
-    if (rcvd_framecounter < last_framecounter)
-    {
-        sprintf(sio_array,
-                "Frame %" PRIu32 " received, expected at least %" PRIu32 "\n",
-                 rcvd_framecounter, last_framecounter);
-
-        sprintf(sio_array, "Device %" PRIu8 " associated\n", i + 1);
-        printf(sio_array);
-
-        indicate_failed_sec(LED_NWK_SETUP);
-    }
-
-    last_framecounter = rcvd_framecounter;
-
     /* Copy received framecounter to nonce. */
     memcpy(nonce + 1 + sizeof(tal_pib_IeeeAddress), msdu + 1, FRM_COUNTER_LEN);
 
-    /* Check MIC. */
-    decrypt_status = stb_ccm_secure(msdu,
-                                    nonce,
-                                    keyp,
-                                    AUX_HDR_LEN,
-                                    PLD_LEN,
-                                    SEC_LEVEL,
-                                    AES_DIR_DECRYPT);
+    /* Check framecounter and MIC. */
+    decrypt_status = stb_ccm_unsecure_fresh(msdu,
+                                            nonce,
+                                            keyp,
+                                            AUX_HDR_LEN,
+                                            PLD_LEN,
+                                            SEC_LEVEL);
 
     switch(decrypt_status)
     {
@@ -561,6 +558,12 @@ static void decrypt_frame(uint8_t msdu[AUX_HDR_LEN + PLD_LEN + AES_BLOCKSIZE],
             printf(sio_array);
             indicate_failed_sec(LED_DATA);
             break;
+
+        case STB_CCM_REPLAY:
+            sprintf(sio_array, "Frame %" PRIu32 ": stale frame counter\n", rcvd_framecounter);
+            printf(sio_array);
+            indicate_failed_sec(LED_NWK_SETUP);
+            break;
     }
 
     /*
@@ -616,6 +619,34 @@ static void led_off_cb(void *parameter)
 
 
 
+/**
+ * @brief Callback function writing the frame counters to the EEPROM
+ *
+ * The frame counters of the senders held in RAM are written to the EEPROM
+ * only when evicted, so they are written periodically, too; otherwise frames
+ * accepted since the last eviction could be replayed after a reset.
+ *
+ * @param parameter Pointer to callback parameter (not used)
+ */
+static void replay_flush_cb(void *parameter)
+{
+    /*
+     * Counters that cannot be written stay in RAM and are tried again
+     * with the next flush.
+     */
+    stb_replay_flush();
+
+    pal_timer_start(TIMER_REPLAY_FLUSH,
+                    REPLAY_FLUSH_INTERVAL,
+                    TIMEOUT_RELATIVE,
+                    (FUNC_PTR)replay_flush_cb,
+                    NULL);
+
+    parameter = parameter;  /* Keep compiler happy. */
+}
+
+
+
 /**
  * @brief Application specific function to assign a short address
  */
@@ -0,0 +1,747 @@
+/**
+ * @file perf_sweep.c
+ *
+ * @brief Host sweep tool of the Performance_Test automation mode
+ *
+ * Switches a transmitting node (and optionally a receiving node) running
+ * Performance_Test into the automation mode (see perf_protocol.h) and runs
+ * a transmit run for each combination of the given channel pages, channels,
+ * tx power values, frame lengths, CSMA settings and frame retries. One CSV
+ * line is printed per run:
+ *
+ * - the parameters of the run
+ * - the frame counts and the transmission attempts
+ * - the packet error rate (PER): frames not acknowledged (or not received,
+ *   if a receiving node is given and no ACK is requested) per frame
+ * - the goodput: MAC payload of the successful frames per test duration
+ * - the latency of the successful frames: min, mean, max and the
+ *   percentiles estimated from the histogram (upper edge of the bin)
+ * - the retry distribution and the latency histogram
+ * - the results of the receiving node
+ *
+ * Usage: perf_sweep [options] tx_device
+ *
+ * Lists are given comma separated, e.g. -l 20,60,127 -w 3,-5,-17.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include "perf_protocol.h"
+
+/* === MACROS ============================================================== */
+
+/** Maximum number of values of a parameter list */
+#define MAX_LIST_LEN                    (32)
+
+/** MAC header and FCS of the test frame (FRAME_OVERHEAD of main.c) */
+#define MAC_FRAME_OVERHEAD              (11)
+
+/** Number of attempts to switch a node to the automation mode */
+#define SYNC_ATTEMPTS                   (5)
+
+/** Time to wait for the answer of a command in ms */
+#define RSP_TIMEOUT_MS                  (1000)
+
+/** Status values, see return_val.h */
+#define STATUS_SUCCESS                  (0x00)
+
+/* === TYPES =============================================================== */
+
+typedef struct list_tag
+{
+    int value[MAX_LIST_LEN];
+    int count;
+} list_t;
+
+/** Serial connection to a node */
+typedef struct node_tag
+{
+    const char *name;
+    int fd;
+    /** Receiver of the response frames */
+    uint8_t msg[PERF_MSG_MAX_LEN + 2];
+    uint8_t index;
+    uint8_t length;
+    uint16_t crc;
+} node_t;
+
+/* === GLOBALS ============================================================= */
+
+static node_t tx_node;
+static node_t rx_node;
+static bool have_rx_node;
+
+/* === IMPLEMENTATION ====================================================== */
+
+static uint16_t crc_update(uint16_t crc, uint8_t data)
+{
+    int i;
+
+    crc ^= (uint16_t)data << 8;
+    for (i = 0; i < 8; i++)
+    {
+        if (crc & 0x8000)
+        {
+            crc = (crc << 1) ^ 0x1021;
+        }
+        else
+        {
+            crc <<= 1;
+        }
+    }
+
+    return crc;
+}
+
+
+
+static uint32_t get_32(const uint8_t *ptr)
+{
+    return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) |
+           ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+
+
+static int64_t now_ms(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return ((int64_t)tv.tv_sec * 1000) + (tv.tv_usec / 1000);
+}
+
+
+
+static bool open_node(node_t *node, const char *name, speed_t speed)
+{
+    struct termios tio;
+
+    node->name = name;
+    node->index = 0;
+    node->fd = open(name, O_RDWR | O_NOCTTY);
+    if (node->fd < 0)
+    {
+        fprintf(stderr, "%s: %s\n", name, strerror(errno));
+        return false;
+    }
+
+    /* Serial ports are switched to raw mode, other files are used as they are. */
+    if (tcgetattr(node->fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(node->fd, TCSANOW, &tio);
+        tcflush(node->fd, TCIOFLUSH);
+    }
+
+    return true;
+}
+
+
+
+static void send_cmd(node_t *node, uint8_t code, const uint8_t *params,
+                     uint8_t param_length)
+{
+    uint8_t frame[PERF_MSG_MAX_LEN + PERF_FRAME_OVERHEAD];
+    uint8_t length = param_length + 1;
+    uint16_t crc = PERF_CRC_INIT;
+    int i;
+
+    frame[0] = PERF_SOF;
+    frame[1] = length;
+    frame[2] = code;
+    if (param_length > 0)
+    {
+        memcpy(&frame[3], params, param_length);
+    }
+    for (i = 1; i <= (length + 1); i++)
+    {
+        crc = crc_update(crc, frame[i]);
+    }
+    frame[2 + length] = (uint8_t)crc;
+    frame[3 + length] = (uint8_t)(crc >> 8);
+
+    if (write(node->fd, frame, length + PERF_FRAME_OVERHEAD) != (length + PERF_FRAME_OVERHEAD))
+    {
+        fprintf(stderr, "%s: write failed\n", node->name);
+    }
+}
+
+
+
+/**
+ * @brief Passes a received octet to the frame receiver of a node
+ *
+ * @return true if a valid frame is stored in node->msg
+ */
+static bool rx_octet(node_t *node, uint8_t data)
+{
+    if (0 == node->index)
+    {
+        /* Search for the start of a frame; the menu output is skipped. */
+        if (PERF_SOF == data)
+        {
+            node->index = 1;
+            node->crc = PERF_CRC_INIT;
+        }
+        return false;
+    }
+
+    if (1 == node->index)
+    {
+        if ((0 == data) || (data > PERF_MSG_MAX_LEN))
+        {
+            node->index = (PERF_SOF == data) ? 1 : 0;
+            return false;
+        }
+        node->length = data;
+        node->crc = crc_update(node->crc, data);
+        node->index = 2;
+        return false;
+    }
+
+    node->msg[node->index - 2] = data;
+    if (node->index < (node->length + 2))
+    {
+        node->crc = crc_update(node->crc, data);
+    }
+    node->index++;
+
+    if (node->index < (node->length + PERF_FRAME_OVERHEAD))
+    {
+        return false;
+    }
+
+    node->index = 0;
+
+    return ((node->msg[node->length] | (node->msg[node->length + 1] << 8)) == node->crc);
+}
+
+
+
+/**
+ * @brief Waits for a response of a node
+ *
+ * Responses with other codes are discarded.
+ *
+ * @return true if the response has been received; it is stored in node->msg
+ */
+static bool wait_rsp(node_t *node, uint8_t code, int timeout_ms)
+{
+    int64_t end = now_ms() + timeout_ms;
+    int64_t left;
+    struct timeval tv;
+    fd_set fds;
+    uint8_t data;
+
+    while ((left = end - now_ms()) > 0)
+    {
+        FD_ZERO(&fds);
+        FD_SET(node->fd, &fds);
+        tv.tv_sec = left / 1000;
+        tv.tv_usec = (left % 1000) * 1000;
+        if (select(node->fd + 1, &fds, NULL, NULL, &tv) <= 0)
+        {
+            continue;
+        }
+        if (read(node->fd, &data, 1) != 1)
+        {
+            /* End of a file, or serial port without data */
+            usleep(1000);
+            continue;
+        }
+        if (rx_octet(node, data) && (node->msg[0] == code))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+/**
+ * @brief Sends a command and waits for its status
+ *
+ * @return Status of the command, or -1 if it has not been answered
+ */
+static int command(node_t *node, uint8_t code, const uint8_t *params,
+                   uint8_t param_length)
+{
+    int64_t end = now_ms() + RSP_TIMEOUT_MS;
+
+    send_cmd(node, code, params, param_length);
+    while (wait_rsp(node, PERF_RSP_STATUS, (int)(end - now_ms())))
+    {
+        if (node->msg[1] == code)
+        {
+            return node->msg[2];
+        }
+    }
+
+    fprintf(stderr, "%s: no answer to command 0x%02X\n", node->name, code);
+
+    return -1;
+}
+
+
+
+/**
+ * @brief Switches a node from the menu to the automation mode
+ */
+static bool sync_node(node_t *node)
+{
+    uint8_t sof = PERF_SOF;
+    int i;
+
+    for (i = 0; i < SYNC_ATTEMPTS; i++)
+    {
+        /*
+         * A single SOF leaves the menu (and the wait for the first key
+         * stroke after reset); the node searches for the next SOF.
+         */
+        if (write(node->fd, &sof, 1) != 1)
+        {
+            break;
+        }
+        usleep(200000);
+
+        send_cmd(node, PERF_CMD_HELLO, NULL, 0);
+        if (wait_rsp(node, PERF_RSP_HELLO, RSP_TIMEOUT_MS))
+        {
+            if (node->msg[1] != PERF_PROTOCOL_VERSION)
+            {
+                fprintf(stderr, "%s: protocol version %u not supported\n",
+                        node->name, node->msg[1]);
+                return false;
+            }
+            fprintf(stderr, "%s: TAL type 0x%02X, latency to %s\n", node->name,
+                    node->msg[2],
+                    (node->msg[3] & PERF_FEATURE_TSTAMP) ? "TAL time stamp" : "tx done callback");
+
+            /* Stop a run left by a previous session and drop its result. */
+            command(node, PERF_CMD_STOP, NULL, 0);
+            usleep(500000);
+            tcflush(node->fd, TCIFLUSH);
+            node->index = 0;
+            return true;
+        }
+    }
+
+    fprintf(stderr, "%s: node does not answer\n", node->name);
+
+    return false;
+}
+
+
+
+static bool parse_list(const char *arg, list_t *list)
+{
+    char *end;
+
+    list->count = 0;
+    while (*arg != '\0')
+    {
+        if (list->count >= MAX_LIST_LEN)
+        {
+            return false;
+        }
+        list->value[list->count++] = (int)strtol(arg, &end, 0);
+        if (end == arg)
+        {
+            return false;
+        }
+        if (*end == ',')
+        {
+            end++;
+        }
+        arg = end;
+    }
+
+    return (list->count > 0);
+}
+
+
+
+static void print_header(void)
+{
+    int i;
+
+    printf("page,channel,tx_power_dbm,psdu_length,csma,max_retries,ack,"
+           "frames,completed,success,no_ack,access_failures,failures,attempts,"
+           "duration_s,per,goodput_kbps,"
+           "lat_min_us,lat_mean_us,lat_p50_us,lat_p90_us,lat_p99_us,lat_max_us");
+    for (i = 0; i <= PERF_MAX_RETRIES; i++)
+    {
+        printf(",retry_%d", i);
+    }
+    for (i = 0; i < PERF_HIST_BINS; i++)
+    {
+        printf(",hist_%d", i);
+    }
+    printf(",rx_frames,rx_unique,rx_lqi,rx_ed,status\n");
+}
+
+
+
+/**
+ * @brief Estimates a percentile of the latency from the histogram
+ *
+ * @return Upper edge of the bin containing the percentile, limited to the maximum
+ */
+static uint32_t percentile(const uint32_t *hist, uint32_t count, uint32_t bin_us,
+                           uint32_t max, double p)
+{
+    uint64_t target = (uint64_t)(p * count + 0.999999);
+    uint64_t sum = 0;
+    uint32_t edge;
+    int i;
+
+    if (0 == count)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < (PERF_HIST_BINS - 1); i++)
+    {
+        sum += hist[i];
+        if (sum >= target)
+        {
+            edge = (uint32_t)(i + 1) * bin_us;
+            return (edge < max) ? edge : max;
+        }
+    }
+
+    return max;
+}
+
+
+
+/**
+ * @brief Prints the CSV line of a transmit run
+ */
+static void print_result(const uint8_t *res, const uint8_t *rx_res)
+{
+    const uint8_t *cfg = &res[1];
+    const uint8_t *ptr = &res[1 + PERF_CONFIG_LEN];
+    uint32_t bin_us = cfg[11] | (cfg[12] << 8);
+    uint32_t completed, success, no_ack, access_failure, failure, attempts;
+    uint32_t retries[PERF_MAX_RETRIES + 1];
+    uint32_t hist[PERF_HIST_BINS];
+    uint32_t lat_min, lat_mean, lat_max;
+    uint64_t duration_us;
+    double duration_s;
+    double per;
+    double goodput;
+    int i;
+
+    completed = get_32(ptr); ptr += 4;
+    success = get_32(ptr); ptr += 4;
+    no_ack = get_32(ptr); ptr += 4;
+    access_failure = get_32(ptr); ptr += 4;
+    failure = get_32(ptr); ptr += 4;
+    attempts = get_32(ptr); ptr += 4;
+    for (i = 0; i <= PERF_MAX_RETRIES; i++)
+    {
+        retries[i] = get_32(ptr);
+        ptr += 4;
+    }
+    duration_us = (uint64_t)get_32(ptr) | ((uint64_t)get_32(ptr + 4) << 32);
+    ptr += 8;
+    lat_min = get_32(ptr); ptr += 4;
+    lat_mean = get_32(ptr); ptr += 4;
+    lat_max = get_32(ptr); ptr += 4;
+    for (i = 0; i < PERF_HIST_BINS; i++)
+    {
+        hist[i] = get_32(ptr);
+        ptr += 4;
+    }
+
+    duration_s = (double)duration_us / 1000000;
+
+    /* Without ACK only the receiving node knows which frames got lost. */
+    per = 0;
+    if (completed > 0)
+    {
+        if ((0 == cfg[6]) && (rx_res != NULL))
+        {
+            uint32_t unique = get_32(&rx_res[5]);
+
+            per = (unique < completed) ? 1.0 - ((double)unique / completed) : 0.0;
+        }
+        else
+        {
+            per = 1.0 - ((double)success / completed);
+        }
+    }
+
+    goodput = 0;
+    if (duration_s > 0)
+    {
+        goodput = (double)success * (cfg[0] - MAC_FRAME_OVERHEAD) * 8 / duration_s / 1000;
+    }
+
+    printf("%u,%u,%d,%u,%u,%u,%u,", cfg[2], cfg[1], (int8_t)cfg[3], cfg[0],
+           cfg[4], cfg[5], cfg[6]);
+    printf("%u,%u,%u,%u,%u,%u,%u,", get_32(&cfg[7]), completed, success,
+           no_ack, access_failure, failure, attempts);
+    printf("%.6f,%.6f,%.3f,", duration_s, per, goodput);
+    printf("%u,%u,%u,%u,%u,%u", lat_min, lat_mean,
+           percentile(hist, success, bin_us, lat_max, 0.50),
+           percentile(hist, success, bin_us, lat_max, 0.90),
+           percentile(hist, success, bin_us, lat_max, 0.99),
+           lat_max);
+    for (i = 0; i <= PERF_MAX_RETRIES; i++)
+    {
+        printf(",%u", retries[i]);
+    }
+    for (i = 0; i < PERF_HIST_BINS; i++)
+    {
+        printf(",%u", hist[i]);
+    }
+    if (rx_res != NULL)
+    {
+        printf(",%u,%u,%u,%u", get_32(&rx_res[1]), get_32(&rx_res[5]),
+               rx_res[9], rx_res[10]);
+    }
+    else
+    {
+        printf(",,,,");
+    }
+    printf(",%s\n", (STATUS_SUCCESS == res[0]) ? "ok" : "stopped");
+    fflush(stdout);
+}
+
+
+
+/**
+ * @brief Performs one transmit run
+ *
+ * @return false if a node does not answer anymore
+ */
+static bool run(const uint8_t *cfg, int timeout_s)
+{
+    uint8_t rx_res[1 + PERF_RX_RESULT_LEN];
+    bool rx_ok = false;
+    int status;
+
+    status = command(&tx_node, PERF_CMD_CONFIG, cfg, PERF_CONFIG_LEN);
+    if (status != STATUS_SUCCESS)
+    {
+        fprintf(stderr, "page %u channel %u power %d length %u: config rejected (0x%02X)\n",
+                cfg[2], cfg[1], (int8_t)cfg[3], cfg[0], status & 0xFF);
+        return (status >= 0);
+    }
+
+    if (have_rx_node)
+    {
+        if ((command(&rx_node, PERF_CMD_CONFIG, cfg, PERF_CONFIG_LEN) != STATUS_SUCCESS) ||
+            (command(&rx_node, PERF_CMD_RX_START, NULL, 0) != STATUS_SUCCESS))
+        {
+            fprintf(stderr, "%s: receive run not started\n", rx_node.name);
+            return false;
+        }
+    }
+
+    if (command(&tx_node, PERF_CMD_TX_START, NULL, 0) != STATUS_SUCCESS)
+    {
+        return false;
+    }
+
+    if (!wait_rsp(&tx_node, PERF_RSP_TX_RESULT, timeout_s * 1000))
+    {
+        /* Stop the run; the result of the completed frames follows. */
+        fprintf(stderr, "%s: run timed out\n", tx_node.name);
+        send_cmd(&tx_node, PERF_CMD_STOP, NULL, 0);
+        if (!wait_rsp(&tx_node, PERF_RSP_TX_RESULT, RSP_TIMEOUT_MS))
+        {
+            return false;
+        }
+    }
+
+    if (have_rx_node)
+    {
+        send_cmd(&rx_node, PERF_CMD_STOP, NULL, 0);
+        if (wait_rsp(&rx_node, PERF_RSP_RX_RESULT, RSP_TIMEOUT_MS))
+        {
+            memcpy(rx_res, rx_node.msg, sizeof(rx_res));
+            rx_ok = true;
+        }
+        else
+        {
+            fprintf(stderr, "%s: no receive result\n", rx_node.name);
+        }
+    }
+
+    print_result(&tx_node.msg[1], rx_ok ? rx_res : NULL);
+
+    return true;
+}
+
+
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [options] tx_device\n"
+                    "  -r dev   receiving node, counts the received frames\n"
+                    "  -B baud  baud rate of the serial ports (default 9600)\n"
+                    "  -p list  channel pages (default 0)\n"
+                    "  -c list  channels (default 20)\n"
+                    "  -w list  tx power in dBm (default 3)\n"
+                    "  -l list  PSDU length incl. FCS, %d ... 127 (default 127)\n"
+                    "  -m list  CSMA off/on: 0, 1 (default 1)\n"
+                    "  -f list  maximum frame retries 0 ... %d (default 3)\n"
+                    "  -a 0|1   request ACK (default 1)\n"
+                    "  -n num   frames per run (default 1000)\n"
+                    "  -b us    width of a latency histogram bin (default %d)\n"
+                    "  -t s     timeout of a run (default 600)\n",
+            name, MAC_FRAME_OVERHEAD, PERF_MAX_RETRIES, PERF_HIST_DEFAULT_BIN_US);
+    exit(1);
+}
+
+
+
+static speed_t baud_to_speed(long baud)
+{
+    switch (baud)
+    {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        default: return B0;
+    }
+}
+
+
+
+int main(int argc, char **argv)
+{
+    list_t pages = { { 0 }, 1 };
+    list_t channels = { { 20 }, 1 };
+    list_t powers = { { 3 }, 1 };
+    list_t lengths = { { 127 }, 1 };
+    list_t csma = { { 1 }, 1 };
+    list_t retries = { { 3 }, 1 };
+    const char *rx_name = NULL;
+    speed_t speed = B9600;
+    uint32_t frames = 1000;
+    uint16_t bin_us = PERF_HIST_DEFAULT_BIN_US;
+    int ack = 1;
+    int timeout_s = 600;
+    uint8_t cfg[PERF_CONFIG_LEN];
+    int ip, ic, iw, il, im, ir;
+    bool ok = true;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:B:p:c:w:l:m:f:a:n:b:t:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r': rx_name = optarg; break;
+            case 'B':
+                speed = baud_to_speed(strtol(optarg, NULL, 0));
+                if (B0 == speed)
+                {
+                    usage(argv[0]);
+                }
+                break;
+            case 'p': if (!parse_list(optarg, &pages)) usage(argv[0]); break;
+            case 'c': if (!parse_list(optarg, &channels)) usage(argv[0]); break;
+            case 'w': if (!parse_list(optarg, &powers)) usage(argv[0]); break;
+            case 'l': if (!parse_list(optarg, &lengths)) usage(argv[0]); break;
+            case 'm': if (!parse_list(optarg, &csma)) usage(argv[0]); break;
+            case 'f': if (!parse_list(optarg, &retries)) usage(argv[0]); break;
+            case 'a': ack = (int)strtol(optarg, NULL, 0); break;
+            case 'n': frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': bin_us = (uint16_t)strtoul(optarg, NULL, 0); break;
+            case 't': timeout_s = (int)strtol(optarg, NULL, 0); break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if ((optind != (argc - 1)) || (0 == frames) || (0 == bin_us))
+    {
+        usage(argv[0]);
+    }
+
+    if (!open_node(&tx_node, argv[optind], speed) || !sync_node(&tx_node))
+    {
+        return 1;
+    }
+    if (rx_name != NULL)
+    {
+        if (!open_node(&rx_node, rx_name, speed) || !sync_node(&rx_node))
+        {
+            return 1;
+        }
+        have_rx_node = true;
+    }
+
+    print_header();
+
+    for (ip = 0; ok && (ip < pages.count); ip++)
+    for (ic = 0; ok && (ic < channels.count); ic++)
+    for (iw = 0; ok && (iw < powers.count); iw++)
+    for (il = 0; ok && (il < lengths.count); il++)
+    for (im = 0; ok && (im < csma.count); im++)
+    for (ir = 0; ok && (ir < retries.count); ir++)
+    {
+        cfg[0] = (uint8_t)lengths.value[il];
+        cfg[1] = (uint8_t)channels.value[ic];
+        cfg[2] = (uint8_t)pages.value[ip];
+        cfg[3] = (uint8_t)(int8_t)powers.value[iw];
+        cfg[4] = (uint8_t)csma.value[im];
+        cfg[5] = (uint8_t)retries.value[ir];
+        cfg[6] = (uint8_t)ack;
+        cfg[7] = (uint8_t)frames;
+        cfg[8] = (uint8_t)(frames >> 8);
+        cfg[9] = (uint8_t)(frames >> 16);
+        cfg[10] = (uint8_t)(frames >> 24);
+        cfg[11] = (uint8_t)bin_us;
+        cfg[12] = (uint8_t)(bin_us >> 8);
+
+        ok = run(cfg, timeout_s);
+    }
+
+    /* Return the nodes to the interactive menu. */
+    command(&tx_node, PERF_CMD_EXIT, NULL, 0);
+    if (have_rx_node)
+    {
+        command(&rx_node, PERF_CMD_EXIT, NULL, 0);
+    }
+
+    return ok ? 0 : 1;
+}
+
+/* EOF */
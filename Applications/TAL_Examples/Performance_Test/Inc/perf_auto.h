@@ -0,0 +1,90 @@
+/**
+ * @file perf_auto.h
+ *
+ * @brief Automation mode of the Performance_Test application
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PERF_AUTO_H
+#define PERF_AUTO_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tal.h"
+#include "perf_protocol.h"
+
+/* === Macros =============================================================== */
+
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Enters the automation mode
+ *
+ * Called by the menu once it received PERF_SOF; the SOF is taken as start
+ * of the first command frame.
+ *
+ * @param sio_unit Serial interface of the commands and responses
+ */
+void perf_auto_enter(uint8_t sio_unit);
+
+/**
+ * @brief Handles the commands and the transmit run of the automation mode
+ *
+ * @return false if the host requested the return to the interactive menu
+ */
+bool perf_auto_task(void);
+
+/**
+ * @brief Counts a frame of the transmit run; called by tal_tx_frame_done_cb()
+ *
+ * @param status Status of the transmission
+ * @param frame Transmitted frame
+ */
+void perf_auto_tx_done(retval_t status, frame_info_t *frame);
+
+/**
+ * @brief Counts a frame of the receive run; called by tal_rx_frame_cb()
+ *
+ * @param frame Received frame; the buffer is freed by the caller
+ */
+void perf_auto_rx_frame(frame_info_t *frame);
+
+/**
+ * @brief Rebuilds the test frame; implemented by main.c
+ *
+ * @param psdu_length Length of the PSDU incl. FCS
+ * @param ack true if an ACK shall be requested
+ *
+ * @return Test frame, or NULL if the length is not supported
+ */
+frame_info_t *perf_app_configure_frame(uint8_t psdu_length, bool ack);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PERF_AUTO_H */
+/* EOF */
@@ -0,0 +1,88 @@
+/**
+ * @file perf_ping.h
+ *
+ * @brief Ping-pong latency test of the Performance_Test application
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PERF_PING_H
+#define PERF_PING_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tal.h"
+#include "ping_pong.h"
+
+/* === Macros =============================================================== */
+
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts the ping-pong latency test via the TAL
+ *
+ * @param role Role of this node
+ * @param pings Number of pings sent by the initiator
+ * @param frame Test frame, reused for the pings and pongs
+ * @param header_length Length of the MAC header of the test frame
+ *
+ * @return true if the test frame is long enough for a ping
+ */
+bool perf_ping_start(ping_role_t role, uint16_t pings,
+                     frame_info_t *frame, uint8_t header_length);
+
+/**
+ * @brief Stops the test once the current transmission is completed
+ */
+void perf_ping_stop(void);
+
+/**
+ * @brief Sends the pings of the initiator
+ *
+ * @return false once the test is completed and the result is printed
+ */
+bool perf_ping_task(void);
+
+/**
+ * @brief Handles the end of a transmission; called by tal_tx_frame_done_cb()
+ *
+ * @param status Status of the transmission
+ * @param frame Transmitted frame
+ */
+void perf_ping_tx_done(retval_t status, frame_info_t *frame);
+
+/**
+ * @brief Handles a received frame; called by tal_rx_frame_cb()
+ *
+ * @param frame Received frame; the buffer is freed by the caller
+ */
+void perf_ping_rx_frame(frame_info_t *frame);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PERF_PING_H */
+/* EOF */
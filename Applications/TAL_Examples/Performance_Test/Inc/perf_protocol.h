@@ -0,0 +1,170 @@
+/**
+ * @file perf_protocol.h
+ *
+ * @brief Binary command protocol of the Performance_Test automation mode
+ *
+ * This file is shared by the firmware and the host sweep tool. It defines
+ * the framing of the messages, the command and response codes and the
+ * layout of their parameters.
+ *
+ * Each message is sent as a frame:
+ *
+ *     SOF | LEN | CODE | PARAMETERS | CRC
+ *
+ * - SOF is the start of frame delimiter PERF_SOF. It is no ASCII character,
+ *   so the first SOF received by the interactive menu switches the
+ *   application to the automation mode; the text output of the menu is
+ *   ignored by the host.
+ * - LEN is the number of octets of CODE and PARAMETERS (1 ... PERF_MSG_MAX_LEN).
+ * - CRC is the CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of
+ *   LEN ... PARAMETERS, low byte first.
+ *
+ * A frame with wrong CRC or invalid length is discarded and the receiver
+ * searches for the next SOF. All parameters with more than one octet are
+ * little endian.
+ *
+ * Each command is answered by PERF_RSP_STATUS, except for PERF_CMD_HELLO
+ * and PERF_CMD_RESULT. The status of PERF_CMD_CONFIG is that of the first
+ * parameter the TAL rejected, e.g. MAC_INVALID_PARAMETER for a channel page
+ * not supported by the build. The end of a transmit run is reported by the
+ * unsolicited PERF_RSP_TX_RESULT, the end of a receive run (PERF_CMD_STOP)
+ * by PERF_RSP_RX_RESULT.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PERF_PROTOCOL_H
+#define PERF_PROTOCOL_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+
+/* === Macros =============================================================== */
+
+/** Start of frame delimiter */
+#define PERF_SOF                        (0xA5)
+
+/** Version of the protocol, reported by PERF_RSP_HELLO */
+#define PERF_PROTOCOL_VERSION           (1)
+
+/**
+ * Maximum number of octets of CODE and PARAMETERS of a message; less than
+ * PERF_SOF, so a SOF is never taken as LEN.
+ */
+#define PERF_MSG_MAX_LEN                (160)
+
+/** Number of octets of a frame in addition to the message: SOF, LEN, CRC */
+#define PERF_FRAME_OVERHEAD             (4)
+
+/** Initial value of the CRC */
+#define PERF_CRC_INIT                   (0xFFFF)
+
+/** Maximum number of frame retries of a transmit run */
+#define PERF_MAX_RETRIES                (7)
+
+/** Number of bins of the latency histogram; the last bin collects all larger values */
+#define PERF_HIST_BINS                  (16)
+
+/** Default width of a histogram bin in us */
+#define PERF_HIST_DEFAULT_BIN_US        (500)
+
+/*
+ * Commands sent by the host
+ */
+
+/** Identify the device, answered by PERF_RSP_HELLO: - */
+#define PERF_CMD_HELLO                  (0x01)
+/**
+ * Set the test parameters: PSDU length (1), channel (1), channel page (1),
+ * tx power in dBm (1, signed), CSMA (1), maximum frame retries (1),
+ * ACK request (1), number of frames (4), histogram bin width in us (2)
+ */
+#define PERF_CMD_CONFIG                 (0x02)
+/** Start a transmit run: - */
+#define PERF_CMD_TX_START               (0x03)
+/** Start a receive run: - */
+#define PERF_CMD_RX_START               (0x04)
+/** Stop the current run: - */
+#define PERF_CMD_STOP                   (0x05)
+/** Repeat the result of the last transmit run: - */
+#define PERF_CMD_RESULT                 (0x06)
+/** Return to the interactive menu: - */
+#define PERF_CMD_EXIT                   (0x07)
+
+/** Length of the parameters of PERF_CMD_CONFIG */
+#define PERF_CONFIG_LEN                 (13)
+
+/*
+ * Responses sent by the device
+ */
+
+/**
+ * Answer to PERF_CMD_HELLO: protocol version (1), TAL type (1),
+ * features (1, PERF_FEATURE_*), histogram bins (1), maximum frame retries (1)
+ */
+#define PERF_RSP_HELLO                  (0x81)
+/** Answer to a command: command code (1), status (1, retval_t) */
+#define PERF_RSP_STATUS                 (0x82)
+/**
+ * Result of a transmit run:
+ * - status (1): MAC_SUCCESS, or FAILURE if the run was stopped
+ * - parameters of the run (PERF_CONFIG_LEN), see PERF_CMD_CONFIG
+ * - frames completed (4), frames transmitted successfully (4),
+ *   frames w/o ACK (4), channel access failures (4), other failures (4)
+ * - transmission attempts (4)
+ * - retry distribution (4 * (PERF_MAX_RETRIES + 1)): number of successful
+ *   frames which needed 0 ... PERF_MAX_RETRIES retries
+ * - duration of the run in us (8)
+ * - latency of the successful frames in us: min (4), mean (4), max (4)
+ * - latency histogram (4 * PERF_HIST_BINS)
+ */
+#define PERF_RSP_TX_RESULT              (0x83)
+/**
+ * Result of a receive run: frames received (4), frames with new sequence
+ * number (4), mean LQI (1), mean ED value (1)
+ */
+#define PERF_RSP_RX_RESULT              (0x84)
+
+/** Length of the parameters of PERF_RSP_TX_RESULT */
+#define PERF_TX_RESULT_LEN              (1 + PERF_CONFIG_LEN + 24 + \
+                                         (4 * (PERF_MAX_RETRIES + 1)) + 8 + 12 + \
+                                         (4 * PERF_HIST_BINS))
+
+/** Length of the parameters of PERF_RSP_RX_RESULT */
+#define PERF_RX_RESULT_LEN              (10)
+
+/*
+ * Features reported by PERF_RSP_HELLO
+ */
+
+/** Latency measured to the TAL time stamp of the frame (ENABLE_TSTAMP) */
+#define PERF_FEATURE_TSTAMP             (0x01)
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PERF_PROTOCOL_H */
+/* EOF */
@@ -26,10 +26,13 @@
 #include "pal.h"
 #include "tal.h"
 #include "tfa.h"
+#include "tal_rate_adapt.h"
 #include "app_config.h"
 #include "ieee_const.h"
 #include "bmm.h"
 #include "sio_handler.h"
+#include "perf_auto.h"
+#include "perf_ping.h"
 #if (TAL_TYPE == AT86RF230A)
 #include "phy230_registermap.h" // included for legacy reasons
 #endif
@@ -43,7 +46,10 @@ typedef enum op_mode_tag
     RX_OP_MODE,
     TX_OP_MODE,
     PROMISCUOUS_OP_MODE,
-    CONTINOUS_TX_MODE
+    CONTINOUS_TX_MODE,
+    ED_SURVEY_OP_MODE,
+    AUTOMATION_OP_MODE,
+    PING_OP_MODE
 } op_mode_t;
 
 /* === MACROS ============================================================== */
@@ -62,12 +68,22 @@ typedef enum op_mode_tag
 /* Frame overhead due to selected address scheme incl. FCS */
 #if (DST_PAN_ID == SRC_PAN_ID)
 #define FRAME_OVERHEAD          (11)
+#define PL_POS_SRC_ADDR_START   (PL_POS_DST_ADDR_START + 2)
 #else
 #define FRAME_OVERHEAD          (13)
+#define PL_POS_SRC_ADDR_START   (PL_POS_DST_ADDR_START + 4)
 #endif
 
+/* Position of the first payload octet; it announces the next page. */
+#define PL_POS_NEXT_PAGE        (FRAME_OVERHEAD - FCS_LEN + 1)
+
 #define DEFAULT_SCAN_DURATION   8
 
+/* Normalized ED value above which a channel is regarded as busy */
+#define ED_SURVEY_THRESHOLD     (0x40)
+/* Number of channel visits between two survey reports */
+#define ED_SURVEY_REPORT_VISITS (256)
+
 /* === GLOBALS ============================================================= */
 
 static bool transmitting = false;
@@ -93,9 +109,13 @@ static uint8_t channel_before_scan;
 static uint32_t scan_channel_mask;
 static bool scanning = false;
 static uint8_t scan_duration;
+static uint16_t ed_survey_visits;
 #ifdef ANTENNA_DIVERSITY
 static bool antenna_diversity = true;
 #endif
+#ifdef ENABLE_RATE_ADAPTATION
+static bool rate_adaptation = false;
+#endif
 
 /* === PROTOTYPES ========================================================== */
 
@@ -114,7 +134,10 @@ static void toggle_ack_request(void);
 static void toggle_csma_enabled(void);
 static void toggle_retry_enabled(void);
 static void start_ed_scan(void);
+static void start_ed_survey(void);
+static void print_ed_survey(void);
 static void get_sensor_data(void);
+static void start_ping_test(void);
 #if ((TAL_TYPE != AT86RF230B) || ((TAL_TYPE == AT86RF230B) && (defined CW_SUPPORTED)))
 static void start_cw_transmission(void);
 static void pulse_cw_transmission(void);
@@ -123,6 +146,9 @@ static void stop_pulse_cb(void *callback_parameter);
 #ifdef ANTENNA_DIVERSITY
 static void toogle_antenna_diversity(void);
 #endif
+#ifdef ENABLE_RATE_ADAPTATION
+static void toggle_rate_adaptation(void);
+#endif
 
 /* === IMPLEMENTATION ====================================================== */
 
@@ -169,6 +195,10 @@ int main(void)
     /* Configure the TAL PIBs; e.g. set short address */
     configure_pibs();
 
+#ifdef ENABLE_RATE_ADAPTATION
+    tal_rate_adapt_init();
+#endif
+
     /* Configure the frame sending; e.g. set short address */
     configure_frame_sending();
 
@@ -194,6 +224,27 @@ static void app_task(void)
     {
         if (!transmitting)
         {
+#ifdef ENABLE_RATE_ADAPTATION
+            if (rate_adaptation)
+            {
+                retval_t status = tal_rate_adapt_set_page(DST_SHORT_ADDR);
+
+                if (status == TAL_BUSY)
+                {
+                    /* Retry with the next call of app_task(). */
+                    return;
+                }
+                else if (status != MAC_SUCCESS)
+                {
+                    printf("\r\nPage not supported on this channel; rate adaptation disabled.");
+                    rate_adaptation = false;
+                }
+                else
+                {
+                    tx_frame_info->mpdu[PL_POS_NEXT_PAGE] = tal_rate_adapt_next_page(DST_SHORT_ADDR);
+                }
+            }
+#endif
             transmitting = true;
             tx_frame_info->mpdu[PL_POS_SEQ_NUM]++;
             if (csma_enabled)
@@ -208,6 +259,12 @@ static void app_task(void)
     }
     else if (receiving)
     {
+#ifdef ENABLE_RATE_ADAPTATION
+        if (rate_adaptation)
+        {
+            tal_rate_adapt_rx_task();
+        }
+#endif
         /* While receiving wait for any key to stop receiving. */
         if (sio_getchar_nowait() != -1)
         {
@@ -231,6 +288,49 @@ static void app_task(void)
     {
         /* While CW transmission wait for any key to stop transmitting. */
     }
+    else if (op_mode == ED_SURVEY_OP_MODE)
+    {
+        /* Survey one channel per loop; any key stops the survey. */
+        if (sio_getchar_nowait() != -1)
+        {
+            tfa_ed_survey_stop();
+            op_mode = OFF_OP_MODE;
+            print_ed_survey();
+            printf("\r\nPress any key to return to main menu.");
+            sio_getchar();
+        }
+        else if (tfa_ed_survey_task(false) == MAC_SUCCESS)
+        {
+            ed_survey_visits++;
+            if (ed_survey_visits >= ED_SURVEY_REPORT_VISITS)
+            {
+                ed_survey_visits = 0;
+                print_ed_survey();
+            }
+        }
+    }
+    else if (op_mode == AUTOMATION_OP_MODE)
+    {
+        /* Controlled by the host until it requests the menu again. */
+        if (!perf_auto_task())
+        {
+            op_mode = OFF_OP_MODE;
+        }
+    }
+    else if (op_mode == PING_OP_MODE)
+    {
+        /* Any key stops the test after the current transmission. */
+        if (sio_getchar_nowait() != -1)
+        {
+            perf_ping_stop();
+        }
+        if (!perf_ping_task())
+        {
+            op_mode = OFF_OP_MODE;
+            printf("\r\nPress any key to return to main menu.");
+            sio_getchar();
+        }
+    }
     else
     {
         if (scanning == false)
@@ -252,6 +352,20 @@ void tal_rx_frame_cb(frame_info_t *frame)
     /* First extract LQI. */
     aver_lqi += frame->mpdu[frame->mpdu[0] + LQI_LEN];
 
+#ifdef ENABLE_RATE_ADAPTATION
+    if (rate_adaptation && (frame->mpdu[0] >= FRAME_OVERHEAD))
+    {
+        tal_rate_adapt_rx_update(convert_byte_array_to_16_bit(&frame->mpdu[PL_POS_SRC_ADDR_START]),
+                                 frame->mpdu[frame->mpdu[0] + LQI_LEN],
+                                 frame->mpdu[frame->mpdu[0] + LQI_LEN + ED_VAL_LEN]);
+        /* Listen on the page announced by the sender of a test frame. */
+        if ((op_mode == RX_OP_MODE) && (frame->mpdu[0] > FRAME_OVERHEAD))
+        {
+            tal_rate_adapt_rx_page(frame->mpdu[PL_POS_NEXT_PAGE]);
+        }
+    }
+#endif
+
     if (op_mode == PROMISCUOUS_OP_MODE)
     {
         uint8_t i;
@@ -265,6 +379,14 @@ void tal_rx_frame_cb(frame_info_t *frame)
         }
         printf("\r\n");
     }
+    else if (op_mode == AUTOMATION_OP_MODE)
+    {
+        perf_auto_rx_frame(frame);
+    }
+    else if (op_mode == PING_OP_MODE)
+    {
+        perf_ping_rx_frame(frame);
+    }
 
     /* free buffer that was used for frame reception */
     bmm_buffer_free((buffer_t *)(frame->buffer_header));
@@ -279,6 +401,24 @@ void tal_rx_frame_cb(frame_info_t *frame)
  */
 void tal_tx_frame_done_cb(retval_t status, frame_info_t *frame)
 {
+#ifdef ENABLE_RATE_ADAPTATION
+    if (rate_adaptation)
+    {
+        tal_rate_adapt_tx_update(DST_SHORT_ADDR, status);
+    }
+#endif
+
+    if (op_mode == AUTOMATION_OP_MODE)
+    {
+        perf_auto_tx_done(status, frame);
+        return;
+    }
+    else if (op_mode == PING_OP_MODE)
+    {
+        perf_ping_tx_done(status, frame);
+        return;
+    }
+
     if (status == MAC_SUCCESS)
     {
         frame_successful++;
@@ -459,6 +599,19 @@ static void print_main_menu(void)
         printf("false\r\n");
     }
 
+#ifdef ENABLE_RATE_ADAPTATION
+    /* Print rate adaptation settings */
+    printf("(H) : Rate adaptation enabled = ");
+    if (rate_adaptation == true)
+    {
+        printf("true\r\n");
+    }
+    else
+    {
+        printf("false\r\n");
+    }
+#endif
+
     /* Print operation mode settings */
     printf("(T/R/O/I) : Operating mode Tx/Rx/Off/PromIscuous = ");
     switch (op_mode)
@@ -471,6 +624,7 @@ static void print_main_menu(void)
     }
     printf("\r\n");
     printf("(E) : Energy scan on all channels\r\n");
+    printf("(X) : Continuous energy survey on all channels\r\n");
 #if ((TAL_TYPE != AT86RF230B) || ((TAL_TYPE == AT86RF230B) && (defined CW_SUPPORTED)))
     printf("(U) : Continuous transmission on current channel\r\n");
     printf("(D) : Transmit a continuous wave pulse on current channel\r\n");
@@ -491,6 +645,7 @@ static void print_main_menu(void)
 #else
     printf("(V) : Get sensor data, i.e. supply voltage\r\n");
 #endif
+    printf("(G) : Ping-pong latency test\r\n");
     printf("(S) : Start test\r\n");
     printf(">");
 
@@ -509,6 +664,9 @@ static void print_main_menu(void)
         case 'A': toggle_ack_request(); break;
         case 'M': toggle_csma_enabled(); break;
         case 'F': toggle_retry_enabled(); break;
+#ifdef ENABLE_RATE_ADAPTATION
+        case 'H': toggle_rate_adaptation(); break;
+#endif
 
         case 'T':
             op_mode = TX_OP_MODE;
@@ -541,6 +699,10 @@ static void print_main_menu(void)
             start_ed_scan();
             break;
 
+        case 'X':
+            start_ed_survey();
+            break;
+
 #if ((TAL_TYPE != AT86RF230B) || ((TAL_TYPE == AT86RF230B) && (defined CW_SUPPORTED)))
         case 'U':
             start_cw_transmission();
@@ -560,9 +722,20 @@ static void print_main_menu(void)
             get_sensor_data();
             break;
 
+        case 'G':
+            start_ping_test();
+            break;
+
         case 'S':
             start_test();
             break;
+
+        case PERF_SOF:
+            /* Start of a command frame of the host sweep tool */
+            tal_rx_enable(PHY_TRX_OFF);
+            perf_auto_enter(SIO_CHANNEL);
+            op_mode = AUTOMATION_OP_MODE;
+            break;
     }
 }
 
@@ -666,6 +839,30 @@ static void configure_frame_sending(void)
 
 
 
+/**
+ * @brief Rebuilds the test frame for the automation mode
+ *
+ * @param psdu_length Length of the PSDU incl. FCS
+ * @param ack true if an ACK shall be requested
+ *
+ * @return Test frame, or NULL if the length is not supported
+ */
+frame_info_t *perf_app_configure_frame(uint8_t psdu_length, bool ack)
+{
+    if ((psdu_length < FRAME_OVERHEAD) || (psdu_length > aMaxPHYPacketSize))
+    {
+        return NULL;
+    }
+
+    phy_frame_length = psdu_length;
+    ack_request = ack;
+    configure_frame_sending();
+
+    return tx_frame_info;
+}
+
+
+
 /**
  * @brief Start the test procedure
  */
@@ -675,6 +872,14 @@ static void start_test(void)
     {
         printf("\r\nTransmitting... Wait until test is completed.");
 
+#ifdef ENABLE_RATE_ADAPTATION
+        /* The next page is announced in the first payload octet. */
+        if (rate_adaptation && (phy_frame_length <= FRAME_OVERHEAD))
+        {
+            phy_frame_length = FRAME_OVERHEAD + 1;
+            configure_frame_sending();
+        }
+#endif
         frames_to_transmit = number_test_frames;
         frame_no_ack = 0;
         frame_access_failure = 0;
@@ -773,6 +978,98 @@ static void start_ed_scan(void)
 }
 
 
+/**
+ * @brief Start the ping-pong latency test
+ *
+ * The initiator sends as many pings as test frames are configured, at most
+ * PING_MAX_SAMPLES; the reflector answers until a key is pressed.
+ */
+static void start_ping_test(void)
+{
+    ping_role_t role;
+    uint16_t pings;
+
+    printf("\r\n(I)nitiator or (R)eflector? ");
+    switch (toupper(sio_getchar()))
+    {
+        case 'I': role = PING_INITIATOR; break;
+        case 'R': role = PING_REFLECTOR; break;
+        default: return;
+    }
+
+    if (number_test_frames > PING_MAX_SAMPLES)
+    {
+        pings = PING_MAX_SAMPLES;
+    }
+    else
+    {
+        pings = (uint16_t)number_test_frames;
+    }
+
+    tal_rx_enable(PHY_TRX_OFF);
+    if (!perf_ping_start(role, pings, tx_frame_info, FRAME_OVERHEAD - FCS_LEN))
+    {
+        printf("\r\nFrame length too short, at least %d octets required.",
+               FRAME_OVERHEAD + PING_PAYLOAD_MIN_LEN);
+        printf("\r\nPress any key to return to main menu.");
+        sio_getchar();
+        return;
+    }
+
+    op_mode = PING_OP_MODE;
+    if (role == PING_INITIATOR)
+    {
+        printf("\r\nSending %" PRIu16 " pings... Press any key to stop.\r\n", pings);
+    }
+    else
+    {
+        printf("\r\nAnswering pings... Press any key to stop.\r\n");
+    }
+}
+
+
+/**
+ * @brief Start continuous energy survey on all channels
+ */
+static void start_ed_survey(void)
+{
+    uint32_t channel_mask;
+
+    tal_pib_get(phyChannelsSupported, (uint8_t *)&channel_mask);
+    tal_rx_enable(PHY_TRX_OFF);
+    if (tfa_ed_survey_start(channel_mask, ED_SURVEY_THRESHOLD) == MAC_SUCCESS)
+    {
+        ed_survey_visits = 0;
+        op_mode = ED_SURVEY_OP_MODE;
+        printf("\r\nEnergy survey started. Press any key to stop ...\r\n");
+    }
+}
+
+
+/**
+ * @brief Print the energy survey statistics of all channels
+ *
+ * ED values are normalized to 0..255; busy is the share of samples
+ * above ED_SURVEY_THRESHOLD in percent.
+ */
+static void print_ed_survey(void)
+{
+    uint8_t channel;
+    tfa_ed_survey_result_t result;
+
+    printf("\r\nChannel\tSamples\tMean\tP50\tP90\tP99\tMax\tBusy(%%)\r\n");
+    for (channel = MIN_CHANNEL; channel <= MAX_CHANNEL; channel++)
+    {
+        if (tfa_ed_survey_get(channel, &result) == MAC_SUCCESS)
+        {
+            printf("%d\t%" PRIu16 "\t%d\t%d\t%d\t%d\t%d\t%d\r\n",
+                   channel, result.samples, result.mean, result.p50,
+                   result.p90, result.p99, result.max, result.duty_cycle);
+        }
+    }
+}
+
+
 /**
  * @brief Start CW transmission on current channel page
  */
@@ -1182,6 +1479,27 @@ static void toggle_retry_enabled(void)
 }
 
 
+#ifdef ENABLE_RATE_ADAPTATION
+/**
+ * @brief Support function to toggle the rate adaptation
+ *
+ * Each test run starts again from the compliant channel page.
+ */
+static void toggle_rate_adaptation(void)
+{
+    if (rate_adaptation)
+    {
+        rate_adaptation = false;
+    }
+    else
+    {
+        rate_adaptation = true;
+        tal_rate_adapt_init();
+    }
+}
+#endif
+
+
 #ifdef ANTENNA_DIVERSITY
 /**
  * @brief Support function toggling antenna diversity
@@ -1233,6 +1551,12 @@ static void print_result(void)
         data_rate = data_volume / duration_s / 1000;
 
         printf("Net data rate = %.2f kbit/s\r\n", (double)data_rate);
+#ifdef ENABLE_RATE_ADAPTATION
+        if (rate_adaptation)
+        {
+            printf("Selected channel page = %d\r\n", tal_rate_adapt_get_page(DST_SHORT_ADDR));
+        }
+#endif
         printf("Press any key to continue");
         sio_getchar();
     }
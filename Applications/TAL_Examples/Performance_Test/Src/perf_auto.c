@@ -0,0 +1,716 @@
+/**
+ * @file perf_auto.c
+ *
+ * @brief Automation mode of the Performance_Test application
+ *
+ * In the automation mode the application is controlled by the binary
+ * protocol of perf_protocol.h instead of the terminal menu, so a host
+ * script can sweep the test parameters unattended.
+ *
+ * The frame retries of a transmit run are done by the application: each
+ * attempt is passed to tal_tx_frame() without frame retry, and a frame
+ * without ACK is repeated with the same sequence number until the maximum
+ * number of retries is reached. With CSMA every attempt performs its own
+ * CSMA-CA, like the automatic retries of the transceiver, but the number of
+ * retries needed by each frame is known and reported as distribution.
+ *
+ * The latency of a frame is measured from the first tal_tx_frame() call of
+ * the frame until the successful attempt went on air, i.e. until the time
+ * stamp of the frame written by the TAL (ENABLE_TSTAMP). Without
+ * ENABLE_TSTAMP the time of tal_tx_frame_done_cb() is used instead.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "perf_auto.h"
+
+#if ((PERF_TX_RESULT_LEN + 1) > PERF_MSG_MAX_LEN)
+#error "PERF_RSP_TX_RESULT exceeds PERF_MSG_MAX_LEN"
+#endif
+
+/* === TYPES =============================================================== */
+
+/** State of the automation mode */
+typedef enum perf_state_tag
+{
+    PERF_STATE_IDLE,
+    PERF_STATE_TX,
+    PERF_STATE_RX
+} perf_state_t;
+
+/** Test parameters, see PERF_CMD_CONFIG */
+typedef struct perf_config_tag
+{
+    uint8_t psdu_length;
+    uint8_t channel;
+    uint8_t page;
+    int8_t tx_power;
+    uint8_t csma;
+    uint8_t max_retries;
+    uint8_t ack_request;
+    uint32_t frames;
+    uint16_t bin_us;
+} perf_config_t;
+
+/** Result of a transmit run, see PERF_RSP_TX_RESULT */
+typedef struct perf_tx_result_tag
+{
+    uint8_t status;
+    uint32_t frames;
+    uint32_t success;
+    uint32_t no_ack;
+    uint32_t access_failure;
+    uint32_t failure;
+    uint32_t attempts;
+    uint32_t retries[PERF_MAX_RETRIES + 1];
+    uint64_t duration_us;
+    uint32_t latency_min;
+    uint32_t latency_max;
+    uint64_t latency_sum;
+    uint32_t hist[PERF_HIST_BINS];
+} perf_tx_result_t;
+
+/* === GLOBALS ============================================================= */
+
+static uint8_t perf_sio_unit;
+static perf_state_t perf_state;
+
+static perf_config_t config;
+static frame_info_t *test_frame;
+
+/** Parameters and result of the last transmit run */
+static perf_config_t run_config;
+static perf_tx_result_t tx_result;
+
+/** Frames of the transmit run not yet completed */
+static uint32_t frames_left;
+/** Retry of the current frame */
+static uint8_t attempt;
+static bool tx_busy;
+static uint32_t request_time;
+static uint32_t last_time;
+
+/** Receive run */
+static uint32_t rx_frames;
+static uint32_t rx_unique;
+static uint32_t rx_lqi_sum;
+static uint32_t rx_ed_sum;
+static uint8_t rx_last_dsn;
+
+/** Receiver of the command frames */
+static uint8_t rx_msg[PERF_MSG_MAX_LEN + 2];
+static uint8_t rx_index;
+static uint8_t rx_length;
+static uint16_t rx_crc;
+
+/** Transmit buffer of the response frames */
+static uint8_t tx_buf[PERF_MSG_MAX_LEN + PERF_FRAME_OVERHEAD];
+
+/* === PROTOTYPES ========================================================== */
+
+
+/* === IMPLEMENTATION ====================================================== */
+
+static uint16_t crc_update(uint16_t crc, uint8_t data)
+{
+    uint8_t i;
+
+    crc ^= (uint16_t)data << 8;
+    for (i = 0; i < 8; i++)
+    {
+        if (crc & 0x8000)
+        {
+            crc = (crc << 1) ^ 0x1021;
+        }
+        else
+        {
+            crc <<= 1;
+        }
+    }
+
+    return crc;
+}
+
+
+
+static uint8_t *put_32(uint8_t *ptr, uint32_t value)
+{
+    *ptr++ = (uint8_t)value;
+    *ptr++ = (uint8_t)(value >> 8);
+    *ptr++ = (uint8_t)(value >> 16);
+    *ptr++ = (uint8_t)(value >> 24);
+
+    return ptr;
+}
+
+
+
+/**
+ * @brief Sends a response frame; the parameters are stored at tx_buf[3]
+ *
+ * Waits until the serial interface accepted the complete frame.
+ */
+static void send_frame(uint8_t code, uint8_t param_length)
+{
+    uint8_t length = param_length + 1;
+    uint8_t frame_length = length + PERF_FRAME_OVERHEAD;
+    uint16_t crc = PERF_CRC_INIT;
+    uint8_t sent = 0;
+    uint8_t i;
+
+    tx_buf[0] = PERF_SOF;
+    tx_buf[1] = length;
+    tx_buf[2] = code;
+    for (i = 1; i <= (length + 1); i++)
+    {
+        crc = crc_update(crc, tx_buf[i]);
+    }
+    tx_buf[2 + length] = (uint8_t)crc;
+    tx_buf[3 + length] = (uint8_t)(crc >> 8);
+
+    while (sent < frame_length)
+    {
+        i = pal_sio_tx(perf_sio_unit, &tx_buf[sent], frame_length - sent);
+        if (0 == i)
+        {
+            /* The USB interface is served by pal_task(). */
+            pal_task();
+        }
+        sent += i;
+    }
+}
+
+
+
+static void send_status(uint8_t cmd, retval_t status)
+{
+    tx_buf[3] = cmd;
+    tx_buf[4] = (uint8_t)status;
+    send_frame(PERF_RSP_STATUS, 2);
+}
+
+
+
+static void send_tx_result(void)
+{
+    uint8_t *ptr = &tx_buf[3];
+    uint32_t mean = 0;
+    uint8_t i;
+
+    if (tx_result.success > 0)
+    {
+        mean = (uint32_t)(tx_result.latency_sum / tx_result.success);
+    }
+    else
+    {
+        tx_result.latency_min = 0;
+    }
+
+    *ptr++ = tx_result.status;
+    *ptr++ = run_config.psdu_length;
+    *ptr++ = run_config.channel;
+    *ptr++ = run_config.page;
+    *ptr++ = (uint8_t)run_config.tx_power;
+    *ptr++ = run_config.csma;
+    *ptr++ = run_config.max_retries;
+    *ptr++ = run_config.ack_request;
+    ptr = put_32(ptr, run_config.frames);
+    *ptr++ = (uint8_t)run_config.bin_us;
+    *ptr++ = (uint8_t)(run_config.bin_us >> 8);
+    ptr = put_32(ptr, tx_result.frames);
+    ptr = put_32(ptr, tx_result.success);
+    ptr = put_32(ptr, tx_result.no_ack);
+    ptr = put_32(ptr, tx_result.access_failure);
+    ptr = put_32(ptr, tx_result.failure);
+    ptr = put_32(ptr, tx_result.attempts);
+    for (i = 0; i <= PERF_MAX_RETRIES; i++)
+    {
+        ptr = put_32(ptr, tx_result.retries[i]);
+    }
+    ptr = put_32(ptr, (uint32_t)tx_result.duration_us);
+    ptr = put_32(ptr, (uint32_t)(tx_result.duration_us >> 32));
+    ptr = put_32(ptr, tx_result.latency_min);
+    ptr = put_32(ptr, mean);
+    ptr = put_32(ptr, tx_result.latency_max);
+    for (i = 0; i < PERF_HIST_BINS; i++)
+    {
+        ptr = put_32(ptr, tx_result.hist[i]);
+    }
+
+    send_frame(PERF_RSP_TX_RESULT, PERF_TX_RESULT_LEN);
+}
+
+
+
+static void send_rx_result(void)
+{
+    uint8_t *ptr = &tx_buf[3];
+    uint8_t lqi = 0;
+    uint8_t ed = 0;
+
+    if (rx_frames > 0)
+    {
+        lqi = (uint8_t)(rx_lqi_sum / rx_frames);
+        ed = (uint8_t)(rx_ed_sum / rx_frames);
+    }
+
+    ptr = put_32(ptr, rx_frames);
+    ptr = put_32(ptr, rx_unique);
+    *ptr++ = lqi;
+    *ptr = ed;
+
+    send_frame(PERF_RSP_RX_RESULT, PERF_RX_RESULT_LEN);
+}
+
+
+
+static void send_hello(void)
+{
+    uint8_t features = 0;
+
+#ifdef ENABLE_TSTAMP
+    features |= PERF_FEATURE_TSTAMP;
+#endif
+
+    tx_buf[3] = PERF_PROTOCOL_VERSION;
+    tx_buf[4] = (uint8_t)TAL_TYPE;
+    tx_buf[5] = features;
+    tx_buf[6] = PERF_HIST_BINS;
+    tx_buf[7] = PERF_MAX_RETRIES;
+    send_frame(PERF_RSP_HELLO, 5);
+}
+
+
+
+/**
+ * @brief Applies the parameters of PERF_CMD_CONFIG
+ */
+static retval_t set_config(uint8_t *params)
+{
+    perf_config_t cfg;
+    frame_info_t *frame;
+    uint8_t temp_var;
+    retval_t status;
+
+    cfg.psdu_length = params[0];
+    cfg.channel = params[1];
+    cfg.page = params[2];
+    cfg.tx_power = (int8_t)params[3];
+    cfg.csma = params[4];
+    cfg.max_retries = params[5];
+    cfg.ack_request = params[6];
+    cfg.frames = (uint32_t)params[7] | ((uint32_t)params[8] << 8) |
+                 ((uint32_t)params[9] << 16) | ((uint32_t)params[10] << 24);
+    cfg.bin_us = (uint16_t)params[11] | ((uint16_t)params[12] << 8);
+
+    if ((cfg.max_retries > PERF_MAX_RETRIES) || (0 == cfg.frames) ||
+        (0 == cfg.bin_us))
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    frame = perf_app_configure_frame(cfg.psdu_length, (cfg.ack_request != 0));
+    if (NULL == frame)
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+    test_frame = frame;
+
+    /* The page is only set if changed, since not every build supports it. */
+    tal_pib_get(phyCurrentPage, &temp_var);
+    if (temp_var != cfg.page)
+    {
+        status = tal_pib_set(phyCurrentPage, (pib_value_t *)&cfg.page);
+        if (status != MAC_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    status = tal_pib_set(phyCurrentChannel, (pib_value_t *)&cfg.channel);
+    if (status != MAC_SUCCESS)
+    {
+        return status;
+    }
+
+    temp_var = CONV_DBM_TO_phyTransmitPower(cfg.tx_power);
+    status = tal_pib_set(phyTransmitPower, (pib_value_t *)&temp_var);
+    if (status != MAC_SUCCESS)
+    {
+        return status;
+    }
+
+    config = cfg;
+
+    return MAC_SUCCESS;
+}
+
+
+
+static void start_tx(void)
+{
+    memset(&tx_result, 0, sizeof(tx_result));
+    tx_result.status = MAC_SUCCESS;
+    tx_result.latency_min = UINT32_MAX;
+    run_config = config;
+
+    frames_left = config.frames;
+    attempt = 0;
+    tx_busy = false;
+    pal_get_current_time(&last_time);
+
+    perf_state = PERF_STATE_TX;
+}
+
+
+
+static void start_rx(void)
+{
+    rx_frames = 0;
+    rx_unique = 0;
+    rx_lqi_sum = 0;
+    rx_ed_sum = 0;
+
+    tal_rx_enable(PHY_RX_ON);
+    perf_state = PERF_STATE_RX;
+}
+
+
+
+/**
+ * @brief Handles a complete command frame
+ *
+ * @return false if the host requested the return to the menu
+ */
+static bool handle_command(uint8_t code, uint8_t *params, uint8_t param_length)
+{
+    retval_t status = MAC_SUCCESS;
+
+    switch (code)
+    {
+        case PERF_CMD_HELLO:
+            send_hello();
+            return true;
+
+        case PERF_CMD_CONFIG:
+            if (perf_state != PERF_STATE_IDLE)
+            {
+                status = TAL_BUSY;
+            }
+            else if (param_length != PERF_CONFIG_LEN)
+            {
+                status = MAC_INVALID_PARAMETER;
+            }
+            else
+            {
+                status = set_config(params);
+            }
+            break;
+
+        case PERF_CMD_TX_START:
+        case PERF_CMD_RX_START:
+            if (perf_state != PERF_STATE_IDLE)
+            {
+                status = TAL_BUSY;
+            }
+            else if (NULL == test_frame)
+            {
+                /* Not configured yet */
+                status = FAILURE;
+            }
+            else if (PERF_CMD_TX_START == code)
+            {
+                start_tx();
+            }
+            else
+            {
+                start_rx();
+            }
+            break;
+
+        case PERF_CMD_STOP:
+            if (PERF_STATE_TX == perf_state)
+            {
+                /* The result is sent once the current frame is completed. */
+                frames_left = 0;
+                tx_result.status = FAILURE;
+            }
+            else if (PERF_STATE_RX == perf_state)
+            {
+                tal_rx_enable(PHY_TRX_OFF);
+                perf_state = PERF_STATE_IDLE;
+                send_status(code, MAC_SUCCESS);
+                send_rx_result();
+                return true;
+            }
+            break;
+
+        case PERF_CMD_RESULT:
+            send_tx_result();
+            return true;
+
+        case PERF_CMD_EXIT:
+            if (perf_state != PERF_STATE_IDLE)
+            {
+                status = TAL_BUSY;
+                break;
+            }
+            send_status(code, MAC_SUCCESS);
+            return false;
+
+        default:
+            status = MAC_INVALID_PARAMETER;
+            break;
+    }
+
+    send_status(code, status);
+
+    return true;
+}
+
+
+
+/**
+ * @brief Passes a received octet to the frame receiver
+ *
+ * @return true if a valid frame is stored in rx_msg
+ */
+static bool rx_octet(uint8_t data)
+{
+    if (0 == rx_index)
+    {
+        /* Search for the start of a frame. */
+        if (PERF_SOF == data)
+        {
+            rx_index = 1;
+            rx_crc = PERF_CRC_INIT;
+        }
+        return false;
+    }
+
+    if (1 == rx_index)
+    {
+        if ((0 == data) || (data > PERF_MSG_MAX_LEN))
+        {
+            /* Invalid length; it may have been a SOF of the next frame. */
+            rx_index = (PERF_SOF == data) ? 1 : 0;
+            return false;
+        }
+        rx_length = data;
+        rx_crc = crc_update(rx_crc, data);
+        rx_index = 2;
+        return false;
+    }
+
+    /* Message and CRC, the CRC is stored behind the message. */
+    rx_msg[rx_index - 2] = data;
+    if (rx_index < (rx_length + 2))
+    {
+        rx_crc = crc_update(rx_crc, data);
+    }
+    rx_index++;
+
+    if (rx_index < (rx_length + PERF_FRAME_OVERHEAD))
+    {
+        return false;
+    }
+
+    rx_index = 0;
+
+    return (((uint16_t)rx_msg[rx_length] | ((uint16_t)rx_msg[rx_length + 1] << 8)) == rx_crc);
+}
+
+
+
+void perf_auto_enter(uint8_t sio_unit)
+{
+    perf_sio_unit = sio_unit;
+    perf_state = PERF_STATE_IDLE;
+
+    /* A run can only be started after PERF_CMD_CONFIG. */
+    test_frame = NULL;
+    memset(&config, 0, sizeof(config));
+    memset(&tx_result, 0, sizeof(tx_result));
+    memset(&run_config, 0, sizeof(run_config));
+
+    /* The menu received the SOF of the first command. */
+    rx_index = 1;
+    rx_crc = PERF_CRC_INIT;
+}
+
+
+
+bool perf_auto_task(void)
+{
+    uint8_t data;
+
+    while (pal_sio_rx(perf_sio_unit, &data, 1) > 0)
+    {
+        if (rx_octet(data))
+        {
+            if (!handle_command(rx_msg[0], &rx_msg[1], rx_length - 1))
+            {
+                return false;
+            }
+        }
+    }
+
+    if ((PERF_STATE_TX == perf_state) && !tx_busy)
+    {
+        if (frames_left > 0)
+        {
+            if (0 == attempt)
+            {
+                test_frame->mpdu[PL_POS_SEQ_NUM]++;
+                pal_get_current_time(&request_time);
+            }
+            tx_busy = true;
+            tx_result.attempts++;
+            if (run_config.csma)
+            {
+                tal_tx_frame(test_frame, CSMA_UNSLOTTED, false);
+            }
+            else
+            {
+                tal_tx_frame(test_frame, NO_CSMA_NO_IFS, false);
+            }
+        }
+        else
+        {
+            tal_rx_enable(PHY_TRX_OFF);
+            perf_state = PERF_STATE_IDLE;
+            send_tx_result();
+        }
+    }
+
+    return true;
+}
+
+
+
+void perf_auto_tx_done(retval_t status, frame_info_t *frame)
+{
+    uint32_t now;
+    uint32_t latency;
+    uint8_t bin;
+
+    if (PERF_STATE_TX != perf_state)
+    {
+        return;
+    }
+
+    tx_busy = false;
+
+    pal_get_current_time(&now);
+    tx_result.duration_us += pal_sub_time_us(now, last_time);
+    last_time = now;
+
+    if ((MAC_NO_ACK == status) && (attempt < run_config.max_retries) &&
+        (frames_left > 0))
+    {
+        /* Repeated by the next perf_auto_task() */
+        attempt++;
+        return;
+    }
+
+    tx_result.frames++;
+    if (frames_left > 0)
+    {
+        frames_left--;
+    }
+
+    switch (status)
+    {
+        case MAC_SUCCESS:
+        case TAL_FRAME_PENDING:
+            tx_result.success++;
+            tx_result.retries[attempt]++;
+
+#ifdef ENABLE_TSTAMP
+            latency = pal_sub_time_us(frame->time_stamp, request_time);
+            /* The time stamp is corrected by estimated delays only. */
+            if ((int32_t)latency < 0)
+            {
+                latency = 0;
+            }
+#else
+            latency = pal_sub_time_us(now, request_time);
+            frame = frame;  /* Keep compiler happy. */
+#endif
+            if (latency < tx_result.latency_min)
+            {
+                tx_result.latency_min = latency;
+            }
+            if (latency > tx_result.latency_max)
+            {
+                tx_result.latency_max = latency;
+            }
+            tx_result.latency_sum += latency;
+
+            if ((latency / run_config.bin_us) >= (PERF_HIST_BINS - 1))
+            {
+                bin = PERF_HIST_BINS - 1;
+            }
+            else
+            {
+                bin = (uint8_t)(latency / run_config.bin_us);
+            }
+            tx_result.hist[bin]++;
+            break;
+
+        case MAC_NO_ACK:
+            tx_result.no_ack++;
+            break;
+
+        case MAC_CHANNEL_ACCESS_FAILURE:
+            tx_result.access_failure++;
+            break;
+
+        default:
+            tx_result.failure++;
+            break;
+    }
+
+    attempt = 0;
+}
+
+
+
+void perf_auto_rx_frame(frame_info_t *frame)
+{
+    uint8_t length = frame->mpdu[0];
+
+    if (PERF_STATE_RX != perf_state)
+    {
+        return;
+    }
+
+    /* Repeated frames carry the sequence number of the previous frame. */
+    if ((0 == rx_frames) || (frame->mpdu[PL_POS_SEQ_NUM] != rx_last_dsn))
+    {
+        rx_unique++;
+    }
+    rx_last_dsn = frame->mpdu[PL_POS_SEQ_NUM];
+    rx_frames++;
+
+    rx_lqi_sum += frame->mpdu[length + LQI_LEN];
+    rx_ed_sum += frame->mpdu[length + LQI_LEN + ED_VAL_LEN];
+}
+
+/* EOF */
@@ -0,0 +1,197 @@
+/**
+ * @file perf_ping.c
+ *
+ * @brief Ping-pong latency test of the Performance_Test application
+ *
+ * The pings and pongs are sent directly via tal_tx_frame() with unslotted
+ * CSMA-CA and frame retries, reusing the test frame of the application;
+ * the measurement itself is done by ping_pong.c. The reflector requests the
+ * pong within tal_rx_frame_cb(), so its turnaround contains no main loop
+ * latency. Comparing the result with the one of the MAC example Ping_Pong
+ * shows the share of the MAC.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pal.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "perf_ping.h"
+
+/* === MACROS ============================================================== */
+
+
+/* === GLOBALS ============================================================= */
+
+static ping_role_t role;
+static uint16_t pings_to_send;
+static frame_info_t *ping_frame;
+static uint8_t *ping_payload;
+static uint8_t mac_header_length;
+static bool tx_busy;
+static bool stopping;
+
+/* === PROTOTYPES ========================================================== */
+
+static void send_frame(void);
+
+/* === IMPLEMENTATION ====================================================== */
+
+
+/**
+ * @brief Starts the ping-pong latency test via the TAL
+ *
+ * @param ping_role Role of this node
+ * @param pings Number of pings sent by the initiator
+ * @param frame Test frame, reused for the pings and pongs
+ * @param header_length Length of the MAC header of the test frame
+ *
+ * @return true if the test frame is long enough for a ping
+ */
+bool perf_ping_start(ping_role_t ping_role, uint16_t pings,
+                     frame_info_t *frame, uint8_t header_length)
+{
+    uint8_t payload_length = frame->mpdu[0] - header_length - FCS_LEN;
+
+    if ((frame->mpdu[0] < (header_length + FCS_LEN)) ||
+        !ping_init(ping_role, payload_length))
+    {
+        return false;
+    }
+
+    role = ping_role;
+    pings_to_send = pings;
+    ping_frame = frame;
+    ping_payload = &frame->mpdu[LENGTH_FIELD_LEN + header_length];
+    mac_header_length = header_length;
+    tx_busy = false;
+    stopping = false;
+
+    tal_rx_enable(PHY_RX_ON);
+
+    return true;
+}
+
+
+/**
+ * @brief Stops the test once the current transmission is completed
+ */
+void perf_ping_stop(void)
+{
+    stopping = true;
+}
+
+
+/**
+ * @brief Sends the pings of the initiator
+ *
+ * @return false once the test is completed and the result is printed
+ */
+bool perf_ping_task(void)
+{
+    if (tx_busy)
+    {
+        return true;
+    }
+
+    if (role == PING_INITIATOR)
+    {
+        if (ping_pending())
+        {
+            return true;
+        }
+
+        if (!stopping && (ping_count() < pings_to_send))
+        {
+            ping_build_request(ping_payload);
+            send_frame();
+            return true;
+        }
+    }
+    else if (!stopping)
+    {
+        /* The pongs are sent by perf_ping_rx_frame(). */
+        return true;
+    }
+
+    tal_rx_enable(PHY_TRX_OFF);
+    ping_print_result("TAL");
+
+    return false;
+}
+
+
+/**
+ * @brief Handles the end of a transmission
+ *
+ * @param status Status of the transmission
+ * @param frame Transmitted frame
+ */
+void perf_ping_tx_done(retval_t status, frame_info_t *frame)
+{
+    tx_busy = false;
+#ifdef ENABLE_TSTAMP
+    ping_tx_done(status, frame->time_stamp);
+#else
+    ping_tx_done(status, 0);
+    frame = frame;  /* Keep compiler happy. */
+#endif
+}
+
+
+/**
+ * @brief Handles a received frame
+ *
+ * @param frame Received frame; the buffer is freed by the caller
+ */
+void perf_ping_rx_frame(frame_info_t *frame)
+{
+    uint8_t *payload = &frame->mpdu[LENGTH_FIELD_LEN + mac_header_length];
+    uint32_t rx_stamp = 0;
+
+    if (frame->mpdu[0] < (mac_header_length + FCS_LEN))
+    {
+        return;
+    }
+
+#ifdef ENABLE_TSTAMP
+    rx_stamp = frame->time_stamp;
+#endif
+
+    if (ping_rx(payload, frame->mpdu[0] - mac_header_length - FCS_LEN, rx_stamp) &&
+        !tx_busy && !stopping)
+    {
+        /* Answer right away to keep the turnaround short. */
+        ping_build_response(ping_payload);
+        send_frame();
+    }
+}
+
+
+/**
+ * @brief Requests the transmission of the ping or pong in the test frame
+ */
+static void send_frame(void)
+{
+    ping_frame->mpdu[PL_POS_SEQ_NUM]++;
+    tx_busy = true;
+    if (tal_tx_frame(ping_frame, CSMA_UNSLOTTED, true) != MAC_SUCCESS)
+    {
+        tx_busy = false;
+        ping_tx_done(TAL_BUSY, 0);
+    }
+}
+
+/* EOF */
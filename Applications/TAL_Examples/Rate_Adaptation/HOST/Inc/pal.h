@@ -0,0 +1,93 @@
+/**
+ * @file pal.h
+ *
+ * @brief Minimal PAL for building the rate adaptation on a host computer
+ *
+ * The rate adaptation of the TAL only requires the compiler abstraction,
+ * the flash access macros, the critical region handling and the time
+ * functions of the PAL. This file provides these for a host build with GCC,
+ * so that the rate adaptation can be run without any target hardware. The
+ * compiler abstraction of the 32 bit MCUs (PAL_GENERIC_TYPE ARM7) is used,
+ * since it only depends on GCC. The time is provided by the test program.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_H
+#define PAL_H
+
+/* === Includes ============================================================ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pal_types.h"
+#include "app_config.h"
+
+#if (PAL_GENERIC_TYPE != ARM7)
+#error "The host PAL requires PAL_GENERIC_TYPE ARM7"
+#endif
+
+/* === Macros =============================================================== */
+
+/**
+ * Adds two time values
+ */
+#define ADD_TIME(a, b)                  ((a) + (b))
+
+/**
+ * Subtracts two time values
+ */
+#define SUB_TIME(a, b)                  ((a) - (b))
+
+/**
+ * A host build runs single threaded without interrupts, so no critical
+ * regions are required.
+ */
+#define ENTER_CRITICAL_REGION()
+#define LEAVE_CRITICAL_REGION()
+
+/**
+ * Assertions are not evaluated by the host build.
+ */
+#define ASSERT(expr)
+
+/* === Types =============================================================== */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+/**
+ * @brief Gets the current time in us
+ *
+ * @param[out] current_time Current time
+ */
+void pal_get_current_time(uint32_t *current_time);
+
+/**
+ * @brief Subtracts two time values
+ *
+ * @param a Time value
+ * @param b Time value
+ *
+ * @return Difference a - b in us
+ */
+static inline uint32_t pal_sub_time_us(uint32_t a, uint32_t b)
+{
+    return (SUB_TIME(a, b));
+}
+
+
+#endif  /* PAL_H */
+/* EOF */
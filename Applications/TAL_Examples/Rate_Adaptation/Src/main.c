@@ -0,0 +1,218 @@
+/**
+ * @file main.c
+ *
+ * @brief TAL Example Rate Adaptation - host test of the rate adaptation
+ *
+ * This program runs the rate adaptation of the TAL (tal_rate_adapt.c)
+ * against a simulated peer. Each exchange consists of an acknowledged
+ * transmission to the peer and a frame received from it, whose LQI and
+ * ED value are passed to tal_rate_adapt_rx_update() in the form the TAL
+ * appends them to the frame, i.e. the ED value is the value of register
+ * PHY_ED_LEVEL. A strong link has to climb the rate ladder up to the
+ * fastest page, while a weak link has to stay on the compliant page.
+ *
+ * The program is built for the host, so that changes of the rate
+ * adaptation can be checked without any hardware. It returns the number
+ * of failed checks.
+ *
+ * $Id$
+ *
+ *  @author
+ *      Atmel Corporation: http://www.atmel.com
+ *      Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdio.h>
+#include "pal.h"
+#include "return_val.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "tal_rate_adapt.h"
+#include "app_config.h"
+
+/* === TYPES =============================================================== */
+
+/* Link to the simulated peer */
+typedef struct link_tag
+{
+    const char *name;
+    uint8_t lqi;
+    uint8_t ed_reg;
+    uint8_t expected_page;
+} link_t;
+
+/* === MACROS ============================================================== */
+
+/* Short address of the simulated peer */
+#define PEER_ADDR                       (0x0001)
+
+/* Number of exchanges per link; enough to climb the complete ladder */
+#define NO_OF_EXCHANGES                 (100)
+
+/* Time between two exchanges in us, well below TAL_RATE_ADAPT_TIMEOUT_US */
+#define EXCHANGE_INTERVAL_US            (2000)
+
+/* Fastest page of the rate ladder */
+#define FASTEST_PAGE                    (17)
+
+/* === GLOBALS ============================================================= */
+
+/*
+ * Links to be checked. The register PHY_ED_LEVEL counts about 1 dB per step
+ * starting at the receiver sensitivity and is clipped at 55 to 62 depending
+ * on the transceiver, so 40 is a strong link and 10 a weak one.
+ */
+static const link_t links[] =
+{
+    { "strong link (ED register 40)", 0xFF, 40, FASTEST_PAGE },
+    { "clipped ED register (70)", 0xFF, 70, FASTEST_PAGE },
+    { "weak link (ED register 10)", 0xFF, 10, 0 },
+    { "low LQI (ED register 40)", 0x80, 40, 0 }
+};
+
+/* Current time of the host PAL */
+static uint32_t current_time;
+
+/* Current channel page of the host TAL */
+static uint8_t current_page;
+
+/* Number of failed checks */
+static unsigned int failures;
+
+/* === PROTOTYPES ========================================================== */
+
+static void check(const char *name, const char *step, bool passed);
+static void run_link(const link_t *link);
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Main function of the rate adaptation test
+ *
+ * @return Number of failed checks
+ */
+int main(void)
+{
+    uint8_t i;
+
+    printf("Rate adaptation\n");
+    for (i = 0; i < sizeof(links) / sizeof(links[0]); i++)
+    {
+        run_link(&links[i]);
+    }
+
+    printf("\n%u check(s) failed\n", failures);
+
+    return ((int)failures);
+}
+
+
+
+/**
+ * @brief Gets the current time of the host PAL
+ *
+ * @param[out] time Current time in us
+ */
+void pal_get_current_time(uint32_t *time)
+{
+    *time = current_time;
+}
+
+
+
+/**
+ * @brief Gets a PIB attribute of the host TAL
+ *
+ * Only phyCurrentPage is used by the rate adaptation.
+ *
+ * @param attribute PIB attribute
+ * @param value Pointer to the value of the attribute
+ *
+ * @return MAC_SUCCESS
+ */
+retval_t tal_pib_get(uint8_t attribute, uint8_t *value)
+{
+    attribute = attribute;  /* Keep compiler happy */
+
+    *value = current_page;
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Sets a PIB attribute of the host TAL
+ *
+ * Only phyCurrentPage is used by the rate adaptation.
+ *
+ * @param attribute PIB attribute
+ * @param value Pointer to the value of the attribute
+ *
+ * @return MAC_SUCCESS
+ */
+retval_t tal_pib_set(uint8_t attribute, pib_value_t *value)
+{
+    attribute = attribute;  /* Keep compiler happy */
+
+    current_page = value->pib_value_8bit;
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Reports the result of a single check
+ *
+ * @param name Name of the link
+ * @param step Name of the check
+ * @param passed True if the check has passed
+ */
+static void check(const char *name, const char *step, bool passed)
+{
+    if (!passed)
+    {
+        failures++;
+    }
+
+    printf("  %-32s %-10s %s\n", name, step, passed ? "OK" : "FAILED");
+}
+
+
+
+/**
+ * @brief Runs the exchanges with the simulated peer over a link
+ *
+ * @param link Link to the peer
+ */
+static void run_link(const link_t *link)
+{
+    uint8_t i;
+
+    tal_rate_adapt_init();
+    current_page = 0;
+
+    for (i = 0; i < NO_OF_EXCHANGES; i++)
+    {
+        current_time += EXCHANGE_INTERVAL_US;
+        tal_rate_adapt_set_page(PEER_ADDR);
+        tal_rate_adapt_tx_update(PEER_ADDR, MAC_SUCCESS);
+        tal_rate_adapt_rx_update(PEER_ADDR, link->lqi, link->ed_reg);
+    }
+
+    check(link->name, "page",
+          tal_rate_adapt_get_page(PEER_ADDR) == link->expected_page);
+
+    tal_rate_adapt_set_page(PEER_ADDR);
+    check(link->name, "set_page", current_page == link->expected_page);
+}
+
+/* EOF */
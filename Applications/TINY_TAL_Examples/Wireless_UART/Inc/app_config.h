@@ -100,9 +100,14 @@ typedef enum
 #define USB_PRODUCT_NAME L"RZUSBSTICK"
 
 /*
- * UART transmit and receive buffer size
+ * UART transmit and receive buffer size; the SIO bulk mode supports rings
+ * larger than 255 bytes.
  */
+#ifdef SIO_BULK
+#define UART_MAX_TX_BUF_LENGTH      (512)
+#else
 #define UART_MAX_TX_BUF_LENGTH      (255)
+#endif
 #define UART_MAX_RX_BUF_LENGTH      (UART_MAX_TX_BUF_LENGTH)
 
 /* Offset of IEEE address storage location within EEPROM */
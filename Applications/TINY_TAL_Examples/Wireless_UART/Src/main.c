@@ -26,19 +26,6 @@
 #include "app_config.h"
 #include "ieee_const.h"
 
-/* === TYPES =============================================================== */
-
-/**
- * This enum stores the current type of the node if this application.
- */
-typedef enum tx_state_tag
-{
-    TX_IDLE = 0,
-    TX_ONGOING,
-    TX_RETRY
-}
-tx_state_t;
-
 /* === MACROS ============================================================== */
 
 #if (TAL_TYPE == AT86RF212)
@@ -51,6 +38,11 @@ tx_state_t;
     #endif  /* #ifdef CHINESE_BAND */
 #else
 #define DEFAULT_CHANNEL                 (20)
+#ifdef HIGH_DATA_RATE_SUPPORT
+#define DEFAULT_CHANNEL_PAGE            (17)    /* 2 Mbit/s */
+#else
+#define DEFAULT_CHANNEL_PAGE            (0)
+#endif
 #endif
 
 #define DEFAULT_PAN_ID                  (0xCAFE)
@@ -95,6 +87,46 @@ tx_state_t;
 #define MAX_APP_DATA_LENGTH             (aMaxMACSafePayloadSize)
 #endif
 
+/* Application header within the MAC payload */
+#define WUART_POS_FLAGS                 (0)
+#define WUART_POS_SEQ                   (1)
+#define WUART_POS_ACK                   (2)
+#define WUART_POS_CREDIT                (3)
+#define WUART_POS_SACK                  (4)
+#define WUART_HDR_LEN                   (5)
+
+/* Flags of the application header */
+#define WUART_FLAG_DATA                 (0x01)  /* Frame carries data */
+#define WUART_FLAG_SYNC                 (0x02)  /* Sequence numbers start here */
+#define WUART_FLAG_PROBE                (0x04)  /* Request for acknowledgement */
+
+/* Maximum number of data bytes per frame */
+#define WUART_MAX_FRAME_DATA            (aMaxPHYPacketSize - FRAME_OVERHEAD - WUART_HDR_LEN)
+
+/* Maximum number of data bytes read from the SIO per frame */
+#if (MAX_APP_DATA_LENGTH < WUART_MAX_FRAME_DATA)
+#define WUART_MAX_APP_DATA              (MAX_APP_DATA_LENGTH)
+#else
+#define WUART_MAX_APP_DATA              (WUART_MAX_FRAME_DATA)
+#endif
+
+/*
+ * Number of frames sent without acknowledgement resp. buffered for the
+ * SIO; have to be powers of two, at most 128.
+ */
+#ifndef WUART_TX_WINDOW
+#define WUART_TX_WINDOW                 (8)
+#endif
+#ifndef WUART_RX_WINDOW
+#define WUART_RX_WINDOW                 (8)
+#endif
+
+/* Maximum delay of an acknowledgement in microseconds */
+#define WUART_ACK_DELAY_US              (20000)
+
+/* Retransmission timeout in microseconds */
+#define WUART_RETRY_TIMEOUT_US          (60000)
+
 #if (NO_OF_LEDS >= 3)
 #define LED_START                       (LED_0)
 #define LED_DATA_RX                     (LED_1)
@@ -109,16 +141,99 @@ tx_state_t;
 #define LED_DATA_TX                     (LED_0)
 #endif
 
+/* === TYPES =============================================================== */
+
+/**
+ * This enum stores the current state of the transmitter.
+ */
+typedef enum tx_state_tag
+{
+    TX_IDLE = 0,
+    TX_ONGOING
+}
+tx_state_t;
+
+/**
+ * Frame held in the transmit window until it is acknowledged by the peer.
+ */
+typedef struct tx_slot_tag
+{
+    /** Number of data bytes */
+    uint8_t len;
+    /** The peer has buffered the frame (selective acknowledgement) */
+    bool acked;
+    /** The frame has to be retransmitted as soon as possible */
+    bool resend;
+    /** Time of the last transmission in microseconds */
+    uint32_t sent_time;
+    /** Data bytes */
+    uint8_t data[WUART_MAX_FRAME_DATA];
+} tx_slot_t;
+
+/**
+ * Frame held in the receive window until it is written to the SIO;
+ * len is 0 for an empty slot.
+ */
+typedef struct rx_slot_tag
+{
+    /** Number of data bytes */
+    uint8_t len;
+    /** Data bytes */
+    uint8_t data[WUART_MAX_FRAME_DATA];
+} rx_slot_t;
+
 /* === GLOBALS ============================================================= */
 
 static tx_state_t tx_state = TX_IDLE;
 static uint8_t tx_buffer[LARGE_BUFFER_SIZE];
-static uint8_t sio_rx_data[MAX_APP_DATA_LENGTH];
+
+/* Transmit window, indexed by sequence number. */
+static tx_slot_t tx_window[WUART_TX_WINDOW];
+/* Sequence number of the oldest frame not acknowledged by the peer. */
+static uint8_t tx_base;
+/* Sequence number of the acknowledged frame echoed to the SIO. */
+static uint8_t tx_echo;
+/* Number of bytes of this frame already echoed to the SIO. */
+static uint8_t tx_echo_offset;
+/* Sequence number of the next new frame. */
+static uint8_t tx_next;
+/* Sequence number up to which (exclusive) the peer can buffer frames. */
+static uint8_t tx_limit;
+/* The peer has acknowledged a frame since startup. */
+static bool tx_synced;
+/* Sequence number of the frame currently transmitted; only valid for data. */
+static uint8_t tx_current_seq;
+static bool tx_current_data;
+/* Time of the last probe of a closed window. */
+static uint32_t tx_probe_time;
+
+/* Receive window, indexed by sequence number. */
+static rx_slot_t rx_window[WUART_RX_WINDOW];
+/* Sequence number of the frame written to the SIO. */
+static uint8_t rx_deliver;
+/* Number of bytes of this frame already written to the SIO. */
+static uint8_t rx_deliver_offset;
+/* Sequence number of the next frame expected in order (cumulative ack). */
+static uint8_t rx_next;
+/* Window end advertised to the peer in the last frame. */
+static uint8_t rx_adv_limit;
+/* The receive window follows the sequence numbers of the peer. */
+static bool rx_synced;
+/* Acknowledgement state of the receiver. */
+static bool ack_pending;
+static bool ack_now;
+static uint8_t rx_unacked;
+static uint32_t ack_time;
 
 /* === PROTOTYPES ========================================================== */
 
 static void app_task(void);
 static void configure_frame_sending(void);
+static void sio_drain(void);
+static void send_frame(uint8_t flags, uint8_t seq, uint8_t *data, uint8_t len);
+static void process_ack(uint8_t ack, uint8_t credit, uint8_t sack, uint32_t now);
+static void process_data(uint8_t flags, uint8_t seq, uint8_t *data,
+                         uint8_t len, uint32_t now);
 
 /* === IMPLEMENTATION ====================================================== */
 
@@ -175,152 +290,429 @@ int main(void)
 
 /**
  * @brief Application task
+ *
+ * Writes received data to the SIO and transmits at most one frame:
+ * a retransmission, a frame with new SIO data, an acknowledgement, or a
+ * probe of a closed window, in this order of priority.
  */
 static void app_task(void)
 {
-    uint8_t number_of_bytes_to_be_transmitted;
+    uint32_t now;
+    uint8_t seq;
+    tx_slot_t *slot;
+
+    sio_drain();
+
+    if (tx_state != TX_IDLE)
+    {
+        return;
+    }
+
+    pal_get_current_time(&now);
+
+    /* Retransmit the oldest frame that is missing at the peer. */
+    for (seq = tx_base; seq != tx_next; seq++)
+    {
+        slot = &tx_window[seq & (WUART_TX_WINDOW - 1)];
+
+        if (!slot->acked &&
+            (slot->resend ||
+             (SUB_TIME(now, slot->sent_time) > WUART_RETRY_TIMEOUT_US)))
+        {
+            slot->resend = false;
+            slot->sent_time = now;
+            send_frame(WUART_FLAG_DATA, seq, slot->data, slot->len);
+            return;
+        }
+    }
 
-    if (tx_state == TX_IDLE)
+    /*
+     * Send new data if the transmit window and the window of the peer
+     * allow it. Until the peer has acknowledged a frame, only one frame is
+     * sent, so that the peer can synchronize to the sequence numbers.
+     * A slot is reused once its data has been echoed.
+     */
+    if (((uint8_t)(tx_next - tx_echo) < WUART_TX_WINDOW) &&
+        ((int8_t)(tx_limit - tx_next) > 0) &&
+        (tx_synced || (tx_next == tx_base)))
     {
+        slot = &tx_window[tx_next & (WUART_TX_WINDOW - 1)];
 
-        number_of_bytes_to_be_transmitted = pal_sio_rx(SIO_CHANNEL, sio_rx_data, MAX_APP_DATA_LENGTH);
+        slot->len = pal_sio_rx(SIO_CHANNEL, slot->data, WUART_MAX_APP_DATA);
 
         // If bytes are received via UART/USB, transmit the bytes.
-        if (number_of_bytes_to_be_transmitted > 0)
+        if (slot->len > 0)
         {
-            tx_state = TX_ONGOING;
-
-            tx_buffer[PL_POS_SEQ_NUM]++;
-
-            /* Check for maximum allowed IEEE 802.15.4 frame length. */
-            if (number_of_bytes_to_be_transmitted > aMaxMACSafePayloadSize)
-            {
-                ASSERT("Received too many bytes from SIO");
-                number_of_bytes_to_be_transmitted = aMaxMACSafePayloadSize;
-            }
-
-            /* Update mpdu length within frame. */
-            tx_buffer[0] = number_of_bytes_to_be_transmitted + FRAME_OVERHEAD;
-
-            /* Copy MSDU (actual MAC payload) into frame. */
-            /*
-             * Note: Usually the MSDU is copied beginning from the end of
-             * the frame. Since the header is always the same for this
-             * application, the start of the MSDU is always the same position.
-             * Therefore the payload copying is done from the beginning.
-             */
-            memcpy(&tx_buffer[LENGTH_FIELD_LEN + FRAME_OVERHEAD  - FCS_LEN],
-                   sio_rx_data,
-                   number_of_bytes_to_be_transmitted);
-
-            tal_tx_frame(tx_buffer, CSMA_UNSLOTTED, true);
+            slot->acked = false;
+            slot->resend = false;
+            slot->sent_time = now;
+            send_frame(WUART_FLAG_DATA, tx_next++, slot->data, slot->len);
+            return;
         }
     }
-    else if (tx_state == TX_RETRY)
+
+    /*
+     * Acknowledge received frames without data: after half a window, after
+     * a delay, or at once if a frame is missing or the window has opened.
+     */
+    if (ack_pending &&
+        (ack_now ||
+         (rx_unacked >= WUART_RX_WINDOW / 2) ||
+         (SUB_TIME(now, ack_time) > WUART_ACK_DELAY_US)))
     {
-        tx_state = TX_ONGOING;
+        send_frame(0, tx_next, NULL, 0);
+        return;
+    }
 
-        /* Retransmit the previous frame until frame transmission was successful. */
-        tal_tx_frame(tx_buffer, CSMA_UNSLOTTED, true);
+    /* Ask the peer for a window update if its window is closed. */
+    if (((int8_t)(tx_limit - tx_next) <= 0) &&
+        (SUB_TIME(now, tx_probe_time) > WUART_RETRY_TIMEOUT_US))
+    {
+        tx_probe_time = now;
+        send_frame(WUART_FLAG_PROBE, tx_next, NULL, 0);
     }
 }
 
 
 /**
- * @brief Callback that is called if data has been received by trx.
+ * @brief Writes the received frames in order to the SIO
  *
- * @param rx_frame_array Pointer to data array containing received frame
+ * Afterwards the data of frames acknowledged by the peer is echoed to the
+ * SIO, so the entered characters are shown in the terminal program once
+ * they have been transmitted.
+ *
+ * Only as many bytes as the SIO accepts are written, the rest is written
+ * in the next call, so the radio is never blocked by a slow SIO.
  */
-void tal_rx_frame_cb(uint8_t *rx_frame_array)
+static void sio_drain(void)
 {
-    uint8_t rx_payload_len = rx_frame_array[0] - FRAME_OVERHEAD;
-    uint8_t *rx_payload_ptr = rx_frame_array + FRAME_OVERHEAD + LENGTH_FIELD_LEN - FCS_LEN;
-    uint8_t sio_len_rx;
+    rx_slot_t *slot;
+    tx_slot_t *tx_slot;
+
+    while (rx_deliver != rx_next)
+    {
+        slot = &rx_window[rx_deliver & (WUART_RX_WINDOW - 1)];
+
+        rx_deliver_offset += pal_sio_tx(SIO_CHANNEL,
+                                        slot->data + rx_deliver_offset,
+                                        slot->len - rx_deliver_offset);
+
+        if (rx_deliver_offset < slot->len)
+        {
+            break;
+        }
 
-    /* Print received data to terminal program. */
-    bool sio_ongoing = true;
+        slot->len = 0;
+        rx_deliver_offset = 0;
+        rx_deliver++;
+    }
 
-    do
+    /* Print transmitted bytes to terminal program. */
+    while (tx_echo != tx_base)
     {
-        sio_len_rx = pal_sio_tx(SIO_CHANNEL, rx_payload_ptr, rx_payload_len);
+        tx_slot = &tx_window[tx_echo & (WUART_TX_WINDOW - 1)];
 
-        if (sio_len_rx < rx_payload_len)
+        tx_echo_offset += pal_sio_tx(SIO_CHANNEL,
+                                     tx_slot->data + tx_echo_offset,
+                                     tx_slot->len - tx_echo_offset);
+
+        if (tx_echo_offset < tx_slot->len)
         {
-            rx_payload_len -= sio_len_rx;
-            rx_payload_ptr += sio_len_rx;
-            pal_task();
+            break;
         }
-        else
+
+        tx_echo_offset = 0;
+        tx_echo++;
+    }
+
+    /* Tell the peer if the window has opened by half since the last frame. */
+    if (rx_synced &&
+        ((uint8_t)(rx_deliver + WUART_RX_WINDOW - rx_adv_limit) >= WUART_RX_WINDOW / 2))
+    {
+        ack_pending = true;
+        ack_now = true;
+    }
+}
+
+
+/**
+ * @brief Transmits a frame carrying the acknowledgement of the receiver
+ *
+ * @param flags Frame flags (WUART_FLAG_...)
+ * @param seq   Sequence number of the frame
+ * @param data  Data bytes or NULL
+ * @param len   Number of data bytes
+ */
+static void send_frame(uint8_t flags, uint8_t seq, uint8_t *data, uint8_t len)
+{
+    uint8_t *payload = tx_buffer + LENGTH_FIELD_LEN + FRAME_OVERHEAD - FCS_LEN;
+    uint8_t credit = (uint8_t)(rx_deliver + WUART_RX_WINDOW - rx_next);
+    uint8_t sack = 0;
+    uint8_t i;
+
+    /* Frames buffered beyond the first missing one. */
+    for (i = 0; i < 8; i++)
+    {
+        uint8_t rx_seq = rx_next + 1 + i;
+
+        if (((uint8_t)(rx_seq - rx_deliver) < WUART_RX_WINDOW) &&
+            (rx_window[rx_seq & (WUART_RX_WINDOW - 1)].len > 0))
         {
-            sio_ongoing = false;
+            sack |= 1 << i;
         }
-    } while (sio_ongoing);
+    }
+
+    if ((flags & WUART_FLAG_DATA) && !tx_synced)
+    {
+        flags |= WUART_FLAG_SYNC;
+    }
+
+    tx_state = TX_ONGOING;
+    tx_current_seq = seq;
+    tx_current_data = ((flags & WUART_FLAG_DATA) != 0);
+
+    tx_buffer[PL_POS_SEQ_NUM]++;
+
+    /* Update mpdu length within frame. */
+    tx_buffer[0] = FRAME_OVERHEAD + WUART_HDR_LEN + len;
+
+    payload[WUART_POS_FLAGS] = flags;
+    payload[WUART_POS_SEQ] = seq;
+    payload[WUART_POS_ACK] = rx_next;
+    payload[WUART_POS_CREDIT] = credit;
+    payload[WUART_POS_SACK] = sack;
+
+    /*
+     * Note: Usually the MSDU is copied beginning from the end of
+     * the frame. Since the header is always the same for this
+     * application, the start of the MSDU is always the same position.
+     * Therefore the payload copying is done from the beginning.
+     */
+    if (len > 0)
+    {
+        memcpy(payload + WUART_HDR_LEN, data, len);
+    }
+
+    /* The acknowledgement is sent with this frame. */
+    rx_adv_limit = rx_next + credit;
+    ack_pending = false;
+    ack_now = false;
+    rx_unacked = 0;
 
-    pal_led(LED_DATA_RX, LED_TOGGLE);    // indicating data recption
+    tal_tx_frame(tx_buffer, CSMA_UNSLOTTED, true);
 }
 
 
 /**
- * @brief Callback that is called once tx is done.
+ * @brief Processes the acknowledgement of the peer
  *
- * @param status    Status of the transmission procedure
+ * @param ack    Next sequence number expected by the peer
+ * @param credit Number of frames the peer can buffer from ack on
+ * @param sack   Bit i is set if the peer has buffered frame ack + 1 + i
+ * @param now    Current time in microseconds
  */
-void tal_tx_frame_done_cb(retval_t status)
+static void process_ack(uint8_t ack, uint8_t credit, uint8_t sack, uint32_t now)
 {
-    if (status == MAC_SUCCESS)
+    uint8_t i;
+    tx_slot_t *slot;
+
+    /* Ignore outdated acknowledgements. */
+    if ((uint8_t)(ack - tx_base) > (uint8_t)(tx_next - tx_base))
     {
-        uint8_t tx_payload_len = tx_buffer[0] - FRAME_OVERHEAD;
-        uint8_t *tx_payload_ptr = tx_buffer + FRAME_OVERHEAD + LENGTH_FIELD_LEN - FCS_LEN;
-        uint8_t sio_len_tx;
+        return;
+    }
+
+    if (ack != tx_base)
+    {
+        tx_base = ack;
+        tx_synced = true;
+    }
 
-        /* Print transmitted bytes to terminal program. */
-        bool sio_ongoing = true;
+    tx_limit = ack + credit;
 
-        do
+    if (sack == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+        uint8_t seq = ack + 1 + i;
+
+        if ((uint8_t)(seq - tx_base) >= (uint8_t)(tx_next - tx_base))
+        {
+            break;
+        }
+
+        if (sack & (1 << i))
         {
-            sio_len_tx = pal_sio_tx(SIO_CHANNEL, tx_payload_ptr, tx_payload_len);
-
-            if (sio_len_tx < tx_payload_len)
-            {
-                tx_payload_len -= sio_len_tx;
-                tx_payload_ptr += sio_len_tx;
-                pal_task();
-            }
-            else
-            {
-                sio_ongoing = false;
-            }
-        } while (sio_ongoing);
-
-        pal_led(LED_DATA_TX, LED_TOGGLE);    // indicating successfull data transmission
-
-        /* After transmission is completed, allow next transmission. */
-        tx_state = TX_IDLE;
+            tx_window[seq & (WUART_TX_WINDOW - 1)].acked = true;
+        }
+    }
+
+    /*
+     * A later frame has arrived, so the first one is missing; retransmit it
+     * unless it has just been sent again.
+     */
+    slot = &tx_window[tx_base & (WUART_TX_WINDOW - 1)];
+    if ((tx_base != tx_next) &&
+        (SUB_TIME(now, slot->sent_time) > WUART_ACK_DELAY_US))
+    {
+        slot->resend = true;
     }
-    else if (status == MAC_CHANNEL_ACCESS_FAILURE)
+}
+
+
+/**
+ * @brief Stores a received data frame in the receive window
+ *
+ * @param flags Frame flags (WUART_FLAG_...)
+ * @param seq   Sequence number of the frame
+ * @param data  Data bytes
+ * @param len   Number of data bytes
+ * @param now   Current time in microseconds
+ */
+static void process_data(uint8_t flags, uint8_t seq, uint8_t *data,
+                         uint8_t len, uint32_t now)
+{
+    uint8_t offset;
+    rx_slot_t *slot;
+
     /*
-     * Channel access failure is the only transmission failure that is handled
-     * within this application.
-     * If other status codes shall be handled, such as MAC_NO_ACK, this is probably
-     * the wrong application on the wrong layer.
-     *
-     * For absolutely reliable transmission, please use a MAC or TAL based
-     * application. The Tiny-TAL is not designed for such a purpose.
-     *
-     * In case of channel access failure the frame is retried.
+     * Follow the sequence numbers of the peer after a restart of either
+     * node; a retransmission of the frame received last is no restart.
      */
+    if (!rx_synced ||
+        ((flags & WUART_FLAG_SYNC) && (seq != rx_next) && (seq != (uint8_t)(rx_next - 1))))
+    {
+        for (offset = 0; offset < WUART_RX_WINDOW; offset++)
+        {
+            rx_window[offset].len = 0;
+        }
+        rx_deliver = seq;
+        rx_deliver_offset = 0;
+        rx_next = seq;
+        rx_synced = true;
+    }
+
+    ack_pending = true;
+    if (rx_unacked++ == 0)
     {
-        /* Transmission was not successful, initiate retry. */
-        tx_state = TX_RETRY;
+        ack_time = now;
+    }
+
+    /* Duplicate, or no space to buffer the frame */
+    offset = seq - rx_next;
+    if (offset >= (uint8_t)(rx_deliver + WUART_RX_WINDOW - rx_next))
+    {
+        ack_now = true;
+        return;
+    }
+
+    slot = &rx_window[seq & (WUART_RX_WINDOW - 1)];
+    if (slot->len == 0)
+    {
+        memcpy(slot->data, data, len);
+        slot->len = len;
+    }
+
+    if (offset == 0)
+    {
+        while (((uint8_t)(rx_next - rx_deliver) < WUART_RX_WINDOW) &&
+               (rx_window[rx_next & (WUART_RX_WINDOW - 1)].len > 0))
+        {
+            rx_next++;
+        }
     }
     else
     {
-        /*
-         * Other transmission status codes are not handled
-         * within this application.
-         * The transmission is considered as beeing completed for this frame.
-         */
-        tx_state = TX_IDLE;
+        /* A frame is missing, let the peer retransmit it. */
+        ack_now = true;
+    }
+}
+
+
+/**
+ * @brief Callback that is called if data has been received by trx.
+ *
+ * The frame is only stored here; it is written to the SIO by app_task().
+ *
+ * @param rx_frame_array Pointer to data array containing received frame
+ */
+void tal_rx_frame_cb(uint8_t *rx_frame_array)
+{
+    uint8_t *rx_payload_ptr = rx_frame_array + FRAME_OVERHEAD + LENGTH_FIELD_LEN - FCS_LEN;
+    uint8_t rx_data_len;
+    uint32_t now;
+
+    if ((rx_frame_array[0] < FRAME_OVERHEAD + WUART_HDR_LEN) ||
+        (rx_frame_array[0] > FRAME_OVERHEAD + WUART_HDR_LEN + WUART_MAX_FRAME_DATA))
+    {
+        return;
+    }
+
+    rx_data_len = rx_frame_array[0] - FRAME_OVERHEAD - WUART_HDR_LEN;
+
+    pal_get_current_time(&now);
+
+    process_ack(rx_payload_ptr[WUART_POS_ACK],
+                rx_payload_ptr[WUART_POS_CREDIT],
+                rx_payload_ptr[WUART_POS_SACK],
+                now);
+
+    if ((rx_payload_ptr[WUART_POS_FLAGS] & WUART_FLAG_DATA) && (rx_data_len > 0))
+    {
+        process_data(rx_payload_ptr[WUART_POS_FLAGS],
+                     rx_payload_ptr[WUART_POS_SEQ],
+                     rx_payload_ptr + WUART_HDR_LEN,
+                     rx_data_len,
+                     now);
+
+        pal_led(LED_DATA_RX, LED_TOGGLE);    // indicating data recption
+    }
+
+    if (rx_payload_ptr[WUART_POS_FLAGS] & WUART_FLAG_PROBE)
+    {
+        ack_pending = true;
+        ack_now = true;
+    }
+}
+
+
+/**
+ * @brief Callback that is called once tx is done.
+ *
+ * @param status    Status of the transmission procedure
+ */
+void tal_tx_frame_done_cb(retval_t status)
+{
+    tx_state = TX_IDLE;
+
+    if (status == MAC_SUCCESS)
+    {
+        if (tx_current_data)
+        {
+            pal_led(LED_DATA_TX, LED_TOGGLE);    // indicating successfull data transmission
+        }
+        return;
+    }
+
+    if ((status == MAC_CHANNEL_ACCESS_FAILURE) && tx_current_data)
+    {
+        /* In case of channel access failure the frame is retried at once. */
+        tx_window[tx_current_seq & (WUART_TX_WINDOW - 1)].resend = true;
+    }
+    /*
+     * Other failures, like MAC_NO_ACK, are left to the retransmission
+     * timeout, so that an absent peer is not flooded with frames.
+     */
+
+    /* The acknowledgement carried by the frame is sent again after a delay. */
+    if (rx_synced)
+    {
+        ack_pending = true;
+        rx_unacked = 1;
+        pal_get_current_time(&ack_time);
     }
 }
 
@@ -380,6 +772,13 @@ static void configure_frame_sending(void)
     /* Set proper channel. */
     temp_value_8 = DEFAULT_CHANNEL;
     tal_pib_set(phyCurrentChannel, (pib_value_t *)&temp_value_8);
+
+    /* Set proper channel page, e.g. a high data rate. */
+    temp_value_8 = DEFAULT_CHANNEL_PAGE;
+    tal_pib_set(phyCurrentPage, (pib_value_t *)&temp_value_8);
+
+    /* Until the peer has answered, one frame may be sent. */
+    tx_limit = tx_next + 1;
 }
 
 /* EOF */
@@ -790,7 +790,7 @@
  *
  * - @em Type: Integer
  * - @em Range: 0x00000000 - 0xFFFFFFFF
- * - @em Default: 0xFFFFFFFF
+ * - @em Default: 0x00000000
  */
 #define macFrameCounter                 (0x77)
 
@@ -154,6 +154,17 @@ extern "C" {
     #define MAC_SCAN_SUPPORT                        (0)
 #endif
 
+/*
+ * The fast scan (compile switch MAC_FAST_SCAN) shortens active and passive
+ * scans only.
+ */
+#if (defined(MAC_FAST_SCAN) && \
+     ((MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1) || (MAC_SCAN_PASSIVE_REQUEST_CONFIRM == 1)))
+    #define MAC_FAST_SCAN_SUPPORT                   (1)
+#else
+    #define MAC_FAST_SCAN_SUPPORT                   (0)
+#endif
+
 /*
  * Some sanity checks are done here to prevent having configurations
  * that might violate the standard or lead to undefined behaviour
@@ -55,11 +55,17 @@
  * Additional octets for the length of the frame, the LQI
  * and the ED value are required.
  */
+/*
+ * A build for a target with wider pointers or stricter alignment, like a
+ * host computer, defines the size of mcps_data_ind_t on its own.
+ */
+#ifndef MCPS_DATA_IND_SIZE
 #ifdef MAC_SECURITY_ZIP
     #define MCPS_DATA_IND_SIZE  (32 + 3)    /* Size of mcps_data_ind_t incl. security for ZIP */
 #else   /* No Security */
     #define MCPS_DATA_IND_SIZE  (32)        /* Size of mcps_data_ind_t w/o security */
 #endif  /* MAC_SECURITY_ZIP */
+#endif  /* MCPS_DATA_IND_SIZE */
 
 #if ((PAL_GENERIC_TYPE == AVR) || (PAL_GENERIC_TYPE == XMEGA) || (PAL_GENERIC_TYPE == MEGA_RF))
 /*
@@ -0,0 +1,105 @@
+/**
+ * @file symbol_time.h
+ *
+ * @brief Integer arithmetic for symbol and backoff period based timing
+ *
+ * The timing of slotted CSMA-CA and of the beacon tracking is based on
+ * symbols and on backoff periods of aUnitBackoffPeriod (20) symbols.
+ * Dividing a 32 bit value by such a constant results in a library call on
+ * 8 bit MCUs that takes several hundred cycles. The functions provided here
+ * replace these divisions by shift and add sequences using a fixed point
+ * reciprocal of 5; they are exact for the full 32 bit range.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef SYMBOL_TIME_H
+#define SYMBOL_TIME_H
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+
+/* === TYPES =============================================================== */
+
+
+/* === MACROS ============================================================== */
+
+/**
+ * Conversion of backoff periods to symbols, i.e. multiplication by
+ * aUnitBackoffPeriod (20 = 16 + 4)
+ */
+#define CONVERT_BACKOFF_PERIODS_TO_SYMBOLS(periods) \
+    (((uint32_t)(periods) << 4) + ((uint32_t)(periods) << 2))
+
+/* === PROTOTYPES ========================================================== */
+
+/**
+ * @brief Divides a 32 bit value by 5
+ *
+ * The quotient is estimated by the binary expansion of 1/5
+ * (0.001100110011...b) and corrected using the remainder of the estimate,
+ * which is always below 26.
+ *
+ * @param value Dividend
+ *
+ * @return value / 5
+ */
+static inline uint32_t divide_by_5(uint32_t value)
+{
+    uint32_t quotient;
+    uint8_t remainder;
+
+    quotient = (value >> 3) + (value >> 4);
+    quotient += quotient >> 4;
+    quotient += quotient >> 8;
+    quotient += quotient >> 16;
+    remainder = (uint8_t)(value - ((quotient << 2) + quotient));
+
+    return (quotient + (((uint16_t)remainder * 13) >> 6));
+}
+
+
+/**
+ * @brief Converts symbols to complete backoff periods
+ *
+ * @param symbols Duration in symbols
+ *
+ * @return symbols / aUnitBackoffPeriod, rounded down
+ */
+static inline uint32_t convert_symbols_to_backoff_periods(uint32_t symbols)
+{
+    return divide_by_5(symbols >> 2);
+}
+
+
+/**
+ * @brief Converts symbols to backoff periods, rounding up
+ *
+ * @param symbols Duration in symbols
+ *
+ * @return symbols / aUnitBackoffPeriod, rounded up
+ */
+static inline uint32_t convert_symbols_to_backoff_periods_ceil(uint32_t symbols)
+{
+    uint32_t periods = divide_by_5(symbols >> 2);
+
+    if (CONVERT_BACKOFF_PERIODS_TO_SYMBOLS(periods) != symbols)
+    {
+        periods++;
+    }
+
+    return periods;
+}
+
+#endif /* SYMBOL_TIME_H */
+/* EOF */
@@ -0,0 +1,156 @@
+/**
+ * @file tlm.h
+ *
+ * @brief Binary telemetry of the stack
+ *
+ * With the build switch ENABLE_TELEMETRY the MAC, TAL and PAL write an event
+ * record for frame transmissions and receptions, state changes, buffer
+ * exhaustion etc. into a RAM ring (Resources/Telemetry/Src/tlm.c). The
+ * application drains the ring to a serial interface by calling tlm_task()
+ * from its main loop; the host decoder (Resources/Telemetry/HOST) prints the
+ * records as timeline. Without ENABLE_TELEMETRY the macro TLM_EVENT() is
+ * empty, so the hooks do not generate any code.
+ *
+ * This file is shared by the firmware and the host decoder.
+ *
+ * The records are sent in batches:
+ *
+ *     SYNC0 | SYNC1 | COUNT | RECORD (COUNT * TLM_RECORD_LEN) | CHECK
+ *
+ * - COUNT is the number of records, 1 ... TLM_BATCH_MAX_RECORDS.
+ * - Each record consists of the time of the event in us (4 octets),
+ *   the event id (TLM_EV_*), an 8 bit and a 16 bit argument; all fields
+ *   are little endian, see TLM_REC_OFF_*.
+ * - CHECK is the XOR of the octets COUNT ... RECORD.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef TLM_H
+#define TLM_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+
+/* === Macros =============================================================== */
+
+/** First and second octet of a batch */
+#define TLM_SYNC_0                      (0x5A)
+#define TLM_SYNC_1                      (0xC3)
+
+/** Length of the batch header (SYNC0, SYNC1, COUNT) */
+#define TLM_BATCH_HDR_LEN               (3)
+
+/** Maximum number of records of a batch; a batch fits into 255 octets. */
+#define TLM_BATCH_MAX_RECORDS           (31)
+
+/** Length of a record */
+#define TLM_RECORD_LEN                  (8)
+
+/** Offsets of the fields of a record */
+#define TLM_REC_OFF_TIME                (0)
+#define TLM_REC_OFF_ID                  (4)
+#define TLM_REC_OFF_ARG8                (5)
+#define TLM_REC_OFF_ARG16               (6)
+
+/**
+ * Number of records of the ring, a power of two up to 128. Events occurring
+ * while the ring is full are counted and reported by a TLM_EV_LOST record.
+ */
+#ifndef TLM_RING_RECORDS
+#define TLM_RING_RECORDS                (32)
+#endif
+
+/*
+ * Event ids and their arguments (arg8, arg16)
+ */
+/** Events lost due to a full ring (-, number of events) */
+#define TLM_EV_LOST                     (0x00)
+/** MAC message dispatched (message id, -) */
+#define TLM_EV_MAC_DISPATCH             (0x01)
+/** MAC state changed (mac_state, mac_scan_state | mac_sync_state << 8) */
+#define TLM_EV_MAC_STATE                (0x02)
+/** Frame handed to the TAL (PSDU length, csma_mode | frame retry << 8) */
+#define TLM_EV_TX_START                 (0x03)
+/** Transmission finished (status, msg_type) */
+#define TLM_EV_TX_DONE                  (0x04)
+/** Frame uploaded from the transceiver (PSDU length, LQI | ED << 8) */
+#define TLM_EV_RX_FRAME                 (0x05)
+/** Frame with invalid FCS discarded in promiscuous mode (-, -) */
+#define TLM_EV_RX_CRC_ERROR             (0x06)
+/** Buffer allocation failed (requested size, -) */
+#define TLM_EV_BUFFER_EXHAUSTED         (0x07)
+/** Transceiver put to sleep (sleep mode, -) */
+#define TLM_EV_TRX_SLEEP                (0x08)
+/** Transceiver woken up (-, -) */
+#define TLM_EV_TRX_WAKEUP               (0x09)
+/** PAL timer expired (timer id, -) */
+#define TLM_EV_TIMER_EXPIRED            (0x0A)
+/** First event id available for the application */
+#define TLM_EV_USER                     (0x80)
+
+/**
+ * Writes an event record; compiled out without ENABLE_TELEMETRY.
+ */
+#ifdef ENABLE_TELEMETRY
+#define TLM_EVENT(id, arg8, arg16)      tlm_event((id), (uint8_t)(arg8), (uint16_t)(arg16))
+#else
+#define TLM_EVENT(id, arg8, arg16)
+#endif
+
+/* === Types ================================================================ */
+
+
+/* === Externals ============================================================ */
+
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the telemetry
+ *
+ * The serial interface has to be initialized by the application.
+ *
+ * @param sio_unit Serial interface the records are sent to
+ */
+void tlm_init(uint8_t sio_unit);
+
+/**
+ * @brief Writes an event record into the ring
+ *
+ * May be called from interrupt context. Use TLM_EVENT() instead of calling
+ * this function directly.
+ *
+ * @param id Event id
+ * @param arg8 8 bit argument
+ * @param arg16 16 bit argument
+ */
+void tlm_event(uint8_t id, uint8_t arg8, uint16_t arg16);
+
+/**
+ * @brief Passes the records of the ring to the serial interface
+ *
+ * Has to be called from the main loop.
+ */
+void tlm_task(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TLM_H */
+/* EOF */
@@ -30,36 +30,48 @@
 
 /**
  * The maximum number of entries supported in the macKeyTable.
- * This value is mplementation specific.
+ * This value is implementation specific and may be overridden by the build.
  */
+#ifndef MAC_ZIP_MAX_KEY_TABLE_ENTRIES
 #define MAC_ZIP_MAX_KEY_TABLE_ENTRIES           (1)
+#endif
 
 /**
  * The maximum number of entries supported in the macDeviceTable.
- * This value is mplementation specific.
+ * This value is implementation specific and may be overridden by the build.
  */
+#ifndef MAC_ZIP_MAX_DEV_TABLE_ENTRIES
 #define MAC_ZIP_MAX_DEV_TABLE_ENTRIES           (1)
+#endif
 
 /**
  * The maximum number of entries supported in the macSecurityLevelTable.
- * This value is mplementation specific.
+ * This value is implementation specific and may be overridden by the build.
  */
+#ifndef MAC_ZIP_MAX_SEC_LVL_TABLE_ENTRIES
 #define MAC_ZIP_MAX_SEC_LVL_TABLE_ENTRIES       (1)
+#endif
 
 /**
  * The maximum number of entries supported in the KeyIdLookupList
  */
+#ifndef MAC_ZIP_MAX_KEY_ID_LOOKUP_LIST_ENTRIES
 #define MAC_ZIP_MAX_KEY_ID_LOOKUP_LIST_ENTRIES  (1)
+#endif
 
 /**
  * The maximum number of entries supported in the KeyDeviceList
  */
+#ifndef MAC_ZIP_MAX_KEY_DEV_LIST_ENTRIES
 #define MAC_ZIP_MAX_KEY_DEV_LIST_ENTRIES        (1)
+#endif
 
 /**
  * The maximum number of entries supported in the KeyUsageList
  */
+#ifndef MAC_ZIP_MAX_KEY_USAGE_LIST_ENTRIES
 #define MAC_ZIP_MAX_KEY_USAGE_LIST_ENTRIES      (1)
+#endif
 
 /* === Externals ============================================================ */
 
@@ -146,6 +158,112 @@ typedef struct wpan_pandescriptor_tag
 } wpan_pandescriptor_t;
 
 
+#if (MAC_FAST_SCAN_SUPPORT == 1) || defined(DOXYGEN)
+/**
+ * @brief Configuration of the fast active and passive scan
+ *
+ * A configuration with all members set to 0 gives the scan of
+ * IEEE 802.15.4, which dwells on each channel for the full scan duration.
+ *
+ * @ingroup apiMacTypes
+ */
+typedef struct wpan_fast_scan_config_tag
+{
+    /**
+     * ED level below which a channel is skipped without dwelling on it;
+     * 0 disables the ED pre-screen. Only available if ED scans are included
+     * in the build (FFD). An idle coordinator of a nonbeacon-enabled PAN
+     * does not show up in the ED sample, so the threshold should only be
+     * used if the coordinators are known to carry traffic or send beacons
+     * within the ED sample.
+     */
+    uint8_t ed_threshold;
+
+    /**
+     * Duration of the ED pre-screen as ScanDuration (0 .. 14).
+     */
+    uint8_t ed_scan_duration;
+
+    /**
+     * Active scan only: time in symbols after the beacon request at which
+     * a channel without any beacon is left; 0 dwells for the full scan
+     * duration. Coordinators of nonbeacon-enabled PANs answer the beacon
+     * request within a few backoff periods.
+     */
+    uint16_t response_window;
+
+    /**
+     * Number of new PAN descriptors on a channel after which the channel is
+     * left; 0 dwells for the full scan duration.
+     */
+    uint8_t beacons_per_channel;
+
+    /**
+     * Set to true to end the scan at the first acceptable PAN. The channels
+     * not scanned are returned as UnscannedChannels of the scan confirm.
+     */
+    bool stop_at_first_pan;
+
+    /**
+     * PAN Id of an acceptable PAN; 0xFFFF accepts any PAN.
+     */
+    uint16_t pan_id;
+
+    /**
+     * Minimum link quality of an acceptable PAN.
+     */
+    uint8_t min_link_quality;
+
+    /**
+     * Set to true to accept only PANs permitting association.
+     */
+    bool association_permit;
+} wpan_fast_scan_config_t;
+
+
+/**
+ * @brief Report of the last active or passive scan
+ *
+ * @ingroup apiMacTypes
+ */
+typedef struct wpan_fast_scan_report_tag
+{
+    /**
+     * Time in microseconds from the scan request until the scan confirm.
+     */
+    uint32_t scan_time;
+
+    /**
+     * Sum of the full scan durations of the channels covered by the scan,
+     * in microseconds, i.e. the dwell time of a standard scan with the same
+     * result.
+     */
+    uint32_t nominal_time;
+
+    /**
+     * Scan time saved in microseconds, i.e. nominal_time - scan_time; 0 if
+     * the scan took longer.
+     */
+    uint32_t time_saved;
+
+    /**
+     * Number of channels skipped by the ED pre-screen.
+     */
+    uint8_t channels_skipped;
+
+    /**
+     * Number of channels left before the end of the scan duration.
+     */
+    uint8_t channels_ended_early;
+
+    /**
+     * Set to true if the scan ended at an acceptable PAN.
+     */
+    bool stopped_at_pan;
+} wpan_fast_scan_report_t;
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
+
 #ifdef MAC_SECURITY_ZIP
 /**
  * Structure implementing a DeviceDescriptor.
@@ -554,7 +672,9 @@ bool wpan_task(void);
  * @param KeyIndex      Used index of the key; this parameter is only available
  *                      if MAC security is enabled via MAC_SECURITY_ZIP
  *
- * @return true - success; false - buffer not available or queue full.
+ * @return true - success; false - msdu too long (including the auxiliary
+ *         security header and the MIC of a secured frame), buffer not
+ *         available or queue full.
  */
 #if defined(MAC_SECURITY_ZIP) || defined(DOXYGEN)
 bool wpan_mcps_data_req(uint8_t SrcAddrMode,
@@ -769,6 +889,34 @@ bool wpan_mlme_scan_req(uint8_t ScanType,
 
 
 
+#if (MAC_FAST_SCAN_SUPPORT == 1) || defined(DOXYGEN)
+/**
+ * Sets the configuration of the fast scan used by the following active and
+ * passive scans.
+ *
+ * The configuration cannot be changed while a scan is ongoing.
+ *
+ * @param config Pointer to the fast scan configuration
+ *
+ * @return MAC_SUCCESS - configuration set;
+ *         MAC_INVALID_PARAMETER - scan ongoing or ED pre-screen requested,
+ *         but not supported by the build.
+ */
+retval_t wpan_fast_scan_config(const wpan_fast_scan_config_t *config);
+
+
+/**
+ * Gets the report of the last active or passive scan.
+ *
+ * The report is valid once the scan confirm has been delivered.
+ *
+ * @param report Pointer to the structure receiving the report
+ */
+void wpan_fast_scan_report(wpan_fast_scan_report_t *report);
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
+
+
 #if (MAC_START_REQUEST_CONFIRM == 1) || defined(DOXYGEN)
 /**
  * Initiate MLME-START service and have it placed in the MLME-SAP queue.
@@ -861,6 +1009,9 @@ void usr_mcps_data_conf(uint8_t msduHandle,
  * @param msduLength       Number of octets contained in MSDU.
  * @param msdu             Pointer to MSDU.
  * @param mpduLinkQuality  LQI measured during reception of the MPDU.
+ * @param mpduRssi         Received signal strength in dBm measured during reception
+ *                         of the MPDU; this parameter is only available if RSSI
+ *                         reporting is enabled via compile switch ENABLE_RSSI.
  * @param DSN              The DSN of the received data frame.
  * @param Timestamp        The time, in symbols, at which the data were received;
  *                         this parameter is only available if timestamping is enabled
@@ -883,6 +1034,9 @@ void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
                        uint8_t msduLength,
                        uint8_t *msdu,
                        uint8_t mpduLinkQuality,
+    #if defined(ENABLE_RSSI) || defined(DOXYGEN)
+                       int8_t mpduRssi,
+    #endif  /* ENABLE_RSSI */
                        uint8_t DSN,
     #if defined(ENABLE_TSTAMP) || defined(DOXYGEN)
                        uint32_t Timestamp,
@@ -896,6 +1050,9 @@ void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
                        uint8_t msduLength,
                        uint8_t *msdu,
                        uint8_t mpduLinkQuality,
+    #ifdef ENABLE_RSSI
+                       int8_t mpduRssi,
+    #endif  /* ENABLE_RSSI */
     #ifdef ENABLE_TSTAMP
                        uint8_t DSN,
                        uint32_t Timestamp);
@@ -138,6 +138,9 @@ typedef struct parse_tag
 #endif  /* MAC_SECURITY_ZIP */
     uint8_t mac_command;
     uint8_t ppdu_link_quality;
+#ifdef ENABLE_RSSI
+    int8_t ppdu_rssi;
+#endif  /* ENABLE_RSSI */
 #if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
     /*
      * The timestamping is only required for beaconing networks
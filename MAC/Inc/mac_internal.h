@@ -368,6 +368,11 @@ void mac_sleep_trans(void);
 void mac_scan_send_complete(retval_t status);
 #endif /* ((MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1) || (MAC_SCAN_ORPHAN_REQUEST_CONFIRM == 1)) */
 
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+void mac_fast_scan_beacon(bool new_pan, uint16_t pan_id,
+                          uint16_t superframe_spec, uint8_t link_quality);
+#endif /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
 #ifdef BEACON_SUPPORT
 #if (MAC_START_REQUEST_CONFIRM == 1)
 void mac_start_beacon_timer(void);
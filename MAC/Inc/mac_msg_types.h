@@ -187,6 +187,12 @@ typedef struct mcps_data_ind_tag
      * represent lower LQI (see 6.7.8).
      */
     uint8_t mpduLinkQuality;
+#ifdef ENABLE_RSSI
+    /**
+     * Received signal strength in dBm measured during reception of the MPDU.
+     */
+    int8_t mpduRssi;
+#endif  /* ENABLE_RSSI */
     /**
      * The DSN of the received data frame.
      */
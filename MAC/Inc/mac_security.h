@@ -0,0 +1,157 @@
+/**
+ * @file mac_security.h
+ *
+ * @brief Declarations for the IEEE 802.15.4-2006 MAC frame security
+ *
+ * The MAC secures outgoing and unsecures incoming data frames in place
+ * using CCM* of the security tool box (STB). Key and device descriptors are
+ * found via hash indexes over macKeyTable and macDeviceTable, which are
+ * rebuilt after any of these tables has been changed, so that the lookup
+ * and the check of the incoming frame counter do not depend on the table
+ * sizes. Only key identifier mode 1 (macDefaultKeySource and key index) is
+ * supported, as required by the ZigBee IP profile (MAC_SECURITY_ZIP).
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef MAC_SECURITY_H
+#define MAC_SECURITY_H
+
+#if defined(MAC_SECURITY_ZIP) || defined(DOXYGEN)
+
+/* === Includes ============================================================= */
+
+#include "return_val.h"
+#include "mac_api.h"
+#include "mac_data_structures.h"
+
+#if !defined(STB_ON_SAL) && !defined(STB_ARMCRYPTO)
+#error "MAC_SECURITY_ZIP requires the security tool box (STB_ON_SAL or STB_ARMCRYPTO)"
+#endif
+
+/* === Macros =============================================================== */
+
+/* Default values of the MAC security PIB attributes */
+#define macKeyTableEntries_def              (0)
+#define macDeviceTable_def                  (0)
+#define macSecurityLevelTable_def           (0)
+#define macFrameCounter_def                 (0x00000000)
+
+/**
+ * Number of buckets of the hash index over the KeyIdLookupDescriptors of
+ * macKeyTable; has to be a power of two.
+ */
+#ifndef MAC_SEC_KEY_HASH_SIZE
+#define MAC_SEC_KEY_HASH_SIZE               (8)
+#endif
+
+/**
+ * Number of buckets of each hash index over macDeviceTable (one by
+ * extended address, one by PAN-Id and short address); has to be a power
+ * of two.
+ */
+#ifndef MAC_SEC_DEV_HASH_SIZE
+#define MAC_SEC_DEV_HASH_SIZE               (8)
+#endif
+
+/** Length of the Security Control field of the Auxiliary Security Header */
+#define SEC_CTRL_LEN                        (1)
+
+/** Length of the Frame Counter field of the Auxiliary Security Header */
+#define FRAME_COUNTER_LEN                   (4)
+
+/** Length of the Key Identifier field for key identifier mode 1 */
+#define KEY_ID_MODE_1_LEN                   (1)
+
+/** Key identifier mode using macDefaultKeySource and a key index */
+#define KEY_ID_MODE_1                       (1)
+
+/** Length of the Auxiliary Security Header for key identifier mode 1 */
+#define AUX_SEC_HDR_LEN                     (SEC_CTRL_LEN + FRAME_COUNTER_LEN + KEY_ID_MODE_1_LEN)
+
+/** Number of octets of a KeyIdLookupDescriptor for key identifier mode 1 */
+#define KEY_LOOKUP_DATA_LEN                 (9)
+
+/** Value of the frame counter after which it may not be used anymore */
+#define FRAME_COUNTER_EXHAUSTED             (0xFFFFFFFF)
+
+/**
+ * Length of the MIC appended to a frame secured with the given security
+ * level (0, 4, 8 or 16 octets).
+ *
+ * A payload to be secured by the MAC has to be placed this number of
+ * octets further in front of the buffer end, i.e. at
+ * LARGE_BUFFER_SIZE - FCS_LEN - MAC_SEC_MIC_LEN(SecurityLevel) - msduLength,
+ * so that the MIC can be appended in place.
+ */
+#define MAC_SEC_MIC_LEN(sec_level) \
+    (((sec_level) & 3) ? (1 << (((sec_level) & 3) + 1)) : 0)
+
+/** Security levels that encrypt the payload */
+#define MAC_SEC_ENC_FLAG                    (0x04)
+
+/* === Externals ============================================================ */
+
+/**
+ * Holds the values of all security related PIB attributes.
+ */
+extern mac_sec_pib_t mac_sec_pib;
+
+/**
+ * Holds the values of all security related test PIB attributes.
+ */
+extern mac_sec_test_pib_t mac_sec_test_pib;
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the MAC security PIB attributes
+ *
+ * Empties all security tables, sets the outgoing frame counter to zero
+ * and macDefaultKeySource to all octets 0xFF.
+ */
+void mac_sec_init(void);
+
+/**
+ * @brief Marks the hash indexes over the security tables as outdated
+ *
+ * Has to be called whenever macKeyTable, macDeviceTable, their number of
+ * entries or macDefaultKeySource are changed. The indexes are rebuilt
+ * on the next secured frame.
+ */
+void mac_sec_tables_changed(void);
+
+/**
+ * @brief Checks the security level of an incoming unsecured frame
+ *
+ * @param mac_parse_data Parsed MHR of the received frame
+ * @param mac_payload Pointer to the MAC payload of the received frame
+ *
+ * @return MAC_IMPROPER_SECURITY_LEVEL if macSecurityLevelTable requires
+ *         the frame to be secured and the sender is not exempt;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t mac_check_unsecured_frame(parse_t *mac_parse_data,
+                                   uint8_t *mac_payload);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* #if defined(MAC_SECURITY_ZIP) || defined(DOXYGEN) */
+
+#endif /* MAC_SECURITY_H */
+/* EOF */
@@ -33,6 +33,7 @@
 #include "mac_internal.h"
 #include "mac.h"
 #include "mac_build_config.h"
+#include "tlm.h"
 #ifdef MAC_SECURITY_ZIP
 #include "mac_security.h"
 #endif  /* MAC_SECURITY_ZIP */
@@ -323,6 +324,14 @@ queue_t broadcast_q;
 queue_t indirect_data_q;
 #endif /* (MAC_INDIRECT_DATA_FFD == 1) */
 
+#ifdef ENABLE_TELEMETRY
+/**
+ * MAC state and scan/sync states last reported to the telemetry.
+ */
+static uint8_t tlm_mac_state;
+static uint16_t tlm_mac_sub_states;
+#endif  /* ENABLE_TELEMETRY */
+
 /* === Prototypes =========================================================== */
 
 
@@ -376,6 +385,20 @@ bool mac_task(void)
         }
     }
 
+#ifdef ENABLE_TELEMETRY
+    {
+        /* State changes by timer callbacks are caught here, too. */
+        uint16_t sub_states = (uint16_t)mac_scan_state | ((uint16_t)mac_sync_state << 8);
+
+        if ((mac_state != tlm_mac_state) || (sub_states != tlm_mac_sub_states))
+        {
+            tlm_mac_state = mac_state;
+            tlm_mac_sub_states = sub_states;
+            TLM_EVENT(TLM_EV_MAC_STATE, mac_state, sub_states);
+        }
+    }
+#endif  /* ENABLE_TELEMETRY */
+
     return processed_event;
 }
 
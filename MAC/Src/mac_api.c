@@ -32,6 +32,9 @@
 #include "mac_build_config.h"
 #include "pal.h"
 #include "mac_internal.h"
+#ifdef MAC_SECURITY_ZIP
+#include "mac_security.h"
+#endif  /* MAC_SECURITY_ZIP */
 
 /* === Types =============================================================== */
 
@@ -127,6 +130,20 @@ bool wpan_mcps_data_req(uint8_t SrcAddrMode,
         return false;
     }
 
+#ifdef MAC_SECURITY_ZIP
+    /*
+     * A secured frame carries the Auxiliary Security Header and the MIC in
+     * addition; the MIC is appended in place behind the payload, so a longer
+     * payload would overwrite the request parameters in front of it.
+     */
+    if ((SecurityLevel != 0) &&
+        (((uint16_t)msduLength + AUX_SEC_HDR_LEN + MAC_SEC_MIC_LEN(SecurityLevel)) >
+         aMaxMACPayloadSize))
+    {
+        return false;
+    }
+#endif  /* MAC_SECURITY_ZIP */
+
     /* Allocate a large buffer for mcps data request */
     buffer_header = bmm_buffer_alloc(LARGE_BUFFER_SIZE);
 
@@ -174,6 +191,11 @@ bool wpan_mcps_data_req(uint8_t SrcAddrMode,
 
     /* Find the position where the data payload is to be updated */
     payload_pos = ((uint8_t *)mcps_data_req) + (LARGE_BUFFER_SIZE - FCS_LEN - msduLength);
+#ifdef MAC_SECURITY_ZIP
+    /* Leave space for the MIC, which is appended in place. */
+    payload_pos -= MAC_SEC_MIC_LEN(SecurityLevel);
+#endif  /* MAC_SECURITY_ZIP */
+    ASSERT(payload_pos >= (uint8_t *)(mcps_data_req + 1));
 
     /* Copy the payload to the end of buffer */
     memcpy(payload_pos, msdu, msduLength);
@@ -78,6 +78,9 @@ void mcps_data_ind(uint8_t *m)
                       pmsg->msduLength,
                       pmsg->msdu,
                       pmsg->mpduLinkQuality,
+    #ifdef ENABLE_RSSI
+                      pmsg->mpduRssi,
+    #endif  /* ENABLE_RSSI */
                       pmsg->DSN,
     #ifdef ENABLE_TSTAMP
                       pmsg->Timestamp,
@@ -91,6 +94,9 @@ void mcps_data_ind(uint8_t *m)
                       pmsg->msduLength,
                       pmsg->msdu,
                       pmsg->mpduLinkQuality,
+    #ifdef ENABLE_RSSI
+                      pmsg->mpduRssi,
+    #endif  /* ENABLE_RSSI */
     #ifdef ENABLE_TSTAMP
                       pmsg->DSN,
                       pmsg->Timestamp);
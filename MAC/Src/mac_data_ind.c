@@ -41,6 +41,9 @@
 #include "mac.h"
 #include "mac_config.h"
 #include "mac_build_config.h"
+#ifdef MAC_SECURITY_ZIP
+#include "mac_security.h"
+#endif  /* MAC_SECURITY_ZIP */
 
 /* === Macros =============================================================== */
 
@@ -103,6 +106,9 @@ void mac_process_tal_data_ind(uint8_t *msg)
 
     /* First extract LQI since this is already needed in Promiscuous Mode. */
     mac_parse_data.ppdu_link_quality = frameptr->mpdu[mac_parse_data.mpdu_length + LQI_LEN];
+#ifdef ENABLE_RSSI
+    mac_parse_data.ppdu_rssi = frameptr->rssi;
+#endif  /* ENABLE_RSSI */
 
 #ifdef PROMISCUOUS_MODE
     if (tal_pib_PromiscuousMode)
@@ -854,25 +860,40 @@ static bool parse_mpdu(frame_info_t *rx_frame_ptr)
 
     mac_parse_data.frame_type = FCF_GET_FRAMETYPE(fcf);
 
+    payload_index = 0;
+
+#ifdef MAC_SECURITY_ZIP
+    if (fcf & FCF_SECURITY_ENABLED)
+    {
+        /* The frame is decrypted and authenticated in place. */
+        if (MAC_SUCCESS != mac_unsecure(&mac_parse_data,
+                                        &rx_frame_ptr->mpdu[1],
+                                        temp_frame_ptr,
+                                        &payload_index))
+        {
+            return false;
+        }
+
+        /* Skip the Auxiliary Security Header. */
+        temp_frame_ptr += payload_index;
+        payload_index = 0;
+    }
+    else if (MAC_SUCCESS != mac_check_unsecured_frame(&mac_parse_data, temp_frame_ptr))
+    {
+        return false;
+    }
+#endif  /* MAC_SECURITY_ZIP */
+
     if (FCF_FRAMETYPE_MAC_CMD == mac_parse_data.frame_type)
     {
         mac_parse_data.mac_command = *temp_frame_ptr;
     }
 
-    payload_index = 0;
-
 #ifdef BEACON_SUPPORT
         /* The timestamping is only required for beaconing networks. */
     mac_parse_data.time_stamp = rx_frame_ptr->time_stamp;
 #endif  /* BEACON_SUPPORT */
 
-#ifdef MAC_SECURITY_ZIP
-    if (fcf & FCF_SECURITY_ENABLED)
-    {
-        mac_unsecure(&mac_parse_data, &rx_frame_ptr->mpdu[1], temp_frame_ptr, &payload_index);
-    }
-#endif  /* MAC_SECURITY_ZIP */
-
     /* temp_frame_ptr still points to the first octet of the MAC payload. */
     switch (mac_parse_data.frame_type)
     {
@@ -1242,6 +1263,9 @@ static void prom_mode_rx_frame(buffer_t *b_ptr, frame_info_t *f_ptr)
     mdi->DstAddr = 0;
 
     mdi->mpduLinkQuality = mac_parse_data.ppdu_link_quality;
+#ifdef ENABLE_RSSI
+    mdi->mpduRssi = mac_parse_data.ppdu_rssi;
+#endif  /* ENABLE_RSSI */
     mdi->cmdcode = MCPS_DATA_INDICATION;
 
     /* Append MCPS data indication to MAC-NHLE queue */
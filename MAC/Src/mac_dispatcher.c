@@ -34,6 +34,7 @@
 #include "mac.h"
 #include "mac_config.h"
 #include "mac_build_config.h"
+#include "tlm.h"
 
 /* === Macros ============================================================== */
 
@@ -257,6 +258,8 @@ void dispatch_event(uint8_t *event)
          */
         handler_t handler = (handler_t)PGM_READ_WORD(&dispatch_table[buffer_body[CMD_ID_OCTET]]);
 
+        TLM_EVENT(TLM_EV_MAC_DISPATCH, buffer_body[CMD_ID_OCTET], 0);
+
         if (handler != NULL)
         {
             handler(event);
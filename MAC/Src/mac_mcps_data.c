@@ -461,6 +461,9 @@ void mac_process_data_frame(buffer_t *buf_ptr)
             }
 
             mdi->mpduLinkQuality = mac_parse_data.ppdu_link_quality;
+#ifdef ENABLE_RSSI
+            mdi->mpduRssi = mac_parse_data.ppdu_rssi;
+#endif  /* ENABLE_RSSI */
 
 #ifdef MAC_SECURITY_ZIP
             mdi->SecurityLevel = mac_parse_data.sec_ctrl.sec_level;
@@ -576,6 +579,12 @@ static retval_t build_data_frame(mcps_data_req_t *pmdr,
                 pmdr->msduLength - 2; /* Add 2 octets for FCS. */
 
 #ifdef MAC_SECURITY_ZIP
+    /*
+     * The payload of a frame to be secured has been stored in front of
+     * the space for its MIC, see wpan_mcps_data_req().
+     */
+    frame_ptr -= MAC_SEC_MIC_LEN(pmdr->SecurityLevel);
+
     uint8_t *mac_payload_ptr = frame_ptr;
     /*
      * Note: The value of the payload_length parameter will be updated
@@ -585,9 +594,9 @@ static retval_t build_data_frame(mcps_data_req_t *pmdr,
     {
         retval_t build_sec = mac_build_aux_sec_header(&frame_ptr, pmdr, &frame_len);
         if (MAC_SUCCESS != build_sec)
-    {
+        {
             return (build_sec);
-    }
+        }
     }
 #endif  /* MAC_SECURITY_ZIP */
 
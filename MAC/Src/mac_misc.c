@@ -37,6 +37,7 @@
 #include "mac_build_config.h"
 #ifdef MAC_SECURITY_ZIP
 #include "mac_security.h"
+#include "stb.h"
 #endif  /* MAC_SECURITY_ZIP */
 
 /* === Macros =============================================================== */
@@ -97,6 +98,11 @@ retval_t mac_init(void)
         return FAILURE;
     }
 
+#ifdef MAC_SECURITY_ZIP
+    /* Initialize the security tool box used for frame security */
+    stb_init();
+#endif  /* MAC_SECURITY_ZIP */
+
 
     mac_soft_reset(true);
 
@@ -209,14 +215,7 @@ static void do_init_pib(void)
     mac_pib_macRxOnWhenIdle = macRxOnWhenIdle_def;
 
 #ifdef MAC_SECURITY_ZIP
-    /* TODO: Create a specific function for security PIB initialization? */
-    mac_sec_pib.KeyTableEntries = macKeyTableEntries_def;
-    mac_sec_pib.DeviceTableEntries = macDeviceTable_def;
-    mac_sec_pib.SecurityLevelTableEntries = macSecurityLevelTable_def;
-    mac_sec_pib.FrameCounter = macFrameCounter_def;
-
-    mac_sec_test_pib.DefaultKeyEnable = false;
-    mac_sec_test_pib.DefaultSrcAddrEnable = false;
+    mac_sec_init();
 #endif  /* MAC_SECURITY_ZIP */
 
 #ifdef TEST_HARNESS
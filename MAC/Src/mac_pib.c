@@ -704,19 +704,23 @@ retval_t mlme_set(uint8_t attribute, pib_value_t *attribute_value, bool set_trx_
         case macKeyTable:
             /* Todo: The PIB attribute index not handled yet. */
             memcpy(&mac_sec_pib.KeyTable[0], attribute_value, sizeof(mac_key_table_t));
+            mac_sec_tables_changed();
             break;
 
         case macKeyTableEntries:
             mac_sec_pib.KeyTableEntries = attribute_value->pib_value_8bit;
+            mac_sec_tables_changed();
             break;
 
         case macDeviceTable:
             /* Todo: The PIB attribute index not handled yet. */
             memcpy(&mac_sec_pib.DeviceTable[0], attribute_value, sizeof(mac_dev_table_t));
+            mac_sec_tables_changed();
             break;
 
         case macDeviceTableEntries:
             mac_sec_pib.DeviceTableEntries = attribute_value->pib_value_8bit;
+            mac_sec_tables_changed();
             break;
 
         case macSecurityLevelTable:
@@ -735,6 +739,7 @@ retval_t mlme_set(uint8_t attribute, pib_value_t *attribute_value, bool set_trx_
         case macDefaultKeySource:
             /* Key Source length is 8 octets. */
             memcpy(mac_sec_pib.DefaultKeySource, attribute_value, 8);
+            mac_sec_tables_changed();
             break;
 
         case macDefaultKeyEnable:
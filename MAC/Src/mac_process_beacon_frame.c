@@ -169,8 +169,8 @@ void mac_process_beacon_frame(buffer_t *beacon)
                 }
 
                 /* Round up to backoff slot boundary */
-                beacon_length = (beacon_length + aUnitBackoffPeriod - 1) / aUnitBackoffPeriod;
-                beacon_length *= aUnitBackoffPeriod;
+                beacon_length = CONVERT_BACKOFF_PERIODS_TO_SYMBOLS(
+                                    convert_symbols_to_backoff_periods_ceil(beacon_length));
 
                 /*
                  * Slotted CSMA-CA with macBattLifeExt must start within
@@ -311,6 +311,20 @@ void mac_process_beacon_frame(buffer_t *beacon)
                 msc->ResultListSize++;
             }
         }
+
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+        if ((MAC_SCAN_ACTIVE == mac_scan_state) || (MAC_SCAN_PASSIVE == mac_scan_state))
+        {
+            /*
+             * Without macAutoRequest there is no PAN descriptor list, so
+             * each beacon counts as a new PAN.
+             */
+            mac_fast_scan_beacon(!(mac_pib_macAutoRequest && matchflag),
+                                 pand_long.CoordAddrSpec.PANId,
+                                 pand_long.SuperframeSpec,
+                                 pand_long.LinkQuality);
+        }
+#endif /* (MAC_FAST_SCAN_SUPPORT == 1) */
     }
 
 
@@ -34,6 +34,7 @@
 #include "mac.h"
 #include "mac_config.h"
 #include "mac_build_config.h"
+#include "tlm.h"
 
 /* === Macros =============================================================== */
 
@@ -426,6 +427,8 @@ static void mac_process_tal_tx_status(retval_t tx_status,  frame_info_t *frame)
  */
 void tal_tx_frame_done_cb(retval_t status, frame_info_t *frame)
 {
+    TLM_EVENT(TLM_EV_TX_DONE, status, frame->msg_type);
+
     /* Frame transmission completed, set dispatcher to not busy */
     MAKE_MAC_NOT_BUSY();
 
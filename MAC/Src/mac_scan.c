@@ -8,6 +8,10 @@
  * scan. All required timers and frames (beacon request and orphan
  * notification frames) are assembled and their transmission is initiated.
  *
+ * With MAC_FAST_SCAN, active and passive scans may skip channels without
+ * energy, leave a channel before the end of the scan duration and end at
+ * the first acceptable PAN, see wpan_fast_scan_config().
+ *
  * $Id: mac_scan.c 23034 2010-08-20 15:08:57Z sschneid $
  *
  * @author    Atmel Corporation: http://www.atmel.com
@@ -62,6 +66,13 @@
  */
 #define BEAC_REQ_ORPH_NOT_PAYLOAD_LEN       (1)
 
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+/*
+ * Value of fast_scan_screened_channel if no channel has been pre-screened
+ */
+#define NO_CHANNEL                          (0xFF)
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
 /* === Globals ============================================================= */
 
 static uint8_t scan_type;
@@ -74,6 +85,28 @@ static uint8_t scan_duration;
 /* Original PAN-ID before starting of active or passive scan. */
 #endif /* ((MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1) || (MAC_SCAN_PASSIVE_REQUEST_CONFIRM == 1)) */
 
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+/* Fast scan configuration; all 0 gives the standard scan. */
+static wpan_fast_scan_config_t fast_scan_config;
+/* Report of the last active or passive scan */
+static wpan_fast_scan_report_t fast_scan_report;
+/* Time of the scan request */
+static uint32_t fast_scan_start_time;
+/* Channel pre-screened last */
+static uint8_t fast_scan_screened_channel;
+/* Beacons and new PAN descriptors received on the current channel */
+static uint8_t fast_scan_channel_beacons;
+static uint8_t fast_scan_channel_pans;
+/* ED pre-screen of the current channel ongoing */
+static bool fast_scan_screening;
+/* Scan timer runs for the response window of the active scan */
+static bool fast_scan_in_window;
+/* Current channel left before the end of the scan duration */
+static bool fast_scan_ended_early;
+/* Acceptable PAN found, no further channel is scanned */
+static bool fast_scan_stop;
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
 /* === Prototypes ========================================================== */
 
 #if ((MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1) || \
@@ -90,6 +123,18 @@ static void scan_set_complete(retval_t set_status);
 static void scan_clean_up(buffer_t *buf);
 static void scan_proceed(uint8_t scan_type, buffer_t *buf);
 
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+static uint32_t fast_scan_dwell_time(void);
+static void fast_scan_begin(void);
+static void fast_scan_end(mlme_scan_conf_t *msc);
+static void fast_scan_end_dwell(void);
+static bool fast_scan_channel_continue(void);
+#if (MAC_SCAN_ED_REQUEST_CONFIRM == 1)
+static bool fast_scan_prescreen_start(void);
+static void fast_scan_prescreen_done(uint8_t energy_level);
+#endif /* (MAC_SCAN_ED_REQUEST_CONFIRM == 1) */
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
 /* === Implementation ====================================================== */
 
 /*
@@ -138,6 +183,19 @@ static void scan_proceed(uint8_t scan_type, buffer_t *buf)
             }
         }
 #endif /* ((MAC_SCAN_PASSIVE_REQUEST_CONFIRM == 1) || (MAC_SCAN_ACTIVE_REQUEST_CONFIRM == 1)) */
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+        if (
+            ((MAC_SCAN_ACTIVE == mac_scan_state) || (MAC_SCAN_PASSIVE == mac_scan_state)) &&
+            fast_scan_stop
+           )
+        {
+            /*
+             * An acceptable PAN has been found; the remaining channels are
+             * returned as unscanned channels.
+             */
+            break;
+        }
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
 #if (MAC_SCAN_ORPHAN_REQUEST_CONFIRM == 1)
         if (MLME_SCAN_TYPE_ORPHAN == scan_type)
         {
@@ -171,6 +229,13 @@ static void scan_proceed(uint8_t scan_type, buffer_t *buf)
                 mac_scan_state = MAC_SCAN_ORPHAN;
             }
 
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+            fast_scan_channel_beacons = 0;
+            fast_scan_channel_pans = 0;
+            fast_scan_in_window = false;
+            fast_scan_ended_early = false;
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
             /* Set the channel to perform scan */
             set_status = set_tal_pib_internal(phyCurrentChannel,
                                               (void *)&scan_curr_channel);
@@ -245,6 +310,10 @@ static void scan_proceed(uint8_t scan_type, buffer_t *buf)
                     msc->status = MAC_NO_BEACON;
                 }
 
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+                fast_scan_end(msc);
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
                 /* Restore macPANId after active scan completed. */
 #if (DEBUG > 0)
                 set_status =
@@ -280,6 +349,10 @@ static void scan_proceed(uint8_t scan_type, buffer_t *buf)
                 msc->status = MAC_NO_BEACON;
             }
 
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+            fast_scan_end(msc);
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
             /* Restore macPANId after passive scan completed. */
 #if (DEBUG > 0)
             set_status =
@@ -418,6 +491,10 @@ static void mac_awake_scan(buffer_t *scan_buf)
             msc->ResultListSize = 0;
             msc->scan_result_list[0].ed_value[0] = 0;
 
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+            fast_scan_begin();
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
             scan_proceed(scan_type, (buffer_t *)mac_conf_buf_ptr);
             break;
         }
@@ -624,6 +701,14 @@ void scan_set_complete(retval_t set_status)
         case MAC_SCAN_ACTIVE:
             if (MAC_SUCCESS == set_status)
             {
+#if ((MAC_FAST_SCAN_SUPPORT == 1) && (MAC_SCAN_ED_REQUEST_CONFIRM == 1))
+                if (fast_scan_prescreen_start())
+                {
+                    /* Continued once the ED pre-screen is done */
+                    break;
+                }
+#endif  /* ((MAC_FAST_SCAN_SUPPORT == 1) && (MAC_SCAN_ED_REQUEST_CONFIRM == 1)) */
+
                 /*
                  * The TAL switches ON the transmitter while sending a
                  * beacon request, hence the MAC can call send_scan_cmd() to send
@@ -657,7 +742,17 @@ void scan_set_complete(retval_t set_status)
             {
                 if (MAC_SUCCESS == set_status)
                 {
-                    uint8_t status = tal_rx_enable(PHY_RX_ON);
+                    uint8_t status;
+
+#if ((MAC_FAST_SCAN_SUPPORT == 1) && (MAC_SCAN_ED_REQUEST_CONFIRM == 1))
+                    if (fast_scan_prescreen_start())
+                    {
+                        /* Continued once the ED pre-screen is done */
+                        break;
+                    }
+#endif  /* ((MAC_FAST_SCAN_SUPPORT == 1) && (MAC_SCAN_ED_REQUEST_CONFIRM == 1)) */
+
+                    status = tal_rx_enable(PHY_RX_ON);
 
                     if (PHY_RX_ON == status)
                     {
@@ -755,6 +850,16 @@ void mac_scan_send_complete(retval_t status)
         if (MAC_SCAN_ACTIVE == mac_scan_state)
         {
             tmr = MAC_CALCULATE_SYMBOL_TIME_SCANDURATION(scan_duration);
+
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+            if ((fast_scan_config.response_window > 0) &&
+                (fast_scan_config.response_window < tmr))
+            {
+                /* Listen for answers to the beacon request first. */
+                tmr = fast_scan_config.response_window;
+                fast_scan_in_window = true;
+            }
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
         }
         else
         /*
@@ -813,6 +918,14 @@ static void mac_t_scan_duration_cb(void *callback_parameter)
     {
         case MAC_SCAN_ACTIVE:
         case MAC_SCAN_PASSIVE:
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+            if (fast_scan_channel_continue())
+            {
+                break;
+            }
+            /* The channel is done. */
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+            /* fall through */
         case MAC_SCAN_ORPHAN:
             msc->UnscannedChannels &= ~(1UL << scan_curr_channel);
             scan_proceed(scan_type, (buffer_t *)mac_conf_buf_ptr);
@@ -1049,6 +1162,14 @@ void tal_ed_end_cb(uint8_t energy_level)
 {
     MAKE_MAC_NOT_BUSY();
 
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+    if (fast_scan_screening)
+    {
+        fast_scan_prescreen_done(energy_level);
+        return;
+    }
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
     mlme_scan_conf_t *msc;
 
     /*
@@ -1215,6 +1336,311 @@ void mac_process_orphan_realign(buffer_t *buf_ptr)
 } /* mac_process_orphan_realign() */
 #endif /* (MAC_SCAN_ORPHAN_REQUEST_CONFIRM == 1) */
 
+
+#if (MAC_FAST_SCAN_SUPPORT == 1)
+/**
+ * @brief Sets the configuration of the fast scan
+ *
+ * @param config Pointer to the fast scan configuration
+ *
+ * @return MAC_SUCCESS if the configuration is set, MAC_INVALID_PARAMETER if
+ *         a scan is ongoing or the configuration is not supported
+ */
+retval_t wpan_fast_scan_config(const wpan_fast_scan_config_t *config)
+{
+    if (MAC_SCAN_IDLE != mac_scan_state)
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+#if (MAC_SCAN_ED_REQUEST_CONFIRM == 0)
+    /* The ED pre-screen requires the ED scan of the TAL. */
+    if (config->ed_threshold > 0)
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+#endif /* (MAC_SCAN_ED_REQUEST_CONFIRM == 0) */
+
+    if (config->ed_scan_duration > BEACON_NETWORK_MAX_BO)
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    memcpy(&fast_scan_config, config, sizeof(fast_scan_config));
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Gets the report of the last active or passive scan
+ *
+ * @param report Pointer to the structure receiving the report
+ */
+void wpan_fast_scan_report(wpan_fast_scan_report_t *report)
+{
+    memcpy(report, &fast_scan_report, sizeof(fast_scan_report));
+}
+
+
+
+/**
+ * @brief Handles a beacon received during an active or passive scan
+ *
+ * Leaves the current channel once enough PAN descriptors have been
+ * collected on it, and ends the scan if the PAN is acceptable.
+ *
+ * @param new_pan True if the beacon belongs to a PAN not found before
+ * @param pan_id PAN Id of the beacon
+ * @param superframe_spec Superframe specification of the beacon
+ * @param link_quality LQI of the beacon
+ */
+void mac_fast_scan_beacon(bool new_pan, uint16_t pan_id,
+                          uint16_t superframe_spec, uint8_t link_quality)
+{
+    if (fast_scan_channel_beacons < 0xFF)
+    {
+        fast_scan_channel_beacons++;
+    }
+
+    if (!new_pan)
+    {
+        return;
+    }
+
+    if (fast_scan_channel_pans < 0xFF)
+    {
+        fast_scan_channel_pans++;
+    }
+
+    if (fast_scan_config.stop_at_first_pan &&
+        ((BROADCAST == fast_scan_config.pan_id) || (pan_id == fast_scan_config.pan_id)) &&
+        (link_quality >= fast_scan_config.min_link_quality) &&
+        (!fast_scan_config.association_permit ||
+         (superframe_spec & (1U << ASSOC_PERMIT_BIT_POS))))
+    {
+        fast_scan_stop = true;
+        fast_scan_report.stopped_at_pan = true;
+        fast_scan_end_dwell();
+    }
+    else if ((fast_scan_config.beacons_per_channel > 0) &&
+             (fast_scan_channel_pans >= fast_scan_config.beacons_per_channel))
+    {
+        fast_scan_end_dwell();
+    }
+}
+
+
+
+/*
+ * @brief Gets the scan duration of a channel
+ *
+ * @return Scan duration in us
+ */
+static uint32_t fast_scan_dwell_time(void)
+{
+    return TAL_CONVERT_SYMBOLS_TO_US(MAC_CALCULATE_SYMBOL_TIME_SCANDURATION(scan_duration));
+}
+
+
+
+/*
+ * @brief Starts the report of an active or passive scan
+ */
+static void fast_scan_begin(void)
+{
+    memset(&fast_scan_report, 0, sizeof(fast_scan_report));
+    pal_get_current_time(&fast_scan_start_time);
+
+    fast_scan_screened_channel = NO_CHANNEL;
+    fast_scan_screening = false;
+    fast_scan_stop = false;
+}
+
+
+
+/*
+ * @brief Completes the report of an active or passive scan
+ *
+ * @param msc Scan confirm
+ */
+static void fast_scan_end(mlme_scan_conf_t *msc)
+{
+    uint32_t now;
+
+    if (fast_scan_stop)
+    {
+        /*
+         * A standard scan would have dwelt on the unscanned channels as
+         * well.
+         */
+        uint32_t channels = msc->UnscannedChannels;
+
+        for (; channels != 0; channels &= channels - 1)
+        {
+            fast_scan_report.nominal_time += fast_scan_dwell_time();
+        }
+
+        fast_scan_stop = false;
+    }
+
+    pal_get_current_time(&now);
+    fast_scan_report.scan_time = pal_sub_time_us(now, fast_scan_start_time);
+
+    if (fast_scan_report.nominal_time > fast_scan_report.scan_time)
+    {
+        fast_scan_report.time_saved =
+            fast_scan_report.nominal_time - fast_scan_report.scan_time;
+    }
+}
+
+
+
+/*
+ * @brief Leaves the current channel before the end of the scan duration
+ *
+ * The scan timer is restarted with the minimum timeout, so the scan
+ * proceeds from the timer callback, after the received beacon has been
+ * processed.
+ */
+static void fast_scan_end_dwell(void)
+{
+    if (fast_scan_ended_early || !pal_is_timer_running(T_Scan_Duration))
+    {
+        return;
+    }
+
+    fast_scan_ended_early = true;
+
+    pal_timer_stop(T_Scan_Duration);
+
+#if (DEBUG > 0)
+    retval_t timer_status =
+#endif
+    pal_timer_start(T_Scan_Duration,
+                    MIN_TIMEOUT,
+                    TIMEOUT_RELATIVE,
+                    (FUNC_PTR)mac_t_scan_duration_cb,
+                    NULL);
+#if (DEBUG > 0)
+    ASSERT(MAC_SUCCESS == timer_status);
+#endif
+}
+
+
+
+/*
+ * @brief Decides at the expiry of the scan timer whether to stay on the
+ *        current channel
+ *
+ * At the end of the response window of an active scan, the MAC stays on a
+ * channel where beacons have been received until the end of the scan
+ * duration.
+ *
+ * @return true if the scan timer has been restarted for the current channel
+ */
+static bool fast_scan_channel_continue(void)
+{
+    if (fast_scan_in_window)
+    {
+        fast_scan_in_window = false;
+
+        if (0 == fast_scan_channel_beacons)
+        {
+            /* No coordinator answered the beacon request. */
+            fast_scan_ended_early = true;
+        }
+        else if (!fast_scan_ended_early)
+        {
+            uint32_t tmr = MAC_CALCULATE_SYMBOL_TIME_SCANDURATION(scan_duration) -
+                           fast_scan_config.response_window;
+
+            if (MAC_SUCCESS == pal_timer_start(T_Scan_Duration,
+                                               TAL_CONVERT_SYMBOLS_TO_US(tmr),
+                                               TIMEOUT_RELATIVE,
+                                               (FUNC_PTR)mac_t_scan_duration_cb,
+                                               NULL))
+            {
+                return true;
+            }
+
+            /* Remaining scan duration too short for the timer */
+            fast_scan_ended_early = true;
+        }
+    }
+
+    fast_scan_report.nominal_time += fast_scan_dwell_time();
+    if (fast_scan_ended_early)
+    {
+        fast_scan_report.channels_ended_early++;
+    }
+
+    return false;
+}
+
+
+
+#if (MAC_SCAN_ED_REQUEST_CONFIRM == 1)
+/*
+ * @brief Starts the ED pre-screen of the current channel
+ *
+ * @return true if the ED pre-screen has been started, false if the channel
+ *         is scanned right away
+ */
+static bool fast_scan_prescreen_start(void)
+{
+    if ((0 == fast_scan_config.ed_threshold) ||
+        (fast_scan_screened_channel == scan_curr_channel))
+    {
+        return false;
+    }
+
+    fast_scan_screened_channel = scan_curr_channel;
+
+    if (MAC_SUCCESS != tal_ed_start(fast_scan_config.ed_scan_duration))
+    {
+        return false;
+    }
+
+    MAKE_MAC_BUSY();
+    fast_scan_screening = true;
+
+    return true;
+}
+
+
+
+/*
+ * @brief Continues the scan after the ED pre-screen of the current channel
+ *
+ * @param energy_level Maximum energy on the channel
+ */
+static void fast_scan_prescreen_done(uint8_t energy_level)
+{
+    fast_scan_screening = false;
+
+    if (energy_level < fast_scan_config.ed_threshold)
+    {
+        mlme_scan_conf_t *msc =
+            (mlme_scan_conf_t *)BMM_BUFFER_POINTER((buffer_t *)mac_conf_buf_ptr);
+
+        /* No energy on the channel, it is skipped. */
+        fast_scan_report.nominal_time += fast_scan_dwell_time();
+        fast_scan_report.channels_skipped++;
+
+        msc->UnscannedChannels &= ~(1UL << scan_curr_channel);
+        scan_proceed(scan_type, (buffer_t *)mac_conf_buf_ptr);
+    }
+    else
+    {
+        /* Scan the channel as usual. */
+        scan_set_complete(MAC_SUCCESS);
+    }
+}
+#endif /* (MAC_SCAN_ED_REQUEST_CONFIRM == 1) */
+#endif  /* (MAC_FAST_SCAN_SUPPORT == 1) */
+
 #endif /* (MAC_SCAN_SUPPORT == 1) */
 
 /* EOF */
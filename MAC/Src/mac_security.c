@@ -0,0 +1,867 @@
+/**
+ * @file mac_security.c
+ *
+ * @brief Implements the IEEE 802.15.4-2006 MAC frame security.
+ *
+ * Outgoing data frames are secured and incoming frames are unsecured in
+ * place in the frame buffer using stb_ccm_secure(). The KeyIdLookupDescriptors
+ * of macKeyTable and the entries of macDeviceTable are reached via chained
+ * hash indexes, so that the key lookup and the check of the incoming frame
+ * counter take constant time for any table size.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifdef MAC_SECURITY_ZIP
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "pal.h"
+#include "return_val.h"
+#include "bmm.h"
+#include "qmm.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "mac_msg_const.h"
+#include "mac_api.h"
+#include "mac_msg_types.h"
+#include "mac_data_structures.h"
+#include "stack_config.h"
+#include "mac_internal.h"
+#include "mac.h"
+#include "mac_build_config.h"
+#include "mac_security.h"
+#include "stb.h"
+
+/* === Macros =============================================================== */
+
+/* Index value marking the end of a hash chain */
+#define NO_ENTRY                        (0xFF)
+
+/* Number of KeyIdLookupDescriptors that can be indexed */
+#define NO_OF_KEY_LOOKUPS \
+    (MAC_ZIP_MAX_KEY_TABLE_ENTRIES * MAC_ZIP_MAX_KEY_ID_LOOKUP_LIST_ENTRIES)
+
+#if (NO_OF_KEY_LOOKUPS >= NO_ENTRY) || (MAC_ZIP_MAX_DEV_TABLE_ENTRIES >= NO_ENTRY)
+#error "MAC security tables are too large to be indexed"
+#endif
+
+#if (MAC_SEC_KEY_HASH_SIZE & (MAC_SEC_KEY_HASH_SIZE - 1)) || \
+    (MAC_SEC_DEV_HASH_SIZE & (MAC_SEC_DEV_HASH_SIZE - 1))
+#error "MAC_SEC_KEY_HASH_SIZE and MAC_SEC_DEV_HASH_SIZE have to be powers of two"
+#endif
+
+/* Position of the key identifier mode in the Security Control field */
+#define SEC_CTRL_KEY_ID_MODE_POS        (3)
+
+/* LookupDataSize value of a 9 octet KeyIdLookupDescriptor */
+#define LOOKUP_DATA_SIZE_9              (0x01)
+
+/* ShortAddress values of a device that is not addressed by a short address */
+#define NO_SHORT_ADDRESS                (0xFFFE)
+
+/* Positions within the CCM* nonce, see IEEE 802.15.4-2006 7.6.3.2 */
+#define NONCE_POS_EXT_ADDR              (1)
+#define NONCE_POS_FRAME_COUNTER         (9)
+#define NONCE_POS_SEC_LEVEL             (13)
+
+/* DeviceDescriptor addressed by its handle */
+#define DEVICE(handle)                  (&mac_sec_pib.DeviceTable[handle].DeviceDescriptor[0])
+
+/* === Globals ============================================================= */
+
+/* Heads and links of the hash chains over the KeyIdLookupDescriptors */
+static uint8_t key_hash[MAC_SEC_KEY_HASH_SIZE];
+static uint8_t key_hash_next[NO_OF_KEY_LOOKUPS];
+
+/* Heads and links of the hash chains over the devices by extended address */
+static uint8_t dev_ext_hash[MAC_SEC_DEV_HASH_SIZE];
+static uint8_t dev_ext_hash_next[MAC_ZIP_MAX_DEV_TABLE_ENTRIES];
+
+/* Heads and links of the hash chains over the devices by short address */
+static uint8_t dev_short_hash[MAC_SEC_DEV_HASH_SIZE];
+static uint8_t dev_short_hash_next[MAC_ZIP_MAX_DEV_TABLE_ENTRIES];
+
+/* The hash indexes match the current security tables. */
+static bool sec_index_valid;
+
+/* === Prototypes =========================================================== */
+
+static uint8_t hash_octets(uint8_t *data, uint8_t len);
+static uint8_t hash_short_addr(uint16_t pan_id, uint16_t short_addr);
+static void rebuild_index(void);
+static mac_key_table_t *find_key(uint8_t key_index);
+static uint8_t find_device(parse_t *mac_parse_data);
+static mac_key_device_desc_t *find_key_device(mac_key_table_t *key_desc,
+                                              uint8_t dev_handle);
+static bool key_usage_allowed(mac_key_table_t *key_desc,
+                              uint8_t frame_type,
+                              uint8_t cmd_id);
+static retval_t check_sec_level(uint8_t frame_type,
+                                uint8_t cmd_id,
+                                uint8_t sec_level,
+                                mac_device_desc_t *device);
+static void build_nonce(uint8_t *nonce,
+                        uint8_t *ext_addr,
+                        uint32_t frame_counter,
+                        uint8_t sec_level);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the MAC security PIB attributes
+ */
+void mac_sec_init(void)
+{
+    mac_sec_pib.KeyTableEntries = macKeyTableEntries_def;
+    mac_sec_pib.DeviceTableEntries = macDeviceTable_def;
+    mac_sec_pib.SecurityLevelTableEntries = macSecurityLevelTable_def;
+    mac_sec_pib.FrameCounter = macFrameCounter_def;
+    memset(mac_sec_pib.DefaultKeySource, 0xFF, sizeof(mac_sec_pib.DefaultKeySource));
+
+    mac_sec_test_pib.DefaultKeyEnable = false;
+    mac_sec_test_pib.DefaultSrcAddrEnable = false;
+
+    sec_index_valid = false;
+}
+
+
+
+/**
+ * @brief Marks the hash indexes over the security tables as outdated
+ */
+void mac_sec_tables_changed(void)
+{
+    sec_index_valid = false;
+}
+
+
+
+/**
+ * @brief Builds the Auxiliary Security Header of an outgoing data frame
+ *
+ * The header is written in front of the payload. The outgoing frame
+ * counter is written to the header, but only incremented once the frame
+ * has been secured by mac_secure().
+ *
+ * @param[in,out] frame_ptr Pointer to the first octet of the payload;
+ *                          updated to the first octet of the header
+ * @param pmdr Pointer to the MCPS-DATA.request parameters
+ * @param[in,out] frame_len Length of the frame; updated by the length of
+ *                          the header and of the MIC
+ *
+ * @return MAC_INVALID_PARAMETER if the security level is invalid;
+ *         MAC_UNSUPPORTED_SECURITY if macSecurityEnabled is false or the
+ *         key identifier mode is not 1;
+ *         MAC_COUNTER_ERROR if the outgoing frame counter is exhausted;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t mac_build_aux_sec_header(uint8_t **frame_ptr, mcps_data_req_t *pmdr,
+                                  uint8_t *frame_len)
+{
+    uint8_t *aux_hdr;
+
+    if (pmdr->SecurityLevel > 7)
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    if (!mac_pib_macSecurityEnabled || (KEY_ID_MODE_1 != pmdr->KeyIdMode))
+    {
+        return MAC_UNSUPPORTED_SECURITY;
+    }
+
+    if (FRAME_COUNTER_EXHAUSTED == mac_sec_pib.FrameCounter)
+    {
+        return MAC_COUNTER_ERROR;
+    }
+
+    *frame_ptr -= AUX_SEC_HDR_LEN;
+    *frame_len += AUX_SEC_HDR_LEN + MAC_SEC_MIC_LEN(pmdr->SecurityLevel);
+
+    aux_hdr = *frame_ptr;
+    aux_hdr[0] = pmdr->SecurityLevel | (KEY_ID_MODE_1 << SEC_CTRL_KEY_ID_MODE_POS);
+    convert_32_bit_to_byte_array(mac_sec_pib.FrameCounter, &aux_hdr[SEC_CTRL_LEN]);
+    aux_hdr[SEC_CTRL_LEN + FRAME_COUNTER_LEN] = pmdr->KeyIndex;
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Secures an outgoing data frame in place
+ *
+ * The frame has to be built completely, including the Auxiliary Security
+ * Header; the MIC is appended directly behind the payload.
+ *
+ * @param frame Frame to be secured
+ * @param mac_payload_ptr Pointer to the first octet of the payload
+ * @param pmdr Pointer to the MCPS-DATA.request parameters
+ *
+ * @return MAC_UNAVAILABLE_KEY if no key is found for the key index;
+ *         MAC_SECURITY_ERROR if the frame could not be secured;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t mac_secure(frame_info_t *frame, uint8_t *mac_payload_ptr,
+                    mcps_data_req_t *pmdr)
+{
+    uint8_t nonce[AES_BLOCKSIZE];
+    uint8_t src_addr[EXT_ADDR_LEN];
+    uint8_t *mhr = &frame->mpdu[1];
+    uint8_t hdr_len = (uint8_t)(mac_payload_ptr - mhr);
+    uint8_t pld_len = pmdr->msduLength;
+    uint8_t *key;
+
+    if (mac_sec_test_pib.DefaultKeyEnable)
+    {
+        key = mac_sec_test_pib.DefaultKey;
+    }
+    else
+    {
+        mac_key_table_t *key_desc = find_key(pmdr->KeyIndex);
+
+        if (NULL == key_desc)
+        {
+            return MAC_UNAVAILABLE_KEY;
+        }
+        key = key_desc->Key;
+    }
+
+    if (mac_sec_test_pib.DefaultSrcAddrEnable)
+    {
+        memcpy(src_addr, mac_sec_test_pib.DefaultSrcAddr, EXT_ADDR_LEN);
+    }
+    else
+    {
+        convert_64_bit_to_byte_array(tal_pib_IeeeAddress, src_addr);
+    }
+    build_nonce(nonce, src_addr, mac_sec_pib.FrameCounter, pmdr->SecurityLevel);
+
+    if (!(pmdr->SecurityLevel & MAC_SEC_ENC_FLAG))
+    {
+        /* The payload is only authenticated. */
+        hdr_len += pld_len;
+        pld_len = 0;
+    }
+
+    /* The transceiver's AES engine is only usable while it is awake. */
+    mac_trx_wakeup();
+
+    if (STB_CCM_OK != stb_ccm_secure(mhr, nonce, key, hdr_len, pld_len,
+                                     pmdr->SecurityLevel, AES_DIR_ENCRYPT))
+    {
+        return MAC_SECURITY_ERROR;
+    }
+
+    mac_sec_pib.FrameCounter++;
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Unsecures an incoming frame in place
+ *
+ * Parses the Auxiliary Security Header into mac_parse_data, checks the
+ * frame against the security tables and the incoming frame counter of its
+ * originator, and decrypts and authenticates it. On success the MAC payload
+ * length is reduced by the header and the MIC.
+ *
+ * @param mac_parse_data Parsed MHR of the received frame
+ * @param mpdu Pointer to the first octet of the MHR
+ * @param mac_payload Pointer to the first octet following the addressing
+ *                    fields, i.e. to the Auxiliary Security Header
+ * @param[out] payload_index Length of the Auxiliary Security Header, i.e.
+ *                           index of the first payload octet in mac_payload
+ *
+ * @return MAC_UNSUPPORTED_LEGACY if the frame is secured by 802.15.4-2003;
+ *         MAC_UNSUPPORTED_SECURITY if macSecurityEnabled is false, the
+ *         security level is 0 or the key identifier mode is not 1;
+ *         MAC_UNAVAILABLE_KEY if the key or the originator is unknown or
+ *         the originator is blacklisted;
+ *         MAC_IMPROPER_SECURITY_LEVEL if the security level is too low;
+ *         MAC_IMPROPER_KEY_TYPE if the key may not be used for the frame;
+ *         MAC_COUNTER_ERROR if the frame counter is not fresh;
+ *         MAC_SECURITY_ERROR if the frame is too short or its MIC is wrong;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t mac_unsecure(parse_t *mac_parse_data, uint8_t *mpdu,
+                      uint8_t *mac_payload, uint8_t *payload_index)
+{
+    uint8_t nonce[AES_BLOCKSIZE];
+    uint8_t src_addr[EXT_ADDR_LEN];
+    mac_key_table_t *key_desc = NULL;
+    mac_key_device_desc_t *key_dev = NULL;
+    mac_device_desc_t *device;
+    uint8_t *key;
+    uint8_t dev_handle;
+    uint8_t sec_level;
+    uint8_t mic_len;
+    uint8_t hdr_len;
+    uint8_t pld_len;
+    uint8_t cmd_id = 0;
+    retval_t status;
+
+    if (!(mac_parse_data->fcf & FCF_FRAME_VERSION_2006))
+    {
+        return MAC_UNSUPPORTED_LEGACY;
+    }
+
+    /* Parse the Auxiliary Security Header. */
+    sec_level = mac_payload[0] & 0x07;
+    mac_parse_data->sec_ctrl.sec_level = sec_level;
+    mac_parse_data->sec_ctrl.key_id_mode = (mac_payload[0] >> SEC_CTRL_KEY_ID_MODE_POS) & 0x03;
+
+    if (!mac_pib_macSecurityEnabled || (0 == sec_level) ||
+        (KEY_ID_MODE_1 != mac_parse_data->sec_ctrl.key_id_mode))
+    {
+        return MAC_UNSUPPORTED_SECURITY;
+    }
+
+    mic_len = MAC_SEC_MIC_LEN(sec_level);
+    if (mac_parse_data->mac_payload_length < (AUX_SEC_HDR_LEN + mic_len))
+    {
+        return MAC_SECURITY_ERROR;
+    }
+
+    mac_parse_data->frame_cnt = convert_byte_array_to_32_bit(&mac_payload[SEC_CTRL_LEN]);
+    mac_parse_data->key_id_len = KEY_ID_MODE_1_LEN;
+    mac_parse_data->key_id[0] = mac_payload[SEC_CTRL_LEN + FRAME_COUNTER_LEN];
+    mac_parse_data->mac_payload_length -= AUX_SEC_HDR_LEN + mic_len;
+    *payload_index = AUX_SEC_HDR_LEN;
+
+    if (FCF_FRAMETYPE_MAC_CMD == mac_parse_data->frame_type)
+    {
+        if (0 == mac_parse_data->mac_payload_length)
+        {
+            return MAC_SECURITY_ERROR;
+        }
+        cmd_id = mac_payload[AUX_SEC_HDR_LEN];
+    }
+
+    if (!sec_index_valid)
+    {
+        rebuild_index();
+    }
+
+    /* Find the key and the originator. */
+    if (mac_sec_test_pib.DefaultKeyEnable)
+    {
+        key = mac_sec_test_pib.DefaultKey;
+    }
+    else
+    {
+        key_desc = find_key(mac_parse_data->key_id[0]);
+        if (NULL == key_desc)
+        {
+            return MAC_UNAVAILABLE_KEY;
+        }
+        key = key_desc->Key;
+    }
+
+    dev_handle = find_device(mac_parse_data);
+    if (NO_ENTRY == dev_handle)
+    {
+        return MAC_UNAVAILABLE_KEY;
+    }
+    device = DEVICE(dev_handle);
+
+    if (NULL != key_desc)
+    {
+        key_dev = find_key_device(key_desc, dev_handle);
+        if ((NULL == key_dev) || key_dev->BlackListed)
+        {
+            return MAC_UNAVAILABLE_KEY;
+        }
+    }
+
+    status = check_sec_level(mac_parse_data->frame_type, cmd_id, sec_level, device);
+    if (MAC_SUCCESS != status)
+    {
+        return status;
+    }
+
+    if ((NULL != key_desc) &&
+        !key_usage_allowed(key_desc, mac_parse_data->frame_type, cmd_id))
+    {
+        return MAC_IMPROPER_KEY_TYPE;
+    }
+
+    /* The frame has to be newer than the last one accepted from the device. */
+    if ((FRAME_COUNTER_EXHAUSTED == mac_parse_data->frame_cnt) ||
+        (mac_parse_data->frame_cnt < device->FrameCounter))
+    {
+        return MAC_COUNTER_ERROR;
+    }
+
+    if (mac_sec_test_pib.DefaultSrcAddrEnable)
+    {
+        memcpy(src_addr, mac_sec_test_pib.DefaultSrcAddr, EXT_ADDR_LEN);
+    }
+    else
+    {
+        convert_64_bit_to_byte_array(device->ExtAddress, src_addr);
+    }
+    build_nonce(nonce, src_addr, mac_parse_data->frame_cnt, sec_level);
+
+    hdr_len = (uint8_t)(mac_payload - mpdu) + AUX_SEC_HDR_LEN;
+    pld_len = mac_parse_data->mac_payload_length;
+    if (sec_level & MAC_SEC_ENC_FLAG)
+    {
+        if (FCF_FRAMETYPE_MAC_CMD == mac_parse_data->frame_type)
+        {
+            /* The command frame identifier is not encrypted. */
+            hdr_len++;
+            pld_len--;
+        }
+    }
+    else
+    {
+        /* The payload is only authenticated. */
+        hdr_len += pld_len;
+        pld_len = 0;
+    }
+
+    if (STB_CCM_OK != stb_ccm_secure(mpdu, nonce, key, hdr_len, pld_len,
+                                     sec_level, AES_DIR_DECRYPT))
+    {
+        return MAC_SECURITY_ERROR;
+    }
+
+    device->FrameCounter = mac_parse_data->frame_cnt + 1;
+    if ((FRAME_COUNTER_EXHAUSTED == device->FrameCounter) && (NULL != key_dev))
+    {
+        key_dev->BlackListed = true;
+    }
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Checks the security level of an incoming unsecured frame
+ *
+ * @param mac_parse_data Parsed MHR of the received frame
+ * @param mac_payload Pointer to the MAC payload of the received frame
+ *
+ * @return MAC_IMPROPER_SECURITY_LEVEL if the frame had to be secured;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t mac_check_unsecured_frame(parse_t *mac_parse_data,
+                                   uint8_t *mac_payload)
+{
+    uint8_t dev_handle;
+    uint8_t cmd_id = 0;
+
+    if (!mac_pib_macSecurityEnabled || (0 == mac_sec_pib.SecurityLevelTableEntries))
+    {
+        return MAC_SUCCESS;
+    }
+
+    if ((FCF_FRAMETYPE_MAC_CMD == mac_parse_data->frame_type) &&
+        (mac_parse_data->mac_payload_length > 0))
+    {
+        cmd_id = mac_payload[0];
+    }
+
+    if (!sec_index_valid)
+    {
+        rebuild_index();
+    }
+
+    dev_handle = find_device(mac_parse_data);
+
+    return (check_sec_level(mac_parse_data->frame_type, cmd_id, 0,
+                            (NO_ENTRY == dev_handle) ? NULL : DEVICE(dev_handle)));
+}
+
+
+
+/**
+ * @brief Hashes a sequence of octets
+ *
+ * @param data Octets to be hashed
+ * @param len Number of octets
+ *
+ * @return Hash value; the least significant bits depend on all octets
+ */
+static uint8_t hash_octets(uint8_t *data, uint8_t len)
+{
+    uint8_t hash = 0;
+
+    while (len--)
+    {
+        /* Rotate left by one and add the next octet. */
+        hash = (uint8_t)((hash << 1) | (hash >> 7)) ^ *data++;
+    }
+
+    return hash;
+}
+
+
+
+/**
+ * @brief Hashes a PAN-Id and short address pair
+ *
+ * @param pan_id PAN-Id of the device
+ * @param short_addr Short address of the device
+ *
+ * @return Hash value
+ */
+static uint8_t hash_short_addr(uint16_t pan_id, uint16_t short_addr)
+{
+    uint16_t hash = pan_id ^ short_addr;
+
+    return ((uint8_t)(hash ^ (hash >> 8)));
+}
+
+
+
+/**
+ * @brief Rebuilds the hash indexes over macKeyTable and macDeviceTable
+ */
+static void rebuild_index(void)
+{
+    uint8_t entries;
+    uint8_t lookups;
+    uint8_t i;
+    uint8_t j;
+    uint8_t node;
+    uint8_t bucket;
+
+    memset(key_hash, NO_ENTRY, sizeof(key_hash));
+    memset(dev_ext_hash, NO_ENTRY, sizeof(dev_ext_hash));
+    memset(dev_short_hash, NO_ENTRY, sizeof(dev_short_hash));
+
+    entries = mac_sec_pib.KeyTableEntries;
+    if (entries > MAC_ZIP_MAX_KEY_TABLE_ENTRIES)
+    {
+        entries = MAC_ZIP_MAX_KEY_TABLE_ENTRIES;
+    }
+
+    for (i = 0; i < entries; i++)
+    {
+        mac_key_table_t *key_desc = &mac_sec_pib.KeyTable[i];
+
+        lookups = key_desc->KeyIdLookupListEntries;
+        if (lookups > MAC_ZIP_MAX_KEY_ID_LOOKUP_LIST_ENTRIES)
+        {
+            lookups = MAC_ZIP_MAX_KEY_ID_LOOKUP_LIST_ENTRIES;
+        }
+
+        for (j = 0; j < lookups; j++)
+        {
+            /* Key identifier mode 1 only uses 9 octet lookup data. */
+            if (LOOKUP_DATA_SIZE_9 != key_desc->KeyIdLookupList[j].LookupDataSize)
+            {
+                continue;
+            }
+
+            node = (i * MAC_ZIP_MAX_KEY_ID_LOOKUP_LIST_ENTRIES) + j;
+            bucket = hash_octets(key_desc->KeyIdLookupList[j].LookupData,
+                                 KEY_LOOKUP_DATA_LEN) & (MAC_SEC_KEY_HASH_SIZE - 1);
+            key_hash_next[node] = key_hash[bucket];
+            key_hash[bucket] = node;
+        }
+    }
+
+    entries = mac_sec_pib.DeviceTableEntries;
+    if (entries > MAC_ZIP_MAX_DEV_TABLE_ENTRIES)
+    {
+        entries = MAC_ZIP_MAX_DEV_TABLE_ENTRIES;
+    }
+
+    for (i = 0; i < entries; i++)
+    {
+        mac_device_desc_t *device = DEVICE(i);
+
+        bucket = hash_octets((uint8_t *)&device->ExtAddress,
+                             sizeof(uint64_t)) & (MAC_SEC_DEV_HASH_SIZE - 1);
+        dev_ext_hash_next[i] = dev_ext_hash[bucket];
+        dev_ext_hash[bucket] = i;
+
+        if (device->ShortAddress < NO_SHORT_ADDRESS)
+        {
+            bucket = hash_short_addr(device->PANId,
+                                     device->ShortAddress) & (MAC_SEC_DEV_HASH_SIZE - 1);
+            dev_short_hash_next[i] = dev_short_hash[bucket];
+            dev_short_hash[bucket] = i;
+        }
+    }
+
+    sec_index_valid = true;
+}
+
+
+
+/**
+ * @brief Finds the KeyDescriptor for key identifier mode 1
+ *
+ * The lookup data is macDefaultKeySource followed by the key index.
+ *
+ * @param key_index Key index of the frame
+ *
+ * @return Pointer to the KeyDescriptor, or NULL if no key matches
+ */
+static mac_key_table_t *find_key(uint8_t key_index)
+{
+    uint8_t lookup_data[KEY_LOOKUP_DATA_LEN];
+    mac_key_table_t *key_desc;
+    uint8_t node;
+
+    if (!sec_index_valid)
+    {
+        rebuild_index();
+    }
+
+    memcpy(lookup_data, mac_sec_pib.DefaultKeySource, sizeof(mac_sec_pib.DefaultKeySource));
+    lookup_data[KEY_LOOKUP_DATA_LEN - 1] = key_index;
+
+    node = key_hash[hash_octets(lookup_data, KEY_LOOKUP_DATA_LEN) & (MAC_SEC_KEY_HASH_SIZE - 1)];
+    while (NO_ENTRY != node)
+    {
+        key_desc = &mac_sec_pib.KeyTable[node / MAC_ZIP_MAX_KEY_ID_LOOKUP_LIST_ENTRIES];
+        if (0 == memcmp(key_desc->KeyIdLookupList[node % MAC_ZIP_MAX_KEY_ID_LOOKUP_LIST_ENTRIES].LookupData,
+                        lookup_data, KEY_LOOKUP_DATA_LEN))
+        {
+            return key_desc;
+        }
+        node = key_hash_next[node];
+    }
+
+    return NULL;
+}
+
+
+
+/**
+ * @brief Finds the DeviceDescriptor of the originator of a frame
+ *
+ * @param mac_parse_data Parsed MHR of the received frame
+ *
+ * @return Handle of the DeviceDescriptor, or NO_ENTRY if it is unknown
+ */
+static uint8_t find_device(parse_t *mac_parse_data)
+{
+    mac_device_desc_t *device;
+    uint8_t handle;
+
+    if (FCF_LONG_ADDR == mac_parse_data->src_addr_mode)
+    {
+        uint64_t ext_addr = mac_parse_data->src_addr.long_address;
+
+        handle = dev_ext_hash[hash_octets((uint8_t *)&ext_addr,
+                                          sizeof(uint64_t)) & (MAC_SEC_DEV_HASH_SIZE - 1)];
+        while (NO_ENTRY != handle)
+        {
+            device = DEVICE(handle);
+            if (device->ExtAddress == ext_addr)
+            {
+                break;
+            }
+            handle = dev_ext_hash_next[handle];
+        }
+    }
+    else if (FCF_SHORT_ADDR == mac_parse_data->src_addr_mode)
+    {
+        uint16_t pan_id = mac_parse_data->src_panid;
+        uint16_t short_addr = mac_parse_data->src_addr.short_address;
+
+        handle = dev_short_hash[hash_short_addr(pan_id, short_addr) & (MAC_SEC_DEV_HASH_SIZE - 1)];
+        while (NO_ENTRY != handle)
+        {
+            device = DEVICE(handle);
+            if ((device->PANId == pan_id) && (device->ShortAddress == short_addr))
+            {
+                break;
+            }
+            handle = dev_short_hash_next[handle];
+        }
+    }
+    else
+    {
+        /* Frames without source address are not supported. */
+        handle = NO_ENTRY;
+    }
+
+    return handle;
+}
+
+
+
+/**
+ * @brief Finds the KeyDeviceDescriptor of a device for a key
+ *
+ * @param key_desc KeyDescriptor
+ * @param dev_handle Handle of the DeviceDescriptor
+ *
+ * @return Pointer to the KeyDeviceDescriptor, or NULL if the device may
+ *         not use the key
+ */
+static mac_key_device_desc_t *find_key_device(mac_key_table_t *key_desc,
+                                              uint8_t dev_handle)
+{
+    uint8_t entries = key_desc->KeyDeviceListEntries;
+    uint8_t i;
+
+    if (entries > MAC_ZIP_MAX_KEY_DEV_LIST_ENTRIES)
+    {
+        entries = MAC_ZIP_MAX_KEY_DEV_LIST_ENTRIES;
+    }
+
+    for (i = 0; i < entries; i++)
+    {
+        if (key_desc->KeyDeviceList[i].DeviceDescriptorHandle == dev_handle)
+        {
+            return &key_desc->KeyDeviceList[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/**
+ * @brief Checks whether a key may be used for a frame type
+ *
+ * @param key_desc KeyDescriptor
+ * @param frame_type Frame type of the frame
+ * @param cmd_id Command frame identifier for MAC command frames
+ *
+ * @return true if the KeyUsageList contains the frame type
+ */
+static bool key_usage_allowed(mac_key_table_t *key_desc,
+                              uint8_t frame_type,
+                              uint8_t cmd_id)
+{
+    uint8_t entries = key_desc->KeyUsageListEntries;
+    uint8_t i;
+
+    if (entries > MAC_ZIP_MAX_KEY_USAGE_LIST_ENTRIES)
+    {
+        entries = MAC_ZIP_MAX_KEY_USAGE_LIST_ENTRIES;
+    }
+
+    for (i = 0; i < entries; i++)
+    {
+        if ((key_desc->KeyUsageList[i].Frametype == frame_type) &&
+            ((FCF_FRAMETYPE_MAC_CMD != frame_type) ||
+             (key_desc->KeyUsageList[i].CommandFrameIdentifier == cmd_id)))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+/**
+ * @brief Checks the security level of a frame against macSecurityLevelTable
+ *
+ * A security level meets the minimum if both its encryption and its MIC
+ * length meet those of the minimum, see IEEE 802.15.4-2006 7.5.8.2.8.
+ *
+ * @param frame_type Frame type of the frame
+ * @param cmd_id Command frame identifier for MAC command frames
+ * @param sec_level Security level of the frame
+ * @param device DeviceDescriptor of the originator, or NULL if unknown
+ *
+ * @return MAC_IMPROPER_SECURITY_LEVEL if the level is too low;
+ *         MAC_SUCCESS otherwise
+ */
+static retval_t check_sec_level(uint8_t frame_type,
+                                uint8_t cmd_id,
+                                uint8_t sec_level,
+                                mac_device_desc_t *device)
+{
+    uint8_t entries = mac_sec_pib.SecurityLevelTableEntries;
+    uint8_t i;
+
+    if (entries > MAC_ZIP_MAX_SEC_LVL_TABLE_ENTRIES)
+    {
+        entries = MAC_ZIP_MAX_SEC_LVL_TABLE_ENTRIES;
+    }
+
+    for (i = 0; i < entries; i++)
+    {
+        mac_sec_lvl_table_t *sec_lvl = &mac_sec_pib.SecurityLevelTable[i];
+        uint8_t minimum = sec_lvl->SecurityMinimum;
+
+        if ((sec_lvl->FrameType != frame_type) ||
+            ((FCF_FRAMETYPE_MAC_CMD == frame_type) &&
+             (sec_lvl->CommandFrameIdentifier != cmd_id)))
+        {
+            continue;
+        }
+
+        if (((sec_level & MAC_SEC_ENC_FLAG) >= (minimum & MAC_SEC_ENC_FLAG)) &&
+            ((sec_level & 0x03) >= (minimum & 0x03)))
+        {
+            return MAC_SUCCESS;
+        }
+
+        /* Exempt devices may omit security if the table allows it. */
+        if ((0 == sec_level) && sec_lvl->DeviceOverrideSecurityMinimum &&
+            (NULL != device) && device->Exempt)
+        {
+            return MAC_SUCCESS;
+        }
+
+        return MAC_IMPROPER_SECURITY_LEVEL;
+    }
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Builds the CCM* nonce
+ *
+ * The STB sets the flags octet and the block counter itself.
+ *
+ * @param[out] nonce Nonce of AES_BLOCKSIZE octets
+ * @param ext_addr Extended address of the originator in transmission order
+ * @param frame_counter Frame counter of the frame
+ * @param sec_level Security level of the frame
+ */
+static void build_nonce(uint8_t *nonce,
+                        uint8_t *ext_addr,
+                        uint32_t frame_counter,
+                        uint8_t sec_level)
+{
+    uint8_t i;
+
+    /* The nonce holds address and frame counter in big endian order. */
+    for (i = 0; i < EXT_ADDR_LEN; i++)
+    {
+        nonce[NONCE_POS_EXT_ADDR + i] = ext_addr[EXT_ADDR_LEN - 1 - i];
+    }
+
+    nonce[NONCE_POS_FRAME_COUNTER] = (uint8_t)(frame_counter >> 24);
+    nonce[NONCE_POS_FRAME_COUNTER + 1] = (uint8_t)(frame_counter >> 16);
+    nonce[NONCE_POS_FRAME_COUNTER + 2] = (uint8_t)(frame_counter >> 8);
+    nonce[NONCE_POS_FRAME_COUNTER + 3] = (uint8_t)frame_counter;
+    nonce[NONCE_POS_SEC_LEVEL] = sec_level;
+}
+
+#endif  /* MAC_SECURITY_ZIP */
+
+/* EOF */
@@ -37,6 +37,9 @@ void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
                        uint8_t msduLength,
                        uint8_t *msdu,
                        uint8_t mpduLinkQuality,
+    #ifdef ENABLE_RSSI
+                       int8_t mpduRssi,
+    #endif  /* ENABLE_RSSI */
                        uint8_t DSN,
     #ifdef ENABLE_TSTAMP
                        uint32_t Timestamp,
@@ -50,6 +53,9 @@ void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
                        uint8_t msduLength,
                        uint8_t *msdu,
                        uint8_t mpduLinkQuality,
+    #ifdef ENABLE_RSSI
+                       int8_t mpduRssi,
+    #endif  /* ENABLE_RSSI */
     #ifdef ENABLE_TSTAMP
                        uint8_t DSN,
                        uint32_t Timestamp)
@@ -64,6 +70,9 @@ void usr_mcps_data_ind(wpan_addr_spec_t *SrcAddrSpec,
     msduLength = msduLength;
     msdu = msdu;
     mpduLinkQuality = mpduLinkQuality;
+#ifdef ENABLE_RSSI
+    mpduRssi = mpduRssi;
+#endif  /* ENABLE_RSSI */
     DSN = DSN;
 #ifdef ENABLE_TSTAMP
     Timestamp = Timestamp;
@@ -53,11 +53,21 @@ retval_t pal_sio_init(uint8_t sio_unit)
     switch (sio_unit)
     {
 #ifdef UART0
-        case SIO_0: sio_uart_0_init(UART_BAUD_9k6);
+        case SIO_0:
+    #ifdef BAUD_RATE
+                    sio_uart_0_init(BAUD_RATE);
+    #else
+                    sio_uart_0_init(UART_BAUD_9k6);
+    #endif
                     break;
 #endif
 #ifdef UART1
-        case SIO_1: sio_uart_1_init(UART_BAUD_9k6);
+        case SIO_1:
+    #ifdef BAUD_RATE
+                    sio_uart_1_init(BAUD_RATE);
+    #else
+                    sio_uart_1_init(UART_BAUD_9k6);
+    #endif
                     break;
 #endif
 #ifdef USB0
@@ -29,6 +29,65 @@
 
 #if ((defined UART0) || (defined UART1))
 
+#ifdef SIO_BULK
+
+#if ((UART_MAX_TX_BUF_LENGTH > 0xFFFF) || (UART_MAX_RX_BUF_LENGTH > 0xFFFF))
+#error "The UART buffers of the SIO bulk mode are limited to 65535 bytes"
+#endif
+
+/*
+ * Structure containing the transmit and receive ring buffer of the SIO bulk
+ * mode. A ring is empty if head and tail are equal, so one byte of each
+ * ring remains unused. Both rings are served by the PDC of the USART.
+ */
+typedef struct uart_bulk_buffer_tag
+{
+    /* Transmit buffer */
+    uint8_t tx_buf[UART_MAX_TX_BUF_LENGTH];
+
+    /* Receive buffer */
+    uint8_t rx_buf[UART_MAX_RX_BUF_LENGTH];
+
+    /* Next byte to be transmitted, advanced by the ISR */
+    volatile uint16_t tx_buf_head;
+
+    /* Number of bytes handed over to the transmit PDC, 0 if it is idle */
+    volatile uint16_t tx_pdc_length;
+
+    /* Next free byte of transmit buffer, advanced by pal_sio_tx_commit() */
+    volatile uint16_t tx_buf_tail;
+
+    /* Next byte to be read, advanced by pal_sio_rx_release() */
+    volatile uint16_t rx_buf_head;
+
+    /* Start of the space handed over to the receive PDC */
+    volatile uint16_t rx_buf_tail;
+
+    /* Number of bytes handed over to the receive PDC, 0 if it is idle */
+    volatile uint16_t rx_pdc_length;
+
+    /* The receiver time-out has expired since the last check */
+    volatile bool rx_idle;
+
+    /* Receive callback */
+    sio_rx_cb_t rx_cb;
+
+    /* Number of pending bytes to call the receive callback */
+    uint16_t rx_threshold;
+
+    /* Receive buffer tail at the last check for the receive callback */
+    uint16_t rx_seen_tail;
+
+    /* USART of this buffer */
+    AT91PS_USART usart;
+
+    /* SIO unit of this buffer */
+    uint8_t sio_unit;
+
+} uart_bulk_buffer_t;
+
+#else   /* !SIO_BULK */
+
 /*
  * Structure containing the transmit and receive buffer
  * and also the buffer head, tail and count
@@ -61,6 +120,8 @@ typedef struct uart_communication_buffer_tag
 
 } uart_communication_buffer_t;
 
+#endif  /* SIO_BULK */
+
 /* Irq handlers of UART */
 typedef void (*uart_irq_handler_t) (void);
 
@@ -80,6 +141,22 @@ typedef void (*uart_irq_handler_t) (void);
  */
 #define UART_BAUD_DIVISOR           (uint16_t) ((F_CPU / UART_BAUD_9k6) / 16)
 
+/*
+ * Value to be loaded in the SCBR register of USART to obtain the given baud
+ * rate in SIO bulk mode, rounded to the nearest divisor.
+ */
+#define UART_BAUD(rate) \
+    ((uint16_t)(((F_CPU) + 8UL * (rate)) / (16UL * (rate))))
+
+/*
+ * Time in microseconds without a received byte after which the receive line
+ * is idle in SIO bulk mode; programmed into the receiver time-out of the
+ * USART.
+ */
+#ifndef SIO_RX_IDLE_TIME
+#define SIO_RX_IDLE_TIME            (1000)
+#endif
+
 /* UART0 */
 #ifdef UART0
 
@@ -178,6 +255,9 @@ uint8_t sio_uart_0_rx(uint8_t *data, uint8_t max_length);
 uint8_t sio_uart_1_rx(uint8_t *data, uint8_t max_length);
 uint8_t sio_uart_0_tx(uint8_t *data, uint8_t length);
 uint8_t sio_uart_1_tx(uint8_t *data, uint8_t length);
+#ifdef SIO_BULK
+void sio_uart_bulk_task(void);
+#endif
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -35,12 +35,15 @@
 /* === Macros =============================================================== */
 
 /*
- * USB buffer sizes
+ * USB buffer sizes; they have to be powers of two and multiples of the
+ * endpoint size (USB_TX_MAX_SIZE), at most 32768 octets
  */
-#define USB_TX_BUF_MAX_SIZE 128
-#define USB_RX_BUF_MAX_SIZE 128
-//#define USB_TX_BUF_MAX_SIZE            USB_TX_BUF_SIZE
-//#define USB_RX_BUF_MAX_SIZE            USB_RX_BUF_SIZE
+#ifndef USB_TX_BUF_MAX_SIZE
+#define USB_TX_BUF_MAX_SIZE             (1024)
+#endif
+#ifndef USB_RX_BUF_MAX_SIZE
+#define USB_RX_BUF_MAX_SIZE             (512)
+#endif
 
 #ifdef USE_FTDI_USB
 /*
@@ -54,11 +57,31 @@
 /* Size of the Endpoint */
 #define USB_TX_MAX_SIZE 64
 
+/*
+ * Maximum number of octets submitted to the IN endpoint as one transfer.
+ * Both banks of the endpoint are kept filled within a transfer, and the
+ * part of the transmit buffer not being transferred can be refilled
+ * meanwhile.
+ */
+#ifndef USB_TX_BATCH_SIZE
+#define USB_TX_BATCH_SIZE               (USB_TX_BUF_MAX_SIZE / 2)
+#endif
+
+#if ((USB_TX_BUF_MAX_SIZE & (USB_TX_BUF_MAX_SIZE - 1)) != 0) || \
+    ((USB_RX_BUF_MAX_SIZE & (USB_RX_BUF_MAX_SIZE - 1)) != 0) || \
+    (USB_TX_BUF_MAX_SIZE < USB_TX_MAX_SIZE) || \
+    (USB_RX_BUF_MAX_SIZE < USB_TX_MAX_SIZE) || \
+    (USB_TX_BUF_MAX_SIZE > 32768) || (USB_RX_BUF_MAX_SIZE > 32768)
+#error "USB buffer sizes have to be powers of two between the endpoint size and 32768"
+#endif
+
 /* === Types ================================================================ */
 
 /*
- * Structure containing the transmit and receive buffer
- * and also the buffer head, tail and count
+ * Structure containing the transmit and receive buffer.
+ * Head and tail are free running counters; the buffer index is the counter
+ * modulo the buffer size, and the number of octets in a buffer is the
+ * difference of tail and head.
  */
 typedef struct usb_communication_buffer_tag
 {
@@ -68,23 +91,32 @@ typedef struct usb_communication_buffer_tag
     /* Receive buffer */
     uint8_t rx_buf[USB_RX_BUF_MAX_SIZE];
 
-    /* Transmit buffer head */
-    uint8_t tx_buf_head;
+    /* Transmit buffer head, advanced when a transfer has been completed */
+    volatile uint16_t tx_buf_head;
 
     /* Transmit buffer tail */
-    uint8_t tx_buf_tail;
+    volatile uint16_t tx_buf_tail;
 
     /* Receive buffer head */
-    uint8_t rx_buf_head;
+    volatile uint16_t rx_buf_head;
+
+    /* Receive buffer tail, advanced when a packet has been received */
+    volatile uint16_t rx_buf_tail;
+
+    /* Number of bytes of the transfer submitted to the IN endpoint */
+    volatile uint16_t tx_count;
 
-    /* Receive buffer tail */
-    uint8_t rx_buf_tail;
+    /* Transfer submitted to the IN endpoint */
+    volatile bool tx_busy;
 
-    /* Number of bytes in transmit buffer */
-    uint8_t tx_count;
+    /*
+     * The last transfer ended with a full packet, so a zero length packet
+     * has to follow unless more data is sent.
+     */
+    volatile bool tx_zlp;
 
-    /* Number of bytes in receive buffer */
-    uint8_t rx_count;
+    /* Transfer submitted to the OUT endpoint */
+    volatile bool rx_busy;
 
 } usb_communication_buffer_t;
 
@@ -26,6 +26,7 @@
 #include "return_val.h"
 #include "pal_timer.h"
 #include "app_config.h"
+#include "tlm.h"
 
 /* === Globals ============================================================== */
 
@@ -135,6 +136,8 @@ void timer_service(void)
         /* Expired timer if any will be processed here */
         while (NO_TIMER != expired_timer_queue_head)
         {
+            TLM_EVENT(TLM_EV_TIMER_EXPIRED, expired_timer_queue_head, 0);
+
             ENTER_CRITICAL_REGION();
 
             next_expired_timer = timer_array[expired_timer_queue_head].next_timer_in_queue;
@@ -19,7 +19,7 @@
 
 /* === Includes ============================================================= */
 
-#if ((defined UART0) || (defined UART1))
+#if (((defined UART0) || (defined UART1)) && !(defined SIO_BULK))
 #include <stdint.h>
 #include "pal.h"
 #include "pal_config.h"
@@ -722,6 +722,6 @@ void uart1_irq_handler(void)
 }
 #endif  /* UART1 */
 
-#endif  /* ((defined UART0) || (defined UART1)) */
+#endif  /* (((defined UART0) || (defined UART1)) && !(defined SIO_BULK)) */
 
 /* EOF */
@@ -0,0 +1,775 @@
+/**
+ * @file pal_uart_bulk.c
+ *
+ * @brief UART bulk mode functions for ARM7
+ *
+ * This file implements the SIO bulk mode (SIO_BULK) of the USART for
+ * AT91SAM7 MCUs. It replaces pal_uart.c if SIO_BULK is defined.
+ *
+ * The transmit and receive buffers are rings with 16 bit indices, which are
+ * accessed in place by the application (pal_sio_tx_reserve() /
+ * pal_sio_tx_commit(), pal_sio_rx_peek() / pal_sio_rx_release()).
+ * Both directions are served by the PDC of the USART, so that interrupts
+ * only occur at the end of a contiguous part of a ring. The receiver
+ * time-out of the USART detects an idle line. Received bytes are signalled
+ * from pal_task() once a threshold is reached or the line is idle.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================= */
+
+#if (((defined UART0) || (defined UART1)) && (defined SIO_BULK))
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "pal_config.h"
+#include "pal_uart.h"
+
+#ifndef SIO_HUB
+#error "The SIO bulk mode requires SIO_HUB"
+#endif
+
+/* === Macros =============================================================== */
+
+
+/* === Globals ============================================================== */
+
+#if (defined UART0)
+static uart_bulk_buffer_t uart_0_buffer;
+#endif
+
+#if (defined UART1)
+static uart_bulk_buffer_t uart_1_buffer;
+#endif
+
+/* === Prototypes =========================================================== */
+
+static uart_bulk_buffer_t *get_buffer(uint8_t sio_unit);
+static void tx_start(uart_bulk_buffer_t *buffer);
+static void rx_pdc_start(uart_bulk_buffer_t *buffer);
+static uint16_t rx_tail_get(uart_bulk_buffer_t *buffer);
+static uint16_t tx_copy(uart_bulk_buffer_t *buffer, uint8_t *data,
+                        uint16_t length);
+static uint16_t rx_copy(uart_bulk_buffer_t *buffer, uint8_t *data,
+                        uint16_t max_length);
+static void rx_check(uart_bulk_buffer_t *buffer);
+static void uart_init(uart_bulk_buffer_t *buffer, uint32_t uart_id,
+                      uart_irq_handler_t irq_handler, uint32_t baud_rate);
+static void uart_irq(uart_bulk_buffer_t *buffer);
+
+#ifdef UART0
+static void uart0_irq_handler(void);
+#endif
+
+#ifdef UART1
+static void uart1_irq_handler(void);
+#endif
+
+/* === Implementation ======================================================= */
+
+/**
+ * @brief Returns the buffer of an UART SIO unit
+ *
+ * @param sio_unit Specifies the SIO unit
+ *
+ * @return Buffer of the SIO unit, NULL if it is no UART
+ */
+static uart_bulk_buffer_t *get_buffer(uint8_t sio_unit)
+{
+    switch (sio_unit)
+    {
+#ifdef UART0
+        case SIO_0: return &uart_0_buffer;
+#endif
+#ifdef UART1
+        case SIO_1: return &uart_1_buffer;
+#endif
+        default:    return NULL;
+    }
+}
+
+
+
+/**
+ * @brief Hands the contiguous part of the transmit buffer to the PDC
+ *
+ * Has to be called with interrupts disabled.
+ *
+ * @param buffer Buffer of the UART
+ */
+static void tx_start(uart_bulk_buffer_t *buffer)
+{
+    uint16_t head = buffer->tx_buf_head;
+    uint16_t length;
+
+    if ((head == buffer->tx_buf_tail) || (buffer->tx_pdc_length > 0))
+    {
+        /* Nothing to transmit, or the PDC is still busy. */
+        return;
+    }
+
+    if (buffer->tx_buf_tail > head)
+    {
+        length = buffer->tx_buf_tail - head;
+    }
+    else
+    {
+        /* The rest is transmitted after the end of the buffer is reached. */
+        length = UART_MAX_TX_BUF_LENGTH - head;
+    }
+
+    buffer->tx_pdc_length = length;
+    buffer->usart->US_TPR = (uint32_t)&buffer->tx_buf[head];
+    buffer->usart->US_TCR = length;
+    buffer->usart->US_IER = AT91C_US_ENDTX;
+}
+
+
+
+/**
+ * @brief Hands the contiguous free part of the receive buffer to the PDC
+ *
+ * Has to be called with interrupts disabled and the receive PDC idle. If
+ * the receive buffer is full, the PDC remains idle until bytes are
+ * released.
+ *
+ * @param buffer Buffer of the UART
+ */
+static void rx_pdc_start(uart_bulk_buffer_t *buffer)
+{
+    uint16_t head = buffer->rx_buf_head;
+    uint16_t tail = buffer->rx_buf_tail;
+    uint16_t length;
+
+    if (head > tail)
+    {
+        length = head - tail - 1;
+    }
+    else if (0 == head)
+    {
+        /* The last byte of the buffer must not reach the head. */
+        length = UART_MAX_RX_BUF_LENGTH - tail - 1;
+    }
+    else
+    {
+        length = UART_MAX_RX_BUF_LENGTH - tail;
+    }
+
+    if (0 == length)
+    {
+        buffer->usart->US_IDR = AT91C_US_ENDRX;
+        return;
+    }
+
+    buffer->rx_pdc_length = length;
+    buffer->usart->US_RPR = (uint32_t)&buffer->rx_buf[tail];
+    buffer->usart->US_RCR = length;
+    buffer->usart->US_IER = AT91C_US_ENDRX;
+}
+
+
+
+/**
+ * @brief Returns the next byte of the receive buffer to be written
+ *
+ * Has to be called with interrupts disabled.
+ *
+ * @param buffer Buffer of the UART
+ *
+ * @return Tail of the receive buffer including the bytes received by the PDC
+ */
+static uint16_t rx_tail_get(uart_bulk_buffer_t *buffer)
+{
+    uint16_t tail = buffer->rx_buf_tail;
+
+    if (buffer->rx_pdc_length > 0)
+    {
+        tail = (uint16_t)((uint8_t *)buffer->usart->US_RPR - buffer->rx_buf);
+        if (UART_MAX_RX_BUF_LENGTH == tail)
+        {
+            tail = 0;
+        }
+    }
+
+    return tail;
+}
+
+
+
+/**
+ * @brief Reserves contiguous space in the transmit buffer
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param[out] data Pointer to the reserved space
+ *
+ * @return Number of bytes that can be written at data
+ */
+uint16_t pal_sio_tx_reserve(uint8_t sio_unit, uint8_t **data)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+    uint16_t head;
+    uint16_t tail;
+
+    if (NULL == buffer)
+    {
+        return 0;
+    }
+
+    ENTER_CRITICAL_REGION();
+    head = buffer->tx_buf_head;
+    LEAVE_CRITICAL_REGION();
+    tail = buffer->tx_buf_tail;
+
+    *data = &buffer->tx_buf[tail];
+
+    if (head > tail)
+    {
+        return (head - tail - 1);
+    }
+    else if (0 == head)
+    {
+        /* The last byte of the buffer must not reach the head. */
+        return (UART_MAX_TX_BUF_LENGTH - tail - 1);
+    }
+    else
+    {
+        return (UART_MAX_TX_BUF_LENGTH - tail);
+    }
+}
+
+
+
+/**
+ * @brief Transmits the bytes written to the reserved space
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param length Number of bytes to be transmitted
+ */
+void pal_sio_tx_commit(uint8_t sio_unit, uint16_t length)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+    uint16_t tail;
+
+    if ((NULL == buffer) || (0 == length))
+    {
+        return;
+    }
+
+    tail = buffer->tx_buf_tail + length;
+    if (tail >= UART_MAX_TX_BUF_LENGTH)
+    {
+        tail -= UART_MAX_TX_BUF_LENGTH;
+    }
+
+    ENTER_CRITICAL_REGION();
+    buffer->tx_buf_tail = tail;
+    tx_start(buffer);
+    LEAVE_CRITICAL_REGION();
+}
+
+
+
+/**
+ * @brief Gives access to the oldest received bytes
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param[out] data Pointer to the oldest received byte
+ *
+ * @return Number of contiguous bytes at data
+ */
+uint16_t pal_sio_rx_peek(uint8_t sio_unit, uint8_t **data)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+    uint16_t head;
+    uint16_t tail;
+
+    if (NULL == buffer)
+    {
+        return 0;
+    }
+
+    ENTER_CRITICAL_REGION();
+    tail = rx_tail_get(buffer);
+    LEAVE_CRITICAL_REGION();
+    head = buffer->rx_buf_head;
+
+    *data = &buffer->rx_buf[head];
+
+    if (tail >= head)
+    {
+        return (tail - head);
+    }
+    else
+    {
+        return (UART_MAX_RX_BUF_LENGTH - head);
+    }
+}
+
+
+
+/**
+ * @brief Releases received bytes
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param length Number of bytes to be released
+ */
+void pal_sio_rx_release(uint8_t sio_unit, uint16_t length)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+    uint16_t head;
+
+    if (NULL == buffer)
+    {
+        return;
+    }
+
+    head = buffer->rx_buf_head + length;
+    if (head >= UART_MAX_RX_BUF_LENGTH)
+    {
+        head -= UART_MAX_RX_BUF_LENGTH;
+    }
+
+    ENTER_CRITICAL_REGION();
+    buffer->rx_buf_head = head;
+    if (0 == buffer->rx_pdc_length)
+    {
+        /* The receive buffer was full, the receive PDC is restarted. */
+        rx_pdc_start(buffer);
+    }
+    LEAVE_CRITICAL_REGION();
+}
+
+
+
+/**
+ * @brief Sets the receive callback
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param rx_cb Callback function, NULL to remove the callback
+ * @param threshold Number of pending bytes to call the callback
+ */
+void pal_sio_rx_cb_set(uint8_t sio_unit, sio_rx_cb_t rx_cb, uint16_t threshold)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+
+    if (NULL == buffer)
+    {
+        return;
+    }
+
+    buffer->rx_threshold = threshold;
+    ENTER_CRITICAL_REGION();
+    buffer->rx_seen_tail = rx_tail_get(buffer);
+    buffer->rx_idle = false;
+    LEAVE_CRITICAL_REGION();
+    buffer->rx_cb = rx_cb;
+}
+
+
+
+/**
+ * @brief Copies data into the transmit buffer and starts the transmission
+ *
+ * @param buffer Buffer of the UART
+ * @param data Data to be transmitted
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Number of bytes copied into the transmit buffer
+ */
+static uint16_t tx_copy(uart_bulk_buffer_t *buffer, uint8_t *data,
+                        uint16_t length)
+{
+    uint16_t copied = 0;
+    uint8_t *space;
+    uint16_t size;
+
+    /* The free space may wrap around the end of the buffer once. */
+    while (copied < length)
+    {
+        size = pal_sio_tx_reserve(buffer->sio_unit, &space);
+        if (0 == size)
+        {
+            break;
+        }
+        if (size > (length - copied))
+        {
+            size = length - copied;
+        }
+        memcpy(space, &data[copied], size);
+        pal_sio_tx_commit(buffer->sio_unit, size);
+        copied += size;
+    }
+
+    return copied;
+}
+
+
+
+/**
+ * @brief Copies received data out of the receive buffer
+ *
+ * @param buffer Buffer of the UART
+ * @param data Buffer for the received data
+ * @param max_length Maximum number of bytes to be copied
+ *
+ * @return Number of bytes copied
+ */
+static uint16_t rx_copy(uart_bulk_buffer_t *buffer, uint8_t *data,
+                        uint16_t max_length)
+{
+    uint16_t copied = 0;
+    uint8_t *received;
+    uint16_t size;
+
+    /* The received bytes may wrap around the end of the buffer once. */
+    while (copied < max_length)
+    {
+        size = pal_sio_rx_peek(buffer->sio_unit, &received);
+        if (0 == size)
+        {
+            break;
+        }
+        if (size > (max_length - copied))
+        {
+            size = max_length - copied;
+        }
+        memcpy(&data[copied], received, size);
+        pal_sio_rx_release(buffer->sio_unit, size);
+        copied += size;
+    }
+
+    return copied;
+}
+
+
+
+/**
+ * @brief Calls the receive callback if required
+ *
+ * The callback is called if new bytes have been received and at least the
+ * threshold is pending, or if the receiver time-out has expired while bytes
+ * are pending.
+ *
+ * @param buffer Buffer of the UART
+ */
+static void rx_check(uart_bulk_buffer_t *buffer)
+{
+    uint16_t tail;
+    uint16_t pending;
+    bool indicate;
+
+    if (NULL == buffer->rx_cb)
+    {
+        return;
+    }
+
+    ENTER_CRITICAL_REGION();
+    tail = rx_tail_get(buffer);
+    indicate = buffer->rx_idle;
+    buffer->rx_idle = false;
+    LEAVE_CRITICAL_REGION();
+
+    if (tail >= buffer->rx_buf_head)
+    {
+        pending = tail - buffer->rx_buf_head;
+    }
+    else
+    {
+        pending = UART_MAX_RX_BUF_LENGTH - buffer->rx_buf_head + tail;
+    }
+
+    if (tail != buffer->rx_seen_tail)
+    {
+        /* New bytes have been received. */
+        buffer->rx_seen_tail = tail;
+        if ((buffer->rx_threshold > 0) && (pending >= buffer->rx_threshold))
+        {
+            indicate = true;
+        }
+    }
+
+    if (indicate && (pending > 0))
+    {
+        buffer->rx_cb(buffer->sio_unit, pending);
+    }
+}
+
+
+
+/**
+ * @brief Calls the receive callbacks of the UARTs if required
+ *
+ * This function is called by pal_task().
+ */
+void sio_uart_bulk_task(void)
+{
+#ifdef UART0
+    rx_check(&uart_0_buffer);
+#endif
+#ifdef UART1
+    rx_check(&uart_1_buffer);
+#endif
+}
+
+
+
+/**
+ * @brief Initializes an USART for the SIO bulk mode
+ *
+ * @param buffer Buffer of the UART, with the USART already set
+ * @param uart_id Peripheral ID of the USART
+ * @param irq_handler Interrupt handler of the USART
+ * @param baud_rate Actual UART baud rate
+ */
+static void uart_init(uart_bulk_buffer_t *buffer, uint32_t uart_id,
+                      uart_irq_handler_t irq_handler, uint32_t baud_rate)
+{
+    AT91PS_USART uart_ptr = buffer->usart;
+    uint32_t timeout;
+
+    /* The clock for selected UART channel is enabled. */
+    AT91C_BASE_PMC->PMC_PCER = _BV(uart_id);
+
+    uart_ptr->US_CR = AT91C_US_RSTRX | AT91C_US_RSTTX |
+                      AT91C_US_RXDIS | AT91C_US_TXDIS;
+
+    /*
+     * UART is configured in normal mode, 8 bits per transfer, no parity bit
+     * and one stop bit (per transfer).
+     */
+    uart_ptr->US_MR = AT91C_US_USMODE_NORMAL | AT91C_US_CLKS_CLOCK |
+                      AT91C_US_CHRL_8_BITS | AT91C_US_PAR_NONE |
+                      AT91C_US_NBSTOP_1_BIT;
+
+    uart_ptr->US_BRGR = UART_BAUD(baud_rate);
+
+    /* The receiver time-out is given in bit periods. */
+    timeout = ((uint32_t)SIO_RX_IDLE_TIME * (baud_rate / 1000)) / 1000;
+    if (timeout > 0xFFFF)
+    {
+        timeout = 0xFFFF;
+    }
+    else if (0 == timeout)
+    {
+        timeout = 1;
+    }
+    uart_ptr->US_RTOR = timeout;
+
+    /* The AIC is set up for the UART interrupts. */
+    AIC_CONFIGURE(uart_id, AT91C_AIC_SRCTYPE_INT_POSITIVE_EDGE, irq_handler);
+
+    /* The PDC receives into the whole buffer, which is empty. */
+    uart_ptr->US_PTCR = AT91C_PDC_RXTEN | AT91C_PDC_TXTEN;
+    rx_pdc_start(buffer);
+
+    uart_ptr->US_IER = AT91C_US_TIMEOUT;
+
+    /* The UART interrupt is enabled in AIC. */
+    AT91C_BASE_AIC->AIC_IECR = _BV(uart_id);
+
+    /* Transmitter and receiver of the UART channel are enabled. */
+    uart_ptr->US_CR = AT91C_US_TXEN;
+    uart_ptr->US_CR = AT91C_US_RXEN;
+
+    /* The receiver time-out starts with the first received byte. */
+    uart_ptr->US_CR = AT91C_US_STTTO;
+}
+
+
+
+/**
+ * @brief Handles the interrupts of an USART in SIO bulk mode
+ *
+ * @param buffer Buffer of the UART
+ */
+static void uart_irq(uart_bulk_buffer_t *buffer)
+{
+    AT91PS_USART uart_ptr = buffer->usart;
+    uint32_t uart_irq_cause = uart_ptr->US_CSR & uart_ptr->US_IMR;
+
+    if (AT91C_US_ENDRX & uart_irq_cause)
+    {
+        uint16_t tail = buffer->rx_buf_tail + buffer->rx_pdc_length;
+
+        if (tail >= UART_MAX_RX_BUF_LENGTH)
+        {
+            /* Revert back to beginning of buffer after reaching its end. */
+            tail -= UART_MAX_RX_BUF_LENGTH;
+        }
+        buffer->rx_buf_tail = tail;
+        buffer->rx_pdc_length = 0;
+
+        rx_pdc_start(buffer);
+    }
+
+    if (AT91C_US_TIMEOUT & uart_irq_cause)
+    {
+        buffer->rx_idle = true;
+
+        /* The time-out is restarted by the next received byte. */
+        uart_ptr->US_CR = AT91C_US_STTTO;
+    }
+
+    if (AT91C_US_ENDTX & uart_irq_cause)
+    {
+        uint16_t head = buffer->tx_buf_head + buffer->tx_pdc_length;
+
+        if (head >= UART_MAX_TX_BUF_LENGTH)
+        {
+            /* Reached the end of buffer, revert back to beginning of buffer. */
+            head -= UART_MAX_TX_BUF_LENGTH;
+        }
+        buffer->tx_buf_head = head;
+        buffer->tx_pdc_length = 0;
+
+        /* ENDTX remains set as long as the PDC is idle. */
+        uart_ptr->US_IDR = AT91C_US_ENDTX;
+        tx_start(buffer);
+    }
+}
+
+
+
+#ifdef UART0
+/**
+ * @brief Initializes UART 0
+ *
+ * This function initializes the UART channel 0.
+ *
+ * @param baud_rate Actual UART baud rate
+ */
+void sio_uart_0_init(uint32_t baud_rate)
+{
+    uart_0_buffer.sio_unit = SIO_0;
+    uart_0_buffer.usart = AT91C_BASE_US0;
+
+    /*
+     * The RXD0 and TXD0 pins on the PIO A are configured to be
+     * controlled by on chip UART peripheral.
+     */
+    AT91C_BASE_PIOA->PIO_ASR = (PIN_UART_0_RXD | PIN_UART_0_TXD);
+    AT91C_BASE_PIOA->PIO_PDR = (PIN_UART_0_RXD | PIN_UART_0_TXD);
+
+    uart_init(&uart_0_buffer, AT91C_ID_US0, uart0_irq_handler, baud_rate);
+}
+
+
+
+/**
+ * @brief Transmit data via UART 0
+ *
+ * @param data Pointer to the buffer where the data to be transmitted is present
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Number of bytes actually transmitted
+ */
+uint8_t sio_uart_0_tx(uint8_t *data, uint8_t length)
+{
+    return (uint8_t)tx_copy(&uart_0_buffer, data, length);
+}
+
+
+
+/**
+ * @brief Receives data from UART 0
+ *
+ * @param data pointer to the buffer where the received data is to be stored
+ * @param max_length maximum length of data to be received
+ *
+ * @return actual number of bytes received
+ */
+uint8_t sio_uart_0_rx(uint8_t *data, uint8_t max_length)
+{
+    return (uint8_t)rx_copy(&uart_0_buffer, data, max_length);
+}
+
+
+
+/**
+ * @brief ISR for UART0 interrupts
+ */
+static void uart0_irq_handler(void)
+{
+    uart_irq(&uart_0_buffer);
+}
+#endif  /* UART0 */
+
+
+
+#ifdef UART1
+/**
+ * @brief Initializes UART 1
+ *
+ * This function initializes the UART channel 1.
+ *
+ * @param baud_rate Actual UART baud rate
+ */
+void sio_uart_1_init(uint32_t baud_rate)
+{
+    uart_1_buffer.sio_unit = SIO_1;
+    uart_1_buffer.usart = AT91C_BASE_US1;
+
+    /*
+     * The RXD1 and TXD1 pins on the PIO A are configured to be
+     * controlled by on chip UART peripheral.
+     */
+    AT91C_BASE_PIOA->PIO_ASR = (PIN_UART_1_RXD | PIN_UART_1_TXD);
+    AT91C_BASE_PIOA->PIO_PDR = (PIN_UART_1_RXD | PIN_UART_1_TXD);
+
+    uart_init(&uart_1_buffer, AT91C_ID_US1, uart1_irq_handler, baud_rate);
+}
+
+
+
+/**
+ * @brief Transmit data via UART 1
+ *
+ * @param data Pointer to the buffer where the data to be transmitted is present
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Number of bytes actually transmitted
+ */
+uint8_t sio_uart_1_tx(uint8_t *data, uint8_t length)
+{
+    return (uint8_t)tx_copy(&uart_1_buffer, data, length);
+}
+
+
+
+/**
+ * @brief Receives data from UART 1
+ *
+ * @param data pointer to the buffer where the received data is to be stored
+ * @param max_length maximum length of data to be received
+ *
+ * @return actual number of bytes received
+ */
+uint8_t sio_uart_1_rx(uint8_t *data, uint8_t max_length)
+{
+    return (uint8_t)rx_copy(&uart_1_buffer, data, max_length);
+}
+
+
+
+/**
+ * @brief ISR for UART1 interrupts
+ */
+static void uart1_irq_handler(void)
+{
+    uart_irq(&uart_1_buffer);
+}
+#endif  /* UART1 */
+
+#endif  /* (((defined UART0) || (defined UART1)) && (defined SIO_BULK)) */
+
+/* EOF */
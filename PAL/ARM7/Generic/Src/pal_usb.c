@@ -42,10 +42,8 @@
 
 /* === Globals ============================================================== */
 
-static uint8_t usb_0_tx_temp_buf[USB_TX_BUF_MAX_SIZE];
-static uint8_t usb_0_rx_temp_buf[USB_RX_BUF_MAX_SIZE];
-
-static uint8_t usb_0_rx_disable_flag;
+/* Packet received from the OUT endpoint */
+static uint8_t usb_0_rx_temp_buf[USB_TX_MAX_SIZE];
 
 static usb_communication_buffer_t usb_0_buffer;
 
@@ -123,29 +121,80 @@ static void VBus_Configure( void )
 
 
 /**
- * @brief Bytes free in the buffer
- *
- * This function computes the free buffer size in a cyclic buffer.
+ * @brief Submits the next transfer to the IN endpoint
  *
- * @param head          index of the head
- * @param tail          index of the tail
- * @param max_buf_size  maximum size of the used buffer
- *
- * @return Number of bytes available in the buffers
+ * The data of the transmit buffer is passed to the USB driver in place,
+ * as long as it is contiguous and up to USB_TX_BATCH_SIZE bytes, so that
+ * the driver keeps both banks of the endpoint filled. If the buffer is
+ * empty and the last transfer ended with a full packet, a zero length
+ * packet is sent, so that the host completes its read.
+ * Has to be called with interrupts disabled and no transfer submitted.
  */
-uint8_t get_buffer_size(uint8_t head, uint8_t tail, uint8_t max_buf_size)
+static void usb0_tx_start(void)
 {
-    uint8_t size;
-    if (tail >= head)
+    uint16_t index = usb_0_buffer.tx_buf_head & (USB_TX_BUF_MAX_SIZE - 1);
+    uint16_t length = usb_0_buffer.tx_buf_tail - usb_0_buffer.tx_buf_head;
+
+    if (length == 0)
     {
-        size = (max_buf_size) - (tail - head);
+        if (!usb_0_buffer.tx_zlp)
+        {
+            /* No more data for transmission */
+            return;
+        }
     }
     else
     {
-        size = (head - 1) - tail;
+        if (length > (USB_TX_BUF_MAX_SIZE - index))
+        {
+            /* Transmit up to the end of the buffer first. */
+            length = USB_TX_BUF_MAX_SIZE - index;
+        }
+        if (length > USB_TX_BATCH_SIZE)
+        {
+            length = USB_TX_BATCH_SIZE;
+        }
+    }
+
+    if (CDCDSerialDriver_Write(&usb_0_buffer.tx_buf[index], length,
+            (TransferCallback) usb0_tx_complete_handler, 0)
+            == USBD_STATUS_SUCCESS)
+    {
+        usb_0_buffer.tx_count = length;
+        usb_0_buffer.tx_zlp = false;
+        usb_0_buffer.tx_busy = true;
     }
+}
+
 
-    return size;
+
+/**
+ * @brief Submits the next transfer to the OUT endpoint
+ *
+ * One packet is received at a time, so that a host write of a multiple of
+ * the endpoint size is available without waiting for a zero length packet.
+ * While a packet is copied to the receive buffer, the next one is already
+ * stored by the second bank of the endpoint. If the receive buffer has no
+ * space for a full packet, the host is NAKed until sio_usb_0_rx() has read
+ * enough data.
+ * Has to be called with interrupts disabled and no transfer submitted.
+ */
+static void usb0_rx_start(void)
+{
+    uint16_t size = USB_RX_BUF_MAX_SIZE -
+                    (uint16_t)(usb_0_buffer.rx_buf_tail - usb_0_buffer.rx_buf_head);
+
+    if (size < USB_TX_MAX_SIZE)
+    {
+        return;
+    }
+
+    if (CDCDSerialDriver_Read(usb_0_rx_temp_buf, sizeof(usb_0_rx_temp_buf),
+            (TransferCallback) usb0_rx_complete_handler, 0)
+            == USBD_STATUS_SUCCESS)
+    {
+        usb_0_buffer.rx_busy = true;
+    }
 }
 
 
@@ -161,12 +210,12 @@ void sio_usb_0_init(void)
     usb_0_buffer.tx_buf_head = 0;
     usb_0_buffer.tx_buf_tail = 0;
     usb_0_buffer.tx_count = 0;
+    usb_0_buffer.tx_busy = false;
+    usb_0_buffer.tx_zlp = false;
 
     usb_0_buffer.rx_buf_head = 0;
     usb_0_buffer.rx_buf_tail = 0;
-    usb_0_buffer.rx_count = 0;
-
-    usb_0_rx_disable_flag = 1; //disable rx for startup
+    usb_0_buffer.rx_busy = false;
 
     /* CDC serial driver initialization */
     CDCDSerialDriver_Initialize();
@@ -177,8 +226,9 @@ void sio_usb_0_init(void)
     while (USBD_GetState() < USBD_STATE_CONFIGURED)
         ;
 
-    CDCDSerialDriver_Read(usb_0_rx_temp_buf, sizeof(usb_0_rx_temp_buf),
-            (TransferCallback) usb0_rx_complete_handler, 0);
+    ENTER_CRITICAL_REGION();
+    usb0_rx_start();
+    LEAVE_CRITICAL_REGION();
 }
 
 
@@ -195,102 +245,44 @@ void sio_usb_0_init(void)
  */
 uint8_t sio_usb_0_tx(uint8_t *data, uint8_t length)
 {
-    uint8_t bytes_to_be_written = 0;
-    uint8_t head = 0;
-    uint8_t tail = 0;
-    uint8_t size = 0;
-    uint8_t back = 0;
-
-    uint8_t tx_length = 0;
-    uint8_t i = 0;
-
-    /* The transmit interrupt is disabled. */
-    //ENTER_CRITICAL_REGION();
-
-    /*
-     * Initialize head and tail
-     */
-    head = usb_0_buffer.tx_buf_head;
-    tail = usb_0_buffer.tx_buf_tail;
-
-    size = get_buffer_size( usb_0_buffer.tx_buf_head,
-                            usb_0_buffer.tx_buf_tail,
-                            USB_TX_BUF_MAX_SIZE);
+    uint16_t tail = usb_0_buffer.tx_buf_tail;
+    uint16_t size = USB_TX_BUF_MAX_SIZE -
+                    (uint16_t)(tail - usb_0_buffer.tx_buf_head);
+    uint16_t index = tail & (USB_TX_BUF_MAX_SIZE - 1);
+    uint16_t chunk;
 
     if (size < length)
     {
         /* Not enough buffer space available. Use the remaining size. */
-        bytes_to_be_written = size;
-    }
-    else
-    {
-        bytes_to_be_written = length;
+        length = size;
     }
 
-    /* Remember the number of bytes transmitted. */
-    back = bytes_to_be_written;
-
-    /* The data is copied to the transmit buffer. */
-    while (bytes_to_be_written > 0)
+    /* The data is copied to the transmit buffer, wrapping at its end. */
+    chunk = USB_TX_BUF_MAX_SIZE - index;
+    if (chunk > length)
     {
-        usb_0_buffer.tx_buf[usb_0_buffer.tx_buf_tail] = *data;
+        chunk = length;
+    }
+    memcpy(&usb_0_buffer.tx_buf[index], data, chunk);
+    memcpy(usb_0_buffer.tx_buf, data + chunk, length - chunk);
 
-        if ((USB_TX_BUF_MAX_SIZE - 1) == usb_0_buffer.tx_buf_tail)
-        {
-            /* Reached the end of buffer, revert back to beginning of buffer. */
-            usb_0_buffer.tx_buf_tail = 0;
-        }
-        else
-        {
-            /*
-             * Increment the index to point the next character to be
-             * inserted.
-             */
-            usb_0_buffer.tx_buf_tail++;
-        }
+    ENTER_CRITICAL_REGION();
 
-        bytes_to_be_written--;
-        data++;
-    }
+    usb_0_buffer.tx_buf_tail = tail + length;
 
     /*
-     * Check whether there is a transmission ongoing. Otherwise write
-     * data into the UART data register. Transmission of subsequent
-     * bytes / data will be taken care in the ISR.
+     * Check whether there is a transfer ongoing. Otherwise submit the
+     * data; subsequent data is submitted by the completion handler,
+     * batched with everything written meanwhile.
      */
-    if (usb_0_buffer.tx_count == 0)
+    if (!usb_0_buffer.tx_busy)
     {
-        /*
-         * Prepare a linear buffer for submitting data
-         */
-        head = usb_0_buffer.tx_buf_head;
-        tail = usb_0_buffer.tx_buf_tail;
-
-        while (head != tail)
-        {
-            usb_0_tx_temp_buf[i] = usb_0_buffer.tx_buf[head];
-            if (i == USB_TX_MAX_SIZE) //cannot transmit more than USB_TX_MAX_SIZE at once
-                break;
-            if ((head) == (USB_TX_BUF_MAX_SIZE - 1))
-                head = 0;
-            else
-                head++;
-            i++;
-        }
-        tx_length = i;
-
-        /* The transmit interrupt is enabled. */
-        //LEAVE_CRITICAL_REGION();
-
-        usb_0_buffer.tx_count = 1;
-        while (CDCDSerialDriver_Write(usb_0_tx_temp_buf, tx_length,
-                (TransferCallback) usb0_tx_complete_handler, 0)
-                != USBD_STATUS_SUCCESS)
-            ;
-
+        usb0_tx_start();
     }
 
-    return back;
+    LEAVE_CRITICAL_REGION();
+
+    return length;
 }
 
 
@@ -307,92 +299,43 @@ uint8_t sio_usb_0_tx(uint8_t *data, uint8_t length)
  */
 uint8_t sio_usb_0_rx(uint8_t *data, uint8_t max_length)
 {
-    uint8_t data_received = 0;
-    uint8_t size = 0;
+    uint16_t head = usb_0_buffer.rx_buf_head;
+    uint16_t count = usb_0_buffer.rx_buf_tail - head;
+    uint16_t index = head & (USB_RX_BUF_MAX_SIZE - 1);
+    uint16_t chunk;
 
-    if (usb_0_buffer.rx_count == 0)
+    if (max_length > count)
     {
-        /* usb receive buffer is empty. */
-        return 0;
-    }
-
-    /* The receive interrupt is disabled. */
-    ENTER_CRITICAL_REGION();
-
-    if (USB_RX_BUF_MAX_SIZE <= usb_0_buffer.rx_count)
-    {
-        /*
-         * Bytes between head and tail are overwritten by new data.
-         * The oldest data in buffer is the one to which the tail is
-         * pointing. So reading operation should start from the tail.
-         */
-        usb_0_buffer.rx_buf_head = usb_0_buffer.rx_buf_tail;
-
         /*
-         * This is a buffer overflow case. But still only bytes equivalent to
-         * full buffer size are useful.
+         * Requested receive length (max_length) is more than the data
+         * present in receive buffer. Hence only the number of bytes
+         * present in receive buffer are read.
          */
-        usb_0_buffer.rx_count = USB_RX_BUF_MAX_SIZE;
-
-        /* Bytes received is more than or equal to buffer. */
-        if (USB_RX_BUF_MAX_SIZE <= max_length)
-        {
-            /*
-             * Requested receive length (max_length) is more than the
-             * max size of receive buffer, but at max the full
-             * buffer can be read.
-             */
-            max_length = USB_RX_BUF_MAX_SIZE;
-        }
-    }
-    else
-    {
-        /* Bytes received is less than receive buffer maximum length. */
-        if (max_length > usb_0_buffer.rx_count)
-        {
-            /*
-             * Requested receive length (max_length) is more than the data
-             * present in receive buffer. Hence only the number of bytes
-             * present in receive buffer are read.
-             */
-            max_length = usb_0_buffer.rx_count;
-        }
+        max_length = count;
     }
 
-    data_received = max_length;
-
-    while (max_length > 0)
+    /* Start to copy from head, wrapping at the end of the buffer. */
+    chunk = USB_RX_BUF_MAX_SIZE - index;
+    if (chunk > max_length)
     {
-        /* Start to copy from head. */
-        *data = usb_0_buffer.rx_buf[usb_0_buffer.rx_buf_head];
-        usb_0_buffer.rx_buf_head++;
-        usb_0_buffer.rx_count--;
-        data++;
-        max_length--;
-        if ((USB_RX_BUF_MAX_SIZE) == usb_0_buffer.rx_buf_head)
-        {
-            usb_0_buffer.rx_buf_head = 0;
-        }
+        chunk = max_length;
     }
+    memcpy(data, &usb_0_buffer.rx_buf[index], chunk);
+    memcpy(data + chunk, usb_0_buffer.rx_buf, max_length - chunk);
 
-    size = get_buffer_size( usb_0_buffer.rx_buf_head,
-                            usb_0_buffer.rx_buf_tail,
-                            USB_RX_BUF_MAX_SIZE);
+    ENTER_CRITICAL_REGION();
 
-    /* The receive interrupt is enabled back. */
-    LEAVE_CRITICAL_REGION();
+    usb_0_buffer.rx_buf_head = head + max_length;
 
-    if (size > 60)
+    /* Resume the reception if it was stopped for lack of buffer space. */
+    if (!usb_0_buffer.rx_busy)
     {
-        CDCDSerialDriver_Read(  usb_0_rx_temp_buf,
-                                sizeof(usb_0_rx_temp_buf),
-                                (TransferCallback) usb0_rx_complete_handler,
-                                0);
-
-        usb_0_rx_disable_flag = 0;
+        usb0_rx_start();
     }
 
-    return data_received;
+    LEAVE_CRITICAL_REGION();
+
+    return max_length;
 }
 
 
@@ -407,59 +350,19 @@ static void usb0_tx_complete_handler(   unsigned int unused,
                                         unsigned int remaining)
 {
     ENTER_CRITICAL_REGION();
-    while (transferred--)
-    {
-        if ((USB_TX_BUF_MAX_SIZE - 1) == usb_0_buffer.tx_buf_head)
-        {
-            /* Reached the end of buffer, revert back to beginning of buffer. */
-            usb_0_buffer.tx_buf_head = 0;
-        }
-        else
-        {
-            /*
-             * * Increment the index to point the next character to be
-             * * transmitted.
-             * */
-            usb_0_buffer.tx_buf_head++;
-        }
-    }
 
-    if (usb_0_buffer.tx_buf_head != usb_0_buffer.tx_buf_tail)
-    {
-        /*
-         * Prepare a linear buffer for submitting data
-         * remaining data in the buffer
-         */
-        uint8_t tx_length = 0;
-        uint8_t i = 0;
-        uint8_t head = 0;
-        uint8_t tail = 0;
-        head = usb_0_buffer.tx_buf_head;
-        tail = usb_0_buffer.tx_buf_tail;
-        while (head != tail)
-        {
-            usb_0_tx_temp_buf[i] = usb_0_buffer.tx_buf[head];
-            if (i == (USB_TX_MAX_SIZE - 1)) //cannot transmit more than USB_TX_MAX_SIZE at once
-                break;
-            if ((head) == (USB_TX_BUF_MAX_SIZE - 1))
-                head = 0;
-            else
-                head++;
-            i++;
-        }
-        tx_length = i;
-        usb_0_buffer.tx_count = 1;
-        while (CDCDSerialDriver_Write(usb_0_tx_temp_buf,
-                                tx_length,
-                                (TransferCallback) usb0_tx_complete_handler,
-                                0)
-                != USBD_STATUS_SUCCESS)
-            ;
-    } else
+    /* The space of the transfer is released, even if it was aborted. */
+    usb_0_buffer.tx_buf_head += usb_0_buffer.tx_count;
+    usb_0_buffer.tx_count = 0;
+    usb_0_buffer.tx_busy = false;
+
+    if (USBD_STATUS_SUCCESS == status)
     {
-        /* No more data for transmission */
-        usb_0_buffer.tx_count = 0;
+        usb_0_buffer.tx_zlp = (transferred != 0) &&
+                              ((transferred % USB_TX_MAX_SIZE) == 0);
+        usb0_tx_start();
     }
+
     LEAVE_CRITICAL_REGION();
 }
 
@@ -474,28 +377,29 @@ static void usb0_rx_complete_handler(   unsigned int unused,
                                         unsigned int received,
                                         unsigned int remaining)
 {
-    uint8_t tail = usb_0_buffer.rx_buf_tail;
-    uint8_t i = 0;
+    uint16_t index;
+    uint16_t chunk;
 
     ENTER_CRITICAL_REGION();
-    while (received--)
+
+    usb_0_buffer.rx_busy = false;
+
+    /* The reception was started only with space for a full packet. */
+    index = usb_0_buffer.rx_buf_tail & (USB_RX_BUF_MAX_SIZE - 1);
+    chunk = USB_RX_BUF_MAX_SIZE - index;
+    if (chunk > received)
     {
-        /* Count of bytes received through USB 0 channel is incremented. */
-        usb_0_buffer.rx_count++;
-        usb_0_buffer.rx_buf[tail] = usb_0_rx_temp_buf[i];
-        i++;
-        if ((USB_RX_BUF_MAX_SIZE - 1) == usb_0_buffer.rx_buf_tail)
-        {
-            /* Revert back to beginning of buffer after reaching end of buffer. */
-            usb_0_buffer.rx_buf_tail = 0;
-            tail = 0;
-        }
-        else
-        {
-            usb_0_buffer.rx_buf_tail++;
-            tail++;
-        }
+        chunk = received;
+    }
+    memcpy(&usb_0_buffer.rx_buf[index], usb_0_rx_temp_buf, chunk);
+    memcpy(usb_0_buffer.rx_buf, &usb_0_rx_temp_buf[chunk], received - chunk);
+    usb_0_buffer.rx_buf_tail += received;
+
+    if (USBD_STATUS_SUCCESS == status)
+    {
+        usb0_rx_start();
     }
+
     LEAVE_CRITICAL_REGION();
 }
 
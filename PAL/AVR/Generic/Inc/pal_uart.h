@@ -31,6 +31,59 @@
 
 #if ((defined UART0) || (defined UART1))
 
+#ifdef SIO_BULK
+
+#if ((UART_MAX_TX_BUF_LENGTH > 0xFFFF) || (UART_MAX_RX_BUF_LENGTH > 0xFFFF))
+#error "The UART buffers of the SIO bulk mode are limited to 65535 bytes"
+#endif
+
+/*
+ * Structure containing the transmit and receive ring buffer of the SIO bulk
+ * mode. A ring is empty if head and tail are equal, so one byte of each
+ * ring remains unused.
+ */
+typedef struct uart_bulk_buffer_tag
+{
+    /* Transmit buffer */
+    uint8_t tx_buf[UART_MAX_TX_BUF_LENGTH];
+
+    /* Receive buffer */
+    uint8_t rx_buf[UART_MAX_RX_BUF_LENGTH];
+
+    /* Next byte to be transmitted, advanced by the ISR */
+    volatile uint16_t tx_buf_head;
+
+    /* Next free byte of transmit buffer, advanced by pal_sio_tx_commit() */
+    volatile uint16_t tx_buf_tail;
+
+    /* Next byte to be read, advanced by pal_sio_rx_release() */
+    volatile uint16_t rx_buf_head;
+
+    /* Next free byte of receive buffer, advanced by the ISR */
+    volatile uint16_t rx_buf_tail;
+
+    /* Receive callback */
+    sio_rx_cb_t rx_cb;
+
+    /* Number of pending bytes to call the receive callback */
+    uint16_t rx_threshold;
+
+    /* Receive buffer tail at the last check for the receive callback */
+    uint16_t rx_seen_tail;
+
+    /* Time of the last change of the receive buffer tail */
+    uint32_t rx_seen_time;
+
+    /* Idle receive line has been indicated to the receive callback */
+    bool rx_idle_indicated;
+
+    /* SIO unit of this buffer */
+    uint8_t sio_unit;
+
+} uart_bulk_buffer_t;
+
+#else   /* !SIO_BULK */
+
 /*
  * Structure containing the transmit and receive buffer
  * and also the buffer head, tail and count
@@ -63,6 +116,8 @@ typedef struct uart_communication_buffer_tag
 
 } uart_communication_buffer_t;
 
+#endif  /* SIO_BULK */
+
 /* === Externals ============================================================ */
 
 
@@ -82,6 +137,17 @@ typedef struct uart_communication_buffer_tag
 /* Transmit interrupt Mask */
 #define TX_INT_MASK (0x40)
 
+/* Data register empty interrupt Mask */
+#define DRE_INT_MASK (0x20)
+
+/*
+ * Time in microseconds without a received byte after which the receive line
+ * is idle in SIO bulk mode
+ */
+#ifndef SIO_RX_IDLE_TIME
+#define SIO_RX_IDLE_TIME            (1000)
+#endif
+
 /* UART0 */
 #ifdef UART0
 /* Enables the RX interrupt of UART0 */
@@ -95,6 +161,12 @@ typedef struct uart_communication_buffer_tag
 
 /* Disables the TX interrupt of UART0 */
 #define DISABLE_UART_0_TX_INT()  (UCSR0B &= ~TX_INT_MASK)
+
+/* Enables the data register empty interrupt of UART0 */
+#define ENABLE_UART_0_DRE_INT()  (UCSR0B |= DRE_INT_MASK)
+
+/* Disables the data register empty interrupt of UART0 */
+#define DISABLE_UART_0_DRE_INT() (UCSR0B &= ~DRE_INT_MASK)
 #endif  /* UART0 */
 
 /* UART1 */
@@ -110,6 +182,12 @@ typedef struct uart_communication_buffer_tag
 
 /* Disables the TX interrupt of UART1 */
 #define DISABLE_UART_1_TX_INT()  (UCSR1B &= ~TX_INT_MASK)
+
+/* Enables the data register empty interrupt of UART1 */
+#define ENABLE_UART_1_DRE_INT()  (UCSR1B |= DRE_INT_MASK)
+
+/* Disables the data register empty interrupt of UART1 */
+#define DISABLE_UART_1_DRE_INT() (UCSR1B &= ~DRE_INT_MASK)
 #endif  /* UART1 */
 
 /* === Prototypes =========================================================== */
@@ -123,6 +201,9 @@ uint8_t sio_uart_0_rx(uint8_t *data, uint8_t max_length);
 uint8_t sio_uart_1_rx(uint8_t *data, uint8_t max_length);
 uint8_t sio_uart_0_tx(uint8_t *data, uint8_t length);
 uint8_t sio_uart_1_tx(uint8_t *data, uint8_t length);
+#ifdef SIO_BULK
+void sio_uart_bulk_task(void);
+#endif
 
 #ifdef __cplusplus
 } /* extern "C" */
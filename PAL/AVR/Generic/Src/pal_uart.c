@@ -19,7 +19,7 @@
 
 /* === Includes ============================================================= */
 
-#if ((defined UART0) || (defined UART1))
+#if (((defined UART0) || (defined UART1)) && !(defined SIO_BULK))
 #include <stdint.h>
 #include "pal_uart.h"
 
@@ -611,6 +611,6 @@ ISR(USART1_TX_vect)
 }
 #endif  /* UART1 */
 
-#endif  /* ((defined UART0) || (defined UART1)) */
+#endif  /* (((defined UART0) || (defined UART1)) && !(defined SIO_BULK)) */
 
 /* EOF */
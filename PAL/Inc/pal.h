@@ -81,6 +81,17 @@ typedef enum sio_serial_tag
 #endif
 
 
+#if defined (SIO_BULK) || defined(DOXYGEN)
+/**
+ * Receive callback of the SIO bulk mode
+ *
+ * @param sio_unit SIO unit that has received data
+ * @param length Number of bytes pending in the receive buffer
+ */
+typedef void (*sio_rx_cb_t)(uint8_t sio_unit, uint16_t length);
+#endif
+
+
 /**
  * Timeout type
  */
@@ -789,6 +800,79 @@ uint8_t pal_sio_tx(uint8_t sio_unit, uint8_t *data, uint8_t length);
  * @ingroup apiPalApi
  */
 uint8_t pal_sio_rx(uint8_t sio_unit, uint8_t *data, uint8_t max_length);
+
+#if defined(SIO_BULK) || defined(DOXYGEN)
+/*
+ * Prototypes for the bulk mode of the UART SIO units (SIO_0, SIO_1).
+ * The bulk mode is enabled with SIO_BULK and provided by pal_uart_bulk.c
+ * instead of pal_uart.c. The transmit and receive buffers of
+ * UART_MAX_TX_BUF_LENGTH and UART_MAX_RX_BUF_LENGTH bytes are indexed with
+ * 16 bit, and are accessed in place.
+ */
+/**
+ * @brief Reserves space in the transmit buffer of an UART SIO unit
+ *
+ * The returned space is contiguous; it is transmitted after it has been
+ * filled and handed over with pal_sio_tx_commit().
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param[out] data Pointer to the reserved space
+ *
+ * @return Number of bytes that can be written at data, 0 if the transmit
+ *         buffer is full
+ * @ingroup apiPalApi
+ */
+uint16_t pal_sio_tx_reserve(uint8_t sio_unit, uint8_t **data);
+
+/**
+ * @brief Transmits bytes written to the space of pal_sio_tx_reserve()
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param length Number of bytes to be transmitted, at most the number
+ *        returned by the preceding pal_sio_tx_reserve()
+ * @ingroup apiPalApi
+ */
+void pal_sio_tx_commit(uint8_t sio_unit, uint16_t length);
+
+/**
+ * @brief Gives access to the received bytes of an UART SIO unit
+ *
+ * The bytes remain in the receive buffer until they are released with
+ * pal_sio_rx_release().
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param[out] data Pointer to the oldest received byte
+ *
+ * @return Number of contiguous bytes at data, 0 if nothing is received
+ * @ingroup apiPalApi
+ */
+uint16_t pal_sio_rx_peek(uint8_t sio_unit, uint8_t **data);
+
+/**
+ * @brief Releases received bytes returned by pal_sio_rx_peek()
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param length Number of bytes to be released, at most the number
+ *        returned by the preceding pal_sio_rx_peek()
+ * @ingroup apiPalApi
+ */
+void pal_sio_rx_release(uint8_t sio_unit, uint16_t length);
+
+/**
+ * @brief Sets the receive callback of an UART SIO unit
+ *
+ * The callback is called from pal_task() when new bytes have been received
+ * and at least threshold bytes are pending, and when the receive line has
+ * been idle for SIO_RX_IDLE_TIME microseconds while bytes are pending.
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param rx_cb Callback function, NULL to remove the callback
+ * @param threshold Number of pending bytes to call the callback,
+ *        0 to call it on an idle receive line only
+ * @ingroup apiPalApi
+ */
+void pal_sio_rx_cb_set(uint8_t sio_unit, sio_rx_cb_t rx_cb, uint16_t threshold);
+#endif  /* defined(SIO_BULK) || defined(DOXYGEN) */
 #endif  /* (defined(SIO_HUB) || defined(DOXYGEN) || (PAL_GENERIC_TYPE==ARM7)) */
 
 
@@ -29,6 +29,10 @@
 #include "pal_usb.h"
 #endif /* USB0 */
 
+#if ((defined SIO_BULK) && ((defined UART0) || (defined UART1)))
+#include "pal_uart.h"
+#endif
+
 /* === Globals ============================================================= */
 
 
@@ -79,6 +83,11 @@ void pal_task(void)
 #ifdef USB0
     usb_handler();
 #endif /* USB0 */
+
+#if ((defined SIO_BULK) && ((defined UART0) || (defined UART1)))
+    /* In SIO bulk mode the receive callbacks are called from here. */
+    sio_uart_bulk_task();
+#endif
 }
 
 
@@ -19,7 +19,7 @@
 
 /* === Includes ============================================================= */
 
-#if ((defined UART0) || (defined UART1))
+#if (((defined UART0) || (defined UART1)) && !(defined SIO_BULK))
 #include <stdint.h>
 #include "pal.h"
 #include "pal_config.h"
@@ -625,6 +625,6 @@ ISR(USART1_TX_vect)
 }
 #endif  /* UART1 */
 
-#endif  /* ((defined UART0) || (defined UART1)) */
+#endif  /* (((defined UART0) || (defined UART1)) && !(defined SIO_BULK)) */
 
 /* EOF */
@@ -0,0 +1,711 @@
+/**
+ * @file pal_uart_bulk.c
+ *
+ * @brief UART bulk mode functions for ATmega128RFA1
+ *
+ * This file implements the SIO bulk mode (SIO_BULK) of the UART for the
+ * ATmega128RFA1. It replaces pal_uart.c if SIO_BULK is defined.
+ *
+ * The transmit and receive buffers are rings with 16 bit indices, which are
+ * accessed in place by the application (pal_sio_tx_reserve() /
+ * pal_sio_tx_commit(), pal_sio_rx_peek() / pal_sio_rx_release()).
+ * The transmitter is fed by the data register empty interrupt, so that
+ * consecutive bytes are sent without a gap. Received bytes are signalled
+ * from pal_task() once a threshold is reached or the line is idle.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================= */
+
+#if (((defined UART0) || (defined UART1)) && (defined SIO_BULK))
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pal.h"
+#include "pal_config.h"
+#include "pal_uart.h"
+
+#ifndef SIO_HUB
+#error "The SIO bulk mode requires SIO_HUB"
+#endif
+
+/* === Macros =============================================================== */
+
+
+/* === Globals ============================================================== */
+
+#if (defined UART0)
+static uart_bulk_buffer_t uart_0_buffer;
+#endif
+
+#if (defined UART1)
+static uart_bulk_buffer_t uart_1_buffer;
+#endif
+
+/* === Prototypes =========================================================== */
+
+static uart_bulk_buffer_t *get_buffer(uint8_t sio_unit);
+static void tx_start(uart_bulk_buffer_t *buffer);
+static uint16_t tx_copy(uart_bulk_buffer_t *buffer, uint8_t *data,
+                        uint16_t length);
+static uint16_t rx_copy(uart_bulk_buffer_t *buffer, uint8_t *data,
+                        uint16_t max_length);
+static inline void rx_put(uart_bulk_buffer_t *buffer, uint8_t data);
+static void rx_check(uart_bulk_buffer_t *buffer);
+
+/* === Implementation ======================================================= */
+
+/**
+ * @brief Returns the buffer of an UART SIO unit
+ *
+ * @param sio_unit Specifies the SIO unit
+ *
+ * @return Buffer of the SIO unit, NULL if it is no UART
+ */
+static uart_bulk_buffer_t *get_buffer(uint8_t sio_unit)
+{
+    switch (sio_unit)
+    {
+#ifdef UART0
+        case SIO_0: return &uart_0_buffer;
+#endif
+#ifdef UART1
+        case SIO_1: return &uart_1_buffer;
+#endif
+        default:    return NULL;
+    }
+}
+
+
+
+/**
+ * @brief Starts the transmitter if the transmit buffer is not empty
+ *
+ * Has to be called with interrupts disabled.
+ *
+ * @param buffer Buffer of the UART
+ */
+static void tx_start(uart_bulk_buffer_t *buffer)
+{
+    if (buffer->tx_buf_head == buffer->tx_buf_tail)
+    {
+        return;
+    }
+
+    /*
+     * The data register empty interrupt is pending as long as the
+     * transmitter can take a byte, hence enabling it starts the transmission.
+     */
+    switch (buffer->sio_unit)
+    {
+#ifdef UART0
+        case SIO_0: ENABLE_UART_0_DRE_INT();
+                    break;
+#endif
+#ifdef UART1
+        case SIO_1: ENABLE_UART_1_DRE_INT();
+                    break;
+#endif
+        default:    break;
+    }
+}
+
+
+
+/**
+ * @brief Reserves contiguous space in the transmit buffer
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param[out] data Pointer to the reserved space
+ *
+ * @return Number of bytes that can be written at data
+ */
+uint16_t pal_sio_tx_reserve(uint8_t sio_unit, uint8_t **data)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+    uint16_t head;
+    uint16_t tail;
+
+    if (NULL == buffer)
+    {
+        return 0;
+    }
+
+    ENTER_CRITICAL_REGION();
+    head = buffer->tx_buf_head;
+    LEAVE_CRITICAL_REGION();
+    tail = buffer->tx_buf_tail;
+
+    *data = &buffer->tx_buf[tail];
+
+    if (head > tail)
+    {
+        return (head - tail - 1);
+    }
+    else if (0 == head)
+    {
+        /* The last byte of the buffer must not reach the head. */
+        return (UART_MAX_TX_BUF_LENGTH - tail - 1);
+    }
+    else
+    {
+        return (UART_MAX_TX_BUF_LENGTH - tail);
+    }
+}
+
+
+
+/**
+ * @brief Transmits the bytes written to the reserved space
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param length Number of bytes to be transmitted
+ */
+void pal_sio_tx_commit(uint8_t sio_unit, uint16_t length)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+    uint16_t tail;
+
+    if ((NULL == buffer) || (0 == length))
+    {
+        return;
+    }
+
+    tail = buffer->tx_buf_tail + length;
+    if (tail >= UART_MAX_TX_BUF_LENGTH)
+    {
+        tail -= UART_MAX_TX_BUF_LENGTH;
+    }
+
+    ENTER_CRITICAL_REGION();
+    buffer->tx_buf_tail = tail;
+    tx_start(buffer);
+    LEAVE_CRITICAL_REGION();
+}
+
+
+
+/**
+ * @brief Gives access to the oldest received bytes
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param[out] data Pointer to the oldest received byte
+ *
+ * @return Number of contiguous bytes at data
+ */
+uint16_t pal_sio_rx_peek(uint8_t sio_unit, uint8_t **data)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+    uint16_t head;
+    uint16_t tail;
+
+    if (NULL == buffer)
+    {
+        return 0;
+    }
+
+    ENTER_CRITICAL_REGION();
+    tail = buffer->rx_buf_tail;
+    LEAVE_CRITICAL_REGION();
+    head = buffer->rx_buf_head;
+
+    *data = &buffer->rx_buf[head];
+
+    if (tail >= head)
+    {
+        return (tail - head);
+    }
+    else
+    {
+        return (UART_MAX_RX_BUF_LENGTH - head);
+    }
+}
+
+
+
+/**
+ * @brief Releases received bytes
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param length Number of bytes to be released
+ */
+void pal_sio_rx_release(uint8_t sio_unit, uint16_t length)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+    uint16_t head;
+
+    if (NULL == buffer)
+    {
+        return;
+    }
+
+    head = buffer->rx_buf_head + length;
+    if (head >= UART_MAX_RX_BUF_LENGTH)
+    {
+        head -= UART_MAX_RX_BUF_LENGTH;
+    }
+
+    ENTER_CRITICAL_REGION();
+    buffer->rx_buf_head = head;
+    LEAVE_CRITICAL_REGION();
+}
+
+
+
+/**
+ * @brief Sets the receive callback
+ *
+ * @param sio_unit Specifies the SIO unit
+ * @param rx_cb Callback function, NULL to remove the callback
+ * @param threshold Number of pending bytes to call the callback
+ */
+void pal_sio_rx_cb_set(uint8_t sio_unit, sio_rx_cb_t rx_cb, uint16_t threshold)
+{
+    uart_bulk_buffer_t *buffer = get_buffer(sio_unit);
+
+    if (NULL == buffer)
+    {
+        return;
+    }
+
+    buffer->rx_threshold = threshold;
+    buffer->rx_idle_indicated = true;
+    ENTER_CRITICAL_REGION();
+    buffer->rx_seen_tail = buffer->rx_buf_tail;
+    LEAVE_CRITICAL_REGION();
+    pal_get_current_time(&buffer->rx_seen_time);
+    buffer->rx_cb = rx_cb;
+}
+
+
+
+/**
+ * @brief Copies data into the transmit buffer and starts the transmission
+ *
+ * @param buffer Buffer of the UART
+ * @param data Data to be transmitted
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Number of bytes copied into the transmit buffer
+ */
+static uint16_t tx_copy(uart_bulk_buffer_t *buffer, uint8_t *data,
+                        uint16_t length)
+{
+    uint16_t copied = 0;
+    uint8_t *space;
+    uint16_t size;
+
+    /* The free space may wrap around the end of the buffer once. */
+    while (copied < length)
+    {
+        size = pal_sio_tx_reserve(buffer->sio_unit, &space);
+        if (0 == size)
+        {
+            break;
+        }
+        if (size > (length - copied))
+        {
+            size = length - copied;
+        }
+        memcpy(space, &data[copied], size);
+        pal_sio_tx_commit(buffer->sio_unit, size);
+        copied += size;
+    }
+
+    return copied;
+}
+
+
+
+/**
+ * @brief Copies received data out of the receive buffer
+ *
+ * @param buffer Buffer of the UART
+ * @param data Buffer for the received data
+ * @param max_length Maximum number of bytes to be copied
+ *
+ * @return Number of bytes copied
+ */
+static uint16_t rx_copy(uart_bulk_buffer_t *buffer, uint8_t *data,
+                        uint16_t max_length)
+{
+    uint16_t copied = 0;
+    uint8_t *received;
+    uint16_t size;
+
+    /* The received bytes may wrap around the end of the buffer once. */
+    while (copied < max_length)
+    {
+        size = pal_sio_rx_peek(buffer->sio_unit, &received);
+        if (0 == size)
+        {
+            break;
+        }
+        if (size > (max_length - copied))
+        {
+            size = max_length - copied;
+        }
+        memcpy(&data[copied], received, size);
+        pal_sio_rx_release(buffer->sio_unit, size);
+        copied += size;
+    }
+
+    return copied;
+}
+
+
+
+/**
+ * @brief Stores a received byte in the receive buffer
+ *
+ * Called by the receive ISR. If the receive buffer is full, the byte is
+ * dropped, since the bytes in the buffer may be in use by the application.
+ *
+ * @param buffer Buffer of the UART
+ * @param data Received byte
+ */
+static inline void rx_put(uart_bulk_buffer_t *buffer, uint8_t data)
+{
+    uint16_t tail = buffer->rx_buf_tail;
+    uint16_t next = tail + 1;
+
+    if (UART_MAX_RX_BUF_LENGTH == next)
+    {
+        next = 0;
+    }
+
+    if (next != buffer->rx_buf_head)
+    {
+        buffer->rx_buf[tail] = data;
+        buffer->rx_buf_tail = next;
+    }
+}
+
+
+
+/**
+ * @brief Calls the receive callback if required
+ *
+ * The callback is called if new bytes have been received and at least the
+ * threshold is pending, or once if the receive line has become idle while
+ * bytes are pending.
+ *
+ * @param buffer Buffer of the UART
+ */
+static void rx_check(uart_bulk_buffer_t *buffer)
+{
+    uint16_t tail;
+    uint16_t pending;
+    uint32_t now;
+    bool indicate = false;
+
+    if (NULL == buffer->rx_cb)
+    {
+        return;
+    }
+
+    ENTER_CRITICAL_REGION();
+    tail = buffer->rx_buf_tail;
+    LEAVE_CRITICAL_REGION();
+
+    if (tail >= buffer->rx_buf_head)
+    {
+        pending = tail - buffer->rx_buf_head;
+    }
+    else
+    {
+        pending = UART_MAX_RX_BUF_LENGTH - buffer->rx_buf_head + tail;
+    }
+
+    pal_get_current_time(&now);
+
+    if (tail != buffer->rx_seen_tail)
+    {
+        /* New bytes have been received. */
+        buffer->rx_seen_tail = tail;
+        buffer->rx_seen_time = now;
+        buffer->rx_idle_indicated = false;
+        if ((buffer->rx_threshold > 0) && (pending >= buffer->rx_threshold))
+        {
+            indicate = true;
+        }
+    }
+    else if ((!buffer->rx_idle_indicated) &&
+             ((now - buffer->rx_seen_time) >= SIO_RX_IDLE_TIME))
+    {
+        /* The receive line has become idle. */
+        buffer->rx_idle_indicated = true;
+        indicate = true;
+    }
+
+    if (indicate && (pending > 0))
+    {
+        buffer->rx_cb(buffer->sio_unit, pending);
+    }
+}
+
+
+
+/**
+ * @brief Calls the receive callbacks of the UARTs if required
+ *
+ * This function is called by pal_task().
+ */
+void sio_uart_bulk_task(void)
+{
+#ifdef UART0
+    rx_check(&uart_0_buffer);
+#endif
+#ifdef UART1
+    rx_check(&uart_1_buffer);
+#endif
+}
+
+
+
+#ifdef UART0
+/**
+ * @brief Initializes UART 0
+ *
+ * This function initializes the UART channel 0.
+ *
+ * @param baud_rate Actual UART baud rate
+ */
+void sio_uart_0_init(uint32_t baud_rate)
+{
+    /* Calculate corresponding value for baud rateregister. */
+    uint16_t baud_rate_reg = UART_BAUD(baud_rate);
+
+    uart_0_buffer.sio_unit = SIO_0;
+
+    /*
+     * Microcontroller's USART register is updated to
+     * run at the given baud rate.
+     */
+    UBRR0H = (baud_rate_reg >> 8) & 0xFF;
+    UBRR0L = (uint8_t)baud_rate_reg;
+
+    /* Faster async mode (UART clock divider = 8, instead of 16) */
+    UCSR0A = (1 << U2X0);
+
+    /* Data Length is 8 bit */
+    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+
+    /*
+     * Receiver and transmitter are enabled.
+     * Receive interrupt is enabled, the data register empty interrupt is
+     * enabled as soon as there is data to transmit.
+     */
+    UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+
+    /*
+     * Boards specific initialization.
+     */
+    UART_0_INIT_NON_GENERIC();
+}
+#endif  /* UART0 */
+
+
+
+#ifdef UART1
+/**
+ * @brief Initializes UART 1
+ *
+ * This function initializes the UART channel 1.
+ *
+ * @param baud_rate Actual UART baud rate
+ */
+void sio_uart_1_init(uint32_t baud_rate)
+{
+    /* Calculate corresponding value for baud rateregister. */
+    uint16_t baud_rate_reg = UART_BAUD(baud_rate);
+
+    uart_1_buffer.sio_unit = SIO_1;
+
+    /*
+     * Microcontroller's USART register is updated to
+     * run at the given baud rate.
+     */
+    UBRR1H = (baud_rate_reg >> 8) & 0xFF;
+    UBRR1L = (uint8_t)baud_rate_reg;
+
+    /* Faster async mode (UART clock divider = 8, instead of 16) */
+    UCSR1A = (1 << U2X1);
+
+    /* Data Length is 8 bit */
+    UCSR1C = (1 << UCSZ11) | (1 << UCSZ10);
+
+    /*
+     * Receiver and transmitter are enabled.
+     * Receive interrupt is enabled, the data register empty interrupt is
+     * enabled as soon as there is data to transmit.
+     */
+    UCSR1B = (1 << RXEN1) | (1 << TXEN1) | (1 << RXCIE1);
+
+    /*
+     * Boards specific initialization.
+     */
+    UART_1_INIT_NON_GENERIC();
+}
+#endif  /* UART1 */
+
+
+
+#ifdef UART0
+/**
+ * @brief Transmit data via UART 0
+ *
+ * @param data Pointer to the buffer where the data to be transmitted is present
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Number of bytes actually transmitted
+ */
+uint8_t sio_uart_0_tx(uint8_t *data, uint8_t length)
+{
+    return (uint8_t)tx_copy(&uart_0_buffer, data, length);
+}
+
+
+
+/**
+ * @brief Receives data from UART 0
+ *
+ * @param data pointer to the buffer where the received data is to be stored
+ * @param max_length maximum length of data to be received
+ *
+ * @return actual number of bytes received
+ */
+uint8_t sio_uart_0_rx(uint8_t *data, uint8_t max_length)
+{
+    return (uint8_t)rx_copy(&uart_0_buffer, data, max_length);
+}
+
+
+
+/**
+ * @brief ISR for UART 0 receive interrupt
+ *
+ * This service routine is executed when a byte is received successfully on
+ * UART channel 0.
+ */
+ISR(USART0_RX_vect)
+{
+    rx_put(&uart_0_buffer, UDR0);
+}
+
+
+
+/**
+ * @brief ISR for UART 0 data register empty interrupt
+ *
+ * This service routine is executed as long as the transmitter of UART
+ * channel 0 can take another byte.
+ */
+ISR(USART0_UDRE_vect)
+{
+    uint16_t head = uart_0_buffer.tx_buf_head;
+
+    UDR0 = uart_0_buffer.tx_buf[head];
+
+    head++;
+    if (UART_MAX_TX_BUF_LENGTH == head)
+    {
+        /* Reached the end of buffer, revert back to beginning of buffer. */
+        head = 0;
+    }
+    uart_0_buffer.tx_buf_head = head;
+
+    if (head == uart_0_buffer.tx_buf_tail)
+    {
+        /* No more data for transmission */
+        DISABLE_UART_0_DRE_INT();
+    }
+}
+#endif  /* UART0 */
+
+
+
+#ifdef UART1
+/**
+ * @brief Transmit data via UART 1
+ *
+ * @param data Pointer to the buffer where the data to be transmitted is present
+ * @param length Number of bytes to be transmitted
+ *
+ * @return Number of bytes actually transmitted
+ */
+uint8_t sio_uart_1_tx(uint8_t *data, uint8_t length)
+{
+    return (uint8_t)tx_copy(&uart_1_buffer, data, length);
+}
+
+
+
+/**
+ * @brief Receives data from UART 1
+ *
+ * @param data pointer to the buffer where the received data is to be stored
+ * @param max_length maximum length of data to be received
+ *
+ * @return actual number of bytes received
+ */
+uint8_t sio_uart_1_rx(uint8_t *data, uint8_t max_length)
+{
+    return (uint8_t)rx_copy(&uart_1_buffer, data, max_length);
+}
+
+
+
+/**
+ * @brief ISR for UART 1 receive interrupt
+ *
+ * This service routine is executed when a byte is received successfully on
+ * UART channel 1.
+ */
+ISR(USART1_RX_vect)
+{
+    rx_put(&uart_1_buffer, UDR1);
+}
+
+
+
+/**
+ * @brief ISR for UART 1 data register empty interrupt
+ *
+ * This service routine is executed as long as the transmitter of UART
+ * channel 1 can take another byte.
+ */
+ISR(USART1_UDRE_vect)
+{
+    uint16_t head = uart_1_buffer.tx_buf_head;
+
+    UDR1 = uart_1_buffer.tx_buf[head];
+
+    head++;
+    if (UART_MAX_TX_BUF_LENGTH == head)
+    {
+        /* Reached the end of buffer, revert back to beginning of buffer. */
+        head = 0;
+    }
+    uart_1_buffer.tx_buf_head = head;
+
+    if (head == uart_1_buffer.tx_buf_tail)
+    {
+        /* No more data for transmission */
+        DISABLE_UART_1_DRE_INT();
+    }
+}
+#endif  /* UART1 */
+
+#endif  /* (((defined UART0) || (defined UART1)) && (defined SIO_BULK)) */
+
+/* EOF */
@@ -220,6 +220,8 @@ typedef enum button_id_tag
 #define UART0_REG                       USARTC0
 #define UART0_RX_ISR_VECT               USARTC0_RXC_vect
 #define UART0_TX_ISR_VECT               USARTC0_TXC_vect
+#define UART0_DRE_ISR_VECT              USARTC0_DRE_vect
+#define UART0_TX_DMA_TRIGSRC            DMA_CH_TRIGSRC_USARTC0_DRE_gc
 #endif
 
 /*
@@ -231,8 +233,10 @@ typedef enum button_id_tag
 #define UART1_TX_PIN                    PIN7_bm
 #define UART1_RX_PIN                    PIN6_bm
 #define UART1_REG                       USARTC1
-#define UART0_RX_ISR_VECT               USARTC1_RXC_vect
-#define UART0_TX_ISR_VECT               USARTC1_TXC_vect
+#define UART1_RX_ISR_VECT               USARTC1_RXC_vect
+#define UART1_TX_ISR_VECT               USARTC1_TXC_vect
+#define UART1_DRE_ISR_VECT              USARTC1_DRE_vect
+#define UART1_TX_DMA_TRIGSRC            DMA_CH_TRIGSRC_USARTC1_DRE_gc
 #endif
 
 /*
@@ -247,6 +247,7 @@ typedef enum button_id_tag
 #define UART0_REG                       USARTD0
 #define UART0_RX_ISR_VECT               USARTD0_RXC_vect
 #define UART0_TX_ISR_VECT               USARTD0_TXC_vect
+#define UART0_DRE_ISR_VECT              USARTD0_DRE_vect
 #endif
 
 /*
@@ -258,8 +259,9 @@ typedef enum button_id_tag
 #define UART1_TX_PIN                    PIN7_bm
 #define UART1_RX_PIN                    PIN6_bm
 #define UART1_REG                       USARTD1
-#define UART0_RX_ISR_VECT               USARTD1_RXC_vect
-#define UART0_TX_ISR_VECT               USARTD1_TXC_vect
+#define UART1_RX_ISR_VECT               USARTD1_RXC_vect
+#define UART1_TX_ISR_VECT               USARTD1_TXC_vect
+#define UART1_DRE_ISR_VECT              USARTD1_DRE_vect
 #endif
 
 /*
@@ -30,6 +30,62 @@
 
 #if ((defined UART0) || (defined UART1))
 
+#ifdef SIO_BULK
+
+#if ((UART_MAX_TX_BUF_LENGTH > 0xFFFF) || (UART_MAX_RX_BUF_LENGTH > 0xFFFF))
+#error "The UART buffers of the SIO bulk mode are limited to 65535 bytes"
+#endif
+
+/*
+ * Structure containing the transmit and receive ring buffer of the SIO bulk
+ * mode. A ring is empty if head and tail are equal, so one byte of each
+ * ring remains unused.
+ */
+typedef struct uart_bulk_buffer_tag
+{
+    /* Transmit buffer */
+    uint8_t tx_buf[UART_MAX_TX_BUF_LENGTH];
+
+    /* Receive buffer */
+    uint8_t rx_buf[UART_MAX_RX_BUF_LENGTH];
+
+    /* Next byte to be transmitted, advanced by the ISR */
+    volatile uint16_t tx_buf_head;
+
+    /* Number of bytes handed over to the DMA controller, 0 if it is idle */
+    volatile uint16_t tx_dma_length;
+
+    /* Next free byte of transmit buffer, advanced by pal_sio_tx_commit() */
+    volatile uint16_t tx_buf_tail;
+
+    /* Next byte to be read, advanced by pal_sio_rx_release() */
+    volatile uint16_t rx_buf_head;
+
+    /* Next free byte of receive buffer, advanced by the ISR */
+    volatile uint16_t rx_buf_tail;
+
+    /* Receive callback */
+    sio_rx_cb_t rx_cb;
+
+    /* Number of pending bytes to call the receive callback */
+    uint16_t rx_threshold;
+
+    /* Receive buffer tail at the last check for the receive callback */
+    uint16_t rx_seen_tail;
+
+    /* Time of the last change of the receive buffer tail */
+    uint32_t rx_seen_time;
+
+    /* Idle receive line has been indicated to the receive callback */
+    bool rx_idle_indicated;
+
+    /* SIO unit of this buffer */
+    uint8_t sio_unit;
+
+} uart_bulk_buffer_t;
+
+#else   /* !SIO_BULK */
+
 /*
  * Structure containing the transmit and receive buffer
  * and also the buffer head, tail and count
@@ -62,6 +118,8 @@ typedef struct uart_communication_buffer_tag
 
 } uart_communication_buffer_t;
 
+#endif  /* SIO_BULK */
+
 /* === Externals ============================================================ */
 
 
@@ -80,6 +138,14 @@ typedef struct uart_communication_buffer_tag
 /* Transmit interrupt Mask */
 #define TX_INT_MASK (0x40)
 
+/*
+ * Time in microseconds without a received byte after which the receive line
+ * is idle in SIO bulk mode
+ */
+#ifndef SIO_RX_IDLE_TIME
+#define SIO_RX_IDLE_TIME            (1000)
+#endif
+
 /* UART0 */
 #ifdef UART0
 /* Enables the RX interrupt of UART0 */
@@ -93,6 +159,21 @@ typedef struct uart_communication_buffer_tag
 
 /* Disables the TX interrupt of UART0 */
 #define DISABLE_UART_0_TX_INT()  (UART0_REG.CTRLA &= ~USART_TXCINTLVL_gm)
+
+/* Enables the data register empty interrupt of UART0 */
+#define ENABLE_UART_0_DRE_INT()  (UART0_REG.CTRLA |= USART_DREINTLVL_gm)
+
+/* Disables the data register empty interrupt of UART0 */
+#define DISABLE_UART_0_DRE_INT() (UART0_REG.CTRLA &= ~USART_DREINTLVL_gm)
+
+/*
+ * In SIO bulk mode the transmitter of UART0 is fed by DMA channel 0 if the
+ * board provides a DMA trigger source (UART0_TX_DMA_TRIGSRC).
+ */
+#ifdef UART0_TX_DMA_TRIGSRC
+#define UART0_TX_DMA_CH              (DMA.CH0)
+#define UART0_TX_DMA_ISR_VECT        DMA_CH0_vect
+#endif
 #endif  /* UART0 */
 
 /* UART1 */
@@ -108,6 +189,21 @@ typedef struct uart_communication_buffer_tag
 
 /* Disables the TX interrupt of UART1 */
 #define DISABLE_UART_1_TX_INT()  (UART1_REG.CTRLA &= ~USART_TXCINTLVL_gm)
+
+/* Enables the data register empty interrupt of UART1 */
+#define ENABLE_UART_1_DRE_INT()  (UART1_REG.CTRLA |= USART_DREINTLVL_gm)
+
+/* Disables the data register empty interrupt of UART1 */
+#define DISABLE_UART_1_DRE_INT() (UART1_REG.CTRLA &= ~USART_DREINTLVL_gm)
+
+/*
+ * In SIO bulk mode the transmitter of UART1 is fed by DMA channel 1 if the
+ * board provides a DMA trigger source (UART1_TX_DMA_TRIGSRC).
+ */
+#ifdef UART1_TX_DMA_TRIGSRC
+#define UART1_TX_DMA_CH              (DMA.CH1)
+#define UART1_TX_DMA_ISR_VECT        DMA_CH1_vect
+#endif
 #endif  /* UART1 */
 
 /* === Prototypes =========================================================== */
@@ -121,6 +217,9 @@ uint8_t sio_uart_0_rx(uint8_t *data, uint8_t max_length);
 uint8_t sio_uart_1_rx(uint8_t *data, uint8_t max_length);
 uint8_t sio_uart_0_tx(uint8_t *data, uint8_t length);
 uint8_t sio_uart_1_tx(uint8_t *data, uint8_t length);
+#ifdef SIO_BULK
+void sio_uart_bulk_task(void);
+#endif
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -24,6 +24,10 @@
 #include "pal_timer.h"
 #include "pal_internal.h"
 
+#if ((defined SIO_BULK) && ((defined UART0) || (defined UART1)))
+#include "pal_uart.h"
+#endif
+
 /* === Globals ============================================================= */
 
 /*
@@ -83,6 +87,11 @@ void pal_task(void)
 #if (TOTAL_NUMBER_OF_TIMERS > 0)
     timer_service();
 #endif
+
+#if ((defined SIO_BULK) && ((defined UART0) || (defined UART1)))
+    /* In SIO bulk mode the receive callbacks are called from here. */
+    sio_uart_bulk_task();
+#endif
 }
 
 
@@ -19,7 +19,7 @@
 
 /* === Includes ============================================================= */
 
-#if ((defined UART0) || (defined UART1))
+#if (((defined UART0) || (defined UART1)) && !(defined SIO_BULK))
 #include <stdint.h>
 #include "pal.h"
 #include "pal_config.h"
@@ -565,7 +565,7 @@ ISR(UART0_TX_ISR_VECT)
  * This service routine is executed when a byte is received successfully on
  * UART channel 1.
  */
-ISR(UART0_RX_ISR_VECT)
+ISR(UART1_RX_ISR_VECT)
 {
     uint8_t tail = uart_1_buffer.rx_buf_tail;
 
@@ -593,7 +593,7 @@ ISR(UART0_RX_ISR_VECT)
  * This service routine is executed when a byte is transmitted successfully on
  * UART channel 1.
  */
-ISR(UART0_TX_ISR_VECT)
+ISR(UART1_TX_ISR_VECT)
 {
     if ((UART_MAX_TX_BUF_LENGTH - 1) == uart_1_buffer.tx_buf_head)
     {
@@ -621,6 +621,6 @@ ISR(UART0_TX_ISR_VECT)
 }
 #endif  /* UART1 */
 
-#endif  /* ((defined UART0) || (defined UART1)) */
+#endif  /* (((defined UART0) || (defined UART1)) && !(defined SIO_BULK)) */
 
 /* EOF */
@@ -26,6 +26,7 @@
 #include "tal.h"
 #include "ieee_const.h"
 #include "app_config.h"
+#include "tlm.h"
 
 #if (TOTAL_NUMBER_OF_BUFS > 0)
 
@@ -199,6 +200,11 @@ buffer_t *bmm_buffer_alloc(uint8_t size)
     size = size;    /* Keep compiler happy. */
 #endif
 
+    if (NULL == pfree_buffer)
+    {
+        TLM_EVENT(TLM_EV_BUFFER_EXHAUSTED, size, 0);
+    }
+
     return pfree_buffer;
 }
 
@@ -0,0 +1,548 @@
+/**
+ * @file tlm_decode.c
+ *
+ * @brief Decoder of the binary telemetry of the stack
+ *
+ * Reads the telemetry batches (see Include/tlm.h) from a file or a serial
+ * port and prints one line per event: the time since the first event, the
+ * time since the previous event, the event and its arguments. Other output
+ * of the application and corrupted batches are skipped. With -s a summary
+ * of the event counts and transmission results is printed at the end.
+ *
+ * Usage: tlm_decode [-s] [input]
+ *
+ * Input defaults to stdin ("-"), so a live timeline is printed by
+ *     stty -F /dev/ttyUSB0 raw 9600
+ *     tlm_decode /dev/ttyUSB0
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "tlm.h"
+
+/* === MACROS ============================================================== */
+
+#define IN_BUF_SIZE     (4096)
+
+/** Status values of the transmission, see return_val.h */
+#define STATUS_SUCCESS                  (0x00)
+#define STATUS_CHANNEL_ACCESS_FAILURE   (0xE1)
+#define STATUS_NO_ACK                   (0xE9)
+
+/** Number of event ids counted in the summary */
+#define NUM_EVENTS                      (TLM_EV_TIMER_EXPIRED + 1)
+
+/* === TYPES =============================================================== */
+
+typedef struct name_tag
+{
+    uint8_t value;
+    const char *name;
+} name_t;
+
+/* === GLOBALS ============================================================= */
+
+static const char *const event_names[NUM_EVENTS] =
+{
+    "LOST",
+    "MAC_DISPATCH",
+    "MAC_STATE",
+    "TX_START",
+    "TX_DONE",
+    "RX_FRAME",
+    "RX_CRC_ERROR",
+    "BUFFER_EXHAUSTED",
+    "TRX_SLEEP",
+    "TRX_WAKEUP",
+    "TIMER_EXPIRED"
+};
+
+/** Message ids, see mac_msg_const.h */
+static const name_t message_names[] =
+{
+    { 0x00, "TAL_DATA_INDICATION" },
+    { 0x01, "MLME_ASSOCIATE_REQUEST" },
+    { 0x02, "MLME_ASSOCIATE_RESPONSE" },
+    { 0x03, "MCPS_DATA_REQUEST" },
+    { 0x04, "MCPS_PURGE_REQUEST" },
+    { 0x05, "MLME_DISASSOCIATE_REQUEST" },
+    { 0x06, "MLME_SET_REQUEST" },
+    { 0x07, "MLME_ORPHAN_RESPONSE" },
+    { 0x08, "MLME_GET_REQUEST" },
+    { 0x09, "MLME_RESET_REQUEST" },
+    { 0x0A, "MLME_RX_ENABLE_REQUEST" },
+    { 0x0B, "MLME_SCAN_REQUEST" },
+    { 0x0D, "MLME_START_REQUEST" },
+    { 0x0E, "MLME_POLL_REQUEST" },
+    { 0x0F, "MLME_SYNC_REQUEST" },
+    { 0x10, "MCPS_DATA_CONFIRM" },
+    { 0x11, "MCPS_DATA_INDICATION" },
+    { 0x12, "MCPS_PURGE_CONFIRM" },
+    { 0x13, "MLME_ASSOCIATE_INDICATION" },
+    { 0x14, "MLME_ASSOCIATE_CONFIRM" },
+    { 0x15, "MLME_DISASSOCIATE_INDICATION" },
+    { 0x16, "MLME_DISASSOCIATE_CONFIRM" },
+    { 0x17, "MLME_BEACON_NOTIFY_INDICATION" },
+    { 0x1A, "MLME_ORPHAN_INDICATION" },
+    { 0x1B, "MLME_SCAN_CONFIRM" },
+    { 0x1C, "MLME_COMM_STATUS_INDICATION" },
+    { 0x1D, "MLME_SYNC_LOSS_INDICATION" },
+    { 0x1E, "MLME_GET_CONFIRM" },
+    { 0x1F, "MLME_SET_CONFIRM" },
+    { 0x20, "MLME_RESET_CONFIRM" },
+    { 0x21, "MLME_RX_ENABLE_CONFIRM" },
+    { 0x22, "MLME_START_CONFIRM" },
+    { 0x23, "MLME_POLL_CONFIRM" },
+    { 0, NULL }
+};
+
+/** Status values, see return_val.h */
+static const name_t status_names[] =
+{
+    { 0x00, "SUCCESS" },
+    { 0x85, "FAILURE" },
+    { 0x86, "TAL_BUSY" },
+    { 0x87, "FRAME_PENDING" },
+    { 0xE1, "CHANNEL_ACCESS_FAILURE" },
+    { 0xE8, "INVALID_PARAMETER" },
+    { 0xE9, "NO_ACK" },
+    { 0, NULL }
+};
+
+/** Message types of transmitted frames, see frame_msgtype_t in tal.h */
+static const name_t msgtype_names[] =
+{
+    { 0x01, "ASSOCIATION_REQUEST" },
+    { 0x02, "ASSOCIATION_RESPONSE" },
+    { 0x03, "DISASSOCIATION_NOTIFICATION" },
+    { 0x04, "DATA_REQUEST" },
+    { 0x05, "PANID_CONFLICT_NOTIFICATION" },
+    { 0x06, "ORPHAN_NOTIFICATION" },
+    { 0x07, "BEACON_REQUEST" },
+    { 0x08, "COORDINATOR_REALIGNMENT" },
+    { 0x09, "ORPHAN_REALIGNMENT" },
+    { 0x0A, "BEACON" },
+    { 0x0B, "DATA_REQUEST_IMPL_POLL" },
+    { 0x0C, "NULL_FRAME" },
+    { 0x0D, "MCPS_DATA" },
+    { 0, NULL }
+};
+
+static const char *const mac_state_names[] =
+{
+    "IDLE", "ASSOCIATED", "COORDINATOR", "PAN_COORD_STARTED"
+};
+
+static const char *const scan_state_names[] =
+{
+    "IDLE", "ED", "ACTIVE", "ORPHAN", "PASSIVE"
+};
+
+static const char *const sync_state_names[] =
+{
+    "NEVER", "ONCE", "TRACKING_BEACON", "BEFORE_ASSOC"
+};
+
+static const char *const csma_mode_names[] =
+{
+    "NO_CSMA_NO_IFS", "NO_CSMA_WITH_IFS", "CSMA_UNSLOTTED", "CSMA_SLOTTED"
+};
+
+static int in_fd;
+static uint8_t in_buf[IN_BUF_SIZE];
+static size_t in_pos;
+static size_t in_len;
+
+static bool summary;
+
+/** Time of the first and the previous event, unwrapped to 64 bit */
+static uint64_t time_us;
+static uint64_t first_time_us;
+static uint32_t last_time;
+static bool first_event = true;
+
+/** Time of the pending TX_START event */
+static uint64_t tx_start_us;
+static bool tx_pending;
+
+static uint32_t event_cnt[NUM_EVENTS];
+static uint32_t user_cnt;
+static uint32_t lost_cnt;
+static uint32_t tx_status_cnt[256];
+static uint64_t tx_time_sum_us;
+static uint32_t tx_time_max_us;
+static uint32_t tx_time_cnt;
+static uint32_t batches;
+static uint32_t skipped;
+
+/* === PROTOTYPES ========================================================== */
+
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Makes at least length octets of the input available at in_pos
+ *
+ * @return false at the end of the input
+ */
+static bool need(size_t length)
+{
+    ssize_t n;
+
+    if ((in_len - in_pos) >= length)
+    {
+        return true;
+    }
+
+    memmove(in_buf, &in_buf[in_pos], in_len - in_pos);
+    in_len -= in_pos;
+    in_pos = 0;
+
+    while (in_len < length)
+    {
+        /* read() returns what is available, so a live stream is not delayed. */
+        n = read(in_fd, &in_buf[in_len], IN_BUF_SIZE - in_len);
+        if (n <= 0)
+        {
+            return false;
+        }
+        in_len += (size_t)n;
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Formats a value without name; up to four of them are printed in one line
+ */
+static const char *unknown_name(uint8_t value)
+{
+    static char unknown[4][8];
+    static uint8_t next;
+    char *s = unknown[next++ & 3];
+
+    snprintf(s, sizeof(unknown[0]), "0x%02X", value);
+    return s;
+}
+
+
+
+static const char *lookup(const name_t *names, uint8_t value)
+{
+    for (; names->name != NULL; names++)
+    {
+        if (names->value == value)
+        {
+            return names->name;
+        }
+    }
+
+    return unknown_name(value);
+}
+
+
+
+static const char *state_name(const char *const *names, size_t count, uint8_t value)
+{
+    if (value < count)
+    {
+        return names[value];
+    }
+
+    return unknown_name(value);
+}
+
+#define STATE_NAME(names, value)    state_name(names, sizeof(names) / sizeof(names[0]), value)
+
+
+
+/**
+ * @brief Prints an event record
+ */
+static void print_record(const uint8_t *rec)
+{
+    uint32_t time = (uint32_t)rec[TLM_REC_OFF_TIME] |
+                    ((uint32_t)rec[TLM_REC_OFF_TIME + 1] << 8) |
+                    ((uint32_t)rec[TLM_REC_OFF_TIME + 2] << 16) |
+                    ((uint32_t)rec[TLM_REC_OFF_TIME + 3] << 24);
+    uint8_t id = rec[TLM_REC_OFF_ID];
+    uint8_t arg8 = rec[TLM_REC_OFF_ARG8];
+    uint16_t arg16 = (uint16_t)rec[TLM_REC_OFF_ARG16] |
+                     ((uint16_t)rec[TLM_REC_OFF_ARG16 + 1] << 8);
+    uint32_t delta;
+    uint32_t tx_time;
+
+    if (first_event)
+    {
+        first_event = false;
+        time_us = time;
+        first_time_us = time;
+        delta = 0;
+    }
+    else
+    {
+        /* The 32 bit time wraps after 71 minutes. */
+        delta = time - last_time;
+        time_us += delta;
+    }
+    last_time = time;
+
+    printf("%12.6f +%-10u ", (double)(time_us - first_time_us) / 1e6, delta);
+
+    if (id >= TLM_EV_USER)
+    {
+        user_cnt++;
+        printf("USER_%-11u arg8=%u arg16=%u\n", id - TLM_EV_USER, arg8, arg16);
+        return;
+    }
+
+    if (id >= NUM_EVENTS)
+    {
+        printf("0x%02X             arg8=%u arg16=%u\n", id, arg8, arg16);
+        return;
+    }
+
+    event_cnt[id]++;
+    printf("%-16s ", event_names[id]);
+
+    switch (id)
+    {
+        case TLM_EV_LOST:
+            lost_cnt += arg16;
+            /* The end of a pending transmission may be among the lost events. */
+            tx_pending = false;
+            printf("%u events lost", arg16);
+            break;
+
+        case TLM_EV_MAC_DISPATCH:
+            printf("%s", lookup(message_names, arg8));
+            break;
+
+        case TLM_EV_MAC_STATE:
+            printf("mac=%s scan=%s sync=%s",
+                   STATE_NAME(mac_state_names, arg8),
+                   STATE_NAME(scan_state_names, (uint8_t)arg16),
+                   STATE_NAME(sync_state_names, (uint8_t)(arg16 >> 8)));
+            break;
+
+        case TLM_EV_TX_START:
+            tx_start_us = time_us;
+            tx_pending = true;
+            printf("len=%u %s%s", arg8,
+                   STATE_NAME(csma_mode_names, (uint8_t)arg16),
+                   (arg16 >> 8) ? " retry" : "");
+            break;
+
+        case TLM_EV_TX_DONE:
+            tx_status_cnt[arg8]++;
+            printf("%s %s", lookup(status_names, arg8), lookup(msgtype_names, (uint8_t)arg16));
+            if (tx_pending)
+            {
+                tx_time = (uint32_t)(time_us - tx_start_us);
+                tx_time_sum_us += tx_time;
+                tx_time_cnt++;
+                if (tx_time > tx_time_max_us)
+                {
+                    tx_time_max_us = tx_time;
+                }
+                printf(" after %u us", tx_time);
+                tx_pending = false;
+            }
+            break;
+
+        case TLM_EV_RX_FRAME:
+            printf("len=%u lqi=%u ed=%u", arg8, (uint8_t)arg16, (uint8_t)(arg16 >> 8));
+            break;
+
+        case TLM_EV_BUFFER_EXHAUSTED:
+            printf("size=%u", arg8);
+            break;
+
+        case TLM_EV_TRX_SLEEP:
+            printf("mode=%u", arg8);
+            break;
+
+        case TLM_EV_TIMER_EXPIRED:
+            printf("timer=%u", arg8);
+            break;
+
+        default:
+            break;
+    }
+
+    printf("\n");
+}
+
+
+
+static void print_summary(void)
+{
+    unsigned i;
+
+    fprintf(stderr, "\n%u batches, %u octets skipped, %u events lost\n",
+            batches, skipped, lost_cnt);
+
+    for (i = 0; i < NUM_EVENTS; i++)
+    {
+        if (event_cnt[i] > 0)
+        {
+            fprintf(stderr, "  %-16s %10u\n", event_names[i], event_cnt[i]);
+        }
+    }
+    if (user_cnt > 0)
+    {
+        fprintf(stderr, "  %-16s %10u\n", "USER", user_cnt);
+    }
+
+    if (event_cnt[TLM_EV_TX_DONE] > 0)
+    {
+        fprintf(stderr, "Transmissions: %u success, %u CSMA failure, %u no ACK, %u other\n",
+                tx_status_cnt[STATUS_SUCCESS],
+                tx_status_cnt[STATUS_CHANNEL_ACCESS_FAILURE],
+                tx_status_cnt[STATUS_NO_ACK],
+                event_cnt[TLM_EV_TX_DONE] - tx_status_cnt[STATUS_SUCCESS] -
+                tx_status_cnt[STATUS_CHANNEL_ACCESS_FAILURE] - tx_status_cnt[STATUS_NO_ACK]);
+    }
+    if (tx_time_cnt > 0)
+    {
+        fprintf(stderr, "Transmission time: mean %u us, max %u us\n",
+                (unsigned)(tx_time_sum_us / tx_time_cnt), tx_time_max_us);
+    }
+}
+
+
+
+/**
+ * @brief Checks the batch at in_pos
+ *
+ * @return Length of the batch, 0 if no valid batch starts at in_pos
+ */
+static size_t batch_valid(void)
+{
+    const uint8_t *b = &in_buf[in_pos];
+    size_t length;
+    uint8_t check = 0;
+    size_t i;
+
+    if ((b[0] != TLM_SYNC_0) || (b[1] != TLM_SYNC_1) ||
+        (b[2] == 0) || (b[2] > TLM_BATCH_MAX_RECORDS))
+    {
+        return 0;
+    }
+
+    length = TLM_BATCH_HDR_LEN + ((size_t)b[2] * TLM_RECORD_LEN) + 1;
+    if (!need(length))
+    {
+        return 0;
+    }
+    /* need() may have moved the buffer. */
+    b = &in_buf[in_pos];
+
+    for (i = 2; i < (length - 1); i++)
+    {
+        check ^= b[i];
+    }
+
+    return (check == b[length - 1]) ? length : 0;
+}
+
+
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-s] [input]\n"
+                    "  -s  print a summary to stderr at the end of the input\n",
+            name);
+    exit(2);
+}
+
+
+
+/**
+ * @brief Main function of the decoder
+ */
+int main(int argc, char **argv)
+{
+    int opt;
+    size_t length;
+    size_t i;
+
+    while ((opt = getopt(argc, argv, "s")) != -1)
+    {
+        switch (opt)
+        {
+            case 's':
+                summary = true;
+                break;
+
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if ((argc - optind) > 1)
+    {
+        usage(argv[0]);
+    }
+
+    in_fd = STDIN_FILENO;
+    if ((optind < argc) && (strcmp(argv[optind], "-") != 0))
+    {
+        in_fd = open(argv[optind], O_RDONLY);
+        if (in_fd < 0)
+        {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    /* Lines are passed on immediately for a live timeline. */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    while (need(TLM_BATCH_HDR_LEN))
+    {
+        length = batch_valid();
+        if (0 == length)
+        {
+            /* Text output or a corrupted batch; search the next batch. */
+            in_pos++;
+            skipped++;
+            continue;
+        }
+
+        batches++;
+        for (i = TLM_BATCH_HDR_LEN; i < (length - 1); i += TLM_RECORD_LEN)
+        {
+            print_record(&in_buf[in_pos + i]);
+        }
+        in_pos += length;
+    }
+
+    if (summary)
+    {
+        print_summary();
+    }
+
+    return 0;
+}
+
+/* EOF */
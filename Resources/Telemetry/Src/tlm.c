@@ -0,0 +1,237 @@
+/**
+ * @file tlm.c
+ *
+ * @brief Binary telemetry of the stack
+ *
+ * The events are written into a ring of fixed-size records. Events are
+ * generated in interrupt context (TAL) as well as by the main loop, so the
+ * few instructions storing a record run in a critical region. The ring is
+ * read by tlm_task() only, which takes records up to the write index without
+ * locking and converts them to the little endian wire format (see tlm.h).
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pal.h"
+#include "tlm.h"
+
+#ifdef ENABLE_TELEMETRY
+
+#if ((TLM_RING_RECORDS & (TLM_RING_RECORDS - 1)) != 0) || (TLM_RING_RECORDS > 128)
+#error "TLM_RING_RECORDS needs to be a power of two up to 128"
+#endif
+
+/* === Macros ============================================================== */
+
+/** Size of the transmit buffer: a complete batch */
+#define TLM_TX_BUF_SIZE     (TLM_BATCH_HDR_LEN + (TLM_BATCH_MAX_RECORDS * TLM_RECORD_LEN) + 1)
+
+/* === Types =============================================================== */
+
+/**
+ * Event record as stored in the ring
+ */
+typedef struct tlm_record_tag
+{
+    uint32_t time;
+    uint8_t id;
+    uint8_t arg8;
+    uint16_t arg16;
+} tlm_record_t;
+
+/* === Globals ============================================================= */
+
+static tlm_record_t tlm_ring[TLM_RING_RECORDS];
+
+/** Write index, only changed in a critical region */
+static volatile uint8_t tlm_head;
+
+/** Read index, only changed by tlm_task() */
+static uint8_t tlm_tail;
+
+/** Events lost since the last TLM_EV_LOST record, only changed in a critical region */
+static uint16_t tlm_lost;
+
+static uint8_t tlm_sio_unit;
+
+/** Batch being sent */
+static uint8_t tlm_tx_buf[TLM_TX_BUF_SIZE];
+static uint8_t tlm_tx_start;
+static uint8_t tlm_tx_end;
+
+/* === Prototypes ========================================================== */
+
+
+/* === Implementation ====================================================== */
+
+void tlm_init(uint8_t sio_unit)
+{
+    ENTER_CRITICAL_REGION();
+    tlm_head = 0;
+    tlm_tail = 0;
+    tlm_lost = 0;
+    LEAVE_CRITICAL_REGION();
+
+    tlm_sio_unit = sio_unit;
+    tlm_tx_start = 0;
+    tlm_tx_end = 0;
+}
+
+
+
+/**
+ * @brief Stores a record in the ring; called in a critical region
+ *
+ * @return true if the record was stored, false if the ring is full
+ */
+static bool put_event(uint8_t id, uint8_t arg8, uint16_t arg16)
+{
+    tlm_record_t *rec;
+
+    if ((uint8_t)(tlm_head - tlm_tail) >= TLM_RING_RECORDS)
+    {
+        return false;
+    }
+
+    rec = &tlm_ring[tlm_head & (TLM_RING_RECORDS - 1)];
+    /* The time is taken in the critical region to keep the records in order. */
+    pal_get_current_time(&rec->time);
+    rec->id = id;
+    rec->arg8 = arg8;
+    rec->arg16 = arg16;
+    tlm_head++;
+
+    return true;
+}
+
+
+
+void tlm_event(uint8_t id, uint8_t arg8, uint16_t arg16)
+{
+    ENTER_CRITICAL_REGION();
+
+    /* Lost events are reported at the position of the loss in the timeline. */
+    if (tlm_lost > 0)
+    {
+        if (put_event(TLM_EV_LOST, 0, tlm_lost))
+        {
+            tlm_lost = 0;
+        }
+    }
+
+    if ((tlm_lost > 0) || !put_event(id, arg8, arg16))
+    {
+        if (tlm_lost < 0xFFFF)
+        {
+            tlm_lost++;
+        }
+    }
+
+    LEAVE_CRITICAL_REGION();
+}
+
+
+
+/**
+ * @brief Appends a record in wire format to the transmit buffer
+ */
+static void put_record(uint32_t time, uint8_t id, uint8_t arg8, uint16_t arg16)
+{
+    uint8_t *p = &tlm_tx_buf[tlm_tx_end];
+
+    p[TLM_REC_OFF_TIME] = (uint8_t)time;
+    p[TLM_REC_OFF_TIME + 1] = (uint8_t)(time >> 8);
+    p[TLM_REC_OFF_TIME + 2] = (uint8_t)(time >> 16);
+    p[TLM_REC_OFF_TIME + 3] = (uint8_t)(time >> 24);
+    p[TLM_REC_OFF_ID] = id;
+    p[TLM_REC_OFF_ARG8] = arg8;
+    p[TLM_REC_OFF_ARG16] = (uint8_t)arg16;
+    p[TLM_REC_OFF_ARG16 + 1] = (uint8_t)(arg16 >> 8);
+
+    tlm_tx_end += TLM_RECORD_LEN;
+}
+
+
+
+/**
+ * @brief Fills the transmit buffer with a batch of the records of the ring
+ */
+static void build_batch(void)
+{
+    tlm_record_t *rec;
+    uint8_t count = 0;
+    uint8_t check;
+    uint8_t head = tlm_head;
+    uint8_t i;
+
+    tlm_tx_start = 0;
+    tlm_tx_end = TLM_BATCH_HDR_LEN;
+
+    while ((tlm_tail != head) && (count < TLM_BATCH_MAX_RECORDS))
+    {
+        rec = &tlm_ring[tlm_tail & (TLM_RING_RECORDS - 1)];
+        put_record(rec->time, rec->id, rec->arg8, rec->arg16);
+        tlm_tail++;
+        count++;
+    }
+
+    if (0 == count)
+    {
+        tlm_tx_end = 0;
+        return;
+    }
+
+    tlm_tx_buf[0] = TLM_SYNC_0;
+    tlm_tx_buf[1] = TLM_SYNC_1;
+    tlm_tx_buf[2] = count;
+
+    check = 0;
+    for (i = 2; i < tlm_tx_end; i++)
+    {
+        check ^= tlm_tx_buf[i];
+    }
+    tlm_tx_buf[tlm_tx_end++] = check;
+}
+
+
+
+void tlm_task(void)
+{
+    uint8_t sent;
+
+    do
+    {
+        if (tlm_tx_start == tlm_tx_end)
+        {
+            build_batch();
+        }
+
+        if (tlm_tx_start < tlm_tx_end)
+        {
+            sent = pal_sio_tx(tlm_sio_unit, &tlm_tx_buf[tlm_tx_start],
+                              tlm_tx_end - tlm_tx_start);
+            tlm_tx_start += sent;
+        }
+        else
+        {
+            sent = 0;
+        }
+        /* Continue until the ring is empty or the serial interface is busy. */
+    } while (sent > 0);
+}
+
+#endif  /* #ifdef ENABLE_TELEMETRY */
+
+/* EOF */
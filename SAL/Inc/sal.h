@@ -66,6 +66,16 @@
 #define AES_MODE_CBC                 (1)
 #endif
 
+#if (SAL_TYPE == SW_AES_SAL) || defined(DOXYGEN)
+/**
+ * Number of expanded keys held by the software AES, selected by
+ * sal_aes_key_select()
+ */
+#ifndef SAL_AES_KEY_SLOTS
+#define SAL_AES_KEY_SLOTS            (1)
+#endif
+#endif
+
 /* === Types ============================================================== */
 
 
@@ -192,6 +202,23 @@ bool sal_aes_setup(uint8_t *key,
                    uint8_t enc_mode,
                    uint8_t dir);
 
+#if (SAL_TYPE == SW_AES_SAL) || defined(DOXYGEN)
+/**
+ * @brief Selects the key slot used by subsequent AES operations
+ *
+ * The software AES keeps SAL_AES_KEY_SLOTS expanded keys. A key passed to
+ * sal_aes_setup() is expanded into the selected slot; switching between
+ * keys already expanded costs no key expansion.
+ *
+ * @param[in] slot Key slot, 0 ... SAL_AES_KEY_SLOTS - 1
+ *
+ * @return  False if the slot does not exist, true else
+ *
+ * @ingroup apiSalApi
+ */
+bool sal_aes_key_select(uint8_t slot);
+#endif
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
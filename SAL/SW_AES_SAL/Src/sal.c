@@ -0,0 +1,608 @@
+/**
+ * @file sal.c
+ *
+ * @brief Low-level crypto API for a software AES implementation
+ *
+ * This file implements the low-level crypto API for platforms without a
+ * hardware AES engine, such as AT91SAM7X256 with AT86RF230B, for host based
+ * simulations and for gateways handling the secured traffic of many nodes.
+ *
+ * Three implementations of the AES forward cipher are provided; the one
+ * fitting best is selected at compile time:
+ * - a byte oriented implementation with the S-box kept in flash memory
+ *   for 8 bit MCUs (default),
+ * - a 32 bit T-table implementation for 32 bit MCUs such as ARM7, which is
+ *   selected for PAL_GENERIC_TYPE ARM7 and SAM3 or by defining
+ *   SAL_SW_AES_TTABLE,
+ * - an implementation based on the AES-NI instructions for x86 hosts, which is
+ *   selected if the compiler targets AES-NI (e.g. gcc -maes).
+ *
+ * Only the forward cipher (AES_DIR_ENCRYPT) is implemented, since CCM* does
+ * not require the inverse cipher.
+ *
+ * $Id$
+ *
+ */
+/**
+ * @author
+ *      Atmel Corporation: http://www.atmel.com
+ *      Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include "sal_types.h"
+#if (SAL_TYPE == SW_AES_SAL)
+#include <string.h>
+#include "pal.h"
+#include "sal.h"
+
+#if defined(__AES__) && defined(__SSE2__)
+#define SW_AES_NI
+#include <wmmintrin.h>
+#elif defined(SAL_SW_AES_TTABLE) || \
+      (PAL_GENERIC_TYPE == ARM7) || (PAL_GENERIC_TYPE == SAM3)
+#define SW_AES_TTABLE
+#endif
+
+/* === Macros ============================================================== */
+
+/* Number of rounds of AES-128 */
+#define AES_ROUNDS              (10)
+
+/* Multiplication by x in GF(2^8) */
+#define XTIME(x)                ((uint8_t)(((x) << 1) ^ (((x) & 0x80) ? 0x1B : 0x00)))
+
+#ifdef SW_AES_TTABLE
+/* Rotation of a column word by 8, 16 and 24 bits */
+#define ROR32(w, n)             (((w) >> (n)) | ((w) << (32 - (n))))
+
+/* S-box value contained in the T-table */
+#define SBOX_T(x)               ((uint8_t)(te0[(x)] >> 16))
+
+/* Column word built from 4 bytes in big endian order */
+#define LOAD_COLUMN(p)          (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | \
+                                 ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+#endif
+
+/* === Types =============================================================== */
+
+
+/* === Data ============================================================= */
+
+#ifndef SW_AES_NI
+/* Round constants of the key expansion */
+static FLASH_DECLARE(const uint8_t rcon[AES_ROUNDS]) =
+{
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36
+};
+#endif
+
+#if defined(SW_AES_NI)
+
+/* Expanded keys: one round key per round plus the initial one. */
+static __m128i round_keys[SAL_AES_KEY_SLOTS][AES_ROUNDS + 1];
+/* Current state; result of the last AES operation. */
+static __m128i state;
+
+#elif defined(SW_AES_TTABLE)
+
+/*
+ * Combined SubBytes and MixColumns table; each entry holds the column
+ * (2 * S[x], S[x], S[x], 3 * S[x]). The tables of the other rows are
+ * obtained by rotation, which keeps the table size at 1 KByte. The byte at
+ * bit position 16 is the plain S-box value used by the last round and the
+ * key expansion.
+ * Since all supported 32 bit MCUs read constants directly from flash,
+ * this table is accessed without PGM_READ_*().
+ */
+static const uint32_t te0[256] =
+{
+    0xC66363A5UL, 0xF87C7C84UL, 0xEE777799UL, 0xF67B7B8DUL,
+    0xFFF2F20DUL, 0xD66B6BBDUL, 0xDE6F6FB1UL, 0x91C5C554UL,
+    0x60303050UL, 0x02010103UL, 0xCE6767A9UL, 0x562B2B7DUL,
+    0xE7FEFE19UL, 0xB5D7D762UL, 0x4DABABE6UL, 0xEC76769AUL,
+    0x8FCACA45UL, 0x1F82829DUL, 0x89C9C940UL, 0xFA7D7D87UL,
+    0xEFFAFA15UL, 0xB25959EBUL, 0x8E4747C9UL, 0xFBF0F00BUL,
+    0x41ADADECUL, 0xB3D4D467UL, 0x5FA2A2FDUL, 0x45AFAFEAUL,
+    0x239C9CBFUL, 0x53A4A4F7UL, 0xE4727296UL, 0x9BC0C05BUL,
+    0x75B7B7C2UL, 0xE1FDFD1CUL, 0x3D9393AEUL, 0x4C26266AUL,
+    0x6C36365AUL, 0x7E3F3F41UL, 0xF5F7F702UL, 0x83CCCC4FUL,
+    0x6834345CUL, 0x51A5A5F4UL, 0xD1E5E534UL, 0xF9F1F108UL,
+    0xE2717193UL, 0xABD8D873UL, 0x62313153UL, 0x2A15153FUL,
+    0x0804040CUL, 0x95C7C752UL, 0x46232365UL, 0x9DC3C35EUL,
+    0x30181828UL, 0x379696A1UL, 0x0A05050FUL, 0x2F9A9AB5UL,
+    0x0E070709UL, 0x24121236UL, 0x1B80809BUL, 0xDFE2E23DUL,
+    0xCDEBEB26UL, 0x4E272769UL, 0x7FB2B2CDUL, 0xEA75759FUL,
+    0x1209091BUL, 0x1D83839EUL, 0x582C2C74UL, 0x341A1A2EUL,
+    0x361B1B2DUL, 0xDC6E6EB2UL, 0xB45A5AEEUL, 0x5BA0A0FBUL,
+    0xA45252F6UL, 0x763B3B4DUL, 0xB7D6D661UL, 0x7DB3B3CEUL,
+    0x5229297BUL, 0xDDE3E33EUL, 0x5E2F2F71UL, 0x13848497UL,
+    0xA65353F5UL, 0xB9D1D168UL, 0x00000000UL, 0xC1EDED2CUL,
+    0x40202060UL, 0xE3FCFC1FUL, 0x79B1B1C8UL, 0xB65B5BEDUL,
+    0xD46A6ABEUL, 0x8DCBCB46UL, 0x67BEBED9UL, 0x7239394BUL,
+    0x944A4ADEUL, 0x984C4CD4UL, 0xB05858E8UL, 0x85CFCF4AUL,
+    0xBBD0D06BUL, 0xC5EFEF2AUL, 0x4FAAAAE5UL, 0xEDFBFB16UL,
+    0x864343C5UL, 0x9A4D4DD7UL, 0x66333355UL, 0x11858594UL,
+    0x8A4545CFUL, 0xE9F9F910UL, 0x04020206UL, 0xFE7F7F81UL,
+    0xA05050F0UL, 0x783C3C44UL, 0x259F9FBAUL, 0x4BA8A8E3UL,
+    0xA25151F3UL, 0x5DA3A3FEUL, 0x804040C0UL, 0x058F8F8AUL,
+    0x3F9292ADUL, 0x219D9DBCUL, 0x70383848UL, 0xF1F5F504UL,
+    0x63BCBCDFUL, 0x77B6B6C1UL, 0xAFDADA75UL, 0x42212163UL,
+    0x20101030UL, 0xE5FFFF1AUL, 0xFDF3F30EUL, 0xBFD2D26DUL,
+    0x81CDCD4CUL, 0x180C0C14UL, 0x26131335UL, 0xC3ECEC2FUL,
+    0xBE5F5FE1UL, 0x359797A2UL, 0x884444CCUL, 0x2E171739UL,
+    0x93C4C457UL, 0x55A7A7F2UL, 0xFC7E7E82UL, 0x7A3D3D47UL,
+    0xC86464ACUL, 0xBA5D5DE7UL, 0x3219192BUL, 0xE6737395UL,
+    0xC06060A0UL, 0x19818198UL, 0x9E4F4FD1UL, 0xA3DCDC7FUL,
+    0x44222266UL, 0x542A2A7EUL, 0x3B9090ABUL, 0x0B888883UL,
+    0x8C4646CAUL, 0xC7EEEE29UL, 0x6BB8B8D3UL, 0x2814143CUL,
+    0xA7DEDE79UL, 0xBC5E5EE2UL, 0x160B0B1DUL, 0xADDBDB76UL,
+    0xDBE0E03BUL, 0x64323256UL, 0x743A3A4EUL, 0x140A0A1EUL,
+    0x924949DBUL, 0x0C06060AUL, 0x4824246CUL, 0xB85C5CE4UL,
+    0x9FC2C25DUL, 0xBDD3D36EUL, 0x43ACACEFUL, 0xC46262A6UL,
+    0x399191A8UL, 0x319595A4UL, 0xD3E4E437UL, 0xF279798BUL,
+    0xD5E7E732UL, 0x8BC8C843UL, 0x6E373759UL, 0xDA6D6DB7UL,
+    0x018D8D8CUL, 0xB1D5D564UL, 0x9C4E4ED2UL, 0x49A9A9E0UL,
+    0xD86C6CB4UL, 0xAC5656FAUL, 0xF3F4F407UL, 0xCFEAEA25UL,
+    0xCA6565AFUL, 0xF47A7A8EUL, 0x47AEAEE9UL, 0x10080818UL,
+    0x6FBABAD5UL, 0xF0787888UL, 0x4A25256FUL, 0x5C2E2E72UL,
+    0x381C1C24UL, 0x57A6A6F1UL, 0x73B4B4C7UL, 0x97C6C651UL,
+    0xCBE8E823UL, 0xA1DDDD7CUL, 0xE874749CUL, 0x3E1F1F21UL,
+    0x964B4BDDUL, 0x61BDBDDCUL, 0x0D8B8B86UL, 0x0F8A8A85UL,
+    0xE0707090UL, 0x7C3E3E42UL, 0x71B5B5C4UL, 0xCC6666AAUL,
+    0x904848D8UL, 0x06030305UL, 0xF7F6F601UL, 0x1C0E0E12UL,
+    0xC26161A3UL, 0x6A35355FUL, 0xAE5757F9UL, 0x69B9B9D0UL,
+    0x17868691UL, 0x99C1C158UL, 0x3A1D1D27UL, 0x279E9EB9UL,
+    0xD9E1E138UL, 0xEBF8F813UL, 0x2B9898B3UL, 0x22111133UL,
+    0xD26969BBUL, 0xA9D9D970UL, 0x078E8E89UL, 0x339494A7UL,
+    0x2D9B9BB6UL, 0x3C1E1E22UL, 0x15878792UL, 0xC9E9E920UL,
+    0x87CECE49UL, 0xAA5555FFUL, 0x50282878UL, 0xA5DFDF7AUL,
+    0x038C8C8FUL, 0x59A1A1F8UL, 0x09898980UL, 0x1A0D0D17UL,
+    0x65BFBFDAUL, 0xD7E6E631UL, 0x844242C6UL, 0xD06868B8UL,
+    0x824141C3UL, 0x299999B0UL, 0x5A2D2D77UL, 0x1E0F0F11UL,
+    0x7BB0B0CBUL, 0xA85454FCUL, 0x6DBBBBD6UL, 0x2C16163AUL
+};
+
+/* Expanded keys as column words. */
+static uint32_t round_keys[SAL_AES_KEY_SLOTS][4 * (AES_ROUNDS + 1)];
+/* Current state; result of the last AES operation. */
+static uint8_t state[AES_BLOCKSIZE];
+
+#else   /* byte oriented */
+
+/* S-box */
+static FLASH_DECLARE(const uint8_t sbox[256]) =
+{
+    0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+    0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+    0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+    0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+    0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+    0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+    0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+    0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+    0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+    0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+    0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+    0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+    0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+    0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+    0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+    0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+};
+
+/* Expanded keys. */
+static uint8_t round_keys[SAL_AES_KEY_SLOTS][AES_BLOCKSIZE * (AES_ROUNDS + 1)];
+/* Current state; result of the last AES operation. */
+static uint8_t state[AES_BLOCKSIZE];
+
+#endif  /* SW_AES_NI, SW_AES_TTABLE */
+
+/* Key slot used by the AES operations. */
+static uint8_t key_slot;
+/* Actual encryption mode: AES_MODE_ECB or AES_MODE_CBC. */
+static uint8_t aes_mode;
+
+/* === Prototypes ========================================================== */
+
+static void expand_key(uint8_t *key);
+#ifndef SW_AES_NI
+static void encrypt_state(void);
+#endif
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initialization of SAL.
+ *
+ * This functions initializes the SAL.
+ */
+void sal_init(void)
+{
+#if defined(SW_AES_NI)
+    state = _mm_setzero_si128();
+#else
+    memset(state, 0, AES_BLOCKSIZE);
+#endif
+}
+
+
+
+/**
+ * @brief Setup AES unit
+ *
+ * This function performs the following tasks as part of the setup of the
+ * AES unit: key expansion into the selected key slot and setting the
+ * encryption mode.
+ *
+ * @param[in] key AES key or NULL (NULL: use last key)
+ * @param[in] enc_mode  AES_MODE_ECB or AES_MODE_CBC
+ * @param[in] dir must be AES_DIR_ENCRYPT
+ *
+ * @return  False if some parameter was illegal, true else
+ */
+bool sal_aes_setup(uint8_t *key,
+                   uint8_t enc_mode,
+                   uint8_t dir)
+{
+    if ((dir != AES_DIR_ENCRYPT) ||
+        ((enc_mode != AES_MODE_ECB) && (enc_mode != AES_MODE_CBC)))
+    {
+        return (false);
+    }
+
+    if (key != NULL)
+    {
+        expand_key(key);
+    }
+
+    aes_mode = enc_mode;
+
+    return (true);
+}
+
+
+
+/**
+ * @brief Selects the key slot used by subsequent AES operations
+ *
+ * @param[in] slot Key slot, 0 ... SAL_AES_KEY_SLOTS - 1
+ *
+ * @return  False if the slot does not exist, true else
+ */
+bool sal_aes_key_select(uint8_t slot)
+{
+    if (slot >= SAL_AES_KEY_SLOTS)
+    {
+        return (false);
+    }
+
+    key_slot = slot;
+
+    return (true);
+}
+
+
+
+/**
+ * @brief Re-inits key and state after a sleep or chip reset
+ *
+ * This function is void for the software AES since the expanded key and the
+ * state are kept in RAM.
+ */
+void sal_aes_restart(void)
+{
+    /* Nothing to be done for software AES */
+}
+
+
+
+/**
+ * @brief En/decrypt one AES block.
+ *
+ * In ECB mode the block is encrypted; in CBC mode the block is XORed to the
+ * result of the previous operation before it is encrypted.
+ * The result is read with sal_aes_read().
+ *
+ * @param[in]  data  AES block to be encrypted
+ */
+void sal_aes_exec(uint8_t *data)
+{
+#if defined(SW_AES_NI)
+    __m128i block = _mm_loadu_si128((const __m128i *)data);
+    uint8_t i;
+
+    if (aes_mode == AES_MODE_CBC)
+    {
+        block = _mm_xor_si128(block, state);
+    }
+
+    block = _mm_xor_si128(block, round_keys[key_slot][0]);
+    for (i = 1; i < AES_ROUNDS; i++)
+    {
+        block = _mm_aesenc_si128(block, round_keys[key_slot][i]);
+    }
+    state = _mm_aesenclast_si128(block, round_keys[key_slot][AES_ROUNDS]);
+#else
+    uint8_t i;
+
+    if (aes_mode == AES_MODE_CBC)
+    {
+        for (i = 0; i < AES_BLOCKSIZE; i++)
+        {
+            state[i] ^= data[i];
+        }
+    }
+    else
+    {
+        memcpy(state, data, AES_BLOCKSIZE);
+    }
+
+    encrypt_state();
+#endif
+}
+
+
+
+/**
+ * @brief Reads the result of previous AES en/decryption
+ *
+ * This function returns the result of the previous AES operation.
+ *
+ * @param[out] data - result of previous operation
+ */
+void sal_aes_read(uint8_t *data)
+{
+#if defined(SW_AES_NI)
+    _mm_storeu_si128((__m128i *)data, state);
+#else
+    memcpy(data, state, AES_BLOCKSIZE);
+#endif
+}
+
+
+
+#if defined(SW_AES_NI)
+
+/* One step of the key expansion; rcon must be a compile time constant. */
+#define EXPAND_STEP(prev, rc)   expand_step((prev), _mm_aeskeygenassist_si128((prev), (rc)))
+
+static inline __m128i expand_step(__m128i key, __m128i assist)
+{
+    assist = _mm_shuffle_epi32(assist, 0xFF);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+
+    return _mm_xor_si128(key, assist);
+}
+
+
+
+/**
+ * @brief Expands a key into the round keys of the selected slot
+ *
+ * @param[in] key AES key
+ */
+static void expand_key(uint8_t *key)
+{
+    __m128i *rk = round_keys[key_slot];
+
+    rk[0] = _mm_loadu_si128((const __m128i *)key);
+    rk[1] = EXPAND_STEP(rk[0], 0x01);
+    rk[2] = EXPAND_STEP(rk[1], 0x02);
+    rk[3] = EXPAND_STEP(rk[2], 0x04);
+    rk[4] = EXPAND_STEP(rk[3], 0x08);
+    rk[5] = EXPAND_STEP(rk[4], 0x10);
+    rk[6] = EXPAND_STEP(rk[5], 0x20);
+    rk[7] = EXPAND_STEP(rk[6], 0x40);
+    rk[8] = EXPAND_STEP(rk[7], 0x80);
+    rk[9] = EXPAND_STEP(rk[8], 0x1B);
+    rk[10] = EXPAND_STEP(rk[9], 0x36);
+}
+
+#elif defined(SW_AES_TTABLE)
+
+/**
+ * @brief Expands a key into the round keys of the selected slot
+ *
+ * @param[in] key AES key
+ */
+static void expand_key(uint8_t *key)
+{
+    uint32_t *rk = round_keys[key_slot];
+    uint8_t i;
+    uint32_t temp;
+
+    for (i = 0; i < 4; i++)
+    {
+        rk[i] = LOAD_COLUMN(&key[i * 4]);
+    }
+
+    for (i = 4; i < (4 * (AES_ROUNDS + 1)); i++)
+    {
+        temp = rk[i - 1];
+        if ((i & 3) == 0)
+        {
+            /* RotWord, SubWord and round constant */
+            temp = ((uint32_t)(SBOX_T((temp >> 16) & 0xFF) ^
+                               PGM_READ_BYTE(&rcon[(i >> 2) - 1])) << 24) |
+                   ((uint32_t)SBOX_T((temp >> 8) & 0xFF) << 16) |
+                   ((uint32_t)SBOX_T(temp & 0xFF) << 8) |
+                   (uint32_t)SBOX_T(temp >> 24);
+        }
+        rk[i] = rk[i - 4] ^ temp;
+    }
+}
+
+
+
+/**
+ * @brief Encrypts the state in place
+ */
+static void encrypt_state(void)
+{
+    uint32_t s0, s1, s2, s3;
+    uint32_t t0, t1, t2, t3;
+    const uint32_t *rk = round_keys[key_slot];
+    uint8_t round;
+
+    s0 = LOAD_COLUMN(&state[0]) ^ rk[0];
+    s1 = LOAD_COLUMN(&state[4]) ^ rk[1];
+    s2 = LOAD_COLUMN(&state[8]) ^ rk[2];
+    s3 = LOAD_COLUMN(&state[12]) ^ rk[3];
+
+    for (round = 1; round < AES_ROUNDS; round++)
+    {
+        rk += 4;
+        t0 = te0[s0 >> 24] ^ ROR32(te0[(s1 >> 16) & 0xFF], 8) ^
+             ROR32(te0[(s2 >> 8) & 0xFF], 16) ^ ROR32(te0[s3 & 0xFF], 24) ^ rk[0];
+        t1 = te0[s1 >> 24] ^ ROR32(te0[(s2 >> 16) & 0xFF], 8) ^
+             ROR32(te0[(s3 >> 8) & 0xFF], 16) ^ ROR32(te0[s0 & 0xFF], 24) ^ rk[1];
+        t2 = te0[s2 >> 24] ^ ROR32(te0[(s3 >> 16) & 0xFF], 8) ^
+             ROR32(te0[(s0 >> 8) & 0xFF], 16) ^ ROR32(te0[s1 & 0xFF], 24) ^ rk[2];
+        t3 = te0[s3 >> 24] ^ ROR32(te0[(s0 >> 16) & 0xFF], 8) ^
+             ROR32(te0[(s1 >> 8) & 0xFF], 16) ^ ROR32(te0[s2 & 0xFF], 24) ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    /* Last round without MixColumns */
+    rk += 4;
+    t0 = (((uint32_t)SBOX_T(s0 >> 24) << 24) | ((uint32_t)SBOX_T((s1 >> 16) & 0xFF) << 16) |
+          ((uint32_t)SBOX_T((s2 >> 8) & 0xFF) << 8) | (uint32_t)SBOX_T(s3 & 0xFF)) ^ rk[0];
+    t1 = (((uint32_t)SBOX_T(s1 >> 24) << 24) | ((uint32_t)SBOX_T((s2 >> 16) & 0xFF) << 16) |
+          ((uint32_t)SBOX_T((s3 >> 8) & 0xFF) << 8) | (uint32_t)SBOX_T(s0 & 0xFF)) ^ rk[1];
+    t2 = (((uint32_t)SBOX_T(s2 >> 24) << 24) | ((uint32_t)SBOX_T((s3 >> 16) & 0xFF) << 16) |
+          ((uint32_t)SBOX_T((s0 >> 8) & 0xFF) << 8) | (uint32_t)SBOX_T(s1 & 0xFF)) ^ rk[2];
+    t3 = (((uint32_t)SBOX_T(s3 >> 24) << 24) | ((uint32_t)SBOX_T((s0 >> 16) & 0xFF) << 16) |
+          ((uint32_t)SBOX_T((s1 >> 8) & 0xFF) << 8) | (uint32_t)SBOX_T(s2 & 0xFF)) ^ rk[3];
+
+    for (round = 0; round < 4; round++)
+    {
+        state[round] = (uint8_t)(t0 >> (24 - 8 * round));
+        state[4 + round] = (uint8_t)(t1 >> (24 - 8 * round));
+        state[8 + round] = (uint8_t)(t2 >> (24 - 8 * round));
+        state[12 + round] = (uint8_t)(t3 >> (24 - 8 * round));
+    }
+}
+
+#else   /* byte oriented */
+
+/**
+ * @brief Expands a key into the round keys of the selected slot
+ *
+ * @param[in] key AES key
+ */
+static void expand_key(uint8_t *key)
+{
+    uint8_t i;
+    uint8_t j;
+    uint8_t *rk;
+
+    memcpy(round_keys[key_slot], key, AES_KEYSIZE);
+
+    for (i = 1; i <= AES_ROUNDS; i++)
+    {
+        rk = &round_keys[key_slot][i * AES_BLOCKSIZE];
+
+        /* RotWord, SubWord and round constant on the last column */
+        rk[0] = rk[-16] ^ PGM_READ_BYTE(&sbox[rk[-3]]) ^ PGM_READ_BYTE(&rcon[i - 1]);
+        rk[1] = rk[-15] ^ PGM_READ_BYTE(&sbox[rk[-2]]);
+        rk[2] = rk[-14] ^ PGM_READ_BYTE(&sbox[rk[-1]]);
+        rk[3] = rk[-13] ^ PGM_READ_BYTE(&sbox[rk[-4]]);
+
+        for (j = 4; j < AES_KEYSIZE; j++)
+        {
+            rk[j] = rk[j - 16] ^ rk[j - 4];
+        }
+    }
+}
+
+
+
+/**
+ * @brief Encrypts the state in place
+ *
+ * SubBytes and ShiftRows are combined into a single pass over the state;
+ * MixColumns uses XTIME() only, so no multiplication tables are needed.
+ */
+static void encrypt_state(void)
+{
+    const uint8_t *rk = round_keys[key_slot];
+    uint8_t round;
+    uint8_t i;
+    uint8_t t;
+
+    for (i = 0; i < AES_BLOCKSIZE; i++)
+    {
+        state[i] ^= rk[i];
+    }
+
+    for (round = 1; round <= AES_ROUNDS; round++)
+    {
+        /* SubBytes; row 0 is not shifted */
+        state[0] = PGM_READ_BYTE(&sbox[state[0]]);
+        state[4] = PGM_READ_BYTE(&sbox[state[4]]);
+        state[8] = PGM_READ_BYTE(&sbox[state[8]]);
+        state[12] = PGM_READ_BYTE(&sbox[state[12]]);
+
+        /* SubBytes and ShiftRows: row 1 is rotated by 1 */
+        t = state[1];
+        state[1] = PGM_READ_BYTE(&sbox[state[5]]);
+        state[5] = PGM_READ_BYTE(&sbox[state[9]]);
+        state[9] = PGM_READ_BYTE(&sbox[state[13]]);
+        state[13] = PGM_READ_BYTE(&sbox[t]);
+
+        /* Row 2 is rotated by 2 */
+        t = state[2];
+        state[2] = PGM_READ_BYTE(&sbox[state[10]]);
+        state[10] = PGM_READ_BYTE(&sbox[t]);
+        t = state[6];
+        state[6] = PGM_READ_BYTE(&sbox[state[14]]);
+        state[14] = PGM_READ_BYTE(&sbox[t]);
+
+        /* Row 3 is rotated by 3 */
+        t = state[15];
+        state[15] = PGM_READ_BYTE(&sbox[state[11]]);
+        state[11] = PGM_READ_BYTE(&sbox[state[7]]);
+        state[7] = PGM_READ_BYTE(&sbox[state[3]]);
+        state[3] = PGM_READ_BYTE(&sbox[t]);
+
+        /* MixColumns, except for the last round */
+        if (round < AES_ROUNDS)
+        {
+            for (i = 0; i < AES_BLOCKSIZE; i += 4)
+            {
+                uint8_t a0 = state[i];
+                uint8_t all = a0 ^ state[i + 1] ^ state[i + 2] ^ state[i + 3];
+
+                state[i] ^= all ^ XTIME(state[i] ^ state[i + 1]);
+                state[i + 1] ^= all ^ XTIME(state[i + 1] ^ state[i + 2]);
+                state[i + 2] ^= all ^ XTIME(state[i + 2] ^ state[i + 3]);
+                state[i + 3] ^= all ^ XTIME(state[i + 3] ^ a0);
+            }
+        }
+
+        /* AddRoundKey */
+        rk += AES_BLOCKSIZE;
+        for (i = 0; i < AES_BLOCKSIZE; i++)
+        {
+            state[i] ^= rk[i];
+        }
+    }
+}
+
+#endif  /* SW_AES_NI, SW_AES_TTABLE */
+
+#endif /* SAL_TYPE == SW_AES_SAL */
+
+/* EOF */
@@ -126,6 +126,16 @@
  */
 #define AUX_HDR_LEN                     (MSDU_POS_KEY_SEQ_NO)
 
+#if defined(STB_ON_SAL) || defined(DOXYGEN)
+/**
+ * Number of keys held by the STB key cache; each key is addressed by its
+ * handle 0 ... STB_KEY_CACHE_SIZE - 1.
+ */
+#ifndef STB_KEY_CACHE_SIZE
+#define STB_KEY_CACHE_SIZE              (4)
+#endif
+#endif
+
 /* === Types ============================================================== */
 
 /**
@@ -140,9 +150,45 @@ typedef enum
 /** No previous key init in stb_ccm_secure() */
     STB_CCM_KEYMISS,
 /** MIC error detected in stb_ccm_secure() */
-    STB_CCM_MICERR
+    STB_CCM_MICERR,
+/** Stale frame counter detected in stb_ccm_unsecure_fresh() */
+    STB_CCM_REPLAY
 } SHORTENUM stb_ccm_t;
 
+#if defined(STB_ON_SAL) || defined(DOXYGEN)
+/**
+ * Statistics of the STB key cache
+ */
+typedef struct stb_key_cache_stats_tag
+{
+    /** Number of CCM* operations whose key was already set up */
+    uint32_t hits;
+    /** Number of CCM* operations that required a key setup */
+    uint32_t misses;
+} stb_key_cache_stats_t;
+
+/**
+ * Descriptor of a frame processed by stb_ccm_secure_batch()
+ */
+typedef struct stb_ccm_frame_tag
+{
+    /** Frame buffer, see stb_ccm_secure() */
+    uint8_t *buffer;
+    /** Nonce of AES_BLOCKSIZE bytes, see stb_ccm_secure() */
+    uint8_t *nonce;
+    /** Handle of a key stored by stb_key_set() */
+    uint8_t key_handle;
+    /** Length of plaintext header */
+    uint8_t hdr_len;
+    /** Length of payload to be encrypted */
+    uint8_t pld_len;
+    /** Security level according to IEEE 802.15.4 */
+    uint8_t sec_level;
+    /** Returned status of the frame */
+    stb_ccm_t status;
+} stb_ccm_frame_t;
+#endif
+
 /* === Externals ========================================================== */
 
 
@@ -176,8 +222,8 @@ void stb_restart(void);
  * This functions secures one block with CCM* according to 802.15.4.
  *
  * @param[in,out] buffer Input: plaintext header and payload concatenated;
- *                       for encryption: MUST HAVE 'AES_BLOCKSIZE'
- *                       BYTES SPACE AT THE END FOR THE MIC!
+ *                       for encryption: must have space for the MIC
+ *                       (mic_len bytes) at the end
  *                       Output: frame secured (with MIC at end)/unsecured
  * @param[in]  nonce   The nonce: Initialization Vector (IV) as used in
  *                     cryptography; the ZigBee nonce (13 bytes long)
@@ -185,7 +231,9 @@ void stb_restart(void);
  * @param[in] key The key to be used; if NULL, use the current key
  * @param[in] hdr_len Length of plaintext header (will not be encrypted)
  * @param[in] pld_len Length of payload to be encrypted; if 0, then only MIC
- *                    authentication implies
+ *                    authentication implies; for security levels without
+ *                    encryption the payload is authenticated as part of
+ *                    the header
  * @param[in] sec_level Security level according to IEEE 802.15.4,
  *                    7.6.2.2.1, Table 95:
  *                    - the value may be 0 ... 7;
@@ -206,6 +254,87 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
                          uint8_t sec_level,
                          uint8_t aes_dir);
 
+#if defined(STB_ON_SAL) || defined(DOXYGEN)
+/**
+ * @brief Stores a key in the STB key cache
+ *
+ * The key is set up in the AES engine with its first use. Replacing the key
+ * of a handle forces a new key setup.
+ *
+ * @param[in] key_handle Handle of the key, 0 ... STB_KEY_CACHE_SIZE - 1
+ * @param[in] key The key
+ *
+ * @return STB_CCM_ILLPARM if a parameter is invalid, STB_CCM_OK otherwise
+ *
+ * @ingroup apiStbApi
+ */
+stb_ccm_t stb_key_set(uint8_t key_handle, uint8_t *key);
+
+/**
+ * @brief Secure one block with CCM* using a cached key
+ *
+ * This function equals stb_ccm_secure(), but the key is addressed by its
+ * handle in the STB key cache. The key setup is only done if the key is
+ * not already set up in the AES engine, and no key comparison is required.
+ *
+ * @param[in,out] buffer See stb_ccm_secure()
+ * @param[in]  nonce   See stb_ccm_secure()
+ * @param[in] key_handle Handle of a key stored by stb_key_set()
+ * @param[in] hdr_len See stb_ccm_secure()
+ * @param[in] pld_len See stb_ccm_secure()
+ * @param[in] sec_level See stb_ccm_secure()
+ * @param[in] aes_dir See stb_ccm_secure()
+ *
+ * @return STB CCM Status; STB_CCM_KEYMISS if no key is stored for the handle
+ *
+ * @ingroup apiStbApi
+ */
+stb_ccm_t stb_ccm_secure_handle(uint8_t *buffer,
+                                uint8_t nonce[AES_BLOCKSIZE],
+                                uint8_t key_handle,
+                                uint8_t hdr_len,
+                                uint8_t pld_len,
+                                uint8_t sec_level,
+                                uint8_t aes_dir);
+
+/**
+ * @brief Secures or unsecures several frames with CCM*
+ *
+ * All frames are processed back to back with the same direction. Compared
+ * to calling stb_ccm_secure_handle() for each frame, the AES engine is
+ * restarted and cleaned up only once, and consecutive frames with the same
+ * key handle need no key setup. The status of each frame is returned in
+ * its descriptor.
+ *
+ * @param[in,out] frames Frame descriptors
+ * @param[in] no_of_frames Number of frame descriptors
+ * @param[in] aes_dir AES_DIR_ENCRYPT if secure, AES_DIR_DECRYPT if unsecure
+ *
+ * @return Number of frames processed with status STB_CCM_OK
+ *
+ * @ingroup apiStbApi
+ */
+uint8_t stb_ccm_secure_batch(stb_ccm_frame_t *frames,
+                             uint8_t no_of_frames,
+                             uint8_t aes_dir);
+
+/**
+ * @brief Gets the hit and miss counters of the STB key cache
+ *
+ * @param[out] stats Key cache statistics
+ *
+ * @ingroup apiStbApi
+ */
+void stb_key_cache_get_stats(stb_key_cache_stats_t *stats);
+
+/**
+ * @brief Resets the hit and miss counters of the STB key cache
+ *
+ * @ingroup apiStbApi
+ */
+void stb_key_cache_reset_stats(void);
+#endif
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
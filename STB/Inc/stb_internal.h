@@ -54,6 +54,14 @@ void encrypt_pldmic(uint8_t *buffer,
 
 void encrypt_with_padding(uint8_t *start, uint8_t buflen);
 
+#if (SAL_TYPE == AT86RF2xx)
+void ccm_encrypt_pipelined(uint8_t *buffer,
+                           uint8_t *nonce,
+                           uint8_t hdr_len,
+                           uint8_t pld_len,
+                           uint8_t mic_len);
+#endif
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
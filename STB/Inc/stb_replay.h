@@ -0,0 +1,208 @@
+/**
+ * @file stb_replay.h
+ *
+ * @brief Declarations for the replay protection of the security tool box
+ *
+ * The replay protection keeps the incoming frame counter of each sender,
+ * addressed by its extended address, and rejects frames whose counter is
+ * not larger than the last one accepted from that sender.
+ *
+ * The most recently used senders are kept in RAM and found via a hash
+ * index. If the table is full, the least recently used sender is moved to
+ * a hash addressed area of the persistent storage (pal_ps_set()), from
+ * where its counter is read back if the sender shows up again. Hence RAM
+ * and persistent storage are bounded, and the lookup of a sender needs at
+ * most one read of the persistent storage.
+ *
+ * Without persistent storage (pal_ps_get() and pal_ps_set() fail, e.g. on
+ * boards without EEPROM), evicted senders are not kept; instead frames of
+ * all senders not held in RAM are only accepted with a frame counter above
+ * the largest one evicted so far. The table size should then cover all
+ * senders of the network.
+ *
+ * $Id$
+ *
+ */
+/**
+ *  @author
+ *      Atmel Corporation: http://www.atmel.com
+ *      Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef STB_REPLAY_H
+#define STB_REPLAY_H
+
+#if defined(STB_ON_SAL) || defined(STB_ARMCRYPTO) || defined(DOXYGEN)
+
+/* === Includes =========================================================== */
+
+#include "stb.h"
+#include "return_val.h"
+
+/* === Macros ============================================================= */
+
+/**
+ * Number of senders whose frame counters are kept in RAM; at most 254.
+ */
+#ifndef STB_REPLAY_TABLE_SIZE
+#define STB_REPLAY_TABLE_SIZE           (16)
+#endif
+
+/**
+ * Number of buckets of the hash index over the senders kept in RAM; has to
+ * be a power of two.
+ */
+#ifndef STB_REPLAY_HASH_SIZE
+#define STB_REPLAY_HASH_SIZE            (16)
+#endif
+
+/**
+ * Start address of the replay protection area within the persistent
+ * storage (internal EEPROM); the area must not overlap with other data,
+ * e.g. the IEEE address stored at EE_IEEE_ADDR.
+ */
+#ifndef STB_REPLAY_PS_ADDR
+#define STB_REPLAY_PS_ADDR              (0x40)
+#endif
+
+/**
+ * Number of buckets of the replay protection area within the persistent
+ * storage; has to be a power of two.
+ */
+#ifndef STB_REPLAY_PS_BUCKETS
+#define STB_REPLAY_PS_BUCKETS           (16)
+#endif
+
+/**
+ * Number of senders stored per bucket of the persistent storage. If more
+ * senders fall into a bucket, the one with the smallest frame counter is
+ * dropped, and unknown senders of this bucket are only accepted with a
+ * frame counter above the dropped one. Hence the persistent storage should
+ * hold all senders of the network.
+ */
+#ifndef STB_REPLAY_PS_WAYS
+#define STB_REPLAY_PS_WAYS              (4)
+#endif
+
+/**
+ * Size of a bucket of the persistent storage in octets: the lowest frame
+ * counter accepted from unknown senders, followed by the extended address
+ * and the frame counter of each sender.
+ */
+#define STB_REPLAY_PS_BUCKET_SIZE       (4 + STB_REPLAY_PS_WAYS * (8 + 4))
+
+/**
+ * Size of the replay protection area within the persistent storage in
+ * octets, including a header identifying the layout.
+ */
+#define STB_REPLAY_PS_SIZE              (4 + STB_REPLAY_PS_BUCKETS * STB_REPLAY_PS_BUCKET_SIZE)
+
+/* === Types ============================================================== */
+
+
+/* === Externals ========================================================== */
+
+
+/* === Prototypes ========================================================= */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the replay protection
+ *
+ * Empties the table in RAM. If the persistent storage does not contain a
+ * replay protection area of the configured layout, the area is formatted;
+ * otherwise the frame counters stored there remain valid.
+ *
+ * @ingroup apiStbApi
+ */
+void stb_replay_init(void);
+
+/**
+ * @brief Checks whether a frame counter is fresh
+ *
+ * The table is not changed, so that frames that fail the MIC verification
+ * do not evict senders or cause writes to the persistent storage.
+ *
+ * @param[in] src_addr Extended address of the sender
+ * @param[in] frame_counter Received frame counter
+ *
+ * @return STB_CCM_REPLAY if the frame counter is not larger than the last
+ *         one accepted from this sender, STB_CCM_OK otherwise
+ *
+ * @ingroup apiStbApi
+ */
+stb_ccm_t stb_replay_check(uint64_t src_addr, uint32_t frame_counter);
+
+/**
+ * @brief Stores the frame counter of an authenticated frame
+ *
+ * Has to be called only after the frame has been verified successfully.
+ * If the sender is not held in RAM and the table is full, the least
+ * recently used sender is written to the persistent storage.
+ *
+ * @param[in] src_addr Extended address of the sender
+ * @param[in] frame_counter Frame counter of the authenticated frame
+ *
+ * @ingroup apiStbApi
+ */
+void stb_replay_update(uint64_t src_addr, uint32_t frame_counter);
+
+/**
+ * @brief Writes all frame counters changed in RAM to the persistent storage
+ *
+ * Frame counters are written to the persistent storage only when evicted
+ * from RAM. This function should be called periodically or before power is
+ * removed, so that frames accepted since then cannot be replayed after a
+ * restart. Counters that cannot be written stay marked as changed.
+ *
+ * @return MAC_SUCCESS if all counters have been written, FAILURE if the
+ *         persistent storage is not available or a write has failed
+ *
+ * @ingroup apiStbApi
+ */
+retval_t stb_replay_flush(void);
+
+/**
+ * @brief Unsecures a frame with CCM* if its frame counter is fresh
+ *
+ * The extended address of the sender and the frame counter are taken from
+ * the nonce (octets 1 ... 8 and 9 ... 12, big endian). A stale frame is
+ * rejected before the MIC is verified; the frame counter of a frame that
+ * has been unsecured successfully is stored.
+ *
+ * @param[in,out] buffer See stb_ccm_secure()
+ * @param[in]  nonce   See stb_ccm_secure()
+ * @param[in] key See stb_ccm_secure()
+ * @param[in] hdr_len See stb_ccm_secure()
+ * @param[in] pld_len See stb_ccm_secure()
+ * @param[in] sec_level See stb_ccm_secure()
+ *
+ * @return STB_CCM_REPLAY if the frame counter is stale, otherwise the
+ *         status of stb_ccm_secure()
+ *
+ * @ingroup apiStbApi
+ */
+stb_ccm_t stb_ccm_unsecure_fresh(uint8_t *buffer,
+                                 uint8_t nonce[AES_BLOCKSIZE],
+                                 uint8_t *key,
+                                 uint8_t hdr_len,
+                                 uint8_t pld_len,
+                                 uint8_t sec_level);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* #if defined(STB_ON_SAL) || defined(STB_ARMCRYPTO) || defined(DOXYGEN) */
+
+#endif /* STB_REPLAY_H */
+/* EOF */
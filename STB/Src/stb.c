@@ -32,15 +32,65 @@
 
 /* === Macros ============================================================== */
 
+/* Handle value indicating that no key is used. */
+#define NO_KEY                  (0xFF)
+
+/*
+ * Number of keys the AES engine holds at a time; the software AES keeps
+ * several expanded keys, the hardware engines only one. On the hardware
+ * engines a cache hit thus only saves the key setup while consecutive
+ * frames use the same key; frames alternating between keys set up the key
+ * for each frame, like without key cache.
+ */
+#if (SAL_TYPE == SW_AES_SAL)
+#define ENGINE_KEY_SLOTS        (SAL_AES_KEY_SLOTS)
+#else
+#define ENGINE_KEY_SLOTS        (1)
+#endif
+
+#if (STB_KEY_CACHE_SIZE >= NO_KEY)
+#error "STB_KEY_CACHE_SIZE is too large"
+#endif
+
 /* === Types =============================================================== */
 
+/* Entry of the key cache */
+typedef struct stb_key_tag
+{
+    /* The key */
+    uint8_t key[AES_KEYSIZE];
+    /* Value of key_stamp when the key was used last */
+    uint16_t last_used;
+    /* Entry holds a key */
+    bool valid;
+} stb_key_t;
+
 /* === Globals ============================================================= */
 
-/* True indicates if key has to be setup. */
-static bool key_change = true;
-static uint8_t last_key[AES_BLOCKSIZE];
+/* Key cache, indexed by the key handle. */
+static stb_key_t stb_keys[STB_KEY_CACHE_SIZE];
+/* Handle of the key set up in each key slot of the AES engine. */
+static uint8_t engine_keys[ENGINE_KEY_SLOTS];
+/* Handle of the key used last; used if stb_ccm_secure() gets no key. */
+static uint8_t current_key = NO_KEY;
+/* Running counter used to find the least recently used key. */
+static uint16_t key_stamp;
+/* Hit and miss counters of the key cache. */
+static stb_key_cache_stats_t key_cache_stats;
 static bool stb_restart_required = false;
 
+/* === Prototypes ========================================================== */
+
+static stb_ccm_t ccm_secure(uint8_t *buffer,
+                            uint8_t *nonce,
+                            uint8_t key_handle,
+                            uint8_t hdr_len,
+                            uint8_t pld_len,
+                            uint8_t sec_level,
+                            uint8_t aes_dir);
+static uint8_t find_key(uint8_t *key);
+static void load_key(uint8_t key_handle);
+
 /* === Implementation ====================================================== */
 
 /**
@@ -51,6 +101,9 @@ static bool stb_restart_required = false;
 void stb_init(void)
 {
     sal_init();
+    memset(stb_keys, 0, sizeof(stb_keys));
+    memset(engine_keys, NO_KEY, sizeof(engine_keys));
+    current_key = NO_KEY;
 }
 
 
@@ -64,8 +117,8 @@ void stb_init(void)
 void stb_restart(void)
 {
     /*
-     * Re-use key_change flag indicating that the AES engine has been power-
-     * cycled and needs to be restarted.
+     * The AES engine has been power-cycled and needs to be restarted
+     * before its next use.
      */
     stb_restart_required = true;
 }
@@ -77,16 +130,19 @@ void stb_restart(void)
  * This functions secures one block with CCM* according to 802.15.4.
  *
  * @param[in,out] buffer Input: plaintext header and payload concatenated;
- *                       for encryption: MUST HAVE 'AES_BLOCKSIZE'
- *                       BYTES SPACE AT THE END FOR THE MIC!
+ *                       for encryption: must have space for the MIC
+ *                       (mic_len bytes) at the end
  *                       Output: frame secured (with MIC at end)/unsecured
  * @param[in]  nonce   The nonce: Initialization Vector (IV) as used in
  *                     cryptography; the ZigBee nonce (13 bytes long)
  *                     are the bytes 2...14 of this nonce
- * @param[in] key The key to be used; if NULL, use the current key
+ * @param[in] key The key to be used; if NULL, use the current key;
+ *                the key is stored in the STB key cache
  * @param[in] hdr_len Length of plaintext header (will not be encrypted)
  * @param[in] pld_len Length of payload to be encrypted; if 0, then only MIC
- *                    authentication implies
+ *                    authentication implies; for security levels without
+ *                    encryption the payload is authenticated as part of
+ *                    the header
  * @param[in] sec_level Security level according to IEEE 802.15.4,
  *                    7.6.2.2.1, Table 95:
  *                    - the value may be 0 ... 7;
@@ -99,15 +155,87 @@ void stb_restart(void)
  */
 stb_ccm_t stb_ccm_secure(uint8_t *buffer,
                          uint8_t nonce[AES_BLOCKSIZE],
-                                 uint8_t *key,
+                         uint8_t *key,
                          uint8_t hdr_len,
                          uint8_t pld_len,
                          uint8_t sec_level,
                          uint8_t aes_dir)
 {
-    uint8_t nonce_0;    /* nonce[0] for MIC computation. */
-    uint8_t mic_len;
-    uint8_t enc_flag;
+    uint8_t key_handle = current_key;
+
+    if (key != NULL)
+    {
+        key_handle = find_key(key);
+    }
+
+    return (stb_ccm_secure_handle(buffer, nonce, key_handle, hdr_len,
+                                  pld_len, sec_level, aes_dir));
+}
+
+
+/**
+ * @brief Secure one block with CCM* using a cached key
+ *
+ * This function equals stb_ccm_secure(), but the key is addressed by its
+ * handle in the STB key cache.
+ *
+ * @param[in,out] buffer See stb_ccm_secure()
+ * @param[in]  nonce   See stb_ccm_secure()
+ * @param[in] key_handle Handle of a key stored by stb_key_set()
+ * @param[in] hdr_len See stb_ccm_secure()
+ * @param[in] pld_len See stb_ccm_secure()
+ * @param[in] sec_level See stb_ccm_secure()
+ * @param[in] aes_dir See stb_ccm_secure()
+ *
+ * @return STB CCM Status
+ *
+ * @ingroup apiStbApi
+ */
+stb_ccm_t stb_ccm_secure_handle(uint8_t *buffer,
+                                uint8_t nonce[AES_BLOCKSIZE],
+                                uint8_t key_handle,
+                                uint8_t hdr_len,
+                                uint8_t pld_len,
+                                uint8_t sec_level,
+                                uint8_t aes_dir)
+{
+    stb_ccm_t status;
+
+    if (stb_restart_required)
+    {
+        sal_aes_restart();
+        stb_restart_required = false;
+    }
+
+    status = ccm_secure(buffer, nonce, key_handle, hdr_len, pld_len,
+                        sec_level, aes_dir);
+
+    sal_aes_clean_up();
+    return (status);
+}
+
+
+/**
+ * @brief Secures or unsecures several frames with CCM*
+ *
+ * The frames are processed back to back; the AES engine is restarted and
+ * cleaned up only once for all frames, and the key is only set up again
+ * if it differs from the key of the previous frame.
+ *
+ * @param[in,out] frames Frame descriptors; the status of each frame is
+ *                       returned in its status element
+ * @param[in] no_of_frames Number of frame descriptors
+ * @param[in] aes_dir AES_DIR_ENCRYPT if secure, AES_DIR_DECRYPT if unsecure
+ *
+ * @return Number of frames processed with status STB_CCM_OK
+ *
+ * @ingroup apiStbApi
+ */
+uint8_t stb_ccm_secure_batch(stb_ccm_frame_t *frames,
+                             uint8_t no_of_frames,
+                             uint8_t aes_dir)
+{
+    uint8_t no_of_ok = 0;
 
     if (stb_restart_required)
     {
@@ -115,6 +243,113 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
         stb_restart_required = false;
     }
 
+    for (; no_of_frames > 0; no_of_frames--, frames++)
+    {
+        frames->status = ccm_secure(frames->buffer,
+                                    frames->nonce,
+                                    frames->key_handle,
+                                    frames->hdr_len,
+                                    frames->pld_len,
+                                    frames->sec_level,
+                                    aes_dir);
+        if (frames->status == STB_CCM_OK)
+        {
+            no_of_ok++;
+        }
+    }
+
+    sal_aes_clean_up();
+    return (no_of_ok);
+}
+
+
+/**
+ * @brief Stores a key in the STB key cache
+ *
+ * @param[in] key_handle Handle of the key, 0 ... STB_KEY_CACHE_SIZE - 1
+ * @param[in] key The key
+ *
+ * @return STB_CCM_ILLPARM if a parameter is invalid, STB_CCM_OK otherwise
+ *
+ * @ingroup apiStbApi
+ */
+stb_ccm_t stb_key_set(uint8_t key_handle, uint8_t *key)
+{
+    uint8_t slot;
+
+    if ((key_handle >= STB_KEY_CACHE_SIZE) || (key == NULL))
+    {
+        return (STB_CCM_ILLPARM);
+    }
+
+    memcpy(stb_keys[key_handle].key, key, AES_KEYSIZE);
+    stb_keys[key_handle].last_used = key_stamp;
+    stb_keys[key_handle].valid = true;
+
+    /* The engine holds the old key of this handle; set it up again. */
+    slot = key_handle % ENGINE_KEY_SLOTS;
+    if (engine_keys[slot] == key_handle)
+    {
+        engine_keys[slot] = NO_KEY;
+    }
+
+    return (STB_CCM_OK);
+}
+
+
+/**
+ * @brief Gets the hit and miss counters of the STB key cache
+ *
+ * @param[out] stats Key cache statistics
+ *
+ * @ingroup apiStbApi
+ */
+void stb_key_cache_get_stats(stb_key_cache_stats_t *stats)
+{
+    *stats = key_cache_stats;
+}
+
+
+/**
+ * @brief Resets the hit and miss counters of the STB key cache
+ *
+ * @ingroup apiStbApi
+ */
+void stb_key_cache_reset_stats(void)
+{
+    key_cache_stats.hits = 0;
+    key_cache_stats.misses = 0;
+}
+
+
+/**
+ * @brief Secures or unsecures one frame with CCM*
+ *
+ * The AES engine has to be restarted before and cleaned up afterwards by
+ * the caller.
+ *
+ * @param[in,out] buffer See stb_ccm_secure()
+ * @param[in]  nonce   See stb_ccm_secure()
+ * @param[in] key_handle Handle of a key stored in the key cache
+ * @param[in] hdr_len See stb_ccm_secure()
+ * @param[in] pld_len See stb_ccm_secure()
+ * @param[in] sec_level See stb_ccm_secure()
+ * @param[in] aes_dir See stb_ccm_secure()
+ *
+ * @return STB CCM Status
+ */
+static stb_ccm_t ccm_secure(uint8_t *buffer,
+                            uint8_t *nonce,
+                            uint8_t key_handle,
+                            uint8_t hdr_len,
+                            uint8_t pld_len,
+                            uint8_t sec_level,
+                            uint8_t aes_dir)
+{
+    uint8_t nonce_0;    /* nonce[0] for MIC computation. */
+    uint8_t mic_len;
+    uint8_t enc_flag;
+
     if (sec_level & 3)
     {
         mic_len = 1 << ((sec_level & 3) + 1);
@@ -134,39 +369,26 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
         ((uint16_t)pld_len + (uint16_t)hdr_len + (uint16_t)mic_len > aMaxPHYPacketSize)
        )
     {
-        sal_aes_clean_up();
         return (STB_CCM_ILLPARM);
     }
 
-    if (key_change && (key == NULL))
+    if ((key_handle >= STB_KEY_CACHE_SIZE) || !stb_keys[key_handle].valid)
     {
-        sal_aes_clean_up();
-        return (STB_CCM_KEYMISS);   /* Initial call, but no key given. */
+        return (STB_CCM_KEYMISS);   /* No key given or stored. */
     }
 
-    /* Setup key if necessary. */
-
-    if(!key_change && key != NULL)    /* There was some previous key. */
+    /*
+     * Without encryption the payload is authenticated as part of the
+     * header (IEEE 802.15.4-2006, 7.6.3.4).
+     */
+    if (!enc_flag)
     {
-        uint8_t i;
-
-        /* Test on changed key. */
-        for (i = AES_BLOCKSIZE; i--; /* */)
-        {
-            key_change |= (last_key[i] ^ key[i]);
-        }
+        hdr_len += pld_len;
+        pld_len = 0;
     }
 
-    if (key_change)
-    {
-        /*
-         * Key must be non-NULL because of test above, and
-         * ECB encryption is always the initial encryption mode.
-         */
-        sal_aes_setup(key, AES_MODE_ECB, AES_DIR_ENCRYPT);
-        memcpy(last_key, key, AES_KEYSIZE);
-        key_change = false;
-    }
+    /* Setup key if necessary. */
+    load_key(key_handle);
 
     /* Prepare nonce. */
 
@@ -185,22 +407,35 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
     nonce_0 = nonce[0];
     nonce[AES_BLOCKSIZE -  2] = 0;
 
+#if (SAL_TYPE == AT86RF2xx)
+    if ((aes_dir == AES_DIR_ENCRYPT) && (mic_len > 0) && enc_flag)
+    {
+        /* Authenticate and encrypt in a single pass. */
+        ccm_encrypt_pipelined(buffer, nonce, hdr_len, pld_len, mic_len);
+    }
+    else
+#endif
     if (aes_dir == AES_DIR_ENCRYPT)
     {
         /* Authenticate. */
         if (mic_len > 0)
         {
+            uint8_t mic[AES_BLOCKSIZE];     /* maximal MIC size */
+
             nonce[AES_BLOCKSIZE - 1] = pld_len;
 
             compute_mic(buffer,
-                        buffer + hdr_len + pld_len,
+                        mic,
                         nonce,
                         hdr_len,
                         pld_len);
+
+            /* Append only the MIC, so no extra space is needed. */
+            memcpy(buffer + hdr_len + pld_len, mic, mic_len);
         }
 
-        /* encrypt payload and MIC */
-        if (enc_flag)
+        /* Encrypt payload and MIC; the MIC is encrypted for all levels. */
+        if (enc_flag || (mic_len > 0))
         {
             nonce[0] = 1;
             encrypt_pldmic(buffer + hdr_len, nonce, mic_len, pld_len);
@@ -209,7 +444,7 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
     else
     {
         /* Decrypt payload and MIC. */
-        if (enc_flag)
+        if (enc_flag || (mic_len > 0))
         {
             nonce[0] = 1;
             encrypt_pldmic(buffer + hdr_len, nonce, mic_len, pld_len);
@@ -219,6 +454,8 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
         if (mic_len > 0)
         {
             uint8_t rcvd_mic[AES_BLOCKSIZE];      /* maximal MIC size */
+            uint8_t diff;
+            uint8_t i;
 
             nonce[0] = nonce_0;
             nonce[AES_BLOCKSIZE - 1] = pld_len;
@@ -231,18 +468,95 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
 
             buffer += hdr_len + pld_len;
 
-            if(memcmp(buffer, rcvd_mic, mic_len))
+            /*
+             * Compare byte by byte without an early exit, so the time
+             * does not depend on the position of the first wrong byte.
+             */
+            diff = 0;
+            for(i = 0; i < mic_len; i++)
+            {
+                diff |= buffer[i] ^ rcvd_mic[i];
+            }
+
+            if(diff)
             {
                 return STB_CCM_MICERR;
             }
         }
     }
 
-    sal_aes_clean_up();
     return (STB_CCM_OK);
 }
 
 
+/**
+ * @brief Finds a key in the key cache, or stores it there
+ *
+ * If the key is not found, it replaces the least recently used key.
+ *
+ * @param[in] key The key
+ *
+ * @return Handle of the key
+ */
+static uint8_t find_key(uint8_t *key)
+{
+    uint8_t i;
+    uint8_t lru = 0;
+
+    for (i = 0; i < STB_KEY_CACHE_SIZE; i++)
+    {
+        if (!stb_keys[i].valid)
+        {
+            lru = i;
+        }
+        else if (memcmp(stb_keys[i].key, key, AES_KEYSIZE) == 0)
+        {
+            return i;
+        }
+        else if (stb_keys[lru].valid &&
+                 ((uint16_t)(key_stamp - stb_keys[i].last_used) >
+                  (uint16_t)(key_stamp - stb_keys[lru].last_used)))
+        {
+            lru = i;
+        }
+    }
+
+    stb_key_set(lru, key);
+
+    return lru;
+}
+
+
+/**
+ * @brief Sets up a key in the AES engine unless it is already set up
+ *
+ * @param[in] key_handle Handle of a valid key
+ */
+static void load_key(uint8_t key_handle)
+{
+    uint8_t slot = key_handle % ENGINE_KEY_SLOTS;
+
+#if (SAL_TYPE == SW_AES_SAL)
+    sal_aes_key_select(slot);
+#endif
+
+    if (engine_keys[slot] == key_handle)
+    {
+        key_cache_stats.hits++;
+    }
+    else
+    {
+        /* ECB encryption is always the initial encryption mode. */
+        sal_aes_setup(stb_keys[key_handle].key, AES_MODE_ECB, AES_DIR_ENCRYPT);
+        engine_keys[slot] = key_handle;
+        key_cache_stats.misses++;
+    }
+
+    stb_keys[key_handle].last_used = ++key_stamp;
+    current_key = key_handle;
+}
+
+
 #endif /* #ifdef STB_ON_SAL */
 
 /* EOF */
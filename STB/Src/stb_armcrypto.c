@@ -6,6 +6,11 @@
  * This file implements the security tool box including
  * CCM* encryption and decryption (without using the SAL API).
  *
+ * The frame is processed in place: the CBC-MAC is fed with 32 bit words
+ * directly from the frame buffer, and the payload is en/decrypted in the
+ * frame buffer by the PDC of the AES engine. Bytes are only copied for
+ * blocks that are not word-aligned or not complete.
+ *
  * $Id: stb_armcrypto.c 20268 2010-02-09 16:00:55Z sschneid $
  *
  */
@@ -31,20 +36,46 @@
 
 /* === Macros ============================================================== */
 
-#define MAX_FRAMELEN    aMaxPHYPacketSize-2
-#define FULL_BLOCK(l)   ((l + AES_BLOCKSIZE-1)/AES_BLOCKSIZE * AES_BLOCKSIZE)
+/* Number of 32 bit words of an AES block */
+#define AES_BLOCKWORDS          (AES_BLOCKSIZE / 4)
+
+/* True if the pointer can be used for 32 bit word accesses */
+#define WORD_ALIGNED(p)         ((((uint32_t)(p)) & 3) == 0)
+
+/* AES engine modes used for CCM* */
+#define AES_MODE_CBC_MAC        (AT91C_AES_LOD | AT91C_AES_CIPHER | \
+                                 AT91C_AES_OPMOD_CBC | AT91C_AES_SMOD_AUTO)
+#define AES_MODE_CTR            (AT91C_AES_CIPHER | AT91C_AES_OPMOD_CTR | \
+                                 AT91C_AES_SMOD_AUTO)
+#define AES_MODE_CTR_PDC        (AT91C_AES_CIPHER | AT91C_AES_OPMOD_CTR | \
+                                 AT91C_AES_SMOD_PDC)
 
 /* === Types =============================================================== */
 
+/* AES block, accessible as bytes and as 32 bit words */
+typedef union aes_block_tag
+{
+    uint32_t word[AES_BLOCKWORDS];
+    uint8_t byte[AES_BLOCKSIZE];
+} aes_block_t;
 
 /* === Globals ============================================================= */
 
 /* True indicates if key has to be setup. */
 static bool firstcall = true;
 
-static void ctr_crypt(uint8_t *nonce, uint8_t *buf, uint8_t len);
+/* Key set up in the AES engine. */
+static aes_block_t current_key;
+
+static void aes_setup(uint32_t mode, uint8_t *iv);
+static void aes_input(const uint32_t *in);
+static void aes_output(uint32_t *out);
+static void aes_input_pdc(uint8_t *buf, uint8_t len);
+static void mic_input(uint8_t *buf, uint8_t len);
+static void ctr_crypt(uint8_t *nonce, uint8_t *buf, uint8_t len,
+                      aes_block_t *mic);
 static void compute_mic(uint8_t *nonce, uint8_t *buf,
-                        uint8_t len, uint8_t off);
+                        uint8_t hdr_len, uint8_t pld_len, aes_block_t *mic);
 
 /* === Implementation ====================================================== */
 
@@ -56,81 +87,227 @@ void sal_aes_restart(void)
 /* --- Helper functions ---------------------------------------------------- */
 
 /**
- * @brief CTR en/decryption of buffer 'buf'
+ * @brief Sets the mode and the initialization vector of the AES engine
  *
- * @param[in,out]       nonce     The nonce (as "IV"), 1st and last byte
- *                                will be changed!
- * @param[in,out]       buf       Plain resp. ciphertext, MIC is first block
- * @param[in]           len       Number of encrypted bytes
+ * @param[in]   mode      Value of the mode register
+ * @param[in]   iv        Initialization vector; NULL for a zero vector
  */
-static void ctr_crypt(uint8_t *nonce, uint8_t *buf, uint8_t len)
+static void aes_setup(uint32_t mode, uint8_t *iv)
 {
-    nonce[0] = 1;
-    nonce[AES_BLOCKSIZE-1] = 0;         // counter value for MIC
+    aes_block_t blk;
+    uint8_t i;
+
+    AT91C_BASE_AES->AES_MR = mode;
+
+    if (iv == NULL)
+    {
+        memset(&blk, 0, sizeof(blk));
+    }
+    else
+    {
+        memcpy(blk.byte, iv, AES_BLOCKSIZE);
+    }
+
+    for (i = 0; i < AES_BLOCKWORDS; i++)
+    {
+        AT91C_BASE_AES->AES_IVxR[i] = blk.word[i];
+    }
+}
+
+
+
+/**
+ * @brief Processes one block by the AES engine
+ *
+ * The block is started by writing the last input word (auto mode).
+ *
+ * @param[in]   in        Input block
+ */
+static void aes_input(const uint32_t *in)
+{
+    AT91C_BASE_AES->AES_IDATAxR[0] = in[0];
+    AT91C_BASE_AES->AES_IDATAxR[1] = in[1];
+    AT91C_BASE_AES->AES_IDATAxR[2] = in[2];
+    AT91C_BASE_AES->AES_IDATAxR[3] = in[3];
+
+    while (!(AT91C_BASE_AES->AES_ISR & AT91C_AES_DATRDY));
+}
+
+
+
+/**
+ * @brief Reads the output block of the AES engine
+ *
+ * @param[out]  out       Output block
+ */
+static void aes_output(uint32_t *out)
+{
+    out[0] = AT91C_BASE_AES->AES_ODATAxR[0];
+    out[1] = AT91C_BASE_AES->AES_ODATAxR[1];
+    out[2] = AT91C_BASE_AES->AES_ODATAxR[2];
+    out[3] = AT91C_BASE_AES->AES_ODATAxR[3];
+}
 
-    /* Set mode */
-    AT91C_BASE_AES->AES_MR = AT91C_AES_OPMOD_CTR | AT91C_AES_CIPHER |
-        AT91C_AES_SMOD_PDC;
 
-    /* Init CTR*/
-    memcpy((void *)(AT91C_BASE_AES->AES_IVxR), nonce, AES_BLOCKSIZE);
 
-    /* Set PDC */
+/**
+ * @brief Processes complete blocks in place by the PDC of the AES engine
+ *
+ * @param[in,out]   buf       Word-aligned buffer
+ * @param[in]       len       Number of bytes, a multiple of AES_BLOCKSIZE
+ */
+static void aes_input_pdc(uint8_t *buf, uint8_t len)
+{
     AT91C_BASE_AES->AES_PTCR = AT91C_PDC_RXTDIS | AT91C_PDC_TXTDIS;
-    AT91C_BASE_AES->AES_TPR = AT91C_BASE_AES->AES_RPR = (uint32_t)(buf);
-    AT91C_BASE_AES->AES_TCR = AT91C_BASE_AES->AES_RCR = FULL_BLOCK(len)/4;
+    AT91C_BASE_AES->AES_TPR = AT91C_BASE_AES->AES_RPR = (uint32_t)buf;
+    AT91C_BASE_AES->AES_TCR = AT91C_BASE_AES->AES_RCR = len / 4;
 
-    /* Start encryption */
     AT91C_BASE_AES->AES_PTCR = AT91C_PDC_RXTEN | AT91C_PDC_TXTEN;
 
-    /* Wait for end */
-    while(!(AT91C_BASE_AES->AES_ISR & AT91C_AES_ENDRX));
+    while (!(AT91C_BASE_AES->AES_ISR & AT91C_AES_ENDRX));
 }
 
 
 
 /**
- * @brief Compute MIC of buffer
+ * @brief Feeds data into the CBC-MAC, padded with zeros to full blocks
  *
- * @param[in]       nonce     The nonce (as "IV")
- * @param[in,out]   buf       Buffer with plaintext, nonce will be
- *                            stored in first block
- * @param[in]       len       Number of plaintext bytes (with nonce)
- * @param[in]       micoff    Offset of 'buf' where MIC is stored
+ * @param[in]   buf       Data
+ * @param[in]   len       Number of bytes
  */
-static void compute_mic(uint8_t *nonce,
-                        uint8_t *buf,
-                        uint8_t len,
-                        uint8_t micoff)
+static void mic_input(uint8_t *buf, uint8_t len)
 {
-    memcpy(buf, nonce, AES_BLOCKSIZE);
+    aes_block_t blk;
 
-    /* Set mode */
-    AT91C_BASE_AES->AES_MR = AT91C_AES_LOD | AT91C_AES_CIPHER |
-        AT91C_AES_OPMOD_CBC | AT91C_AES_SMOD_PDC;
+    if (WORD_ALIGNED(buf))
+    {
+        for (; len >= AES_BLOCKSIZE; len -= AES_BLOCKSIZE)
+        {
+            aes_input((uint32_t *)buf);
+            buf += AES_BLOCKSIZE;
+        }
+    }
+    else
+    {
+        for (; len >= AES_BLOCKSIZE; len -= AES_BLOCKSIZE)
+        {
+            memcpy(blk.byte, buf, AES_BLOCKSIZE);
+            aes_input(blk.word);
+            buf += AES_BLOCKSIZE;
+        }
+    }
 
-    memset((void *)(AT91C_BASE_AES->AES_IVxR), 0, AES_BLOCKSIZE);
+    if (len > 0)
+    {
+        memset(&blk, 0, sizeof(blk));
+        memcpy(blk.byte, buf, len);
+        aes_input(blk.word);
+    }
+}
 
-    /* Set PDC */
-    AT91C_BASE_AES->AES_PTCR = AT91C_PDC_RXTDIS | AT91C_PDC_TXTDIS;
-    AT91C_BASE_AES->AES_TPR = (uint32_t)buf;
-    AT91C_BASE_AES->AES_TCR = FULL_BLOCK(len)/4;
 
-    /* Start encryption */
-    AT91C_BASE_AES->AES_PTCR = AT91C_PDC_TXTEN;
 
-    /* Wait for finishing */
-    while(AT91C_BASE_AES->AES_TCR);
-    while(!(AT91C_BASE_AES->AES_ISR & AT91C_AES_DATRDY));
+/**
+ * @brief CTR en/decryption in place
+ *
+ * The payload is en/decrypted with the counter values 1, 2, ..., the MIC
+ * with the counter value 0.
+ *
+ * @param[in,out]       nonce     The nonce (as "IV"), 1st and last byte
+ *                                will be changed!
+ * @param[in,out]       buf       Plain resp. ciphertext
+ * @param[in]           len       Number of encrypted bytes
+ * @param[in,out]       mic       MIC block; NULL if there is no MIC
+ */
+static void ctr_crypt(uint8_t *nonce, uint8_t *buf, uint8_t len,
+                      aes_block_t *mic)
+{
+    aes_block_t blk;
+    uint8_t full_len = len & ~(AES_BLOCKSIZE - 1);
+
+    nonce[0] = 1;
+    nonce[AES_BLOCKSIZE - 1] = 1;       // counter value for payload
+
+    /* Complete word-aligned blocks are processed by the PDC. */
+    if ((full_len > 0) && WORD_ALIGNED(buf))
+    {
+        aes_setup(AES_MODE_CTR_PDC, nonce);
+        aes_input_pdc(buf, full_len);
+        buf += full_len;
+        len -= full_len;
+        nonce[AES_BLOCKSIZE - 1] += full_len / AES_BLOCKSIZE;
+    }
+
+    /* Remaining blocks; the counter is incremented by the AES engine. */
+    if (len > 0)
+    {
+        aes_setup(AES_MODE_CTR, nonce);
+        while (len > 0)
+        {
+            uint8_t blk_len = (len < AES_BLOCKSIZE) ? len : AES_BLOCKSIZE;
+
+            memcpy(blk.byte, buf, blk_len);
+            aes_input(blk.word);
+            aes_output(blk.word);
+            memcpy(buf, blk.byte, blk_len);
+            buf += blk_len;
+            len -= blk_len;
+        }
+    }
+
+    if (mic != NULL)
+    {
+        nonce[AES_BLOCKSIZE - 1] = 0;   // counter value for MIC
+        aes_setup(AES_MODE_CTR, nonce);
+        aes_input(mic->word);
+        aes_output(mic->word);
+    }
+}
+
+
+
+/**
+ * @brief Compute MIC of header and payload
+ *
+ * @param[in]       nonce     The nonce prepared as first block (B0)
+ * @param[in]       buf       Buffer with header and plaintext payload
+ * @param[in]       hdr_len   Number of header bytes
+ * @param[in]       pld_len   Number of payload bytes
+ * @param[out]      mic       Computed MIC (unencrypted)
+ */
+static void compute_mic(uint8_t *nonce,
+                        uint8_t *buf,
+                        uint8_t hdr_len,
+                        uint8_t pld_len,
+                        aes_block_t *mic)
+{
+    aes_block_t blk;
+
+    aes_setup(AES_MODE_CBC_MAC, NULL);
+
+    memcpy(blk.byte, nonce, AES_BLOCKSIZE);
+    aes_input(blk.word);
 
     /*
-     * Get result - write MIC before payload, so CTR encryption in ZigBee
-     * can be done in one step (the MIC is encrypted with counter value 0,
-     * the payload with 1,2,...)
+     * The header is preceded by its 2 byte length, so the first header
+     * block is assembled here.
      */
-    memcpy(buf+micoff,
-           (void *)(AT91C_BASE_AES->AES_ODATAxR),
-           AES_BLOCKSIZE);
+    if (hdr_len)
+    {
+        uint8_t first_len = (hdr_len < AES_BLOCKSIZE - 2) ?
+                            hdr_len : AES_BLOCKSIZE - 2;
+
+        memset(&blk, 0, sizeof(blk));
+        blk.byte[1] = hdr_len;
+        memcpy(blk.byte + 2, buf, first_len);
+        aes_input(blk.word);
+        mic_input(buf + first_len, hdr_len - first_len);
+    }
+
+    mic_input(buf + hdr_len, pld_len);
+
+    /* With AT91C_AES_LOD the output is read only after the last block. */
+    aes_output(mic->word);
 }
 
 
@@ -170,8 +347,8 @@ void stb_restart(void)
  * This functions secures one block with CCM* according to 802.15.4.
  *
  * @param[in,out] buffer Input: plaintext header and payload concatenated;
- *                       for encryption: MUST HAVE 'AES_BLOCKSIZE'
- *                       BYTES SPACE AT THE END FOR THE MIC!
+ *                       for encryption: must have space for the MIC
+ *                       (mic_len bytes) at the end
  *                       Output: frame secured (with MIC at end)/unsecured
  * @param[in]  nonce   The nonce: Initialization Vector (IV) as used in
  *                     cryptography; the ZigBee nonce (13 bytes long)
@@ -179,7 +356,9 @@ void stb_restart(void)
  * @param[in] key The key to be used; if NULL, use the current key
  * @param[in] hdr_len Length of plaintext header (will not be encrypted)
  * @param[in] pld_len Length of payload to be encrypted; if 0, then only MIC
- *                    authentication implies
+ *                    authentication implies; for security levels without
+ *                    encryption the payload is authenticated as part of
+ *                    the header
  * @param[in] sec_level Security level according to IEEE 802.15.4,
  *                    7.6.2.2.1, Table 95:
  *                    - the value may be 0 ... 7;
@@ -201,10 +380,10 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
     uint8_t nonce_0;    /* nonce[0] for MIC computation. */
     uint8_t mic_len;
     uint8_t enc_flag;
-    uint8_t off_pld;    /* offset for payload in padbuf */
-    uint8_t off_mic;    /* offset for MIC in padbuf, before payload */
-    uint8_t padbuf[MAX_FRAMELEN+4*AES_BLOCKSIZE];
-                /* padded buffer with leading nonce and appended MIC */
+    uint8_t i;
+    uint32_t diff;
+    aes_block_t mic;    /* MIC as received (decrypted) resp. sent */
+    aes_block_t tag;    /* MIC computed for the received frame */
 
     if(sec_level & 3)
     {
@@ -229,16 +408,39 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
         return (STB_CCM_ILLPARM);
     }
 
-    if(firstcall)
+    /*
+     * Without encryption the payload is authenticated as part of the
+     * header (IEEE 802.15.4-2006, 7.6.3.4).
+     */
+    if(!enc_flag)
+    {
+        hdr_len += pld_len;
+        pld_len = 0;
+    }
+
+    if(firstcall && (key == NULL))
+    {
+        return (STB_CCM_KEYMISS);   /* Initial call, but no key given. */
+    }
+
+    /*
+     * Set up the key if it differs from the current one; this causes the
+     * AES engine to generate the subkeys again.
+     */
+    if(key != NULL)
     {
-        if(key == NULL)
+        memcpy(tag.byte, key, AES_KEYSIZE);
+
+        if(firstcall || memcmp(tag.byte, current_key.byte, AES_KEYSIZE))
         {
-            return (STB_CCM_KEYMISS);   /* Initial call, but no key given. */
-        }
-        /* Key must be non-NULL because of test above */
-        firstcall = false;
+            firstcall = false;
+            current_key = tag;
 
-        memcpy((void *)(AT91C_BASE_AES->AES_KEYWxR), key, AES_KEYSIZE);
+            for(i = 0; i < AES_BLOCKWORDS; i++)
+            {
+                AT91C_BASE_AES->AES_KEYWxR[i] = current_key.word[i];
+            }
+        }
     }
 
     /* Prepare nonce. */
@@ -258,102 +460,39 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
     nonce_0 = nonce[0];
     nonce[AES_BLOCKSIZE -  2] = 0;
 
-    /*
-     * Fill padbuf
-     * first block for nonce (filled by compute_mic()),
-     * then optional space for header + 2 byte length, with padding,
-     * then space for payload with padding,
-     * then MIC
-     */
-
-    off_pld = AES_BLOCKSIZE;
-
-    memset(padbuf, 0, sizeof(padbuf));
-
-    if(hdr_len)
-    {
-        off_pld += FULL_BLOCK(hdr_len+2);
-    }
-
-    off_mic = off_pld - AES_BLOCKSIZE;
-
-    if(pld_len)
-    {
-        memcpy(padbuf + off_pld, buffer + hdr_len, pld_len);
-    }
-
     if(aes_dir == AES_DIR_ENCRYPT)
     {
-        /*
-         * Authenticate -
-         * place header and result (16byte-MIC) before payload
-         */
-
-        if(hdr_len)
-        {
-            memcpy(padbuf + AES_BLOCKSIZE + 2, buffer, hdr_len);
-            padbuf[AES_BLOCKSIZE+1] = hdr_len;
-        }
-
+        /* Authenticate the plaintext. */
         if(mic_len > 0)
         {
             nonce[AES_BLOCKSIZE - 1] = pld_len;
-            compute_mic(nonce, padbuf, off_pld+pld_len, off_mic);
+            compute_mic(nonce, buffer, hdr_len, pld_len, &mic);
         }
 
-        /* Encrypt payload and MIC */
-        if(enc_flag)
+        /* Encrypt payload and MIC; the MIC is encrypted for all levels. */
+        if(enc_flag || (mic_len > 0))
         {
-            ctr_crypt(nonce, padbuf+off_mic, pld_len+AES_BLOCKSIZE);
-
-            /*
-             * Copy back payload - consider case that sec_level
-             * requires encryption but pld_len is 0, hence only
-             * MIC was encrypted, no payload
-             */
-            if(pld_len)
-            {
-                memcpy(buffer+hdr_len, padbuf+off_pld, pld_len);
-            }
+            ctr_crypt(nonce, buffer + hdr_len, pld_len,
+                      (mic_len > 0) ? &mic : NULL);
         }
 
-        /* Copy back encrypted MIC */
+        /* Append encrypted MIC */
         if(mic_len)
         {
-            memcpy(buffer+hdr_len+pld_len, padbuf+off_mic, mic_len);
+            memcpy(buffer + hdr_len + pld_len, mic.byte, mic_len);
         }
     }
     else                        /* Decrypt payload and MIC. */
     {
-        if(enc_flag)
+        if(mic_len)
         {
-            /*
-             * Place encrypted MIC before encrypted payload
-             * (first block is still null)
-             */
-            if(mic_len)
-            {
-                memcpy(padbuf+off_mic, buffer+hdr_len+pld_len, mic_len);
-            }
-
-            /* Decrypt */
-            ctr_crypt(nonce, padbuf+off_mic, pld_len+AES_BLOCKSIZE);
-
-            /* Copy plaintext back to original buffer */
-            memcpy(buffer+hdr_len, padbuf+off_pld, pld_len);
-
-            /* Copy MIC to end (just a buffer) */
-            if(mic_len)
-            {
-                memcpy(padbuf + off_pld + FULL_BLOCK(pld_len),
-                       padbuf+off_mic,
-                       mic_len);
-            }
+            memcpy(mic.byte, buffer + hdr_len + pld_len, mic_len);
         }
-        else
+
+        if(enc_flag || (mic_len > 0))
         {
-            memcpy(padbuf + off_pld + FULL_BLOCK(pld_len),
-                   buffer+hdr_len+pld_len, mic_len);
+            ctr_crypt(nonce, buffer + hdr_len, pld_len,
+                      (mic_len > 0) ? &mic : NULL);
         }
 
         /* Check MIC. */
@@ -361,27 +500,20 @@ stb_ccm_t stb_ccm_secure(uint8_t *buffer,
         {
             nonce[0] = nonce_0;
             nonce[AES_BLOCKSIZE - 1] = pld_len;
-            memcpy(padbuf, nonce, AES_BLOCKSIZE);
+            compute_mic(nonce, buffer, hdr_len, pld_len, &tag);
 
-            /* Copy hdr */
-            if(hdr_len)
-            {
-                memset(padbuf+AES_BLOCKSIZE, 0, FULL_BLOCK(hdr_len+2));
-                memcpy(padbuf + AES_BLOCKSIZE + 2, buffer, hdr_len);
-                padbuf[AES_BLOCKSIZE+1] = hdr_len;
-            }
-
-            /* Pad pld */
-            if(pld_len > 0)
+            /*
+             * Compare word by word without an early exit, so the time
+             * does not depend on the position of the first wrong byte;
+             * the MIC length is a multiple of 4.
+             */
+            diff = 0;
+            for(i = 0; i < mic_len / 4; i++)
             {
-                memset(padbuf+off_pld+pld_len, 0, FULL_BLOCK(pld_len)-pld_len);
+                diff |= mic.word[i] ^ tag.word[i];
             }
 
-            compute_mic(nonce, padbuf, off_pld+pld_len, off_mic);
-
-            if(memcmp(padbuf+off_mic,
-                      padbuf + off_pld + FULL_BLOCK(pld_len),
-                      mic_len))
+            if(diff)
             {
                 return STB_CCM_MICERR;
             }
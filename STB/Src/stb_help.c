@@ -43,6 +43,13 @@
 
 /* === Globals ============================================================= */
 
+/* === Prototypes ========================================================== */
+
+static void compute_hdr_mic(uint8_t *buffer,
+                            uint8_t *nonce,
+                            uint8_t hdr_len,
+                            uint8_t pld_len);
+
 /* === Implementation ====================================================== */
 
 /* help functions ---------------------------------------------------------- */
@@ -92,25 +99,22 @@ void encrypt_with_padding(uint8_t *start, uint8_t buflen)
 
 
 /**
- * @brief Computes MIC
- *
- * This function computes the MIC according to CCM.
+ * @brief Authenticates B0 and the header
  *
- * The key was initialized in other functions before.
+ * This function starts the MIC computation according to CCM: the first
+ * block B0 (the nonce) and the header including its length field are
+ * processed. Afterwards the AES unit is in CBC mode and its state contains
+ * the intermediate CBC-MAC.
  *
  * @param[in]  buffer  Input data (frame, not padded yet)
- * @param[out] mic     Computed MIC of size AES_BLOCKSIZE
- * @param[in]  nonce   The nonce: Initialization Vector (IV) as used in
- *                     cryptography; the ZigBee nonce are the bytes 2...14
- *                     of this nonce
- * @param[in]  hdr_len  Size of plaintext header in bytes (may be 0)
+ * @param[in]  nonce   The nonce
+ * @param[in]  hdr_len Size of plaintext header in bytes (may be 0)
  * @param[in]  pld_len Length of payload in bytes (may be 0)
  */
-void compute_mic(uint8_t *buffer,
-                        uint8_t *mic,
-                        uint8_t *nonce,
-                        uint8_t hdr_len,
-                        uint8_t pld_len)
+static void compute_hdr_mic(uint8_t *buffer,
+                            uint8_t *nonce,
+                            uint8_t hdr_len,
+                            uint8_t pld_len)
 {
     nonce[AES_BLOCKSIZE-1] = pld_len;
 
@@ -142,6 +146,32 @@ void compute_mic(uint8_t *buffer,
             encrypt_with_padding(buffer + firstlen, hdr_len - firstlen);
         }
     }
+}
+
+
+
+/**
+ * @brief Computes MIC
+ *
+ * This function computes the MIC according to CCM.
+ *
+ * The key was initialized in other functions before.
+ *
+ * @param[in]  buffer  Input data (frame, not padded yet)
+ * @param[out] mic     Computed MIC of size AES_BLOCKSIZE
+ * @param[in]  nonce   The nonce: Initialization Vector (IV) as used in
+ *                     cryptography; the ZigBee nonce are the bytes 2...14
+ *                     of this nonce
+ * @param[in]  hdr_len  Size of plaintext header in bytes (may be 0)
+ * @param[in]  pld_len Length of payload in bytes (may be 0)
+ */
+void compute_mic(uint8_t *buffer,
+                        uint8_t *mic,
+                        uint8_t *nonce,
+                        uint8_t hdr_len,
+                        uint8_t pld_len)
+{
+    compute_hdr_mic(buffer, nonce, hdr_len, pld_len);
 
     encrypt_with_padding(buffer + hdr_len, pld_len);
 
@@ -235,6 +265,83 @@ void encrypt_pldmic(uint8_t *buffer,
     }
 }
 
+
+
+/**
+ * @brief Encrypts payload and computes the encrypted MIC in one pass
+ *
+ * This function performs CCM* encryption with authentication. After B0 and
+ * the header have been authenticated, the AES unit is switched to ECB mode
+ * once and the CTR keystream blocks and the CBC-MAC blocks of the payload
+ * are computed alternately; the CBC chaining is done by the CPU.
+ * Since sal_aes_wrrd() returns the result of the previous operation, the
+ * intermediate CBC-MAC and each keystream block are fetched with the SPI
+ * transfer that starts the next operation, and no separate SRAM read is
+ * needed between the MIC computation and the encryption.
+ *
+ * @param[in,out] buffer  Input: plaintext header and payload;
+ *                        output: header, encrypted payload and MIC
+ * @param[in]  nonce   The nonce; will be modified
+ * @param[in]  hdr_len Size of plaintext header in bytes (may be 0)
+ * @param[in]  pld_len Length of payload in bytes (may be 0)
+ * @param[in]  mic_len Size of MIC in bytes (> 0)
+ */
+void ccm_encrypt_pipelined(uint8_t *buffer,
+                           uint8_t *nonce,
+                           uint8_t hdr_len,
+                           uint8_t pld_len,
+                           uint8_t mic_len)
+{
+    uint8_t mac[AES_BLOCKSIZE];
+    uint8_t keystream[AES_BLOCKSIZE];
+    uint8_t len;
+    uint8_t i;
+
+    compute_hdr_mic(buffer, nonce, hdr_len, pld_len);
+
+    sal_aes_setup(NULL, AES_MODE_ECB, AES_DIR_ENCRYPT);
+
+    /* B0 has been processed, so the nonce becomes the counter block A0. */
+    nonce[0] = 1;
+    nonce[AES_BLOCKSIZE-1] = 0;
+
+    buffer += hdr_len;
+
+    while (pld_len > 0)
+    {
+        len = MIN(pld_len, AES_BLOCKSIZE);
+
+        /* Keystream of this block; get the CBC-MAC so far. */
+        nonce[AES_BLOCKSIZE-1]++;
+        sal_aes_wrrd(nonce, mac);
+
+        /* CBC-MAC of the plaintext block padded with zeros. */
+        for (i = 0; i < len; i++)
+        {
+            mac[i] ^= buffer[i];
+        }
+        sal_aes_wrrd(mac, keystream);
+
+        /* Encrypt the block. */
+        for (i = 0; i < len; i++)
+        {
+            *buffer++ ^= keystream[i];
+        }
+
+        pld_len -= len;
+    }
+
+    /* Keystream of the MIC (counter 0); get the final CBC-MAC. */
+    nonce[AES_BLOCKSIZE-1] = 0;
+    sal_aes_wrrd(nonce, mac);
+    sal_aes_read(keystream);
+
+    for (i = 0; i < mic_len; i++)
+    {
+        buffer[i] = mac[i] ^ keystream[i];
+    }
+}
+
 #else   /* #if (SAL_TYPE == AT86RF2xx) */
 
 void encrypt_pldmic(uint8_t *buffer,
@@ -0,0 +1,653 @@
+/**
+ * @file stb_replay.c
+ *
+ * @brief Replay protection of the security tool box
+ *
+ * This file implements the table of incoming frame counters. The senders
+ * held in RAM are found via a chained hash index over their extended
+ * addresses and are kept in a list ordered by their last use. The least
+ * recently used sender is moved to a bucket of the persistent storage
+ * addressed by the hash of its extended address; if the bucket is full, the
+ * sender with the smallest frame counter is dropped from it, and the lowest
+ * frame counter accepted from unknown senders of this bucket is raised
+ * above the dropped one, so that no frame of a dropped sender can be
+ * replayed.
+ *
+ * If the persistent storage is not available (e.g. boards without EEPROM)
+ * or a write fails, the counter of an evicted sender is lost. In this case
+ * a floor kept in RAM is raised above the evicted counter, and frames of
+ * any sender not held in RAM are only accepted above this floor.
+ *
+ * $Id$
+ *
+ */
+/**
+ * @author
+ *      Atmel Corporation: http://www.atmel.com
+ *      Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(STB_ON_SAL) || defined(STB_ARMCRYPTO)
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "pal.h"
+#include "return_val.h"
+#include "stb.h"
+#include "stb_replay.h"
+
+/* === Macros ============================================================== */
+
+/* Index value marking the end of a hash chain or of the LRU list */
+#define NO_ENTRY                (0xFF)
+
+/* Extended address of an empty record of the persistent storage */
+#define EMPTY_ADDR              (0xFFFFFFFFFFFFFFFFULL)
+
+/* Identifier of the replay protection area */
+#define PS_MAGIC                (0x5250)
+
+/* Length of the header of the replay protection area */
+#define PS_HEADER_LEN           (4)
+
+/* Length of a record (extended address and frame counter) */
+#define PS_RECORD_LEN           (8 + 4)
+
+/* Address of a bucket within the persistent storage */
+#define PS_BUCKET_ADDR(bucket)  (STB_REPLAY_PS_ADDR + PS_HEADER_LEN + \
+                                 (uint16_t)(bucket) * STB_REPLAY_PS_BUCKET_SIZE)
+
+/* Offset of a record within a bucket */
+#define PS_RECORD_OFFSET(way)   (4 + (way) * PS_RECORD_LEN)
+
+/* Positions of the sender's address and the frame counter in the nonce */
+#define NONCE_POS_SRC_ADDR      (1)
+#define NONCE_POS_FRM_CNTR      (NONCE_POS_SRC_ADDR + 8)
+
+#if (STB_REPLAY_TABLE_SIZE >= NO_ENTRY)
+#error "STB_REPLAY_TABLE_SIZE is too large"
+#endif
+
+/* === Types =============================================================== */
+
+/* Sender held in RAM */
+typedef struct replay_entry_tag
+{
+    /* Extended address of the sender */
+    uint64_t addr;
+    /* Last frame counter accepted from the sender */
+    uint32_t counter;
+    /* Next entry of the hash chain */
+    uint8_t hash_next;
+    /* Previous (more recently used) entry of the LRU list */
+    uint8_t lru_prev;
+    /* Next (less recently used) entry of the LRU list */
+    uint8_t lru_next;
+    /* The counter has not been written to the persistent storage yet. */
+    bool dirty;
+} replay_entry_t;
+
+/* === Globals ============================================================= */
+
+/* Senders held in RAM */
+static replay_entry_t replay_table[STB_REPLAY_TABLE_SIZE];
+
+/* Number of used entries of replay_table */
+static uint8_t replay_entries;
+
+/* Heads of the hash chains */
+static uint8_t replay_hash[STB_REPLAY_HASH_SIZE];
+
+/* Most and least recently used entries */
+static uint8_t lru_head;
+static uint8_t lru_tail;
+
+/* The replay protection area of the persistent storage can be used. */
+static bool ps_valid;
+
+/*
+ * Lowest frame counter accepted from senders not held in RAM, raised above
+ * the counters of evicted senders that could not be written to the
+ * persistent storage.
+ */
+static uint32_t ram_floor;
+
+/* === Prototypes ========================================================== */
+
+static uint8_t hash_addr(uint64_t addr);
+static uint8_t find_entry(uint64_t addr);
+static void lru_unlink(uint8_t entry);
+static void lru_insert_head(uint8_t entry);
+static void hash_unlink(uint8_t entry);
+static uint32_t ps_floor(uint8_t *bucket);
+static bool ps_lookup(uint64_t addr, uint32_t *counter, uint32_t *floor);
+static bool ps_store(uint64_t addr, uint32_t counter);
+static void raise_ram_floor(uint32_t counter);
+
+/* === Implementation ====================================================== */
+
+/**
+ * @brief Initializes the replay protection
+ */
+void stb_replay_init(void)
+{
+    uint8_t header[PS_HEADER_LEN];
+    uint8_t bucket[STB_REPLAY_PS_BUCKET_SIZE];
+    uint8_t i;
+
+    replay_entries = 0;
+    lru_head = NO_ENTRY;
+    lru_tail = NO_ENTRY;
+    memset(replay_hash, NO_ENTRY, sizeof(replay_hash));
+    ram_floor = 0;
+
+    ps_valid = (pal_ps_get(INTERN_EEPROM, STB_REPLAY_PS_ADDR, PS_HEADER_LEN,
+                           header) == MAC_SUCCESS);
+
+    if (ps_valid &&
+        ((header[0] != (uint8_t)PS_MAGIC) ||
+        (header[1] != (uint8_t)(PS_MAGIC >> 8)) ||
+        (header[2] != STB_REPLAY_PS_BUCKETS) ||
+        (header[3] != STB_REPLAY_PS_WAYS)))
+    {
+        /*
+         * Format the area: all records empty, all senders accepted. Erased
+         * EEPROM already has this content, so only changed octets are
+         * written.
+         */
+        memset(bucket, 0xFF, sizeof(bucket));
+        for (i = 0; i < STB_REPLAY_PS_BUCKETS; i++)
+        {
+            if (pal_ps_set(PS_BUCKET_ADDR(i), sizeof(bucket), bucket) != MAC_SUCCESS)
+            {
+                ps_valid = false;
+                return;
+            }
+        }
+
+        header[0] = (uint8_t)PS_MAGIC;
+        header[1] = (uint8_t)(PS_MAGIC >> 8);
+        header[2] = STB_REPLAY_PS_BUCKETS;
+        header[3] = STB_REPLAY_PS_WAYS;
+        if (pal_ps_set(STB_REPLAY_PS_ADDR, PS_HEADER_LEN, header) != MAC_SUCCESS)
+        {
+            ps_valid = false;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Checks whether a frame counter is fresh
+ *
+ * @param src_addr Extended address of the sender
+ * @param frame_counter Received frame counter
+ *
+ * @return STB_CCM_REPLAY if the frame counter is stale, STB_CCM_OK otherwise
+ */
+stb_ccm_t stb_replay_check(uint64_t src_addr, uint32_t frame_counter)
+{
+    uint8_t entry;
+    uint32_t counter;
+    uint32_t floor;
+
+    entry = find_entry(src_addr);
+
+    if (entry != NO_ENTRY)
+    {
+        if (frame_counter > replay_table[entry].counter)
+        {
+            return STB_CCM_OK;
+        }
+        return STB_CCM_REPLAY;
+    }
+
+    /* The sender may have been evicted without its counter being stored. */
+    if (frame_counter < ram_floor)
+    {
+        return STB_CCM_REPLAY;
+    }
+
+    if (ps_lookup(src_addr, &counter, &floor))
+    {
+        if (frame_counter > counter)
+        {
+            return STB_CCM_OK;
+        }
+        return STB_CCM_REPLAY;
+    }
+
+    /* Unknown sender */
+    if (frame_counter >= floor)
+    {
+        return STB_CCM_OK;
+    }
+    return STB_CCM_REPLAY;
+}
+
+
+
+/**
+ * @brief Stores the frame counter of an authenticated frame
+ *
+ * @param src_addr Extended address of the sender
+ * @param frame_counter Frame counter of the authenticated frame
+ */
+void stb_replay_update(uint64_t src_addr, uint32_t frame_counter)
+{
+    uint8_t entry;
+    uint8_t bucket;
+
+    entry = find_entry(src_addr);
+
+    if (entry != NO_ENTRY)
+    {
+        lru_unlink(entry);
+    }
+    else
+    {
+        if (replay_entries < STB_REPLAY_TABLE_SIZE)
+        {
+            entry = replay_entries++;
+        }
+        else
+        {
+            /* Move the least recently used sender to the persistent storage. */
+            entry = lru_tail;
+            if (replay_table[entry].dirty &&
+                !ps_store(replay_table[entry].addr, replay_table[entry].counter))
+            {
+                raise_ram_floor(replay_table[entry].counter);
+            }
+            lru_unlink(entry);
+            hash_unlink(entry);
+        }
+
+        replay_table[entry].addr = src_addr;
+        bucket = hash_addr(src_addr) & (STB_REPLAY_HASH_SIZE - 1);
+        replay_table[entry].hash_next = replay_hash[bucket];
+        replay_hash[bucket] = entry;
+    }
+
+    replay_table[entry].counter = frame_counter;
+    replay_table[entry].dirty = true;
+    lru_insert_head(entry);
+}
+
+
+
+/**
+ * @brief Writes all frame counters changed in RAM to the persistent storage
+ *
+ * @return MAC_SUCCESS if all counters have been written, FAILURE otherwise
+ */
+retval_t stb_replay_flush(void)
+{
+    retval_t status = MAC_SUCCESS;
+    uint8_t i;
+
+    for (i = 0; i < replay_entries; i++)
+    {
+        if (replay_table[i].dirty)
+        {
+            if (ps_store(replay_table[i].addr, replay_table[i].counter))
+            {
+                replay_table[i].dirty = false;
+            }
+            else
+            {
+                /* Keep the entry dirty, so that its eviction raises the floor. */
+                status = FAILURE;
+            }
+        }
+    }
+
+    return status;
+}
+
+
+
+/**
+ * @brief Unsecures a frame with CCM* if its frame counter is fresh
+ *
+ * @param buffer See stb_ccm_secure()
+ * @param nonce See stb_ccm_secure()
+ * @param key See stb_ccm_secure()
+ * @param hdr_len See stb_ccm_secure()
+ * @param pld_len See stb_ccm_secure()
+ * @param sec_level See stb_ccm_secure()
+ *
+ * @return STB_CCM_REPLAY if the frame counter is stale, otherwise the
+ *         status of stb_ccm_secure()
+ */
+stb_ccm_t stb_ccm_unsecure_fresh(uint8_t *buffer,
+                                 uint8_t nonce[AES_BLOCKSIZE],
+                                 uint8_t *key,
+                                 uint8_t hdr_len,
+                                 uint8_t pld_len,
+                                 uint8_t sec_level)
+{
+    uint64_t src_addr = 0;
+    uint32_t frame_counter = 0;
+    stb_ccm_t status;
+    uint8_t i;
+
+    if (nonce == NULL)
+    {
+        return STB_CCM_ILLPARM;
+    }
+
+    /* Both fields are stored MSB first. */
+    for (i = 0; i < 8; i++)
+    {
+        src_addr = (src_addr << 8) | nonce[NONCE_POS_SRC_ADDR + i];
+    }
+    for (i = 0; i < 4; i++)
+    {
+        frame_counter = (frame_counter << 8) | nonce[NONCE_POS_FRM_CNTR + i];
+    }
+
+    /* Reject a stale frame before its MIC is verified. */
+    if (stb_replay_check(src_addr, frame_counter) != STB_CCM_OK)
+    {
+        return STB_CCM_REPLAY;
+    }
+
+    status = stb_ccm_secure(buffer, nonce, key, hdr_len, pld_len, sec_level,
+                            AES_DIR_DECRYPT);
+
+    if (status == STB_CCM_OK)
+    {
+        stb_replay_update(src_addr, frame_counter);
+    }
+
+    return status;
+}
+
+
+
+/**
+ * @brief Computes the hash value of an extended address
+ *
+ * @param addr Extended address
+ *
+ * @return Hash value, to be masked with the number of buckets
+ */
+static uint8_t hash_addr(uint64_t addr)
+{
+    uint8_t hash = 0;
+    uint8_t i;
+
+    for (i = 0; i < 8; i++)
+    {
+        hash = (uint8_t)((hash << 1) | (hash >> 7)) ^ (uint8_t)addr;
+        addr >>= 8;
+    }
+
+    return hash;
+}
+
+
+
+/**
+ * @brief Finds a sender held in RAM
+ *
+ * @param addr Extended address of the sender
+ *
+ * @return Index of the entry, or NO_ENTRY if the sender is not held in RAM
+ */
+static uint8_t find_entry(uint64_t addr)
+{
+    uint8_t entry;
+
+    entry = replay_hash[hash_addr(addr) & (STB_REPLAY_HASH_SIZE - 1)];
+
+    while ((entry != NO_ENTRY) && (replay_table[entry].addr != addr))
+    {
+        entry = replay_table[entry].hash_next;
+    }
+
+    return entry;
+}
+
+
+
+/**
+ * @brief Removes an entry from the LRU list
+ *
+ * @param entry Index of the entry
+ */
+static void lru_unlink(uint8_t entry)
+{
+    uint8_t prev = replay_table[entry].lru_prev;
+    uint8_t next = replay_table[entry].lru_next;
+
+    if (prev != NO_ENTRY)
+    {
+        replay_table[prev].lru_next = next;
+    }
+    else
+    {
+        lru_head = next;
+    }
+
+    if (next != NO_ENTRY)
+    {
+        replay_table[next].lru_prev = prev;
+    }
+    else
+    {
+        lru_tail = prev;
+    }
+}
+
+
+
+/**
+ * @brief Inserts an entry as most recently used one into the LRU list
+ *
+ * @param entry Index of the entry
+ */
+static void lru_insert_head(uint8_t entry)
+{
+    replay_table[entry].lru_prev = NO_ENTRY;
+    replay_table[entry].lru_next = lru_head;
+
+    if (lru_head != NO_ENTRY)
+    {
+        replay_table[lru_head].lru_prev = entry;
+    }
+    else
+    {
+        lru_tail = entry;
+    }
+
+    lru_head = entry;
+}
+
+
+
+/**
+ * @brief Removes an entry from its hash chain
+ *
+ * @param entry Index of the entry
+ */
+static void hash_unlink(uint8_t entry)
+{
+    uint8_t *link;
+
+    link = &replay_hash[hash_addr(replay_table[entry].addr) & (STB_REPLAY_HASH_SIZE - 1)];
+
+    while (*link != entry)
+    {
+        link = &replay_table[*link].hash_next;
+    }
+
+    *link = replay_table[entry].hash_next;
+}
+
+
+
+/**
+ * @brief Gets the lowest frame counter accepted from unknown senders
+ *
+ * The value is stored inverted, so that erased EEPROM accepts all counters.
+ *
+ * @param bucket Bucket read from the persistent storage
+ *
+ * @return Lowest frame counter accepted from unknown senders of the bucket
+ */
+static uint32_t ps_floor(uint8_t *bucket)
+{
+    uint32_t floor;
+
+    memcpy(&floor, bucket, sizeof(floor));
+
+    return ~floor;
+}
+
+
+
+/**
+ * @brief Looks up a sender in the persistent storage
+ *
+ * @param addr Extended address of the sender
+ * @param[out] counter Last frame counter accepted from the sender
+ * @param[out] floor Lowest frame counter accepted from unknown senders
+ *
+ * @return True if the sender has been found; false if it has not been found
+ *         or the persistent storage cannot be read, in which case *floor
+ *         is 0 and only the floor kept in RAM applies
+ */
+static bool ps_lookup(uint64_t addr, uint32_t *counter, uint32_t *floor)
+{
+    uint8_t bucket[STB_REPLAY_PS_BUCKET_SIZE];
+    uint64_t record_addr;
+    uint8_t way;
+
+    *floor = 0;
+
+    if (!ps_valid ||
+        (pal_ps_get(INTERN_EEPROM,
+                    PS_BUCKET_ADDR(hash_addr(addr) & (STB_REPLAY_PS_BUCKETS - 1)),
+                    sizeof(bucket), bucket) != MAC_SUCCESS))
+    {
+        return false;
+    }
+
+    *floor = ps_floor(bucket);
+
+    for (way = 0; way < STB_REPLAY_PS_WAYS; way++)
+    {
+        memcpy(&record_addr, &bucket[PS_RECORD_OFFSET(way)], sizeof(record_addr));
+        if (record_addr == addr)
+        {
+            memcpy(counter, &bucket[PS_RECORD_OFFSET(way) + 8], sizeof(*counter));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+/**
+ * @brief Writes the frame counter of a sender to the persistent storage
+ *
+ * The record of the sender is reused; otherwise an empty record or the
+ * record with the smallest frame counter is taken.
+ *
+ * @param addr Extended address of the sender
+ * @param counter Last frame counter accepted from the sender
+ *
+ * @return True if the counter has been written
+ */
+static bool ps_store(uint64_t addr, uint32_t counter)
+{
+    uint8_t bucket[STB_REPLAY_PS_BUCKET_SIZE];
+    uint16_t bucket_addr;
+    uint64_t record_addr;
+    uint32_t record_counter;
+    uint32_t min_counter = 0xFFFFFFFF;
+    uint32_t floor;
+    uint8_t victim = 0;
+    uint8_t way;
+
+    if (!ps_valid)
+    {
+        return false;
+    }
+
+    bucket_addr = PS_BUCKET_ADDR(hash_addr(addr) & (STB_REPLAY_PS_BUCKETS - 1));
+    if (pal_ps_get(INTERN_EEPROM, bucket_addr, sizeof(bucket), bucket) != MAC_SUCCESS)
+    {
+        return false;
+    }
+
+    for (way = 0; way < STB_REPLAY_PS_WAYS; way++)
+    {
+        memcpy(&record_addr, &bucket[PS_RECORD_OFFSET(way)], sizeof(record_addr));
+        memcpy(&record_counter, &bucket[PS_RECORD_OFFSET(way) + 8], sizeof(record_counter));
+
+        if ((record_addr == addr) || (record_addr == EMPTY_ADDR))
+        {
+            victim = way;
+            break;
+        }
+
+        if (record_counter <= min_counter)
+        {
+            min_counter = record_counter;
+            victim = way;
+        }
+    }
+
+    if (way == STB_REPLAY_PS_WAYS)
+    {
+        /*
+         * The bucket is full and the sender with the smallest frame counter
+         * is dropped; it would be unknown afterwards, so no frame counter up
+         * to its counter is accepted from unknown senders anymore.
+         */
+        floor = ps_floor(bucket);
+        if ((min_counter != 0xFFFFFFFF) && (min_counter >= floor))
+        {
+            floor = ~(min_counter + 1);
+            memcpy(bucket, &floor, sizeof(floor));
+        }
+    }
+
+    memcpy(&bucket[PS_RECORD_OFFSET(victim)], &addr, sizeof(addr));
+    memcpy(&bucket[PS_RECORD_OFFSET(victim) + 8], &counter, sizeof(counter));
+
+    /* Only changed octets are written. */
+    return (pal_ps_set(bucket_addr, sizeof(bucket), bucket) == MAC_SUCCESS);
+}
+
+
+
+/**
+ * @brief Raises the floor kept in RAM above the counter of a lost sender
+ *
+ * @param counter Last frame counter accepted from the evicted sender
+ */
+static void raise_ram_floor(uint32_t counter)
+{
+    if (counter >= ram_floor)
+    {
+        /* A frame counter of 0xFFFFFFFF is not sent (IEEE 802.15.4 counter error). */
+        ram_floor = (counter == 0xFFFFFFFF) ? counter : counter + 1;
+    }
+}
+
+#endif /* #if defined(STB_ON_SAL) || defined(STB_ARMCRYPTO) */
+
+/* EOF */
@@ -140,6 +140,13 @@ bool tal_pib_PrivatePanCoordinator;
  */
 #ifdef PROMISCUOUS_MODE
 bool tal_pib_PromiscuousMode;
+
+/**
+ * Number of frames with invalid FCS discarded in promiscuous mode;
+ * incremented by the RX interrupt, so it has to be read within a critical
+ * region
+ */
+volatile uint16_t tal_prom_crc_error_cnt;
 #endif
 
 #ifdef BEACON_SUPPORT
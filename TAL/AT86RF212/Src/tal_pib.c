@@ -480,6 +480,24 @@ retval_t tal_pib_set(uint8_t attribute, pib_value_t *value)
                         previous_channel = tal_pib_CurrentChannel;
                         tal_pib_CurrentChannel = value->pib_value_8bit;
 
+#ifdef PROMISCUOUS_MODE
+                        /*
+                         * In promiscuous mode the transceiver is in basic
+                         * RX_ON and never sends an ACK; if the modulation is
+                         * not changed, the channel is changed without leaving
+                         * RX_ON to keep the blind time of a channel hopping
+                         * sniffer short.
+                         */
+                        if (tal_pib_PromiscuousMode &&
+                            (tal_pib_CurrentPage != 5) &&
+                            (tal_pib_CurrentChannel > 0) && (previous_channel > 0) &&
+                            (pal_trx_bit_read(SR_TRX_STATUS) == RX_ON))
+                        {
+                            pal_trx_bit_write(SR_CHANNEL, tal_pib_CurrentChannel);
+                            break;
+                        }
+#endif
+
                         /*
                          * Set trx to "soft" off avoiding that ongoing
                          * transaction (e.g. ACK) are interrupted.
@@ -517,8 +535,17 @@ retval_t tal_pib_set(uint8_t attribute, pib_value_t *value)
                         /* Re-store previous trx state */
                         if (previous_trx_status != TRX_OFF)
                         {
-                            /* Set to default state */
-                            set_trx_state(CMD_RX_AACK_ON);
+#ifdef PROMISCUOUS_MODE
+                            if (tal_pib_PromiscuousMode)
+                            {
+                                set_trx_state(CMD_RX_ON);
+                            }
+                            else
+#endif
+                            {
+                                /* Set to default state */
+                                set_trx_state(CMD_RX_AACK_ON);
+                            }
                         }
                     }
                     break;
@@ -557,8 +584,17 @@ retval_t tal_pib_set(uint8_t attribute, pib_value_t *value)
 
                         if (previous_trx_status != TRX_OFF)
                         {
-                            /* Set to default state */
-                            set_trx_state(CMD_RX_AACK_ON);
+#ifdef PROMISCUOUS_MODE
+                            if (tal_pib_PromiscuousMode)
+                            {
+                                set_trx_state(CMD_RX_ON);
+                            }
+                            else
+#endif
+                            {
+                                /* Set to default state */
+                                set_trx_state(CMD_RX_AACK_ON);
+                            }
                         }
 
                         if (ret_val)
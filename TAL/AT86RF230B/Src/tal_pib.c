@@ -412,6 +412,23 @@ retval_t tal_pib_set(uint8_t attribute, pib_value_t *value)
                     if ((uint32_t)TRX_SUPPORTED_CHANNELS & ((uint32_t)0x01 << value->pib_value_8bit))
                     {
                         tal_trx_status_t previous_trx_status = TRX_OFF;
+#ifdef PROMISCUOUS_MODE
+                        /*
+                         * In promiscuous mode the transceiver is in basic
+                         * RX_ON and never sends an ACK, so the channel is
+                         * changed without leaving RX_ON. The PLL settles within
+                         * the channel switch time instead of the TRX_OFF ->
+                         * RX_ON transition, which keeps the blind time of a
+                         * channel hopping sniffer short.
+                         */
+                        if (tal_pib_PromiscuousMode &&
+                            (pal_trx_bit_read(SR_TRX_STATUS) == RX_ON))
+                        {
+                            tal_pib_CurrentChannel = value->pib_value_8bit;
+                            pal_trx_bit_write(SR_CHANNEL, tal_pib_CurrentChannel);
+                            break;
+                        }
+#endif
                         /*
                          * Set trx to "soft" off avoiding that ongoing
                          * transaction (e.g. ACK) are interrupted.
@@ -430,8 +447,17 @@ retval_t tal_pib_set(uint8_t attribute, pib_value_t *value)
                         /* Re-store previous trx state */
                         if (previous_trx_status != TRX_OFF)
                         {
-                            /* Set to default state */
-                            set_trx_state(CMD_RX_AACK_ON);
+#ifdef PROMISCUOUS_MODE
+                            if (tal_pib_PromiscuousMode)
+                            {
+                                set_trx_state(CMD_RX_ON);
+                            }
+                            else
+#endif
+                            {
+                                /* Set to default state */
+                                set_trx_state(CMD_RX_AACK_ON);
+                            }
                         }
                     }
                     else
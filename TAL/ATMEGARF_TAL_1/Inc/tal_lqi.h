@@ -0,0 +1,172 @@
+/**
+ * @file tal_lqi.h
+ *
+ * @brief Lookup tables for LQI normalization and RSSI calculation
+ *
+ * The tables are generated by the preprocessor from the transceiver
+ * specific constants, so that the reception path only needs a flash read
+ * instead of a 16-bit multiplication and division per received frame.
+ * This file is shared by TAL and TINY_TAL and shall only be included by
+ * the frame reception module.
+ *
+ * $Id: tal_lqi.h $
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef TAL_LQI_H
+#define TAL_LQI_H
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include "pal.h"
+#include "atmega128rfa1.h"
+
+/* === MACROS ============================================================== */
+
+/* Constant defines for the LQI calculation */
+#define ED_THRESHOLD                    (30)
+#define ED_MAX_VAL                      (-RSSI_BASE_VAL - ED_THRESHOLD)
+#define LQI_MAX                         (3)
+/* Constant define for the ED scaling: register value at -35dBm */
+#define CLIP_VALUE_REG                  (55)
+
+/*
+ * Helper macros expanding the table entry macro for consecutive indices.
+ */
+#define LQI_TABLE_4(entry, idx)         entry(idx), entry((idx) + 1), \
+                                        entry((idx) + 2), entry((idx) + 3)
+#define LQI_TABLE_16(entry, idx)        LQI_TABLE_4(entry, idx), LQI_TABLE_4(entry, (idx) + 4), \
+                                        LQI_TABLE_4(entry, (idx) + 8), LQI_TABLE_4(entry, (idx) + 12)
+#define LQI_TABLE_64(entry, idx)        LQI_TABLE_16(entry, idx), LQI_TABLE_16(entry, (idx) + 16), \
+                                        LQI_TABLE_16(entry, (idx) + 32), LQI_TABLE_16(entry, (idx) + 48)
+
+#ifdef RSSI_TO_LQI_MAPPING
+/*
+ * The table is indexed by the ED value. ED values above CLIP_VALUE_REG
+ * (-35dBm) are clipped to 0xFF.
+ */
+#define LQI_TABLE_LEN                   (64)
+#define LQI_ENTRY(ed)                   \
+    ((ed) > CLIP_VALUE_REG ? 0xFF : (uint8_t)(((ed) * 0xFFU) / CLIP_VALUE_REG))
+#define LQI_TABLE_ENTRIES               LQI_TABLE_64(LQI_ENTRY, 0)
+
+#if (CLIP_VALUE_REG >= LQI_TABLE_LEN)
+#error "LQI table does not cover CLIP_VALUE_REG"
+#endif
+#else   /* #ifdef RSSI_TO_LQI_MAPPING */
+/*
+ * The table is indexed by the product of LQI* (the two most significant bits
+ * of the measured LQI) and the clipped ED value.
+ */
+#define LQI_TABLE_LEN                   (192)
+#define LQI_ENTRY(prod)                 \
+    ((prod) >= (ED_MAX_VAL * LQI_MAX) ? 0xFF : (uint8_t)(((prod) * 255UL) / (ED_MAX_VAL * LQI_MAX)))
+#define LQI_TABLE_ENTRIES               \
+    LQI_TABLE_64(LQI_ENTRY, 0), \
+    LQI_TABLE_64(LQI_ENTRY, 64), \
+    LQI_TABLE_64(LQI_ENTRY, 128)
+
+#if ((ED_MAX_VAL * LQI_MAX) >= LQI_TABLE_LEN)
+#error "LQI table does not cover ED_MAX_VAL * LQI_MAX"
+#endif
+#endif  /* #ifdef RSSI_TO_LQI_MAPPING */
+
+/* === GLOBALS ============================================================= */
+
+/**
+ * Normalized LQI values (ppduLinkQuality)
+ */
+static FLASH_DECLARE(const uint8_t lqi_table[LQI_TABLE_LEN]) =
+{
+    LQI_TABLE_ENTRIES
+};
+
+/* === IMPLEMENTATION ====================================================== */
+
+#ifdef RSSI_TO_LQI_MAPPING
+/**
+ * @brief Normalize LQI
+ *
+ * This function normalizes the LQI value based on the RSSI/ED value.
+ *
+ * @param ed_value Read ED value
+ *
+ * @return The calculated/normalized LQI value: ppduLinkQuality
+ */
+static inline uint8_t normalize_lqi(uint8_t ed_value)
+{
+    if (ed_value > CLIP_VALUE_REG)
+    {
+        return 0xFF;
+    }
+
+    return PGM_READ_BYTE(&lqi_table[ed_value]);
+}
+
+#else
+
+/**
+ * @brief Normalize LQI
+ *
+ * This function normalizes the LQI value based on the ED and
+ * the originally appended LQI value.
+ *
+ * @param lqi Measured LQI
+ * @param ed_value Read ED value
+ *
+ * @return The calculated LQI value: ppduLinkQuality
+ */
+static inline uint8_t normalize_lqi(uint8_t lqi, uint8_t ed_value)
+{
+#ifdef HIGH_DATA_RATE_SUPPORT
+    if (tal_pib_CurrentPage != 0)
+    {
+        /* High data rate modes do not provide a valid LQI value. */
+        if (ed_value > ED_MAX_VAL)
+        {
+            return 0xFF;
+        }
+        else
+        {
+            return (ed_value * (255 / ED_MAX_VAL));
+        }
+    }
+#endif
+
+    if (ed_value > ED_MAX_VAL)
+    {
+        ed_value = ED_MAX_VAL;
+    }
+    else if (ed_value == 0)
+    {
+        ed_value = 1;
+    }
+
+    return PGM_READ_BYTE(&lqi_table[(uint8_t)((lqi >> 6) * ed_value)]);
+}
+#endif /* #ifdef RSSI_TO_LQI_MAPPING */
+
+
+
+/**
+ * @brief Converts an ED register value into the received signal strength
+ *
+ * @param ed_value ED register value measured during frame reception
+ *
+ * @return Received signal strength in dBm
+ */
+static inline int8_t ed_to_rssi(uint8_t ed_value)
+{
+    return (int8_t)(RSSI_BASE_VAL + ed_value);
+}
+
+#endif /* TAL_LQI_H */
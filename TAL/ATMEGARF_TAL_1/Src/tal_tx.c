@@ -32,6 +32,7 @@
 #include "qmm.h"
 #include "tal_rx.h"
 #include "tal_internal.h"
+#include "tlm.h"
 #include "atmega128rfa1.h"
 #ifdef BEACON_SUPPORT
 #include "tal_slotted_csma.h"
@@ -95,6 +96,9 @@ retval_t tal_tx_frame(frame_info_t *tx_frame,
         return MAC_INVALID_PARAMETER;
     }
 
+    TLM_EVENT(TLM_EV_TX_START, tal_frame_to_tx[0],
+              (uint16_t)csma_mode | ((uint16_t)perform_frame_retry << 8));
+
 #ifdef BEACON_SUPPORT
     // check if beacon mode is used
     if (csma_mode == CSMA_SLOTTED)
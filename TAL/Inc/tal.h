@@ -29,6 +29,7 @@
 #include "return_val.h"
 #include "tal_types.h"
 #include "mac_build_config.h"
+#include "symbol_time.h"
 
 /* === EXTERNALS =========================================================== */
 
@@ -143,6 +144,13 @@ extern uint8_t tal_pib_MaxFrameRetries;
  * Promiscuous Mode
  */
 extern bool tal_pib_PromiscuousMode;
+
+/**
+ * Number of frames with invalid FCS discarded in promiscuous mode;
+ * incremented by the RX interrupt, so it has to be read within a critical
+ * region
+ */
+extern volatile uint16_t tal_prom_crc_error_cnt;
 #endif
 
 
@@ -218,6 +226,12 @@ frame_info_tag
   */
     uint32_t time_stamp;
 #endif  /* #if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP) */
+#if defined(ENABLE_RSSI) || defined(DOXYGEN)
+/** Received signal strength in dBm, derived from the ED value
+  * measured during frame reception.
+  */
+    int8_t rssi;
+#endif  /* #if defined(ENABLE_RSSI) || defined(DOXYGEN) */
 /** Pointer to MPDU */
     uint8_t *mpdu;
 } frame_info_t;
@@ -377,10 +391,17 @@ typedef union
 #if (RF_BAND == BAND_2400)
     #define TAL_CONVERT_US_TO_SYMBOLS(time)         ((time) >> 4)
 #else   /* (RF_BAND == BAND_900) */
-    #define TAL_CONVERT_US_TO_SYMBOLS(time)                                 \
-        (tal_pib_CurrentPage == 0 ?                                         \
-            (tal_pib_CurrentChannel == 0 ? ((time) / 50) : ((time) / 25)) : \
-            (tal_pib_CurrentChannel == 0 ? ((time) / 40) : ((time) >> 4))   \
+    /*
+     * The divisions by 50, 25 and 40 are composed of shifts and exact
+     * divisions by 5, see symbol_time.h.
+     */
+    #define TAL_CONVERT_US_TO_SYMBOLS(time)                                                 \
+        (tal_pib_CurrentPage == 0 ?                                                         \
+            (tal_pib_CurrentChannel == 0 ?                                                  \
+                divide_by_5(divide_by_5((uint32_t)(time) >> 1)) :                           \
+                divide_by_5(divide_by_5((uint32_t)(time)))) :                               \
+            (tal_pib_CurrentChannel == 0 ?                                                  \
+                divide_by_5((uint32_t)(time) >> 3) : ((time) >> 4))                         \
         )
 #endif  /* #if (RF_BAND == BAND_2400) */
 
@@ -0,0 +1,205 @@
+/**
+ * @file tal_rate_adapt.h
+ *
+ * @brief Interface for the per-neighbour data rate adaptation
+ *
+ * The data rate of each neighbour is selected from the channel pages
+ * supported by the transceiver's high data rate modes. A neighbour moves up
+ * to the next faster page after a number of successful transmissions if the
+ * observed link quality allows it, and falls back to the next slower page
+ * after repeated missing acknowledgments or a degraded link quality.
+ *
+ * Frames sent on a high data rate page can only be received by a node
+ * listening on the same page, so both ends follow these rules:
+ * - The sender announces in each frame the page returned by
+ *   tal_rate_adapt_next_page(), i.e. the page of its next frame if this
+ *   frame is acknowledged. Where the announcement is carried is up to the
+ *   application.
+ * - The receiver hands the announced page to tal_rate_adapt_rx_page() and
+ *   thus listens on it after the frame has been acknowledged.
+ * - Both ends return to the compliant page 0 if no frame has been
+ *   exchanged for TAL_RATE_ADAPT_TIMEOUT_US: the receiver by calling
+ *   tal_rate_adapt_rx_task() regularly, the sender on its own. The sender
+ *   also returns to page 0 after a failed probe or repeated missing ACKs,
+ *   since the peer may have missed the announcement.
+ * Unsuccessful probes to a faster page are backed off exponentially.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef TAL_RATE_ADAPT_H
+#define TAL_RATE_ADAPT_H
+
+#if (defined(ENABLE_RATE_ADAPTATION) && defined(HIGH_DATA_RATE_SUPPORT)) || defined(DOXYGEN)
+
+/* === INCLUDES ============================================================ */
+
+#include "return_val.h"
+#include "tal.h"
+
+#if (TAL_TYPE == AT86RF230B)
+#error "Rate adaptation requires a transceiver with high data rate modes"
+#endif
+
+/* === TYPES =============================================================== */
+
+
+/* === MACROS ============================================================== */
+
+/**
+ * Number of neighbours whose data rate is tracked. If the table is full the
+ * least recently used neighbour is replaced.
+ */
+#ifndef TAL_RATE_ADAPT_MAX_NEIGHBOURS
+#define TAL_RATE_ADAPT_MAX_NEIGHBOURS   (8)
+#endif
+
+/**
+ * Minimum number of successful transmissions before a faster page is probed.
+ * The number is doubled after each failed probe.
+ */
+#ifndef TAL_RATE_ADAPT_PROBE_INTERVAL
+#define TAL_RATE_ADAPT_PROBE_INTERVAL   (10)
+#endif
+
+/** Number of consecutive missing ACKs after which a slower page is used */
+#ifndef TAL_RATE_ADAPT_MAX_FAILURES
+#define TAL_RATE_ADAPT_MAX_FAILURES     (2)
+#endif
+
+/** Averaged LQI required to probe a faster page */
+#ifndef TAL_RATE_ADAPT_LQI_UP
+#define TAL_RATE_ADAPT_LQI_UP           (0xF0)
+#endif
+
+/** Averaged LQI below which a slower page is used */
+#ifndef TAL_RATE_ADAPT_LQI_DOWN
+#define TAL_RATE_ADAPT_LQI_DOWN         (0xA0)
+#endif
+
+/**
+ * Averaged ED value required to probe a faster page, normalized to
+ * 0x00 - 0xFF like the ED value of tal_ed_end_cb()
+ */
+#ifndef TAL_RATE_ADAPT_ED_UP
+#define TAL_RATE_ADAPT_ED_UP            (0x40)
+#endif
+
+/** Time in us without exchanged frame after which both ends use page 0 */
+#ifndef TAL_RATE_ADAPT_TIMEOUT_US
+#define TAL_RATE_ADAPT_TIMEOUT_US       (50000UL)
+#endif
+
+/* === GLOBALS ============================================================= */
+
+
+/* === PROTOTYPES ========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the rate adaptation
+ *
+ * Forgets all neighbours; new neighbours start at the compliant page.
+ */
+void tal_rate_adapt_init(void);
+
+/**
+ * @brief Gets the channel page currently selected for a neighbour
+ *
+ * The lookup does not create an entry; unknown neighbours use page 0.
+ *
+ * @param addr Short address of the neighbour
+ *
+ * @return Channel page to be used for transmissions to this neighbour
+ */
+uint8_t tal_rate_adapt_get_page(uint16_t addr);
+
+/**
+ * @brief Gets the channel page to be announced to a neighbour
+ *
+ * @param addr Short address of the neighbour
+ *
+ * @return Channel page used for the next frame to this neighbour if the
+ *         frame currently sent is acknowledged
+ */
+uint8_t tal_rate_adapt_next_page(uint16_t addr);
+
+/**
+ * @brief Sets the channel page selected for a neighbour
+ *
+ * Switches phyCurrentPage to the page selected for the neighbour, if the
+ * current page differs. It should be called before each tal_tx_frame()
+ * to this neighbour.
+ *
+ * @param addr Short address of the neighbour
+ *
+ * @return TAL_BUSY if the TAL is currently busy;
+ *         MAC_INVALID_PARAMETER if the page is not supported on the channel;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t tal_rate_adapt_set_page(uint16_t addr);
+
+/**
+ * @brief Updates the statistics of a neighbour with a transmission result
+ *
+ * An acknowledged frame creates the neighbour's entry; if the table is full
+ * the least recently used neighbour is replaced.
+ *
+ * @param addr Short address of the neighbour
+ * @param status Status returned by tal_tx_frame_done_cb()
+ */
+void tal_rate_adapt_tx_update(uint16_t addr, retval_t status);
+
+/**
+ * @brief Updates the statistics of a neighbour with a received frame
+ *
+ * Frames of neighbours without entry are ignored.
+ *
+ * @param addr Short address of the neighbour
+ * @param lqi Link quality of the received frame
+ * @param ed_value Value of register PHY_ED_LEVEL appended to the received
+ *                 frame by the TAL; it is normalized by the rate adaptation
+ */
+void tal_rate_adapt_rx_update(uint16_t addr, uint8_t lqi, uint8_t ed_value);
+
+/**
+ * @brief Follows the channel page announced by a sender
+ *
+ * @param page Channel page announced in the received frame
+ *
+ * @return MAC_INVALID_PARAMETER if the page is not part of the rate ladder;
+ *         TAL_BUSY if the TAL is currently busy;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t tal_rate_adapt_rx_page(uint8_t page);
+
+/**
+ * @brief Returns to the compliant page if no announcement has been received
+ *
+ * Has to be called regularly by a receiver following announced pages.
+ *
+ * @return TAL_BUSY if the TAL is currently busy;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t tal_rate_adapt_rx_task(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* #if (defined(ENABLE_RATE_ADAPTATION) && defined(HIGH_DATA_RATE_SUPPORT)) */
+
+#endif /* TAL_RATE_ADAPT_H */
+/* EOF */
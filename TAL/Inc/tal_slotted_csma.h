@@ -35,9 +35,14 @@ typedef enum csma_state_tag
     BACKOFF_WAITING_FOR_CCA_TIMER,
     BACKOFF_WAITING_FOR_BEACON,
     CSMA_ACCESS_FAILURE,
+#if (TAL_TYPE == AT86RF230B)
+    /* The AT86RF230B waits for the ACK in software. */
     FRAME_SENDING_WITH_ACK,
     FRAME_SENDING_NO_ACK,
     WAITING_FOR_ACK,
+#else
+    FRAME_SENDING,
+#endif
     TX_DONE_SUCCESS,
     TX_DONE_FRAME_PENDING,
     TX_DONE_NO_ACK,
@@ -0,0 +1,143 @@
+/**
+ * @file tal_trx.h
+ *
+ * @brief Transceiver descriptor for the TAL sources shared by all transceivers
+ *
+ * This file selects the register map of the transceiver given by TAL_TYPE
+ * and maps the few differences between the transceivers to common names,
+ * so that TAL functionality that is identical for all transceivers is kept
+ * in a single source file in TAL/Src.
+ *
+ * Shared so far: tal_rx.c, tal_rx_enable.c, tal_pwr_mgmt.c,
+ * tal_slotted_csma.c (not for the AT86RF230B, which acknowledges frames in
+ * software), tal_pib.h, tal_rx.h and tal_slotted_csma.h. tal.c, tal_tx.c,
+ * tal_init.c, tal_pib.c, tal_ed.c and tal_irq_handler.c are still kept per
+ * transceiver; their differences are transceiver-specific logic rather
+ * than register names and have to be expressed by further descriptor
+ * entries before they can move here.
+ *
+ * The TINY_TAL is not covered: it has its own API and sources, so it does
+ * not share files with the TAL. Its tiny_tal_rx_enable.c and
+ * tiny_tal_pwr_mgmt.c only differ in the same points as the TAL files
+ * shared here, so they can be merged the same way using this descriptor.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef TAL_TRX_H
+#define TAL_TRX_H
+
+/* === INCLUDES ============================================================ */
+
+#include "tal_types.h"
+
+#if (TAL_TYPE == AT86RF230B)
+#include "at86rf230b.h"
+#elif (TAL_TYPE == AT86RF231)
+#include "at86rf231.h"
+#elif (TAL_TYPE == AT86RF212)
+#include "at86rf212.h"
+#elif (TAL_TYPE == ATMEGARF_TAL_1)
+#include "atmega128rfa1.h"
+#else
+#error "TAL_TYPE is not supported by the shared TAL sources"
+#endif
+
+#ifdef STB_ON_SAL
+#include "sal_types.h"
+#endif
+
+/* === TYPES =============================================================== */
+
+
+/* === MACROS ============================================================== */
+
+/**
+ * Command setting the transceiver to SLEEP
+ */
+#if (TAL_TYPE == AT86RF230B)
+#define TRX_CMD_SLEEP                   (CMD_TRX_SLEEP)
+#else
+#define TRX_CMD_SLEEP                   (CMD_SLEEP)
+#endif
+
+/**
+ * Value of sub-register SR_CCA_DONE once the CCA has been completed
+ */
+#if (TAL_TYPE == ATMEGARF_TAL_1)
+#define TRX_CCA_DONE                    (CCA_CALCULATION_DONE)
+#else
+#define TRX_CCA_DONE                    (CCA_DETECTION_DONE)
+#endif
+
+/**
+ * The MCU timer of external transceivers is clocked by the transceiver's
+ * CLKM output, so its clock source has to be switched while the transceiver
+ * sleeps. Single chip transceivers do not need this.
+ */
+#if (TAL_TYPE == ATMEGARF_TAL_1)
+#define TRX_SWITCH_TIMER_SOURCE_ON_SLEEP    (0)
+#else
+#define TRX_SWITCH_TIMER_SOURCE_ON_SLEEP    (1)
+#endif
+
+/**
+ * The transceiver's AES engine is used by the STB and loses its key while
+ * the transceiver sleeps.
+ */
+#if defined(STB_ON_SAL) && \
+    ((TAL_TYPE == ATMEGARF_TAL_1) || \
+     (((TAL_TYPE == AT86RF231) || (TAL_TYPE == AT86RF212)) && (SAL_TYPE == AT86RF2xx)))
+#define TRX_AES_LOST_ON_SLEEP           (1)
+#else
+#define TRX_AES_LOST_ON_SLEEP           (0)
+#endif
+
+/**
+ * Single chip transceivers provide the length of a received frame in a
+ * register, protect the frame buffer while it is read and raise TX_END for
+ * automatically sent ACKs. Reading the frame buffer of external transceivers
+ * via SPI starts with the length field.
+ */
+#if (TAL_TYPE == ATMEGARF_TAL_1)
+#define TRX_SINGLE_CHIP                 (1)
+#else
+#define TRX_SINGLE_CHIP                 (0)
+#endif
+
+/**
+ * The AT86RF230B does not timestamp the frame start, so the timestamp of a
+ * received frame is taken when its end is handled.
+ */
+#if (TAL_TYPE == AT86RF230B)
+#define TRX_RX_TSTAMP_AT_FRAME_END      (1)
+#else
+#define TRX_RX_TSTAMP_AT_FRAME_END      (0)
+#endif
+
+/**
+ * Value of register PHY_ED_LEVEL at which the ED value is clipped, see
+ * CLIP_VALUE_REG in tal_lqi.h
+ */
+#if (TAL_TYPE == AT86RF212)
+#define TRX_ED_CLIP_VALUE_REG           (62)
+#elif (TAL_TYPE == ATMEGARF_TAL_1)
+#define TRX_ED_CLIP_VALUE_REG           (55)
+#else
+#define TRX_ED_CLIP_VALUE_REG           (56)
+#endif
+
+/* === PROTOTYPES ========================================================== */
+
+
+#endif /* TAL_TRX_H */
+/* EOF */
@@ -24,14 +24,12 @@
 #include "return_val.h"
 #include "tal.h"
 #include "tal_constants.h"
-#include "at86rf231.h"
+#include "tal_trx.h"
 #include "tal_internal.h"
-#ifdef STB_ON_SAL
-#include "sal_types.h"
-#if (SAL_TYPE == AT86RF2xx)
+#include "tlm.h"
+#if (TRX_AES_LOST_ON_SLEEP == 1)
 #include "stb.h"
 #endif
-#endif
 
 /* === TYPES =============================================================== */
 
@@ -91,9 +89,11 @@ retval_t tal_trx_sleep(sleep_mode_t mode)
         trx_status = set_trx_state(CMD_TRX_OFF);
     } while (trx_status != TRX_OFF);
 
+#if (TRX_SWITCH_TIMER_SOURCE_ON_SLEEP == 1)
     pal_timer_source_select(TMR_CLK_SRC_DURING_TRX_SLEEP);
+#endif
 
-    trx_status = set_trx_state(CMD_SLEEP);
+    trx_status = set_trx_state(TRX_CMD_SLEEP);
 
 #ifdef ENABLE_FTN_PLL_CALIBRATION
     /*
@@ -105,11 +105,10 @@ retval_t tal_trx_sleep(sleep_mode_t mode)
 
     if (trx_status == TRX_SLEEP)
     {
-#ifdef STB_ON_SAL
-#if (SAL_TYPE == AT86RF2xx)
+#if (TRX_AES_LOST_ON_SLEEP == 1)
         stb_restart();
 #endif
-#endif
+        TLM_EVENT(TLM_EV_TRX_SLEEP, mode, 0);
         return MAC_SUCCESS;
     }
     else
@@ -170,7 +169,10 @@ retval_t tal_trx_wakeup(void)
 
     if (trx_status == TRX_OFF)
     {
+#if (TRX_SWITCH_TIMER_SOURCE_ON_SLEEP == 1)
         pal_timer_source_select(TMR_CLK_SRC_DURING_TRX_AWAKE);
+#endif
+        TLM_EVENT(TLM_EV_TRX_WAKEUP, 0, 0);
         return MAC_SUCCESS;
     }
     else
@@ -0,0 +1,512 @@
+/**
+ * @file tal_rate_adapt.c
+ *
+ * @brief Per-neighbour data rate adaptation using the high data rate pages
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#if defined(ENABLE_RATE_ADAPTATION) && defined(HIGH_DATA_RATE_SUPPORT)
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "pal.h"
+#include "return_val.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "tal_rate_adapt.h"
+#include "tal_trx.h"
+
+/* === TYPES =============================================================== */
+
+/** Rate adaptation state of a neighbour */
+typedef struct rate_adapt_nb_tag
+{
+    /** Short address of the neighbour */
+    uint16_t addr;
+    /** Index into rate_adapt_pages */
+    uint8_t rate;
+    /** Averaged LQI of received frames; 0 if unknown */
+    uint8_t lqi;
+    /** Averaged normalized ED value of received frames */
+    uint8_t ed;
+    /** Successful transmissions since the last rate change */
+    uint8_t successes;
+    /** Successful transmissions required before the next probe */
+    uint8_t probe_interval;
+    /** Consecutive transmissions without ACK */
+    uint8_t failures;
+    /** Value of rate_adapt_stamp when the entry was used last */
+    uint8_t last_used;
+    /** Time of the last acknowledged transmission */
+    uint32_t last_ack_time;
+    /** Entry is in use */
+    bool valid;
+    /** Current rate was reached by a probe that is not yet confirmed */
+    bool probing;
+} rate_adapt_nb_t;
+
+/* === MACROS ============================================================== */
+
+/** Number of pages of the rate ladder */
+#define NO_OF_RATES                     (sizeof(rate_adapt_pages))
+
+/** Upper limit of the probe interval */
+#define MAX_PROBE_INTERVAL              (0xF0)
+
+/** Exponentially weighted moving average with a weight of 1/8 */
+#define EWMA(avg, val)                  ((uint8_t)((avg) - ((avg) >> 3) + ((val) >> 3)))
+
+/** Scales the value of register PHY_ED_LEVEL to 0x00 - 0xFF like tal_lqi.h */
+#define NORMALIZE_ED(ed)                (((ed) > TRX_ED_CLIP_VALUE_REG) ? 0xFF : \
+                                         (uint8_t)(((uint16_t)(ed) * 0xFF) / TRX_ED_CLIP_VALUE_REG))
+
+/* === GLOBALS ============================================================= */
+
+/**
+ * Channel pages ordered by increasing data rate. The ladder is the same for
+ * all transceivers supporting high data rates:
+ * AT86RF231/ATmega128RFA1: 250 kbit/s, 500 kbit/s, 1 Mbit/s, 2 Mbit/s;
+ * AT86RF212 (channels 1-10): 40 kbit/s BPSK, 250 kbit/s, 500 kbit/s, 1 Mbit/s.
+ */
+static FLASH_DECLARE(const uint8_t rate_adapt_pages[]) = { 0, 2, 16, 17 };
+
+/** Neighbour table */
+static rate_adapt_nb_t rate_adapt_nbs[TAL_RATE_ADAPT_MAX_NEIGHBOURS];
+
+/** Running counter used to find the least recently used neighbour */
+static uint8_t rate_adapt_stamp;
+
+/** Time of the last page announcement received */
+static uint32_t rx_page_time;
+
+/* === PROTOTYPES ========================================================== */
+
+static rate_adapt_nb_t *find_nb(uint16_t addr);
+static rate_adapt_nb_t *alloc_nb(uint16_t addr);
+static void tx_success(rate_adapt_nb_t *nb);
+static void set_rate(rate_adapt_nb_t *nb, uint8_t rate);
+static bool page_in_ladder(uint8_t page);
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Initializes the rate adaptation
+ */
+void tal_rate_adapt_init(void)
+{
+    memset(rate_adapt_nbs, 0, sizeof(rate_adapt_nbs));
+    rate_adapt_stamp = 0;
+    pal_get_current_time(&rx_page_time);
+}
+
+
+
+/**
+ * @brief Gets the channel page currently selected for a neighbour
+ *
+ * @param addr Short address of the neighbour
+ *
+ * @return Channel page to be used for transmissions to this neighbour
+ */
+uint8_t tal_rate_adapt_get_page(uint16_t addr)
+{
+    rate_adapt_nb_t *nb = find_nb(addr);
+
+    if (NULL == nb)
+    {
+        /* Unknown neighbours are served on the compliant page. */
+        return PGM_READ_BYTE(&rate_adapt_pages[0]);
+    }
+
+    return PGM_READ_BYTE(&rate_adapt_pages[nb->rate]);
+}
+
+
+
+/**
+ * @brief Gets the channel page to be announced to a neighbour
+ *
+ * @param addr Short address of the neighbour
+ *
+ * @return Channel page used for the next frame to this neighbour if the
+ *         frame currently sent is acknowledged
+ */
+uint8_t tal_rate_adapt_next_page(uint16_t addr)
+{
+    rate_adapt_nb_t *nb = find_nb(addr);
+    rate_adapt_nb_t next;
+
+    if (NULL == nb)
+    {
+        /* The entry is created with the first acknowledged frame. */
+        memset(&next, 0, sizeof(rate_adapt_nb_t));
+        next.probe_interval = TAL_RATE_ADAPT_PROBE_INTERVAL;
+    }
+    else
+    {
+        next = *nb;
+    }
+
+    tx_success(&next);
+
+    return PGM_READ_BYTE(&rate_adapt_pages[next.rate]);
+}
+
+
+
+/**
+ * @brief Sets the channel page selected for a neighbour
+ *
+ * @param addr Short address of the neighbour
+ *
+ * @return TAL_BUSY if the TAL is currently busy;
+ *         MAC_INVALID_PARAMETER if the page is not supported on the channel;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t tal_rate_adapt_set_page(uint16_t addr)
+{
+    uint8_t current_page;
+    pib_value_t pib_value;
+
+    pib_value.pib_value_8bit = tal_rate_adapt_get_page(addr);
+    tal_pib_get(phyCurrentPage, &current_page);
+    if (current_page == pib_value.pib_value_8bit)
+    {
+        return MAC_SUCCESS;
+    }
+
+    return tal_pib_set(phyCurrentPage, &pib_value);
+}
+
+
+
+/**
+ * @brief Updates the statistics of a neighbour with a transmission result
+ *
+ * @param addr Short address of the neighbour
+ * @param status Status returned by tal_tx_frame_done_cb()
+ */
+void tal_rate_adapt_tx_update(uint16_t addr, retval_t status)
+{
+    rate_adapt_nb_t *nb;
+
+    if (status == MAC_SUCCESS)
+    {
+        nb = alloc_nb(addr);
+        tx_success(nb);
+        pal_get_current_time(&nb->last_ack_time);
+    }
+    else if (status == MAC_NO_ACK)
+    {
+        nb = find_nb(addr);
+        if (NULL == nb)
+        {
+            /* Unknown neighbours are already served on the compliant page. */
+            return;
+        }
+
+        nb->failures++;
+        /*
+         * The peer may have missed the last announcement, so a failing
+         * probe or repeated failures return to the compliant page, on which
+         * the peer ends up after TAL_RATE_ADAPT_TIMEOUT_US as well.
+         */
+        if (nb->probing || (nb->failures >= TAL_RATE_ADAPT_MAX_FAILURES))
+        {
+            if (nb->probing)
+            {
+                nb->probing = false;
+                if (nb->probe_interval < (MAX_PROBE_INTERVAL / 2))
+                {
+                    nb->probe_interval <<= 1;
+                }
+                else
+                {
+                    nb->probe_interval = MAX_PROBE_INTERVAL;
+                }
+            }
+            set_rate(nb, 0);
+        }
+    }
+    /* Channel access failures say nothing about the link. */
+}
+
+
+
+/**
+ * @brief Updates the statistics of a neighbour with a received frame
+ *
+ * @param addr Short address of the neighbour
+ * @param lqi Link quality of the received frame
+ * @param ed_value Value of register PHY_ED_LEVEL appended to the received
+ *                 frame by the TAL
+ */
+void tal_rate_adapt_rx_update(uint16_t addr, uint8_t lqi, uint8_t ed_value)
+{
+    rate_adapt_nb_t *nb = find_nb(addr);
+
+    if (NULL == nb)
+    {
+        /* Only neighbours frames are sent to are tracked. */
+        return;
+    }
+
+    ed_value = NORMALIZE_ED(ed_value);
+    if (nb->lqi == 0)
+    {
+        nb->lqi = lqi;
+        nb->ed = ed_value;
+    }
+    else
+    {
+        nb->lqi = EWMA(nb->lqi, lqi);
+        nb->ed = EWMA(nb->ed, ed_value);
+    }
+    /* A degraded link is taken into account by the next announcement. */
+}
+
+
+
+/**
+ * @brief Follows the channel page announced by a sender
+ *
+ * @param page Channel page announced in the received frame
+ *
+ * @return MAC_INVALID_PARAMETER if the page is not part of the rate ladder;
+ *         TAL_BUSY if the TAL is currently busy;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t tal_rate_adapt_rx_page(uint8_t page)
+{
+    uint8_t current_page;
+    pib_value_t pib_value;
+
+    if (!page_in_ladder(page))
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    pal_get_current_time(&rx_page_time);
+
+    tal_pib_get(phyCurrentPage, &current_page);
+    if (current_page == page)
+    {
+        return MAC_SUCCESS;
+    }
+
+    pib_value.pib_value_8bit = page;
+    return tal_pib_set(phyCurrentPage, &pib_value);
+}
+
+
+
+/**
+ * @brief Returns to the compliant page if no announcement has been received
+ *
+ * @return TAL_BUSY if the TAL is currently busy;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t tal_rate_adapt_rx_task(void)
+{
+    uint8_t current_page;
+    uint32_t now;
+    pib_value_t pib_value;
+
+    pib_value.pib_value_8bit = PGM_READ_BYTE(&rate_adapt_pages[0]);
+    tal_pib_get(phyCurrentPage, &current_page);
+    if (current_page == pib_value.pib_value_8bit)
+    {
+        return MAC_SUCCESS;
+    }
+
+    pal_get_current_time(&now);
+    if (pal_sub_time_us(now, rx_page_time) < TAL_RATE_ADAPT_TIMEOUT_US)
+    {
+        return MAC_SUCCESS;
+    }
+
+    return tal_pib_set(phyCurrentPage, &pib_value);
+}
+
+
+
+/**
+ * @brief Finds a neighbour
+ *
+ * A neighbour without acknowledged frame for TAL_RATE_ADAPT_TIMEOUT_US is
+ * returned to the compliant page, like the peer does.
+ *
+ * @param addr Short address of the neighbour
+ *
+ * @return Pointer to the neighbour's entry, or NULL if it is unknown
+ */
+static rate_adapt_nb_t *find_nb(uint16_t addr)
+{
+    rate_adapt_nb_t *nb;
+    uint32_t now;
+    uint8_t i;
+
+    for (i = 0; i < TAL_RATE_ADAPT_MAX_NEIGHBOURS; i++)
+    {
+        nb = &rate_adapt_nbs[i];
+        if (nb->valid && (nb->addr == addr))
+        {
+            pal_get_current_time(&now);
+            if ((nb->rate > 0) &&
+                (pal_sub_time_us(now, nb->last_ack_time) >= TAL_RATE_ADAPT_TIMEOUT_US))
+            {
+                nb->probing = false;
+                set_rate(nb, 0);
+            }
+            return nb;
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/**
+ * @brief Finds a neighbour, or allocates an entry for it
+ *
+ * If the table is full, the least recently used entry is replaced.
+ *
+ * @param addr Short address of the neighbour
+ *
+ * @return Pointer to the neighbour's entry
+ */
+static rate_adapt_nb_t *alloc_nb(uint16_t addr)
+{
+    rate_adapt_nb_t *nb = find_nb(addr);
+    rate_adapt_nb_t *lru = &rate_adapt_nbs[0];
+    uint8_t i;
+
+    rate_adapt_stamp++;
+
+    if (NULL != nb)
+    {
+        nb->last_used = rate_adapt_stamp;
+        return nb;
+    }
+
+    for (i = 0; i < TAL_RATE_ADAPT_MAX_NEIGHBOURS; i++)
+    {
+        nb = &rate_adapt_nbs[i];
+        if (!nb->valid)
+        {
+            lru = nb;
+            break;
+        }
+        if ((uint8_t)(rate_adapt_stamp - nb->last_used) >
+            (uint8_t)(rate_adapt_stamp - lru->last_used))
+        {
+            lru = nb;
+        }
+    }
+
+    memset(lru, 0, sizeof(rate_adapt_nb_t));
+    lru->valid = true;
+    lru->addr = addr;
+    lru->probe_interval = TAL_RATE_ADAPT_PROBE_INTERVAL;
+    lru->last_used = rate_adapt_stamp;
+
+    return lru;
+}
+
+
+
+/**
+ * @brief Updates a neighbour with an acknowledged transmission
+ *
+ * The resulting rate is announced to the peer before the transmission, see
+ * tal_rate_adapt_next_page(), so the update only depends on the entry.
+ *
+ * @param nb Neighbour
+ */
+static void tx_success(rate_adapt_nb_t *nb)
+{
+    nb->failures = 0;
+    if (nb->probing)
+    {
+        /* The faster page works; start probing with the base interval. */
+        nb->probing = false;
+        nb->probe_interval = TAL_RATE_ADAPT_PROBE_INTERVAL;
+    }
+    if (nb->successes < 0xFF)
+    {
+        nb->successes++;
+    }
+
+    if ((nb->lqi != 0) && (nb->lqi < TAL_RATE_ADAPT_LQI_DOWN))
+    {
+        set_rate(nb, (nb->rate > 0) ? (nb->rate - 1) : 0);
+    }
+    else if ((nb->successes >= nb->probe_interval) &&
+             (nb->rate < (NO_OF_RATES - 1)) &&
+             ((nb->lqi == 0) ||
+              ((nb->lqi >= TAL_RATE_ADAPT_LQI_UP) && (nb->ed >= TAL_RATE_ADAPT_ED_UP))))
+    {
+        nb->rate++;
+        nb->successes = 0;
+        nb->probing = true;
+        /* The link quality has to be proven again at the new rate. */
+        nb->lqi = 0;
+    }
+}
+
+
+
+/**
+ * @brief Selects a page for a neighbour and restarts its statistics
+ *
+ * @param nb Neighbour
+ * @param rate Index into rate_adapt_pages
+ */
+static void set_rate(rate_adapt_nb_t *nb, uint8_t rate)
+{
+    nb->rate = rate;
+    nb->successes = 0;
+    nb->failures = 0;
+    nb->lqi = 0;
+}
+
+
+
+/**
+ * @brief Checks whether a channel page is part of the rate ladder
+ *
+ * @param page Channel page
+ *
+ * @return true if the page is used by the rate adaptation
+ */
+static bool page_in_ladder(uint8_t page)
+{
+    uint8_t i;
+
+    for (i = 0; i < NO_OF_RATES; i++)
+    {
+        if (PGM_READ_BYTE(&rate_adapt_pages[i]) == page)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif /* #if defined(ENABLE_RATE_ADAPTATION) && defined(HIGH_DATA_RATE_SUPPORT) */
+
+/* EOF */
@@ -29,9 +29,11 @@
 #include "tal_constants.h"
 #include "tal_pib.h"
 #include "tal_irq_handler.h"
-#include "at86rf230b.h"
+#include "tal_trx.h"
 #include "tal_rx.h"
 #include "tal_internal.h"
+#include "tlm.h"
+#include "tal_lqi.h"
 #ifdef BEACON_SUPPORT
 #include "tal_slotted_csma.h"
 #endif  /* BEACON_SUPPORT */
@@ -41,30 +43,17 @@
 
 /* === MACROS ============================================================== */
 
-/* Constant defines for the LQI calculation */
-#define ED_THRESHOLD                    (60)
-#define ED_MAX                          (-RSSI_BASE_VAL - ED_THRESHOLD)
-#define LQI_MAX                         (3)
-#define UPPER_CLIPPING_VALUE        (-60)
-
 #define US_PER_OCTECT                   (32)
-#define TRX_END_PROCESS_DELAY_US        (16)
-/* Constant define for the ED scaling: register value at -35dBm */
-#define CLIP_VALUE_REG                  (56)
 
 /* === GLOBALS ============================================================= */
 
 
 /* === PROTOTYPES ========================================================== */
 
-#ifdef RSSI_TO_LQI_MAPPING
-static inline uint8_t normalize_lqi(uint8_t ed_value);
-#else
-static inline uint8_t normalize_lqi(uint8_t lqi, uint8_t ed_value);
-#endif
 
 /* === IMPLEMENTATION ====================================================== */
 
+
 /**
  * @brief Handle received frame interrupt
  *
@@ -80,9 +69,9 @@ void handle_received_frame_irq(void)
     uint8_t ext_frame_length;
     frame_info_t *receive_frame;
     uint8_t *frame_ptr;
-#if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
+#if ((defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)) && (TRX_RX_TSTAMP_AT_FRAME_END == 1)
     uint32_t timestamp_us;
-#endif  /*if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP) */
+#endif
 
     if (tal_rx_buffer == NULL)
     {
@@ -90,13 +79,13 @@ void handle_received_frame_irq(void)
         return;
     }
 
-#if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
+#if ((defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)) && (TRX_RX_TSTAMP_AT_FRAME_END == 1)
     /*
      * The timestamping is only required for beaconing networks
      * or if timestamping is explicitly enabled.
      */
     pal_trx_read_timestamp(&timestamp_us);
-#endif  /*if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP) */
+#endif
 
     receive_frame = (frame_info_t*)BMM_BUFFER_POINTER(tal_rx_buffer);
 
@@ -106,6 +95,8 @@ void handle_received_frame_irq(void)
         /* Check for valid FCS */
         if (pal_trx_bit_read(SR_RX_CRC_VALID) == CRC16_NOT_VALID)
         {
+            tal_prom_crc_error_cnt++;
+            TLM_EVENT(TLM_EV_RX_CRC_ERROR, 0, 0);
             return;
         }
     }
@@ -115,7 +106,11 @@ void handle_received_frame_irq(void)
     ed_value = pal_trx_reg_read(RG_PHY_ED_LEVEL);
 
     /* Get frame length from transceiver. */
+#if (TRX_SINGLE_CHIP == 1)
+    phy_frame_len = ext_frame_length = pal_trx_reg_read(RG_TST_RX_LENGTH);
+#else
     pal_trx_frame_read(&phy_frame_len, LENGTH_FIELD_LEN);
+#endif
 
     /* Check for valid frame length. */
     if (phy_frame_len > 127)
@@ -128,29 +123,54 @@ void handle_received_frame_irq(void)
      * is incremented.
      * In addition to that, the LQI and ED value are uploaded, too.
      */
+#if (TRX_SINGLE_CHIP == 1)
+    ext_frame_length += LQI_LEN + ED_VAL_LEN;
+#else
     ext_frame_length = phy_frame_len + LENGTH_FIELD_LEN + LQI_LEN + ED_VAL_LEN;
-
+#endif
 
     /* Update payload pointer to store received frame. */
     frame_ptr = (uint8_t *)receive_frame + LARGE_BUFFER_SIZE - ext_frame_length;
 
     /*
-     * Note: The following code is different from single chip
-     * transceivers, since reading the frame via SPI contains the length field
-     * in the first octet.
+     * Note: Reading the frame via SPI from external transceivers contains the
+     * length field in the first octet, while the frame buffer of single chip
+     * transceivers does not contain it.
      */
+#if (TRX_SINGLE_CHIP == 1)
+    pal_trx_frame_read(frame_ptr, phy_frame_len + LQI_LEN);
+    frame_ptr--;
+    *frame_ptr = phy_frame_len;
+#else
     pal_trx_frame_read(frame_ptr, LENGTH_FIELD_LEN + phy_frame_len + LQI_LEN);
+#endif
     receive_frame->mpdu = frame_ptr;
     /* Add ED value at the end of the frame buffer. */
     receive_frame->mpdu[phy_frame_len + LQI_LEN + ED_VAL_LEN] = ed_value;
 
+    TLM_EVENT(TLM_EV_RX_FRAME, phy_frame_len,
+              (uint16_t)receive_frame->mpdu[phy_frame_len + LQI_LEN] | ((uint16_t)ed_value << 8));
+
+#if (TRX_SINGLE_CHIP == 1)
+    /*
+     * Release the protected buffer and set it again for further protection.
+     */
+    pal_trx_bit_write(SR_RX_SAFE_MODE, RX_SAFE_MODE_DISABLE);  /* Disable buffer protection mode */
+    pal_trx_bit_write(SR_RX_SAFE_MODE, RX_SAFE_MODE_ENABLE);  /* Enable buffer protection mode */
+#endif
+
 #if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
-    /* Store the timestamp.
+    /*
+     * Store the timestamp.
      * The timestamping is only required for beaconing networks
      * or if timestamping is explicitly enabled.
      */
+#if (TRX_RX_TSTAMP_AT_FRAME_END == 1)
     receive_frame->time_stamp = timestamp_us;
-#endif  /*if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP) */
+#else
+    receive_frame->time_stamp = tal_rx_timestamp;
+#endif
+#endif  /* #if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP) */
 
     /* Append received frame to incoming_frame_queue and get new rx buffer. */
     qmm_queue_append(&tal_incoming_frame_queue, tal_rx_buffer);
@@ -176,9 +196,19 @@ void handle_received_frame_irq(void)
          */
         //pal_trx_reg_write(RG_TRX_STATE, CMD_RX_AACK_ON);
     }
+
+#if (TRX_SINGLE_CHIP == 1)
+    /*
+     * Clear pending TX_END IRQ: The TX_END IRQ is envoked for the transmission
+     * end of an automatically sent ACK frame. This implementation does not use
+     * this feature.
+     */
+    pal_trx_irq_flag_clr_tx_end();
+#endif
 }
 
 
+
 /**
  * @brief Parses received frame and create the frame_info_t structure
  *
@@ -230,6 +260,11 @@ void process_incoming_frame(buffer_t *buf_ptr)
         frame_ptr--;
         *frame_ptr = lqi;
 
+#ifdef ENABLE_RSSI
+        /* Provide the received signal strength in dBm. */
+        receive_frame->rssi = ed_to_rssi(ed_level);
+#endif  /* ENABLE_RSSI */
+
         receive_frame->buffer_header = buf_ptr;
 
          /* The callback function implemented by MAC is invoked. */
@@ -284,6 +319,11 @@ void process_incoming_frame(buffer_t *buf_ptr)
     frame_ptr--;
     *frame_ptr = lqi;
 
+#ifdef ENABLE_RSSI
+    /* Provide the received signal strength in dBm. */
+    receive_frame->rssi = ed_to_rssi(ed_level);
+#endif  /* ENABLE_RSSI */
+
     receive_frame->buffer_header = buf_ptr;
 
     /* The callback function implemented by MAC is invoked. */
@@ -291,75 +331,5 @@ void process_incoming_frame(buffer_t *buf_ptr)
 } /* process_incoming_frame() */
 
 
-
-#ifdef RSSI_TO_LQI_MAPPING
-/**
- * @brief Normalize LQI
- *
- * This function normalizes the LQI value based on the RSSI/ED value.
- *
- * @param ed_value Read ED value
- *
- * @return The calculated/normalized LQI value: ppduLinkQuality
- */
-static inline uint8_t normalize_lqi(uint8_t ed_value)
-{
-    /*
-     * Scale ED result.
-     * Clip values to 0xFF if > -35dBm
-     */
-    if (ed_value > CLIP_VALUE_REG)
-    {
-        return 0xFF;
-    }
-    else
-    {
-        return (uint8_t)(((uint16_t)ed_value * 0xFF) / CLIP_VALUE_REG);
-    }
-}
-
-#else
-
-/**
- * @brief Normalize LQI
- *
- * This function normalizes the LQI value based on the ED and
- * the originally appended LQI value.
- *
- * @param lqi Measured LQI
- * @param ed_value Read ED value
- *
- * @return The calculated LQI value: ppduLinkQuality
- */
-static inline uint8_t normalize_lqi(uint8_t lqi, uint8_t ed_value)
-{
-    uint16_t link_quality;
-    uint8_t lqi_star;
-
-    if (ed_value > ED_MAX)
-    {
-        ed_value = ED_MAX;
-    }
-    else if (ed_value == 0)
-    {
-        ed_value = 1;
-    }
-
-    lqi_star = lqi >> 6;
-    link_quality = (uint16_t)lqi_star * (uint16_t)ed_value * 255 / (ED_MAX * LQI_MAX);
-
-    if (link_quality > 255)
-    {
-        return 255;
-    }
-    else
-    {
-        return (uint8_t)link_quality;
-    }
-}
-#endif /* #ifdef RSSI_TO_LQI_MAPPING */
-
-
-
 /*  EOF */
 
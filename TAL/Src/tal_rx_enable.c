@@ -25,7 +25,7 @@
 #include "tal.h"
 #include "ieee_const.h"
 #include "tal_constants.h"
-#include "at86rf212.h"
+#include "tal_trx.h"
 #include "bmm.h"
 #include "qmm.h"
 #include "tal_rx.h"
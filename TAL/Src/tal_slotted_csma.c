@@ -28,21 +28,26 @@
 #include "tal_constants.h"
 #include "tal_slotted_csma.h"
 #include "tal_pib.h"
-#include "at86rf231.h"
+#include "tal_trx.h"
 #include "tal_internal.h"
 #include "tal_tx.h"
 #include "tal_irq_handler.h"
 #include "mac_build_config.h"
 
+#if (TAL_TYPE == AT86RF230B)
+#error "The AT86RF230B uses its own slotted CSMA-CA implementation"
+#endif
+
 /* === TYPES =============================================================== */
 
 
 /* === MACROS ============================================================== */
 
 /*
- * Conversion of octets to microseconds (1 octet = 32 us = 2 symbols)
+ * Conversion of octets to symbols; depends on the channel page for
+ * sub-1 GHz transceivers.
  */
-#define CONVERT_OCTETS_TO_SYM(octets)   (2 * octets)
+#define CONVERT_OCTETS_TO_SYM(octets)   ((octets) * SYMBOLS_PER_OCTET)
 #define CCA_GUARD_DURATION_US           (1000)  // used for calculation overhead
 #define CSMA_BEACON_LOSS_GUARD_TIME_US  (2000)
 #define PRE_BEACON_GUARD_TIME_US        (1000)
@@ -219,13 +224,9 @@ static void calculate_transaction_duration(void)
 
     transaction_duration_sym += CONVERT_OCTETS_TO_SYM(transaction_duration_octets);
 
-    transaction_duration_periods = transaction_duration_sym / aUnitBackoffPeriod;
-
     /* Round up to the next integer number. */
-    if ((transaction_duration_sym % aUnitBackoffPeriod) > 0)
-    {
-        transaction_duration_periods++;
-    }
+    transaction_duration_periods =
+        (uint8_t)convert_symbols_to_backoff_periods_ceil(transaction_duration_sym);
 
     /* Add 2 backoff periods that are used for CCA. */
     transaction_duration_periods += 2;
@@ -265,17 +266,13 @@ static void csma_backoff_calculation(void)
 
         time_since_last_beacon_sym = tal_sub_time_symbols(now_time_sym,
                                                           tal_pib_BeaconTxTime);
-        next_backoff_boundary_period = time_since_last_beacon_sym / aUnitBackoffPeriod;
-
-        if ((time_since_last_beacon_sym % aUnitBackoffPeriod) > 0)
-        {
-            next_backoff_boundary_period++;
-        }
+        next_backoff_boundary_period =
+            convert_symbols_to_backoff_periods_ceil(time_since_last_beacon_sym);
 
         next_backoff_boundary_us =
             TAL_CONVERT_SYMBOLS_TO_US(
                 pal_add_time_us(tal_pib_BeaconTxTime,
-                                (next_backoff_boundary_period * aUnitBackoffPeriod)) );
+                                CONVERT_BACKOFF_PERIODS_TO_SYMBOLS(next_backoff_boundary_period)) );
     }
 
     /* Check if we are still within the CAP. */
@@ -290,8 +287,9 @@ static void csma_backoff_calculation(void)
         uint32_t remaining_periods_in_CAP;  // @TODO check if variable size can be reduced
 
         /* Check if the remaining backoff time will expire in current CAP. */
-        remaining_periods_in_CAP = tal_sub_time_symbols(current_CAP_end_sym, now_time_sym) /
-                                   aUnitBackoffPeriod;
+        remaining_periods_in_CAP =
+            convert_symbols_to_backoff_periods(tal_sub_time_symbols(current_CAP_end_sym,
+                                                                    now_time_sym));
 
         if (remaining_backoff_periods > remaining_periods_in_CAP)
         {
@@ -311,7 +309,7 @@ static void csma_backoff_calculation(void)
 
             /* Add some guard time to wakeup the transceiver. */
             transaction_duration_sym =
-                (transaction_duration_periods * aUnitBackoffPeriod) +
+                CONVERT_BACKOFF_PERIODS_TO_SYMBOLS(transaction_duration_periods) +
                 TAL_CONVERT_US_TO_SYMBOLS(SLEEP_TO_TRX_OFF_US + CCA_GUARD_DURATION_US);
 
             time_after_transaction_sym =
@@ -328,7 +326,7 @@ static void csma_backoff_calculation(void)
                 cca_starttime_us =
                     pal_add_time_us(next_backoff_boundary_us,
                                     TAL_CONVERT_SYMBOLS_TO_US(
-                                        remaining_backoff_periods * aUnitBackoffPeriod));
+                                        CONVERT_BACKOFF_PERIODS_TO_SYMBOLS(remaining_backoff_periods)));
 
                 /*
                  * Ensure that wakeup time is available before CCA.
@@ -592,7 +590,7 @@ static uint8_t perform_cca_twice(void)
         {
           // poll until CCA is really done;
           cca_done = pal_trx_bit_read(SR_CCA_DONE);
-        } while (cca_done != CCA_DETECTION_DONE);
+        } while (cca_done != TRX_CCA_DONE);
 
         // between both CCA switch trx to PLL_ON to reduce power consumption
         set_trx_state(CMD_PLL_ON);
@@ -42,6 +42,25 @@ typedef enum continuous_tx_mode_tag
     PRBS_MODE = 1
 } SHORTENUM continuous_tx_mode_t;
 
+/** Per-channel result of the ED spectrum survey */
+typedef struct tfa_ed_survey_result_tag
+{
+    /** Number of ED samples taken on this channel */
+    uint16_t samples;
+    /** Mean ED value (normalized to 0x00..0xFF) */
+    uint8_t mean;
+    /** Highest ED value seen */
+    uint8_t max;
+    /** 50th percentile of the ED values */
+    uint8_t p50;
+    /** 90th percentile of the ED values */
+    uint8_t p90;
+    /** 99th percentile of the ED values */
+    uint8_t p99;
+    /** Percentage of samples above the busy threshold */
+    uint8_t duty_cycle;
+} tfa_ed_survey_result_t;
+
 /* === MACROS ============================================================== */
 
 /**
@@ -49,6 +68,21 @@ typedef enum continuous_tx_mode_tag
  */
 #define TFA_PIB_RX_SENS_DEF             (0)
 
+/**
+ * Number of histogram bins per channel used by the ED spectrum survey.
+ * Must be a power of two not larger than 256.
+ */
+#ifndef TFA_ED_SURVEY_BINS
+#define TFA_ED_SURVEY_BINS              (16)
+#endif
+
+/**
+ * Number of ED samples taken per call of tfa_ed_survey_task().
+ */
+#ifndef TFA_ED_SURVEY_SAMPLES_PER_VISIT
+#define TFA_ED_SURVEY_SAMPLES_PER_VISIT (4)
+#endif
+
 /* === GLOBALS ============================================================= */
 
 
@@ -145,6 +179,64 @@ uint8_t tfa_ed_sample(void);
  */
 uint16_t tfa_get_batmon_voltage(void);
 
+/**
+ * @brief Starts a background ED spectrum survey
+ *
+ * Clears the statistics of all channels and selects the channels to be
+ * visited by tfa_ed_survey_task().
+ *
+ * @param channel_mask Bit mask of channels to be surveyed
+ * @param threshold Normalized ED value above which a sample counts as busy
+ *
+ * @return MAC_INVALID_PARAMETER if the channel mask contains no valid channel;
+ *         MAC_SUCCESS otherwise
+ *
+ * @ingroup apiTfaApi
+ */
+retval_t tfa_ed_survey_start(uint32_t channel_mask, uint8_t threshold);
+
+/**
+ * @brief Stops the ED spectrum survey
+ *
+ * The statistics gathered so far remain available.
+ *
+ * @ingroup apiTfaApi
+ */
+void tfa_ed_survey_stop(void);
+
+/**
+ * @brief Visits the next channel of the ED spectrum survey
+ *
+ * Switches to the next channel of the survey mask, takes
+ * TFA_ED_SURVEY_SAMPLES_PER_VISIT ED samples and switches back to the
+ * current channel. It is intended to be called from the application's main
+ * loop whenever the node is idle.
+ *
+ * @param rx_on Defines whether the receiver is switched on again afterwards
+ *
+ * @return FAILURE if no survey is running;
+ *         TAL_BUSY if the TAL is currently busy;
+ *         TAL_TRX_ASLEEP if the transceiver is sleeping;
+ *         MAC_SUCCESS otherwise
+ *
+ * @ingroup apiTfaApi
+ */
+retval_t tfa_ed_survey_task(bool rx_on);
+
+/**
+ * @brief Gets the ED spectrum survey statistics of a channel
+ *
+ * @param[in] channel Channel number
+ * @param[out] result Statistics of the channel
+ *
+ * @return MAC_INVALID_PARAMETER if the channel is not valid;
+ *         FAILURE if no sample has been taken on this channel yet;
+ *         MAC_SUCCESS otherwise
+ *
+ * @ingroup apiTfaApi
+ */
+retval_t tfa_ed_survey_get(uint8_t channel, tfa_ed_survey_result_t *result);
+
 #if (PAL_GENERIC_TYPE == MEGA_RF) || defined(DOXYGEN)
 /**
  * @brief Get the temperature value from the integrated sensor
@@ -0,0 +1,321 @@
+/**
+ * @file tfa_ed_survey.c
+ *
+ * @brief Background ED spectrum survey based on single ED samples
+ *
+ * The survey visits one channel of the requested channel mask per call of
+ * tfa_ed_survey_task(), takes a few ED samples there and accumulates them
+ * into a small per-channel histogram. Mean, percentiles and the share of
+ * samples above a busy threshold are derived from this histogram on demand.
+ *
+ * $Id$
+ *
+ * @author    Atmel Corporation: http://www.atmel.com
+ * @author    Support email: avr@atmel.com
+ */
+/*
+ * Copyright (c) 2009, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifdef ENABLE_TFA
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "pal.h"
+#include "return_val.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "tfa.h"
+
+/* === TYPES =============================================================== */
+
+/** Statistics gathered per channel */
+typedef struct ed_survey_channel_tag
+{
+    /** Histogram of the normalized ED values */
+    uint8_t bins[TFA_ED_SURVEY_BINS];
+    /** Number of samples contained in the histogram */
+    uint16_t samples;
+    /** Number of samples above the busy threshold */
+    uint16_t busy;
+    /** Sum of all samples, used for the mean value */
+    uint32_t sum;
+    /** Highest ED value seen */
+    uint8_t max;
+} ed_survey_channel_t;
+
+/* === MACROS ============================================================== */
+
+/** Number of channels covered by the survey */
+#define ED_SURVEY_NO_OF_CHANNELS        (MAX_CHANNEL - MIN_CHANNEL + 1)
+
+/** Width of a histogram bin in ED units */
+#define ED_SURVEY_BIN_WIDTH             (256 / TFA_ED_SURVEY_BINS)
+
+/** Histogram bin of a normalized ED value */
+#define ED_SURVEY_BIN(ed)               ((uint8_t)((ed) / ED_SURVEY_BIN_WIDTH))
+
+#if (TFA_ED_SURVEY_BINS > 256) || (TFA_ED_SURVEY_BINS & (TFA_ED_SURVEY_BINS - 1))
+#error "TFA_ED_SURVEY_BINS must be a power of two not larger than 256"
+#endif
+
+/* === GLOBALS ============================================================= */
+
+/** Statistics of all channels */
+static ed_survey_channel_t ed_survey_stats[ED_SURVEY_NO_OF_CHANNELS];
+
+/** Channels still to be surveyed; 0 if no survey is running */
+static uint32_t ed_survey_channel_mask;
+
+/** ED value above which a sample counts as busy */
+static uint8_t ed_survey_threshold;
+
+/** Channel to be visited next */
+static uint8_t ed_survey_next_channel;
+
+/* === PROTOTYPES ========================================================== */
+
+static void ed_survey_add_sample(ed_survey_channel_t *stats, uint8_t ed_value);
+static uint8_t ed_survey_percentile(ed_survey_channel_t *stats, uint8_t percent);
+
+/* === IMPLEMENTATION ====================================================== */
+
+/**
+ * @brief Starts a background ED spectrum survey
+ *
+ * @param channel_mask Bit mask of channels to be surveyed
+ * @param threshold Normalized ED value above which a sample counts as busy
+ *
+ * @return MAC_INVALID_PARAMETER if the channel mask contains no valid channel;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t tfa_ed_survey_start(uint32_t channel_mask, uint8_t threshold)
+{
+    channel_mask &= (uint32_t)VALID_CHANNEL_MASK;
+    if (channel_mask == 0)
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    memset(ed_survey_stats, 0, sizeof(ed_survey_stats));
+    ed_survey_threshold = threshold;
+    ed_survey_next_channel = MIN_CHANNEL;
+    ed_survey_channel_mask = channel_mask;
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Stops the ED spectrum survey
+ */
+void tfa_ed_survey_stop(void)
+{
+    ed_survey_channel_mask = 0;
+}
+
+
+
+/**
+ * @brief Visits the next channel of the ED spectrum survey
+ *
+ * @param rx_on Defines whether the receiver is switched on again afterwards
+ *
+ * @return FAILURE if no survey is running;
+ *         TAL_BUSY if the TAL is currently busy;
+ *         TAL_TRX_ASLEEP if the transceiver is sleeping;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t tfa_ed_survey_task(bool rx_on)
+{
+    uint8_t current_channel;
+    uint8_t channel;
+    uint8_t i;
+    pib_value_t pib_value;
+    retval_t status;
+    ed_survey_channel_t *stats;
+
+    if (ed_survey_channel_mask == 0)
+    {
+        return FAILURE;
+    }
+
+    /* Find the next channel of the mask, wrapping around at the end. */
+    channel = ed_survey_next_channel;
+    while ((ed_survey_channel_mask & ((uint32_t)1 << channel)) == 0)
+    {
+        channel = (channel >= MAX_CHANNEL) ? MIN_CHANNEL : (channel + 1);
+    }
+
+    tal_pib_get(phyCurrentChannel, &current_channel);
+
+    /*
+     * Setting the channel is done even if the survey channel is the current
+     * one, since the TAL rejects it while being busy or asleep.
+     */
+    pib_value.pib_value_8bit = channel;
+    status = tal_pib_set(phyCurrentChannel, &pib_value);
+    if (status != MAC_SUCCESS)
+    {
+        return status;
+    }
+
+    stats = &ed_survey_stats[channel - MIN_CHANNEL];
+    for (i = 0; i < TFA_ED_SURVEY_SAMPLES_PER_VISIT; i++)
+    {
+        ed_survey_add_sample(stats, tfa_ed_sample());
+    }
+
+    /* The transceiver is in TRX_OFF after sampling. */
+    if (channel != current_channel)
+    {
+        pib_value.pib_value_8bit = current_channel;
+        tal_pib_set(phyCurrentChannel, &pib_value);
+    }
+    if (rx_on)
+    {
+        tal_rx_enable(PHY_RX_ON);
+    }
+
+    ed_survey_next_channel = (channel >= MAX_CHANNEL) ? MIN_CHANNEL : (channel + 1);
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Gets the ED spectrum survey statistics of a channel
+ *
+ * @param[in] channel Channel number
+ * @param[out] result Statistics of the channel
+ *
+ * @return MAC_INVALID_PARAMETER if the channel is not valid;
+ *         FAILURE if no sample has been taken on this channel yet;
+ *         MAC_SUCCESS otherwise
+ */
+retval_t tfa_ed_survey_get(uint8_t channel, tfa_ed_survey_result_t *result)
+{
+    ed_survey_channel_t *stats;
+
+    if ((channel < MIN_CHANNEL) || (channel > MAX_CHANNEL))
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    stats = &ed_survey_stats[channel - MIN_CHANNEL];
+    if (stats->samples == 0)
+    {
+        return FAILURE;
+    }
+
+    result->samples = stats->samples;
+    result->max = stats->max;
+    /* Halving the counters may lift the mean slightly above the maximum. */
+    if ((stats->sum / stats->samples) > stats->max)
+    {
+        result->mean = stats->max;
+    }
+    else
+    {
+        result->mean = (uint8_t)(stats->sum / stats->samples);
+    }
+    result->p50 = ed_survey_percentile(stats, 50);
+    result->p90 = ed_survey_percentile(stats, 90);
+    result->p99 = ed_survey_percentile(stats, 99);
+    result->duty_cycle = (uint8_t)(((uint32_t)stats->busy * 100) / stats->samples);
+
+    return MAC_SUCCESS;
+}
+
+
+
+/**
+ * @brief Adds an ED sample to the statistics of a channel
+ *
+ * If a histogram bin would overflow, all counters of the channel are halved.
+ * This keeps the ratios intact and lets older samples fade out gradually.
+ *
+ * @param stats Statistics of the channel
+ * @param ed_value Normalized ED value
+ */
+static void ed_survey_add_sample(ed_survey_channel_t *stats, uint8_t ed_value)
+{
+    uint8_t bin = ED_SURVEY_BIN(ed_value);
+
+    if (stats->bins[bin] == 0xFF)
+    {
+        uint16_t i;
+
+        stats->samples = 0;
+        for (i = 0; i < TFA_ED_SURVEY_BINS; i++)
+        {
+            stats->bins[i] >>= 1;
+            stats->samples += stats->bins[i];
+        }
+        stats->busy >>= 1;
+        if (stats->busy > stats->samples)
+        {
+            stats->busy = stats->samples;
+        }
+        stats->sum >>= 1;
+    }
+
+    stats->bins[bin]++;
+    stats->samples++;
+    stats->sum += ed_value;
+    if (ed_value > ed_survey_threshold)
+    {
+        stats->busy++;
+    }
+    if (ed_value > stats->max)
+    {
+        stats->max = ed_value;
+    }
+}
+
+
+
+/**
+ * @brief Estimates a percentile from the histogram of a channel
+ *
+ * @param stats Statistics of the channel
+ * @param percent Requested percentile
+ *
+ * @return Upper edge of the bin containing the percentile, limited to the
+ *         highest ED value seen
+ */
+static uint8_t ed_survey_percentile(ed_survey_channel_t *stats, uint8_t percent)
+{
+    uint32_t limit = (uint32_t)stats->samples * percent;
+    uint32_t count = 0;
+    uint16_t upper_edge = ED_SURVEY_BIN_WIDTH - 1;
+    uint16_t i;
+
+    for (i = 0; i < TFA_ED_SURVEY_BINS; i++)
+    {
+        count += stats->bins[i];
+        if ((count * 100) >= limit)
+        {
+            break;
+        }
+        upper_edge += ED_SURVEY_BIN_WIDTH;
+    }
+
+    if (upper_edge > stats->max)
+    {
+        upper_edge = stats->max;
+    }
+
+    return (uint8_t)upper_edge;
+}
+
+#endif /* #ifdef ENABLE_TFA */
+
+/* EOF */
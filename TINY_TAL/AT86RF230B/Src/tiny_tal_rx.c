@@ -30,22 +30,15 @@
 #include "at86rf230b.h"
 #include "tiny_tal_rx.h"
 #include "tiny_tal_internal.h"
+#include "tal_lqi.h"
 
 /* === TYPES =============================================================== */
 
 
 /* === MACROS ============================================================== */
 
-/* Constant defines for the LQI calculation */
-#define ED_THRESHOLD                    (60)
-#define ED_MAX                          (-RSSI_BASE_VAL - ED_THRESHOLD)
-#define LQI_MAX                         (3)
-#define UPPER_CLIPPING_VALUE        (-60)
-
 #define US_PER_OCTECT                   (32)
 #define TRX_END_PROCESS_DELAY_US        (16)
-/* Constant define for the ED scaling: register value at -35dBm */
-#define CLIP_VALUE_REG                  (56)
 
 /* === GLOBALS ============================================================= */
 
@@ -63,11 +56,6 @@ bool tiny_tal_frame_rx;
 
 /* === PROTOTYPES ========================================================== */
 
-#ifdef RSSI_TO_LQI_MAPPING
-static inline uint8_t normalize_lqi(uint8_t ed_value);
-#else
-static inline uint8_t normalize_lqi(uint8_t lqi, uint8_t ed_value);
-#endif
 
 /* === IMPLEMENTATION ====================================================== */
 
@@ -136,6 +124,11 @@ void process_incoming_frame(void)
     /* Store normalized LQI value again. */
     tiny_tal_rx_buffer[tiny_tal_rx_buffer[0] + LQI_LEN] = lqi;
 
+#ifdef ENABLE_RSSI
+    /* Replace the ED value by the received signal strength in dBm. */
+    tiny_tal_rx_buffer[tiny_tal_rx_buffer[0] + LQI_LEN + ED_VAL_LEN] = (uint8_t)ed_to_rssi(ed_level);
+#endif  /* ENABLE_RSSI */
+
     /*
      * The callback function implemented by the application on top of Tiny-TAL.
      */
@@ -143,75 +136,5 @@ void process_incoming_frame(void)
 } /* process_incoming_frame() */
 
 
-
-#ifdef RSSI_TO_LQI_MAPPING
-/**
- * @brief Normalize LQI
- *
- * This function normalizes the LQI value based on the RSSI/ED value.
- *
- * @param ed_value Read ED value
- *
- * @return The calculated/normalized LQI value: ppduLinkQuality
- */
-static inline uint8_t normalize_lqi(uint8_t ed_value)
-{
-    /*
-     * Scale ED result.
-     * Clip values to 0xFF if > -35dBm
-     */
-    if (ed_value > CLIP_VALUE_REG)
-    {
-        return 0xFF;
-    }
-    else
-    {
-        return (uint8_t)(((uint16_t)ed_value * 0xFF) / CLIP_VALUE_REG);
-    }
-}
-
-#else
-
-/**
- * @brief Normalize LQI
- *
- * This function normalizes the LQI value based on the ED and
- * the originally appended LQI value.
- *
- * @param lqi Measured LQI
- * @param ed_value Read ED value
- *
- * @return The calculated LQI value: ppduLinkQuality
- */
-static inline uint8_t normalize_lqi(uint8_t lqi, uint8_t ed_value)
-{
-    uint16_t link_quality;
-    uint8_t lqi_star;
-
-    if (ed_value > ED_MAX)
-    {
-        ed_value = ED_MAX;
-    }
-    else if (ed_value == 0)
-    {
-        ed_value = 1;
-    }
-
-    lqi_star = lqi >> 6;
-    link_quality = (uint16_t)lqi_star * (uint16_t)ed_value * 255 / (ED_MAX * LQI_MAX);
-
-    if (link_quality > 255)
-    {
-        return 255;
-    }
-    else
-    {
-        return (uint8_t)link_quality;
-    }
-}
-#endif /* #ifdef RSSI_TO_LQI_MAPPING */
-
-
-
 /*  EOF */
 
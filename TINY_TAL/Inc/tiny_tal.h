@@ -26,6 +26,7 @@
 #include "stack_config.h"
 #include "return_val.h"
 #include "tiny_tal_types.h"
+#include "symbol_time.h"
 
 /* === EXTERNALS =========================================================== */
 
@@ -248,10 +249,17 @@ typedef union
 #if (RF_BAND == BAND_2400)
     #define TAL_CONVERT_US_TO_SYMBOLS(time)         ((time) >> 4)
 #else   /* (RF_BAND == BAND_900) */
-    #define TAL_CONVERT_US_TO_SYMBOLS(time)                                 \
-        (tal_pib_CurrentPage == 0 ?                                         \
-            (tal_pib_CurrentChannel == 0 ? ((time) / 50) : ((time) / 25)) : \
-            (tal_pib_CurrentChannel == 0 ? ((time) / 40) : ((time) >> 4))   \
+    /*
+     * The divisions by 50, 25 and 40 are composed of shifts and exact
+     * divisions by 5, see symbol_time.h.
+     */
+    #define TAL_CONVERT_US_TO_SYMBOLS(time)                                                 \
+        (tal_pib_CurrentPage == 0 ?                                                         \
+            (tal_pib_CurrentChannel == 0 ?                                                  \
+                divide_by_5(divide_by_5((uint32_t)(time) >> 1)) :                           \
+                divide_by_5(divide_by_5((uint32_t)(time)))) :                               \
+            (tal_pib_CurrentChannel == 0 ?                                                  \
+                divide_by_5((uint32_t)(time) >> 3) : ((time) >> 4))                         \
         )
 #endif  /* #if (RF_BAND == BAND_2400) */
 
@@ -335,6 +343,10 @@ uint8_t tal_rx_enable(uint8_t state);
 /**
  * User call back function for frame reception
  *
+ * The received frame array contains the length field, the MPDU, the
+ * normalized LQI and the ED value. If ENABLE_RSSI is defined, the ED value
+ * is replaced by the received signal strength in dBm (as int8_t).
+ *
  * @param rx_frame_array Pointer to received frame array
  * @ingroup apiTalApi
  */